@@ -0,0 +1,87 @@
+// Benchmarks for action bookkeeping: the list of active actions and scheduled events.
+
+#include "benchmark.h"
+#include "vart/jointaction.h"
+#include "vart/scheduler.h"
+#include "vart/simulationclock.h"
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+const unsigned int NUM_ACTIONS = 100000;
+
+// An action that does nothing but keep its time
+class IdleAction : public VART::JointAction {
+    public:
+        IdleAction() { SetDuration(1.0f); }
+    protected:
+        virtual void Move() { bool cycled; ComputePositionIndex(&cycled); }
+};
+
+static std::vector<IdleAction>& Actions()
+{
+    static std::vector<IdleAction> actions(NUM_ACTIONS);
+    static bool initialized = false;
+    if (!initialized)
+    {
+        srand(1);
+        for (unsigned int i = 0; i < NUM_ACTIONS; ++i)
+            actions[i].SetPriority(rand() % 4);
+        initialized = true;
+    }
+    return actions;
+}
+
+// Activates all actions (in four priority levels), then deactivates them in random order
+static void ActivateDeactivate(unsigned long iterations)
+{
+    std::vector<IdleAction>& actions = Actions();
+    std::vector<unsigned int> order(NUM_ACTIONS);
+    for (unsigned int i = 0; i < NUM_ACTIONS; ++i)
+        order[i] = i;
+    std::random_shuffle(order.begin(), order.end());
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        for (unsigned int i = 0; i < NUM_ACTIONS; ++i)
+            actions[i].Activate();
+        for (unsigned int i = 0; i < NUM_ACTIONS; ++i)
+            actions[order[i]].Deactivate();
+    }
+}
+
+// Schedules activations over 10 seconds, each action lasting half a second, and runs
+// 10 seconds of animation at 60 steps per second.
+static void ScheduledActions(unsigned long iterations)
+{
+    std::vector<IdleAction>& actions = Actions();
+    VART::SimulationClock clock(1.0/60.0);
+    clock.SetOffline(true);
+    VART::SimulationClock::SetCurrent(&clock);
+    VART::Scheduler scheduler(1.0/60.0);
+    VART::Scheduler::SetCurrent(&scheduler);
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        clock.Reset();
+        scheduler.Reset();
+        srand(2);
+        for (unsigned int i = 0; i < NUM_ACTIONS; ++i)
+        {
+            double start = (rand() % 600) / 60.0;
+            scheduler.Activate(&actions[i], start);
+            scheduler.Deactivate(&actions[i], start + 0.5);
+        }
+        unsigned int numMoved = 0;
+        for (unsigned int step = 0; step < 632; ++step)
+        {
+            clock.Update();
+            clock.Step();
+            numMoved += VART::BaseAction::MoveAllActive();
+        }
+        Benchmark::Use(numMoved);
+    }
+    VART::Scheduler::SetCurrent(NULL);
+    VART::SimulationClock::SetCurrent(NULL);
+}
+
+static Benchmark b1("action/activate-deactivate", &ActivateDeactivate, NUM_ACTIONS);
+static Benchmark b2("action/scheduled-100k", &ScheduledActions, NUM_ACTIONS);
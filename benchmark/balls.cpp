@@ -0,0 +1,139 @@
+// Benchmarks for ball simulations: steps of balls dropped on hills, given as a terrain and
+// as the triangles of a mesh object, and writing ball placements into transforms.
+
+#include "benchmark.h"
+#include "vart/ballsimulation.h"
+#include "vart/terrain.h"
+#include "vart/meshobject.h"
+#include "vart/transform.h"
+#include <cmath>
+#include <vector>
+
+const double BALL_RADIUS = 0.5;
+
+// Height of the hills
+static float HillHeight(double x, double z)
+{
+    return static_cast<float>(4 * sin(x * 0.1) * cos(z * 0.13) + sin(x * 0.37 + z * 0.23));
+}
+
+// Hills as a mesh object: two triangles per cell
+class HillMesh : public VART::MeshObject {
+    public:
+        HillMesh(unsigned int numCells);
+};
+
+HillMesh::HillMesh(unsigned int numCells)
+{
+    unsigned int numSamples = numCells + 1;
+    for (unsigned int j = 0; j < numSamples; ++j)
+        for (unsigned int i = 0; i < numSamples; ++i)
+        {
+            vertCoordVec.push_back(i);
+            vertCoordVec.push_back(HillHeight(i, j));
+            vertCoordVec.push_back(j);
+        }
+    VART::Mesh mesh;
+    mesh.type = VART::Mesh::TRIANGLES;
+    for (unsigned int j = 0; j < numCells; ++j)
+        for (unsigned int i = 0; i < numCells; ++i)
+        {
+            unsigned int corner = j * numSamples + i;
+            unsigned int indices[] = { corner, corner + numSamples, corner + 1,
+                                       corner + 1, corner + numSamples, corner + numSamples + 1 };
+            mesh.indexVec.insert(mesh.indexVec.end(), indices, indices + 6);
+        }
+    meshList.push_back(mesh);
+    ComputeVertexNormals();
+    ComputeBoundingBox();
+}
+
+// Balls in two layers above hills, kept in by walls
+class Drop {
+    public:
+        Drop(unsigned int numBalls, bool mesh);
+        VART::Terrain terrain;
+        VART::BallSimulation simulation;
+};
+
+Drop::Drop(unsigned int numBalls, bool mesh)
+{
+    unsigned int numCells = static_cast<unsigned int>(ceil(sqrt(numBalls) / 16)) * 16;
+    unsigned int perSide = static_cast<unsigned int>(numCells / (2.5 * BALL_RADIUS));
+    if (mesh)
+    {
+        HillMesh hills(numCells);
+        simulation.AddMesh(hills);
+    }
+    else
+    {
+        terrain.SetSize(numCells, numCells, 1, 16);
+        for (unsigned int j = 0; j <= numCells; ++j)
+            for (unsigned int i = 0; i <= numCells; ++i)
+                terrain.SetHeight(i, j, HillHeight(i, j));
+        simulation.SetTerrain(&terrain);
+    }
+    for (unsigned int ball = 0; ball < numBalls; ++ball)
+    {
+        unsigned int layer = ball / (perSide * perSide);
+        unsigned int row = (ball / perSide) % perSide;
+        double x = (ball % perSide + 0.5) * 2.5 * BALL_RADIUS;
+        double z = (row + 0.5) * 2.5 * BALL_RADIUS;
+        simulation.AddBall(VART::Point4D(x, 7 + layer * 2.5 * BALL_RADIUS, z), BALL_RADIUS);
+    }
+    VART::BoundingBox box;
+    box.SetBoundingBox(0, -100, 0, numCells, 1000, numCells);
+    simulation.SetBounds(box);
+}
+
+static void Steps(unsigned long iterations, Drop* dropPtr)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        dropPtr->simulation.Step();
+    Benchmark::Use(dropPtr->simulation.GetPosition(0).GetY());
+}
+
+static void Terrain1k(unsigned long iterations)
+{
+    static Drop drop(1000, false);
+    Steps(iterations, &drop);
+}
+
+static void Terrain10k(unsigned long iterations)
+{
+    static Drop drop(10000, false);
+    Steps(iterations, &drop);
+}
+
+static void Terrain100k(unsigned long iterations)
+{
+    static Drop drop(100000, false);
+    Steps(iterations, &drop);
+}
+
+static void Mesh10k(unsigned long iterations)
+{
+    static Drop drop(10000, true);
+    Steps(iterations, &drop);
+    Benchmark::SetCounter("triangles", drop.simulation.GetNumTriangles());
+}
+
+// Writes placements of 10k balls into transforms
+static void Transforms10k(unsigned long iterations)
+{
+    static Drop drop(10000, false);
+    static std::vector<VART::Transform*> transformPtrVec;
+    static std::vector<VART::Transform> transformVec(10000);
+    if (transformPtrVec.empty())
+        for (unsigned int i = 0; i < transformVec.size(); ++i)
+            transformPtrVec.push_back(&transformVec[i]);
+    for (unsigned long i = 0; i < iterations; ++i)
+        drop.simulation.WriteTransforms(transformPtrVec);
+    Benchmark::Use(transformVec[0].GetData()[13]);
+}
+
+static Benchmark terrain1k("balls/terrain-1k", &Terrain1k, 1000);
+static Benchmark terrain10k("balls/terrain-10k", &Terrain10k, 10000);
+static Benchmark terrain100k("balls/terrain-100k", &Terrain100k, 100000);
+static Benchmark mesh10k("balls/mesh-10k", &Mesh10k, 10000);
+static Benchmark transforms10k("balls/transforms-10k", &Transforms10k, 10000);
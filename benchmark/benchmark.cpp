@@ -0,0 +1,219 @@
+/// \file benchmark.cpp
+/// \brief Implementation file for the V-ART microbenchmark harness.
+/// \version $Revision: 1.1 $
+
+#include "benchmark.h"
+#include "vart/time.h"
+#include <algorithm>
+#include <iomanip>
+
+using namespace std;
+
+unsigned int Benchmark::numSamples = 15;
+unsigned int Benchmark::numWarmup = 1;
+double Benchmark::sampleTime = 0.01;
+volatile double Benchmark::sink = 0.0;
+vector<pair<string, double> > Benchmark::counters;
+
+Benchmark::Benchmark(const char* newName, Function newFunction, unsigned long newItems)
+    : name(newName), function(newFunction), items(newItems)
+{
+    Registry().push_back(this);
+}
+
+// static
+vector<Benchmark*>& Benchmark::Registry()
+{
+    // Function local, so that it exists before static benchmarks are constructed
+    static vector<Benchmark*> registry;
+    return registry;
+}
+
+// static
+double Benchmark::Seconds(Function function, unsigned long iterations)
+{
+    VART::Time start;
+    VART::Time end;
+    start.SetMonotonic();
+    function(iterations);
+    end.SetMonotonic();
+    return (end - start).AsDouble();
+}
+
+// static
+void Benchmark::SetCounter(const string& counterName, double value)
+{
+    for (unsigned int i = 0; i < counters.size(); ++i)
+    {
+        if (counters[i].first == counterName)
+        {
+            counters[i].second = value;
+            return;
+        }
+    }
+    counters.push_back(make_pair(counterName, value));
+}
+
+// Returns the value at given fraction of a sorted vector (linear interpolation)
+static double Percentile(const vector<double>& sorted, double fraction)
+{
+    double position = fraction * (sorted.size() - 1);
+    unsigned int index = static_cast<unsigned int>(position);
+    if (index + 1 >= sorted.size())
+        return sorted.back();
+    double weight = position - index;
+    return sorted[index] * (1 - weight) + sorted[index + 1] * weight;
+}
+
+void Benchmark::Run(Result* resultPtr) const
+{
+    counters.clear();
+    // Calibrate: double iterations until a sample takes at least 1/4 of sampleTime
+    unsigned long iterations = 1;
+    double seconds = Seconds(function, iterations);
+    while (seconds < sampleTime / 4)
+    {
+        iterations *= 2;
+        seconds = Seconds(function, iterations);
+    }
+    iterations = static_cast<unsigned long>(iterations * sampleTime / seconds) + 1;
+    for (unsigned int i = 0; i < numWarmup; ++i)
+        Seconds(function, iterations);
+    vector<double> times(numSamples);
+    double sum = 0;
+    for (unsigned int i = 0; i < numSamples; ++i)
+    {
+        times[i] = Seconds(function, iterations) * 1e9 / (iterations * items);
+        sum += times[i];
+    }
+    sort(times.begin(), times.end());
+    resultPtr->name = name;
+    resultPtr->items = items;
+    resultPtr->iterations = iterations;
+    resultPtr->samples = numSamples;
+    resultPtr->warmup = numWarmup;
+    resultPtr->min = times.front();
+    resultPtr->median = Percentile(times, 0.5);
+    resultPtr->p10 = Percentile(times, 0.1);
+    resultPtr->p90 = Percentile(times, 0.9);
+    resultPtr->max = times.back();
+    resultPtr->mean = sum / numSamples;
+    resultPtr->counters = counters;
+}
+
+// static
+void Benchmark::RunAll(const string& prefix, vector<Result>* resultsPtr)
+{
+    vector<Benchmark*>& registry = Registry();
+    Result result;
+    for (unsigned int i = 0; i < registry.size(); ++i)
+    {
+        if (registry[i]->name.compare(0, prefix.size(), prefix) == 0)
+        {
+            registry[i]->Run(&result);
+            resultsPtr->push_back(result);
+        }
+    }
+}
+
+// static
+void Benchmark::PrintTable(ostream& os, const vector<Result>& results)
+{
+    os << left << setw(46) << "benchmark (ns/item)" << right << setw(15) << "median"
+       << setw(15) << "p10" << setw(15) << "p90" << "\n";
+    os << fixed << setprecision(3);
+    for (unsigned int i = 0; i < results.size(); ++i)
+    {
+        os << left << setw(46) << results[i].name << right << setw(15) << results[i].median
+           << setw(15) << results[i].p10 << setw(15) << results[i].p90 << "\n";
+        const vector<pair<string, double> >& counters = results[i].counters;
+        for (unsigned int c = 0; c < counters.size(); ++c)
+            os << "    " << counters[c].first << ": " << counters[c].second << "\n";
+    }
+}
+
+// Writes a string as a JSON string
+static void PrintJSONString(ostream& os, const string& text)
+{
+    os << '"';
+    for (unsigned int i = 0; i < text.size(); ++i)
+    {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c == '"' || c == '\\')
+            os << '\\' << c;
+        else if (c < 0x20)
+            os << "\\u" << hex << setw(4) << setfill('0') << static_cast<unsigned int>(c)
+               << dec << setfill(' ');
+        else
+            os << c;
+    }
+    os << '"';
+}
+
+// static
+void Benchmark::PrintJSON(ostream& os, const vector<Result>& results)
+{
+    os << "{\n  \"unit\": \"ns/item\",\n  \"sample_time\": " << sampleTime
+       << ",\n  \"benchmarks\": [";
+    os << setprecision(6);
+    for (unsigned int i = 0; i < results.size(); ++i)
+    {
+        const Result& result = results[i];
+        os << ((i > 0) ? ",\n" : "\n") << "    {\"name\": ";
+        PrintJSONString(os, result.name);
+        os << ", \"items\": " << result.items << ", \"iterations\": " << result.iterations
+           << ", \"samples\": " << result.samples << ", \"warmup\": " << result.warmup
+           << ",\n     \"min\": " << result.min << ", \"p10\": " << result.p10
+           << ", \"median\": " << result.median << ", \"p90\": " << result.p90
+           << ", \"max\": " << result.max << ", \"mean\": " << result.mean
+           << ",\n     \"counters\": {";
+        for (unsigned int c = 0; c < result.counters.size(); ++c)
+        {
+            if (c > 0)
+                os << ", ";
+            PrintJSONString(os, result.counters[c].first);
+            os << ": " << result.counters[c].second;
+        }
+        os << "}}";
+    }
+    os << "\n  ]\n}\n";
+}
+
+// static
+void Benchmark::PrintNames(ostream& os)
+{
+    vector<Benchmark*>& registry = Registry();
+    for (unsigned int i = 0; i < registry.size(); ++i)
+        os << registry[i]->name << "\n";
+}
+
+Check::Check(const char* newName, Function newFunction) : name(newName), function(newFunction)
+{
+    Registry().push_back(this);
+}
+
+// static
+vector<Check*>& Check::Registry()
+{
+    // Function local, so that it exists before static checks are constructed
+    static vector<Check*> registry;
+    return registry;
+}
+
+// static
+unsigned int Check::RunAll(const string& prefix, ostream& os)
+{
+    vector<Check*>& registry = Registry();
+    unsigned int numFailed = 0;
+    for (unsigned int i = 0; i < registry.size(); ++i)
+    {
+        if (registry[i]->name.compare(0, prefix.size(), prefix) == 0)
+        {
+            bool passed = registry[i]->function(os);
+            os << (passed ? "OK   " : "FAIL ") << registry[i]->name << endl;
+            if (!passed)
+                ++numFailed;
+        }
+    }
+    return numFailed;
+}
@@ -0,0 +1,118 @@
+/// \file benchmark.h
+/// \brief Header file for the V-ART microbenchmark harness.
+/// \version $Revision: 1.1 $
+
+#ifndef VART_BENCHMARK_H
+#define VART_BENCHMARK_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <utility>
+
+/// \class Benchmark benchmark.h
+/// \brief A named, timed piece of code.
+///
+/// Benchmarks are static objects that register themselves at construction:
+/// \code
+/// static void BenchSomething(unsigned long iterations) { ... }
+/// static Benchmark bench("group/something", &BenchSomething, 1024);
+/// \endcode
+/// The function must run its kernel "iterations" times. Each sample runs enough
+/// iterations to take a few milliseconds; after warmup samples (not measured), several
+/// samples are measured and summarized by percentiles of the time per item, which are
+/// robust to the few samples slowed down by the rest of the system. Results print as a
+/// table to read, or as JSON to keep and compare between builds (see PrintJSON).
+class Benchmark {
+    public:
+    // PUBLIC TYPES
+        typedef void (*Function)(unsigned long iterations);
+        /// \brief Statistics of a run, in nanoseconds per item.
+        class Result {
+            public:
+                std::string name;
+                unsigned long items; // per iteration
+                unsigned long iterations; // per sample
+                unsigned int samples;
+                unsigned int warmup;
+                double min;
+                double median;
+                double p10;
+                double p90;
+                double max;
+                double mean;
+                /// Values reported with SetCounter (name, value).
+                std::vector<std::pair<std::string, double> > counters;
+        };
+    // PUBLIC STATIC METHODS
+        /// \brief Runs all benchmarks whose names start with prefix.
+        static void RunAll(const std::string& prefix, std::vector<Result>* resultsPtr);
+        /// \brief Prints results as a table.
+        static void PrintTable(std::ostream& os, const std::vector<Result>& results);
+        /// \brief Prints results as a JSON object, with settings of the run and an array
+        /// of results (times in nanoseconds per item, counters as an object).
+        static void PrintJSON(std::ostream& os, const std::vector<Result>& results);
+        /// \brief Prints the names of all benchmarks.
+        static void PrintNames(std::ostream& os);
+        /// \brief Sets the number of measured samples (default 15).
+        static void SetSamples(unsigned int value) { numSamples = (value > 0) ? value : 1; }
+        /// \brief Sets the number of warmup samples (default 1).
+        static void SetWarmup(unsigned int value) { numWarmup = value; }
+        /// \brief Sets the duration of each sample in seconds (default 0.01).
+        static void SetSampleTime(double seconds) { sampleTime = seconds; }
+        /// \brief Keeps the compiler from discarding a result.
+        static void Use(double value) { sink += value; }
+        /// \brief Attaches a value (e.g.: bytes per frame) to the result of the running
+        /// benchmark. Setting the same counter again replaces its value.
+        static void SetCounter(const std::string& name, double value);
+    // PUBLIC METHODS
+        /// \brief Creates and registers a benchmark.
+        /// \param name [in] Name, usually "group/case".
+        /// \param function [in] Code to measure.
+        /// \param items [in] Number of items processed per iteration.
+        Benchmark(const char* name, Function function, unsigned long items);
+        /// \brief Measures the benchmark.
+        void Run(Result* resultPtr) const;
+    private:
+        static std::vector<Benchmark*>& Registry();
+        static double Seconds(Function function, unsigned long iterations);
+        static unsigned int numSamples;
+        static unsigned int numWarmup;
+        static double sampleTime;
+        static volatile double sink;
+        static std::vector<std::pair<std::string, double> > counters;
+        std::string name;
+        Function function;
+        unsigned long items;
+};
+
+/// \class Check benchmark.h
+/// \brief A named correctness check of code that benchmarks measure.
+///
+/// Checks are static objects that register themselves at construction, as benchmarks do:
+/// \code
+/// static bool CheckSomething(std::ostream& os) { ... }
+/// static Check check("group/something", &CheckSomething);
+/// \endcode
+/// The function compares results against a reference, describes mismatches on the stream
+/// and returns false if there were any. They run with "benchmark -v", which exits with a
+/// non-zero status if any check fails.
+class Check {
+    public:
+    // PUBLIC TYPES
+        typedef bool (*Function)(std::ostream& os);
+    // PUBLIC STATIC METHODS
+        /// \brief Runs all checks whose names start with prefix, printing "OK" or "FAIL"
+        /// and the name of each.
+        /// \return The number of failed checks.
+        static unsigned int RunAll(const std::string& prefix, std::ostream& os);
+    // PUBLIC METHODS
+        /// \brief Creates and registers a check.
+        Check(const char* name, Function function);
+    private:
+        static std::vector<Check*>& Registry();
+        std::string name;
+        Function function;
+};
+
+#endif
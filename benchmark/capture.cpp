@@ -0,0 +1,120 @@
+// Benchmarks for capturing rendered frames to files.
+
+#include "benchmark.h"
+#include "vart/contrib/framecapture.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+const int FRAME_COLUMNS = 1920;
+const int FRAME_LINES = 1080;
+// Frames captured per iteration: a short burst, as when recording an animation
+const unsigned int BURST_FRAMES = 8;
+const char* const FILE_PREFIX = "capture_";
+const char* const RAW_FILE_NAME = "capture.rgb";
+
+// An RGBA frame with smooth shading and a few hard edges, as rendered scenes have
+static const std::vector<unsigned char>& GetFrame()
+{
+    static std::vector<unsigned char> frame;
+    if (frame.empty())
+    {
+        frame.resize(FRAME_COLUMNS * FRAME_LINES * 4);
+        unsigned char* ptr = &frame[0];
+        for (int lin = 0; lin < FRAME_LINES; ++lin)
+            for (int col = 0; col < FRAME_COLUMNS; ++col)
+            {
+                double shade = 0.5 + 0.5 * std::sin(col * 0.01) * std::cos(lin * 0.013);
+                bool box = ((col / 240) + (lin / 180)) % 3 == 0;
+                *ptr++ = static_cast<unsigned char>(box ? 200 : 255 * shade);
+                *ptr++ = static_cast<unsigned char>(box ? 40 : 180 * shade);
+                *ptr++ = static_cast<unsigned char>(box ? 40 : 100 + 100 * shade);
+                *ptr++ = 255;
+            }
+    }
+    return frame;
+}
+
+static std::string SequenceFileName(unsigned int number, const char* extension)
+{
+    std::ostringstream oss;
+    oss << FILE_PREFIX << std::setfill('0') << std::setw(5) << number << extension;
+    return oss.str();
+}
+
+static void RemoveFiles(unsigned int count, const char* extension)
+{
+    for (unsigned int i = 0; i < count; ++i)
+        std::remove(SequenceFileName(i, extension).c_str());
+}
+
+// PNMExporter::OnDraw as it was: a new file per frame, written three bytes at a time while
+// flipping rows, all in the rendering thread
+static void SyncPNM(unsigned long iterations)
+{
+    const std::vector<unsigned char>& frame = GetFrame();
+    const unsigned int* dataPtr = reinterpret_cast<const unsigned int*>(&frame[0]);
+    unsigned int counter = 0;
+    for (unsigned long n = 0; n < iterations * BURST_FRAMES; ++n)
+    {
+        std::ofstream outFile(SequenceFileName(counter++, ".pnm").c_str());
+        outFile << "P6\n#Creator: V-ART framework PNMExporter class\n"
+                << FRAME_COLUMNS << " " << FRAME_LINES << "\n255\n";
+        const char* pixelPtr;
+        for (int lin = FRAME_LINES; lin > 0; --lin)
+        {
+            pixelPtr = reinterpret_cast<const char*>(dataPtr + ((lin-1)*FRAME_COLUMNS));
+            for (int col = 0; col < FRAME_COLUMNS; ++col)
+            {
+                outFile.write(pixelPtr,3);
+                pixelPtr += 4;
+            }
+        }
+    }
+    RemoveFiles(counter, ".pnm");
+}
+
+// Captures through FrameCapture, reporting time spent in the rendering thread
+static void Capture(VART::FrameCapture::Format format, unsigned long iterations)
+{
+    const std::vector<unsigned char>& frame = GetFrame();
+    VART::FrameCapture capture;
+    capture.SetBufferSize(FRAME_COLUMNS, FRAME_LINES);
+    capture.SetFormat(format);
+    capture.SetFileName((format == VART::FrameCapture::RAW_VIDEO) ? RAW_FILE_NAME : FILE_PREFIX);
+    for (unsigned long n = 0; n < iterations * BURST_FRAMES; ++n)
+        capture.AddFrame(&frame[0]);
+    capture.Finish();
+    Benchmark::SetCounter("render thread ms/frame", capture.GetOverhead() * 1000);
+    Benchmark::SetCounter("stalled frames %",
+                          100.0 * capture.GetNumStalls() / capture.GetNumFrames());
+    if (format == VART::FrameCapture::RAW_VIDEO)
+        std::remove(RAW_FILE_NAME);
+    else
+        RemoveFiles(capture.GetNumFrames(),
+                    (format == VART::FrameCapture::PNG_SEQUENCE) ? ".png" : ".pnm");
+}
+
+static void AsyncRaw(unsigned long iterations)
+{
+    Capture(VART::FrameCapture::RAW_VIDEO, iterations);
+}
+
+static void AsyncPNM(unsigned long iterations)
+{
+    Capture(VART::FrameCapture::PNM_SEQUENCE, iterations);
+}
+
+static void AsyncPNG(unsigned long iterations)
+{
+    Capture(VART::FrameCapture::PNG_SEQUENCE, iterations);
+}
+
+static Benchmark syncPNM("capture/sync-pnm-1080p-frame", &SyncPNM, BURST_FRAMES);
+static Benchmark asyncRaw("capture/async-raw-1080p-frame", &AsyncRaw, BURST_FRAMES);
+static Benchmark asyncPNM("capture/async-pnm-1080p-frame", &AsyncPNM, BURST_FRAMES);
+static Benchmark asyncPNG("capture/async-png-1080p-frame", &AsyncPNG, BURST_FRAMES);
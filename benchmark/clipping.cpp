@@ -0,0 +1,43 @@
+// Benchmarks for line clipping (Liang-Barsky, in the clipping program): random segments
+// against a rectangle, with a quarter of the area where they lie, so that segments are
+// kept whole, cut or discarded.
+
+#include "benchmark.h"
+#include "recorte/clip-rectangle.h"
+#include <cstdlib>
+#include <vector>
+
+const unsigned int NUM_LINES = 1024;
+
+// Returns a random coordinate in [-2, 2]
+static double RandomCoordinate()
+{
+    return static_cast<double>(rand()) / RAND_MAX * 4 - 2;
+}
+
+static void Clips(unsigned long iterations)
+{
+    static std::vector<Line> lineVec;
+    if (lineVec.empty())
+        for (unsigned int i = 0; i < NUM_LINES; ++i)
+            lineVec.push_back(Line(Point(RandomCoordinate(), RandomCoordinate()),
+                                   Point(RandomCoordinate(), RandomCoordinate())));
+    ClipRectangle rectangle(-1, 1, -1, 1);
+    unsigned int kept = 0;
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        for (unsigned int l = 0; l < NUM_LINES; ++l)
+        {
+            Line* linePtr = rectangle.Clip(lineVec[l]);
+            if (linePtr)
+            {
+                ++kept;
+                sum += linePtr->mP0.mX;
+                delete linePtr;
+            }
+        }
+    Benchmark::SetCounter("kept lines (%)", 100.0 * kept / (iterations * NUM_LINES));
+    Benchmark::Use(sum);
+}
+
+static Benchmark clips("clipping/liang-barsky-1024", &Clips, NUM_LINES);
@@ -0,0 +1,273 @@
+// Benchmarks for crowds: updating instances of an animated chain of joints (phases, poses
+// and sorting by pose) and drawing frames of them, for crowds of several sizes. Memory
+// per instance is reported as a counter. A check makes sure that baking an action leaves
+// other actions and the current scheduler alone.
+
+#include "benchmark.h"
+#include "vart/contrib/crowd.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/uniaxialjoint.h"
+#include "vart/jointaction.h"
+#include "vart/jointmover.h"
+#include "vart/linearinterpolator.h"
+#include "vart/box.h"
+#include "vart/transform.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include "vart/simulationclock.h"
+#include "vart/scheduler.h"
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+
+const unsigned int NUM_JOINTS = 20;
+const unsigned int CLIP_SAMPLES = 30;
+
+// Instances of a chain of joints, each with a box, bending back and forth. Instances are
+// placed in a square grid, with random phases and speeds, facing the camera.
+class CrowdScene {
+    public:
+        CrowdScene(unsigned int numInstances);
+        VART::Box box;
+        std::vector<VART::UniaxialJoint> joints;
+        VART::LinearInterpolator interpolator;
+        VART::JointAction action;
+        VART::Crowd crowd;
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+CrowdScene::CrowdScene(unsigned int numInstances) : joints(NUM_JOINTS)
+{
+    box.MakeBox(-0.1, 0.1, 0, 0.2, -0.1, 0.1);
+    box.SetMaterial(VART::Material::PLASTIC_GREEN());
+    for (unsigned int j = 0; j < NUM_JOINTS; ++j)
+    {
+        VART::UniaxialJoint& joint = joints[j];
+        // Each joint sits at the top of the previous box
+        float height = (j == 0) ? 0 : 0.2f;
+        joint.AddDof(VART::Point4D::Z(), VART::Point4D(0, height, 0), -0.5f, 0.5f);
+        joint.AddChild(box);
+        if (j > 0)
+            joints[j-1].AddChild(joint);
+        VART::JointMover* moverPtr = action.AddJointMover(&joint, 1.0f, interpolator);
+        moverPtr->AddDofMover(VART::Joint::FLEXION, 0.0f, 0.5f, 0.2f);
+        moverPtr->AddDofMover(VART::Joint::FLEXION, 0.5f, 1.0f, 0.8f);
+    }
+    crowd.SetModel(&joints[0]);
+    crowd.BakeAction(&action, CLIP_SAMPLES);
+    unsigned int side = static_cast<unsigned int>(ceil(sqrt(static_cast<double>(numInstances))));
+    srand(1);
+    for (unsigned int i = 0; i < numInstances; ++i)
+    {
+        VART::Transform placement;
+        placement.MakeTranslation(2.0 * (i % side) - side + 1, 2.0 * (i / side) - side, 0);
+        crowd.AddInstance(placement, 0, (rand() % 1000) / 1000.0f,
+                          0.5f + (rand() % 1000) / 1000.0f);
+    }
+    crowd.Update(0);
+    root.MakeIdentity();
+    root.AddChild(crowd);
+    camera.SetLocation(VART::Point4D(0, 0, 2.0 * side + 4));
+    camera.SetTarget(VART::Point4D::ORIGIN());
+    camera.SetUp(VART::Point4D::Y());
+    camera.SetFarPlaneDistance(4.0 * side + 8);
+    scene.AddObject(&root);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+// Advances instances by a frame at 60 frames per second
+static void Update(unsigned long iterations, CrowdScene* crowdPtr)
+{
+    for (unsigned long n = 0; n < iterations; ++n)
+        crowdPtr->crowd.Update(1.0f / 60);
+    Benchmark::SetCounter("bytes per instance", VART::Crowd::InstanceSize());
+}
+
+// The viewer is shared: its camera would stay the one of the first scene
+static VART::OffscreenViewer& GetViewer()
+{
+    static VART::OffscreenViewer viewer(640, 480);
+    return viewer;
+}
+
+// Draws frames of a crowd, reporting draw calls of the last one
+static void Draw(unsigned long iterations, CrowdScene* crowdPtr)
+{
+    VART::OffscreenViewer& viewer = GetViewer();
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    viewer.SetScene(crowdPtr->scene);
+    viewer.SetCamera(&crowdPtr->camera);
+    viewer.Run(iterations);
+    Benchmark::SetCounter("draw calls", crowdPtr->scene.GetFrameStats().GetDrawCalls());
+}
+
+static void Update100(unsigned long iterations)
+{
+    static CrowdScene crowd(100);
+    Update(iterations, &crowd);
+}
+
+static void Update1k(unsigned long iterations)
+{
+    static CrowdScene crowd(1000);
+    Update(iterations, &crowd);
+}
+
+static void Update10k(unsigned long iterations)
+{
+    static CrowdScene crowd(10000);
+    Update(iterations, &crowd);
+}
+
+static void Update100k(unsigned long iterations)
+{
+    static CrowdScene crowd(100000);
+    Update(iterations, &crowd);
+}
+
+static void Draw100(unsigned long iterations)
+{
+    static CrowdScene crowd(100);
+    Draw(iterations, &crowd);
+}
+
+static void Draw1k(unsigned long iterations)
+{
+    static CrowdScene crowd(1000);
+    Draw(iterations, &crowd);
+}
+
+static void Draw10k(unsigned long iterations)
+{
+    static CrowdScene crowd(10000);
+    Draw(iterations, &crowd);
+}
+
+// A joint action that tells when it was last moved
+class ProbedAction : public VART::JointAction {
+    public:
+        double GetLastUpdateTime() const { return lastUpdateTime.AsDouble(); }
+};
+
+// Bakes a clip while another action is active, with a deactivation scheduled within the
+// time span of the clip
+static bool CheckBakeIsolation(std::ostream& os)
+{
+    VART::Box box;
+    box.MakeBox(-0.1, 0.1, 0, 0.2, -0.1, 0.1);
+    VART::UniaxialJoint joint;
+    joint.AddDof(VART::Point4D::Z(), VART::Point4D::ORIGIN(), -0.5f, 0.5f);
+    joint.AddChild(box);
+    VART::LinearInterpolator interpolator;
+    ProbedAction other;
+    VART::JointMover* moverPtr = other.AddJointMover(&joint, 1.0f, interpolator);
+    moverPtr->AddDofMover(VART::Joint::FLEXION, 0.0f, 1.0f, 0.9f);
+    VART::SimulationClock clock;
+    clock.SetOffline(true);
+    VART::Scheduler scheduler;
+    VART::SimulationClock::SetCurrent(&clock);
+    VART::Scheduler::SetCurrent(&scheduler);
+    other.Activate();
+    static_cast<VART::BaseAction&>(other).Deactivate(0.5f);
+    for (int i = 0; i < 3; ++i)
+    {
+        clock.Update();
+        clock.Step();
+        VART::BaseAction::MoveAllActive();
+    }
+    double lastUpdateTime = other.GetLastUpdateTime();
+    VART::Matrix4 pose(joint.GetData());
+    // Bakes one second of animation
+    CrowdScene crowd(1);
+    bool passed = true;
+    if (!other.IsActive() || (scheduler.GetNumEvents() != 1))
+    {
+        os << "  baking fired the scheduled deactivation\n";
+        passed = false;
+    }
+    if (other.GetLastUpdateTime() != lastUpdateTime)
+    {
+        os << "  baking moved the other action (last update at " << other.GetLastUpdateTime()
+           << ", expected " << lastUpdateTime << ")\n";
+        passed = false;
+    }
+    for (unsigned int i = 0; i < 16; ++i)
+        if (joint.GetData()[i] != pose[i])
+        {
+            os << "  baking changed the joint of the other action\n";
+            passed = false;
+            break;
+        }
+    other.Deactivate();
+    VART::Scheduler::SetCurrent(NULL);
+    VART::SimulationClock::SetCurrent(NULL);
+    return passed;
+}
+
+// Draws a frame of a scene, reading its pixels
+static void Render(VART::Scene* scenePtr, VART::Camera* cameraPtr,
+                   std::vector<unsigned char>* pixelsPtr)
+{
+    VART::OffscreenViewer& viewer = GetViewer();
+    viewer.SetScene(*scenePtr);
+    viewer.SetCamera(cameraPtr);
+    viewer.DrawFrame();
+    viewer.ReadPixels(pixelsPtr);
+}
+
+// Draws a crowd in the live pose and the same model placed by a transform per instance;
+// images must match
+static bool CheckDrawing(std::ostream& os)
+{
+    if (!GetViewer().IsValid())
+        return true;
+    CrowdScene crowd(16);
+    std::vector<VART::Transform> placements(16);
+    VART::Transform root;
+    root.MakeIdentity();
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        crowd.crowd.SetClip(i, VART::Crowd::LIVE_CLIP, 0);
+        crowd.crowd.GetRootTransform(i, &placements[i]);
+        placements[i].AddChild(crowd.joints[0]);
+        root.AddChild(placements[i]);
+    }
+    crowd.crowd.Update(0);
+    VART::Scene scene;
+    scene.AddObject(&root);
+    scene.AddCamera(&crowd.camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+    std::vector<unsigned char> crowdPixels;
+    std::vector<unsigned char> expected;
+    Render(&crowd.scene, &crowd.camera, &crowdPixels);
+    Render(&scene, &crowd.camera, &expected);
+    unsigned int numDifferent = 0;
+    for (unsigned int i = 0; i < expected.size(); ++i)
+        if (std::abs(crowdPixels[i] - expected[i]) > 2)
+            ++numDifferent;
+    if (numDifferent > 0)
+    {
+        os << "  " << numDifferent << " of " << expected.size()
+           << " channels differ from the model\n";
+        return false;
+    }
+    return true;
+}
+
+static Benchmark update100("crowd/update-100", &Update100, 100);
+static Benchmark update1k("crowd/update-1k", &Update1k, 1000);
+static Benchmark update10k("crowd/update-10k", &Update10k, 10000);
+static Benchmark update100k("crowd/update-100k", &Update100k, 100000);
+static Benchmark draw100("crowd/draw-100", &Draw100, 100);
+static Benchmark draw1k("crowd/draw-1k", &Draw1k, 1000);
+static Benchmark draw10k("crowd/draw-10k", &Draw10k, 10000);
+static Check bakeIsolation("crowd/bake-isolation", &CheckBakeIsolation);
+static Check drawing("crowd/draw-like-model", &CheckDrawing);
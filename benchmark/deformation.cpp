@@ -0,0 +1,229 @@
+// Benchmarks for deformable meshes: a ripple moving over part of a 1M-vertex field, applied
+// with UpdateVertices (which recomputes only normals around moved vertices and refits the
+// bounding box from blocks), against SetVertex followed by ComputeVertexNormals and
+// ComputeBoundingBox over the whole mesh, as deformations were made before (reproduced
+// here as "full" cases). Frame cases also draw the field, showing the bytes re-uploaded.
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/meshobject.h"
+#include "vart/framestats.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include <cmath>
+#include <vector>
+
+const unsigned int NUM_SAMPLES = 1000; // along each side: 1M vertices
+
+// The field: a strip per row of cells
+class DeformedField : public VART::MeshObject {
+    public:
+        DeformedField();
+};
+
+DeformedField::DeformedField()
+{
+    vertCoordVec.reserve(NUM_SAMPLES * NUM_SAMPLES * 3);
+    for (unsigned int i = 0; i < NUM_SAMPLES; ++i)
+        for (unsigned int j = 0; j < NUM_SAMPLES; ++j)
+        {
+            vertCoordVec.push_back(j);
+            vertCoordVec.push_back(0);
+            vertCoordVec.push_back(i);
+        }
+    for (unsigned int i = 0; i + 1 < NUM_SAMPLES; ++i)
+    {
+        VART::Mesh strip;
+        strip.type = VART::Mesh::TRIANGLE_STRIP;
+        strip.material = VART::Material::PLASTIC_GREEN();
+        for (unsigned int j = 0; j < NUM_SAMPLES; ++j)
+        {
+            strip.indexVec.push_back((i + 1) * NUM_SAMPLES + j);
+            strip.indexVec.push_back(i * NUM_SAMPLES + j);
+        }
+        meshList.push_back(strip);
+    }
+    ComputeVertexNormals();
+    ComputeBoundingBox();
+}
+
+// A ripple over a square patch covering a fraction of the field. The patch moves along the
+// diagonal at every frame.
+class Ripple {
+    public:
+        Ripple(double fraction);
+        // Computes indices and coordinates of the next frame
+        void Next();
+        std::vector<unsigned int> indexVec;
+        std::vector<double> coordVec;
+    private:
+        unsigned int side;
+        unsigned int frame;
+};
+
+Ripple::Ripple(double fraction)
+    : side(static_cast<unsigned int>(sqrt(fraction) * NUM_SAMPLES)), frame(0)
+{
+}
+
+void Ripple::Next()
+{
+    unsigned int corner = (frame * side / 4) % (NUM_SAMPLES - side);
+    double phase = frame * 0.5;
+    indexVec.clear();
+    coordVec.clear();
+    for (unsigned int i = 0; i < side; ++i)
+        for (unsigned int j = 0; j < side; ++j)
+        {
+            double x = j - side / 2.0;
+            double z = i - side / 2.0;
+            indexVec.push_back((corner + i) * NUM_SAMPLES + corner + j);
+            coordVec.push_back(corner + j);
+            coordVec.push_back(2 * sin(0.3 * sqrt(x * x + z * z) - phase));
+            coordVec.push_back(corner + i);
+        }
+    ++frame;
+}
+
+// Moves vertices one by one, then computes all normals and the bounding box
+static void FullUpdate(DeformedField* fieldPtr, const Ripple& ripple)
+{
+    for (unsigned int i = 0; i < ripple.indexVec.size(); ++i)
+        fieldPtr->SetVertex(ripple.indexVec[i],
+                            VART::Point4D(ripple.coordVec[i * 3], ripple.coordVec[i * 3 + 1],
+                                          ripple.coordVec[i * 3 + 2]));
+    fieldPtr->ComputeVertexNormals();
+    fieldPtr->ComputeBoundingBox();
+}
+
+static DeformedField* Field()
+{
+    static DeformedField field;
+    return &field;
+}
+
+static void Full(unsigned long iterations, Ripple* ripplePtr)
+{
+    DeformedField* fieldPtr = Field();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        ripplePtr->Next();
+        FullUpdate(fieldPtr, *ripplePtr);
+    }
+    Benchmark::Use(fieldPtr->GetBoundingBox().GetGreaterY());
+}
+
+// Moves vertices with UpdateVertices, reporting dirty ranges of the last iteration
+static void Batch(unsigned long iterations, Ripple* ripplePtr)
+{
+    DeformedField* fieldPtr = Field();
+    std::vector<std::pair<unsigned int, unsigned int> > rangeVec;
+    unsigned long dirty = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        ripplePtr->Next();
+        fieldPtr->UpdateVertices(&ripplePtr->indexVec[0], ripplePtr->indexVec.size(),
+                                 &ripplePtr->coordVec[0]);
+        fieldPtr->GetDirtyRanges(&rangeVec);
+        fieldPtr->ClearDirtyRanges();
+    }
+    for (unsigned int i = 0; i < rangeVec.size(); ++i)
+        dirty += rangeVec[i].second;
+    Benchmark::Use(fieldPtr->GetBoundingBox().GetGreaterY());
+    Benchmark::SetCounter("dirty ranges", rangeVec.size());
+    Benchmark::SetCounter("dirty vertices", dirty);
+}
+
+// The field seen from above, with a viewer shared by frame cases
+class FieldView {
+    public:
+        FieldView();
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+FieldView::FieldView()
+    : camera(VART::Point4D(-50, 300, -50), VART::Point4D(NUM_SAMPLES / 2.0, 0, NUM_SAMPLES / 2.0),
+             VART::Point4D::Y())
+{
+    camera.SetFarPlaneDistance(2.0 * NUM_SAMPLES);
+    scene.AddObject(Field());
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::SUN());
+}
+
+// Deforms and draws frames, reporting vertex data sent in the last one
+static void Frame(unsigned long iterations, Ripple* ripplePtr, bool partial)
+{
+    static VART::OffscreenViewer viewer(640, 480);
+    static FieldView view;
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    viewer.SetScene(view.scene);
+    viewer.SetCamera(&view.camera);
+    DeformedField* fieldPtr = Field();
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        ripplePtr->Next();
+        if (partial)
+            fieldPtr->UpdateVertices(&ripplePtr->indexVec[0], ripplePtr->indexVec.size(),
+                                     &ripplePtr->coordVec[0]);
+        else
+            FullUpdate(fieldPtr, *ripplePtr);
+        viewer.Run(1);
+    }
+    Benchmark::SetCounter("vertex MB", view.scene.GetFrameStats().vertexBytes / 1048576.0);
+}
+
+static void Full1(unsigned long iterations)
+{
+    static Ripple ripple(0.01);
+    Full(iterations, &ripple);
+}
+
+static void Full10(unsigned long iterations)
+{
+    static Ripple ripple(0.1);
+    Full(iterations, &ripple);
+}
+
+static void Batch1(unsigned long iterations)
+{
+    static Ripple ripple(0.01);
+    Batch(iterations, &ripple);
+}
+
+static void Batch5(unsigned long iterations)
+{
+    static Ripple ripple(0.05);
+    Batch(iterations, &ripple);
+}
+
+static void Batch10(unsigned long iterations)
+{
+    static Ripple ripple(0.1);
+    Batch(iterations, &ripple);
+}
+
+static void FrameFull5(unsigned long iterations)
+{
+    static Ripple ripple(0.05);
+    Frame(iterations, &ripple, false);
+}
+
+static void FramePartial5(unsigned long iterations)
+{
+    static Ripple ripple(0.05);
+    Frame(iterations, &ripple, true);
+}
+
+static Benchmark full1("deformation/full-1pct", &Full1, 10000);
+static Benchmark full10("deformation/full-10pct", &Full10, 100000);
+static Benchmark batch1("deformation/batch-1pct", &Batch1, 10000);
+static Benchmark batch5("deformation/batch-5pct", &Batch5, 50000);
+static Benchmark batch10("deformation/batch-10pct", &Batch10, 100000);
+static Benchmark frameFull5("deformation/frame-full-5pct", &FrameFull5, 50000);
+static Benchmark framePartial5("deformation/frame-partial-5pct", &FramePartial5, 50000);
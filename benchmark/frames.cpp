@@ -0,0 +1,212 @@
+// Benchmarks for whole frames of generated scenes (see SceneGenerator), far larger than the
+// demos: each iteration plays the same fixed-length animation from its start, headless,
+// timing its phases (update, bounding boxes, traversal and drawing through OffscreenViewer).
+// Counters report milliseconds per frame of each phase, resident memory taken by the scene
+// and triangles drawn per second. The same scenes are written as XML and OBJ files, to
+// measure loading them. Frames of the larger scenes take seconds per sample, so run them
+// with few samples ("make frames").
+
+#include "benchmark.h"
+#include "scenegenerator.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/scene.h"
+#include "vart/camera.h"
+#include "vart/graphicobj.h"
+#include "vart/collector.h"
+#include "vart/time.h"
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <list>
+#include <cstdlib>
+#include <malloc.h>
+
+// Frames of the animation (one second)
+const unsigned int NUM_FRAMES = 60;
+const double STEP = 1.0 / NUM_FRAMES;
+const char* const SKELETON_DIRECTORY = "skeleton5b";
+
+// Silences progress messages of the OBJ reader while alive
+class Quiet {
+    public:
+        Quiet() : coutBuf(std::cout.rdbuf(NULL)), clogBuf(std::clog.rdbuf(NULL)) {}
+        ~Quiet() { std::cout.rdbuf(coutBuf); std::clog.rdbuf(clogBuf); }
+    private:
+        std::streambuf* coutBuf;
+        std::streambuf* clogBuf;
+};
+
+// Returns the resident set size in MB (zero if not available)
+static double ResidentMB()
+{
+    malloc_trim(0);
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            return std::atof(line.c_str() + 6) / 1024;
+    return 0;
+}
+
+// A generated scene, built at first use, with a camera that sees all of it
+class GeneratedScene {
+    public:
+        GeneratedScene(const SceneGenerator::Parameters& params, const char* prefix);
+        SceneGenerator generator;
+        VART::Scene scene;
+        VART::Camera camera;
+        bool valid;
+        double residentMB;
+};
+
+GeneratedScene::GeneratedScene(const SceneGenerator::Parameters& params, const char* prefix)
+    : generator(params, SKELETON_DIRECTORY, prefix)
+{
+    Quiet quiet;
+    double before = ResidentMB();
+    valid = generator.Build(&scene);
+    residentMB = ResidentMB() - before;
+    if (!valid)
+        return;
+    const VART::BoundingBox& box = generator.ComputeBoundingBox();
+    double size = box.GetGreaterEdge();
+    const VART::Point4D& center = box.GetCenter();
+    camera.SetLocation(center + VART::Point4D(0, size * 0.6, -size * 0.8, 0));
+    camera.SetTarget(center);
+    camera.SetUp(VART::Point4D::Y());
+    camera.SetFarPlaneDistance(size * 3);
+    scene.AddCamera(&camera);
+}
+
+// Plays the animation of a scene, frame by frame, timing its phases
+static void Animate(unsigned long iterations, GeneratedScene* scenePtr)
+{
+    static VART::OffscreenViewer viewer(640, 480);
+    if (!scenePtr->valid)
+    {
+        Benchmark::SetCounter("no scene", 1);
+        return;
+    }
+    bool draw = viewer.IsValid();
+    if (draw)
+    {
+        viewer.SetScene(scenePtr->scene);
+        viewer.SetCamera(&scenePtr->camera);
+    }
+    // Seconds spent in each phase
+    double phases[4] = { 0, 0, 0, 0 };
+    VART::Time times[5];
+    unsigned long numGathered = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        scenePtr->generator.Rewind();
+        for (unsigned int frame = 0; frame < NUM_FRAMES; ++frame)
+        {
+            times[0].SetMonotonic();
+            scenePtr->generator.Update(STEP);
+            times[1].SetMonotonic();
+            scenePtr->generator.ComputeBoundingBox();
+            times[2].SetMonotonic();
+            // Graphic objects to draw, as a culling pass would gather them
+            VART::Collector<VART::GraphicObj> gatherer;
+            scenePtr->generator.GetRoot().TraverseDepthFirst(&gatherer);
+            numGathered = gatherer.size();
+            times[3].SetMonotonic();
+            if (draw)
+                viewer.Run(1);
+            times[4].SetMonotonic();
+            for (unsigned int p = 0; p < 4; ++p)
+                phases[p] += (times[p+1] - times[p]).AsDouble();
+        }
+    }
+    static const char* NAMES[] = { "update ms/frame", "bounds ms/frame",
+                                   "traversal ms/frame", "draw ms/frame" };
+    double numFrames = static_cast<double>(iterations) * NUM_FRAMES;
+    for (unsigned int p = 0; p < 4; ++p)
+        Benchmark::SetCounter(NAMES[p], phases[p] * 1000 / numFrames);
+    Benchmark::SetCounter("nodes", scenePtr->generator.GetNumNodes());
+    Benchmark::SetCounter("graphic objects traversed", numGathered);
+    Benchmark::SetCounter("scene MB", scenePtr->residentMB);
+    if (draw)
+        Benchmark::SetCounter("Mtriangles/s drawn", scenePtr->generator.GetNumTriangles()
+                                                      * numFrames / phases[3] / 1e6);
+    else
+        Benchmark::SetCounter("no OpenGL context", 1);
+}
+
+// Objects, depth, meshes, triangles per mesh, skeletons and lights of each size
+static SceneGenerator::Parameters SMALL(1000, 3, 8, 200, 16, 2);
+static SceneGenerator::Parameters MEDIUM(10000, 4, 32, 200, 64, 4);
+static SceneGenerator::Parameters LARGE(100000, 6, 64, 48, 256, 8);
+
+static void FrameSmall(unsigned long iterations)
+{
+    static GeneratedScene scene(SMALL, "frames_small_");
+    Animate(iterations, &scene);
+}
+
+static void FrameMedium(unsigned long iterations)
+{
+    static GeneratedScene scene(MEDIUM, "frames_medium_");
+    Animate(iterations, &scene);
+}
+
+static void FrameLarge(unsigned long iterations)
+{
+    static GeneratedScene scene(LARGE, "frames_large_");
+    Animate(iterations, &scene);
+}
+
+// A generated scene written as files
+class GeneratedFiles {
+    public:
+        GeneratedFiles(const SceneGenerator::Parameters& params, const char* prefix);
+        SceneGenerator generator;
+        VART::Scene scene;
+        std::string fileName;
+};
+
+GeneratedFiles::GeneratedFiles(const SceneGenerator::Parameters& params, const char* prefix)
+    : generator(params, SKELETON_DIRECTORY, prefix)
+{
+    Quiet quiet;
+    if (!generator.Build(&scene) || !generator.WriteXML(&fileName))
+        fileName.clear();
+}
+
+// Loads a scene from its XML file, reporting the size of the file
+static void Load(unsigned long iterations, const GeneratedFiles& files)
+{
+    if (files.fileName.empty())
+    {
+        Benchmark::SetCounter("no scene", 1);
+        return;
+    }
+    Quiet quiet;
+    unsigned int numNodes = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        VART::XmlStreamScene loaded;
+        loaded.LoadFromFile(files.fileName);
+        VART::Collector<VART::SceneNode> collector;
+        std::list<VART::SceneNode*> objects = loaded.GetObjects();
+        std::list<VART::SceneNode*>::iterator iter = objects.begin();
+        for (; iter != objects.end(); ++iter)
+            (*iter)->TraverseDepthFirst(&collector);
+        numNodes = collector.size();
+    }
+    Benchmark::SetCounter("nodes loaded", numNodes);
+    std::ifstream file(files.fileName.c_str(), std::ios::ate);
+    Benchmark::SetCounter("scene file MB", file.tellg() / 1048576.0);
+}
+
+static void LoadMedium(unsigned long iterations)
+{
+    static GeneratedFiles files(MEDIUM, "frames_load_");
+    Load(iterations, files);
+}
+
+static Benchmark frameSmall("frame/small-1k-objects", &FrameSmall, NUM_FRAMES);
+static Benchmark frameMedium("frame/medium-10k-objects", &FrameMedium, NUM_FRAMES);
+static Benchmark frameLarge("frame/large-100k-objects", &FrameLarge, NUM_FRAMES);
+static Benchmark loadMedium("frame/load-xml-medium-10k-objects", &LoadMedium, 1);
@@ -0,0 +1,83 @@
+// Benchmarks for frame statistics: counts of a drawn frame and their CSV output.
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/framestats.h"
+#include "vart/box.h"
+#include "vart/transform.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include <sstream>
+
+const unsigned int GRID_SIZE = 20;
+
+// A grid of boxes, drawn with vertex arrays
+class BoxesScene {
+    public:
+        BoxesScene();
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+BoxesScene::BoxesScene()
+    : camera(VART::Point4D(0, 0, 50), VART::Point4D::ORIGIN(), VART::Point4D::Y())
+{
+    root.MakeIdentity();
+    for (unsigned int i = 0; i < GRID_SIZE; ++i)
+        for (unsigned int j = 0; j < GRID_SIZE; ++j)
+        {
+            VART::Transform* transPtr = new VART::Transform;
+            transPtr->MakeTranslation(2.0 * i - GRID_SIZE + 1, 2.0 * j - GRID_SIZE + 1, 0);
+            transPtr->autoDelete = true;
+            VART::Box* boxPtr = new VART::Box;
+            boxPtr->MakeBox(-0.8, 0.8, -0.8, 0.8, -0.8, 0.8);
+            boxPtr->SetMaterial(VART::Material::PLASTIC_GREEN());
+            boxPtr->autoDelete = true;
+            transPtr->AddChild(*boxPtr);
+            root.AddChild(*transPtr);
+        }
+    scene.AddObject(&root);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+// Draws frames, reporting counts of the last one
+static void Frame(unsigned long iterations)
+{
+    static BoxesScene boxes;
+    static VART::OffscreenViewer viewer(320, 240);
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    if (viewer.GetFrameCount() == 0)
+        viewer.SetScene(boxes.scene);
+    viewer.Run(iterations);
+    const VART::FrameStats& stats = boxes.scene.GetFrameStats();
+    Benchmark::SetCounter("nodes visited", stats.nodesVisited);
+    Benchmark::SetCounter("draw calls", stats.GetDrawCalls());
+    Benchmark::SetCounter("triangles", stats.GetTriangles());
+    Benchmark::SetCounter("material binds", stats.materialBinds);
+    Benchmark::SetCounter("transforms pushed", stats.transformsPushed);
+    Benchmark::SetCounter("vertex bytes", stats.vertexBytes);
+}
+
+// Writes a CSV row of counts
+static void WriteCSV(unsigned long iterations)
+{
+    VART::FrameStats stats;
+    stats.nodesVisited = 801;
+    stats.drawCalls[VART::Mesh::QUADS] = 400;
+    stats.indices[VART::Mesh::QUADS] = 9600;
+    std::ostringstream stream;
+    VART::FrameStats::WriteCSVHeader(stream);
+    for (unsigned long i = 0; i < iterations; ++i)
+        stats.WriteCSV(stream, i);
+    Benchmark::Use(stream.str().size());
+}
+
+static Benchmark frame("framestats/frame-400-boxes", &Frame, 1);
+static Benchmark writeCSV("framestats/write-csv-row", &WriteCSV, 1);
@@ -0,0 +1,144 @@
+// Benchmarks for instance groups: frames with many copies of a mesh object, drawn as a
+// transform per copy (as scenes did before instance groups), with an instance group
+// drawing instances one by one, and with hardware instancing.
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/instancegroup.h"
+#include "vart/framestats.h"
+#include "vart/box.h"
+#include "vart/transform.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include <cmath>
+
+// Copies of a box in a square grid, facing the camera
+class CopiesScene {
+    public:
+        CopiesScene(unsigned int numCopies, bool grouped);
+        VART::Box box;
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::InstanceGroup group;
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+CopiesScene::CopiesScene(unsigned int numCopies, bool grouped)
+    : group(box)
+{
+    unsigned int side = static_cast<unsigned int>(ceil(sqrt(static_cast<double>(numCopies))));
+    box.MakeBox(-0.6, 0.6, -0.6, 0.6, -0.6, 0.6);
+    box.SetMaterial(VART::Material::PLASTIC_GREEN());
+    root.MakeIdentity();
+    for (unsigned int i = 0; i < numCopies; ++i)
+    {
+        VART::Transform trans;
+        trans.MakeTranslation(2.0 * (i % side) - side + 1, 2.0 * (i / side) - side + 1, 0);
+        if (grouped)
+            group.AddInstance(trans.GetMatrix());
+        else
+        {
+            VART::Transform* transPtr = new VART::Transform(trans);
+            transPtr->autoDelete = true;
+            transPtr->AddChild(box);
+            root.AddChild(*transPtr);
+        }
+    }
+    if (grouped)
+        root.AddChild(group);
+    camera.SetLocation(VART::Point4D(0, 0, 2.0 * side));
+    camera.SetTarget(VART::Point4D::ORIGIN());
+    camera.SetUp(VART::Point4D::Y());
+    camera.SetFarPlaneDistance(4.0 * side);
+    scene.AddObject(&root);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+// Draws frames of a scene, reporting draw calls of the last one
+static void Frame(unsigned long iterations, CopiesScene* copiesPtr, bool instancing)
+{
+    static VART::OffscreenViewer viewer(640, 480);
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    if (instancing && !VART::InstanceGroup::IsInstancingAvailable())
+    {
+        Benchmark::SetCounter("no instancing", 1);
+        return;
+    }
+    // The viewer is shared: its camera would stay the one of the first scene
+    viewer.SetScene(copiesPtr->scene);
+    viewer.SetCamera(&copiesPtr->camera);
+    VART::InstanceGroup::SetInstancing(instancing);
+    viewer.Run(iterations);
+    VART::InstanceGroup::SetInstancing(true);
+    Benchmark::SetCounter("draw calls", copiesPtr->scene.GetFrameStats().GetDrawCalls());
+}
+
+static void Transforms10(unsigned long iterations)
+{
+    static CopiesScene copies(10, false);
+    Frame(iterations, &copies, false);
+}
+
+static void OneByOne10(unsigned long iterations)
+{
+    static CopiesScene copies(10, true);
+    Frame(iterations, &copies, false);
+}
+
+static void Instanced10(unsigned long iterations)
+{
+    static CopiesScene copies(10, true);
+    Frame(iterations, &copies, true);
+}
+
+static void Transforms1k(unsigned long iterations)
+{
+    static CopiesScene copies(1000, false);
+    Frame(iterations, &copies, false);
+}
+
+static void OneByOne1k(unsigned long iterations)
+{
+    static CopiesScene copies(1000, true);
+    Frame(iterations, &copies, false);
+}
+
+static void Instanced1k(unsigned long iterations)
+{
+    static CopiesScene copies(1000, true);
+    Frame(iterations, &copies, true);
+}
+
+static void Transforms100k(unsigned long iterations)
+{
+    static CopiesScene copies(100000, false);
+    Frame(iterations, &copies, false);
+}
+
+static void OneByOne100k(unsigned long iterations)
+{
+    static CopiesScene copies(100000, true);
+    Frame(iterations, &copies, false);
+}
+
+static void Instanced100k(unsigned long iterations)
+{
+    static CopiesScene copies(100000, true);
+    Frame(iterations, &copies, true);
+}
+
+static Benchmark transforms10("instancing/transforms-10", &Transforms10, 10);
+static Benchmark oneByOne10("instancing/one-by-one-10", &OneByOne10, 10);
+static Benchmark instanced10("instancing/instanced-10", &Instanced10, 10);
+static Benchmark transforms1k("instancing/transforms-1k", &Transforms1k, 1000);
+static Benchmark oneByOne1k("instancing/one-by-one-1k", &OneByOne1k, 1000);
+static Benchmark instanced1k("instancing/instanced-1k", &Instanced1k, 1000);
+static Benchmark transforms100k("instancing/transforms-100k", &Transforms100k, 100000);
+static Benchmark oneByOne100k("instancing/one-by-one-100k", &OneByOne100k, 100000);
+static Benchmark instanced100k("instancing/instanced-100k", &Instanced100k, 100000);
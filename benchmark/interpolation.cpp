@@ -0,0 +1,116 @@
+// Benchmarks for interpolators and curves.
+//
+// Each case evaluates a track of 1024 samples, either one value at a time through the
+// virtual GetValue/GetPoint (as DofMover and Dof do) or with the array methods.
+// NaturalInterpolator is left out: its implementation file does not compile.
+
+#include "benchmark.h"
+#include "vart/linearinterpolator.h"
+#include "vart/sineinterpolator.h"
+#include "vart/rangesineinterpolator.h"
+#include "vart/hermiteinterpolator.h"
+#include "vart/bezier.h"
+
+const unsigned int TRACK_SIZE = 1024;
+
+static float indices[TRACK_SIZE];
+static float values[TRACK_SIZE];
+static double params[TRACK_SIZE];
+static VART::Point4D points[TRACK_SIZE];
+
+static VART::LinearInterpolator linear;
+static VART::SineInterpolator sine;
+static VART::RangeSineInterpolator rangeSine;
+static VART::HermiteInterpolator hermite(1.0f, 1.0f);
+static VART::Bezier bezier;
+
+// Fills input arrays and configures interpolators and curves
+static bool Initialize()
+{
+    for (unsigned int i = 0; i < TRACK_SIZE; ++i)
+    {
+        indices[i] = static_cast<float>(i) / (TRACK_SIZE - 1);
+        params[i] = indices[i];
+    }
+    rangeSine.SetMinimunLimit(0.2f);
+    rangeSine.SetMaximunLimit(0.8f);
+    hermite.AddControlPosition(0.7f, 0.25f);
+    hermite.AddControlPosition(-0.3f, 0.5f);
+    hermite.AddControlPosition(0.4f, 0.75f);
+    hermite.SetInitialPosition(0.0f);
+    bezier.SetControlPoint(0, VART::Point4D(0, 0, 0));
+    bezier.SetControlPoint(1, VART::Point4D(1, 2, 0));
+    bezier.SetControlPoint(2, VART::Point4D(3, -1, 1));
+    bezier.SetControlPoint(3, VART::Point4D(4, 0, 2));
+    return true;
+}
+
+static bool initialized = Initialize();
+
+static void Scalar(const VART::Interpolator& interpolator, unsigned long iterations)
+{
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        for (unsigned int i = 0; i < TRACK_SIZE; ++i)
+            values[i] = interpolator.GetValue(indices[i], 0.1f, 0.5f);
+        Benchmark::Use(values[n % TRACK_SIZE]);
+    }
+}
+
+static void Batch(const VART::Interpolator& interpolator, unsigned long iterations)
+{
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        interpolator.GetValues(indices, TRACK_SIZE, 0.1f, 0.5f, values);
+        Benchmark::Use(values[n % TRACK_SIZE]);
+    }
+}
+
+static void LinearScalar(unsigned long iterations) { Scalar(linear, iterations); }
+static void LinearBatch(unsigned long iterations) { Batch(linear, iterations); }
+static void SineScalar(unsigned long iterations) { Scalar(sine, iterations); }
+static void SineBatch(unsigned long iterations) { Batch(sine, iterations); }
+static void RangeSineScalar(unsigned long iterations) { Scalar(rangeSine, iterations); }
+static void RangeSineBatch(unsigned long iterations) { Batch(rangeSine, iterations); }
+static void HermiteScalar(unsigned long iterations) { Scalar(hermite, iterations); }
+static void HermiteBatch(unsigned long iterations) { Batch(hermite, iterations); }
+
+static void BezierScalar(unsigned long iterations)
+{
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        for (unsigned int i = 0; i < TRACK_SIZE; ++i)
+            bezier.GetPoint(params[i], points + i);
+        Benchmark::Use(points[n % TRACK_SIZE].GetX());
+    }
+}
+
+static void BezierBatch(unsigned long iterations)
+{
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        bezier.GetPoints(params, TRACK_SIZE, points);
+        Benchmark::Use(points[n % TRACK_SIZE].GetX());
+    }
+}
+
+static void BezierUniform(unsigned long iterations)
+{
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        bezier.GetUniformPoints(0.0, 1.0, TRACK_SIZE, points);
+        Benchmark::Use(points[n % TRACK_SIZE].GetX());
+    }
+}
+
+static Benchmark b1("interpolator/linear/scalar", &LinearScalar, TRACK_SIZE);
+static Benchmark b2("interpolator/linear/batch", &LinearBatch, TRACK_SIZE);
+static Benchmark b3("interpolator/sine/scalar", &SineScalar, TRACK_SIZE);
+static Benchmark b4("interpolator/sine/batch", &SineBatch, TRACK_SIZE);
+static Benchmark b5("interpolator/rangesine/scalar", &RangeSineScalar, TRACK_SIZE);
+static Benchmark b6("interpolator/rangesine/batch", &RangeSineBatch, TRACK_SIZE);
+static Benchmark b7("interpolator/hermite/scalar", &HermiteScalar, TRACK_SIZE);
+static Benchmark b8("interpolator/hermite/batch", &HermiteBatch, TRACK_SIZE);
+static Benchmark b9("curve/bezier/scalar", &BezierScalar, TRACK_SIZE);
+static Benchmark b10("curve/bezier/batch", &BezierBatch, TRACK_SIZE);
+static Benchmark b11("curve/bezier/uniform", &BezierUniform, TRACK_SIZE);
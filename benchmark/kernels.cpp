@@ -0,0 +1,192 @@
+// Benchmarks for small core kernels not covered elsewhere: Point4D math, merging bounding
+// boxes and traversals of a scene graph (operators, locators and recursive bounding boxes).
+// Transforms, mesh objects, interpolators, OBJ parsing and DOFs have groups of their own
+// (matrices, meshes, interpolator, mesh and pose).
+
+#include "benchmark.h"
+#include "vart/point4d.h"
+#include "vart/boundingbox.h"
+#include "vart/transform.h"
+#include "vart/box.h"
+#include "vart/snoperator.h"
+#include "vart/descriptionlocator.h"
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+const unsigned int NUM_VECTORS = 1024;
+// The scene graph has BRANCHES children per transform, LEVELS levels deep
+const unsigned int BRANCHES = 16;
+const unsigned int LEVELS = 3;
+const unsigned int NUM_TRANSFORMS = BRANCHES + BRANCHES * BRANCHES
+                                    + BRANCHES * BRANCHES * BRANCHES;
+
+// Random vectors and boxes
+class Vectors {
+    public:
+        Vectors();
+        std::vector<VART::Point4D> vectorVec;
+        std::vector<VART::BoundingBox> boxVec;
+};
+
+Vectors::Vectors() : vectorVec(NUM_VECTORS), boxVec(NUM_VECTORS)
+{
+    for (unsigned int i = 0; i < NUM_VECTORS; ++i)
+    {
+        double x = static_cast<double>(rand()) / RAND_MAX - 0.5;
+        double y = static_cast<double>(rand()) / RAND_MAX - 0.5;
+        double z = static_cast<double>(rand()) / RAND_MAX - 0.5;
+        vectorVec[i].SetXYZW(x, y, z, 0);
+        boxVec[i].SetBoundingBox(x * 100, y * 100, z * 100, x * 100 + 1, y * 100 + 2,
+                                 z * 100 + 3);
+    }
+}
+
+static Vectors vectors;
+
+static void DotProducts(unsigned long iterations)
+{
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        for (unsigned int v = 1; v < NUM_VECTORS; ++v)
+            sum += vectors.vectorVec[v].DotProduct(vectors.vectorVec[v - 1]);
+    Benchmark::Use(sum);
+}
+
+static void CrossProducts(unsigned long iterations)
+{
+    VART::Point4D sum(0, 0, 0, 0);
+    for (unsigned long i = 0; i < iterations; ++i)
+        for (unsigned int v = 1; v < NUM_VECTORS; ++v)
+            sum += vectors.vectorVec[v].CrossProduct(vectors.vectorVec[v - 1]);
+    Benchmark::Use(sum.GetX());
+}
+
+static void Normalizations(unsigned long iterations)
+{
+    VART::Point4D vector;
+    for (unsigned long i = 0; i < iterations; ++i)
+        for (unsigned int v = 0; v < NUM_VECTORS; ++v)
+        {
+            vector = vectors.vectorVec[v];
+            vector.Normalize();
+        }
+    Benchmark::Use(vector.GetX());
+}
+
+// Sums of scaled vectors, as in integrating positions
+static void Arithmetic(unsigned long iterations)
+{
+    VART::Point4D sum(0, 0, 0, 0);
+    for (unsigned long i = 0; i < iterations; ++i)
+        for (unsigned int v = 0; v < NUM_VECTORS; ++v)
+            sum = sum + vectors.vectorVec[v] * 0.5;
+    Benchmark::Use(sum.GetX());
+}
+
+static void Merges(unsigned long iterations)
+{
+    VART::BoundingBox box;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        box = vectors.boxVec[0];
+        for (unsigned int b = 1; b < NUM_VECTORS; ++b)
+            box.MergeWith(vectors.boxVec[b]);
+    }
+    Benchmark::Use(box.GetGreaterX());
+}
+
+// A tree of transforms, with a box (shared by all of them) under those of the last level
+class Graph {
+    public:
+        Graph();
+        VART::Transform root;
+        std::vector<VART::Transform> transformVec;
+        VART::Box box;
+        // Description of the last transform, the last one found by searches
+        std::string lastDescription;
+};
+
+Graph::Graph() : transformVec(NUM_TRANSFORMS)
+{
+    box.MakeBox(-0.5, 0.5, -0.5, 0.5, -0.5, 0.5);
+    unsigned int first = 0; // first transform of the current level
+    unsigned int count = BRANCHES; // transforms in the current level
+    for (unsigned int level = 0; level < LEVELS; ++level)
+    {
+        for (unsigned int i = first; i < first + count; ++i)
+        {
+            std::ostringstream description;
+            description << "transform" << i;
+            transformVec[i].SetDescription(description.str());
+            transformVec[i].MakeTranslation((i % BRANCHES) * 2.0, level, 0);
+            if (level == 0)
+                root.AddChild(transformVec[i]);
+            else
+                transformVec[(i - BRANCHES) / BRANCHES].AddChild(transformVec[i]);
+            if (level == LEVELS - 1)
+                transformVec[i].AddChild(box);
+        }
+        first += count;
+        count *= BRANCHES;
+    }
+    lastDescription = transformVec.back().GetDescription();
+}
+
+static Graph graph;
+
+// Counts nodes, as operators that gather nodes do
+class NodeCounter : public VART::SNOperator {
+    public:
+        NodeCounter() : count(0) {}
+        virtual void OperateOn(const VART::SceneNode* nodePtr) { ++count; }
+        unsigned int count;
+};
+
+static void DepthFirst(unsigned long iterations)
+{
+    NodeCounter counter;
+    for (unsigned long i = 0; i < iterations; ++i)
+        graph.root.TraverseDepthFirst(&counter);
+    Benchmark::Use(counter.count);
+}
+
+static void BreadthFirst(unsigned long iterations)
+{
+    NodeCounter counter;
+    for (unsigned long i = 0; i < iterations; ++i)
+        graph.root.TraverseBreadthFirst(&counter);
+    Benchmark::Use(counter.count);
+}
+
+// Searches for the last transform, visiting the whole graph
+static void Locate(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        VART::DescriptionLocator locator(graph.lastDescription);
+        graph.root.LocateDepthFirst(&locator);
+        Benchmark::Use(locator.LocatedNode() != NULL);
+    }
+}
+
+static void RecursiveBoundingBoxes(unsigned long iterations)
+{
+    VART::BoundingBox box;
+    for (unsigned long i = 0; i < iterations; ++i)
+        graph.root.RecursiveBoundingBox(&box);
+    Benchmark::Use(box.GetGreaterX());
+}
+
+static Benchmark dotProducts("point4d/dot-product-1024", &DotProducts, NUM_VECTORS - 1);
+static Benchmark crossProducts("point4d/cross-product-1024", &CrossProducts, NUM_VECTORS - 1);
+static Benchmark normalizations("point4d/normalize-1024", &Normalizations, NUM_VECTORS);
+static Benchmark arithmetic("point4d/scale-add-1024", &Arithmetic, NUM_VECTORS);
+static Benchmark merges("bounding-box/merge-1024", &Merges, NUM_VECTORS - 1);
+static Benchmark depthFirst("scene-graph/traverse-depth-first-4368nodes", &DepthFirst,
+                            NUM_TRANSFORMS);
+static Benchmark breadthFirst("scene-graph/traverse-breadth-first-4368nodes", &BreadthFirst,
+                              NUM_TRANSFORMS);
+static Benchmark locate("scene-graph/locate-description-4368nodes", &Locate, NUM_TRANSFORMS);
+static Benchmark recursiveBoundingBoxes("scene-graph/recursive-bounding-box-4368nodes",
+                                        &RecursiveBoundingBoxes, NUM_TRANSFORMS);
@@ -0,0 +1,275 @@
+// Benchmarks for loading a city-scale scene, with and without lazy mesh objects.
+
+#include "benchmark.h"
+#include "vart/xmlstreamscene.h"
+#include "vart/lazymeshobject.h"
+#include "vart/meshcache.h"
+#include "vart/transform.h"
+#include "vart/snoperator.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <malloc.h>
+
+const unsigned int NUM_FILES = 64;
+// Each building is a wall of GRID_SIZE x GRID_SIZE vertices
+const unsigned int GRID_SIZE = 32;
+// Buildings stand on a CITY_SIZE x CITY_SIZE grid of blocks
+const unsigned int CITY_SIZE = 32;
+const unsigned int NUM_BUILDINGS = CITY_SIZE * CITY_SIZE;
+const double BLOCK_SIZE = 40;
+const double BUILDING_SIZE = 20;
+const char* const EAGER_SCENE_FILE_NAME = "lazyload_scene.xml";
+const char* const BOUNDS_SCENE_FILE_NAME = "lazyload_bounds.xml";
+
+// Wavefront OBJ files (one building each) and two scenes that place buildings on a grid,
+// one of them with bounding boxes. Files are written at first use and removed at exit.
+class CityFiles {
+    public:
+        CityFiles();
+        ~CityFiles();
+        static std::string FileName(unsigned int file);
+        static double Height(unsigned int file) { return 10 + (file * 37) % 50; }
+};
+
+CityFiles::CityFiles()
+{
+    for (unsigned int f = 0; f < NUM_FILES; ++f)
+    {
+        std::ofstream obj(FileName(f).c_str());
+        obj << "o building\n";
+        const double height = Height(f);
+        for (unsigned int i = 0; i < GRID_SIZE; ++i)
+            for (unsigned int j = 0; j < GRID_SIZE; ++j)
+                obj << "v " << BUILDING_SIZE * i / (GRID_SIZE - 1) << " "
+                    << height * j / (GRID_SIZE - 1) << " "
+                    << BUILDING_SIZE * (0.5 + 0.5 * std::sin(i * 0.2 + f)) << "\n";
+        obj << "vn 0 0 1\n";
+        for (unsigned int i = 0; i < GRID_SIZE - 1; ++i)
+            for (unsigned int j = 0; j < GRID_SIZE - 1; ++j)
+            {
+                unsigned int v = 1 + i * GRID_SIZE + j;
+                obj << "f " << v << "//1 " << v + GRID_SIZE << "//1 " << v + GRID_SIZE + 1
+                    << "//1 " << v + 1 << "//1\n";
+            }
+    }
+    std::ofstream eager(EAGER_SCENE_FILE_NAME);
+    std::ofstream bounds(BOUNDS_SCENE_FILE_NAME);
+    eager << "<?xml version=\"1.0\"?>\n<scene description=\"city\">\n";
+    bounds << "<?xml version=\"1.0\"?>\n<scene description=\"city\">\n";
+    for (unsigned int x = 0; x < CITY_SIZE; ++x)
+        for (unsigned int z = 0; z < CITY_SIZE; ++z)
+        {
+            unsigned int f = (x * 7 + z * 13) % NUM_FILES;
+            std::ostringstream node;
+            node << "  <node><transform description=\"block\"><translation x=\""
+                 << x * BLOCK_SIZE << "\" y=\"0\" z=\"" << z * BLOCK_SIZE << "\"/></transform>\n"
+                 << "    <node><meshobject filename=\"" << FileName(f)
+                 << "\" description=\"building\" type=\"obj\"";
+            eager << node.str() << "/></node>\n  </node>\n";
+            bounds << node.str() << ">\n      <min x=\"0\" y=\"0\" z=\"0\"/><max x=\""
+                   << BUILDING_SIZE << "\" y=\"" << Height(f) << "\" z=\"" << BUILDING_SIZE
+                   << "\"/>\n    </meshobject></node>\n  </node>\n";
+        }
+    eager << "</scene>\n";
+    bounds << "</scene>\n";
+}
+
+CityFiles::~CityFiles()
+{
+    for (unsigned int f = 0; f < NUM_FILES; ++f)
+        std::remove(FileName(f).c_str());
+    std::remove(EAGER_SCENE_FILE_NAME);
+    std::remove(BOUNDS_SCENE_FILE_NAME);
+}
+
+std::string CityFiles::FileName(unsigned int file)
+{
+    std::ostringstream name;
+    name << "lazyload_" << file << ".obj";
+    return name.str();
+}
+
+static void CreateFiles()
+{
+    static CityFiles files;
+}
+
+// Silences progress messages of the OBJ reader while alive
+class Quiet {
+    public:
+        Quiet() : coutBuf(std::cout.rdbuf(NULL)), clogBuf(std::clog.rdbuf(NULL)) {}
+        ~Quiet() { std::cout.rdbuf(coutBuf); std::clog.rdbuf(clogBuf); }
+    private:
+        std::streambuf* coutBuf;
+        std::streambuf* clogBuf;
+};
+
+// Reads a value (in kB) from /proc/self/status. Returns zero if not available.
+static double StatusKB(const std::string& field)
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+        if (line.compare(0, field.size(), field) == 0)
+            return std::atof(line.c_str() + field.size() + 1);
+    return 0;
+}
+
+// Returns the resident set size in kB after resetting its peak (where supported)
+static double ResetPeakRSS()
+{
+    malloc_trim(0);
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5\n";
+    clearRefs.close();
+    return StatusKB("VmRSS");
+}
+
+// Loads the city scene, reporting how much the peak resident set size grew while loading
+// the last one
+static void Load(const char* fileName, bool lazy, unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    double peakGrowth = 0;
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        double rss = ResetPeakRSS();
+        VART::XmlStreamScene scene;
+        scene.SetLazyLoading(lazy);
+        scene.LoadFromFile(fileName);
+        Benchmark::Use(scene.GetObjects().size());
+        peakGrowth = StatusKB("VmHWM") - rss;
+    }
+    Benchmark::SetCounter("peak RSS growth MB", peakGrowth / 1024);
+}
+
+static void LoadEager(unsigned long iterations)
+{
+    Load(EAGER_SCENE_FILE_NAME, false, iterations);
+}
+
+// Bounding boxes are in the scene file: no mesh file is read
+static void LoadLazyBounds(unsigned long iterations)
+{
+    Load(BOUNDS_SCENE_FILE_NAME, true, iterations);
+}
+
+// Bounding boxes come from scanning mesh files
+static void LoadLazyScan(unsigned long iterations)
+{
+    Load(EAGER_SCENE_FILE_NAME, true, iterations);
+}
+
+// Column-major product, as in OpenGL: result = a * b
+static void Multiply(const double* a, const double* b, double* result)
+{
+    for (unsigned int col = 0; col < 4; ++col)
+        for (unsigned int row = 0; row < 4; ++row)
+            result[col*4+row] = a[row] * b[col*4] + a[4+row] * b[col*4+1] +
+                                a[8+row] * b[col*4+2] + a[12+row] * b[col*4+3];
+}
+
+// Finds the lazy mesh object under a node
+class LazyFinder : public VART::SNOperator {
+    public:
+        LazyFinder() : lazyPtr(NULL) {}
+        virtual void OperateOn(const VART::SceneNode* nodePtr)
+        {
+            const VART::LazyMeshObject* ptr = dynamic_cast<const VART::LazyMeshObject*>(nodePtr);
+            if (ptr)
+                lazyPtr = ptr;
+        }
+        const VART::LazyMeshObject* lazyPtr;
+};
+
+// Buildings of the city, each with the transform that places it
+typedef std::vector<std::pair<const VART::Transform*, const VART::LazyMeshObject*> >
+    BuildingVec;
+
+const unsigned int FRAMES_PER_SECOND = 60;
+
+// Walks along a street of the lazily loaded city, one second (of simulated time) per
+// iteration, checking visibility of every building each frame. Buildings within 300 units
+// are loaded, and geometry is kept under 4 MB by unloading buildings out of view for over
+// a second.
+static void Walk(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    // The cache must outlive the scene, whose loaded objects release their files
+    VART::MeshCache::Instance();
+    static VART::XmlStreamScene scene;
+    static BuildingVec buildingVec;
+    static double time = 0;
+    if (buildingVec.empty())
+    {
+        scene.SetLazyLoading(true);
+        scene.LoadFromFile(BOUNDS_SCENE_FILE_NAME);
+        std::list<VART::SceneNode*> objectList = scene.GetObjects();
+        for (std::list<VART::SceneNode*>::iterator iter = objectList.begin();
+             iter != objectList.end(); ++iter)
+        {
+            LazyFinder finder;
+            (*iter)->TraverseDepthFirst(&finder);
+            buildingVec.push_back(std::make_pair(dynamic_cast<VART::Transform*>(*iter),
+                                                 finder.lazyPtr));
+        }
+        VART::LazyMeshObject::SetLoadDistance(300);
+        VART::LazyMeshObject::SetUnloadDelay(1);
+        VART::LazyMeshObject::SetBudget(4 * 1024 * 1024);
+    }
+    // Perspective projection: 60 degrees vertical field of view, 4:3, near 1, far 1000
+    const double f = 1 / std::tan(M_PI / 6);
+    const double nearPlane = 1;
+    const double farPlane = 1000;
+    const double projection[16] = { f * 3 / 4, 0, 0, 0,  0, f, 0, 0,
+        0, 0, (farPlane + nearPlane) / (nearPlane - farPlane), -1,
+        0, 0, 2 * farPlane * nearPlane / (nearPlane - farPlane), 0 };
+    const double cityLength = CITY_SIZE * BLOCK_SIZE;
+    double peakBytes = 0;
+    for (unsigned long n = 0; n < iterations * FRAMES_PER_SECOND; ++n)
+    {
+        time += 1.0 / FRAMES_PER_SECOND;
+        // Along a street across the middle of the city, turning at each end
+        double distance = std::fmod(time * 20, 2 * cityLength);
+        double heading = (distance < cityLength) ? 0 : M_PI;
+        double eyeX = (distance < cityLength) ? distance : 2 * cityLength - distance;
+        double eyeZ = BLOCK_SIZE * (CITY_SIZE / 2) - (BLOCK_SIZE - BUILDING_SIZE) / 2;
+        // View matrix: camera at (eyeX, 2, eyeZ) looking along heading, around y
+        double c = std::cos(heading);
+        double s = std::sin(heading);
+        // rows: side = (-s, 0, c), up = (0, 1, 0), back = (-c, 0, -s)
+        const double view[16] = { -s, 0, -c, 0,  0, 1, 0, 0,  c, 0, -s, 0,
+            s * eyeX - c * eyeZ, -2, c * eyeX + s * eyeZ, 1 };
+        for (BuildingVec::iterator iter = buildingVec.begin(); iter != buildingVec.end(); ++iter)
+        {
+            double modelview[16];
+            Multiply(view, iter->first->GetData(), modelview);
+            iter->second->CheckVisibility(modelview, projection);
+        }
+        VART::LazyMeshObject::Update(time);
+        peakBytes = std::max(peakBytes,
+                             static_cast<double>(VART::LazyMeshObject::GetLoadedBytes()));
+    }
+    Benchmark::SetCounter("loaded objects", VART::LazyMeshObject::GetNumLoaded());
+    Benchmark::SetCounter("loaded MB", static_cast<double>(VART::LazyMeshObject::GetLoadedBytes())
+                                       / (1024 * 1024));
+    Benchmark::SetCounter("peak loaded MB", peakBytes / (1024 * 1024));
+}
+
+static Benchmark loadEager("lazy/load-city-eager-1024objs", &LoadEager, NUM_BUILDINGS);
+static Benchmark loadLazyBounds("lazy/load-city-lazy-bounds-1024objs", &LoadLazyBounds,
+                                NUM_BUILDINGS);
+static Benchmark loadLazyScan("lazy/load-city-lazy-scan-1024objs", &LoadLazyScan,
+                              NUM_BUILDINGS);
+static Benchmark walk("lazy/walk-city-1024objs-frame", &Walk, FRAMES_PER_SECOND);
@@ -0,0 +1,53 @@
+// V-ART microbenchmarks
+//
+// Usage: benchmark [-l] [-v] [-j] [-s samples] [-w warmup] [-t milliseconds] [prefix]
+//   -l      list benchmarks
+//   -v      run correctness checks instead of benchmarks (exit status 1 on failures)
+//   -j      print results as JSON instead of a table
+//   -s      number of measured samples per benchmark (default 15)
+//   -w      number of warmup samples per benchmark (default 1)
+//   -t      duration of each sample in milliseconds (default 10)
+//   prefix  run only benchmarks (or checks) whose names start with prefix
+
+#include "benchmark.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+
+using namespace std;
+
+int main(int argc, char* argv[])
+{
+    string prefix;
+    bool json = false;
+    bool verify = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-l") == 0)
+        {
+            Benchmark::PrintNames(cout);
+            return 0;
+        }
+        if (strcmp(argv[i], "-j") == 0)
+            json = true;
+        else if (strcmp(argv[i], "-v") == 0)
+            verify = true;
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            Benchmark::SetSamples(atoi(argv[++i]));
+        else if ((strcmp(argv[i], "-w") == 0) && (i + 1 < argc))
+            Benchmark::SetWarmup(atoi(argv[++i]));
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+            Benchmark::SetSampleTime(atof(argv[++i]) / 1000);
+        else
+            prefix = argv[i];
+    }
+    if (verify)
+        return (Check::RunAll(prefix, cout) == 0) ? 0 : 1;
+    vector<Benchmark::Result> results;
+    Benchmark::RunAll(prefix, &results);
+    if (json)
+        Benchmark::PrintJSON(cout, results);
+    else
+        Benchmark::PrintTable(cout, results);
+    return 0;
+}
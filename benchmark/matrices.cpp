@@ -0,0 +1,226 @@
+// Benchmarks for matrix kernels: Matrix4 against the scalar code Transform used before
+// (reproduced here as "legacy" cases), for products, inverses, transposes and points.
+
+#include "benchmark.h"
+#include "vart/matrix4.h"
+#include "vart/transform.h"
+#include "vart/boundingbox.h"
+#include <cstdlib>
+
+const unsigned int NUM_POINTS = 1024;
+
+static VART::Transform transA;
+static VART::Transform transB;
+static VART::Matrix4 affine;
+static VART::Matrix4 projective;
+static double coords[NUM_POINTS * 3];
+static double results[NUM_POINTS * 3];
+
+// Fills matrices with arbitrary rigid transformations and points
+static bool Initialize()
+{
+    VART::Transform rotation;
+    transA.MakeTranslation(1, 2, 3);
+    rotation.MakeRotation(VART::Point4D(1, 1, 0, 0), 0.3f);
+    transA.Apply(rotation);
+    transB.MakeRotation(VART::Point4D(0, 0.5, 0.5), VART::Point4D(0, 1, 1, 0), 1.1f);
+    affine = transA.GetMatrix();
+    projective = affine;
+    projective[3] = 0.01;
+    projective[11] = -1;
+    for (unsigned int i = 0; i < NUM_POINTS * 3; ++i)
+        coords[i] = static_cast<double>(rand()) / RAND_MAX;
+    return true;
+}
+
+static bool initialized = Initialize();
+
+// Transform::operator* before Matrix4
+static VART::Transform LegacyProduct(const VART::Transform& a, const VART::Transform& b)
+{
+    VART::Transform resultado;
+    const double* matrix = a.GetData();
+    const double* other = b.GetData();
+    double product[16];
+    for (int i=0; i < 16; ++i)
+        product[i] =
+              matrix[i%4]    *other[i/4*4]  +matrix[(i%4)+4] *other[i/4*4+1]
+            + matrix[(i%4)+8]*other[i/4*4+2]+matrix[(i%4)+12]*other[i/4*4+3];
+    resultado.SetData(product);
+    return resultado;
+}
+
+// Transform::ApplyTo before Matrix4
+static void LegacyApplyTo(const double* matrix, VART::Point4D* ptPoint)
+{
+    ptPoint->SetXYZW(
+        matrix[0]*ptPoint->GetX() + matrix[4]*ptPoint->GetY()
+            + matrix[8]*ptPoint->GetZ() + matrix[12]*ptPoint->GetW(),
+        matrix[1]*ptPoint->GetX() + matrix[5]*ptPoint->GetY()
+            + matrix[9]*ptPoint->GetZ() + matrix[13]*ptPoint->GetW(),
+        matrix[2]*ptPoint->GetX() + matrix[6]*ptPoint->GetY()
+            + matrix[10]*ptPoint->GetZ() + matrix[14]*ptPoint->GetW(),
+        matrix[3]*ptPoint->GetX() + matrix[7]*ptPoint->GetY()
+            + matrix[11]*ptPoint->GetZ() + matrix[15]*ptPoint->GetW());
+}
+
+static void MultiplyLegacy(unsigned long iterations)
+{
+    VART::Transform trans(transB);
+    for (unsigned long i = 0; i < iterations; ++i)
+        trans.CopyMatrix(LegacyProduct(transA, trans));
+    Benchmark::Use(trans.GetData()[12]);
+}
+
+static void MultiplyTransform(unsigned long iterations)
+{
+    VART::Transform trans(transB);
+    for (unsigned long i = 0; i < iterations; ++i)
+        trans.Apply(transA);
+    Benchmark::Use(trans.GetData()[12]);
+}
+
+static void Multiply(unsigned long iterations)
+{
+    VART::Matrix4 matrix(transB.GetMatrix());
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        VART::Matrix4::Multiply(affine, transB.GetMatrix(), &matrix);
+        sum += matrix[12];
+    }
+    Benchmark::Use(sum);
+}
+
+static void MultiplyAffine(unsigned long iterations)
+{
+    VART::Matrix4 matrix(transB.GetMatrix());
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        VART::Matrix4::MultiplyAffine(affine, transB.GetMatrix(), &matrix);
+        sum += matrix[12];
+    }
+    Benchmark::Use(sum);
+}
+
+static void MultiplyProjective(unsigned long iterations)
+{
+    VART::Matrix4 matrix(transB.GetMatrix());
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        VART::Matrix4::Multiply(projective, transB.GetMatrix(), &matrix);
+        sum += matrix[12];
+    }
+    Benchmark::Use(sum);
+}
+
+static void InverseAffine(unsigned long iterations)
+{
+    VART::Matrix4 matrix(affine);
+    for (unsigned long i = 0; i < iterations; ++i)
+        matrix.GetInverse(&matrix);
+    Benchmark::Use(matrix[12]);
+}
+
+static void InverseProjective(unsigned long iterations)
+{
+    VART::Matrix4 matrix(projective);
+    for (unsigned long i = 0; i < iterations; ++i)
+        matrix.GetInverse(&matrix);
+    Benchmark::Use(matrix[12]);
+}
+
+static void Transpose(unsigned long iterations)
+{
+    VART::Matrix4 matrix(projective);
+    for (unsigned long i = 0; i < iterations; ++i)
+        matrix.GetTranspose(&matrix);
+    Benchmark::Use(matrix[3]);
+}
+
+// Makes Point4Ds from coordinates and applies the transform to each, as meshes did
+static void PointsLegacy(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        for (unsigned int p = 0; p < NUM_POINTS * 3; p += 3)
+        {
+            VART::Point4D point(coords[p], coords[p+1], coords[p+2]);
+            LegacyApplyTo(transA.GetData(), &point);
+            results[p] = point.GetX();
+            results[p+1] = point.GetY();
+            results[p+2] = point.GetZ();
+        }
+    Benchmark::Use(results[NUM_POINTS]);
+}
+
+static void PointsBatch(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        affine.TransformPoints(coords, results, NUM_POINTS);
+    Benchmark::Use(results[NUM_POINTS]);
+}
+
+static void VectorsBatch(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        affine.TransformVectors(coords, results, NUM_POINTS);
+    Benchmark::Use(results[NUM_POINTS]);
+}
+
+// BoundingBox::ApplyTransform before Matrix4
+static void LegacyApplyTransform(const VART::Transform& trans, VART::BoundingBox* boxPtr)
+{
+    VART::BoundingBox box = *boxPtr;
+    VART::Point4D ptoBBox = trans * VART::Point4D(box.GetSmallerX(),box.GetSmallerY(),box.GetSmallerZ());
+    boxPtr->SetBoundingBox(ptoBBox.GetX(),ptoBBox.GetY(),ptoBBox.GetZ(),ptoBBox.GetX(),ptoBBox.GetY(),ptoBBox.GetZ());
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetSmallerX(), box.GetSmallerY(), box.GetGreaterZ()));
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetSmallerX(), box.GetGreaterY(), box.GetGreaterZ()));
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetSmallerX(), box.GetGreaterY(), box.GetSmallerZ()));
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetSmallerY(), box.GetSmallerZ()));
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetSmallerY(), box.GetGreaterZ()));
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetGreaterY(), box.GetGreaterZ()));
+    boxPtr->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetGreaterY(), box.GetSmallerZ()));
+    boxPtr->ProcessCenter();
+}
+
+static void BoundingBoxesLegacy(unsigned long iterations)
+{
+    double sum = 0;
+    VART::BoundingBox box;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        box.SetBoundingBox(-1, -2, -3, 1, 2, 3);
+        LegacyApplyTransform(transA, &box);
+        sum += box.GetGreaterX();
+    }
+    Benchmark::Use(sum);
+}
+
+static void BoundingBoxes(unsigned long iterations)
+{
+    double sum = 0;
+    VART::BoundingBox box;
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        box.SetBoundingBox(-1, -2, -3, 1, 2, 3);
+        box.ApplyTransform(transA);
+        sum += box.GetGreaterX();
+    }
+    Benchmark::Use(sum);
+}
+
+static Benchmark multiplyLegacy("matrices/multiply-legacy", &MultiplyLegacy, 1);
+static Benchmark multiplyTransform("matrices/multiply-transform-apply", &MultiplyTransform, 1);
+static Benchmark multiply("matrices/multiply", &Multiply, 1);
+static Benchmark multiplyAffine("matrices/multiply-affine", &MultiplyAffine, 1);
+static Benchmark multiplyProjective("matrices/multiply-projective", &MultiplyProjective, 1);
+static Benchmark inverseAffine("matrices/inverse-affine", &InverseAffine, 1);
+static Benchmark inverseProjective("matrices/inverse-projective", &InverseProjective, 1);
+static Benchmark transpose("matrices/transpose", &Transpose, 1);
+static Benchmark pointsLegacy("matrices/points-legacy-1024", &PointsLegacy, NUM_POINTS);
+static Benchmark pointsBatch("matrices/points-batch-1024", &PointsBatch, NUM_POINTS);
+static Benchmark vectorsBatch("matrices/vectors-batch-1024", &VectorsBatch, NUM_POINTS);
+static Benchmark boundingBoxesLegacy("matrices/bounding-box-legacy", &BoundingBoxesLegacy, 1);
+static Benchmark boundingBoxes("matrices/bounding-box-transform", &BoundingBoxes, 1);
@@ -0,0 +1,427 @@
+// Checks for Matrix4 batch kernels (points, vectors, normals and fused bounds) and for
+// products and inverses of single matrices, whichever of the AVX, SSE2 or plain C++ paths
+// they were built with, against plain loops of the definitions. Batches have odd sizes, so
+// that kernels handle leftover elements, and are also split among threads in small chunks.
+// "make verify" runs them on builds with each path.
+
+#include "benchmark.h"
+#include "vart/matrix4.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+// Relative error allowed against the reference
+const double TOLERANCE = 1e-12;
+// Error allowed for inverses (computed by cofactors, against Gauss-Jordan elimination)
+const double INVERSE_TOLERANCE = 1e-9;
+// Random matrices checked by each of the single matrix checks
+const unsigned int NUM_MATRICES = 100;
+// Batch sizes checked (the last one is split among threads)
+const unsigned int SIZES[] = { 1, 2, 3, 5, 8, 17, 1001, 10007 };
+const unsigned int NUM_SIZES = sizeof(SIZES) / sizeof(SIZES[0]);
+// Small chunks, so that batches are split into many of them
+const unsigned int SPLIT_THRESHOLD = 64;
+const unsigned int SPLIT_THREADS = 4;
+
+// An affine matrix with rotation, non uniform scale, shear and translation, so that
+// normals are not transformed as vectors are
+static VART::Matrix4 AffineMatrix()
+{
+    VART::Matrix4 rotation;
+    VART::Matrix4 scale;
+    VART::Matrix4 shear;
+    VART::Matrix4 translation;
+    rotation.MakeRotation(VART::Point4D(1, 2, 3, 0), 0.7);
+    scale.MakeScale(2, 0.5, 3);
+    shear.MakeShear(0.3, -0.2);
+    translation.MakeTranslation(VART::Point4D(-1, 4, 2.5, 0));
+    return translation * rotation * shear * scale;
+}
+
+// Returns coordinates of random points or vectors, as x, y, z triples
+static std::vector<double> RandomCoordinates(unsigned int count)
+{
+    std::vector<double> result(count * 3);
+    for (unsigned int i = 0; i < count * 3; ++i)
+        result[i] = static_cast<double>(rand()) / RAND_MAX * 20 - 10;
+    return result;
+}
+
+// Applies the upper 3x4 part of a matrix to a triple (w is 1 for points, 0 for vectors)
+static void Reference(const VART::Matrix4& m, const double* src, double w, double* dst)
+{
+    for (unsigned int r = 0; r < 3; ++r)
+        dst[r] = m[r] * src[0] + m[r + 4] * src[1] + m[r + 8] * src[2] + m[r + 12] * w;
+}
+
+// Compares coordinates, reporting the first mismatch
+static bool Compare(std::ostream& os, const char* what, unsigned int count,
+                    const std::vector<double>& result, const std::vector<double>& expected)
+{
+    for (unsigned int i = 0; i < result.size(); ++i)
+    {
+        double error = std::fabs(result[i] - expected[i]);
+        if (error > TOLERANCE * std::max(1.0, std::fabs(expected[i])))
+        {
+            os << "  " << what << " (batch of " << count << "): element " << i << " is "
+               << result[i] << ", expected " << expected[i] << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs a check on every batch size, then on the largest one split among threads
+static bool ForEachSize(std::ostream& os, bool (*check)(std::ostream&, unsigned int))
+{
+    bool passed = true;
+    for (unsigned int s = 0; s < NUM_SIZES; ++s)
+        passed = check(os, SIZES[s]) && passed;
+    VART::Matrix4::SetParallelThreshold(SPLIT_THRESHOLD);
+    VART::Matrix4::SetNumThreads(SPLIT_THREADS);
+    passed = check(os, SIZES[NUM_SIZES - 1]) && passed;
+    VART::Matrix4::SetParallelThreshold(65536);
+    VART::Matrix4::SetNumThreads(0);
+    return passed;
+}
+
+static bool CheckPointsOfSize(std::ostream& os, unsigned int count)
+{
+    VART::Matrix4 matrix = AffineMatrix();
+    std::vector<double> src = RandomCoordinates(count);
+    std::vector<double> expected(count * 3);
+    double expectedBounds[6] = { HUGE_VAL, HUGE_VAL, HUGE_VAL, -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        Reference(matrix, &src[i * 3], 1, &expected[i * 3]);
+        for (unsigned int c = 0; c < 3; ++c)
+        {
+            expectedBounds[c] = std::min(expectedBounds[c], expected[i * 3 + c]);
+            expectedBounds[c + 3] = std::max(expectedBounds[c + 3], expected[i * 3 + c]);
+        }
+    }
+    std::vector<double> dst(count * 3);
+    std::vector<double> bounds(6);
+    matrix.TransformPoints(&src[0], &dst[0], count, &bounds[0]);
+    bool passed = Compare(os, "points", count, dst, expected);
+    std::vector<double> expectedBoundsVec(expectedBounds, expectedBounds + 6);
+    passed = Compare(os, "bounds", count, bounds, expectedBoundsVec) && passed;
+    // In place, and bounds only
+    matrix.TransformPoints(&src[0], &src[0], count);
+    passed = Compare(os, "points in place", count, src, expected) && passed;
+    src = RandomCoordinates(count);
+    for (unsigned int i = 0; i < count; ++i)
+        Reference(matrix, &src[i * 3], 1, &expected[i * 3]);
+    bounds.assign(6, 0);
+    matrix.TransformPoints(&src[0], NULL, count, &bounds[0]);
+    for (unsigned int c = 0; c < 3; ++c)
+    {
+        expectedBoundsVec[c] = HUGE_VAL;
+        expectedBoundsVec[c + 3] = -HUGE_VAL;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            expectedBoundsVec[c] = std::min(expectedBoundsVec[c], expected[i * 3 + c]);
+            expectedBoundsVec[c + 3] = std::max(expectedBoundsVec[c + 3], expected[i * 3 + c]);
+        }
+    }
+    return Compare(os, "bounds only", count, bounds, expectedBoundsVec) && passed;
+}
+
+static bool CheckVectorsOfSize(std::ostream& os, unsigned int count)
+{
+    VART::Matrix4 matrix = AffineMatrix();
+    std::vector<double> src = RandomCoordinates(count);
+    std::vector<double> expected(count * 3);
+    for (unsigned int i = 0; i < count; ++i)
+        Reference(matrix, &src[i * 3], 0, &expected[i * 3]);
+    std::vector<double> dst(count * 3);
+    matrix.TransformVectors(&src[0], &dst[0], count);
+    return Compare(os, "vectors", count, dst, expected);
+}
+
+// Normals go through the transpose of the inverse (computed by GetInverse, not by the
+// cofactors of GetNormalMatrix), then are normalized
+static bool CheckNormalsOfSize(std::ostream& os, unsigned int count)
+{
+    VART::Matrix4 matrix = AffineMatrix();
+    VART::Matrix4 inverse;
+    VART::Matrix4 normalMatrix;
+    if (!matrix.GetInverse(&inverse))
+    {
+        os << "  normals: matrix is singular\n";
+        return false;
+    }
+    inverse.GetTranspose(&normalMatrix);
+    std::vector<double> src = RandomCoordinates(count);
+    std::vector<double> expected(count * 3);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        double* normal = &expected[i * 3];
+        Reference(normalMatrix, &src[i * 3], 0, normal);
+        double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1]
+                                  + normal[2] * normal[2]);
+        for (unsigned int c = 0; c < 3; ++c)
+            normal[c] /= length;
+    }
+    std::vector<double> dst(count * 3);
+    if (!matrix.TransformNormals(&src[0], &dst[0], count))
+    {
+        os << "  normals: TransformNormals failed\n";
+        return false;
+    }
+    return Compare(os, "normals", count, dst, expected);
+}
+
+// Point4D arrays go through the whole matrix, bottom row included
+static bool CheckPoint4DsOfSize(std::ostream& os, unsigned int count)
+{
+    VART::Matrix4 matrix = AffineMatrix();
+    matrix[3] = 0.01;
+    matrix[11] = -0.5;
+    std::vector<double> coordinates = RandomCoordinates(count);
+    std::vector<VART::Point4D> points(count);
+    std::vector<double> expected(count * 4);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const double* p = &coordinates[i * 3];
+        double w = (i % 2) ? 1 : 0;
+        points[i].SetXYZW(p[0], p[1], p[2], w);
+        for (unsigned int r = 0; r < 4; ++r)
+            expected[i * 4 + r] = matrix[r] * p[0] + matrix[r + 4] * p[1]
+                                  + matrix[r + 8] * p[2] + matrix[r + 12] * w;
+    }
+    matrix.ApplyTo(&points[0], count);
+    std::vector<double> result(count * 4);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        result[i * 4] = points[i].GetX();
+        result[i * 4 + 1] = points[i].GetY();
+        result[i * 4 + 2] = points[i].GetZ();
+        result[i * 4 + 3] = points[i].GetW();
+    }
+    return Compare(os, "Point4D array", count, result, expected);
+}
+
+// A random matrix, with a random bottom row unless affine
+static VART::Matrix4 RandomMatrix(bool affine)
+{
+    VART::Matrix4 result;
+    for (unsigned int i = 0; i < 16; ++i)
+        result[i] = static_cast<double>(rand()) / RAND_MAX * 4 - 2;
+    if (affine)
+    {
+        result[3] = result[7] = result[11] = 0;
+        result[15] = 1;
+    }
+    return result;
+}
+
+// a*b by the definition: element (row i, column j) is row i of a times column j of b
+static VART::Matrix4 ReferenceProduct(const VART::Matrix4& a, const VART::Matrix4& b)
+{
+    VART::Matrix4 result;
+    for (unsigned int j = 0; j < 4; ++j)
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            double sum = 0;
+            for (unsigned int k = 0; k < 4; ++k)
+                sum += a[k * 4 + i] * b[j * 4 + k];
+            result[j * 4 + i] = sum;
+        }
+    return result;
+}
+
+// Inverse by Gauss-Jordan elimination with partial pivoting
+static bool ReferenceInverse(const VART::Matrix4& m, VART::Matrix4* resultPtr)
+{
+    double a[4][8]; // rows of m, then rows of the identity
+    for (unsigned int i = 0; i < 4; ++i)
+        for (unsigned int j = 0; j < 4; ++j)
+        {
+            a[i][j] = m[j * 4 + i];
+            a[i][j + 4] = (i == j) ? 1 : 0;
+        }
+    for (unsigned int c = 0; c < 4; ++c)
+    {
+        unsigned int pivot = c;
+        for (unsigned int r = c + 1; r < 4; ++r)
+            if (std::fabs(a[r][c]) > std::fabs(a[pivot][c]))
+                pivot = r;
+        if (a[pivot][c] == 0)
+            return false;
+        for (unsigned int j = 0; j < 8; ++j)
+            std::swap(a[c][j], a[pivot][j]);
+        double factor = 1 / a[c][c];
+        for (unsigned int j = 0; j < 8; ++j)
+            a[c][j] *= factor;
+        for (unsigned int r = 0; r < 4; ++r)
+        {
+            if (r == c)
+                continue;
+            double multiple = a[r][c];
+            for (unsigned int j = 0; j < 8; ++j)
+                a[r][j] -= multiple * a[c][j];
+        }
+    }
+    for (unsigned int i = 0; i < 4; ++i)
+        for (unsigned int j = 0; j < 4; ++j)
+            (*resultPtr)[j * 4 + i] = a[i][j + 4];
+    return true;
+}
+
+// Compares matrices, reporting the first mismatch
+static bool CompareMatrices(std::ostream& os, const char* what, const VART::Matrix4& result,
+                            const VART::Matrix4& expected, double tolerance)
+{
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        double error = std::fabs(result[i] - expected[i]);
+        if (error > tolerance * std::max(1.0, std::fabs(expected[i])))
+        {
+            os << "  " << what << ": element " << i << " is " << result[i] << ", expected "
+               << expected[i] << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckMultiply(std::ostream& os)
+{
+    bool passed = true;
+    for (unsigned int n = 0; passed && (n < NUM_MATRICES); ++n)
+    {
+        VART::Matrix4 a = RandomMatrix(false);
+        VART::Matrix4 b = RandomMatrix(false);
+        VART::Matrix4 expected = ReferenceProduct(a, b);
+        VART::Matrix4 result;
+        VART::Matrix4::Multiply(a, b, &result);
+        passed = CompareMatrices(os, "product", result, expected, TOLERANCE);
+        passed = CompareMatrices(os, "operator*", a * b, expected, TOLERANCE) && passed;
+        // The result may be either operand
+        VART::Matrix4 left = a;
+        VART::Matrix4::Multiply(left, b, &left);
+        passed = CompareMatrices(os, "product into a", left, expected, TOLERANCE) && passed;
+        VART::Matrix4 right = b;
+        VART::Matrix4::Multiply(a, right, &right);
+        passed = CompareMatrices(os, "product into b", right, expected, TOLERANCE) && passed;
+    }
+    return passed;
+}
+
+static bool CheckMultiplyAffine(std::ostream& os)
+{
+    bool passed = true;
+    for (unsigned int n = 0; passed && (n < NUM_MATRICES); ++n)
+    {
+        VART::Matrix4 a = (n == 0) ? AffineMatrix() : RandomMatrix(true);
+        VART::Matrix4 b = RandomMatrix(true);
+        VART::Matrix4 expected = ReferenceProduct(a, b);
+        VART::Matrix4 result;
+        VART::Matrix4::MultiplyAffine(a, b, &result);
+        passed = CompareMatrices(os, "affine product", result, expected, TOLERANCE);
+        if (!result.IsAffine())
+        {
+            os << "  affine product: bottom row is not 0, 0, 0, 1\n";
+            passed = false;
+        }
+        VART::Matrix4 left = a;
+        VART::Matrix4::MultiplyAffine(left, b, &left);
+        passed = CompareMatrices(os, "affine product into a", left, expected, TOLERANCE)
+                 && passed;
+        VART::Matrix4 right = b;
+        VART::Matrix4::MultiplyAffine(a, right, &right);
+        passed = CompareMatrices(os, "affine product into b", right, expected, TOLERANCE)
+                 && passed;
+    }
+    return passed;
+}
+
+// Inverts a matrix, comparing with the reference and checking that the product with the
+// original is the identity
+static bool CheckInverseOf(std::ostream& os, const VART::Matrix4& matrix, const char* what)
+{
+    VART::Matrix4 expected;
+    VART::Matrix4 inverse;
+    if (!ReferenceInverse(matrix, &expected) || !matrix.GetInverse(&inverse))
+    {
+        os << "  " << what << ": matrix is singular\n";
+        return false;
+    }
+    bool passed = CompareMatrices(os, what, inverse, expected, INVERSE_TOLERANCE);
+    VART::Matrix4 identity;
+    identity.MakeIdentity();
+    passed = CompareMatrices(os, what, ReferenceProduct(inverse, matrix), identity,
+                             INVERSE_TOLERANCE) && passed;
+    // The result may be the matrix itself
+    VART::Matrix4 inPlace = matrix;
+    inPlace.GetInverse(&inPlace);
+    return CompareMatrices(os, what, inPlace, inverse, 0) && passed;
+}
+
+static bool CheckInverse(std::ostream& os)
+{
+    // A perspective projection is the usual matrix that is not affine
+    VART::Matrix4 projection;
+    projection.MakeIdentity();
+    projection[0] = 1.5;
+    projection[5] = 2;
+    projection[10] = -1.2;
+    projection[11] = -1;
+    projection[14] = -2.2;
+    projection[15] = 0;
+    bool passed = CheckInverseOf(os, AffineMatrix(), "affine inverse");
+    passed = CheckInverseOf(os, projection, "projection inverse") && passed;
+    for (unsigned int n = 0; passed && (n < NUM_MATRICES); ++n)
+    {
+        passed = CheckInverseOf(os, RandomMatrix(true), "random affine inverse");
+        passed = CheckInverseOf(os, RandomMatrix(false), "random inverse") && passed;
+    }
+    // Singular matrices (with a null column, whose determinant is exactly zero) leave the
+    // result untouched
+    VART::Matrix4 singular = RandomMatrix(false);
+    singular[4] = singular[5] = singular[6] = singular[7] = 0;
+    VART::Matrix4 affineSingular = RandomMatrix(true);
+    affineSingular[8] = affineSingular[9] = affineSingular[10] = 0;
+    VART::Matrix4 result = AffineMatrix();
+    VART::Matrix4 untouched = result;
+    if (singular.GetInverse(&result) || affineSingular.GetInverse(&result)
+        || !CompareMatrices(os, "singular", result, untouched, 0))
+    {
+        os << "  singular matrices were inverted\n";
+        passed = false;
+    }
+    return passed;
+}
+
+static bool CheckPoints(std::ostream& os)
+{
+    return ForEachSize(os, &CheckPointsOfSize);
+}
+
+static bool CheckVectors(std::ostream& os)
+{
+    return ForEachSize(os, &CheckVectorsOfSize);
+}
+
+static bool CheckNormals(std::ostream& os)
+{
+    return ForEachSize(os, &CheckNormalsOfSize);
+}
+
+static bool CheckPoint4Ds(std::ostream& os)
+{
+    bool passed = true;
+    for (unsigned int s = 0; s < NUM_SIZES; ++s)
+        passed = CheckPoint4DsOfSize(os, SIZES[s]) && passed;
+    return passed;
+}
+
+static Check points("matrices/transform-points", &CheckPoints);
+static Check vectors("matrices/transform-vectors", &CheckVectors);
+static Check normals("matrices/transform-normals", &CheckNormals);
+static Check point4Ds("matrices/apply-to-point4d-array", &CheckPoint4Ds);
+static Check multiply("matrices/multiply", &CheckMultiply);
+static Check multiplyAffine("matrices/multiply-affine", &CheckMultiplyAffine);
+static Check inverse("matrices/inverse", &CheckInverse);
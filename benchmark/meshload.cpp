@@ -0,0 +1,153 @@
+// Benchmarks for loading scenes that refer to many mesh files.
+
+#include "benchmark.h"
+#include "vart/xmlstreamscene.h"
+#include "vart/meshcache.h"
+#include "vart/meshobject.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <cstdio>
+
+const unsigned int NUM_FILES = 16;
+const unsigned int OBJECTS_PER_FILE = 8;
+// Each object is a grid of GRID_SIZE x GRID_SIZE quads
+const unsigned int GRID_SIZE = 16;
+// Every mesh object is used this many times in the scene
+const unsigned int USES_PER_OBJECT = 2;
+const unsigned int NUM_REFERENCES = NUM_FILES * OBJECTS_PER_FILE * USES_PER_OBJECT;
+const char* const SCENE_FILE_NAME = "meshload_scene.xml";
+
+// Wavefront OBJ files and a scene that uses each of their mesh objects twice. Files are
+// written at first use and removed at exit.
+class MeshFiles {
+    public:
+        MeshFiles();
+        ~MeshFiles();
+        static std::string FileName(unsigned int file);
+};
+
+MeshFiles::MeshFiles()
+{
+    for (unsigned int f = 0; f < NUM_FILES; ++f)
+    {
+        std::ofstream obj(FileName(f).c_str());
+        unsigned int base = 1;
+        for (unsigned int o = 0; o < OBJECTS_PER_FILE; ++o)
+        {
+            obj << "o mesh" << o << "\n";
+            for (unsigned int i = 0; i <= GRID_SIZE; ++i)
+                for (unsigned int j = 0; j <= GRID_SIZE; ++j)
+                    obj << "v " << i << " " << (i * j) % 7 * 0.1 << " " << j + o * GRID_SIZE << "\n";
+            obj << "vn 0 1 0\n";
+            const unsigned int row = GRID_SIZE + 1;
+            for (unsigned int i = 0; i < GRID_SIZE; ++i)
+                for (unsigned int j = 0; j < GRID_SIZE; ++j)
+                {
+                    unsigned int v = base + i * row + j;
+                    obj << "f " << v << "//1 " << v + 1 << "//1 " << v + row + 1 << "//1 "
+                        << v + row << "//1\n";
+                }
+            base += row * row;
+        }
+    }
+    std::ofstream scene(SCENE_FILE_NAME);
+    scene << "<?xml version=\"1.0\"?>\n<scene description=\"meshes\">\n";
+    for (unsigned int u = 0; u < USES_PER_OBJECT; ++u)
+        for (unsigned int f = 0; f < NUM_FILES; ++f)
+            for (unsigned int o = 0; o < OBJECTS_PER_FILE; ++o)
+                scene << "  <node><meshobject filename=\"" << FileName(f) << "\" description=\"mesh"
+                      << o << "\" type=\"obj\"/></node>\n";
+    scene << "</scene>\n";
+}
+
+MeshFiles::~MeshFiles()
+{
+    for (unsigned int f = 0; f < NUM_FILES; ++f)
+        std::remove(FileName(f).c_str());
+    std::remove(SCENE_FILE_NAME);
+}
+
+std::string MeshFiles::FileName(unsigned int file)
+{
+    std::ostringstream name;
+    name << "meshload_" << file << ".obj";
+    return name.str();
+}
+
+static void CreateFiles()
+{
+    static MeshFiles files;
+}
+
+// Silences progress messages of the OBJ reader while alive
+class Quiet {
+    public:
+        Quiet() : coutBuf(std::cout.rdbuf(NULL)), clogBuf(std::clog.rdbuf(NULL)) {}
+        ~Quiet() { std::cout.rdbuf(coutBuf); std::clog.rdbuf(clogBuf); }
+    private:
+        std::streambuf* coutBuf;
+        std::streambuf* clogBuf;
+};
+
+// What scene loading used to do: read each file in turn, on the calling thread
+static void ReadSequential(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    for (unsigned long n = 0; n < iterations; ++n)
+        for (unsigned int f = 0; f < NUM_FILES; ++f)
+        {
+            std::list<VART::MeshObject*> meshObjectList;
+            VART::MeshObject::ReadFromOBJ(MeshFiles::FileName(f), &meshObjectList);
+            Benchmark::Use(meshObjectList.size());
+            for (std::list<VART::MeshObject*>::iterator iter = meshObjectList.begin();
+                 iter != meshObjectList.end(); ++iter)
+                delete *iter;
+        }
+}
+
+// Loads the scene with an empty cache: every file is read, on worker threads
+static void LoadCold(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    VART::MeshCache& cache = VART::MeshCache::Instance();
+    unsigned long filesRead = cache.GetNumFilesRead();
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        VART::XmlStreamScene scene;
+        scene.LoadFromFile(SCENE_FILE_NAME);
+        Benchmark::Use(scene.GetObjects().size());
+    }
+    Benchmark::SetCounter("files read/load",
+                          static_cast<double>(cache.GetNumFilesRead() - filesRead) / iterations);
+}
+
+// Loads the scene while another scene keeps the files in the cache (from the first run on,
+// so this must run after LoadCold)
+static void LoadWarm(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    VART::MeshCache& cache = VART::MeshCache::Instance();
+    static VART::XmlStreamScene keeper;
+    if (keeper.GetObjects().empty())
+        keeper.LoadFromFile(SCENE_FILE_NAME);
+    unsigned long filesRead = cache.GetNumFilesRead();
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        VART::XmlStreamScene scene;
+        scene.LoadFromFile(SCENE_FILE_NAME);
+        Benchmark::Use(scene.GetObjects().size());
+    }
+    Benchmark::SetCounter("files read/load",
+                          static_cast<double>(cache.GetNumFilesRead() - filesRead) / iterations);
+}
+
+static Benchmark readSequential("mesh/read-obj-sequential-16files", &ReadSequential,
+                                NUM_REFERENCES);
+static Benchmark loadCold("mesh/load-scene-cold-256refs", &LoadCold, NUM_REFERENCES);
+static Benchmark loadWarm("mesh/load-scene-warm-256refs", &LoadWarm, NUM_REFERENCES);
@@ -0,0 +1,206 @@
+// Benchmarks for transforming whole meshes: MeshObject::ApplyTransform and transformed
+// bounding boxes, against the per-vertex loops they used before (reproduced here as
+// "legacy" cases), and the batch kernels for large arrays. Also vertex normals and bounding
+// boxes of a mesh object, on their own.
+
+#include "benchmark.h"
+#include "vart/meshobject.h"
+#include "vart/transform.h"
+#include <cstdlib>
+#include <cmath>
+
+const unsigned int NUM_VERTICES = 100000;
+const unsigned int GRID_SIDE = 316; // about 100k vertices
+
+// A cloud of vertices with normals, in optimized arrays
+class CloudMesh : public VART::MeshObject {
+    public:
+        CloudMesh();
+        // MeshObject::ApplyTransform before batch kernels (normals were not transformed)
+        void LegacyApplyTransform(const VART::Transform& trans);
+        // MeshObject::ComputeBoundingBox(const Transform&, BoundingBox*) before batch kernels
+        void LegacyBoundingBox(const VART::Transform& trans, VART::BoundingBox* bbPtr);
+        // Transformed vertex coordinates
+        std::vector<double>& Coordinates() { return vertCoordVec; }
+        std::vector<double>& Normals() { return normCoordVec; }
+};
+
+CloudMesh::CloudMesh()
+{
+    vertCoordVec.resize(NUM_VERTICES * 3);
+    normCoordVec.resize(NUM_VERTICES * 3);
+    for (unsigned int i = 0; i < NUM_VERTICES * 3; ++i)
+    {
+        vertCoordVec[i] = static_cast<double>(rand()) / RAND_MAX - 0.5;
+        normCoordVec[i] = 0.57735026918962573;
+    }
+    ComputeBoundingBox();
+}
+
+void CloudMesh::LegacyApplyTransform(const VART::Transform& trans)
+{
+    VART::Point4D vertex;
+    for (unsigned int i = 0; i < vertCoordVec.size(); i+=3)
+    {
+        vertex.SetXYZW(vertCoordVec[i],vertCoordVec[i+1],vertCoordVec[i+2],1);
+        trans.ApplyTo(&vertex);
+        vertCoordVec[i] = vertex.GetX();
+        vertCoordVec[i+1] = vertex.GetY();
+        vertCoordVec[i+2] = vertex.GetZ();
+    }
+    ComputeBoundingBox();
+    ComputeRecursiveBoundingBox();
+}
+
+void CloudMesh::LegacyBoundingBox(const VART::Transform& trans, VART::BoundingBox* bbPtr)
+{
+    VART::Point4D p;
+    p.SetXYZW( vertCoordVec[0], vertCoordVec[1], vertCoordVec[2], 1 );
+    p = trans * p;
+    bbPtr->SetBoundingBox(p.GetX(), p.GetY(), p.GetZ() , p.GetX(), p.GetY(), p.GetZ());
+    for (unsigned int i=3; i < vertCoordVec.size(); i+=3)
+    {
+        p.SetXYZW( vertCoordVec[i], vertCoordVec[i+1], vertCoordVec[i+2], 1 );
+        p = trans * p;
+        bbPtr->ConditionalUpdate( p );
+    }
+}
+
+// A wavy grid of triangles, as read from an OBJ file
+class GridMesh : public VART::MeshObject {
+    public:
+        GridMesh();
+};
+
+GridMesh::GridMesh()
+{
+    vertCoordVec.reserve(GRID_SIDE * GRID_SIDE * 3);
+    for (unsigned int i = 0; i < GRID_SIDE; ++i)
+        for (unsigned int j = 0; j < GRID_SIDE; ++j)
+        {
+            vertCoordVec.push_back(j);
+            vertCoordVec.push_back(sin(0.1 * i) * cos(0.1 * j));
+            vertCoordVec.push_back(i);
+        }
+    VART::Mesh triangles;
+    triangles.type = VART::Mesh::TRIANGLES;
+    triangles.material = VART::Material::PLASTIC_GREEN();
+    for (unsigned int i = 0; i + 1 < GRID_SIDE; ++i)
+        for (unsigned int j = 0; j + 1 < GRID_SIDE; ++j)
+        {
+            unsigned int corner = i * GRID_SIDE + j;
+            triangles.indexVec.push_back(corner);
+            triangles.indexVec.push_back(corner + GRID_SIDE);
+            triangles.indexVec.push_back(corner + 1);
+            triangles.indexVec.push_back(corner + 1);
+            triangles.indexVec.push_back(corner + GRID_SIDE);
+            triangles.indexVec.push_back(corner + GRID_SIDE + 1);
+        }
+    meshList.push_back(triangles);
+}
+
+static GridMesh& Grid()
+{
+    static GridMesh grid;
+    return grid;
+}
+
+static CloudMesh& Cloud()
+{
+    static CloudMesh cloud;
+    return cloud;
+}
+
+// A rotation, so that repeated transforms keep the cloud in place
+static const VART::Transform& Rotation()
+{
+    static VART::Transform rotation;
+    rotation.MakeRotation(VART::Point4D(0.1, 0.2, 0.3), VART::Point4D(1, 1, 1, 0), 0.01f);
+    return rotation;
+}
+
+static void ApplyLegacy(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        Cloud().LegacyApplyTransform(Rotation());
+    Benchmark::Use(Cloud().GetBoundingBox().GetGreaterX());
+}
+
+static void Apply(unsigned long iterations)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        Cloud().ApplyTransform(Rotation());
+    Benchmark::Use(Cloud().GetBoundingBox().GetGreaterX());
+}
+
+static void BoundingBoxLegacy(unsigned long iterations)
+{
+    VART::BoundingBox box;
+    for (unsigned long i = 0; i < iterations; ++i)
+        Cloud().LegacyBoundingBox(Rotation(), &box);
+    Benchmark::Use(box.GetGreaterX());
+}
+
+static void BoundingBox(unsigned long iterations)
+{
+    VART::BoundingBox box;
+    for (unsigned long i = 0; i < iterations; ++i)
+        Cloud().ComputeBoundingBox(Rotation(), &box);
+    Benchmark::Use(box.GetGreaterX());
+}
+
+// Batch kernels alone, serial and split among threads
+static void Points(unsigned long iterations)
+{
+    std::vector<double>& coords = Cloud().Coordinates();
+    double bounds[6];
+    for (unsigned long i = 0; i < iterations; ++i)
+        Rotation().GetMatrix().TransformPoints(&coords[0], &coords[0], NUM_VERTICES, bounds);
+    Benchmark::Use(bounds[3]);
+}
+
+static void PointsSerial(unsigned long iterations)
+{
+    VART::Matrix4::SetParallelThreshold(0);
+    Points(iterations);
+    VART::Matrix4::SetParallelThreshold(65536);
+}
+
+static void Normals(unsigned long iterations)
+{
+    std::vector<double>& normals = Cloud().Normals();
+    for (unsigned long i = 0; i < iterations; ++i)
+        Rotation().GetMatrix().TransformNormals(&normals[0], &normals[0], NUM_VERTICES);
+    Benchmark::Use(normals[0]);
+}
+
+// MeshObject::ComputeVertexNormals: face normals added to the normals of their vertices
+static void VertexNormals(unsigned long iterations)
+{
+    GridMesh& grid = Grid();
+    for (unsigned long i = 0; i < iterations; ++i)
+        grid.ComputeVertexNormals();
+    Benchmark::Use(grid.GetBoundingBox().GetGreaterX());
+}
+
+// MeshObject::ComputeBoundingBox, in the mesh object's own coordinates
+static void ObjectBoundingBox(unsigned long iterations)
+{
+    GridMesh& grid = Grid();
+    for (unsigned long i = 0; i < iterations; ++i)
+        grid.ComputeBoundingBox();
+    Benchmark::Use(grid.GetBoundingBox().GetGreaterX());
+}
+
+static Benchmark applyLegacy("meshes/apply-transform-legacy-100k", &ApplyLegacy, NUM_VERTICES);
+static Benchmark apply("meshes/apply-transform-100k", &Apply, NUM_VERTICES);
+static Benchmark boundingBoxLegacy("meshes/bounding-box-legacy-100k", &BoundingBoxLegacy,
+                                   NUM_VERTICES);
+static Benchmark boundingBox("meshes/bounding-box-100k", &BoundingBox, NUM_VERTICES);
+static Benchmark points("meshes/points-bounds-100k", &Points, NUM_VERTICES);
+static Benchmark pointsSerial("meshes/points-bounds-serial-100k", &PointsSerial, NUM_VERTICES);
+static Benchmark normals("meshes/transform-normals-100k", &Normals, NUM_VERTICES);
+static Benchmark vertexNormals("meshes/vertex-normals-100k", &VertexNormals,
+                               GRID_SIDE * GRID_SIDE);
+static Benchmark objectBoundingBox("meshes/object-bounding-box-100k", &ObjectBoundingBox,
+                                   GRID_SIDE * GRID_SIDE);
@@ -0,0 +1,119 @@
+// Benchmarks for headless rendering with OffscreenViewer.
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/contrib/framecapture.h"
+#include "vart/scene.h"
+#include "vart/sphere.h"
+#include "vart/transform.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include "vart/time.h"
+#include <vector>
+
+const unsigned int GRID_SIZE = 10;
+// Spin of the grid, in radians per (simulated) second
+const double ANGULAR_SPEED = 1.0;
+
+// A grid of spheres under a spinning transform
+class SpheresScene {
+    public:
+        SpheresScene();
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+SpheresScene::SpheresScene()
+    : camera(VART::Point4D(0, 0, 30), VART::Point4D::ORIGIN(), VART::Point4D::Y())
+{
+    root.MakeIdentity();
+    for (unsigned int i = 0; i < GRID_SIZE; ++i)
+        for (unsigned int j = 0; j < GRID_SIZE; ++j)
+        {
+            VART::Transform* transPtr = new VART::Transform;
+            transPtr->MakeTranslation(2.0 * i - GRID_SIZE + 1, 2.0 * j - GRID_SIZE + 1, 0);
+            transPtr->autoDelete = true;
+            VART::Sphere* spherePtr = new VART::Sphere(0.8);
+            spherePtr->SetMaterial(VART::Material::PLASTIC_RED());
+            spherePtr->autoDelete = true;
+            transPtr->AddChild(*spherePtr);
+            root.AddChild(*transPtr);
+        }
+    scene.AddObject(&root);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+// Spins the grid with the viewer's clock
+class SpinIH : public VART::ViewerGlutOGL::IdleHandler {
+    public:
+        SpinIH(VART::Transform* transPtr) : rootPtr(transPtr) {}
+        virtual void OnIdle()
+        {
+            rootPtr->MakeRotation(VART::Point4D::Y(),
+                                  ANGULAR_SPEED * VART::SimulationClock::NOW().AsDouble());
+        }
+    private:
+        VART::Transform* rootPtr;
+};
+
+// Draws frames with a viewer of given size, reporting frames per second
+static void Render(VART::OffscreenViewer* viewerPtr, SpheresScene* scenePtr,
+                   unsigned long iterations)
+{
+    if (!viewerPtr->IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    static SpinIH* idlePtr = NULL;
+    if (viewerPtr->GetFrameCount() == 0)
+    {
+        idlePtr = new SpinIH(&scenePtr->root);
+        viewerPtr->SetScene(scenePtr->scene);
+        viewerPtr->SetIdleHandler(idlePtr);
+    }
+    VART::Time start;
+    start.SetMonotonic();
+    viewerPtr->Run(iterations);
+    VART::Time end;
+    end.SetMonotonic();
+    Benchmark::SetCounter("frames per second", iterations / (end - start).AsDouble());
+}
+
+static void Frame640x480(unsigned long iterations)
+{
+    static SpheresScene scene;
+    static VART::OffscreenViewer viewer(640, 480);
+    Render(&viewer, &scene, iterations);
+}
+
+static void Frame1920x1080(unsigned long iterations)
+{
+    static SpheresScene scene;
+    static VART::OffscreenViewer viewer(1920, 1080);
+    Render(&viewer, &scene, iterations);
+}
+
+// Frames are also captured to a raw video stream (discarded)
+static void Frame1920x1080Capture(unsigned long iterations)
+{
+    static SpheresScene scene;
+    static VART::OffscreenViewer viewer(1920, 1080);
+    static VART::FrameCapture capture;
+    if (viewer.GetFrameCount() == 0)
+    {
+        capture.SetBufferSize(1920, 1080);
+        capture.SetFormat(VART::FrameCapture::RAW_VIDEO);
+        capture.SetFileName("/dev/null");
+        viewer.SetDrawHandler(&capture);
+    }
+    Render(&viewer, &scene, iterations);
+}
+
+static Benchmark frame640x480("offscreen/frame-640x480", &Frame640x480, 1);
+static Benchmark frame1920x1080("offscreen/frame-1920x1080", &Frame1920x1080, 1);
+static Benchmark frame1920x1080Capture("offscreen/frame-1920x1080-capture-raw",
+                                       &Frame1920x1080Capture, 1);
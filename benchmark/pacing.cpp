@@ -0,0 +1,92 @@
+// Benchmarks for frame pacing: sleeping versus spinning until frames are due, and the
+// scene state hash used to skip frames that would not change.
+
+#include "benchmark.h"
+#include "vart/contrib/framepacer.h"
+#include "vart/scene.h"
+#include "vart/transform.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+
+const double FRAME_RATE = 240;
+const unsigned int NUM_TRANSFORMS = 1000;
+
+static void ReportStats(const VART::FramePacer& pacer)
+{
+    VART::FramePacer::Stats stats;
+    pacer.GetStats(&stats);
+    Benchmark::SetCounter("frame time (ms)", stats.meanFrameTime * 1e3);
+    Benchmark::SetCounter("frame time std dev (ms)", stats.frameTimeStdDev * 1e3);
+    Benchmark::SetCounter("mean jitter (us)", stats.meanJitter * 1e6);
+    Benchmark::SetCounter("max jitter (us)", stats.maxJitter * 1e6);
+    Benchmark::SetCounter("CPU usage", stats.cpuUsage);
+}
+
+// Sleeps until each frame is due
+static void Sleeping(unsigned long iterations)
+{
+    static VART::FramePacer pacer;
+    if (!pacer.IsPaced())
+        pacer.SetFrameRate(FRAME_RATE);
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        while (!pacer.FrameDue())
+            VART::FramePacer::Sleep(pacer.TimeToNextFrame());
+        pacer.FrameDrawn();
+    }
+    ReportStats(pacer);
+}
+
+// Spins until each frame is due, as an idle callback with nothing to do would
+static void Spinning(unsigned long iterations)
+{
+    static VART::FramePacer pacer;
+    if (!pacer.IsPaced())
+        pacer.SetFrameRate(FRAME_RATE);
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        while (!pacer.FrameDue())
+            ;
+        pacer.FrameDrawn();
+    }
+    ReportStats(pacer);
+}
+
+// A flat scene of transforms
+class TransformsScene {
+    public:
+        TransformsScene();
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+TransformsScene::TransformsScene()
+    : camera(VART::Point4D(0, 0, 50), VART::Point4D::ORIGIN(), VART::Point4D::Y())
+{
+    root.MakeIdentity();
+    for (unsigned int i = 0; i < NUM_TRANSFORMS; ++i)
+    {
+        VART::Transform* transPtr = new VART::Transform;
+        transPtr->MakeTranslation(i, 0, 0);
+        transPtr->autoDelete = true;
+        root.AddChild(*transPtr);
+    }
+    scene.AddObject(&root);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+static void StateHash(unsigned long iterations)
+{
+    static TransformsScene transforms;
+    unsigned long long hash = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        hash += transforms.scene.ComputeStateHash();
+    Benchmark::Use(static_cast<double>(hash));
+}
+
+static Benchmark sleeping("pacing/sleep-240fps", &Sleeping, 1);
+static Benchmark spinning("pacing/spin-240fps", &Spinning, 1);
+static Benchmark stateHash("pacing/state-hash-1000-transforms", &StateHash, NUM_TRANSFORMS + 1);
@@ -0,0 +1,118 @@
+// Benchmarks for particle systems: updates of fountains kept at 100k and 1M living
+// particles, and frames drawing 100k particles, against frames drawing 10k Dot nodes, as
+// small elements would be made otherwise. Particles per millisecond are 10^6 divided by
+// the times per item.
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/particlesystem.h"
+#include "vart/dot.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include <cmath>
+#include <vector>
+
+const double LIFE = 2; // seconds
+const double STEP = 1.0 / 60;
+
+// A fountain keeping a number of particles alive, already running for a lifetime
+class Fountain {
+    public:
+        Fountain(unsigned int numParticles);
+        VART::ParticleSystem system;
+};
+
+Fountain::Fountain(unsigned int numParticles)
+    : system(numParticles)
+{
+    system.SetEmitter(VART::Point4D::ORIGIN(), 1);
+    system.SetDirection(VART::Point4D::Y(), 0.4);
+    system.SetSpeed(8, 12);
+    system.SetLife(LIFE * 0.9, LIFE);
+    system.SetRate(numParticles / LIFE);
+    system.SetGravity(VART::Point4D(0, -9.8, 0, 0));
+    system.SetDrag(0.1);
+    system.SetPointSize(3); // as dots
+    for (double time = 0; time < LIFE; time += STEP)
+        system.Update(STEP);
+}
+
+static void Update(unsigned long iterations, Fountain* fountainPtr)
+{
+    for (unsigned long i = 0; i < iterations; ++i)
+        fountainPtr->system.Update(STEP);
+    Benchmark::SetCounter("living", fountainPtr->system.GetNumParticles());
+    Benchmark::Use(fountainPtr->system.GetBoundingBox().GetGreaterY());
+}
+
+static void Update100k(unsigned long iterations)
+{
+    static Fountain fountain(100000);
+    Update(iterations, &fountain);
+}
+
+static void Update1M(unsigned long iterations)
+{
+    static Fountain fountain(1000000);
+    Update(iterations, &fountain);
+}
+
+// The side of a fountain, with a scene per case and a viewer shared by them
+class FountainView {
+    public:
+        FountainView();
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+FountainView::FountainView()
+    : camera(VART::Point4D(0, 5, 30), VART::Point4D(0, 5, 0), VART::Point4D::Y())
+{
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+// Draws frames, reporting objects drawn in the last one
+static void Frames(unsigned long iterations, FountainView* viewPtr)
+{
+    static VART::OffscreenViewer viewer(640, 480);
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    viewer.SetScene(viewPtr->scene);
+    viewer.SetCamera(&viewPtr->camera);
+    for (unsigned long i = 0; i < iterations; ++i)
+        viewer.Run(1);
+    Benchmark::SetCounter("objects drawn", viewPtr->scene.GetFrameStats().objectsDrawn);
+}
+
+static void Draw100k(unsigned long iterations)
+{
+    static Fountain fountain(100000);
+    static FountainView view;
+    if (view.scene.GetObjects().empty())
+        view.scene.AddObject(&fountain.system);
+    Frames(iterations, &view);
+}
+
+// Dots placed where the particles of a fountain are
+static void Dots10k(unsigned long iterations)
+{
+    static Fountain fountain(10000);
+    static std::vector<VART::Dot> dotVec(fountain.system.GetNumParticles());
+    static FountainView view;
+    if (view.scene.GetObjects().empty())
+        for (unsigned int i = 0; i < dotVec.size(); ++i)
+        {
+            dotVec[i].position = fountain.system.GetPosition(i);
+            view.scene.AddObject(&dotVec[i]);
+        }
+    Frames(iterations, &view);
+}
+
+static Benchmark update100k("particles/update-100k", &Update100k, 100000);
+static Benchmark update1M("particles/update-1M", &Update1M, 1000000);
+static Benchmark draw100k("particles/draw-100k", &Draw100k, 100000);
+static Benchmark dots10k("particles/dots-10k", &Dots10k, 10000);
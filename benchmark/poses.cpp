@@ -0,0 +1,105 @@
+// Benchmarks for pose replay: restoring recorded skeleton poses.
+
+#include "benchmark.h"
+#include "vart/polyaxialjoint.h"
+#include "vart/dof.h"
+#include "vart/transform.h"
+#include "vart/poserecorder.h"
+#include "vart/poseplayer.h"
+#include <vector>
+#include <cmath>
+
+const unsigned int NUM_JOINTS = 20;
+const unsigned int DOFS_PER_JOINT = 3;
+const unsigned int NUM_FRAMES = 600;
+
+// A chain of joints with three DOFs each, under a moving root transform, and a
+// recording of ten seconds of smooth motion.
+class PoseScene {
+    public:
+        PoseScene();
+        VART::Transform root;
+        std::vector<VART::PolyaxialJoint> joints;
+        std::vector<VART::Dof*> dofs;
+        // Positions of every DOF at every frame
+        std::vector<float> positions;
+        VART::PoseRecorder recorder;
+};
+
+PoseScene::PoseScene() : joints(NUM_JOINTS)
+{
+    VART::Point4D axes[DOFS_PER_JOINT] = { VART::Point4D::X(), VART::Point4D::Y(),
+                                           VART::Point4D::Z() };
+    for (unsigned int j = 0; j < NUM_JOINTS; ++j)
+    {
+        VART::Joint& joint = joints[j];
+        for (unsigned int d = 0; d < DOFS_PER_JOINT; ++d)
+            dofs.push_back(joint.AddDof(axes[d], VART::Point4D::ORIGIN(), -1.5f, 1.5f));
+        if (j == 0)
+            root.AddChild(joint);
+        else
+            joints[j-1].AddChild(joint);
+    }
+    recorder.AddNode(root);
+    recorder.AddTransform(root);
+    unsigned int numDofs = dofs.size();
+    positions.resize(NUM_FRAMES * numDofs);
+    for (unsigned int f = 0; f < NUM_FRAMES; ++f)
+    {
+        double t = f / 60.0;
+        for (unsigned int i = 0; i < numDofs; ++i)
+        {
+            positions[f * numDofs + i] = 0.5f + 0.4f * std::sin(3.0 * t + i);
+            dofs[i]->MoveTo(positions[f * numDofs + i]);
+        }
+        root.MakeTranslation(t, 0, 0);
+        recorder.Record();
+    }
+}
+
+static PoseScene& Scene()
+{
+    static PoseScene scene;
+    return scene;
+}
+
+// Replays the recording
+static void Replay(unsigned long iterations)
+{
+    PoseScene& scene = Scene();
+    VART::PosePlayer player;
+    player.AddNode(&scene.root);
+    player.AddTransform(&scene.root);
+    player.SetData(scene.recorder.GetData());
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        player.Seek(0);
+        while (player.PlayFrame())
+            ;
+    }
+    Benchmark::Use(scene.joints.back().GetData()[12]);
+    Benchmark::SetCounter("bytes/frame",
+                          static_cast<double>(scene.recorder.GetData().size()) / NUM_FRAMES);
+}
+
+// Applies the same poses the way actions do: Dof::MoveTo, which updates the joint at
+// every DOF change
+static void MoveDofs(unsigned long iterations)
+{
+    PoseScene& scene = Scene();
+    unsigned int numDofs = scene.dofs.size();
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        const float* positions = &scene.positions[0];
+        for (unsigned int f = 0; f < NUM_FRAMES; ++f)
+        {
+            for (unsigned int i = 0; i < numDofs; ++i)
+                scene.dofs[i]->MoveTo(*positions++);
+            scene.root.MakeTranslation(f / 60.0, 0, 0);
+        }
+    }
+    Benchmark::Use(scene.joints.back().GetData()[12]);
+}
+
+static Benchmark replay("pose/replay-60dofs", &Replay, NUM_FRAMES);
+static Benchmark moveDofs("pose/move-dofs-60dofs", &MoveDofs, NUM_FRAMES);
@@ -0,0 +1,145 @@
+// Benchmarks for drawing primitives: thousands of spheres drawn from the primitive cache
+// (with and without level of detail), against GLU tessellation at every draw, as spheres
+// were drawn before (reproduced here as "glu" cases).
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/primitivecache.h"
+#include "vart/sphere.h"
+#include "vart/transform.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include <GL/glu.h>
+
+const unsigned int GRID_WIDTH = 50;
+const unsigned int GRID_DEPTH = 40;
+const unsigned int NUM_SPHERES = GRID_WIDTH * GRID_DEPTH;
+
+// Sphere::DrawInstanceOGL before the primitive cache
+class GLUSphere : public VART::Sphere {
+    public:
+        GLUSphere(float radius, const VART::Material& mat)
+            : Sphere(radius), gluRadius(radius), gluMaterial(mat) {}
+        bool DrawInstanceOGL() const;
+        static bool enabled;
+    private:
+        float gluRadius;
+        VART::Material gluMaterial;
+};
+
+bool GLUSphere::enabled = false;
+
+bool GLUSphere::DrawInstanceOGL() const
+{
+    if (!enabled)
+        return Sphere::DrawInstanceOGL();
+    GLUquadricObj* qObj = gluNewQuadric();
+    bool result = gluMaterial.DrawOGL();
+    gluQuadricDrawStyle(qObj, GLU_FILL);
+    gluQuadricNormals(qObj, GLU_SMOOTH);
+    gluSphere(qObj, gluRadius, 15, 15);
+    gluDeleteQuadric(qObj);
+    return result;
+}
+
+// Spheres on a ground grid, seen from above its near edge, so that near spheres are
+// large on screen and far ones are small
+class GroundScene {
+    public:
+        GroundScene();
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+GroundScene::GroundScene()
+    : camera(VART::Point4D(0, 4, 6), VART::Point4D(0, 0, -15), VART::Point4D::Y())
+{
+    root.MakeIdentity();
+    for (unsigned int i = 0; i < GRID_WIDTH; ++i)
+        for (unsigned int j = 0; j < GRID_DEPTH; ++j)
+        {
+            VART::Transform* transPtr = new VART::Transform;
+            transPtr->MakeTranslation(1.0 * i - GRID_WIDTH / 2.0, 0, -1.0 * j);
+            transPtr->autoDelete = true;
+            GLUSphere* spherePtr = new GLUSphere(0.4f, VART::Material::PLASTIC_RED());
+            spherePtr->SetMaterial(VART::Material::PLASTIC_RED());
+            spherePtr->autoDelete = true;
+            transPtr->AddChild(*spherePtr);
+            root.AddChild(*transPtr);
+        }
+    scene.AddObject(&root);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::BRIGHT_AMBIENT());
+}
+
+// Draws frames of the ground scene, with spheres drawn by GLU or with given detail
+static void Frame(unsigned long iterations, bool glu, double detail)
+{
+    static GroundScene ground;
+    static VART::OffscreenViewer viewer(640, 480);
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return;
+    }
+    if (viewer.GetFrameCount() == 0)
+        viewer.SetScene(ground.scene);
+    VART::PrimitiveCache& cache = VART::PrimitiveCache::Instance();
+    double previousDetail = cache.GetDetail();
+    GLUSphere::enabled = glu;
+    cache.SetDetail(detail);
+    viewer.Run(iterations);
+    cache.SetDetail(previousDetail);
+    GLUSphere::enabled = false;
+    const VART::FrameStats& stats = ground.scene.GetFrameStats();
+    if (!glu)
+    {
+        Benchmark::SetCounter("triangles", stats.GetTriangles());
+        Benchmark::SetCounter("vertex bytes", stats.vertexBytes);
+    }
+}
+
+static void SpheresGLU(unsigned long iterations)
+{
+    Frame(iterations, true, 1);
+}
+
+static void Spheres(unsigned long iterations)
+{
+    Frame(iterations, false, 1);
+}
+
+// Finest level for every sphere, regardless of size
+static void SpheresFinest(unsigned long iterations)
+{
+    Frame(iterations, false, 1e9);
+}
+
+// Coarsest level for every sphere
+static void SpheresCoarsest(unsigned long iterations)
+{
+    Frame(iterations, false, 0);
+}
+
+// A cone whose top radius changes continuously adds a bounded number of frustums to the
+// cache
+static bool CheckAnimatedFrustum(std::ostream& os)
+{
+    VART::PrimitiveCache cache;
+    for (unsigned int i = 0; i <= 100000; ++i)
+        cache.GetFrustum(0, 1, i / 100000.0f);
+    if (cache.GetNumTessellations() <= 257)
+        return true;
+    os << "  " << cache.GetNumTessellations() << " tessellations for one level\n";
+    return false;
+}
+
+static Benchmark spheresGLU("primitives/spheres-glu-2000", &SpheresGLU, NUM_SPHERES);
+static Benchmark spheres("primitives/spheres-2000", &Spheres, NUM_SPHERES);
+static Benchmark spheresFinest("primitives/spheres-finest-2000", &SpheresFinest,
+                               NUM_SPHERES);
+static Benchmark spheresCoarsest("primitives/spheres-coarsest-2000", &SpheresCoarsest,
+                                 NUM_SPHERES);
+static Check animatedFrustum("primitives/animated-frustum", &CheckAnimatedFrustum);
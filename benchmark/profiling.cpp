@@ -0,0 +1,98 @@
+// Benchmarks for the cost of profiling zones, per frame bookkeeping and trace export.
+
+#include "benchmark.h"
+#include "vart/profiler.h"
+#include <fstream>
+#include <cstdio>
+
+// Zones recorded per frame by EndFrame benchmarks
+const unsigned int ZONES_PER_FRAME = 200;
+
+static double Work(unsigned long i)
+{
+    return i * 0.5;
+}
+
+static double ZonedWork(unsigned long i)
+{
+    VART_PROFILE_ZONE("ZonedWork");
+    return i * 0.5;
+}
+
+// Reference: the same work with no zone
+static void NoZone(unsigned long iterations)
+{
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        sum += Work(i);
+    Benchmark::Use(sum);
+}
+
+static void ZoneDisabled(unsigned long iterations)
+{
+    VART::Profiler::SetEnabled(false);
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        sum += ZonedWork(i);
+    Benchmark::Use(sum);
+}
+
+static void ZoneEnabled(unsigned long iterations)
+{
+    VART::Profiler::SetEnabled(true);
+    double sum = 0;
+    for (unsigned long i = 0; i < iterations; ++i)
+        sum += ZonedWork(i);
+    VART::Profiler::SetEnabled(false);
+    Benchmark::Use(sum);
+}
+
+// A frame of zones under a few different names, then EndFrame
+static void EndFrame(unsigned long iterations)
+{
+    static const char* names[] = { "Scene::DrawOGL", "MeshObject::DrawInstanceOGL",
+                                   "Material::DrawOGL", "JointAction::Move" };
+    VART::Profiler::SetEnabled(true);
+    for (unsigned long i = 0; i < iterations; ++i)
+    {
+        for (unsigned int z = 0; z < ZONES_PER_FRAME; ++z)
+        {
+            VART_PROFILE_ZONE(names[z % 4]);
+        }
+        VART::Profiler::EndFrame();
+    }
+    VART::Profiler::SetEnabled(false);
+}
+
+// Saves a full buffer of events (the default capacity) as a Chrome trace
+static void SaveTrace(unsigned long iterations)
+{
+    static bool filled = false;
+    if (!filled)
+    {
+        VART::Profiler::Clear();
+        VART::Profiler::SetEnabled(true);
+        for (unsigned int i = 0; i < 65536; ++i)
+            ZonedWork(i);
+        VART::Profiler::SetEnabled(false);
+        filled = true;
+    }
+    for (unsigned long i = 0; i < iterations; ++i)
+        VART::Profiler::SaveChromeTrace("/dev/null");
+    static double bytes = 0;
+    if (bytes == 0)
+    {
+        VART::Profiler::SaveChromeTrace("benchmark_trace.json");
+        std::ifstream file("benchmark_trace.json", std::ios::binary | std::ios::ate);
+        bytes = file.tellg();
+        file.close();
+        std::remove("benchmark_trace.json");
+    }
+    Benchmark::SetCounter("trace bytes", bytes);
+}
+
+static Benchmark noZone("profiler/no-zone", &NoZone, 1);
+static Benchmark zoneDisabled("profiler/zone-disabled", &ZoneDisabled, 1);
+static Benchmark zoneEnabled("profiler/zone-enabled", &ZoneEnabled, 1);
+static Benchmark endFrame("profiler/end-frame-200-zones", &EndFrame, ZONES_PER_FRAME);
+static Benchmark saveTrace("profiler/save-trace-65536-events", &SaveTrace, 65536);
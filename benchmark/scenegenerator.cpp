@@ -0,0 +1,527 @@
+/// \file scenegenerator.cpp
+/// \brief Implementation file for the V-ART procedural scene generator (used by benchmarks).
+/// \version $Revision: 1.1 $
+
+#include "scenegenerator.h"
+#include "vart/scene.h"
+#include "vart/meshobject.h"
+#include "vart/light.h"
+#include "vart/material.h"
+#include "vart/collector.h"
+#include "vart/xmlwriter.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+// Distance between neighbour objects, and between neighbour skeletons
+const double SPACING = 3;
+// Largest turn of a transform of the tree (radians)
+const double TURN = 0.02;
+// Size of skeletons (skeleton5b is about 16 units tall)
+const double SKELETON_SCALE = 0.25;
+// Poses stored for each walking clip
+const unsigned int CLIP_SAMPLES = 32;
+// Half of the side of boxes standing in for meshes of skeleton5b
+const double STAND_IN_SIZE = 0.3;
+
+// A sphere made of triangles, with the smooth normals of a sphere, that can write itself as
+// an OBJ file
+class GeneratedMesh : public VART::MeshObject {
+    public:
+        GeneratedMesh(unsigned int numTriangles, double radius);
+        void WriteOBJ(ostream& os) const;
+};
+
+// Triangles are 2 * segments * (rings - 1), with twice as many segments as rings
+GeneratedMesh::GeneratedMesh(unsigned int numTriangles, double radius)
+{
+    unsigned int rings = static_cast<unsigned int>(0.5 + sqrt(numTriangles / 4.0));
+    if (rings < 2)
+        rings = 2;
+    unsigned int segments = 2 * rings;
+    // Poles, then rings - 1 circles of vertices
+    double normals[] = { 0, 1, 0, 0, -1, 0 };
+    normCoordVec.insert(normCoordVec.end(), normals, normals + 6);
+    for (unsigned int r = 1; r < rings; ++r)
+    {
+        double latitude = M_PI * r / rings;
+        for (unsigned int s = 0; s < segments; ++s)
+        {
+            double longitude = 2 * M_PI * s / segments;
+            normCoordVec.push_back(sin(latitude) * cos(longitude));
+            normCoordVec.push_back(cos(latitude));
+            normCoordVec.push_back(sin(latitude) * sin(longitude));
+        }
+    }
+    for (unsigned int i = 0; i < normCoordVec.size(); ++i)
+        vertCoordVec.push_back(normCoordVec[i] * radius);
+    VART::Mesh mesh;
+    mesh.type = VART::Mesh::TRIANGLES;
+    for (unsigned int s = 0; s < segments; ++s)
+    {
+        unsigned int next = (s + 1) % segments;
+        unsigned int top[] = { 0, 2 + next, 2 + s };
+        unsigned int bottom[] = { 1, 2 + (rings - 2) * segments + s,
+                                  2 + (rings - 2) * segments + next };
+        mesh.indexVec.insert(mesh.indexVec.end(), top, top + 3);
+        mesh.indexVec.insert(mesh.indexVec.end(), bottom, bottom + 3);
+        for (unsigned int r = 0; r + 2 < rings; ++r)
+        {
+            unsigned int corner = 2 + r * segments;
+            unsigned int quad[] = { corner + s, corner + next, corner + segments + s,
+                                    corner + next, corner + segments + next,
+                                    corner + segments + s };
+            mesh.indexVec.insert(mesh.indexVec.end(), quad, quad + 6);
+        }
+    }
+    meshList.push_back(mesh);
+    ComputeBoundingBox();
+}
+
+void GeneratedMesh::WriteOBJ(ostream& os) const
+{
+    os << "o " << GetDescription() << "\n";
+    for (unsigned int i = 0; i < vertCoordVec.size(); i += 3)
+        os << "v " << vertCoordVec[i] << " " << vertCoordVec[i+1] << " " << vertCoordVec[i+2]
+           << "\n";
+    for (unsigned int i = 0; i < normCoordVec.size(); i += 3)
+        os << "vn " << normCoordVec[i] << " " << normCoordVec[i+1] << " "
+           << normCoordVec[i+2] << "\n";
+    const vector<unsigned int>& indexVec = meshList.front().indexVec;
+    for (unsigned int i = 0; i < indexVec.size(); i += 3)
+        os << "f " << indexVec[i] + 1 << "//" << indexVec[i] + 1 << " " << indexVec[i+1] + 1
+           << "//" << indexVec[i+1] + 1 << " " << indexVec[i+2] + 1 << "//"
+           << indexVec[i+2] + 1 << "\n";
+}
+
+// Returns the value of an attribute of the element starting at given position of an XML
+// text (empty if missing)
+static string Attribute(const string& text, size_t element, const string& name)
+{
+    size_t end = text.find('>', element);
+    size_t start = text.find(" " + name + "=\"", element);
+    if ((start == string::npos) || (start > end))
+        return string();
+    start += name.size() + 3;
+    return text.substr(start, text.find('"', start) - start);
+}
+
+// Writes a box centered at a point, as an object of an OBJ file, whose vertices are
+// numbered from firstVertex
+static void WriteBox(ostream& os, const string& name, const double* center,
+                     unsigned int firstVertex)
+{
+    // Corners of each face (bits of corners select +x, +y and +z) and its normal
+    static const unsigned int FACES[] = { 0, 2, 3, 1, 4, 5, 7, 6, 0, 1, 5, 4,
+                                          2, 6, 7, 3, 0, 4, 6, 2, 1, 3, 7, 5 };
+    static const char* const NORMALS[] = { "0 0 -1", "0 0 1", "0 -1 0", "0 1 0", "-1 0 0",
+                                           "1 0 0" };
+    os << "o " << name << "\n";
+    for (unsigned int c = 0; c < 8; ++c)
+        os << "v " << center[0] + ((c & 1) ? STAND_IN_SIZE : -STAND_IN_SIZE) << " "
+           << center[1] + ((c & 2) ? STAND_IN_SIZE : -STAND_IN_SIZE) << " "
+           << center[2] + ((c & 4) ? STAND_IN_SIZE : -STAND_IN_SIZE) << "\n";
+    for (unsigned int n = 0; n < 6; ++n)
+        os << "vn " << NORMALS[n] << "\n";
+    // Each box has 8 vertices and 6 normals
+    unsigned int firstNormal = (firstVertex - 1) / 8 * 6 + 1;
+    for (unsigned int f = 0; f < 6; ++f)
+    {
+        unsigned int n = firstNormal + f;
+        const unsigned int* corners = FACES + f * 4;
+        os << "f " << firstVertex + corners[0] << "//" << n << " "
+           << firstVertex + corners[1] << "//" << n << " "
+           << firstVertex + corners[2] << "//" << n << "\n";
+        os << "f " << firstVertex + corners[0] << "//" << n << " "
+           << firstVertex + corners[2] << "//" << n << " "
+           << firstVertex + corners[3] << "//" << n << "\n";
+    }
+}
+
+SceneGenerator::Parameters::Parameters(unsigned int objects, unsigned int levels,
+                                       unsigned int meshes, unsigned int triangles,
+                                       unsigned int skeletons, unsigned int lights)
+    : numObjects(objects), depth(levels), numMeshes(meshes), numTriangles(triangles),
+      numSkeletons(skeletons), numLights(lights)
+{
+}
+
+SceneGenerator::SceneGenerator(const Parameters& newParams, const string& newDirectory,
+                               const string& newPrefix)
+    : params(newParams), skeletonDirectory(newDirectory), prefix(newPrefix), numGroups(0),
+      skeletonNodeCount(0), skeletonTriangles(0), time(0)
+{
+    if (params.depth < 1)
+        params.depth = 1;
+    if (params.numMeshes < 1)
+        params.numMeshes = 1;
+    // Enough groups in the last level for a few objects each
+    double perLevel = pow(params.numObjects, 1.0 / (params.depth + 1));
+    branching = static_cast<unsigned int>(ceil(perLevel - 1e-9));
+    if (branching < 2)
+        branching = 2;
+    root.MakeIdentity();
+    root.SetDescription("generated");
+}
+
+SceneGenerator::~SceneGenerator()
+{
+    for (unsigned int i = 0; i < meshPtrVec.size(); ++i)
+        delete meshPtrVec[i];
+    for (unsigned int i = 0; i < lightPtrVec.size(); ++i)
+        delete lightPtrVec[i];
+    for (unsigned int i = 0; i < fileNameVec.size(); ++i)
+        remove(fileNameVec[i].c_str());
+}
+
+string SceneGenerator::FileName(const string& name) const
+{
+    return prefix + name;
+}
+
+void SceneGenerator::ObjectPlacement(unsigned int object, VART::Transform* resultPtr) const
+{
+    unsigned int side = static_cast<unsigned int>(ceil(sqrt(params.numObjects)));
+    resultPtr->MakeTranslation((object % side) * SPACING, 1, (object / side) * SPACING);
+}
+
+unsigned int SceneGenerator::FirstObject(unsigned int group) const
+{
+    unsigned long long lastCount = numGroups - levelStartVec.back();
+    // Objects i with i * lastCount / numObjects == group
+    return static_cast<unsigned int>((group * static_cast<unsigned long long>(params.numObjects)
+                                      + lastCount - 1) / lastCount);
+}
+
+void SceneGenerator::SkeletonPlacement(unsigned int skeleton, VART::Transform* resultPtr) const
+{
+    unsigned int side = static_cast<unsigned int>(ceil(sqrt(params.numSkeletons)));
+    VART::Transform rotation;
+    VART::Transform scale;
+    // skeleton5b stands along Z, with its feet at -8.8
+    resultPtr->MakeTranslation((skeleton % side) * SPACING, 8.8 * SKELETON_SCALE,
+                               -SPACING * (2 + skeleton / side));
+    rotation.MakeXRotation(-M_PI / 2);
+    scale.MakeScale(SKELETON_SCALE, SKELETON_SCALE, SKELETON_SCALE);
+    resultPtr->Apply(rotation);
+    resultPtr->Apply(scale);
+}
+
+void SceneGenerator::BuildMeshes()
+{
+    static const VART::Material* materials[] = {
+        &VART::Material::PLASTIC_RED(), &VART::Material::PLASTIC_GREEN(),
+        &VART::Material::PLASTIC_BLUE(), &VART::Material::PLASTIC_WHITE(),
+        &VART::Material::LIGHT_PLASTIC_GRAY() };
+    for (unsigned int m = 0; m < params.numMeshes; ++m)
+    {
+        GeneratedMesh* meshPtr = new GeneratedMesh(params.numTriangles, 0.8 + 0.4 * m /
+                                                   params.numMeshes);
+        ostringstream description;
+        description << "mesh" << m;
+        meshPtr->SetDescription(description.str());
+        meshPtr->SetMaterial(*materials[m % 5]);
+        meshPtrVec.push_back(meshPtr);
+    }
+}
+
+bool SceneGenerator::Build(VART::Scene* scenePtr)
+{
+    BuildMeshes();
+    // Groups: branching^(l+1) in level l, each with branching children in the next one
+    unsigned int count = branching;
+    for (unsigned int l = 0; l < params.depth; ++l)
+    {
+        levelStartVec.push_back(numGroups);
+        numGroups += count;
+        count *= branching;
+    }
+    transformVec.resize(numGroups + params.numObjects);
+    for (unsigned int l = 0; l < params.depth; ++l)
+        for (unsigned int g = levelStartVec[l]; g < ((l + 1 < params.depth) ?
+                                                     levelStartVec[l+1] : numGroups); ++g)
+        {
+            transformVec[g].MakeIdentity();
+            if (l == 0)
+                root.AddChild(transformVec[g]);
+            else
+                transformVec[levelStartVec[l-1] + (g - levelStartVec[l]) / branching]
+                    .AddChild(transformVec[g]);
+        }
+    // Objects in order, split evenly among groups of the last level
+    for (unsigned int i = 0; i < params.numObjects; ++i)
+    {
+        VART::Transform& transform = transformVec[numGroups + i];
+        unsigned int group = static_cast<unsigned int>(static_cast<unsigned long long>(i)
+                                                        * (numGroups - levelStartVec.back())
+                                                        / params.numObjects);
+        ObjectPlacement(i, &transform);
+        transform.AddChild(*meshPtrVec[i % params.numMeshes]);
+        transformVec[levelStartVec.back() + group].AddChild(transform);
+    }
+    // Lights above the middle of the objects
+    double middle = ceil(sqrt(params.numObjects)) * SPACING / 2;
+    for (unsigned int l = 0; l < params.numLights; ++l)
+    {
+        double angle = 2 * M_PI * l / params.numLights;
+        ostringstream description;
+        description << "light" << l;
+        VART::Light* lightPtr = new VART::Light(description.str(), 0.8, 0.2,
+                                                VART::Color::WHITE(),
+                                                VART::Point4D(middle + middle * cos(angle),
+                                                              2 * middle + 10,
+                                                              middle + middle * sin(angle)));
+        lightPtrVec.push_back(lightPtr);
+        scenePtr->AddLight(lightPtr);
+    }
+    if ((params.numSkeletons > 0) && !BuildCrowd())
+        return false;
+    scenePtr->AddObject(&root);
+    Rewind();
+    return true;
+}
+
+bool SceneGenerator::WriteSkeleton()
+{
+    ifstream input((skeletonDirectory + "/skeleton5b.xml").c_str());
+    if (!input)
+    {
+        cerr << "Error: SceneGenerator: cannot read " << skeletonDirectory
+             << "/skeleton5b.xml.\n";
+        return false;
+    }
+    ostringstream textStream;
+    textStream << input.rdbuf();
+    string text = textStream.str();
+    size_t start = text.find('>', text.find("<scene"));
+    size_t end = text.rfind("</scene>");
+    if ((start == string::npos) || (end == string::npos))
+    {
+        cerr << "Error: SceneGenerator: no scene in skeleton5b.xml.\n";
+        return false;
+    }
+    // Meshes are read from the OBJ file written next to the other files
+    string objName = FileName("skeleton.obj");
+    string relativeName = objName.substr(objName.rfind('/') + 1);
+    skeletonNodes = text.substr(start + 1, end - start - 1);
+    for (size_t at = skeletonNodes.find("skeleton5b.obj"); at != string::npos;
+         at = skeletonNodes.find("skeleton5b.obj", at + relativeName.size()))
+        skeletonNodes.replace(at, 14, relativeName);
+    ofstream xml(FileName("skeleton.xml").c_str());
+    xml << "<?xml version=\"1.0\"?>\n<scene description=\"skeleton v5b\">" << skeletonNodes
+        << "</scene>\n";
+    fileNameVec.push_back(FileName("skeleton.xml"));
+    ofstream obj(objName.c_str());
+    fileNameVec.push_back(objName);
+    ifstream meshes((skeletonDirectory + "/skeleton5b.obj").c_str());
+    if (meshes)
+    {
+        obj << meshes.rdbuf();
+        return true;
+    }
+    // Boxes at the position of the last DOF seen before each mesh object (its joint)
+    double position[] = { 0, 0, 0 };
+    unsigned int numVertices = 0;
+    size_t at = text.find('<');
+    while (at != string::npos)
+    {
+        if (text.compare(at, 9, "<position") == 0)
+        {
+            position[0] = atof(Attribute(text, at, "x").c_str());
+            position[1] = atof(Attribute(text, at, "y").c_str());
+            position[2] = atof(Attribute(text, at, "z").c_str());
+        }
+        else if (text.compare(at, 11, "<meshobject") == 0)
+        {
+            WriteBox(obj, Attribute(text, at, "description"), position, numVertices + 1);
+            numVertices += 8;
+        }
+        at = text.find('<', at + 1);
+    }
+    return true;
+}
+
+bool SceneGenerator::BuildCrowd()
+{
+    if (!WriteSkeleton())
+        return false;
+    if (!skeletonScene.LoadFromFile(FileName("skeleton.xml")))
+        return false;
+    VART::SceneNode* modelPtr = skeletonScene.GetObjects().front();
+    crowd.SetModel(modelPtr);
+    if (!leftAction.LoadFromFile(skeletonDirectory + "/left_front.xml", *modelPtr) ||
+        !rightAction.LoadFromFile(skeletonDirectory + "/right_front.xml", *modelPtr))
+        return false;
+    crowd.BakeAction(&leftAction, CLIP_SAMPLES);
+    crowd.BakeAction(&rightAction, CLIP_SAMPLES);
+    VART::Collector<VART::SceneNode> collector;
+    modelPtr->TraverseDepthFirst(&collector);
+    skeletonNodeCount = collector.size();
+    VART::Collector<VART::MeshObject> meshCollector;
+    modelPtr->TraverseDepthFirst(&meshCollector);
+    VART::Collector<VART::MeshObject>::iterator iter = meshCollector.begin();
+    for (; iter != meshCollector.end(); ++iter)
+        skeletonTriangles += const_cast<VART::MeshObject*>(*iter)->NumFaces();
+    VART::Transform placement;
+    for (unsigned int s = 0; s < params.numSkeletons; ++s)
+    {
+        SkeletonPlacement(s, &placement);
+        crowd.AddInstance(placement, s % 2, 0, 1);
+    }
+    root.AddChild(crowd);
+    return true;
+}
+
+void SceneGenerator::Rewind()
+{
+    time = 0;
+    for (unsigned int g = 0; g < numGroups; ++g)
+        transformVec[g].MakeIdentity();
+    for (unsigned int s = 0; s < crowd.GetNumInstances(); ++s)
+        crowd.SetClip(s, s % 2, fmod(s * 0.37, 1.0));
+    crowd.Update(0);
+}
+
+void SceneGenerator::Update(double seconds)
+{
+    time += seconds;
+    // Each group turns back and forth around the vertical axis through the middle of the
+    // objects
+    double middle = (ceil(sqrt(params.numObjects)) - 1) * SPACING / 2;
+    double data[16] = { 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+    for (unsigned int g = 0; g < numGroups; ++g)
+    {
+        double angle = TURN / params.depth * sin(time * (0.5 + 0.1 * (g % 7)) + g);
+        double c = cos(angle);
+        double s = sin(angle);
+        data[0] = c;
+        data[2] = -s;
+        data[8] = s;
+        data[10] = c;
+        data[12] = middle - c * middle - s * middle;
+        data[14] = middle + s * middle - c * middle;
+        transformVec[g].SetData(data);
+    }
+    crowd.Update(static_cast<float>(seconds));
+}
+
+const VART::BoundingBox& SceneGenerator::ComputeBoundingBox()
+{
+    if (crowd.GetNumInstances() > 0)
+        crowd.ComputeBoundingBox();
+    root.RecursiveBoundingBox(&bBox);
+    return bBox;
+}
+
+unsigned int SceneGenerator::GetNumNodes() const
+{
+    unsigned int result = 1 + numGroups + params.numObjects + meshPtrVec.size()
+                          + lightPtrVec.size();
+    if (crowd.GetNumInstances() > 0)
+        result += 1 + skeletonNodeCount;
+    return result;
+}
+
+unsigned long SceneGenerator::GetNumTriangles() const
+{
+    unsigned long result = skeletonTriangles * crowd.GetNumInstances();
+    for (unsigned int i = 0; i < params.numObjects; ++i)
+        result += meshPtrVec[i % params.numMeshes]->NumFaces();
+    return result;
+}
+
+// static
+void SceneGenerator::WriteTransform(VART::XmlWriter* writerPtr, const VART::Transform& trans)
+{
+    static const char* NAMES[] = { " m00=\"", " m01=\"", " m02=\"", " m03=\"",
+                                   " m10=\"", " m11=\"", " m12=\"", " m13=\"",
+                                   " m20=\"", " m21=\"", " m22=\"", " m23=\"",
+                                   " m30=\"", " m31=\"", " m32=\"", " m33=\"" };
+    const double* data = trans.GetData();
+    writerPtr->Append("<matrix");
+    for (unsigned int i = 0; i < 16; ++i)
+        writerPtr->Append(NAMES[i], data[i], "\"");
+    writerPtr->Append("/>");
+}
+
+void SceneGenerator::WriteGroup(VART::XmlWriter* writerPtr, unsigned int level,
+                                unsigned int group, unsigned int indent) const
+{
+    writerPtr->Indent(indent);
+    writerPtr->Append("<node><transform description=\"group\"></transform>\n");
+    if (level + 1 < params.depth)
+        for (unsigned int g = group * branching; g < (group + 1) * branching; ++g)
+            WriteGroup(writerPtr, level + 1, g, indent + 2);
+    else
+        for (unsigned int i = FirstObject(group); i < FirstObject(group + 1); ++i)
+        {
+            writerPtr->Indent(indent + 2);
+            writerPtr->Append("<node><transform description=\"object\">");
+            WriteTransform(writerPtr, transformVec[numGroups + i]);
+            writerPtr->Append("</transform>\n");
+            writerPtr->Indent(indent + 4);
+            writerPtr->Append("<node><meshobject filename=\"");
+            writerPtr->Append(meshPtrVec[i % params.numMeshes]->GetFileName());
+            writerPtr->Append("\" description=\"");
+            writerPtr->Append(meshPtrVec[i % params.numMeshes]->GetDescription());
+            writerPtr->Append("\" type=\"obj\"/></node>\n");
+            writerPtr->Indent(indent + 2);
+            writerPtr->Append("</node>\n");
+        }
+    writerPtr->Indent(indent);
+    writerPtr->Append("</node>\n");
+}
+
+bool SceneGenerator::WriteXML(string* fileNamePtr)
+{
+    // Mesh files, named relative to the scene file
+    for (unsigned int m = 0; m < meshPtrVec.size(); ++m)
+    {
+        string objName = FileName(meshPtrVec[m]->GetDescription() + ".obj");
+        ofstream obj(objName.c_str());
+        fileNameVec.push_back(objName);
+        static_cast<GeneratedMesh*>(meshPtrVec[m])->WriteOBJ(obj);
+        meshPtrVec[m]->SetFileName(objName.substr(objName.rfind('/') + 1));
+    }
+    VART::XmlWriter writer;
+    writer.Append("<?xml version=\"1.0\"?>\n<scene description=\"generated\">\n");
+    for (unsigned int l = 0; l < lightPtrVec.size(); ++l)
+    {
+        const VART::Light& light = *lightPtrVec[l];
+        writer.Append("  <node><pointlight description=\"");
+        writer.Append(light.GetDescription());
+        writer.Append("\"><intensity value=\"", light.GetIntensity(), "\"/>");
+        writer.Append("<ambientIntensity value=\"", light.GetAmbientIntensity(), "\"/>");
+        writer.Append("<color red=\"255\" green=\"255\" blue=\"255\"/>");
+        writer.Append("<position x=\"", light.GetLocation().GetX(), "\"");
+        writer.Append(" y=\"", light.GetLocation().GetY(), "\"");
+        writer.Append(" z=\"", light.GetLocation().GetZ(), "\"/></pointlight></node>\n");
+    }
+    writer.Append("  <node><transform description=\"generated\"></transform>\n");
+    for (unsigned int g = 0; g < branching; ++g)
+        WriteGroup(&writer, 0, g, 4);
+    VART::Transform placement;
+    for (unsigned int s = 0; s < crowd.GetNumInstances(); ++s)
+    {
+        SkeletonPlacement(s, &placement);
+        writer.Append("    <node><transform description=\"skeleton\">");
+        WriteTransform(&writer, placement);
+        writer.Append("</transform>");
+        writer.Append(skeletonNodes);
+        writer.Append("</node>\n");
+    }
+    writer.Append("  </node>\n</scene>\n");
+    *fileNamePtr = FileName("scene.xml");
+    fileNameVec.push_back(*fileNamePtr);
+    if (!writer.SaveToFile(*fileNamePtr))
+    {
+        cerr << "Error: SceneGenerator: cannot write " << *fileNamePtr << ".\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,145 @@
+/// \file scenegenerator.h
+/// \brief Header file for the V-ART procedural scene generator (used by benchmarks).
+/// \version $Revision: 1.1 $
+
+#ifndef VART_SCENEGENERATOR_H
+#define VART_SCENEGENERATOR_H
+
+#include "vart/transform.h"
+#include "vart/xmlstreamscene.h"
+#include "vart/xmlstreamjointaction.h"
+#include "vart/contrib/crowd.h"
+#include <string>
+#include <vector>
+
+namespace VART {
+    class MeshObject;
+    class Light;
+    class XmlWriter;
+}
+
+/// \class SceneGenerator scenegenerator.h
+/// \brief Builds scenes of any size, to measure whole frames on scenes far larger than
+/// those of the demos.
+///
+/// A generated scene has a number of objects, each a transform placing one of a few mesh
+/// objects (spheres of about a given number of triangles, shared by all objects that use
+/// them). Objects stand on a square grid, grouped under a tree of transforms with a given
+/// depth. Beside them, skeletons cloned from skeleton5b walk in place (as instances of a
+/// Crowd), and lights are placed above everything. The animation is a function of time
+/// (see Update): transforms of the tree turn, and skeletons play walking clips baked from
+/// the actions of skeleton5b.
+///
+/// WriteXML writes the same content as files that XmlStreamScene reads (a scene and OBJ
+/// files), so that loaders are measured on it. Skeletons are written as copies of
+/// skeleton5b, standing still, since scene files have no crowds nor actions.
+///
+/// The meshes of skeleton5b (skeleton5b.obj) are not distributed with its scene file. When
+/// they are missing, a box at each joint stands in for each mesh.
+class SceneGenerator {
+    public:
+    // PUBLIC TYPES
+        /// \brief Size of a generated scene.
+        class Parameters {
+            public:
+                Parameters(unsigned int objects, unsigned int levels, unsigned int meshes,
+                           unsigned int triangles, unsigned int skeletons,
+                           unsigned int lights);
+                /// Number of objects (transform and shared mesh object).
+                unsigned int numObjects;
+                /// Levels of transforms above objects (at least one).
+                unsigned int depth;
+                /// Number of distinct mesh objects.
+                unsigned int numMeshes;
+                /// Triangles of each mesh object (rounded to a sphere with as many).
+                unsigned int numTriangles;
+                /// Number of skeletons.
+                unsigned int numSkeletons;
+                /// Number of lights (OpenGL draws up to eight).
+                unsigned int numLights;
+        };
+    // PUBLIC METHODS
+        /// \brief Creates a generator. Nothing is built or written yet.
+        /// \param params [in] Size of the scene.
+        /// \param skeletonDirectory [in] Directory of skeleton5b.xml and its actions.
+        /// \param prefix [in] Start of the names of files written (may include a
+        /// directory).
+        SceneGenerator(const Parameters& params, const std::string& skeletonDirectory,
+                       const std::string& prefix);
+        /// \brief Destroys generated nodes and removes files written.
+        ~SceneGenerator();
+        /// \brief Builds the scene, adding its root and lights to a scene.
+        /// \return False on errors (e.g.: skeleton files not found), reported to cerr.
+        ///
+        /// The generator must outlive the scene. Skeleton files (with stand-in meshes) are
+        /// written, in order to load them.
+        bool Build(VART::Scene* scenePtr);
+        /// \brief Moves the animation to its start.
+        void Rewind();
+        /// \brief Advances the animation.
+        /// \param seconds [in] Time elapsed since the previous update.
+        void Update(double seconds);
+        /// \brief Computes bounding boxes of skeletons and of the whole scene.
+        const VART::BoundingBox& ComputeBoundingBox();
+        /// \brief Writes the scene and its meshes as files.
+        /// \param fileNamePtr [out] Name of the scene file.
+        /// \return False on errors, reported to cerr.
+        bool WriteXML(std::string* fileNamePtr);
+        /// \brief Returns the root of the scene (once built).
+        VART::Transform& GetRoot() { return root; }
+        /// \brief Returns the number of scene nodes (once built), counting shared mesh
+        /// objects and skeletons once.
+        unsigned int GetNumNodes() const;
+        /// \brief Returns the number of triangles drawn in each frame (once built).
+        unsigned long GetNumTriangles() const;
+    private:
+        /// \brief Returns the name of a file written, from the prefix.
+        std::string FileName(const std::string& name) const;
+        /// \brief Creates the mesh objects.
+        void BuildMeshes();
+        /// \brief Writes skeleton5b.xml, referring to OBJ files written by the generator,
+        /// and its meshes (or stand-ins). Keeps the nodes of the scene file.
+        bool WriteSkeleton();
+        /// \brief Loads the skeleton and bakes its clips into the crowd.
+        bool BuildCrowd();
+        /// \brief Returns the placement of a skeleton.
+        void SkeletonPlacement(unsigned int skeleton, VART::Transform* resultPtr) const;
+        /// \brief Returns the placement of an object under its parent.
+        void ObjectPlacement(unsigned int object, VART::Transform* resultPtr) const;
+        /// \brief Returns the first object under a group of the last level (given by its
+        /// index in the level).
+        unsigned int FirstObject(unsigned int group) const;
+        /// \brief Writes a group of the tree, with everything under it, as xml.
+        void WriteGroup(VART::XmlWriter* writerPtr, unsigned int level, unsigned int group,
+                        unsigned int indent) const;
+        /// \brief Writes a placement as xml.
+        static void WriteTransform(VART::XmlWriter* writerPtr, const VART::Transform& trans);
+
+        Parameters params;
+        std::string skeletonDirectory;
+        std::string prefix;
+        /// Children of each group, but those of the last level.
+        unsigned int branching;
+        VART::Transform root;
+        /// Transforms of the tree (level by level), then those of objects.
+        std::vector<VART::Transform> transformVec;
+        unsigned int numGroups;
+        /// First transform of each level of the tree.
+        std::vector<unsigned int> levelStartVec;
+        std::vector<VART::MeshObject*> meshPtrVec;
+        std::vector<VART::Light*> lightPtrVec;
+        /// Skeleton model and walking clips.
+        VART::XmlStreamScene skeletonScene;
+        VART::XmlStreamJointAction leftAction;
+        VART::XmlStreamJointAction rightAction;
+        VART::Crowd crowd;
+        unsigned int skeletonNodeCount;
+        unsigned long skeletonTriangles;
+        /// Elements of the skeleton file inside its scene element.
+        std::string skeletonNodes;
+        double time;
+        VART::BoundingBox bBox;
+        std::vector<std::string> fileNameVec;
+};
+
+#endif
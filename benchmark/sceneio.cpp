@@ -0,0 +1,229 @@
+// Benchmarks for saving scenes: xml printing and binary snapshots.
+
+#include "benchmark.h"
+#include "vart/scene.h"
+#include "vart/scenesnapshot.h"
+#include "vart/polyaxialjoint.h"
+#include "vart/transform.h"
+#include "vart/sphere.h"
+#include "vart/dof.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <vector>
+#include <cstdio>
+
+const unsigned int NUM_LIMBS = 100;
+const unsigned int JOINTS_PER_LIMB = 10;
+const unsigned int NUM_JOINTS = NUM_LIMBS * JOINTS_PER_LIMB;
+// Each joint has three DOFs and a transform child holding a sphere
+const unsigned int NODES_PER_JOINT = 6;
+const unsigned int NUM_NODES = NUM_JOINTS * NODES_PER_JOINT + 1;
+// Printing and saving go to the null device, so that timings hold the cost of serializing and
+// of the system calls made, but not the file system's
+const char* const NULL_FILE_NAME = "/dev/null";
+const char* const SNAPSHOT_FILE_NAME = "sceneio.snp";
+
+// A scene with a root transform holding a hundred limbs of ten polyaxial joints each.
+// Joints are kept by limb, so the scene graph can be walked without SceneNode methods.
+class LimbScene {
+    public:
+        LimbScene();
+        ~LimbScene();
+        // The root must outlive the scene, which deletes the root's children
+        VART::Transform root;
+        VART::Scene scene;
+        std::vector<std::vector<VART::PolyaxialJoint*> > limbVec;
+};
+
+LimbScene::LimbScene() : limbVec(NUM_LIMBS)
+{
+    static const VART::Point4D axes[] = { VART::Point4D::X(), VART::Point4D::Y(),
+                                          VART::Point4D::Z() };
+    static const char* dofNames[] = { "flex", "adduct", "twist" };
+    root.SetDescription("root");
+    root.MakeIdentity();
+    scene.SetDescription("benchmark");
+    scene.AddObject(&root);
+    for (unsigned int l = 0; l < NUM_LIMBS; ++l)
+    {
+        VART::SceneNode* parentPtr = &root;
+        for (unsigned int j = 0; j < JOINTS_PER_LIMB; ++j)
+        {
+            std::ostringstream name;
+            name << "limb" << l << "joint" << j;
+            VART::PolyaxialJoint* jointPtr = new VART::PolyaxialJoint;
+            jointPtr->SetDescription(name.str());
+            jointPtr->autoDelete = true;
+            for (unsigned int d = 0; d < 3; ++d)
+            {
+                VART::Dof* dofPtr = new VART::Dof(axes[d], VART::Point4D(0, j * 0.5, 0),
+                                                  -0.785398, 0.785398);
+                dofPtr->SetDescription(dofNames[d] + name.str());
+                dofPtr->SetRest(0.5);
+                dofPtr->autoDelete = true;
+                jointPtr->AddDof(dofPtr);
+            }
+            jointPtr->MakeLim();
+            VART::Transform* offsetPtr = new VART::Transform;
+            offsetPtr->SetDescription(name.str() + "Offset");
+            offsetPtr->MakeTranslation(0, 0.5, 0);
+            offsetPtr->autoDelete = true;
+            VART::Sphere* spherePtr = new VART::Sphere(0.1);
+            spherePtr->SetDescription(name.str() + "Sphere");
+            spherePtr->autoDelete = true;
+            offsetPtr->AddChild(*spherePtr);
+            jointPtr->AddChild(*offsetPtr);
+            parentPtr->AddChild(*jointPtr);
+            parentPtr = jointPtr;
+            limbVec[l].push_back(jointPtr);
+        }
+    }
+}
+
+LimbScene::~LimbScene()
+{
+    std::remove(SNAPSHOT_FILE_NAME);
+}
+
+static LimbScene& GetLimbScene()
+{
+    static LimbScene limbScene;
+    return limbScene;
+}
+
+// Scene::XmlPrintOn as it was before XmlWriter: a stream insertion per field, an indentation
+// string per node and a flush per DOF and joint.
+static void OldPrintDof(const VART::Dof& dof, std::ostream& os, unsigned int indent)
+{
+    std::string indentStr(indent, ' ');
+    VART::Point4D position = dof.GetPosition();
+    VART::Point4D axis = dof.GetAxis();
+    os << indentStr << "<dof description=\"" << dof.GetDescription() << "\">\n"
+       << indentStr << "  <position x=\"" << position.GetX() << "\" y=\"" << position.GetY()
+                    << "\" z=\"" << position.GetZ() << "\"/>\n"
+       << indentStr << "  <axis x=\"" << axis.GetX() << "\" y=\"" << axis.GetY()
+                    << "\" z=\"" << axis.GetZ() << "\"/>\n"
+       << indentStr << "  <range min=\"" << dof.GetMin() << "\" max=\"" << dof.GetMax()
+                    << "\" rest=\"" << dof.GetRest() << "\"/>\n"
+       << indentStr << "</dof>\n";
+    os << std::flush;
+}
+
+static void OldPrintUnimplemented(const VART::SceneNode& node, std::ostream& os,
+                                  unsigned int indent)
+{
+    std::string indentStr(indent, ' ');
+    os << indentStr << "Unimplemented XmlPrintOn for " << node.GetID() << "\n";
+}
+
+static void OldPrintJoint(const std::vector<VART::PolyaxialJoint*>& limb, unsigned int joint,
+                          std::ostream& os, unsigned int indent)
+{
+    VART::PolyaxialJoint* jointPtr = limb[joint];
+    std::string indentStr(indent, ' ');
+    std::list<VART::Dof*> dofList;
+    jointPtr->GetDofs(&dofList);
+    os << indentStr << "<joint description=\"" << jointPtr->GetDescription()
+       << "\" type=\"poliaxial\">\n";
+    for (std::list<VART::Dof*>::iterator iter = dofList.begin(); iter != dofList.end(); ++iter)
+        OldPrintDof(**iter, os, indent + 2);
+    // Children: the offset transform (holding the sphere), then the next joint
+    VART::Transform offset;
+    OldPrintUnimplemented(offset, os, indent + 2);
+    VART::Sphere sphere;
+    OldPrintUnimplemented(sphere, os, indent + 4);
+    if (joint + 1 < limb.size())
+        OldPrintJoint(limb, joint + 1, os, indent + 2);
+    os << indentStr << "</joint>\n";
+    os << std::flush;
+}
+
+static void OldPrintScene(LimbScene& limbScene, std::ostream& os)
+{
+    os << "<?xml version=\"1.0\"?>\n"
+       << "<!DOCTYPE scene SYSTEM \"vartScene.dtd\">\n"
+       << "<scene description=\"" << limbScene.scene.GetDescription() << "\">\n";
+    os << "  <node>\n";
+    OldPrintUnimplemented(limbScene.root, os, 4);
+    for (unsigned int l = 0; l < NUM_LIMBS; ++l)
+        OldPrintJoint(limbScene.limbVec[l], 0, os, 6);
+    os << "  </node>\n";
+    os << "</scene>\n";
+}
+
+// Whether the old and new printing produce the same text
+static bool SameOutput(std::string* newTextPtr)
+{
+    std::ostringstream oldText;
+    std::ostringstream newText;
+    OldPrintScene(GetLimbScene(), oldText);
+    GetLimbScene().scene.XmlPrintOn(newText);
+    *newTextPtr = newText.str();
+    return oldText.str() == *newTextPtr;
+}
+
+static void PrintOld(unsigned long iterations)
+{
+    LimbScene& limbScene = GetLimbScene();
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        std::ofstream file(NULL_FILE_NAME);
+        OldPrintScene(limbScene, file);
+    }
+}
+
+static void PrintWriter(unsigned long iterations)
+{
+    LimbScene& limbScene = GetLimbScene();
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        std::ofstream file(NULL_FILE_NAME);
+        limbScene.scene.XmlPrintOn(file);
+    }
+    // Timings cover the whole call: compare once
+    static std::string text;
+    static bool same = SameOutput(&text);
+    Benchmark::SetCounter("same as old output", same ? 1 : 0);
+    Benchmark::SetCounter("file kB", text.size() / 1024.0);
+}
+
+static void SaveSnapshot(unsigned long iterations)
+{
+    LimbScene& limbScene = GetLimbScene();
+    size_t size = 0;
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        VART::SceneSnapshot snapshot;
+        snapshot.Capture(limbScene.scene);
+        snapshot.SaveToFile(NULL_FILE_NAME);
+        size = snapshot.GetData().size();
+    }
+    Benchmark::SetCounter("file kB", size / 1024.0);
+}
+
+static void LoadSnapshot(unsigned long iterations)
+{
+    static bool saved = false;
+    if (!saved)
+    {
+        VART::SceneSnapshot snapshot;
+        snapshot.Capture(GetLimbScene().scene);
+        snapshot.SaveToFile(SNAPSHOT_FILE_NAME);
+        saved = true;
+    }
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        VART::Scene scene;
+        VART::SceneSnapshot snapshot;
+        snapshot.LoadFromFile(SNAPSHOT_FILE_NAME);
+        snapshot.Restore(&scene);
+        Benchmark::Use(scene.GetObjects().size());
+    }
+}
+
+static Benchmark printOld("scene-io/xml-print-ostream-6000nodes", &PrintOld, NUM_NODES);
+static Benchmark printWriter("scene-io/xml-print-writer-6000nodes", &PrintWriter, NUM_NODES);
+static Benchmark saveSnapshot("scene-io/snapshot-save-6000nodes", &SaveSnapshot, NUM_NODES);
+static Benchmark loadSnapshot("scene-io/snapshot-load-6000nodes", &LoadSnapshot, NUM_NODES);
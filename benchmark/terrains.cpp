@@ -0,0 +1,237 @@
+// Benchmarks for terrains: frames of a field seen from above its corner, drawn as a
+// heightfield (Terrain) and as a mesh object with a triangle strip per row, as the "campo"
+// example built its field before terrains (reproduced here as "mesh" cases). A streamed
+// case moves the camera over a large heightfield whose tiles are made on demand.
+
+#include "benchmark.h"
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/terrain.h"
+#include "vart/meshobject.h"
+#include "vart/camera.h"
+#include "vart/light.h"
+#include <cmath>
+
+// Height of a sample of the benchmark field
+static float FieldHeight(unsigned int i, unsigned int j)
+{
+    return static_cast<float>(30 * sin(i * 0.05) * cos(j * 0.07)
+                              + 3 * sin(i * 0.21 + j * 0.13));
+}
+
+// The field as a mesh object: a strip per row of cells
+class MeshField : public VART::MeshObject {
+    public:
+        MeshField(unsigned int numCells);
+        // Memory used by vertices, normals and indices
+        unsigned long Bytes() const;
+};
+
+MeshField::MeshField(unsigned int numCells)
+{
+    unsigned int numSamples = numCells + 1;
+    vertCoordVec.reserve(numSamples * numSamples * 3);
+    for (unsigned int i = 0; i < numSamples; ++i)
+        for (unsigned int j = 0; j < numSamples; ++j)
+        {
+            vertCoordVec.push_back(j);
+            vertCoordVec.push_back(FieldHeight(j, i));
+            vertCoordVec.push_back(i);
+        }
+    for (unsigned int i = 0; i < numCells; ++i)
+    {
+        VART::Mesh strip;
+        strip.type = VART::Mesh::TRIANGLE_STRIP;
+        strip.material = VART::Material::PLASTIC_GREEN();
+        for (unsigned int j = 0; j < numSamples; ++j)
+        {
+            strip.indexVec.push_back((i + 1) * numSamples + j);
+            strip.indexVec.push_back(i * numSamples + j);
+        }
+        meshList.push_back(strip);
+    }
+    ComputeVertexNormals();
+    ComputeBoundingBox();
+}
+
+unsigned long MeshField::Bytes() const
+{
+    unsigned long result = (vertCoordVec.capacity() + normCoordVec.capacity()) * sizeof(double)
+                           + (vertVec.capacity() + normVec.capacity()) * sizeof(VART::Point4D);
+    std::list<VART::Mesh>::const_iterator iter = meshList.begin();
+    for (; iter != meshList.end(); ++iter)
+        result += (iter->indexVec.capacity() + iter->normIndVec.capacity())
+                  * sizeof(unsigned int);
+    return result;
+}
+
+// Heights made on demand, for streaming
+class FieldSource : public VART::Terrain::TileSource {
+    public:
+        FieldSource(unsigned int newChunkSize) : chunkSize(newChunkSize) {}
+        virtual bool LoadTile(unsigned int tileX, unsigned int tileZ, unsigned int size,
+                              float* heights)
+        {
+            for (unsigned int j = 0; j < size; ++j)
+                for (unsigned int i = 0; i < size; ++i)
+                    heights[j * size + i] = FieldHeight(tileX * chunkSize + i,
+                                                        tileZ * chunkSize + j);
+            return true;
+        }
+    private:
+        unsigned int chunkSize;
+};
+
+// A field (of either kind) seen from above its corner
+class FieldScene {
+    public:
+        FieldScene(VART::GraphicObj* fieldPtr, unsigned int numCells);
+        VART::Scene scene;
+        VART::Camera camera;
+};
+
+FieldScene::FieldScene(VART::GraphicObj* fieldPtr, unsigned int numCells)
+    : camera(VART::Point4D(-10, 60, -10), VART::Point4D(numCells / 2.0, 0, numCells / 2.0),
+             VART::Point4D::Y())
+{
+    camera.SetNearPlaneDistance(1);
+    camera.SetFarPlaneDistance(1.5 * numCells + 100);
+    scene.AddObject(fieldPtr);
+    scene.AddCamera(&camera);
+    scene.AddLight(VART::Light::SUN());
+}
+
+// Viewer shared by all cases
+static VART::OffscreenViewer* Viewer()
+{
+    static VART::OffscreenViewer viewer(640, 480);
+    if (!viewer.IsValid())
+    {
+        Benchmark::SetCounter("no OpenGL context", 1);
+        return NULL;
+    }
+    return &viewer;
+}
+
+// Draws frames of a field scene, reporting memory (in MB) and triangles of the last frame
+static void Frame(unsigned long iterations, FieldScene* fieldPtr, unsigned long bytes)
+{
+    VART::OffscreenViewer* viewerPtr = Viewer();
+    if (!viewerPtr)
+        return;
+    // The viewer is shared: its camera would stay the one of the first scene
+    viewerPtr->SetScene(fieldPtr->scene);
+    viewerPtr->SetCamera(&fieldPtr->camera);
+    viewerPtr->Run(iterations);
+    Benchmark::SetCounter("memory MB", bytes / 1048576.0);
+    Benchmark::SetCounter("triangles", fieldPtr->scene.GetFrameStats().GetTriangles());
+}
+
+static void Mesh256(unsigned long iterations)
+{
+    static MeshField mesh(256);
+    static FieldScene field(&mesh, 256);
+    Frame(iterations, &field, mesh.Bytes());
+}
+
+static void Mesh1k(unsigned long iterations)
+{
+    static MeshField mesh(1024);
+    static FieldScene field(&mesh, 1024);
+    Frame(iterations, &field, mesh.Bytes());
+}
+
+// The benchmark field as a heightfield
+class HeightField : public VART::Terrain {
+    public:
+        HeightField(unsigned int numCells);
+};
+
+HeightField::HeightField(unsigned int numCells) : Terrain(numCells, numCells, 1)
+{
+    for (unsigned int j = 0; j <= numCells; ++j)
+        for (unsigned int i = 0; i <= numCells; ++i)
+            SetHeight(i, j, FieldHeight(i, j));
+    SetMaterial(VART::Material::PLASTIC_GREEN());
+    ComputeBoundingBox();
+}
+
+static void Terrain256(unsigned long iterations)
+{
+    static HeightField terrain(256);
+    static FieldScene field(&terrain, 256);
+    Frame(iterations, &field, terrain.GetMemoryBytes());
+}
+
+static void Terrain1k(unsigned long iterations)
+{
+    static HeightField terrain(1024);
+    static FieldScene field(&terrain, 1024);
+    Frame(iterations, &field, terrain.GetMemoryBytes());
+}
+
+static void Terrain4k(unsigned long iterations)
+{
+    static HeightField terrain(4096);
+    static FieldScene field(&terrain, 4096);
+    Frame(iterations, &field, terrain.GetMemoryBytes());
+}
+
+// Moves the camera along the diagonal of a streamed terrain, updating its tiles
+class Walk : public VART::ViewerGlutOGL::IdleHandler {
+    public:
+        Walk(VART::Terrain* terrainPtr, VART::Camera* camPtr)
+            : terrain(*terrainPtr), camera(*camPtr), position(0) {}
+        virtual void OnIdle()
+        {
+            double size = terrain.GetNumCellsX() * terrain.GetSpacing();
+            position += 2;
+            if (position > size)
+                position = 0;
+            double height = terrain.GetHeightAt(position, position) + 20;
+            camera.SetLocation(VART::Point4D(position, height, position));
+            camera.SetTarget(VART::Point4D(position + 100, height - 20, position + 100));
+            terrain.Update();
+        }
+    private:
+        VART::Terrain& terrain;
+        VART::Camera& camera;
+        double position;
+};
+
+// Streamed terrain, whose heights are made by a tile source
+class StreamedField : public VART::Terrain {
+    public:
+        StreamedField(TileSource* sourcePtr);
+};
+
+StreamedField::StreamedField(TileSource* sourcePtr) : Terrain(4096, 4096, 1)
+{
+    SetMaterial(VART::Material::PLASTIC_GREEN());
+    SetHeightRange(-33, 33);
+    SetStreamingDistance(600);
+    SetTileSource(sourcePtr);
+}
+
+static void Streamed4k(unsigned long iterations)
+{
+    // The source must outlive the terrain
+    static FieldSource source(64);
+    static StreamedField terrain(&source);
+    static FieldScene field(&terrain, 4096);
+    static Walk walk(&terrain, &field.camera);
+    VART::OffscreenViewer* viewerPtr = Viewer();
+    if (!viewerPtr)
+        return;
+    field.camera.SetFarPlaneDistance(600);
+    viewerPtr->SetIdleHandler(&walk);
+    Frame(iterations, &field, terrain.GetMemoryBytes());
+    viewerPtr->SetIdleHandler(NULL);
+    Benchmark::SetCounter("loaded tiles", terrain.GetNumLoadedTiles());
+}
+
+static Benchmark mesh256("terrain/mesh-256", &Mesh256, 1);
+static Benchmark mesh1k("terrain/mesh-1k", &Mesh1k, 1);
+static Benchmark terrain256("terrain/heightfield-256", &Terrain256, 1);
+static Benchmark terrain1k("terrain/heightfield-1k", &Terrain1k, 1);
+static Benchmark terrain4k("terrain/heightfield-4k", &Terrain4k, 1);
+static Benchmark streamed4k("terrain/streamed-4k", &Streamed4k, 1);
@@ -0,0 +1,206 @@
+// Benchmarks for loading textures shared by many materials.
+
+#include "benchmark.h"
+#include "vart/texturecache.h"
+#include "vart/texture.h"
+#include "vart/meshobject.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <cstdio>
+
+const unsigned int NUM_IMAGES = 8;
+const unsigned int IMAGE_SIZE = 256;
+// Every image is in this many files, under different names
+const unsigned int COPIES_PER_IMAGE = 2;
+const unsigned int NUM_IMAGE_FILES = NUM_IMAGES * COPIES_PER_IMAGE;
+const unsigned int NUM_OBJ_FILES = 16;
+const unsigned int MATERIALS_PER_FILE = 8;
+const unsigned int NUM_REFERENCES = NUM_OBJ_FILES * MATERIALS_PER_FILE;
+
+// PPM images, and OBJ files whose materials use them. Files are written at first use and
+// removed at exit.
+class TextureFiles {
+    public:
+        TextureFiles();
+        ~TextureFiles();
+        static std::string ImageFileName(unsigned int file);
+        static std::string ObjFileName(unsigned int file);
+        static std::string MtlFileName(unsigned int file);
+};
+
+TextureFiles::TextureFiles()
+{
+    for (unsigned int f = 0; f < NUM_IMAGE_FILES; ++f)
+    {
+        unsigned int image = f % NUM_IMAGES;
+        std::ofstream ppm(ImageFileName(f).c_str(), std::ios::binary);
+        ppm << "P6\n# texload\n" << IMAGE_SIZE << " " << IMAGE_SIZE << "\n255\n";
+        for (unsigned int y = 0; y < IMAGE_SIZE; ++y)
+            for (unsigned int x = 0; x < IMAGE_SIZE; ++x)
+                ppm << static_cast<char>(x ^ y) << static_cast<char>((x + image * 31) & 255)
+                    << static_cast<char>((y * image) & 255);
+    }
+    for (unsigned int f = 0; f < NUM_OBJ_FILES; ++f)
+    {
+        std::ofstream mtl(MtlFileName(f).c_str());
+        for (unsigned int m = 0; m < MATERIALS_PER_FILE; ++m)
+            mtl << "newmtl mat" << m << "\nKd 1 1 1\nmap_Kd "
+                << ImageFileName((f + m) % NUM_IMAGE_FILES) << "\n";
+        std::ofstream obj(ObjFileName(f).c_str());
+        obj << "mtllib " << MtlFileName(f) << "\n";
+        for (unsigned int m = 0; m < MATERIALS_PER_FILE; ++m)
+            obj << "o quad" << m << "\nusemtl mat" << m << "\n"
+                << "v 0 0 " << m << "\nv 1 0 " << m << "\nv 1 1 " << m << "\nv 0 1 " << m << "\n"
+                << "vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\nvn 0 0 1\n"
+                << "f " << 4 * m + 1 << "/" << 4 * m + 1 << "/" << m + 1 << " "
+                << 4 * m + 2 << "/" << 4 * m + 2 << "/" << m + 1 << " "
+                << 4 * m + 3 << "/" << 4 * m + 3 << "/" << m + 1 << " "
+                << 4 * m + 4 << "/" << 4 * m + 4 << "/" << m + 1 << "\n";
+    }
+}
+
+TextureFiles::~TextureFiles()
+{
+    for (unsigned int f = 0; f < NUM_IMAGE_FILES; ++f)
+        std::remove(ImageFileName(f).c_str());
+    for (unsigned int f = 0; f < NUM_OBJ_FILES; ++f)
+    {
+        std::remove(ObjFileName(f).c_str());
+        std::remove(MtlFileName(f).c_str());
+    }
+}
+
+std::string TextureFiles::ImageFileName(unsigned int file)
+{
+    std::ostringstream name;
+    name << "texload_" << file << ".ppm";
+    return name.str();
+}
+
+std::string TextureFiles::ObjFileName(unsigned int file)
+{
+    std::ostringstream name;
+    name << "texload_" << file << ".obj";
+    return name.str();
+}
+
+std::string TextureFiles::MtlFileName(unsigned int file)
+{
+    std::ostringstream name;
+    name << "texload_" << file << ".mtl";
+    return name.str();
+}
+
+static void CreateFiles()
+{
+    static TextureFiles files;
+}
+
+// Silences progress messages of the OBJ reader while alive
+class Quiet {
+    public:
+        Quiet() : coutBuf(std::cout.rdbuf(NULL)), clogBuf(std::clog.rdbuf(NULL)) {}
+        ~Quiet() { std::cout.rdbuf(coutBuf); std::clog.rdbuf(clogBuf); }
+    private:
+        std::streambuf* coutBuf;
+        std::streambuf* clogBuf;
+};
+
+static void DeleteAll(std::list<VART::MeshObject*>* listPtr)
+{
+    for (std::list<VART::MeshObject*>::iterator iter = listPtr->begin();
+         iter != listPtr->end(); ++iter)
+        delete *iter;
+    listPtr->clear();
+}
+
+// What loading used to cost: every material reference decodes and uploads its image
+static void LoadUncached(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    VART::TextureCache& cache = VART::TextureCache::Instance();
+    double textureBytes = 0;
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        textureBytes = 0;
+        for (unsigned int f = 0; f < NUM_OBJ_FILES; ++f)
+            for (unsigned int m = 0; m < MATERIALS_PER_FILE; ++m)
+            {
+                cache.Clear();
+                VART::Texture texture;
+                texture.LoadFromFile(TextureFiles::ImageFileName((f + m) % NUM_IMAGE_FILES));
+                textureBytes += cache.GetTextureBytes();
+            }
+    }
+    cache.Clear();
+    Benchmark::SetCounter("texture MB", textureBytes / (1024 * 1024));
+}
+
+// Reads every OBJ file with an empty texture cache. Images are decoded by worker threads
+// while files are parsed, then uploaded.
+static void LoadCold(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    VART::TextureCache& cache = VART::TextureCache::Instance();
+    unsigned long decoded = cache.GetNumDecoded();
+    unsigned int images = 0;
+    double textureBytes = 0;
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        std::list<VART::MeshObject*> meshObjectList;
+        for (unsigned int f = 0; f < NUM_OBJ_FILES; ++f)
+            VART::MeshObject::ReadFromOBJ(TextureFiles::ObjFileName(f), &meshObjectList, false);
+        for (unsigned int f = 0; f < NUM_IMAGE_FILES; ++f)
+        {
+            VART::Texture texture;
+            texture.LoadFromFile(TextureFiles::ImageFileName(f));
+        }
+        Benchmark::Use(meshObjectList.size());
+        DeleteAll(&meshObjectList);
+        images = cache.GetNumImages();
+        textureBytes = cache.GetTextureBytes();
+        cache.Clear();
+    }
+    Benchmark::SetCounter("decodes/load",
+                          static_cast<double>(cache.GetNumDecoded() - decoded) / iterations);
+    Benchmark::SetCounter("images", images);
+    Benchmark::SetCounter("texture MB", textureBytes / (1024 * 1024));
+}
+
+// Reads every OBJ file, loading textures as they are found, with images already cached
+// (from the first run on, so this must run after LoadCold)
+static void LoadWarm(unsigned long iterations)
+{
+    CreateFiles();
+    Quiet quiet;
+    VART::TextureCache& cache = VART::TextureCache::Instance();
+    if (cache.GetNumImages() == 0)
+    {
+        std::list<VART::MeshObject*> meshObjectList;
+        for (unsigned int f = 0; f < NUM_OBJ_FILES; ++f)
+            VART::MeshObject::ReadFromOBJ(TextureFiles::ObjFileName(f), &meshObjectList);
+        DeleteAll(&meshObjectList);
+    }
+    unsigned long decoded = cache.GetNumDecoded();
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        std::list<VART::MeshObject*> meshObjectList;
+        for (unsigned int f = 0; f < NUM_OBJ_FILES; ++f)
+            VART::MeshObject::ReadFromOBJ(TextureFiles::ObjFileName(f), &meshObjectList);
+        Benchmark::Use(meshObjectList.size());
+        DeleteAll(&meshObjectList);
+    }
+    Benchmark::SetCounter("decodes/load",
+                          static_cast<double>(cache.GetNumDecoded() - decoded) / iterations);
+    Benchmark::SetCounter("texture MB",
+                          static_cast<double>(cache.GetTextureBytes()) / (1024 * 1024));
+}
+
+static Benchmark loadUncached("texture/load-uncached-128refs", &LoadUncached, NUM_REFERENCES);
+static Benchmark loadCold("texture/load-cold-128refs", &LoadCold, NUM_REFERENCES);
+static Benchmark loadWarm("texture/load-warm-128refs", &LoadWarm, NUM_REFERENCES);
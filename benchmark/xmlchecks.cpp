@@ -0,0 +1,253 @@
+// Checks that the streaming loaders (XmlStreamScene and XmlStreamJointAction) build the same
+// graphs and actions as the Xerces ones (XmlScene and XmlJointAction). Each loaded scene is
+// described node by node (type, description, matrices, DOFs with their limits, mesh sizes,
+// lights) and each action by its own xml output (joint movers with their keyframes); the
+// descriptions must be identical. Inputs are skeleton5b, with its walking, breathing and
+// resting actions, and a scene from SceneGenerator.
+//
+// Needs Xerces: built into "benchmark-xerces" by "make verify-xml", not into "benchmark".
+// The DTDs are not distributed with the demos, so files are checked without their DOCTYPE
+// (which would make Xerces look for them).
+
+#include "benchmark.h"
+#include "scenegenerator.h"
+#include "vart/xmlscene.h"
+#include "vart/xmlstreamscene.h"
+#include "vart/xmljointaction.h"
+#include "vart/xmlstreamjointaction.h"
+#include "vart/transform.h"
+#include "vart/joint.h"
+#include "vart/dof.h"
+#include "vart/meshobject.h"
+#include "vart/light.h"
+#include "vart/snoperator.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <list>
+#include <typeinfo>
+#include <cstdio>
+
+const char* const SKELETON_DIRECTORY = "skeleton5b";
+const char* const PREFIX = "xmlchecks_";
+const char* const ACTIONS[] = { "left_front", "right_front", "breathe", "rest" };
+const unsigned int NUM_ACTIONS = sizeof(ACTIONS) / sizeof(ACTIONS[0]);
+
+// Describes the nodes it operates on, one line per node or DOF
+class Describer : public VART::SNOperator {
+    public:
+        Describer(std::ostream& os) : output(os) {}
+        virtual void OperateOn(const VART::SceneNode* nodePtr);
+    private:
+        std::ostream& output;
+};
+
+void Describer::OperateOn(const VART::SceneNode* nodePtr)
+{
+    output << typeid(*nodePtr).name() << " '" << nodePtr->GetDescription() << "'";
+    const VART::Transform* transPtr = dynamic_cast<const VART::Transform*>(nodePtr);
+    if (transPtr)
+    {
+        const double* data = transPtr->GetData();
+        for (unsigned int i = 0; i < 16; ++i)
+            output << " " << data[i];
+    }
+    const VART::MeshObject* meshPtr = dynamic_cast<const VART::MeshObject*>(nodePtr);
+    if (meshPtr)
+    {
+        VART::MeshObject* ptr = const_cast<VART::MeshObject*>(meshPtr);
+        output << " faces " << ptr->NumFaces() << " vertices "
+               << ptr->GetVerticesCoordinates().size() / 3;
+    }
+    output << "\n";
+    const VART::Joint* jointPtr = dynamic_cast<const VART::Joint*>(nodePtr);
+    if (jointPtr)
+    {
+        std::list<VART::Dof*> dofList;
+        const_cast<VART::Joint*>(jointPtr)->GetDofs(&dofList);
+        std::list<VART::Dof*>::iterator iter = dofList.begin();
+        for (; iter != dofList.end(); ++iter)
+        {
+            VART::Dof* dofPtr = *iter;
+            output << "  dof '" << dofPtr->GetDescription() << "' axis " << dofPtr->GetAxis()
+                   << " origin " << dofPtr->GetOrigin() << " min " << dofPtr->GetMin()
+                   << " max " << dofPtr->GetMax() << " rest " << dofPtr->GetRest()
+                   << " current " << dofPtr->GetCurrent() << "\n";
+        }
+    }
+}
+
+// Describes the objects (depth first) and lights of a scene
+static std::string Describe(VART::Scene* scenePtr)
+{
+    std::ostringstream os;
+    os << std::setprecision(17);
+    std::list<VART::SceneNode*> objects = scenePtr->GetObjects();
+    Describer describer(os);
+    std::list<VART::SceneNode*>::iterator iter = objects.begin();
+    for (; iter != objects.end(); ++iter)
+        (*iter)->TraverseDepthFirst(&describer);
+    std::list<const VART::Light*> lights = scenePtr->GetLights();
+    std::list<const VART::Light*>::iterator lightIter = lights.begin();
+    for (; lightIter != lights.end(); ++lightIter)
+    {
+        const VART::Light* lightPtr = *lightIter;
+        VART::Color color = lightPtr->GetColor();
+        os << "light '" << lightPtr->GetDescription() << "' intensity "
+           << lightPtr->GetIntensity() << " ambient " << lightPtr->GetAmbientIntensity()
+           << " color " << static_cast<int>(color.GetR()) << " "
+           << static_cast<int>(color.GetG()) << " " << static_cast<int>(color.GetB())
+           << " location " << lightPtr->GetLocation() << "\n";
+    }
+    return os.str();
+}
+
+// Compares two descriptions, reporting the first line that differs
+static bool Compare(std::ostream& os, const std::string& what, const std::string& streamed,
+                    const std::string& expected)
+{
+    if (streamed == expected)
+        return true;
+    std::istringstream streamedLines(streamed);
+    std::istringstream expectedLines(expected);
+    std::string streamedLine;
+    std::string expectedLine;
+    unsigned int line = 1;
+    while (std::getline(expectedLines, expectedLine))
+    {
+        if (!std::getline(streamedLines, streamedLine))
+            streamedLine = "(end)";
+        if (streamedLine != expectedLine)
+            break;
+        ++line;
+    }
+    if (expectedLines.eof())
+    {
+        expectedLine = "(end)";
+        std::getline(streamedLines, streamedLine);
+    }
+    os << "  " << what << ", line " << line << ":\n    streamed: " << streamedLine
+       << "\n    xerces:   " << expectedLine << "\n";
+    return false;
+}
+
+// Copies a file without its DOCTYPE line
+static bool CopyWithoutDoctype(const std::string& source, const std::string& destination)
+{
+    std::ifstream input(source.c_str());
+    std::ofstream output(destination.c_str());
+    std::string line;
+    while (std::getline(input, line))
+        if (line.find("<!DOCTYPE") == std::string::npos)
+            output << line << "\n";
+    return input.eof() && output;
+}
+
+// Loads a scene file with both loaders and compares the results
+static bool CompareScenes(std::ostream& os, const std::string& fileName)
+{
+    VART::XmlStreamScene streamed;
+    VART::XmlScene expected;
+    if (!streamed.LoadFromFile(fileName) || !expected.LoadFromFile(fileName))
+    {
+        os << "  could not load '" << fileName << "'\n";
+        return false;
+    }
+    return Compare(os, fileName, Describe(&streamed), Describe(&expected));
+}
+
+// A scene from the generator, with skeleton5b (as written for it, with stand-in meshes if
+// its own are missing)
+class Files {
+    public:
+        Files();
+        SceneGenerator generator;
+        VART::Scene scene;
+        std::string sceneFileName;
+        std::string skeletonFileName;
+        bool valid;
+};
+
+Files::Files()
+    : generator(SceneGenerator::Parameters(50, 2, 3, 60, 2, 2), SKELETON_DIRECTORY, PREFIX),
+      skeletonFileName(std::string(PREFIX) + "skeleton.xml")
+{
+    valid = generator.Build(&scene) && generator.WriteXML(&sceneFileName);
+}
+
+static Files& GetFiles()
+{
+    static Files files;
+    return files;
+}
+
+static bool CheckSkeleton(std::ostream& os)
+{
+    Files& files = GetFiles();
+    if (!files.valid)
+    {
+        os << "  could not write scene files\n";
+        return false;
+    }
+    return CompareScenes(os, files.skeletonFileName);
+}
+
+static bool CheckGeneratedScene(std::ostream& os)
+{
+    Files& files = GetFiles();
+    if (!files.valid)
+    {
+        os << "  could not write scene files\n";
+        return false;
+    }
+    return CompareScenes(os, files.sceneFileName);
+}
+
+// Loads every action of skeleton5b with both loaders, on the same model
+static bool CheckActions(std::ostream& os)
+{
+    Files& files = GetFiles();
+    VART::XmlStreamScene model;
+    if (!files.valid || !model.LoadFromFile(files.skeletonFileName))
+    {
+        os << "  could not load the skeleton\n";
+        return false;
+    }
+    VART::SceneNode* modelPtr = model.GetObjects().front();
+    bool passed = true;
+    for (unsigned int a = 0; a < NUM_ACTIONS; ++a)
+    {
+        std::string fileName = std::string(PREFIX) + ACTIONS[a] + ".xml";
+        if (!CopyWithoutDoctype(std::string(SKELETON_DIRECTORY) + "/" + ACTIONS[a] + ".xml",
+                                fileName))
+        {
+            os << "  could not copy action '" << ACTIONS[a] << "'\n";
+            passed = false;
+            continue;
+        }
+        VART::XmlStreamJointAction streamed;
+        VART::XmlJointAction expected;
+        if (streamed.LoadFromFile(fileName, *modelPtr)
+            && expected.LoadFromFile(fileName, *modelPtr))
+        {
+            std::ostringstream streamedText;
+            std::ostringstream expectedText;
+            streamedText << std::setprecision(9) << streamed;
+            expectedText << std::setprecision(9) << expected;
+            passed = Compare(os, fileName, streamedText.str(), expectedText.str()) && passed;
+        }
+        else
+        {
+            os << "  could not load action '" << ACTIONS[a] << "'\n";
+            passed = false;
+        }
+        std::remove(fileName.c_str());
+    }
+    return passed;
+}
+
+static Check skeleton("xml/skeleton5b-scene", &CheckSkeleton);
+static Check generatedScene("xml/generated-scene", &CheckGeneratedScene);
+static Check actions("xml/skeleton5b-actions", &CheckActions);
@@ -0,0 +1,173 @@
+// Benchmarks for streaming xml loading: scenes and joint actions read with XmlReader.
+
+#include "benchmark.h"
+#include "vart/xmlstreamscene.h"
+#include "vart/xmlstreamjointaction.h"
+#include "vart/xmlreader.h"
+#include <fstream>
+#include <string>
+#include <cstdio>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+const unsigned int NUM_LIMBS = 100;
+const unsigned int JOINTS_PER_LIMB = 10;
+const unsigned int NUM_JOINTS = NUM_LIMBS * JOINTS_PER_LIMB;
+// Each joint has three DOFs and a transform child
+const unsigned int NODES_PER_JOINT = 5;
+const unsigned int NUM_NODES = NUM_JOINTS * NODES_PER_JOINT + 1;
+const char* const SCENE_FILE_NAME = "xmlload_scene.xml";
+const char* const ACTION_FILE_NAME = "xmlload_action.xml";
+
+// Files with a root transform holding a hundred limbs of ten polyaxial joints each, and
+// an action that moves every DOF. Files are written at first use and removed at exit.
+class XmlFiles {
+    public:
+        XmlFiles();
+        ~XmlFiles();
+        static std::string JointName(unsigned int limb, unsigned int joint);
+        long sceneBytes;
+        long actionBytes;
+};
+
+XmlFiles::XmlFiles()
+{
+    static const char* dofNames[] = { "flex", "adduct", "twist" };
+    static const char* axes[] = { "x=\"1\" y=\"0\" z=\"0\"", "x=\"0\" y=\"1\" z=\"0\"",
+                                  "x=\"0\" y=\"0\" z=\"1\"" };
+    std::ofstream scene(SCENE_FILE_NAME);
+    scene << "<?xml version=\"1.0\"?>\n<!DOCTYPE scene SYSTEM \"vartScene.dtd\">\n"
+          << "<scene description=\"benchmark\">\n<node>\n"
+          << "  <transform description=\"root\"><scale x=\"1\" y=\"1\" z=\"1\"/></transform>\n";
+    for (unsigned int l = 0; l < NUM_LIMBS; ++l)
+    {
+        for (unsigned int j = 0; j < JOINTS_PER_LIMB; ++j)
+        {
+            std::string indent(j * 2 + 2, ' ');
+            std::string name = JointName(l, j);
+            scene << indent << "<node>\n" << indent << "  <joint description=\"" << name
+                  << "\" type=\"polyaxial\">\n";
+            for (unsigned int d = 0; d < 3; ++d)
+                scene << indent << "    <dof description=\"" << dofNames[d] << name << "\">\n"
+                      << indent << "      <position x=\"0\" y=\"" << j * 0.5 << "\" z=\"0\"/>\n"
+                      << indent << "      <axis " << axes[d] << "/>\n"
+                      << indent << "      <range min=\"-0.785398\" max=\"0.785398\" rest=\"0.5\"/>\n"
+                      << indent << "    </dof>\n";
+            scene << indent << "  </joint>\n"
+                  << indent << "  <node>\n"
+                  << indent << "    <transform description=\"" << name << "Offset\">\n"
+                  << indent << "      <translation x=\"0\" y=\"0.5\" z=\"0\"/>\n"
+                  << indent << "    </transform>\n"
+                  << indent << "  </node>\n";
+        }
+        for (unsigned int j = JOINTS_PER_LIMB; j > 0; --j)
+            scene << std::string(j * 2, ' ') << "</node>\n";
+    }
+    scene << "</node>\n</scene>\n";
+    sceneBytes = scene.tellp();
+
+    std::ofstream action(ACTION_FILE_NAME);
+    action << "<?xml version=\"1.0\"?>\n<!DOCTYPE action SYSTEM \"vartAnimation.dtd\">\n"
+           << "<action action_name=\"wave\" speed=\"1\" cycle=\"true\">\n";
+    for (unsigned int l = 0; l < NUM_LIMBS; ++l)
+        for (unsigned int j = 0; j < JOINTS_PER_LIMB; ++j)
+        {
+            action << "  <joint_movement joint_name=\"" << JointName(l, j)
+                   << "\" duration=\"2\">\n    <interpolation type=\"ease-in_ease-out\"/>\n";
+            for (unsigned int d = 0; d < 3; ++d)
+                action << "    <dof_movement dofID=\"" << (d == 0 ? "FLEXION" : d == 1 ? "ADDUCTION" : "TWIST")
+                       << "\" initialTime=\"0\" finalTime=\"0.5\" finalPosition=\"0.6\"/>\n"
+                       << "    <dof_movement dofID=\"" << (d == 0 ? "FLEXION" : d == 1 ? "ADDUCTION" : "TWIST")
+                       << "\" initialTime=\"0.5\" finalTime=\"1\" finalPosition=\"0.5\"/>\n";
+            action << "  </joint_movement>\n";
+        }
+    action << "</action>\n";
+    actionBytes = action.tellp();
+}
+
+XmlFiles::~XmlFiles()
+{
+    std::remove(SCENE_FILE_NAME);
+    std::remove(ACTION_FILE_NAME);
+}
+
+std::string XmlFiles::JointName(unsigned int limb, unsigned int joint)
+{
+    char name[32];
+    std::sprintf(name, "limb%uJoint%u", limb, joint);
+    return name;
+}
+
+static XmlFiles& Files()
+{
+    static XmlFiles files;
+    return files;
+}
+
+// Bytes currently allocated from the heap (zero where unknown)
+static double HeapBytes()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+// Loads the scene and deletes it
+static void LoadScene(unsigned long iterations)
+{
+    XmlFiles& files = Files();
+    double heapGrowth = 0;
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        double heapBefore = HeapBytes();
+        VART::XmlStreamScene scene;
+        scene.LoadFromFile(SCENE_FILE_NAME);
+        heapGrowth = HeapBytes() - heapBefore;
+        Benchmark::Use(scene.GetObjects().size());
+    }
+    Benchmark::SetCounter("file bytes/node", static_cast<double>(files.sceneBytes) / NUM_NODES);
+    if (heapGrowth > 0)
+        Benchmark::SetCounter("scene heap bytes/node", heapGrowth / NUM_NODES);
+}
+
+// Loads the action over a scene that stays in memory
+static void LoadAction(unsigned long iterations)
+{
+    static VART::XmlStreamScene scene;
+    XmlFiles& files = Files();
+    if (scene.GetObjects().empty())
+        scene.LoadFromFile(SCENE_FILE_NAME);
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        VART::XmlStreamJointAction action;
+        action.LoadFromFile(ACTION_FILE_NAME, *scene.GetObjects().front());
+        Benchmark::Use(action.GetDuration());
+    }
+    Benchmark::SetCounter("file bytes/joint", static_cast<double>(files.actionBytes) / NUM_JOINTS);
+}
+
+// Reads the scene file without building anything: cost of the parser alone
+static void ReadOnly(unsigned long iterations)
+{
+    Files();
+    unsigned int bufferSize = 0;
+    for (unsigned long n = 0; n < iterations; ++n)
+    {
+        VART::XmlReader reader;
+        unsigned int value = reader.Intern("x");
+        float x;
+        reader.Open(SCENE_FILE_NAME);
+        while (reader.Next() < VART::XmlReader::END_OF_DOCUMENT)
+            if (reader.GetAttribute(value, &x))
+                Benchmark::Use(x);
+        bufferSize = reader.GetBufferSize();
+    }
+    Benchmark::SetCounter("buffer bytes", bufferSize);
+}
+
+static Benchmark loadScene("xml/load-scene-5000nodes", &LoadScene, NUM_NODES);
+static Benchmark loadAction("xml/load-action-1000joints", &LoadAction, NUM_JOINTS);
+static Benchmark readOnly("xml/read-scene-5000nodes", &ReadOnly, NUM_NODES);
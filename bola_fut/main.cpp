@@ -5,15 +5,21 @@
 #include <vart/sphere.h>
 #include <vart/texture.h>
 #include <vart/transform.h>
+#include <vart/simulationclock.h>
 
 
 using namespace std;
 using namespace VART;
 
+// velocidade angular da bola (radianos por segundo)
+const double VELOCIDADE_ANGULAR_BOLA = 6.0;
+
 class MyIH : public ViewerGlutOGL::IdleHandler {
     private:
         // angulo de rotacao da bolas
         double rotationBolaParameter = 0.1;
+        // relogio de passo fixo: a velocidade da animacao nao depende da taxa de quadros
+        SimulationClock clock;
         
     public:
         // transformacoes que ocorrerao durante a execucao do programa
@@ -25,12 +31,17 @@ class MyIH : public ViewerGlutOGL::IdleHandler {
         }
 
         virtual void OnIdle() {
+            // varia o angulo de rotacao a cada passo de simulacao
+            clock.Update();
+            while (clock.Step())
+                rotationBolaParameter += VELOCIDADE_ANGULAR_BOLA * clock.GetStep();
+            // interpola a fracao de passo ainda nao consumida
+            double angulo = rotationBolaParameter
+                          + clock.GetAlpha() * VELOCIDADE_ANGULAR_BOLA * clock.GetStep();
             // faz a rotacao em X da bola
-            rotationXBola->MakeRotation(Point4D::X(), rotationBolaParameter);
+            rotationXBola->MakeRotation(Point4D::X(), angulo);
             // faz a rotacao em Y da bola
-            rotationYBola->MakeRotation(Point4D::Y(), rotationBolaParameter);
-            // varia o angulo de rotacao
-            rotationBolaParameter += 0.1;
+            rotationYBola->MakeRotation(Point4D::Y(), angulo);
 
             viewerPtr->PostRedisplay();
         }
@@ -0,0 +1,216 @@
+/// \file ballsimulation.h
+/// \brief Header file for V-ART class "BallSimulation".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_BALLSIMULATION_H
+#define VART_BALLSIMULATION_H
+
+#include "vart/point4d.h"
+#include "vart/matrix4.h"
+#include "vart/boundingbox.h"
+#include "vart/workqueue.h"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace VART {
+    class MeshObject;
+    class Terrain;
+    class Transform;
+    class InstanceGroup;
+/// \class BallSimulation ballsimulation.h
+/// \brief Rigid balls that fall, bounce and roll on meshes, terrains and each other.
+///
+/// Each call to Step advances the simulation by a fixed time step, so that it pairs with
+/// a SimulationClock:
+/// \code
+/// clock.Update();
+/// while (clock.Step())
+///     simulation.Step();
+/// simulation.WriteTransforms(transformPtrVec);
+/// \endcode
+/// Balls are kept as arrays of coordinates (one array per coordinate, rather than an
+/// array of balls), so that integration handles several balls at once with SIMD
+/// instructions (see Matrix4 for the instruction sets used). Balls near each other are
+/// found through a uniform grid whose cells are as large as the largest ball. Each ball
+/// then works out its own contacts, against where the balls around it were after the
+/// previous pass (see SetIterations) and against the obstacles: triangles of mesh objects
+/// (see AddMesh), a terrain (see SetTerrain) and the walls of a box (see SetBounds). Since
+/// balls only change themselves, contacts are solved by several threads, and results do
+/// not depend on the number of threads.
+///
+/// Balls are solid spheres of equal density. Friction at contacts with obstacles makes
+/// balls spin, so that they roll instead of sliding; contacts between balls have no
+/// friction.
+    class BallSimulation {
+        public:
+        // PUBLIC METHODS
+            /// \brief Creates an empty simulation, with gravity of 9.8 along -Y and steps of
+            /// 1/60 seconds.
+            BallSimulation();
+            /// \brief Waits for worker threads.
+            ~BallSimulation();
+
+            /// \brief Adds a ball.
+            /// \param position [in] Position of the center.
+            /// \param radius [in] Radius (must be positive).
+            /// \param velocity [in] Initial velocity.
+            /// \return Index of the new ball.
+            unsigned int AddBall(const Point4D& position, double radius,
+                                 const Point4D& velocity = Point4D(0, 0, 0, 0));
+            /// \brief Removes all balls.
+            void ClearBalls();
+            /// \brief Returns the number of balls.
+            unsigned int GetNumBalls() const
+                { return static_cast<unsigned int>(radiusVec.size()); }
+            /// \brief Returns the position of the center of a ball.
+            Point4D GetPosition(unsigned int index) const;
+            /// \brief Moves a ball.
+            void SetPosition(unsigned int index, const Point4D& position);
+            /// \brief Returns the velocity of a ball.
+            Point4D GetVelocity(unsigned int index) const;
+            /// \brief Changes the velocity of a ball.
+            void SetVelocity(unsigned int index, const Point4D& velocity);
+            /// \brief Returns the radius of a ball.
+            double GetRadius(unsigned int index) const { return radiusVec[index]; }
+            /// \brief Computes the placement of a ball: rotation and translation, scaled by
+            /// its radius (so that it places a sphere of radius 1).
+            void GetMatrix(unsigned int index, Matrix4* resultPtr) const;
+
+            /// \brief Adds the triangles of a mesh object as obstacles.
+            /// \param meshObj [in] The mesh object. Meshes of points and lines are ignored.
+            /// \param matrix [in] Placement of the mesh object in the simulation.
+            ///
+            /// Triangles are copied: later changes to the mesh object are not seen.
+            void AddMesh(const MeshObject& meshObj, const Matrix4& matrix);
+            /// \brief Adds the triangles of a mesh object, placed at the origin.
+            void AddMesh(const MeshObject& meshObj);
+            /// \brief Removes all triangles.
+            void ClearMeshes();
+            /// \brief Returns the number of triangles added by AddMesh.
+            unsigned int GetNumTriangles() const
+                { return static_cast<unsigned int>(triangleVec.size() / 9); }
+            /// \brief Sets a terrain as obstacle (NULL for none).
+            ///
+            /// The terrain is placed at the origin. Beyond its borders, balls find the height
+            /// of the nearest border (see Terrain::GetHeightAt). It is not copied, and must
+            /// not be changed (nor updated) during a step.
+            void SetTerrain(const Terrain* terrainPtr) { terrain = terrainPtr; }
+            /// \brief Keeps balls inside a box.
+            void SetBounds(const BoundingBox& box);
+            /// \brief Lets balls go anywhere (the default).
+            void ClearBounds() { hasBounds = false; }
+
+            /// \brief Sets the acceleration of gravity.
+            void SetGravity(const Point4D& acceleration);
+            /// \brief Sets the size of a step, in seconds (see SimulationClock::GetStep).
+            void SetStep(double seconds) { step = seconds; }
+            double GetStep() const { return step; }
+            /// \brief Sets the fraction of the approaching speed kept after a contact (from 0
+            /// to 1, default 0.5).
+            void SetRestitution(double value) { restitution = value; }
+            /// \brief Sets the coefficient of friction of contacts with obstacles (default
+            /// 0.3).
+            void SetFriction(double value) { friction = value; }
+            /// \brief Sets the number of passes over contacts in each step (default 4).
+            ///
+            /// Each pass moves balls apart from where the previous one left them, so that
+            /// piles of balls do not sink into each other. Deep piles need more passes.
+            void SetIterations(unsigned int value) { iterations = (value > 0) ? value : 1; }
+            /// \brief Sets the number of threads that solve contacts (default: number of
+            /// processors). Takes effect before the first step.
+            void SetNumThreads(unsigned int value);
+
+            /// \brief Advances the simulation by one step.
+            void Step();
+
+            /// \brief Writes the placement of balls into transforms (see GetMatrix).
+            /// \param transformPtrVec [in] A transform per ball (from the first ball). NULL
+            /// pointers are skipped, and extra transforms are left untouched.
+            void WriteTransforms(const std::vector<Transform*>& transformPtrVec) const;
+            /// \brief Writes the placement of balls into instances of an instance group (see
+            /// GetMatrix), adding instances if there are fewer instances than balls.
+            ///
+            /// Also computes the bounding box of the group.
+            void WriteInstances(InstanceGroup* groupPtr) const;
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief Job that integrates or solves a range of balls.
+            class RangeJob;
+        // PROTECTED METHODS
+            /// \brief Moves balls in [first, end) by their velocities, after gravity, and turns
+            /// them by their spins.
+            void Integrate(unsigned int first, unsigned int end);
+            /// \brief Solves contacts of balls in [first, end), from positions and velocities
+            /// left by the previous pass into new ones.
+            void Solve(unsigned int first, unsigned int end);
+            /// \brief Runs Integrate or Solve over all balls, split among threads.
+            void RunRanges(bool integrate);
+            /// \brief Pushes a ball out of an obstacle, with bounce and friction.
+            /// \param normal [in] Unit direction from the obstacle to the center of the ball.
+            /// \param depth [in] Penetration depth.
+            /// \param radius [in] Radius of the ball.
+            /// \param position [in,out] Center of the ball.
+            /// \param velocity [in,out] Velocity of the ball.
+            /// \param spin [in,out] Angular velocity of the ball.
+            void Collide(const double* normal, double depth, double radius, double* position,
+                         double* velocity, double* spin) const;
+            /// \brief Puts balls in cells of the ball grid.
+            void BuildBallGrid();
+            /// \brief Puts triangles in cells of the triangle grid.
+            void BuildTriangleGrid();
+            /// \brief Adds a triangle given by the coordinates of its vertices.
+            void AddTriangle(const double* v1, const double* v2, const double* v3);
+            /// \brief Returns the bucket of a grid cell, for tables of 2^n buckets.
+            static unsigned int Bucket(int x, int y, int z, unsigned int mask);
+        // PROTECTED ATTRIBUTES
+            /// Coordinates of the centers.
+            std::vector<double> positionVecs[3];
+            /// Coordinates of velocities.
+            std::vector<double> velocityVecs[3];
+            /// Positions and velocities computed by the current step.
+            std::vector<double> newPositionVecs[3];
+            std::vector<double> newVelocityVecs[3];
+            /// Orientations (unit quaternions: w, then x, y and z).
+            std::vector<double> orientationVecs[4];
+            /// Coordinates of angular velocities.
+            std::vector<double> spinVecs[3];
+            std::vector<double> radiusVec;
+            /// Mass of balls (their volume, up to a constant factor).
+            std::vector<double> massVec;
+            double maxRadius;
+            /// Ball grid: cell of each ball, balls sorted by bucket and start of each bucket
+            /// (plus the end of the last one).
+            std::vector<int> cellVecs[3];
+            std::vector<unsigned int> sortedVec;
+            std::vector<unsigned int> bucketStartVec;
+            double cellSize;
+            unsigned int bucketMask;
+            /// Triangles: coordinates of their three vertices.
+            std::vector<double> triangleVec;
+            /// Triangle grid: triangles sorted by bucket and start of each bucket (plus the
+            /// end of the last one).
+            std::vector<unsigned int> triangleIndexVec;
+            std::vector<unsigned int> triangleStartVec;
+            double triangleCellSize;
+            unsigned int triangleMask;
+            /// Whether triangles changed since the triangle grid was built.
+            bool trianglesChanged;
+            const Terrain* terrain;
+            BoundingBox bounds;
+            bool hasBounds;
+            double gravity[3];
+            double step;
+            double restitution;
+            double friction;
+            unsigned int iterations;
+            unsigned int numThreads;
+            WorkQueue workQueue;
+            /// Jobs of the current step still running.
+            unsigned int pending;
+            std::mutex pendingMutex;
+            std::condition_variable finished;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -0,0 +1,131 @@
+/// \file lazymeshobject.h
+/// \brief Header file for V-ART class "LazyMeshObject".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_LAZYMESHOBJECT_H
+#define VART_LAZYMESHOBJECT_H
+
+#include "vart/meshobject.h"
+#include "vart/boundingbox.h"
+#include <string>
+#include <list>
+
+namespace VART {
+/// \class LazyMeshObject lazymeshobject.h
+/// \brief Mesh object whose geometry is loaded when it comes into view.
+///
+/// A lazy mesh object starts as a placeholder that knows only its bounding box and where
+/// its geometry is (a mesh object in a Wavefront OBJ file). The first time it is drawn
+/// inside the view volume (and, optionally, close enough to the camera) its file is requested
+/// from the MeshCache, which reads it in the background. Objects that have been out of view
+/// for a while are unloaded again when the memory used by loaded objects exceeds a budget.
+///
+/// Loading and unloading happen in Update, which the application must call once per frame,
+/// from the thread that draws. Placeholders are not drawn, and neither are loaded objects
+/// outside the view volume.
+    class LazyMeshObject : public MeshObject {
+        public:
+        // PUBLIC TYPES
+            enum State { UNLOADED, LOADING, LOADED, FAILED };
+        // PUBLIC METHODS
+            /// \brief Creates a placeholder.
+            /// \param fileName [in] Wavefront OBJ file.
+            /// \param meshName [in] Name of the mesh object in the file, also used as
+            /// description.
+            /// \param box [in] Bounding box of the mesh object.
+            LazyMeshObject(const std::string& fileName, const std::string& meshName,
+                           const BoundingBox& box);
+            virtual ~LazyMeshObject();
+
+            /// \brief Returns an unloaded copy of the object.
+            virtual SceneNode* Copy();
+
+            /// \brief Sets the bounding box used while the object is not loaded.
+            void SetPlaceholderBox(const BoundingBox& box);
+
+            State GetState() const { return state; }
+
+            /// \brief Computes the bounding box (the placeholder's, if not loaded).
+            virtual void ComputeBoundingBox();
+
+            /// \brief Checks whether the object is in view, requesting its geometry if so.
+            /// \param modelview [in] Modelview matrix at the object, in OpenGL order.
+            /// \param projection [in] Projection matrix, in OpenGL order.
+            /// \return True if the bounding box is inside the view volume and within the load
+            /// distance.
+            ///
+            /// Drawing calls this method with the current OpenGL matrices. It may also be
+            /// called directly, with no OpenGL context.
+            bool CheckVisibility(const double* modelview, const double* projection) const;
+
+        // PUBLIC STATIC METHODS
+            /// \brief Loads requested objects whose files have been read, and unloads objects
+            /// that have been out of view for too long if over the memory budget.
+            /// \param time [in] Current time in seconds (any origin, always increasing).
+            static void Update(double time);
+
+            /// \brief Sets the largest distance (from the camera, in eye coordinates) at
+            /// which objects are loaded. Zero, the default, means no limit.
+            static void SetLoadDistance(double value) { loadDistance = value; }
+
+            /// \brief Sets for how long (in seconds) an object must be out of view to be
+            /// unloaded. Default: 5 seconds.
+            static void SetUnloadDelay(double value) { unloadDelay = value; }
+
+            /// \brief Sets the memory budget (in bytes) for geometry of loaded objects. Zero,
+            /// the default, means no limit: objects are never unloaded.
+            static void SetBudget(unsigned long value) { budget = value; }
+
+            /// \brief Returns the memory (in bytes) used by geometry of loaded objects.
+            static unsigned long GetLoadedBytes() { return loadedBytes; }
+
+            /// \brief Returns the number of loaded objects.
+            static unsigned int GetNumLoaded() { return numLoaded; }
+
+            /// \brief Creates placeholders for every mesh object in a Wavefront OBJ file.
+            /// \param filename [in] The file name.
+            /// \param resultPtr [out] The address of an empty list to be filled with newly
+            /// allocated (auto-delete) placeholders.
+            /// \return False if the file could not be read.
+            ///
+            /// Only vertex positions and face indices are read, to compute bounding boxes.
+            static bool ReadFromOBJ(const std::string& filename,
+                                    std::list<LazyMeshObject*>* resultPtr);
+        protected:
+        // PROTECTED METHODS
+            /// \brief Draws the object if in view (see CheckVisibility).
+            virtual bool DrawInstanceOGL() const;
+
+            /// \brief Returns the memory used by geometry.
+            unsigned long GeometryBytes() const;
+
+            /// \brief Copies geometry from the MeshCache.
+            void Load();
+
+            /// \brief Discards geometry and releases the file.
+            void Unload();
+
+        // PROTECTED ATTRIBUTES
+            BoundingBox placeholderBox;
+            mutable State state;
+            /// \brief Time the object was last found in view.
+            mutable double lastSeen;
+            /// \brief Memory used by geometry, while loaded.
+            unsigned long bytes;
+            /// Position in instanceList
+            std::list<LazyMeshObject*>::iterator instanceListPos;
+
+        // PROTECTED STATIC ATTRIBUTES
+            /// \brief Every lazy mesh object.
+            static std::list<LazyMeshObject*> instanceList;
+            static double loadDistance;
+            static double unloadDelay;
+            static unsigned long budget;
+            static unsigned long loadedBytes;
+            static unsigned int numLoaded;
+            /// \brief Time of the last Update.
+            static double currentTime;
+    }; // end class declaration
+} // end namespace
+
+#endif
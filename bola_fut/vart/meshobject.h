@@ -12,6 +12,7 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <utility>
 
 namespace VART {
 /// \class MeshObject meshobject.h
@@ -25,11 +26,16 @@ namespace VART {
     class MeshObject : public GraphicObj {
         /// Output operator
         friend std::ostream& operator<<(std::ostream& output, const MeshObject& m);
+        /// Instance groups draw the arrays of a mesh object.
+        friend class InstanceGroup;
+        /// Ball simulations collide with the triangles of a mesh object.
+        friend class BallSimulation;
 
         public:
         // PUBLIC METHODS
             MeshObject();
             MeshObject(const MeshObject& obj);
+            virtual ~MeshObject();
 
             /// \brief Makes a copy of the object, including the children list, but not the
             /// children themselves.
@@ -62,6 +68,10 @@ namespace VART {
             /// old data is discarded and the object can no longer be edited.
             void Optimize();
 
+            /// \brief Checks whether the object keeps vertex arrays for display (as optimized
+            /// objects, boxes and objects read from files do).
+            bool IsOptimized() const { return !vertCoordVec.empty(); }
+
             /// \brief Erases internal structures.
             ///
             /// Erases previous vertices, indices, normals, texture coordinates, etc.
@@ -96,8 +106,48 @@ namespace VART {
             /// \brief Changes one vertex.
             /// \param index [in] Index of the vertex to be changed.
             /// \param newValue [in] New value to be copied into the vertex.
+            ///
+            /// Normals and the bounding box are not updated. To deform an object, use
+            /// UpdateVertices instead.
             void SetVertex(unsigned int index, const Point4D& newValue);
 
+            /// \brief Moves some vertices of an optimized object, updating its normals and
+            /// bounding box.
+            /// \param indices [in] Indices of the vertices to move.
+            /// \param count [in] Number of vertices to move.
+            /// \param coords [in] New coordinates (x, y and z of each vertex, in sequence).
+            /// \return False (leaving the object untouched) if the object is not optimized
+            /// or an index is out of range.
+            ///
+            /// Only the faces around moved vertices get new normals, and only the vertices of
+            /// those faces have their normals recomputed. The bounding box is refitted from
+            /// bounds of blocks of vertices, and only blocks whose bounds may have shrunk are
+            /// scanned again. This relies on vertex-face adjacency, computed on first use and
+            /// whenever meshes or the number of vertices change. Moved vertices and vertices
+            /// with new normals are reported by GetDirtyRanges.
+            bool UpdateVertices(const unsigned int* indices, unsigned int count,
+                                const double* coords);
+
+            /// \brief Moves a range of vertices of an optimized object (see UpdateVertices).
+            /// \param first [in] Index of the first vertex to move.
+            /// \param count [in] Number of vertices to move.
+            /// \param coords [in] New coordinates (x, y and z of each vertex, in sequence).
+            bool UpdateVertexRange(unsigned int first, unsigned int count, const double* coords);
+
+            /// \brief Returns the vertices changed since the last call to ClearDirtyRanges.
+            /// \param resultPtr [out] Ranges of vertices (first index and number of vertices)
+            /// whose coordinates or normals changed, in increasing order.
+            ///
+            /// Only changes made by UpdateVertices and UpdateVertexRange are tracked; other
+            /// changes mark every vertex. Drawing a deformed object re-uploads these ranges
+            /// to its vertex buffer and clears them, so applications that upload vertices
+            /// themselves should get them before the object is drawn.
+            void GetDirtyRanges(std::vector<std::pair<unsigned int, unsigned int> >* resultPtr)
+                const;
+
+            /// \brief Marks every vertex as unchanged (see GetDirtyRanges).
+            void ClearDirtyRanges();
+
             /// \brief Returns the coordinates of the vertices in the object.
             const std::vector<double>& GetVerticesCoordinates() { return vertCoordVec; }
 
@@ -123,6 +173,7 @@ namespace VART {
 
             /// Computes the bounding box.
             virtual void ComputeBoundingBox();
+            /// Computes the bounding box of transformed vertices (vertices are not changed).
             void ComputeBoundingBox(const Transform& trans, BoundingBox* bbPtr);
 
             /// \brief Computes de SubBBoxes and stores them.
@@ -141,7 +192,10 @@ namespace VART {
             /// All vertices, normals, meshes, etc. are copied inside the active object.
             void MergeWith(const MeshObject& obj);
 
-            /// \brief Apply Transformation to all vertices.
+            /// \brief Apply Transformation to all vertices and normals.
+            ///
+            /// Normals are transformed by the inverse transpose and renormalized. Large
+            /// objects are transformed by several threads (see Matrix4::TransformPoints).
             void ApplyTransform(const Transform& trans);
 
             //~ /// \brief Splits the object along some plane parallel to XZ.
@@ -207,9 +261,26 @@ namespace VART {
             /// should delete them.
             static bool ReadFromOBJ(const std::string& filename, std::list<MeshObject*>* resultPtr);
 
+            /// \brief Read MeshObjects from a Wavefront OBJ file, optionally leaving textures
+            /// unloaded.
+            ///
+            /// If loadTextures is false, textures are only requested (see Texture::RequestFile)
+            /// and are uploaded when first drawn. Reading then needs no OpenGL context, so that
+            /// files may be read on worker threads.
+            static bool ReadFromOBJ(const std::string& filename, std::list<MeshObject*>* resultPtr,
+                                    bool loadTextures);
+
             /// \brief Computes the number of faces
             unsigned int NumFaces();
 
+            /// \brief Returns the name of the file the mesh object was read from.
+            ///
+            /// Empty for mesh objects that were not read from a file.
+            const std::string& GetFileName() const { return fileName; }
+
+            /// \brief Sets the name of the file the mesh object was read from.
+            void SetFileName(const std::string& name) { fileName = name; }
+
         // STATIC PUBLIC ATTRIBUTES
             /// Size of normals for rendering (in world coordinates).
             static float sizeOfNormals;
@@ -233,6 +304,52 @@ namespace VART {
                     unsigned int normIndex;
             };
 
+            /// \brief Data kept to deform an object (see UpdateVertices).
+            class Deformation {
+                public:
+                    Deformation();
+                    ~Deformation();
+                    /// Marks every vertex (of an object with numVertices vertices) as
+                    /// unchanged.
+                    void ClearDirty(unsigned int numVertices);
+                    /// Number of vertices and of mesh indices that adjacency was made for
+                    /// (zero if it must be made again).
+                    unsigned int numVertices;
+                    unsigned int numIndices;
+                    /// Vertices of each face, faces in sequence. The first three vertices of
+                    /// a face give its normal.
+                    std::vector<unsigned int> faceVertVec;
+                    /// Start of each face in faceVertVec, plus the end of the last face.
+                    std::vector<unsigned int> faceStartVec;
+                    /// Normals of faces (their coordinates in sequence).
+                    std::vector<double> faceNormalVec;
+                    /// Faces around each vertex: faces of vertex i are in vertFaceVec from
+                    /// vertFaceStartVec[i] up to (excluding) vertFaceStartVec[i+1].
+                    std::vector<unsigned int> vertFaceStartVec;
+                    std::vector<unsigned int> vertFaceVec;
+                    /// Bounds of each block of vertices (minimum x, y and z, then maximum).
+                    std::vector<double> blockBoundsVec;
+                    /// Marks of faces and vertices visited by an update (equal to "mark").
+                    std::vector<unsigned int> faceMarkVec;
+                    std::vector<unsigned int> vertMarkVec;
+                    unsigned int mark;
+                    /// Faces and vertices visited by the current update.
+                    std::vector<unsigned int> faceListVec;
+                    std::vector<unsigned int> vertListVec;
+                    /// Blocks whose bounds must be computed again by the current update.
+                    std::vector<unsigned int> refitListVec;
+                    std::vector<unsigned char> refitVec;
+                    /// Changed vertices and blocks with changed vertices.
+                    std::vector<unsigned char> dirtyVec;
+                    std::vector<unsigned char> dirtyBlockVec;
+                    /// Whether every vertex changed.
+                    bool allDirty;
+                    /// OpenGL buffer holding vertex coordinates, then normals (zero if none).
+                    unsigned int vertexBuffer;
+                    /// Number of vertices the buffer was created for.
+                    unsigned int bufferVertices;
+            };
+
         // PROTECTED METHODS
             virtual bool DrawInstanceOGL() const;
 
@@ -250,6 +367,25 @@ namespace VART {
             /// \brief Normalizes all vertex normals
             void NormalizeAllNormals();
 
+            /// \brief Moves vertices given by indices or, if indices is NULL, a range of
+            /// vertices starting at first (see UpdateVertices).
+            bool Deform(const unsigned int* indices, unsigned int first, unsigned int count,
+                        const double* coords);
+
+            /// \brief Makes vertex-face adjacency, face normals and block bounds, if needed.
+            void PrepareDeformation();
+
+            /// \brief Computes the normal of a vertex from the normals of faces around it.
+            void ComputeDeformedNormal(unsigned int vertex);
+
+            /// \brief Marks deformation data as out of date, after a change that was not
+            /// made by UpdateVertices.
+            void DiscardDeformation();
+
+            /// \brief Sends changed vertices and normals to the vertex buffer.
+            /// \return False if vertex buffers are not available.
+            bool UploadDeformation() const;
+
         // PROTECTED ATTRIBUTES
             /// \brief Vector of all vertices.
             ///
@@ -285,13 +421,20 @@ namespace VART {
             /// \brief List of Meshes
             std::list<Mesh> meshList;
 
+            /// \brief File the mesh object was read from (see GetFileName).
+            std::string fileName;
+
+            /// \brief Deformation data (NULL if the object was never deformed).
+            Deformation* deformationPtr;
+
         // PROTECTED STATIC METHODS
             /// \brief Reads a vertex description from a face on a OBJ file.
             /// \return Returns true if a vertex triple has been read.
             static bool ReadVertex(std::istringstream& iss, unsigned int* vi, unsigned int* ti, unsigned int* ni);
 
             static void ReadMaterialTable(const std::string& filename,
-                                          std::map<std::string,Material>* matMapPtr);
+                                          std::map<std::string,Material>* matMapPtr,
+                                          bool loadTextures = true);
 
             static void ReadVerticesLine(std::istringstream& input,
                                          std::list<VertexTriplet>* resultPtr);
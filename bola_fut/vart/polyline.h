@@ -7,6 +7,7 @@
 
 #include "vart/graphicobj.h"
 #include "vart/material.h"
+#include "vart/curve.h"
 #include <vector>
 
 /// \namespace VART
@@ -46,6 +47,11 @@ namespace VART {
         /// \brief Sets the vertex at index i.
         void Setvertex(unsigned int i, VART::Point4D vertex) { vertexVec[i] = vertex; }
 
+        /// \brief Adds vertices along a curve.
+        /// \param curve [in] The curve to be sampled.
+        /// \param numVertices [in] Number of vertices to add (from curve parameter 0 to 1).
+        void AddCurve(VART::Curve& curve, unsigned int numVertices);
+
         /// \brief Computes the bounding box of the PolyLine.
         virtual void ComputeBoundingBox();
 
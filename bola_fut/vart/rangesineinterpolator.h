@@ -20,6 +20,8 @@ namespace VART {
             void SetMaximunLimit(float maxLimit);
             //~ virtual float GetValue(float n) const;
             virtual float GetValue(float linearIndex, float initialPos, float range) const;
+            virtual void GetValues(const float* linearIndices, unsigned int count,
+                                   float initialPos, float range, float* results) const;
         private:
             float minLimit;
             float maxLimit;
@@ -3,7 +3,7 @@
 /// \version $Revision: 1.8 $
 
 #include "vart/camera.h"
-#include "vart/transform.h"
+#include "vart/matrix4.h"
 
 #ifdef WIN32
 #include <windows.h>
@@ -207,19 +207,19 @@ void VART::Camera::ScaleVisibleVolume(float horScale, float verScale) {
 }
 
 void VART::Camera::YawAroundTarget(float radians) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     trans.MakeRotation(target, up, radians);
     trans.ApplyTo(&location);
 }
 
 void VART::Camera::Yaw(float radians) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     trans.MakeRotation(location, up, radians);
     trans.ApplyTo(&target);
 }
 
 void VART::Camera::Roll(float radians) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     VART::Point4D front = target - location;
 
     front.Normalize();
@@ -228,7 +228,7 @@ void VART::Camera::Roll(float radians) {
 }
 
 void VART::Camera::PitchAroundTarget(float radians) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     VART::Point4D left;
     VART::Point4D front = target - location;
     front.Normalize();
@@ -239,7 +239,7 @@ void VART::Camera::PitchAroundTarget(float radians) {
 }
 
 void VART::Camera::MoveForward(double distance) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     VART::Point4D front = target - location;
     front.Normalize();
     front *= distance;
@@ -249,7 +249,7 @@ void VART::Camera::MoveForward(double distance) {
 }
 
 void VART::Camera::MoveSideways(double distance) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     VART::Point4D right;
 
     trans.MakeRotation(up,-1.5707963267948966192313216916398);
@@ -263,7 +263,7 @@ void VART::Camera::MoveSideways(double distance) {
 }
 
 void VART::Camera::MoveUp(double distance) {
-    VART::Transform trans;
+    VART::Matrix4 trans;
     VART::Point4D translation(up);
 
     translation.Normalize();
@@ -0,0 +1,288 @@
+/// \file lazymeshobject.cpp
+/// \brief Implementation file for V-ART class "LazyMeshObject".
+/// \version $Revision: 1.1 $
+
+#include "vart/lazymeshobject.h"
+#include "vart/profiler.h"
+#include "vart/meshcache.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#ifdef VART_OGL
+#include <GL/gl.h>
+#endif
+
+using namespace std;
+
+list<VART::LazyMeshObject*> VART::LazyMeshObject::instanceList;
+double VART::LazyMeshObject::loadDistance = 0;
+double VART::LazyMeshObject::unloadDelay = 5;
+unsigned long VART::LazyMeshObject::budget = 0;
+unsigned long VART::LazyMeshObject::loadedBytes = 0;
+unsigned int VART::LazyMeshObject::numLoaded = 0;
+double VART::LazyMeshObject::currentTime = 0;
+
+VART::LazyMeshObject::LazyMeshObject(const string& file, const string& meshName,
+                                     const BoundingBox& box)
+    : placeholderBox(box), state(UNLOADED), lastSeen(0), bytes(0)
+{
+    fileName = file;
+    description = meshName;
+    bBox = box;
+    recBBox = box;
+    instanceListPos = instanceList.insert(instanceList.end(), this);
+}
+
+VART::LazyMeshObject::~LazyMeshObject()
+{
+    if (state != UNLOADED)
+        Unload();
+    instanceList.erase(instanceListPos);
+}
+
+VART::SceneNode* VART::LazyMeshObject::Copy()
+{
+    return new LazyMeshObject(fileName, description, placeholderBox);
+}
+
+void VART::LazyMeshObject::SetPlaceholderBox(const BoundingBox& box)
+{
+    placeholderBox = box;
+    if (state != LOADED)
+    {
+        ComputeBoundingBox();
+        ComputeRecursiveBoundingBox();
+    }
+}
+
+void VART::LazyMeshObject::ComputeBoundingBox()
+{
+    if (state == LOADED)
+        MeshObject::ComputeBoundingBox();
+    else
+        bBox = placeholderBox;
+}
+
+bool VART::LazyMeshObject::CheckVisibility(const double* modelview,
+                                           const double* projection) const
+{
+    // Corners in clip coordinates are tested against each plane of the view volume; the
+    // box is out of view if all corners are outside the same plane.
+    unsigned int outside[6] = { 0, 0, 0, 0, 0, 0 };
+    double eyeMin[3] = { HUGE_VAL, HUGE_VAL, HUGE_VAL };
+    double eyeMax[3] = { -HUGE_VAL, -HUGE_VAL, -HUGE_VAL };
+    for (unsigned int i = 0; i < 8; ++i)
+    {
+        double corner[4] = { (i & 1) ? bBox.GetGreaterX() : bBox.GetSmallerX(),
+                             (i & 2) ? bBox.GetGreaterY() : bBox.GetSmallerY(),
+                             (i & 4) ? bBox.GetGreaterZ() : bBox.GetSmallerZ(), 1 };
+        double eye[4];
+        double clip[4];
+        for (unsigned int row = 0; row < 4; ++row)
+            eye[row] = modelview[row] * corner[0] + modelview[row+4] * corner[1] +
+                       modelview[row+8] * corner[2] + modelview[row+12];
+        for (unsigned int row = 0; row < 4; ++row)
+            clip[row] = projection[row] * eye[0] + projection[row+4] * eye[1] +
+                        projection[row+8] * eye[2] + projection[row+12] * eye[3];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            if (clip[axis] < -clip[3])
+                ++outside[axis*2];
+            if (clip[axis] > clip[3])
+                ++outside[axis*2+1];
+            eyeMin[axis] = min(eyeMin[axis], eye[axis]);
+            eyeMax[axis] = max(eyeMax[axis], eye[axis]);
+        }
+    }
+    for (unsigned int plane = 0; plane < 6; ++plane)
+        if (outside[plane] == 8)
+            return false;
+    if (loadDistance > 0)
+    { // distance from the camera (the eye origin) to the box, in eye coordinates
+        double squaredDistance = 0;
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            double d = max(eyeMin[axis], 0.0) + min(eyeMax[axis], 0.0);
+            squaredDistance += d * d;
+        }
+        if (squaredDistance > loadDistance * loadDistance)
+            return false;
+    }
+    lastSeen = currentTime;
+    if (state == UNLOADED)
+    {
+        MeshCache::Instance().Request(fileName);
+        state = LOADING;
+    }
+    return true;
+}
+
+void VART::LazyMeshObject::Update(double time)
+{
+    currentTime = time;
+    MeshCache& cache = MeshCache::Instance();
+    list<LazyMeshObject*>::iterator iter = instanceList.begin();
+    for (; iter != instanceList.end(); ++iter)
+        if (((*iter)->state == LOADING) && cache.IsReady((*iter)->fileName))
+            (*iter)->Load();
+    if ((budget == 0) || (loadedBytes <= budget))
+        return;
+    // Unload objects out of view for long enough, least recently seen first
+    vector<pair<double, LazyMeshObject*> > candidateVec;
+    for (iter = instanceList.begin(); iter != instanceList.end(); ++iter)
+        if (((*iter)->state == LOADED) && ((*iter)->lastSeen + unloadDelay < time))
+            candidateVec.push_back(make_pair((*iter)->lastSeen, *iter));
+    sort(candidateVec.begin(), candidateVec.end());
+    for (unsigned int i = 0; (i < candidateVec.size()) && (loadedBytes > budget); ++i)
+        candidateVec[i].second->Unload();
+}
+
+bool VART::LazyMeshObject::DrawInstanceOGL() const
+{
+    VART_PROFILE_ZONE("LazyMeshObject::DrawInstanceOGL");
+#ifdef VART_OGL
+    double modelview[16];
+    double projection[16];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    if (CheckVisibility(modelview, projection) && (state == LOADED))
+        return MeshObject::DrawInstanceOGL();
+    return true;
+#else
+    return false;
+#endif
+}
+
+unsigned long VART::LazyMeshObject::GeometryBytes() const
+{
+    unsigned long result = vertVec.capacity() * sizeof(Point4D) +
+                           vertCoordVec.capacity() * sizeof(double) +
+                           normVec.capacity() * sizeof(Point4D) +
+                           normCoordVec.capacity() * sizeof(double) +
+                           textCoordVec.capacity() * sizeof(float);
+    list<Mesh>::const_iterator iter = meshList.begin();
+    for (; iter != meshList.end(); ++iter)
+        result += sizeof(Mesh) + (iter->indexVec.capacity() + iter->normIndVec.capacity())
+                                 * sizeof(unsigned int);
+    return result;
+}
+
+void VART::LazyMeshObject::Load()
+{
+    state = LOADED;
+    if (!MeshCache::Instance().GetMeshObject(fileName, description, this))
+    {
+        Clear();
+        MeshCache::Instance().Release(fileName);
+        state = FAILED;
+        ComputeBoundingBox();
+        return;
+    }
+    bytes = GeometryBytes();
+    loadedBytes += bytes;
+    ++numLoaded;
+}
+
+void VART::LazyMeshObject::Unload()
+{
+    if (state == FAILED)
+        return;
+    if (state == LOADED)
+    {
+        // Clearing does not free vector storage
+        vector<Point4D>().swap(vertVec);
+        vector<double>().swap(vertCoordVec);
+        vector<Point4D>().swap(normVec);
+        vector<double>().swap(normCoordVec);
+        vector<float>().swap(textCoordVec);
+        meshList.clear();
+        loadedBytes -= bytes;
+        bytes = 0;
+        --numLoaded;
+    }
+    MeshCache::Instance().Release(fileName);
+    state = UNLOADED;
+    ComputeBoundingBox();
+    ComputeRecursiveBoundingBox();
+}
+
+bool VART::LazyMeshObject::ReadFromOBJ(const string& filename,
+                                       list<LazyMeshObject*>* resultPtr)
+{
+    ifstream file(filename.c_str());
+    if (!file)
+    {
+        cerr << "Error: LazyMeshObject::ReadFromOBJ: could not open '" << filename << "'.\n";
+        return false;
+    }
+    vector<double> vertCoordVec;
+    BoundingBox box;
+    bool hasBox = false;
+    string name;
+    string line;
+    while (getline(file, line))
+    {
+        const char* linePtr = line.c_str();
+        if ((linePtr[0] == 'v') && (linePtr[1] == ' '))
+        {
+            char* endPtr = const_cast<char*>(linePtr + 1);
+            for (unsigned int i = 0; i < 3; ++i)
+                vertCoordVec.push_back(strtod(endPtr, &endPtr));
+        }
+        else if ((linePtr[0] == 'f') && (linePtr[1] == ' '))
+        {
+            // Face vertices are "vi", "vi/ti", "vi//ni" or "vi/ti/ni"; only vi matters.
+            char* endPtr = const_cast<char*>(linePtr + 1);
+            while (true)
+            {
+                long index = strtol(endPtr, &endPtr, 10);
+                if (index == 0)
+                    break;
+                size_t base = (index > 0) ? (index - 1) * 3 : vertCoordVec.size() + index * 3;
+                if (base + 2 < vertCoordVec.size())
+                {
+                    if (hasBox)
+                        box.ConditionalUpdate(vertCoordVec[base], vertCoordVec[base+1],
+                                              vertCoordVec[base+2]);
+                    else
+                    {
+                        box.SetBoundingBox(vertCoordVec[base], vertCoordVec[base+1],
+                                           vertCoordVec[base+2], vertCoordVec[base],
+                                           vertCoordVec[base+1], vertCoordVec[base+2]);
+                        hasBox = true;
+                    }
+                }
+                while ((*endPtr != '\0') && (*endPtr != ' ') && (*endPtr != '\t'))
+                    ++endPtr;
+            }
+        }
+        else if ((linePtr[0] == 'o') && (linePtr[1] == ' '))
+        {
+            if (hasBox)
+            {
+                box.ProcessCenter();
+                resultPtr->push_back(new LazyMeshObject(filename, name, box));
+                resultPtr->back()->autoDelete = true;
+            }
+            hasBox = false;
+            istringstream iss(line.substr(1));
+            iss >> name;
+        }
+    }
+    if (hasBox)
+    {
+        box.ProcessCenter();
+        resultPtr->push_back(new LazyMeshObject(filename, name, box));
+        resultPtr->back()->autoDelete = true;
+    }
+    return true;
+}
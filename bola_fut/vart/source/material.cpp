@@ -3,6 +3,8 @@
 /// \version $Revision: 1.5 $
 
 #include "vart/material.h"
+#include "vart/framestats.h"
+#include "vart/profiler.h"
 
 #ifdef WIN32
 #include <windows.h>
@@ -110,9 +112,11 @@ void VART::Material::SetTexture(const Texture& t)
 
 bool VART::Material::DrawOGL() const
 {
+    VART_PROFILE_ZONE("Material::DrawOGL");
 #ifdef VART_OGL
     float fVec[4];
 
+    ++FrameStats::current.materialBinds;
     texture.DrawOGL();
     color.Get(fVec);
     glColor4fv(fVec);
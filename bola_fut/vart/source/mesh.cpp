@@ -3,6 +3,7 @@
 /// \version $Revision: 1.1 $
 
 #include "vart/mesh.h"
+#include "vart/framestats.h"
 
 using namespace std;
 
@@ -65,6 +66,8 @@ bool VART::Mesh::DrawInstanceOGL() const {
     else
         glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     glDrawElements(GetOglType(type), indexVec.size(), GL_UNSIGNED_INT, &indexVec[0]);
+    ++FrameStats::current.drawCalls[type];
+    FrameStats::current.indices[type] += indexVec.size();
     return result;
 #else
     return false;
@@ -0,0 +1,109 @@
+/// \file poserecorder.cpp
+/// \brief Implementation file for V-ART class "PoseRecorder".
+/// \version $Revision: 1.1 $
+
+#include "vart/poserecorder.h"
+#include "vart/joint.h"
+#include "vart/dof.h"
+#include "vart/collector.h"
+
+#include <fstream>
+#include <cstring>
+#include <cassert>
+
+using namespace std;
+
+const unsigned char VART::PoseRecorder::VERSION = 1;
+
+VART::PoseRecorder::PoseRecorder() : numFrames(0), keyFrameInterval(60)
+{
+}
+
+void VART::PoseRecorder::AddNode(const SceneNode& node)
+{
+    assert(numFrames == 0);
+    Collector<Joint> collector;
+    node.TraverseDepthFirst(&collector);
+    list<Dof*> dofList;
+    for (Collector<Joint>::iterator iter = collector.begin(); iter != collector.end(); ++iter)
+        const_cast<Joint*>(*iter)->GetDofs(&dofList);
+    dofVec.insert(dofVec.end(), dofList.begin(), dofList.end());
+}
+
+void VART::PoseRecorder::AddTransform(const Transform& trans)
+{
+    assert(numFrames == 0);
+    transformVec.push_back(&trans);
+}
+
+void VART::PoseRecorder::Clear()
+{
+    data.clear();
+    numFrames = 0;
+}
+
+void VART::PoseRecorder::Append(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<unsigned char>(value));
+}
+
+void VART::PoseRecorder::Record()
+{
+    unsigned int numDofs = dofVec.size();
+    unsigned int numTransforms = transformVec.size();
+    if (numFrames == 0)
+    {
+        data.clear();
+        data.push_back('V'); data.push_back('P'); data.push_back('O'); data.push_back('S');
+        data.push_back(VERSION);
+        Append(numDofs);
+        Append(numTransforms);
+    }
+    bool keyFrame = (keyFrameInterval == 0) ? (numFrames == 0)
+                                            : (numFrames % keyFrameInterval == 0);
+    if (keyFrame)
+    {
+        previousDofVec.assign(numDofs, 0);
+        previousTransformVec.assign(numTransforms * 16, 0);
+    }
+    data.push_back(keyFrame ? 1 : 0);
+    for (unsigned int i = 0; i < numDofs; ++i)
+    {
+        float position = dofVec[i]->GetCurrent();
+        unsigned int bits;
+        memcpy(&bits, &position, sizeof(bits));
+        int delta = static_cast<int>(bits - previousDofVec[i]);
+        Append((static_cast<unsigned int>(delta) << 1) ^ static_cast<unsigned int>(delta >> 31));
+        previousDofVec[i] = bits;
+    }
+    unsigned long long* previousPtr = numTransforms ? &previousTransformVec[0] : NULL;
+    for (unsigned int i = 0; i < numTransforms; ++i)
+    {
+        const double* matrix = transformVec[i]->GetData();
+        for (unsigned int j = 0; j < 16; ++j)
+        {
+            unsigned long long bits;
+            memcpy(&bits, matrix + j, sizeof(bits));
+            long long delta = static_cast<long long>(bits - *previousPtr);
+            Append((static_cast<unsigned long long>(delta) << 1) ^
+                   static_cast<unsigned long long>(delta >> 63));
+            *previousPtr++ = bits;
+        }
+    }
+    ++numFrames;
+}
+
+bool VART::PoseRecorder::SaveToFile(const string& fileName) const
+{
+    ofstream file(fileName.c_str(), ios::out | ios::binary);
+    if (!file)
+        return false;
+    if (!data.empty())
+        file.write(reinterpret_cast<const char*>(&data[0]), data.size());
+    return static_cast<bool>(file);
+}
@@ -3,12 +3,14 @@
 /// \version $Revision: 1.9 $
 
 #include "vart/scenenode.h"
+#include "vart/framestats.h"
 #include "vart/joint.h"
 #include "vart/meshobject.h"
 #include "vart/transform.h"
 #include "vart/sgpath.h"
 #include "vart/snoperator.h"
 #include "vart/snlocator.h"
+#include "vart/xmlwriter.h"
 
 #include <cassert>
 using namespace std;
@@ -75,6 +77,7 @@ bool VART::SceneNode::DetachChild(SceneNode* childPtr)
 
 bool VART::SceneNode::DrawOGL() const
 {
+    ++FrameStats::current.nodesVisited;
     bool result = DrawInstanceOGL();
     list<VART::SceneNode*>::const_iterator iter = childList.begin();
     for (; iter != childList.end(); ++iter)
@@ -280,15 +283,23 @@ int VART::SceneNode::GetNodeTypeList( TypeID type, std::list<SceneNode*>& nodeLi
 
 void VART::SceneNode::XmlPrintOn(ostream& os, unsigned int indent) const
 // virtual method
+{
+    XmlWriter writer;
+    XmlWrite(&writer, indent);
+    writer.WriteTo(os);
+}
+
+void VART::SceneNode::XmlWrite(XmlWriter* writerPtr, unsigned int indent) const
+// virtual method
 {
     list<SceneNode*>::const_iterator iter = childList.begin();
-    string indentStr(indent,' ');
 
-    os << indentStr << "Unimplemented XmlPrintOn for " << GetID() << "\n";
+    writerPtr->Indent(indent);
+    writerPtr->Append("Unimplemented XmlPrintOn for ", GetID(), "\n");
     if (recursivePrinting)
         while (iter != childList.end())
         {
-            (*iter)->XmlPrintOn(os, indent + 2);
+            (*iter)->XmlWrite(writerPtr, indent + 2);
             ++iter;
         }
 }
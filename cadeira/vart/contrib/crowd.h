@@ -0,0 +1,192 @@
+/// \file crowd.h
+/// \brief Header file for V-ART class "Crowd" (contrib).
+/// \version $Revision: 1.1 $
+
+#ifndef VART_CROWD_H
+#define VART_CROWD_H
+
+#include "vart/graphicobj.h"
+#include "vart/instancegroup.h"
+#include "vart/matrix4.h"
+#include <vector>
+
+namespace VART {
+    class Joint;
+    class JointAction;
+    class MeshObject;
+/// \class Crowd crowd.h
+/// \brief Many instances of an articulated model sharing skeleton and animation data.
+///
+/// A crowd draws a single model (usually a skeleton with meshes, such as a Human or its
+/// root joint) many times. The model and its meshes are shared by all instances: each
+/// instance holds only a root transform, a clip (animation) index, a phase and a playback
+/// speed. Clips are either baked from a JointAction (see BakeAction), which stores one
+/// cycle of the action as a table of joint matrices, or "live" (see LIVE_CLIP), which
+/// means the instance shows whatever pose the model currently has.
+///
+/// Update() advances all instances (in parallel, for large crowds) and groups them by
+/// pose, so that each distinct pose is applied to the model once per frame, no matter how
+/// many instances show it. For each pose, the model is traversed once and each of its
+/// optimized mesh objects is drawn by an InstanceGroup, placed by the root matrices of the
+/// instances in that pose: draw calls grow with poses times meshes, not with instances.
+/// Other graphic objects in the model (e.g.: spheres, cylinders) are drawn instance by
+/// instance. The model should not be part of the scene graph by itself; add the crowd
+/// instead.
+    class Crowd : public GraphicObj {
+        public:
+        // PUBLIC STATIC ATTRIBUTES
+            /// \brief Clip index for instances that show the current pose of the model.
+            static const unsigned int LIVE_CLIP;
+        // PUBLIC STATIC METHODS
+            /// \brief Returns the number of bytes used by each instance.
+            static unsigned int InstanceSize();
+        // PUBLIC METHODS
+            /// \brief Creates an empty crowd.
+            Crowd();
+            Crowd(const Crowd& crowd);
+            virtual ~Crowd();
+            Crowd& operator=(const Crowd& crowd);
+            virtual SceneNode* Copy();
+
+            /// \brief Sets the shared model.
+            ///
+            /// The model is not copied or destroyed by the crowd. Baked clips refer to
+            /// the joints of the model, therefore changing the model clears all clips.
+            void SetModel(SceneNode* newModelPtr);
+
+            /// \brief Returns the shared model.
+            SceneNode* GetModel() const { return modelPtr; }
+
+            /// \brief Bakes one cycle of an action into a clip.
+            /// \param actionPtr [in] An action acting on joints of the model.
+            /// \param numSamples [in] Number of poses in the clip.
+            /// \return Index of the new clip.
+            ///
+            /// The action is run as a cyclic action under an offline SimulationClock, for two
+            /// cycles. Poses of the second cycle are stored, so that the clip loops smoothly.
+            /// Only the given action is moved (see BaseAction::MoveAlone): other actions and
+            /// the current Scheduler are not affected. The action is left inactive.
+            unsigned int BakeAction(JointAction* actionPtr, unsigned int numSamples);
+
+            /// \brief Returns the number of clips.
+            unsigned int GetNumClips() const { return clipList.size(); }
+
+            /// \brief Adds an instance.
+            /// \param root [in] Placement of the instance.
+            /// \param clip [in] Clip index (or LIVE_CLIP).
+            /// \param phase [in] Initial position in the clip, in range [0:1).
+            /// \param speed [in] Playback speed (1 means normal speed).
+            /// \return Index of the new instance.
+            ///
+            /// New instances are drawn after the next Update().
+            unsigned int AddInstance(const Transform& root, unsigned int clip,
+                                     float phase, float speed);
+
+            /// \brief Returns the number of instances.
+            unsigned int GetNumInstances() const { return phaseVec.size(); }
+
+            /// \brief Removes all instances.
+            void ClearInstances();
+
+            /// \brief Changes the placement of an instance.
+            void SetRootTransform(unsigned int instance, const Transform& root);
+
+            /// \brief Returns the placement of an instance.
+            void GetRootTransform(unsigned int instance, Transform* resultPtr) const;
+
+            /// \brief Changes the clip of an instance.
+            void SetClip(unsigned int instance, unsigned int clip, float phase);
+
+            /// \brief Changes the playback speed of an instance.
+            void SetSpeed(unsigned int instance, float speed) { speedVec[instance] = speed; }
+
+            /// \brief Sets the number of threads used by Update().
+            ///
+            /// Zero (the default) means one thread per processor. The calling thread updates
+            /// a share of the instances; the others go to worker threads of a WorkQueue shared
+            /// by all crowds.
+            void SetNumThreads(unsigned int value) { numThreads = value; }
+
+            /// \brief Advances all instances.
+            /// \param seconds [in] Elapsed time since last update.
+            void Update(float seconds);
+
+            /// \brief Computes the bounding box of all instances.
+            ///
+            /// Requires the model's bounding boxes to be up to date.
+            virtual void ComputeBoundingBox();
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief Job that updates a range of instances.
+            class RangeJob;
+            /// \brief A baked action: joint matrices for each sample of one cycle.
+            class Clip
+            {
+                public:
+                    /// Duration (in seconds) of a cycle.
+                    float duration;
+                    /// Number of poses.
+                    unsigned int numSamples;
+                    /// Index of the first pose key of the clip (see Crowd::poseKeyVec).
+                    unsigned int firstKey;
+                    /// Joint matrices, numSamples x numJoints x 16.
+                    std::vector<double> matrices;
+            };
+            /// \brief A node of the model to draw, placed in model coordinates.
+            class Part
+            {
+                public:
+                    /// Mesh object drawn by an InstanceGroup (NULL for other nodes).
+                    const MeshObject* meshObjPtr;
+                    /// Node drawn instance by instance, with its subtree (if no mesh object).
+                    const SceneNode* nodePtr;
+                    /// Placement of the node in the model (product of transforms above it).
+                    Matrix4 matrix;
+            };
+        // PROTECTED METHODS
+            virtual bool DrawInstanceOGL() const;
+            /// \brief Updates instances in range [begin:end).
+            void UpdateRange(unsigned int begin, unsigned int end, float seconds);
+            /// \brief Sorts instance indices by pose key (counting sort).
+            void SortByPose();
+            /// \brief Copies the joint matrices of a pose into the model.
+            void ApplyPose(const double* matrices) const;
+            /// \brief Adds the parts of a subtree of the model to partVec.
+            /// \param nodePtr [in] Root of the subtree.
+            /// \param matrix [in] Placement of the subtree in the model.
+            void CollectParts(const SceneNode* nodePtr, const Matrix4& matrix) const;
+            /// \brief Draws instances in range [begin:end) of sortedVec, in the current pose.
+            bool DrawPose(unsigned int begin, unsigned int end) const;
+        // PROTECTED ATTRIBUTES
+            /// \brief Shared model.
+            SceneNode* modelPtr;
+            /// \brief Joints of the model, in depth first order.
+            std::vector<Joint*> jointVec;
+            /// \brief Baked clips.
+            std::vector<Clip> clipList;
+            /// \brief Total number of pose keys (sum of samples of all clips, plus one for
+            /// live instances).
+            unsigned int numKeys;
+            /// \brief Threads used in Update().
+            unsigned int numThreads;
+            // Per instance data, stored as separate arrays.
+            /// \brief Root matrices (16 floats per instance, OpenGL order).
+            std::vector<float> rootVec;
+            std::vector<float> phaseVec;
+            std::vector<float> speedVec;
+            std::vector<unsigned int> clipVec;
+            /// \brief Pose key of each instance (live instances have key zero).
+            std::vector<unsigned int> poseKeyVec;
+            /// \brief Instance indices sorted by pose key.
+            std::vector<unsigned int> sortedVec;
+            /// \brief Start of each pose key in sortedVec (numKeys+1 entries).
+            std::vector<unsigned int> keyStartVec;
+            // Drawing data, rebuilt for each pose (not copied).
+            /// \brief Parts of the model in the pose being drawn.
+            mutable std::vector<Part> partVec;
+            /// \brief Groups that draw the mesh objects of partVec, in order.
+            mutable std::vector<InstanceGroup> groupVec;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -23,10 +23,12 @@ namespace VART {
             virtual float GetValue(float linearIndex, float initialPos, float range) const
                 { return GetValue(linearIndex); }
             virtual float GetValue(float linearIndex) const;
+            virtual void GetValues(const float* linearIndices, unsigned int count,
+                                   float initialPos, float range, float* results) const;
             virtual TypeID GetID() const { return HERMITE; }
 
             /// \brief Sets initial position for interpolation
-            void SetInitialPosition(float p) { positionVec[0] = p; }
+            void SetInitialPosition(float p) { positionVec[0] = p; coefficientsValid = false; }
 
             /// \brief Adds a control position for interpolation
             ///
@@ -36,6 +38,10 @@ namespace VART {
         // PROTECTED METHODS
             /// \brief Warp index around valid vector indices
             int WarpIndex(int i) const;
+            /// \brief Computes polynomial coefficients of every segment
+            void ComputeCoefficients() const;
+            /// \brief Evaluates the polynomial of a segment
+            float EvaluateSegment(int segment, float linearIndex) const;
         // STATIC PROTECTED METHODS
             /// \brief Hermite 1D interpolation
             static float Interpolate(float p1, float tg1, float p2, float tg2, float t);
@@ -50,6 +56,16 @@ namespace VART {
             /// dof movement normalized time, i.e.: values where 0 means the beginning of dof movment
             /// and 1 menas the end of dof movement.
             std::vector<float> timeVec;
+
+            /// \brief Cubic polynomial of each segment
+            ///
+            /// Six values per segment: initial time, inverse of time span and the four
+            /// coefficients of the cubic polynomial on the segment's normalized time. Computed
+            /// on demand, after changes to control positions.
+            mutable std::vector<float> coefficientVec;
+
+            /// \brief Indicates whether coefficientVec matches control positions
+            mutable bool coefficientsValid;
     }; // end class declaration
 } // end namespace
 #endif
@@ -17,6 +17,8 @@ namespace VART {
             LinearInterpolator();
             //~ virtual float GetValue(float n) const;
             virtual float GetValue(float linearIndex, float initialPos, float range) const;
+            virtual void GetValues(const float* linearIndices, unsigned int count,
+                                   float initialPos, float range, float* results) const;
             virtual TypeID GetID() const { return LINEAR; }
     }; // end class declaration
 } // end namespace
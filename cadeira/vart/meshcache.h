@@ -0,0 +1,101 @@
+/// \file meshcache.h
+/// \brief Header file for V-ART class "MeshCache".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_MESHCACHE_H
+#define VART_MESHCACHE_H
+
+#include "vart/workqueue.h"
+#include <string>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+namespace VART {
+    class MeshObject;
+/// \class MeshCache meshcache.h
+/// \brief Shared cache of mesh objects read from files.
+///
+/// Scene loaders use the mesh cache in two steps: first they request every file that a scene
+/// refers to, then they copy the mesh objects they need. Requested files are read by worker
+/// threads, concurrently with each other and with the caller, and each file is read once, no
+/// matter how many times (or by how many scenes) it is used.
+///
+/// Files are reference counted: each call to Request must be matched by a call to Release.
+/// A file stays in the cache while it is requested, so that scenes loaded while another
+/// scene uses a file do not read it again.
+///
+/// Textures are decoded by the TextureCache, also in the background, and uploaded when
+/// first drawn, so using the mesh cache needs no OpenGL context.
+    class MeshCache {
+        public:
+        // PUBLIC STATIC METHODS
+            /// \brief Returns the cache shared by all loaders.
+            static MeshCache& Instance();
+        // PUBLIC METHODS
+            /// \brief Requests a Wavefront OBJ file, starting to read it if not in the cache.
+            void Request(const std::string& fileName);
+
+            /// \brief Releases a requested file.
+            ///
+            /// Files that are no longer requested are removed from the cache.
+            void Release(const std::string& fileName);
+
+            /// \brief Copies a mesh object from a requested file.
+            /// \param fileName [in] Requested file.
+            /// \param meshName [in] Description of the mesh object in the file.
+            /// \param resultPtr [in,out] Mesh object that receives the geometry (see
+            /// MeshObject::MergeWith), usually empty.
+            /// \return False if the file could not be read or has no such mesh object. Errors
+            /// are reported to cerr.
+            ///
+            /// Waits for the file to be read, if needed.
+            bool GetMeshObject(const std::string& fileName, const std::string& meshName,
+                               MeshObject* resultPtr);
+
+            /// \brief Indicates whether a requested file has been read (successfully or not),
+            /// so that GetMeshObject will not wait.
+            bool IsReady(const std::string& fileName) const;
+
+            /// \brief Sets the number of worker threads (default: number of processors).
+            ///
+            /// Takes effect before the first request.
+            void SetNumThreads(unsigned int value) { workQueue.SetNumThreads(value); }
+
+            /// \brief Returns the number of files in the cache.
+            unsigned int GetNumFiles() const;
+
+            /// \brief Returns the number of files read so far.
+            unsigned long GetNumFilesRead() const { return numFilesRead; }
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief A file in the cache.
+            class Entry {
+                public:
+                    Entry() : refCount(0), ready(false), failed(false) {}
+                    ~Entry();
+                    std::map<std::string, MeshObject*> meshObjectMap;
+                    unsigned int refCount;
+                    /// Whether the file has been read (successfully or not).
+                    bool ready;
+                    bool failed;
+                    std::string errorMessage;
+            };
+            /// \brief Job that reads a file into its entry.
+            class ReadJob;
+        // PROTECTED METHODS
+            MeshCache();
+            ~MeshCache();
+            /// \brief Reads a requested file. Called by worker threads.
+            void Read(const std::string& fileName);
+        // PROTECTED ATTRIBUTES
+            std::map<std::string, Entry*> entryMap;
+            WorkQueue workQueue;
+            unsigned long numFilesRead;
+            mutable std::mutex cacheMutex;
+            /// \brief Signals that files were read.
+            std::condition_variable read;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -14,6 +14,8 @@ namespace VART {
     class SGPath;
     class SNOperator;
     class SNLocator;
+    class XmlWriter;
+    class SceneSnapshot;
 /// \class SceneNode scenenode.h
 /// \brief Base class for objects that compose a scene graph
 ///
@@ -23,6 +25,10 @@ namespace VART {
 /// cicle. SceneNodes have childs to allow creating a hierarchy of objects. This class
 /// should be considered abstract.
     class SceneNode : public MemoryObj {
+        /// Snapshots traverse the child list directly.
+        friend class SceneSnapshot;
+        /// Crowds traverse the child list directly, placing the parts of their model.
+        friend class Crowd;
         public:
         // PUBLIC TYPES
             enum TypeID { NONE, GRAPHIC_OBJ, BOX, CONE, CURVE, BEZIER,
@@ -141,8 +147,15 @@ namespace VART {
             virtual void LocateBreadthFirst(SNLocator* locatorPtr) const;
 
             /// \brief Recursively outputs XML representation of the scene node.
+            ///
+            /// Writes to an XmlWriter (see XmlWrite) and then to the stream.
             virtual void XmlPrintOn(std::ostream& os, unsigned int indent) const;
 
+            /// \brief Recursively appends XML representation of the scene node to a writer.
+            ///
+            /// Derived classes with an XML representation should override this method.
+            virtual void XmlWrite(XmlWriter* writerPtr, unsigned int indent) const;
+
         // STATIC PUBLIC ATTRIBUTES
             static bool recursivePrinting;
         protected:
@@ -18,7 +18,19 @@ namespace VART {
             SineInterpolator();
             //~ virtual float GetValue(float n) const;
             virtual float GetValue(float linearIndex, float initialPos, float range) const;
+            virtual void GetValues(const float* linearIndices, unsigned int count,
+                                   float initialPos, float range, float* results) const;
             virtual TypeID GetID() const { return EASE_IN_EASE_OUT; }
+        protected:
+        // PROTECTED STATIC METHODS
+            /// \brief Computes the ease-in ease-out function for an array of linear indices
+            ///
+            /// Each result is scale * f(linearIndex) + offset, where f is in range [0..1].
+            /// Linear indices in range [0..1] are computed with a polynomial approximation
+            /// (error is below 1e-6), which is much faster than sinf and can be vectorized by
+            /// the compiler.
+            static void EaseInEaseOut(const float* linearIndices, unsigned int count,
+                                      float scale, float offset, float* results);
     }; // end class declaration
 } // end namespace
 #endif
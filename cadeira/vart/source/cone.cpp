@@ -9,8 +9,10 @@
 #include <GL/glu.h>
 #endif
 #include "vart/cone.h"
+#include "vart/primitivecache.h"
 
 #include <iostream>
+#include <cmath>
 using namespace std;
 
 
@@ -145,7 +147,6 @@ bool VART::Cone::ShowBottom(void)
 bool VART::Cone::DrawInstanceOGL() const
 {
 #ifdef VART_OGL
-    GLUquadricObj* qObj = gluNewQuadric();
     bool result = true;
 
     if (show)
@@ -162,22 +163,30 @@ bool VART::Cone::DrawInstanceOGL() const
                 glPolygonMode(GL_FRONT, GL_FILL);
                 break;
         }
-        if ( material.GetTexture().HasData() ) {
-            gluQuadricTexture(qObj,GL_TRUE);
-        }
+        PrimitiveCache& cache = PrimitiveCache::Instance();
+        // The primitive reaches up to "height" from its origin
+        unsigned int level = cache.SelectLevel(sqrt(btRadius * btRadius + height * height));
+        bool textured = material.GetTexture().HasData();
         result = material.DrawOGL();
+        // Parts are unit primitives, scaled: normals must be renormalized
+        GLboolean normalize = glIsEnabled(GL_NORMALIZE);
+        glEnable(GL_NORMALIZE);
         // Render sides
-        if (sidesVisible) {
-            gluQuadricDrawStyle(qObj, GLU_FILL);
-            gluQuadricNormals(qObj, GLU_SMOOTH);
-            gluCylinder(qObj, btRadius, 0.0 , height, 15, 1);
+        if (sidesVisible && (btRadius > 0)) {
+            glPushMatrix();
+            glScalef(btRadius, btRadius, height);
+            result &= cache.GetFrustum(level, 1, 0).DrawOGL(textured);
+            glPopMatrix();
         }
         // Render bottom
-        if (bottomVisible) {
-            gluQuadricOrientation(qObj,GLU_INSIDE);
-            gluDisk(qObj, 0.0, btRadius, 15, 1);
+        if (bottomVisible && (btRadius > 0)) {
+            glPushMatrix();
+            glScalef(btRadius, btRadius, 1);
+            result &= cache.GetDisk(level, false).DrawOGL(textured);
+            glPopMatrix();
         }
-        gluDeleteQuadric(qObj);
+        if (!normalize)
+            glDisable(GL_NORMALIZE);
     }
     if (bBox.visible) // Is the bounding box visible?
         bBox.DrawInstanceOGL();
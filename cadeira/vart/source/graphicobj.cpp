@@ -4,6 +4,7 @@
 
 #include "vart/graphicobj.h"
 #include "vart/transform.h"
+#include "vart/framestats.h"
 #include <cassert>
 #include <list>
 
@@ -16,6 +17,12 @@ VART::GraphicObj::GraphicObj() {
     pickName = ++pickCounter;
 }
 
+bool VART::GraphicObj::DrawOGL() const {
+    if (show)
+        ++FrameStats::current.objectsDrawn;
+    return SceneNode::DrawOGL();
+}
+
 void VART::GraphicObj::Show() {
     show = true;
 }
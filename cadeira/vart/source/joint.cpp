@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <cassert>
 #include "vart/joint.h"
+#include "vart/framestats.h"
 #include "vart/dof.h"
+#include "vart/xmlwriter.h"
 
 #ifdef WIN32
 #include <windows.h>
@@ -178,6 +180,8 @@ bool VART::Joint::DrawOGL() const
     list<VART::Dof*>::const_iterator dofIter;
     int i = 0;
 
+    ++FrameStats::current.nodesVisited;
+    ++FrameStats::current.transformsPushed;
     glPushMatrix();
 
     for (dofIter = dofList.begin(); dofIter != dofList.end(); ++dofIter)
@@ -215,39 +219,41 @@ const VART::Material& VART::Joint::GetMaterial(int num)
 }
 #endif // VISUAL_JOINTS
 
-void VART::Joint::XmlPrintOn(ostream& os, unsigned int indent) const
+void VART::Joint::XmlWrite(XmlWriter* writerPtr, unsigned int indent) const
 // virtual method
 {
     list<Dof*>::const_iterator dofIter = dofList.begin();
     list<SceneNode*>::const_iterator iter = childList.begin();
-    string indentStr(indent,' ');
 
-    os << indentStr << "<joint description=\"" << description << "\" type=\"";
+    writerPtr->Indent(indent);
+    writerPtr->Append("<joint description=\"");
+    writerPtr->Append(description);
+    writerPtr->Append("\" type=\"");
     switch (GetNumDofs())
     {
         case 1:
-            os << "uniaxial";
+            writerPtr->Append("uniaxial");
             break;
         case 2:
-            os << "biaxial";
+            writerPtr->Append("biaxial");
             break;
         default:
-            os << "poliaxial";
+            writerPtr->Append("poliaxial");
     }
-    os << "\">\n";
+    writerPtr->Append("\">\n");
     while (dofIter != dofList.end())
     {
-        (*dofIter)->XmlPrintOn(os, indent+2);
+        (*dofIter)->XmlWrite(writerPtr, indent+2);
         ++dofIter;
     }
     if (recursivePrinting)
         while (iter != childList.end())
         {
-            (*iter)->XmlPrintOn(os, indent+2);
+            (*iter)->XmlWrite(writerPtr, indent+2);
             ++iter;
         }
-    os << indentStr << "</joint>\n";
-    os << flush;
+    writerPtr->Indent(indent);
+    writerPtr->Append("</joint>\n");
 }
 
 ostream& VART::operator<<(ostream& output, const VART::Joint::DofID& dofId)
@@ -28,3 +28,56 @@ float VART::SineInterpolator::GetValue(float linearIndex, float initialPos, floa
 {
     return (sinf((linearIndex+1.5)*3.1415926535897932384626433832795)+1) * range/2.0f + initialPos;
 }
+
+void VART::SineInterpolator::GetValues(const float* linearIndices, unsigned int count,
+                                       float initialPos, float range, float* results) const
+// virtual method
+{
+    EaseInEaseOut(linearIndices, count, range, initialPos, results);
+}
+
+void VART::SineInterpolator::EaseInEaseOut(const float* linearIndices, unsigned int count,
+                                           float scale, float offset, float* results)
+// protected static method
+{
+    const float pi = 3.1415926535897932384626433832795f;
+    // Work on fixed size blocks copied to a local buffer: the compiler knows the buffer
+    // does not overlap anything else and the number of iterations, so loops get
+    // vectorized (even if results and linearIndices are the same array).
+    const unsigned int BLOCK_SIZE = 64;
+    float buffer[BLOCK_SIZE];
+    for (unsigned int begin = 0; begin < count; begin += BLOCK_SIZE)
+    {
+        unsigned int size = count - begin;
+        if (size > BLOCK_SIZE)
+            size = BLOCK_SIZE;
+        for (unsigned int i = 0; i < size; ++i)
+            buffer[i] = linearIndices[begin + i];
+        for (unsigned int i = size; i < BLOCK_SIZE; ++i)
+            buffer[i] = 0.0f;
+        int outOfRange = 0;
+        for (unsigned int i = 0; i < BLOCK_SIZE; ++i)
+            outOfRange |= (buffer[i] < 0.0f) | (buffer[i] > 1.0f);
+        if (!outOfRange)
+        {
+            // sin((n+1.5)*pi) == sin(u*pi), where u = n-0.5 is in [-0.5..0.5]. Taylor series
+            // of sin(x) up to x^11, with x in [-pi/2..pi/2].
+            for (unsigned int i = 0; i < BLOCK_SIZE; ++i)
+            {
+                float x = (buffer[i] - 0.5f) * pi;
+                float x2 = x * x;
+                float s = x * (1.0f + x2 * (-1.0f/6.0f + x2 * (1.0f/120.0f + x2 * (-1.0f/5040.0f
+                          + x2 * (1.0f/362880.0f + x2 * (-1.0f/39916800.0f))))));
+                buffer[i] = (s + 1.0f) * 0.5f * scale + offset;
+            }
+        }
+        else
+        {
+            for (unsigned int i = 0; i < size; ++i)
+                buffer[i] = (sinf((buffer[i]+1.5)*3.1415926535897932384626433832795)+1) / 2.0f
+                            * scale + offset;
+        }
+        for (unsigned int i = 0; i < size; ++i)
+            results[begin + i] = buffer[i];
+    }
+}
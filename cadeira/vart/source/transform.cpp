@@ -7,8 +7,10 @@
 // Transform = [ matrix[1] matrix[5] matrix[9]  matrix[13] ]
 //             [ matrix[2] matrix[6] matrix[10] matrix[14] ]
 //             [ matrix[3] matrix[7] matrix[11] matrix[15] ]
+// Computations are done by Matrix4.
 
 #include "vart/transform.h"
+#include "vart/framestats.h"
 #include "vart/boundingbox.h"
 #include "vart/graphicobj.h"
 
@@ -32,13 +34,7 @@ VART::SceneNode * VART::Transform::Copy()
 
 void VART::Transform::SetData(double* data)
 {
-    int i;
-
-    for (i=0; i<16; i++)
-    {
-        matrix[i] = (*data);
-        data++;
-    }
+    matrix.SetData(data);
 }
 
 VART::Transform::Transform(const VART::Transform &trans)
@@ -48,181 +44,82 @@ VART::Transform::Transform(const VART::Transform &trans)
 
 void VART::Transform::MakeIdentity()
 {
-    for (int i=0; i<16; ++i)
-        matrix[i] = 0.0;
-    matrix[0] = matrix[5] = matrix[10] = matrix[15] = 1.0;
+    matrix.MakeIdentity();
 }
 
 void VART::Transform::MakeTranslation(const VART::Point4D& translationVector)
 {
-    MakeIdentity();
-    matrix[12] = translationVector.GetX();
-    matrix[13] = translationVector.GetY();
-    matrix[14] = translationVector.GetZ();
+    matrix.MakeTranslation(translationVector);
 }
 
 void VART::Transform::MakeXRotation(double radians)
 {
-    MakeIdentity();
-    matrix[5] =   cos(radians);
-    matrix[9] =  -sin(radians);
-    matrix[6] =   sin(radians);
-    matrix[10] =  cos(radians);
+    matrix.MakeXRotation(radians);
 }
 
 void VART::Transform::MakeYRotation(double radians)
 {
-    MakeIdentity();
-    matrix[0] =   cos(radians);
-    matrix[8] =   sin(radians);
-    matrix[2] =  -sin(radians);
-    matrix[10] =  cos(radians);
+    matrix.MakeYRotation(radians);
 }
 
 void VART::Transform::MakeZRotation(double radians)
 {
-    MakeIdentity();
-    matrix[0] =  cos(radians);
-    matrix[4] = -sin(radians);
-    matrix[1] =  sin(radians);
-    matrix[5] =  cos(radians);
+    matrix.MakeZRotation(radians);
 }
 
 void VART::Transform::MakeScale(double sX, double sY, double sZ)
 {
-    MakeIdentity();
-    matrix[0] =  sX;
-    matrix[5] =  sY;
-    matrix[10] = sZ;
+    matrix.MakeScale(sX, sY, sZ);
 }
 
 void VART::Transform::MakeShear(double shX, double shY)
 {
-    MakeIdentity();
-    matrix[8] = shX;
-    matrix[9] = shY;
+    matrix.MakeShear(shX, shY);
 }
 
 VART::Point4D VART::Transform::operator *(const VART::Point4D& point) const
 {
-    VART::Point4D result;
-
-    return VART::Point4D(  matrix[0]*point.GetX()  + matrix[4]*point.GetY()
-                     + matrix[8]*point.GetZ()  + matrix[12]*point.GetW(),
-                       matrix[1]*point.GetX()  + matrix[5]*point.GetY()
-                     + matrix[9]*point.GetZ()  + matrix[13]*point.GetW(),
-                       matrix[2]*point.GetX()  + matrix[6]*point.GetY()
-                     + matrix[10]*point.GetZ() + matrix[14]*point.GetW(),
-                       matrix[3]*point.GetX()  + matrix[7]*point.GetY()
-                     + matrix[11]*point.GetZ() + matrix[15]*point.GetW());
+    return matrix * point;
 }
 
 VART::Transform VART::Transform::operator*(const VART::Transform &t) const
 {
     VART::Transform resultado;
-    for (int i=0; i < 16; ++i)
-        resultado.matrix[i] =
-              matrix[i%4]    *t.matrix[i/4*4]  +matrix[(i%4)+4] *t.matrix[i/4*4+1]
-            + matrix[(i%4)+8]*t.matrix[i/4*4+2]+matrix[(i%4)+12]*t.matrix[i/4*4+3];
+    Matrix4::Multiply(matrix, t.matrix, &resultado.matrix);
     return resultado;
 }
 
 VART::Transform& VART::Transform::operator=(const VART::Transform& t)
 {
     this->SceneNode::operator=(t);
-    for (int i=0; i < 16; ++i)
-        matrix[i] = t.matrix[i];
+    matrix = t.matrix;
     return *this;
 }
 
 void VART::Transform::CopyMatrix(const Transform& t)
 {
-    for (int i=0; i < 16; ++i)
-        matrix[i] = t.matrix[i];
+    matrix = t.matrix;
 }
 
 void VART::Transform::Apply(const Transform& t)
 {
-    CopyMatrix(t * (*this));
+    Matrix4::Multiply(t.matrix, matrix, &matrix);
 }
 
 void VART::Transform::ApplyTo(VART::Point4D* ptPoint) const
 {
-    ptPoint->SetXYZW(
-        matrix[0]*ptPoint->GetX()
-            + matrix[4]*ptPoint->GetY()
-            + matrix[8]*ptPoint->GetZ()
-            + matrix[12]*ptPoint->GetW(),
-        matrix[1]*ptPoint->GetX()
-            + matrix[5]*ptPoint->GetY()
-            + matrix[9]*ptPoint->GetZ()
-            + matrix[13]*ptPoint->GetW(),
-        matrix[2]*ptPoint->GetX()
-            + matrix[6]*ptPoint->GetY()
-            + matrix[10]*ptPoint->GetZ()
-            + matrix[14]*ptPoint->GetW(),
-        matrix[3]*ptPoint->GetX()
-            + matrix[7]*ptPoint->GetY()
-            + matrix[11]*ptPoint->GetZ()
-            + matrix[15]*ptPoint->GetW()
-        );
+    matrix.ApplyTo(ptPoint);
 }
 
 void VART::Transform::MakeRotation(const VART::Point4D& refVec, const float radians)
 {
-    VART::Point4D projEmY;
-    VART::Point4D vetTemp;
-    VART::Transform tTemp;
-    double anguloY;
-    double anguloZ;
-
-    //Decompor refVec
-    //Angulo em Y (para levar o vetor ao plano XY)
-    if (Zero(refVec.GetZ()))
-    {
-        anguloY = 0.0;
-        this->MakeIdentity();
-        vetTemp = refVec;
-    }
-    else
-    {
-        // se o vetor nao esta no plano XY...
-        projEmY.SetXYZW(refVec.GetX(), 0, refVec.GetZ(), 0);
-        projEmY.Normalize();
-        if (refVec.GetZ() < 0)
-            anguloY = -(projEmY.AngleTo(VART::Point4D(1,0,0,0)));
-        else
-            anguloY = projEmY.AngleTo(VART::Point4D(1,0,0,0));
-        this->MakeYRotation(anguloY);
-        vetTemp = (*this) * refVec; //refVec no plano XY
-    }
-    //Angulo em Z (para levar o vetor ao X)
-    if (vetTemp.GetY() < 0)
-        anguloZ = vetTemp.AngleTo(VART::Point4D(1,0,0,0));
-    else
-        anguloZ = -(vetTemp.AngleTo(VART::Point4D(1,0,0,0)));
-    tTemp.MakeZRotation(anguloZ);
-    this->CopyMatrix(tTemp * (*this));
-    //Rodar
-    tTemp.MakeXRotation(radians);
-    this->CopyMatrix(tTemp * (*this));
-    //voltar
-    tTemp.MakeZRotation(-anguloZ);
-    this->CopyMatrix(tTemp * (*this));
-    tTemp.MakeYRotation(-anguloY);
-    this->CopyMatrix(tTemp * (*this));
+    matrix.MakeRotation(refVec, radians);
 }
 
 void VART::Transform::MakeRotation(const VART::Point4D& refPoint, const VART::Point4D& refVec,
                                const float radians)
 {
-    VART::Transform tTemp;
-
-    this->MakeTranslation(-refPoint);
-    tTemp.MakeRotation(refVec, radians);
-    this->CopyMatrix(tTemp * (*this));
-    tTemp.MakeTranslation(refPoint);
-    this->CopyMatrix(tTemp * (*this));
+    matrix.MakeRotation(refPoint, refVec, radians);
 }
 
 void VART::Transform::GetVectorX(VART::Point4D* result) const
@@ -262,8 +159,10 @@ bool VART::Transform::DrawOGL() const
 #ifdef VART_OGL
     bool result = true;
 
+    ++FrameStats::current.nodesVisited;
+    ++FrameStats::current.transformsPushed;
     glPushMatrix();
-    glMultMatrixd(matrix);
+    glMultMatrixd(matrix.GetData());
 
     list<VART::SceneNode*>::const_iterator iter = childList.begin();
     for (; iter != childList.end(); ++iter)
@@ -280,7 +179,7 @@ void VART::Transform::DrawForPicking() const {
     list<VART::SceneNode*>::const_iterator iter;
 
     glPushMatrix();
-    glMultMatrixd(matrix);
+    glMultMatrixd(matrix.GetData());
 
     for (iter = childList.begin(); iter != childList.end(); ++iter)
         (*iter)->DrawForPicking();
@@ -0,0 +1,210 @@
+/// \file xmlstreamjointaction.cpp
+/// \brief Implementation file for V-ART class "XmlStreamJointAction".
+/// \version $Revision: 1.1 $
+
+#include "vart/xmlstreamjointaction.h"
+#include "vart/profiler.h"
+#include "vart/xmlreader.h"
+#include "vart/jointmover.h"
+#include "vart/noisydofmover.h"
+#include "vart/linearinterpolator.h"
+#include "vart/sineinterpolator.h"
+#include "vart/rangesineinterpolator.h"
+#include "vart/snoperator.h"
+
+using namespace std;
+
+// Element and attribute names, in the order of XmlStreamJointAction::Name
+static const char* NAMES[] = {
+    "action", "joint_movement", "interpolation", "dof_movement", "noise", "error",
+    "action_name", "speed", "cycle", "duration", "joint_name", "type", "initialTime",
+    "finalTime", "finalPosition", "dofID", "amplitude", "length", "overshoot", "offset",
+    "peak_time", NULL };
+
+// Common interpolators for all joint movers
+static VART::LinearInterpolator linearInterpolator;
+static VART::SineInterpolator sineInterpolator;
+
+// Maps each description to the first node that has it, in breadth first order (the node
+// that a DescriptionLocator would find).
+class NodeIndexer : public VART::SNOperator
+{
+    public:
+        NodeIndexer(map<string, const VART::SceneNode*>* mapPtr) : nodeMapPtr(mapPtr) {}
+        virtual void OperateOn(const VART::SceneNode* nodePtr)
+        {
+            nodeMapPtr->insert(make_pair(nodePtr->GetDescription(), nodePtr));
+        }
+    private:
+        map<string, const VART::SceneNode*>* nodeMapPtr;
+};
+
+VART::XmlStreamJointAction::XmlStreamJointAction() : jointMoverPtr(NULL)
+{
+}
+
+VART::XmlStreamJointAction::~XmlStreamJointAction()
+{
+    for (unsigned int i = 0; i < interpolatorVec.size(); ++i)
+        delete interpolatorVec[i];
+}
+
+bool VART::XmlStreamJointAction::LoadFromFile(const string& fileName, const SceneNode& sNode)
+{
+    VART_PROFILE_ZONE("XmlStreamJointAction::LoadFromFile");
+    XmlReader reader;
+    for (unsigned int i = 0; NAMES[i]; ++i)
+        reader.Intern(NAMES[i]);
+    if (!reader.Open(fileName))
+    {
+        cerr << "Error: XmlStreamJointAction: " << reader.GetErrorMessage() << endl;
+        return false;
+    }
+    jointMoverPtr = NULL;
+    // Joints are looked up by name; indexing the scene once is much faster than one
+    // search per joint movement.
+    NodeIndexer indexer(&nodeMap);
+    sNode.TraverseBreadthFirst(&indexer);
+    bool result = true;
+    XmlReader::Event event = reader.Next();
+    while (event != XmlReader::END_OF_DOCUMENT)
+    {
+        if (event == XmlReader::PARSE_ERROR)
+        {
+            cerr << "Error: XmlStreamJointAction: " << fileName << ": "
+                 << reader.GetErrorMessage() << endl;
+            result = false;
+            break;
+        }
+        if (event == XmlReader::START_ELEMENT)
+        {
+            if (!StartElement(reader))
+            {
+                result = false;
+                break;
+            }
+        }
+        else
+        {
+            unsigned int name = reader.GetName();
+            if ((name == DOF_MOVEMENT) && jointMoverPtr)
+                CreateDofMover();
+            else if (name == JOINT_MOVEMENT)
+                jointMoverPtr = NULL;
+        }
+        event = reader.Next();
+    }
+    nodeMap.clear();
+    return result;
+}
+
+bool VART::XmlStreamJointAction::StartElement(const XmlReader& reader)
+{
+    switch (reader.GetName())
+    {
+        case ACTION:
+            if (reader.GetDepth() == 1)
+            {
+                reader.GetAttribute(ACTION_NAME, &description);
+                reader.GetAttribute(SPEED, &speedModifier);
+                reader.GetAttribute(CYCLE, &cyclic);
+            }
+            break;
+        case JOINT_MOVEMENT:
+        {
+            float duration = 0;
+            string jointName;
+            reader.GetAttribute(DURATION, &duration);
+            reader.GetAttribute(JOINT_NAME, &jointName);
+            map<string, const SceneNode*>::iterator iter = nodeMap.find(jointName);
+            Joint* jointPtr = NULL;
+            if (iter != nodeMap.end())
+                jointPtr = const_cast<Joint*>(dynamic_cast<const Joint*>(iter->second));
+            if (jointPtr)
+                jointMoverPtr = AddJointMover(jointPtr, duration, sineInterpolator);
+            break;
+        }
+        case INTERPOLATION:
+            // Default is a SineInterpolator. Change interpolator if different from default.
+            if (jointMoverPtr && !reader.AttributeEquals(TYPE, "ease-in_ease-out"))
+            {
+                if (reader.AttributeEquals(TYPE, "linear"))
+                    jointMoverPtr->SetInterpolator(linearInterpolator);
+                else if (reader.AttributeEquals(TYPE, "range_sine"))
+                {
+                    interpolatorVec.push_back(new RangeSineInterpolator);
+                    jointMoverPtr->SetInterpolator(*interpolatorVec.back());
+                }
+                else
+                {
+                    string type;
+                    reader.GetAttribute(TYPE, &type);
+                    cerr << "Error: Unknown interpolator type: '" << type
+                         << "'. Using: 'ease-in_ease-out'." << endl;
+                }
+            }
+            break;
+        case DOF_MOVEMENT:
+            if (jointMoverPtr)
+            {
+                initialTime = finalTime = finalPosition = 0;
+                reader.GetAttribute(INITIAL_TIME, &initialTime);
+                reader.GetAttribute(FINAL_TIME, &finalTime);
+                reader.GetAttribute(FINAL_POSITION, &finalPosition);
+                if (reader.AttributeEquals(DOF_ID, "FLEX") || reader.AttributeEquals(DOF_ID, "FLEXION"))
+                    dofID = Joint::FLEXION;
+                else if (reader.AttributeEquals(DOF_ID, "ADDUCT")
+                         || reader.AttributeEquals(DOF_ID, "ADDUCTION"))
+                    dofID = Joint::ADDUCTION;
+                else if (reader.AttributeEquals(DOF_ID, "TWIST"))
+                    dofID = Joint::TWIST;
+                else
+                {
+                    string dofIDString;
+                    reader.GetAttribute(DOF_ID, &dofIDString);
+                    cerr << "XmlStreamJointAction::LoadFromFile: Unknown DOF ID ("
+                         << dofIDString << ")." << endl;
+                    return false;
+                }
+                foundNoise = false;
+                foundPositionalError = false;
+            }
+            break;
+        case NOISE:
+            if (jointMoverPtr && (reader.GetParentName() == DOF_MOVEMENT))
+            {
+                reader.GetAttribute(AMPLITUDE, &noiseAmplitude);
+                reader.GetAttribute(LENGTH, &noiseWaveLength);
+                foundNoise = true;
+            }
+            break;
+        case POSITIONAL_ERROR:
+            if (jointMoverPtr && (reader.GetParentName() == DOF_MOVEMENT))
+            {
+                float value;
+                if (reader.GetAttribute(OVERSHOOT, &value))
+                    NoisyDofMover::SetDefaultOvershoot(value);
+                if (reader.GetAttribute(OFFSET, &value))
+                    NoisyDofMover::SetDefaultOffset(value);
+                if (reader.GetAttribute(PEAK_TIME, &value))
+                    NoisyDofMover::SetDefaultPeakTime(value);
+                foundPositionalError = true;
+            }
+            break;
+    }
+    return true;
+}
+
+void VART::XmlStreamJointAction::CreateDofMover()
+{
+    if (foundPositionalError || foundNoise)
+    {
+        NoisyDofMover* noisyDofMoverPtr;
+        noisyDofMoverPtr = jointMoverPtr->AddNoisyDofMover(dofID, initialTime, finalTime,
+                                                          finalPosition);
+        if (foundNoise)
+            noisyDofMoverPtr->SetNoise(noiseAmplitude, noiseWaveLength);
+    }
+    else
+        jointMoverPtr->AddDofMover(dofID, initialTime, finalTime, finalPosition);
+}
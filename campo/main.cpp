@@ -1,10 +1,11 @@
 #include <vart/arrow.h>
-#include <vart/meshobject.h>
-#include <vart/mesh.h>
+#include <vart/terrain.h>
 #include <vart/transform.h>
 #include <vart/texture.h>
 #include <vart/material.h>
 #include <vart/sphere.h>
+#include <vart/ballsimulation.h>
+#include <vart/simulationclock.h>
 #include <vart/contrib/viewerglutogl.h>
 
 #include <iostream>
@@ -21,7 +22,7 @@ using namespace VART;
 #define VARIATION 3
 #define BALL_SIZE 4
 
-class Campo : public MeshObject {
+class Campo : public Terrain {
     private:
 
         double MyRandom();
@@ -31,33 +32,14 @@ class Campo : public MeshObject {
 
 };
 
-Campo::Campo() {
+Campo::Campo() : Terrain(TAM_CAMPO, TAM_CAMPO, VARIATION, 8) {
     srand(time(NULL));
-    vector<double> coordenadas;
-    for(int i = 0; i < TAM_CAMPO; i++) {
-        for(int j = 0; j < TAM_CAMPO; j++) {
-            coordenadas.push_back(i * VARIATION);
-            double y = this->MyRandom();
-            coordenadas.push_back(y);
-            coordenadas.push_back(j * VARIATION);
+    for(int i = 0; i <= TAM_CAMPO; i++) {
+        for(int j = 0; j <= TAM_CAMPO; j++) {
+            SetHeight(i, j, this->MyRandom());
         }
     }
-    vertCoordVec = coordenadas;
-
-    vector<unsigned int> faces;
-
-    for(int i = 0; i < TAM_CAMPO - 1; i++) {
-        for(int j = 0; j < TAM_CAMPO; j++) {
-            faces.push_back((i + 1) * TAM_CAMPO + j);
-            faces.push_back(i * TAM_CAMPO + j);
-        }
-        Mesh meshTriangStrip;
-        meshTriangStrip.type = Mesh::TRIANGLE_STRIP;
-        meshTriangStrip.indexVec = faces;
-        meshTriangStrip.material = Material::PLASTIC_GREEN();
-        meshList.push_back(meshTriangStrip);
-    }
-    ComputeVertexNormals();
+    SetMaterial(Material::PLASTIC_GREEN());
     ComputeBoundingBox();
     ComputeRecursiveBoundingBox();
 }
@@ -70,49 +52,26 @@ double Campo::MyRandom() {
 
 class MyIH : public ViewerGlutOGL::IdleHandler {
     private:
-        double rotationBolaParameter = -(MAX_ANGLE);
-        double translationXParamater = 0.1;
-        double translationYParamater = VARIATION + 1.5 * BALL_SIZE + 0.1;
-        double translationZParameter = 0.1;
-        double variationXTranslation = ((double) VARIATION + BALL_SIZE)/BALL_SIZE;
-        double variationYTranslation = TAM_CAMPO/(VARIATION + BALL_SIZE);
-        double variationZTranslation = ((double) VARIATION)/BALL_SIZE;
+        SimulationClock clock;
 
     public:
-        Transform* rotationXBola;
-        Transform* rotationYBola;
-        Transform* translationBola;
+        BallSimulation* simulation;
+        vector<Transform*> transformsBola;
         MyIH() {
         }
         virtual ~MyIH(){
         }
 
         virtual void OnIdle() {
-            rotationXBola->MakeRotation(Point4D::X(), rotationBolaParameter);
-            rotationYBola->MakeRotation(Point4D::Y(), rotationBolaParameter);
-            // cout << *rotationXBola << endl;
-
-            if((translationXParamater >= TAM_CAMPO * VARIATION) or
-              (translationXParamater <= TAM_CAMPO * Point4D::ORIGIN().GetX())) {
-                variationXTranslation = -variationXTranslation;
-                rotationBolaParameter = -rotationBolaParameter;
+            clock.Update();
+            while(clock.Step()) {
+                simulation->Step();
             }
-            if((translationZParameter >= TAM_CAMPO * VARIATION) or
-              (translationZParameter <= TAM_CAMPO * Point4D::ORIGIN().GetZ())) {
-                variationZTranslation = -variationZTranslation;
+            // the ball stops on the bumps: kick it again
+            if(simulation->GetVelocity(0).Length() < 1) {
+                simulation->SetVelocity(0, Point4D(rand() % 41 - 20, 10, rand() % 41 - 20, 0));
             }
-            if((translationYParamater >= TAM_CAMPO + VARIATION) or
-              (translationYParamater <= VARIATION + BALL_SIZE + (0.5 * BALL_SIZE))) {
-                variationYTranslation = -variationYTranslation;
-            }
-            translationBola->MakeTranslation(translationXParamater, translationYParamater, translationZParameter);
-
-            translationXParamater += variationXTranslation;
-            translationYParamater += variationYTranslation;
-            translationZParameter += variationZTranslation;
-            rotationBolaParameter += 0.1;
-
-            // cout << translationXParamater << " " << translationYParamater << " " << translationZParameter << endl;
+            simulation->WriteTransforms(transformsBola);
 
             viewerPtr->PostRedisplay();
         }
@@ -135,9 +94,6 @@ int main(int argc, char** argv) {
     Material mat;
     Sphere bola;
     Transform tBola;
-    Transform rotationXBola;
-    Transform rotationYBola;
-    Transform translationMiddleBola;
 
     if(text.LoadFromFile(argv[1])) {
         mat.SetTexture(text);
@@ -146,33 +102,34 @@ int main(int argc, char** argv) {
         bola.SetMaterial(mat);
         bola.SetDescription("BOLA");
 
-        tBola.MakeScale(BALL_SIZE, BALL_SIZE, BALL_SIZE);
+        tBola.MakeIdentity();
         tBola.AddChild(bola);
 
-        rotationXBola.MakeIdentity();
-        rotationYBola.MakeIdentity();
-
-        rotationXBola.AddChild(tBola);
-        rotationYBola.AddChild(rotationXBola);
-
-        translationMiddleBola.MakeTranslation(Point4D((VARIATION * TAM_CAMPO) / 2.0,
-                                                        VARIATION + BALL_SIZE, (VARIATION * TAM_CAMPO) / 2.0));
-        translationMiddleBola.AddChild(rotationYBola);
-
     } else {
         cout << "FOTO AMANDADA NAO ACHADA TEU" << endl;
         return 0;
     }
 
 
+    Campo c;
+
+    // the ball rolls over the field, bouncing on invisible walls around it
+    BallSimulation simulation;
+    BoundingBox walls;
+    walls.SetBoundingBox(0, -BALL_SIZE, 0, TAM_CAMPO * VARIATION, 1000, TAM_CAMPO * VARIATION);
+    simulation.SetTerrain(&c);
+    simulation.SetBounds(walls);
+    simulation.SetRestitution(0.8);
+    simulation.AddBall(Point4D((VARIATION * TAM_CAMPO) / 2.0, VARIATION + 3 * BALL_SIZE,
+                               (VARIATION * TAM_CAMPO) / 2.0),
+                       BALL_SIZE, Point4D(15, 0, 10, 0));
+
     MyIH idle;
-    idle.rotationXBola = &rotationXBola;
-    idle.rotationYBola = &rotationYBola;
-    idle.translationBola = &translationMiddleBola;
+    idle.simulation = &simulation;
+    idle.transformsBola.push_back(&tBola);
 
-    scene.AddObject(&translationMiddleBola);
+    scene.AddObject(&tBola);
 
-    Campo c;
     scene.AddObject(&c);
 
     scene.AddLight(Light::BRIGHT_AMBIENT());
@@ -16,6 +16,12 @@ namespace VART {
     class Bezier : public Curve {
         public:
             Bezier();
+            virtual SceneNode* Copy() { return new Bezier(*this); }
+
+            /// \brief Computes the bounding box of the control points.
+            ///
+            /// The curve lies inside the convex hull of its control points.
+            virtual void ComputeBoundingBox();
             /// \brief Returns a copy a control point.
             Point4D GetControlPoint(int i);
 
@@ -26,6 +32,23 @@ namespace VART {
             /// \param t [in] curve parameter describing the desired point.
             /// \param result [out] the point at position t.
             virtual void GetPoint(double t, Point4D* result);
+
+            /// \brief Returns many points of the curve.
+            ///
+            /// Evaluates the curve in power basis (Horner's rule).
+            virtual void GetPoints(const double* params, unsigned int count, Point4D* results);
+
+            /// \brief Returns points of the curve at evenly spaced parameters.
+            ///
+            /// Evaluates the curve by forward differencing: three additions per coordinate
+            /// per point.
+            virtual void GetUniformPoints(double tBegin, double tEnd, unsigned int count,
+                                          Point4D* results);
+        protected:
+            /// \brief Computes coefficients of the power basis form of the curve.
+            /// \param coef [out] 16 values: coordinates (xyzw) of coefficients of t^3, t^2,
+            /// t and 1, in that order.
+            void ComputePowerBasis(double* coef) const;
     }; // end class declaration
 } // end namespace
 #endif
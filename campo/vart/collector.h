@@ -41,7 +41,7 @@ void VART::Collector<T>::OperateOn(const SceneNode* nodePtr)
 {
     const T* castPtr = dynamic_cast<const T*>(nodePtr);
     if (castPtr)
-        push_back(castPtr);
+        this->push_back(castPtr);
 }
 
 #endif
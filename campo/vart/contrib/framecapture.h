@@ -0,0 +1,155 @@
+/// \file framecapture.h
+/// \brief Header file for V-ART class "FrameCapture".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_FRAMECAPTURE_H
+#define VART_FRAMECAPTURE_H
+
+#include "vart/contrib/viewerglutogl.h"
+#include "vart/workqueue.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+
+namespace VART {
+/// \class FrameCapture framecapture.h
+/// \brief Captures rendered frames to files without stalling the renderer.
+///
+/// A FrameCapture is a ViewerGlutOGL::DrawHandler that reads the frame buffer after every
+/// frame. Reading goes to one of two pixel buffer objects, alternately, so that the pixels of
+/// a frame are copied out while the next one is being read. Worker threads then flip rows,
+/// convert RGBA to RGB, encode and write the output, one large write per frame. Frames may be
+/// saved as:
+/// - RAW_VIDEO: a single file of RGB frames, top row first, with no headers (a "rawvideo"
+///   stream of "rgb24" pixels, as known by video encoders);
+/// - PNM_SEQUENCE: a file per frame, in binary PPM format;
+/// - PNG_SEQUENCE: a file per frame, in PNG format (requires compiling with ZLIB_LIB and
+///   linking with zlib).
+///
+/// Sequence files are named after the file name, followed by the frame number (five digits)
+/// and the extension ("frame00000.pnm"). If the renderer produces frames faster than they
+/// can be written, it waits for a free frame buffer (see SetMaxPendingFrames). Time spent
+/// capturing in the rendering thread is measured (see GetOverhead).
+/// \bug The frame buffer size needs to be mannualy set. Beware of screen resizes.
+    class FrameCapture : public ViewerGlutOGL::DrawHandler
+    {
+        public:
+        // PUBLIC TYPES
+            enum Format { RAW_VIDEO, PNM_SEQUENCE, PNG_SEQUENCE };
+        // PUBLIC METHODS
+            /// \brief Creates a capture to a PNM sequence named "frame".
+            FrameCapture();
+            /// \brief Saves the last frame read and waits for pending frames to be written.
+            ///
+            /// Calls Finish if a frame is still in a pixel buffer, which requires the OpenGL
+            /// context to be current.
+            virtual ~FrameCapture();
+            /// \brief Changes the buffer size.
+            ///
+            /// Should be called before capturing or after Finish.
+            void SetBufferSize(int columns, int lines);
+            /// \brief Sets the output file name (RAW_VIDEO) or the prefix of file names.
+            void SetFileName(const std::string& name) { fileName = name; }
+            /// \brief Sets the output format.
+            /// \return False if the format is not available.
+            ///
+            /// Should be called before capturing or after Finish.
+            bool SetFormat(Format newFormat);
+            /// \brief Sets the zlib compression level of PNG files (default 1: fastest).
+            void SetCompressionLevel(int level) { compressionLevel = level; }
+            /// \brief Sets how many frames may be waiting to be written (default 4).
+            void SetMaxPendingFrames(unsigned int value) { maxPendingFrames = value; }
+            /// \brief Sets the number of worker threads (default: number of processors).
+            ///
+            /// Takes effect before the first frame is captured.
+            void SetNumThreads(unsigned int value) { workQueue.SetNumThreads(value); }
+            /// \brief Reads the frame buffer and queues the previous frame for writing.
+            virtual void OnDraw();
+            /// \brief Queues a frame for writing.
+            /// \param rgbaPtr [in] Pixels, as read by glReadPixels (RGBA, bottom row first).
+            void AddFrame(const void* rgbaPtr);
+            /// \brief Saves the last frame read and waits for all frames to be written.
+            ///
+            /// Must be called by the thread with the OpenGL context when capturing with OnDraw.
+            /// Frames captured afterwards start a new capture, numbered from zero.
+            void Finish();
+            /// \brief Returns the number of frames captured.
+            unsigned int GetNumFrames() const { return numCaptured; }
+            /// \brief Returns mean time (in seconds) taken by OnDraw or AddFrame per frame.
+            double GetOverhead() const;
+            /// \brief Returns the longest time (in seconds) taken by OnDraw or AddFrame.
+            double GetMaxOverhead() const { return maxOverhead; }
+            /// \brief Returns the number of frames that had to wait for a free buffer.
+            unsigned int GetNumStalls() const { return numStalls; }
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief Buffers of a frame being written.
+            class Frame {
+                public:
+                    /// \brief RGBA pixels, bottom row first.
+                    std::vector<unsigned char> pixels;
+                    /// \brief File contents (RGB pixels, top row first, for RAW_VIDEO).
+                    std::vector<unsigned char> output;
+                    unsigned int number;
+            };
+            /// \brief Job that encodes and writes a frame.
+            class EncodeJob;
+        // PROTECTED METHODS
+            /// \brief Copies pixels to a free frame and queues it.
+            void QueueFrame(const void* rgbaPtr);
+            /// \brief Fills the output of a frame. Called by worker threads.
+            void Encode(Frame* framePtr);
+            /// \brief Writes the output of a frame and frees it. Called by worker threads.
+            void Write(Frame* framePtr);
+            /// \brief Returns the name of a sequence file.
+            std::string SequenceFileName(unsigned int number) const;
+            /// \brief Accounts for time spent capturing a frame.
+            void AddOverhead(double seconds);
+            /// \brief Deletes pixel buffer objects. Requires the OpenGL context.
+            void DeletePixelBuffers();
+        // PROTECTED ATTRIBUTES
+            Format format;
+            std::string fileName;
+            int compressionLevel;
+            int numColumns;
+            int numLines;
+            /// \brief Pixel buffer objects read into alternately (zero if not created).
+            unsigned int pixelBuffers[2];
+            /// \brief Index of the pixel buffer to read into next.
+            unsigned int currentBuffer;
+            /// \brief Whether the other pixel buffer holds a frame not yet queued.
+            bool bufferPending;
+            /// \brief Number of the next frame to be queued.
+            unsigned int frameCounter;
+            unsigned int maxPendingFrames;
+            /// \brief Number of frames queued and not yet written.
+            unsigned int numPending;
+            /// \brief Frame buffers not in use.
+            std::vector<Frame*> freeFrameVec;
+            /// \brief Number of frame buffers created.
+            unsigned int numFrames;
+            /// \brief Guards frame buffers and counters of pending frames.
+            std::mutex frameMutex;
+            /// \brief Signals that a frame was written.
+            std::condition_variable frameWritten;
+            /// \brief RAW_VIDEO output.
+            std::ofstream rawFile;
+            /// \brief Number of the next frame to be written to the raw file.
+            unsigned int nextRawFrame;
+            /// \brief Frames encoded but waiting for previous ones to be written to the raw file.
+            std::map<unsigned int, Frame*> encodedMap;
+            /// \brief Guards the raw file.
+            std::mutex rawMutex;
+            unsigned int numCaptured;
+            unsigned int numStalls;
+            double totalOverhead;
+            double maxOverhead;
+            /// \brief Declared last so that it is stopped before anything jobs use is destroyed.
+            WorkQueue workQueue;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -160,7 +160,7 @@ void VART::Human::StickLeftFoot()
 }
 
 //virtual
-void VART::Human::TraverseDepthFirst(SNOperator* operatorPtr)
+void VART::Human::TraverseDepthFirst(SNOperator* operatorPtr) const
 {
     position.TraverseDepthFirst(operatorPtr);
     SceneNode::TraverseDepthFirst(operatorPtr);
@@ -0,0 +1,115 @@
+/// \file instancegroup.h
+/// \brief Header file for V-ART class "InstanceGroup".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_INSTANCEGROUP_H
+#define VART_INSTANCEGROUP_H
+
+#include "vart/graphicobj.h"
+#include "vart/matrix4.h"
+#include "vart/color.h"
+#include <vector>
+
+namespace VART {
+    class MeshObject;
+/// \class InstanceGroup instancegroup.h
+/// \brief Many copies (instances) of a mesh object, each with its own placement.
+///
+/// An instance group draws a mesh object once for each of its instances, which are
+/// matrices (and, optionally, colors) kept in arrays, instead of scene nodes. It replaces
+/// a transform per copy (e.g.: a forest of trees, a crowd, the chairs of a ferris wheel),
+/// avoiding scene graph traversal and matrix stack operations for each copy.
+///
+/// The mesh object is referenced, not copied nor made a child: it must outlive the group
+/// and should not be in the scene graph by itself (unless meant to be drawn there too).
+/// It must be optimized (see MeshObject::Optimize), as meshes read from files are.
+///
+/// Instances outside the view volume are culled by the bounding box of the mesh object,
+/// placed by each instance's matrix. The remaining instances are drawn with a draw call
+/// per mesh, using hardware instancing, if OpenGL 3.3 is available; otherwise, with a
+/// tight loop of draw calls that only load each instance's matrix. For instancing, a
+/// vertex shader reproduces fixed function lighting (ambient, diffuse and specular
+/// terms of point, directional and spot lights, with attenuation).
+///
+/// Instance colors, if given, replace ambient and diffuse colors of the mesh materials.
+    class InstanceGroup : public GraphicObj {
+        public:
+        // PUBLIC STATIC METHODS
+            /// \brief Enables or disables hardware instancing for all groups (default
+            /// enabled, where available).
+            static void SetInstancing(bool value) { instancing = value; }
+            /// \brief Checks whether hardware instancing is available in the current
+            /// OpenGL context.
+            static bool IsInstancingAvailable();
+        // PUBLIC METHODS
+            /// \brief Creates a group with no mesh object and no instances.
+            InstanceGroup();
+            /// \brief Creates a group of instances of a mesh object.
+            InstanceGroup(const MeshObject& meshObj);
+            InstanceGroup(const InstanceGroup& group);
+            InstanceGroup& operator=(const InstanceGroup& group);
+            /// \brief Returns a copy of the group (sharing the mesh object).
+            virtual SceneNode* Copy();
+            /// \brief Sets the mesh object to instantiate.
+            void SetMeshObject(const MeshObject& meshObj);
+            /// \brief Returns the mesh object (NULL if none).
+            const MeshObject* GetMeshObject() const { return meshObjPtr; }
+            /// \brief Adds an instance.
+            /// \return Index of the new instance.
+            unsigned int AddInstance(const Matrix4& matrix);
+            /// \brief Adds an instance with a color.
+            /// \return Index of the new instance.
+            unsigned int AddInstance(const Matrix4& matrix, const Color& color);
+            /// \brief Changes the placement of an instance.
+            ///
+            /// Call ComputeBoundingBox after changing instances, if the bounding box of
+            /// the group is needed.
+            void SetMatrix(unsigned int index, const Matrix4& matrix)
+                { matrixVec[index] = matrix; }
+            /// \brief Returns the placement of an instance.
+            const Matrix4& GetMatrix(unsigned int index) const { return matrixVec[index]; }
+            /// \brief Changes the color of an instance.
+            ///
+            /// Once a color is set, every instance has a color: instances with no color
+            /// set are white.
+            void SetColor(unsigned int index, const Color& color);
+            /// \brief Removes instance colors, so that materials are used.
+            void ClearColors() { colorVec.clear(); }
+            /// \brief Checks whether instances have colors.
+            bool HasColors() const { return !colorVec.empty(); }
+            /// \brief Returns the number of instances.
+            unsigned int GetNumInstances() const { return matrixVec.size(); }
+            /// \brief Removes all instances.
+            void ClearInstances();
+            /// \brief Returns the number of instances drawn (not culled) in the last frame.
+            unsigned int GetNumDrawn() const { return numDrawn; }
+            /// \brief Computes the bounding box of all instances.
+            virtual void ComputeBoundingBox();
+        protected:
+        // PROTECTED METHODS
+            /// \brief Culls instances, computing modelview matrices of the visible ones.
+            void CullInstances(const Matrix4& modelView, const Matrix4& projection) const;
+            /// \brief Draws visible instances, with hardware instancing.
+            /// \param texCoords [in] Whether the mesh object has texture coordinates.
+            bool DrawInstanced(bool texCoords) const;
+            /// \brief Draws visible instances, one by one.
+            /// \param texCoords [in] Whether the mesh object has texture coordinates.
+            bool DrawOneByOne(bool texCoords) const;
+            virtual bool DrawInstanceOGL() const;
+        // PROTECTED ATTRIBUTES
+            const MeshObject* meshObjPtr;
+            std::vector<Matrix4> matrixVec;
+            /// Colors of instances, empty if instances have no colors.
+            std::vector<Color> colorVec;
+            /// Modelview matrices of visible instances, 16 elements each, as OpenGL takes
+            /// them (computed at each frame).
+            mutable std::vector<float> visibleMatrixVec;
+            /// Colors of visible instances, RGBA (computed at each frame).
+            mutable std::vector<unsigned char> visibleColorVec;
+            mutable unsigned int numDrawn;
+        // PROTECTED STATIC ATTRIBUTES
+            static bool instancing;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -0,0 +1,128 @@
+/// \file matrix4.h
+/// \brief Header file for V-ART class "Matrix4".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_MATRIX4_H
+#define VART_MATRIX4_H
+
+#include "vart/point4d.h"
+#include <cstddef>
+
+namespace VART {
+/// \class Matrix4 matrix4.h
+/// \brief 4x4 transformation matrix, as a plain value.
+///
+/// Elements are kept in the same order as Transform and OpenGL (column by column, the
+/// translation at elements 12, 13 and 14). Unlike Transform, a Matrix4 is not a scene
+/// node, so it may be used for temporary results, arrays and computations in other
+/// threads at no cost.
+///
+/// Most matrices are affine (bottom row is 0, 0, 0, 1). Inversion checks for that and
+/// takes a shortcut; MultiplyAffine skips the work on the bottom row for callers that know
+/// their matrices are affine (checking costs more than a full product). Batches of points
+/// and vectors are always transformed as by an affine matrix (the bottom row is ignored).
+/// Kernels use AVX when compiled with it (e.g.: -mavx), SSE2 on x86 processors otherwise,
+/// and plain C++ if VART_NO_SIMD is defined. Large batches are split among threads of a
+/// shared WorkQueue.
+    class Matrix4 {
+        public:
+        // PUBLIC METHODS
+            /// \brief Creates an uninitialized matrix.
+            Matrix4() {}
+            /// \brief Creates a matrix from 16 elements, column by column.
+            explicit Matrix4(const double* values);
+
+            /// \brief Element access (see class description for the order).
+            double& operator[](unsigned int i) { return data[i]; }
+            /// \brief Element access (see class description for the order).
+            const double& operator[](unsigned int i) const { return data[i]; }
+            /// \brief Returns the address of the elements (e.g.: for glMultMatrixd).
+            const double* GetData() const { return data; }
+            /// \brief Copies 16 elements, column by column.
+            void SetData(const double* values);
+
+            /// \brief Checks whether the bottom row is exactly 0, 0, 0, 1.
+            bool IsAffine() const
+                { return (data[3] == 0) && (data[7] == 0) && (data[11] == 0) && (data[15] == 1); }
+
+            /// \brief Turns matrix into identity.
+            void MakeIdentity();
+            /// \brief Turns matrix into a translation (W coordinate is ignored).
+            void MakeTranslation(const Point4D& translationVector);
+            /// \brief Turns matrix into a rotation around the X axis.
+            void MakeXRotation(double radians);
+            /// \brief Turns matrix into a rotation around the Y axis.
+            void MakeYRotation(double radians);
+            /// \brief Turns matrix into a rotation around the Z axis.
+            void MakeZRotation(double radians);
+            /// \brief Turns matrix into a rotation around a vector.
+            void MakeRotation(const Point4D& refVec, double radians);
+            /// \brief Turns matrix into a rotation around an axis (a point and a vector).
+            void MakeRotation(const Point4D& refPoint, const Point4D& refVec, double radians);
+            /// \brief Turns matrix into a scale.
+            void MakeScale(double sX, double sY, double sZ);
+            /// \brief Turns matrix into a shear.
+            void MakeShear(double shX, double shY);
+
+            /// \brief Returns this*m (m is applied first).
+            Matrix4 operator*(const Matrix4& m) const;
+            /// \brief Applies matrix to a point.
+            Point4D operator*(const Point4D& point) const;
+            /// \brief Applies matrix to a point, in place.
+            void ApplyTo(Point4D* ptPoint) const;
+            /// \brief Computes a*b (b is applied first).
+            ///
+            /// The result may be one of the operands.
+            static void Multiply(const Matrix4& a, const Matrix4& b, Matrix4* resultPtr);
+            /// \brief Computes a*b, assuming both are affine.
+            ///
+            /// The result may be one of the operands.
+            static void MultiplyAffine(const Matrix4& a, const Matrix4& b, Matrix4* resultPtr);
+
+            /// \brief Computes the transpose. The result may be this matrix.
+            void GetTranspose(Matrix4* resultPtr) const;
+            /// \brief Computes the inverse. The result may be this matrix.
+            /// \return False (leaving the result untouched) if the matrix is singular.
+            bool GetInverse(Matrix4* resultPtr) const;
+
+            /// \brief Applies matrix to an array of points.
+            void ApplyTo(Point4D* points, unsigned int count) const;
+            /// \brief Transforms points, given as x, y, z triples.
+            /// \param src [in] Coordinates of "count" points
+            /// \param dst [out] Transformed coordinates (may be the same as src, or NULL if
+            /// only bounds are wanted)
+            /// \param bounds [out] If not NULL, gets the smallest x, y and z, then the
+            /// greatest x, y and z of transformed points (count must not be zero)
+            void TransformPoints(const double* src, double* dst, unsigned int count,
+                                 double* bounds = NULL) const;
+            /// \brief Transforms vectors (ignoring translation), given as x, y, z triples.
+            /// \param src [in] Coordinates of "count" vectors
+            /// \param dst [out] Transformed coordinates (may be the same as src)
+            void TransformVectors(const double* src, double* dst, unsigned int count) const;
+            /// \brief Transforms normals, given as x, y, z triples, and renormalizes them.
+            ///
+            /// Normals are transformed by the inverse transpose (see GetNormalMatrix), so
+            /// that they stay perpendicular to surfaces under scales and shears.
+            /// \return False (leaving normals untouched) if the matrix is singular.
+            bool TransformNormals(const double* src, double* dst, unsigned int count) const;
+            /// \brief Computes the matrix that transforms normals: the inverse transpose of
+            /// the upper left 3x3 part, with no translation.
+            /// \return False (leaving the result untouched) if the matrix is singular.
+            bool GetNormalMatrix(Matrix4* resultPtr) const;
+        // PUBLIC STATIC METHODS
+            /// \brief Sets the size of batches of points, vectors or normals from which work
+            /// is split among threads (default 65536).
+            static void SetParallelThreshold(unsigned int value) { parallelThreshold = value; }
+            /// \brief Sets the most threads that share a large batch (default zero: the
+            /// number of processors).
+            static void SetNumThreads(unsigned int value) { numThreads = value; }
+        protected:
+        // PROTECTED ATTRIBUTES
+            double data[16];
+        // PROTECTED STATIC ATTRIBUTES
+            static unsigned int parallelThreshold;
+            static unsigned int numThreads;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -3,9 +3,10 @@
 /// \version $Revision: 1.8 $
 
 #include "vart/action.h"
+#include "vart/profiler.h"
 #include "vart/jointmover.h"
 #include "vart/dofmover.h"
-#include "vart/time.h"
+#include "vart/simulationclock.h"
 #include "vart/dof.h"
 #include "vart/callback.h"
 #include "vart/dmmodifier.h"
@@ -14,6 +15,7 @@
 using namespace std;
 
 list<VART::Action*> VART::Action::activeInstances;
+map<unsigned int, list<VART::Action*>::iterator> VART::Action::activeGroups;
 float VART::Action::frameFrequency = 0.0f;
 
 VART::Action::Action() : callbackPtr(NULL), active(false), duration(0.0f),
@@ -76,7 +78,7 @@ void VART::Action::Move()
     list<VART::JointMover*>::iterator iter;
 
     // compute timeDiff
-    currentTime.Set();
+    currentTime = SimulationClock::NOW();
     if (frameFrequency < 0.001)
         // real time
         timeDiff = (currentTime - initialTime).AsFloat() * speed;
@@ -128,25 +130,22 @@ void VART::Action::Activate()
 {
     if (!active)
     {
-        initialTime.Set();
+        initialTime = SimulationClock::NOW();
 
         // Add action to list of active instances (using priority order)
-        list<Action*>::iterator iter = activeInstances.begin();
-        bool notFinished = true;
-        while (notFinished && (iter != activeInstances.end()))
-        {
-            // Actions with higher priority must come first in the list so that those
-            // with lower priority will never have the chance to move DOFs. If they did,
-            // transitions between DOF movers of the same action would get ugly.
-            if ((*iter)->priority < priority)
-            {
-                activeInstances.insert(iter,this);
-                notFinished = false;
-            }
-            ++iter;
-        }
-        if (notFinished)
-            activeInstances.push_back(this);
+        // Actions with higher priority must come first in the list so that those
+        // with lower priority will never have the chance to move DOFs. If they did,
+        // transitions between DOF movers of the same action would get ugly.
+        // Insert before the first action of the greatest priority lower than this one.
+        map<unsigned int, list<Action*>::iterator>::iterator groupIter;
+        groupIter = activeGroups.lower_bound(priority);
+        if (groupIter == activeGroups.begin())
+            activeIter = activeInstances.insert(activeInstances.end(), this);
+        else
+            activeIter = activeInstances.insert((--groupIter)->second, this);
+        if (activeGroups.find(priority) == activeGroups.end())
+            activeGroups[priority] = activeIter;
+        activePriority = priority;
         active = true;
         timeDiff = 0.0f;
         Move(); // ugly fix to prevent lower priority actions from changing target dofs
@@ -157,24 +156,22 @@ void VART::Action::Deactivate()
 {
     if (active)
     {
-        list<VART::Action*>::iterator iter = activeInstances.begin();
-
         // Remove this instance from list and deactivate all dof movers so that they must be
         // recomputed if the action is activated again.
         active = false;
-        while (iter != activeInstances.end())
+        map<unsigned int, list<Action*>::iterator>::iterator groupIter;
+        groupIter = activeGroups.find(activePriority);
+        if (groupIter->second == activeIter)
         {
-            //~ (*iter)->DeactivateDofMovers();
-            if ((*iter) == this)
-            {
-                DeactivateDofMovers();
-                //~ activeInstances.erase(iter++);
-                activeInstances.erase(iter);
-                iter = activeInstances.end();
-            }
+            list<Action*>::iterator nextIter = activeIter;
+            ++nextIter;
+            if ((nextIter != activeInstances.end()) && ((*nextIter)->activePriority == activePriority))
+                groupIter->second = nextIter;
             else
-                ++iter;
+                activeGroups.erase(groupIter);
         }
+        DeactivateDofMovers();
+        activeInstances.erase(activeIter);
         if (callbackPtr)
             callbackPtr->Activate();
     }
@@ -195,6 +192,7 @@ void VART::Action::DeactivateDofMovers()
 unsigned int VART::Action::MoveAllActive()
 // static method
 {
+    VART_PROFILE_ZONE("Action::MoveAllActive");
     list<VART::Action*>::iterator iter = activeInstances.begin();
     list<VART::Action*>::iterator tempIter;
 
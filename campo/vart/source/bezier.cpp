@@ -25,17 +25,86 @@ void VART::Bezier::SetControlPoint(int i, const VART::Point4D& point) {
     controlPoints[i] = point;
 }
 
+void VART::Bezier::ComputeBoundingBox() {
+    bBox.SetBoundingBox(controlPoints[0].GetX(), controlPoints[0].GetY(), controlPoints[0].GetZ(),
+                        controlPoints[0].GetX(), controlPoints[0].GetY(), controlPoints[0].GetZ());
+    for (int i = 1; i < 4; ++i)
+        bBox.ConditionalUpdate(controlPoints[i]);
+    bBox.ProcessCenter();
+}
+
 void VART::Bezier::GetPoint(double t, VART::Point4D* result) {
     double invT = 1-t; // Cache this common value
     double t2 = t*t; // Cache this common value
-    VART::Point4D p0(controlPoints[0]);
-    VART::Point4D p1(controlPoints[1]);
-    VART::Point4D p2(controlPoints[2]);
-    VART::Point4D p3(controlPoints[3]);
-
-    p0 *= invT*invT*invT;
-    p1 *= 3*t*invT*invT;
-    p2 *= 3*t2*invT;
-    p3 *= t2*t;
-    *result = p0 + p1 + p2 + p3;
+    double b0 = invT*invT*invT;
+    double b1 = 3*t*invT*invT;
+    double b2 = 3*t2*invT;
+    double b3 = t2*t;
+    const double* p0 = controlPoints[0].VetXYZW();
+    const double* p1 = controlPoints[1].VetXYZW();
+    const double* p2 = controlPoints[2].VetXYZW();
+    const double* p3 = controlPoints[3].VetXYZW();
+    double coord[4];
+    for (int i = 0; i < 4; ++i)
+        coord[i] = b0*p0[i] + b1*p1[i] + b2*p2[i] + b3*p3[i];
+    result->SetXYZW(coord[0], coord[1], coord[2], coord[3]);
+}
+
+void VART::Bezier::ComputePowerBasis(double* coef) const {
+    const double* p0 = controlPoints[0].VetXYZW();
+    const double* p1 = controlPoints[1].VetXYZW();
+    const double* p2 = controlPoints[2].VetXYZW();
+    const double* p3 = controlPoints[3].VetXYZW();
+    for (int i = 0; i < 4; ++i) {
+        coef[i] = p3[i] - p0[i] + 3*(p1[i] - p2[i]);
+        coef[4+i] = 3*(p0[i] - 2*p1[i] + p2[i]);
+        coef[8+i] = 3*(p1[i] - p0[i]);
+        coef[12+i] = p0[i];
+    }
+}
+
+void VART::Bezier::GetPoints(const double* params, unsigned int count, VART::Point4D* results) {
+    double coef[16];
+    ComputePowerBasis(coef);
+    for (unsigned int j = 0; j < count; ++j) {
+        double t = params[j];
+        double coord[4];
+        for (int i = 0; i < 4; ++i)
+            coord[i] = ((coef[i]*t + coef[4+i])*t + coef[8+i])*t + coef[12+i];
+        results[j].SetXYZW(coord[0], coord[1], coord[2], coord[3]);
+    }
+}
+
+void VART::Bezier::GetUniformPoints(double tBegin, double tEnd, unsigned int count,
+                                    VART::Point4D* results) {
+    if (count == 0)
+        return;
+    double h = (count > 1) ? (tEnd - tBegin) / (count - 1) : 0.0;
+    double coef[16];
+    ComputePowerBasis(coef);
+    // Rewrite the polynomial on the local parameter s, where t = tBegin + s*h.
+    // Then point(s) = a*s^3 + b*s^2 + c*s + d and its finite differences are:
+    // d1 = a + b + c, d2 = 6a + 2b, d3 = 6a.
+    double point[4], d1[4], d2[4], d3[4];
+    for (int i = 0; i < 4; ++i) {
+        double a = coef[i];
+        double b = coef[4+i];
+        double c = coef[8+i];
+        // Coefficients in s
+        double as = a*h*h*h;
+        double bs = (3*a*tBegin + b)*h*h;
+        double cs = ((3*a*tBegin + 2*b)*tBegin + c)*h;
+        point[i] = ((a*tBegin + b)*tBegin + c)*tBegin + coef[12+i];
+        d1[i] = as + bs + cs;
+        d2[i] = 6*as + 2*bs;
+        d3[i] = 6*as;
+    }
+    for (unsigned int j = 0; j < count; ++j) {
+        results[j].SetXYZW(point[0], point[1], point[2], point[3]);
+        for (int i = 0; i < 4; ++i) {
+            point[i] += d1[i];
+            d1[i] += d2[i];
+            d2[i] += d3[i];
+        }
+    }
 }
@@ -3,8 +3,10 @@
 /// \version $Revision: 1.6 $
 
 #include "vart/dof.h"
+#include "vart/framestats.h"
 #include "vart/joint.h"
 #include "vart/modifier.h"
+#include "vart/xmlwriter.h"
 #include <algorithm>
 
 using namespace std;
@@ -31,7 +33,7 @@ VART::Dof::Dof()
     maxAngle = 0;
     currentPosition = 0;
     restPosition = 0;
-    instanceList.push_back(this);
+    instanceListPos = instanceList.insert(instanceList.end(), this);
 }
 
 VART::Dof::Dof(const VART::Dof& dof)
@@ -52,7 +54,7 @@ VART::Dof::Dof(const VART::Dof& dof)
     currentPosition = dof.currentPosition;
     restPosition = dof.restPosition;
     ownerJoint = dof.ownerJoint;
-    instanceList.push_back(this);
+    instanceListPos = instanceList.insert(instanceList.end(), this);
 }
 
 VART::Dof::Dof(const VART::Point4D& vec, const VART::Point4D& pos, float min, float max)
@@ -69,14 +71,13 @@ VART::Dof::Dof(const VART::Point4D& vec, const VART::Point4D& pos, float min, fl
     currentPosition = (0-min)/(max-min);
     axis.Normalize();
     ComputeLIM();
-    instanceList.push_back(this);
+    instanceListPos = instanceList.insert(instanceList.end(), this);
 }
 
 VART::Dof::~Dof()
 {
     // remove itself from list of instances
-    list<VART::Dof*>::iterator iter = find(instanceList.begin(), instanceList.end(), this);
-    instanceList.erase(iter);
+    instanceList.erase(instanceListPos);
 }
 
 VART::Dof& VART::Dof::operator=(const VART::Dof& dof)
@@ -217,6 +218,12 @@ float VART::Dof::GetCurrent() const
     return currentPosition;
 }
 
+void VART::Dof::SetCurrent(float pos)
+{
+    currentPosition = pos;
+    ComputeLIM();
+}
+
 float VART::Dof::GetRest() const
 {
     return restPosition;
@@ -256,6 +263,7 @@ void VART::Dof::SetMax(float max)
 
 void VART::Dof::MoveTo(float pos)
 {
+    ++FrameStats::current.dofsMoved;
     // Avoid values out of range
     if (pos > 1.0) pos = 1.0;
     if (pos < 0.0) pos = 0.0;
@@ -340,7 +348,7 @@ VART::Modifier* VART::Dof::GetRangeModifier()
 
 void VART::Dof::ApplyTransformTo(VART::Transform* ptrTrans) const
 {
-    ptrTrans->CopyMatrix(lim * (*ptrTrans));
+    ptrTrans->Apply(lim);
 }
 
 void VART::Dof::Reconfigure(const Point4D& state, const Point4D& target)
@@ -424,17 +432,30 @@ void VART::Dof::ClearPriorities()
 }
 
 void VART::Dof::XmlPrintOn(ostream& os, unsigned int indent) const
-// virtual method
-{
-    string indentStr(indent,' ');
-
-    os << indentStr << "<dof description=\"" << description << "\">\n"
-       << indentStr << "  <position x=\"" << position.GetX() << "\" y=\"" << position.GetY()
-                    << "\" z=\"" << position.GetZ() << "\"/>\n"
-       << indentStr << "  <axis x=\"" << axis.GetX() << "\" y=\"" << axis.GetY()
-                    << "\" z=\"" << axis.GetZ() << "\"/>\n"
-       << indentStr << "  <range min=\"" << minAngle << "\" max=\"" << maxAngle
-                    << "\" rest=\"" << restPosition << "\"/>\n"
-       << indentStr << "</dof>\n";
-    os << flush;
+{
+    XmlWriter writer;
+    XmlWrite(&writer, indent);
+    writer.WriteTo(os);
+}
+
+void VART::Dof::XmlWrite(XmlWriter* writerPtr, unsigned int indent) const
+{
+    writerPtr->Indent(indent);
+    writerPtr->Append("<dof description=\"");
+    writerPtr->Append(description);
+    writerPtr->Append("\">\n");
+    writerPtr->Indent(indent);
+    writerPtr->Append("  <position x=\"", position.GetX(), "\" y=\"");
+    writerPtr->Append(position.GetY());
+    writerPtr->Append("\" z=\"", position.GetZ(), "\"/>\n");
+    writerPtr->Indent(indent);
+    writerPtr->Append("  <axis x=\"", axis.GetX(), "\" y=\"");
+    writerPtr->Append(axis.GetY());
+    writerPtr->Append("\" z=\"", axis.GetZ(), "\"/>\n");
+    writerPtr->Indent(indent);
+    writerPtr->Append("  <range min=\"", minAngle, "\" max=\"");
+    writerPtr->Append(maxAngle);
+    writerPtr->Append("\" rest=\"", restPosition, "\"/>\n");
+    writerPtr->Indent(indent);
+    writerPtr->Append("</dof>\n");
 }
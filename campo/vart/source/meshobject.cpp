@@ -2,7 +2,12 @@
 /// \brief Implementation file for V-ART class "MeshObject".
 /// \version $Revision: 1.14 $
 
+#ifdef VART_OGL
+#define GL_GLEXT_PROTOTYPES
+#endif
 #include "vart/meshobject.h"
+#include "vart/framestats.h"
+#include "vart/profiler.h"
 #include "vart/file.h"
 #include <sstream>
 #include <cassert>
@@ -10,11 +15,18 @@
 #include <cstdlib>
 #include <algorithm> // transform
 #include <cctype> // tolower
+#include <cstdio> // sscanf
+#include <cmath>
 
 using namespace std;
 
 float VART::MeshObject::sizeOfNormals = 0.1f;
 
+// Vertices are grouped in blocks of 2^BLOCK_SHIFT vertices for bounds and dirty flags
+static const unsigned int BLOCK_SHIFT = 8;
+// Dirty ranges closer than this (in vertices) are uploaded together
+static const unsigned int UPLOAD_GAP = 64;
+
 // === Auxiliary functions ===
 unsigned int CountOccurrences(char c, string s)
 {
@@ -29,16 +41,46 @@ unsigned int CountOccurrences(char c, string s)
 }
 
 // === Member funcitions ===
+#ifdef VART_OGL
+// Whether vertex buffer objects (OpenGL 1.5) can be used
+static bool BuffersAvailable()
+{
+#ifdef GL_VERSION_1_5
+    static int available = -1; // unknown
+    if (available < 0)
+    {
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        if (!version)
+            return false; // no context yet: ask again later
+        int major = 0;
+        int minor = 0;
+        sscanf(version, "%d.%d", &major, &minor);
+        available = (major > 1) || ((major == 1) && (minor >= 5));
+    }
+    return available == 1;
+#else
+    return false;
+#endif
+}
+#endif
+
 VART::MeshObject::MeshObject()
+    : deformationPtr(NULL)
 {
     howToShow = FILLED;
 }
 
 VART::MeshObject::MeshObject(const VART::MeshObject& obj)
+    : deformationPtr(NULL)
 {
     this->operator=(obj);
 }
 
+VART::MeshObject::~MeshObject()
+{
+    delete deformationPtr;
+}
+
 VART::MeshObject& VART::MeshObject::operator=(const VART::MeshObject& obj)
 {
     this->GraphicObj::operator =(obj);
@@ -48,6 +90,10 @@ VART::MeshObject& VART::MeshObject::operator=(const VART::MeshObject& obj)
     normCoordVec = obj.normCoordVec;
     textCoordVec = obj.textCoordVec;
     meshList = obj.meshList;
+    fileName = obj.fileName;
+    // Deformation data (and the vertex buffer) are not shared
+    delete deformationPtr;
+    deformationPtr = NULL;
     return *this;
 }
 
@@ -64,6 +110,7 @@ void VART::MeshObject::Clear()
     normCoordVec.clear();
     textCoordVec.clear();
     meshList.clear();
+    DiscardDeformation();
 }
 
 void VART::MeshObject::SetMaterial(const VART::Material& mat)
@@ -87,6 +134,7 @@ void VART::MeshObject::SetVertices(const std::vector<VART::Point4D>& vertexVec)
     // Copy the vertVec (unoptimized vertices) as well
     vertVec = vertexVec;
     meshList.clear();
+    DiscardDeformation();
     ComputeBoundingBox();
     ComputeRecursiveBoundingBox();
 }
@@ -95,6 +143,7 @@ void VART::MeshObject::SetNormals(const vector<Point4D>& normalVec)
 {
     normVec = normalVec;
     meshList.clear(); // FixMe: Why clear the meshlist?
+    DiscardDeformation();
     ComputeBoundingBox(); // FixMe: Why recompute the bounding box?
     ComputeRecursiveBoundingBox();
 }
@@ -125,6 +174,7 @@ void VART::MeshObject::SetVertices(const char* vertexStr)
         }
     } while (notFinished);
     meshList.clear();
+    DiscardDeformation();
     ComputeBoundingBox();
     ComputeRecursiveBoundingBox();
 }
@@ -142,6 +192,7 @@ void VART::MeshObject::SetVertex(unsigned int index, const VART::Point4D& newVal
     { // vertVec is not empty
         vertVec[index] = newValue;
     }
+    DiscardDeformation();
 }
 
 VART::Point4D VART::MeshObject::GetVertex(unsigned int pos)
@@ -259,6 +310,7 @@ void VART::MeshObject::AddFace(const char* indexStr)
         mesh.normIndVec.push_back(thisFacesNormalIndex);
     }
     meshList.push_back(mesh);
+    DiscardDeformation();
 
     // Auto computation of face normal
     // FixMe: It should be possible to disable auto computation
@@ -273,6 +325,7 @@ void VART::MeshObject::AddFace(const char* indexStr)
 void VART::MeshObject::AddMesh(const Mesh& m)
 {
     meshList.push_back(m);
+    DiscardDeformation();
 }
 
 void VART::MeshObject::MakeBox(double minX, double maxX, double minY, double maxY, double minZ, double maxZ)
@@ -340,6 +393,7 @@ void VART::MeshObject::MakeBox(double minX, double maxX, double minY, double max
     mesh.indexVec.assign(indexArray,endOfIndexArray);
     mesh.material = VART::Material::DARK_PLASTIC_GRAY(); // default material
     meshList.push_back(mesh);
+    DiscardDeformation();
     ComputeBoundingBox();
     ComputeRecursiveBoundingBox();
 }
@@ -399,33 +453,25 @@ void VART::MeshObject::ComputeBoundingBox() {
 
 void VART::MeshObject::ComputeBoundingBox(const VART::Transform& trans, VART::BoundingBox* bbPtr) {
 
-    VART::Point4D p;
+    const VART::Matrix4& matrix = trans.GetMatrix();
 
     if (vertCoordVec.size() > 0)
     { // Optimized structure found - use it!
-        // Initialize
-        p.SetXYZW( vertCoordVec[0], vertCoordVec[1], vertCoordVec[2], 1 );
-        p = trans * p;
-        bbPtr->SetBoundingBox(p.GetX(), p.GetY(), p.GetZ() , p.GetX(), p.GetY(), p.GetZ());
-        // Check against the others
-        for (unsigned int i=3; i < vertCoordVec.size(); i+=3)
-        {
-            p.SetXYZW( vertCoordVec[i], vertCoordVec[i+1], vertCoordVec[i+2], 1 );
-            p = trans * p;
-            bbPtr->ConditionalUpdate( p );
-        }
+        // Transform all vertices, keeping only their extremes
+        double bounds[6];
+        matrix.TransformPoints(&vertCoordVec[0], NULL, vertCoordVec.size() / 3, bounds);
+        bbPtr->SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
     }
     else
     { // No optmized structure found - use vertVec
+        VART::Point4D p;
         // Initialize
-        p = vertVec[0];
-        p = trans * p;
+        p = matrix * vertVec[0];
         bbPtr->SetBoundingBox(p.GetX(), p.GetY(), p.GetZ() , p.GetX(), p.GetY(), p.GetZ());
         // Check against the others
         for (unsigned int i=1; i < vertVec.size(); ++i)
         {
-            p = vertVec[i];
-            p = trans * p;
+            p = matrix * vertVec[i];
             bbPtr->ConditionalUpdate( p );
         }
     }
@@ -433,7 +479,6 @@ void VART::MeshObject::ComputeBoundingBox(const VART::Transform& trans, VART::Bo
 
 void VART::MeshObject::ComputeSubBBoxes( const Transform& trans, int subdivisions )
 {
-    VART::Point4D p;
     VART::BoundingBox globalBBox;
     std::vector<VART::Point4D> pointList;
 
@@ -441,22 +486,16 @@ void VART::MeshObject::ComputeSubBBoxes( const Transform& trans, int subdivision
     if (vertCoordVec.size() <= 0)
         return;
 
-    pointList.reserve( (int) (vertCoordVec.size() / 3) );
-
-    // Initialize
-    p.SetXYZW( vertCoordVec[0], vertCoordVec[1], vertCoordVec[2], 1 );
-    p = trans * p;
-    pointList.push_back( p );
-    globalBBox.SetBoundingBox(p.GetX(), p.GetY(), p.GetZ() , p.GetX(), p.GetY(), p.GetZ());
+    // Transform all vertices, computing the global bounding box on the way
+    unsigned int numVertices = vertCoordVec.size() / 3;
+    std::vector<double> coordVec(vertCoordVec.size());
+    double bounds[6];
+    trans.GetMatrix().TransformPoints(&vertCoordVec[0], &coordVec[0], numVertices, bounds);
+    globalBBox.SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
 
-    // Check against the others
-    for (unsigned int i=3; i < vertCoordVec.size(); i+=3)
-    {
-        p.SetXYZW( vertCoordVec[i], vertCoordVec[i+1], vertCoordVec[i+2], 1 );
-        p = trans * p;
-        pointList.push_back( p );
-        globalBBox.ConditionalUpdate( p );
-    }
+    pointList.reserve(numVertices);
+    for (unsigned int i=0; i < coordVec.size(); i+=3)
+        pointList.push_back(VART::Point4D(coordVec[i], coordVec[i+1], coordVec[i+2]));
 
     if( subdivisions <= 0)
     {
@@ -543,6 +582,453 @@ void VART::MeshObject::ComputeVertexNormals()
         // now, each normal holds the sum of face normals that share it
     }
     NormalizeAllNormals();
+    DiscardDeformation();
+}
+
+// Computes the normal of a face from its first three vertices, as ComputeTriangleNormal does
+// (degenerate faces get a null normal)
+static void FaceNormal(const double* coords, const unsigned int* vertices, double* normal)
+{
+    const double* v1 = coords + vertices[0] * 3;
+    const double* v2 = coords + vertices[1] * 3;
+    const double* v3 = coords + vertices[2] * 3;
+    double edge1[3] = { v2[0] - v1[0], v2[1] - v1[1], v2[2] - v1[2] };
+    double edge2[3] = { v3[0] - v2[0], v3[1] - v2[1], v3[2] - v2[2] };
+    normal[0] = edge1[1] * edge2[2] - edge1[2] * edge2[1];
+    normal[1] = edge1[2] * edge2[0] - edge1[0] * edge2[2];
+    normal[2] = edge1[0] * edge2[1] - edge1[1] * edge2[0];
+    double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (length > 0)
+    {
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+    }
+}
+
+// Computes the bounds (minimum x, y and z, then maximum) of a range of vertices
+static void RangeBounds(const double* coords, unsigned int first, unsigned int end,
+                        double* bounds)
+{
+    const double* vertex = coords + first * 3;
+    for (unsigned int axis = 0; axis < 3; ++axis)
+        bounds[axis] = bounds[axis + 3] = vertex[axis];
+    for (unsigned int i = first + 1; i < end; ++i)
+    {
+        vertex += 3;
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            if (vertex[axis] < bounds[axis])
+                bounds[axis] = vertex[axis];
+            else if (vertex[axis] > bounds[axis + 3])
+                bounds[axis + 3] = vertex[axis];
+        }
+    }
+}
+
+VART::MeshObject::Deformation::Deformation()
+    : numVertices(0), numIndices(0), mark(0), allDirty(true), vertexBuffer(0),
+      bufferVertices(0)
+{
+}
+
+VART::MeshObject::Deformation::~Deformation()
+{
+#if defined(VART_OGL) && defined(GL_VERSION_1_5)
+    if (vertexBuffer)
+        glDeleteBuffers(1, &vertexBuffer);
+#endif
+}
+
+void VART::MeshObject::Deformation::ClearDirty(unsigned int numVertices)
+{
+    allDirty = false;
+    if (dirtyVec.size() != numVertices)
+    {
+        dirtyVec.assign(numVertices, 0);
+        dirtyBlockVec.assign((numVertices >> BLOCK_SHIFT) + 1, 0);
+        return;
+    }
+    for (unsigned int block = 0; block < dirtyBlockVec.size(); ++block)
+    {
+        if (dirtyBlockVec[block])
+        {
+            unsigned int first = block << BLOCK_SHIFT;
+            unsigned int end = min(first + (1 << BLOCK_SHIFT), numVertices);
+            fill(dirtyVec.begin() + first, dirtyVec.begin() + end, 0);
+            dirtyBlockVec[block] = 0;
+        }
+    }
+}
+
+bool VART::MeshObject::UpdateVertices(const unsigned int* indices, unsigned int count,
+                                      const double* coords)
+{
+    return Deform(indices, 0, count, coords);
+}
+
+bool VART::MeshObject::UpdateVertexRange(unsigned int first, unsigned int count,
+                                         const double* coords)
+{
+    return Deform(NULL, first, count, coords);
+}
+
+void VART::MeshObject::GetDirtyRanges(vector<pair<unsigned int, unsigned int> >* resultPtr) const
+{
+    unsigned int numVertices = vertCoordVec.size() / 3;
+    resultPtr->clear();
+    if (numVertices == 0)
+        return;
+    if (!deformationPtr || deformationPtr->allDirty ||
+        (deformationPtr->dirtyVec.size() != numVertices))
+    { // changes were not tracked
+        resultPtr->push_back(make_pair(0u, numVertices));
+        return;
+    }
+    const Deformation& def = *deformationPtr;
+    for (unsigned int block = 0; block < def.dirtyBlockVec.size(); ++block)
+    {
+        if (!def.dirtyBlockVec[block])
+            continue;
+        unsigned int end = min((block + 1) << BLOCK_SHIFT, numVertices);
+        for (unsigned int i = block << BLOCK_SHIFT; i < end; ++i)
+        {
+            if (def.dirtyVec[i])
+            {
+                if (!resultPtr->empty() &&
+                    (resultPtr->back().first + resultPtr->back().second == i))
+                    ++resultPtr->back().second;
+                else
+                    resultPtr->push_back(make_pair(i, 1u));
+            }
+        }
+    }
+}
+
+void VART::MeshObject::ClearDirtyRanges()
+{
+    if (!deformationPtr)
+        deformationPtr = new Deformation;
+    deformationPtr->ClearDirty(vertCoordVec.size() / 3);
+}
+
+void VART::MeshObject::DiscardDeformation()
+{
+    if (deformationPtr)
+    {
+        deformationPtr->numVertices = 0;
+        deformationPtr->allDirty = true;
+    }
+}
+
+void VART::MeshObject::PrepareDeformation()
+{
+    unsigned int numVertices = vertCoordVec.size() / 3;
+    unsigned int numIndices = 0;
+    list<Mesh>::const_iterator iter;
+    for (iter = meshList.begin(); iter != meshList.end(); ++iter)
+        numIndices += iter->indexVec.size();
+    if (!deformationPtr)
+        deformationPtr = new Deformation;
+    Deformation& def = *deformationPtr;
+    if ((def.numVertices == numVertices) && (def.numIndices == numIndices))
+        return;
+
+    // Find faces the same way ComputeVertexNormals does
+    def.faceVertVec.clear();
+    def.faceStartVec.clear();
+    for (iter = meshList.begin(); iter != meshList.end(); ++iter)
+    {
+        const vector<unsigned int>& indexVec = iter->indexVec;
+        unsigned int p1Idx = 0;
+        unsigned int p2Idx = 1;
+        unsigned int p3Idx = 2;
+        unsigned int end = indexVec.size();
+        if ((iter->type < Mesh::TRIANGLES) || (iter->type > Mesh::POLYGON))
+            continue; // no faces
+        while (p3Idx < end)
+        {
+            def.faceStartVec.push_back(def.faceVertVec.size());
+            def.faceVertVec.push_back(indexVec[p1Idx]);
+            def.faceVertVec.push_back(indexVec[p2Idx]);
+            def.faceVertVec.push_back(indexVec[p3Idx]);
+            switch (iter->type)
+            {
+                case Mesh::TRIANGLES:
+                    p1Idx += 3;
+                    p2Idx += 3;
+                    p3Idx += 3;
+                break;
+                case Mesh::TRIANGLE_STRIP:
+                    p1Idx += 1;
+                    p2Idx += 1;
+                    p3Idx += 1;
+                break;
+                case Mesh::TRIANGLE_FAN:
+                    p3Idx += 1;
+                break;
+                case Mesh::QUADS:
+                    def.faceVertVec.push_back(indexVec[p3Idx+1]);
+                    p1Idx += 4;
+                    p2Idx += 4;
+                    p3Idx += 4;
+                break;
+                case Mesh::QUAD_STRIP:
+                    def.faceVertVec.push_back(indexVec[p3Idx+1]);
+                    p1Idx += 2;
+                    p2Idx += 2;
+                    p3Idx += 2;
+                break;
+                default: // POLYGON
+                    for (++p3Idx; p3Idx < end; ++p3Idx)
+                        def.faceVertVec.push_back(indexVec[p3Idx]);
+            }
+        }
+    }
+    unsigned int numFaces = def.faceStartVec.size();
+    def.faceStartVec.push_back(def.faceVertVec.size());
+
+    // Faces around each vertex: count them, then fill each vertex's slice
+    def.vertFaceStartVec.assign(numVertices + 1, 0);
+    for (unsigned int i = 0; i < def.faceVertVec.size(); ++i)
+        ++def.vertFaceStartVec[def.faceVertVec[i] + 1];
+    for (unsigned int v = 0; v < numVertices; ++v)
+        def.vertFaceStartVec[v + 1] += def.vertFaceStartVec[v];
+    def.vertFaceVec.resize(def.faceVertVec.size());
+    vector<unsigned int> nextVec(def.vertFaceStartVec.begin(), def.vertFaceStartVec.end() - 1);
+    for (unsigned int face = 0; face < numFaces; ++face)
+        for (unsigned int i = def.faceStartVec[face]; i < def.faceStartVec[face + 1]; ++i)
+            def.vertFaceVec[nextVec[def.faceVertVec[i]]++] = face;
+
+    def.faceNormalVec.resize(numFaces * 3);
+    for (unsigned int face = 0; face < numFaces; ++face)
+        FaceNormal(&vertCoordVec[0], &def.faceVertVec[def.faceStartVec[face]],
+                   &def.faceNormalVec[face * 3]);
+    if (normCoordVec.size() != vertCoordVec.size())
+    { // no normals yet: compute them all
+        normCoordVec.assign(vertCoordVec.size(), 0);
+        for (unsigned int v = 0; v < numVertices; ++v)
+            ComputeDeformedNormal(v);
+    }
+
+    unsigned int numBlocks = (numVertices >> BLOCK_SHIFT) + 1;
+    def.blockBoundsVec.resize(numBlocks * 6);
+    for (unsigned int block = 0; (block << BLOCK_SHIFT) < numVertices; ++block)
+        RangeBounds(&vertCoordVec[0], block << BLOCK_SHIFT,
+                    min((block + 1) << BLOCK_SHIFT, numVertices), &def.blockBoundsVec[block * 6]);
+    def.refitVec.assign(numBlocks, 0);
+    def.faceMarkVec.assign(numFaces, 0);
+    def.vertMarkVec.assign(numVertices, 0);
+    def.mark = 0;
+    if (def.dirtyVec.size() != numVertices)
+    {
+        def.dirtyVec.assign(numVertices, 0);
+        def.dirtyBlockVec.assign(numBlocks, 0);
+        def.allDirty = true;
+    }
+    def.numVertices = numVertices;
+    def.numIndices = numIndices;
+}
+
+void VART::MeshObject::ComputeDeformedNormal(unsigned int vertex)
+{
+    const Deformation& def = *deformationPtr;
+    double* normal = &normCoordVec[vertex * 3];
+    normal[0] = normal[1] = normal[2] = 0;
+    for (unsigned int i = def.vertFaceStartVec[vertex]; i < def.vertFaceStartVec[vertex + 1]; ++i)
+    {
+        const double* faceNormal = &def.faceNormalVec[def.vertFaceVec[i] * 3];
+        normal[0] += faceNormal[0];
+        normal[1] += faceNormal[1];
+        normal[2] += faceNormal[2];
+    }
+    double length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (length > 0)
+    {
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+    }
+}
+
+bool VART::MeshObject::Deform(const unsigned int* indices, unsigned int first, unsigned int count,
+                              const double* coords)
+{
+    unsigned int numVertices = vertCoordVec.size() / 3;
+    if (numVertices == 0)
+    {
+        cerr << "Error: MeshObject::UpdateVertices: object is not optimized." << endl;
+        return false;
+    }
+    if (indices)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (indices[i] >= numVertices)
+            {
+                cerr << "Error: MeshObject::UpdateVertices: vertex index " << indices[i]
+                     << " out of range." << endl;
+                return false;
+            }
+        }
+    }
+    else if ((first > numVertices) || (count > numVertices - first))
+    {
+        cerr << "Error: MeshObject::UpdateVertexRange: vertices " << first << " to "
+             << first + count << " out of range." << endl;
+        return false;
+    }
+    if (count == 0)
+        return true;
+    PrepareDeformation();
+    Deformation& def = *deformationPtr;
+    if (++def.mark == 0)
+    { // marks wrapped around: forget old ones
+        def.faceMarkVec.assign(def.faceMarkVec.size(), 0);
+        def.vertMarkVec.assign(def.vertMarkVec.size(), 0);
+        def.mark = 1;
+    }
+    def.faceListVec.clear();
+    def.vertListVec.clear();
+    def.refitListVec.clear();
+
+    // Move vertices, growing bounds of their blocks, and collect faces around them. A block
+    // where a vertex leaves its bounds may shrink, so its bounds are computed again later.
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        unsigned int v = indices ? indices[i] : first + i;
+        double* vertex = &vertCoordVec[v * 3];
+        const double* newVertex = coords + i * 3;
+        unsigned int block = v >> BLOCK_SHIFT;
+        if (!def.refitVec[block])
+        {
+            double* bounds = &def.blockBoundsVec[block * 6];
+            for (unsigned int axis = 0; axis < 3; ++axis)
+            {
+                if (((vertex[axis] == bounds[axis]) && (newVertex[axis] > bounds[axis])) ||
+                    ((vertex[axis] == bounds[axis + 3]) && (newVertex[axis] < bounds[axis + 3])))
+                {
+                    def.refitVec[block] = 1;
+                    def.refitListVec.push_back(block);
+                    break;
+                }
+            }
+            if (!def.refitVec[block])
+            {
+                for (unsigned int axis = 0; axis < 3; ++axis)
+                {
+                    if (newVertex[axis] < bounds[axis])
+                        bounds[axis] = newVertex[axis];
+                    else if (newVertex[axis] > bounds[axis + 3])
+                        bounds[axis + 3] = newVertex[axis];
+                }
+            }
+        }
+        vertex[0] = newVertex[0];
+        vertex[1] = newVertex[1];
+        vertex[2] = newVertex[2];
+        def.dirtyVec[v] = 1;
+        def.dirtyBlockVec[block] = 1;
+        for (unsigned int j = def.vertFaceStartVec[v]; j < def.vertFaceStartVec[v + 1]; ++j)
+        {
+            unsigned int face = def.vertFaceVec[j];
+            if (def.faceMarkVec[face] != def.mark)
+            {
+                def.faceMarkVec[face] = def.mark;
+                def.faceListVec.push_back(face);
+            }
+        }
+    }
+
+    // New normals for those faces, then for their vertices
+    for (unsigned int i = 0; i < def.faceListVec.size(); ++i)
+    {
+        unsigned int face = def.faceListVec[i];
+        FaceNormal(&vertCoordVec[0], &def.faceVertVec[def.faceStartVec[face]],
+                   &def.faceNormalVec[face * 3]);
+        for (unsigned int j = def.faceStartVec[face]; j < def.faceStartVec[face + 1]; ++j)
+        {
+            unsigned int v = def.faceVertVec[j];
+            if (def.vertMarkVec[v] != def.mark)
+            {
+                def.vertMarkVec[v] = def.mark;
+                def.vertListVec.push_back(v);
+            }
+        }
+    }
+    for (unsigned int i = 0; i < def.vertListVec.size(); ++i)
+    {
+        unsigned int v = def.vertListVec[i];
+        ComputeDeformedNormal(v);
+        def.dirtyVec[v] = 1;
+        def.dirtyBlockVec[v >> BLOCK_SHIFT] = 1;
+    }
+
+    // Refit the bounding box from bounds of blocks
+    for (unsigned int i = 0; i < def.refitListVec.size(); ++i)
+    {
+        unsigned int block = def.refitListVec[i];
+        RangeBounds(&vertCoordVec[0], block << BLOCK_SHIFT,
+                    min((block + 1) << BLOCK_SHIFT, numVertices), &def.blockBoundsVec[block * 6]);
+        def.refitVec[block] = 0;
+    }
+    double bounds[6];
+    copy(def.blockBoundsVec.begin(), def.blockBoundsVec.begin() + 6, bounds);
+    for (unsigned int block = 1; (block << BLOCK_SHIFT) < numVertices; ++block)
+    {
+        const double* blockBounds = &def.blockBoundsVec[block * 6];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+        {
+            bounds[axis] = min(bounds[axis], blockBounds[axis]);
+            bounds[axis + 3] = max(bounds[axis + 3], blockBounds[axis + 3]);
+        }
+    }
+    bBox.SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+    bBox.ProcessCenter();
+    ComputeRecursiveBoundingBox();
+    return true;
+}
+
+bool VART::MeshObject::UploadDeformation() const
+{
+#if defined(VART_OGL) && defined(GL_VERSION_1_5)
+    if (!BuffersAvailable() || (normCoordVec.size() != vertCoordVec.size()))
+        return false;
+    Deformation& def = *deformationPtr;
+    unsigned int numVertices = vertCoordVec.size() / 3;
+    size_t coordBytes = vertCoordVec.size() * sizeof(double);
+    if (!def.vertexBuffer)
+        glGenBuffers(1, &def.vertexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, def.vertexBuffer);
+    if (def.bufferVertices != numVertices)
+    {
+        glBufferData(GL_ARRAY_BUFFER, 2 * coordBytes, NULL, GL_DYNAMIC_DRAW);
+        def.bufferVertices = numVertices;
+        def.allDirty = true;
+    }
+    // Send vertices and normals of dirty ranges, joining ranges that are close
+    vector<pair<unsigned int, unsigned int> > rangeVec;
+    GetDirtyRanges(&rangeVec);
+    unsigned int i = 0;
+    while (i < rangeVec.size())
+    {
+        unsigned int start = rangeVec[i].first;
+        unsigned int end = start + rangeVec[i].second;
+        for (++i; (i < rangeVec.size()) && (rangeVec[i].first - end < UPLOAD_GAP); ++i)
+            end = rangeVec[i].first + rangeVec[i].second;
+        size_t offset = start * 3 * sizeof(double);
+        size_t size = (end - start) * 3 * sizeof(double);
+        glBufferSubData(GL_ARRAY_BUFFER, offset, size, &vertCoordVec[start * 3]);
+        glBufferSubData(GL_ARRAY_BUFFER, coordBytes + offset, size, &normCoordVec[start * 3]);
+        FrameStats::current.vertexBytes += 2 * size;
+    }
+    def.ClearDirty(numVertices);
+    glVertexPointer(3, GL_DOUBLE, 0, NULL);
+    glNormalPointer(GL_DOUBLE, 0, reinterpret_cast<const GLvoid*>(coordBytes));
+    return true;
+#else
+    return false;
+#endif
 }
 
 void VART::MeshObject::subDivideBBox( VART::BoundingBox motherBox, int subdivisions, std::vector<VART::Point4D> pointList )
@@ -654,34 +1140,42 @@ void VART::MeshObject::MergeWith(const VART::MeshObject& obj) {
     normVec.insert(normVec.end(), obj.normVec.begin(), obj.normVec.end());
     normCoordVec.insert(normCoordVec.end(), obj.normCoordVec.begin(), obj.normCoordVec.end());
     textCoordVec.insert(textCoordVec.end(), obj.textCoordVec.begin(), obj.textCoordVec.end());
+    DiscardDeformation();
     ComputeBoundingBox();
     ComputeRecursiveBoundingBox();
 }
 
 void VART::MeshObject::ApplyTransform(const VART::Transform& trans) {
-    unsigned int i = 0;
-    unsigned int size;
+    const VART::Matrix4& matrix = trans.GetMatrix();
 
+    // Normals are transformed by the inverse transpose, which keeps them perpendicular to
+    // faces under non uniform scales. A singular transform leaves them untouched.
     if (vertCoordVec.empty())
     {
-        for (size = vertVec.size(); i < size; ++i)
+        if (!vertVec.empty())
+            matrix.ApplyTo(&vertVec[0], vertVec.size());
+        VART::Matrix4 normalMatrix;
+        if (matrix.GetNormalMatrix(&normalMatrix))
         {
-            trans.ApplyTo(&(vertVec[i]));
+            for (unsigned int i = 0; i < normVec.size(); ++i)
+            {
+                normalMatrix.ApplyTo(&normVec[i]);
+                if (normVec[i].Length() > 0)
+                    normVec[i].Normalize();
+            }
         }
+        ComputeBoundingBox();
     }
     else
     {
-        VART::Point4D vertex;
-        for (size = vertCoordVec.size(); i < size; i+=3)
-        {
-            vertex.SetXYZW(vertCoordVec[i],vertCoordVec[i+1],vertCoordVec[i+2],1);
-            trans.ApplyTo(&vertex);
-            vertCoordVec[i] = vertex.GetX();
-            vertCoordVec[i+1] = vertex.GetY();
-            vertCoordVec[i+2] = vertex.GetZ();
-        }
+        double bounds[6];
+        matrix.TransformPoints(&vertCoordVec[0], &vertCoordVec[0], vertCoordVec.size() / 3,
+                               bounds);
+        if (!normCoordVec.empty())
+            matrix.TransformNormals(&normCoordVec[0], &normCoordVec[0], normCoordVec.size() / 3);
+        bBox.SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
     }
-    ComputeBoundingBox();
+    DiscardDeformation();
     ComputeRecursiveBoundingBox();
 }
 
@@ -694,6 +1188,7 @@ void VART::MeshObject::ComputeTriangleNormal(const VART::Point4D& v1, const VART
 }
 
 bool VART::MeshObject::DrawInstanceOGL() const {
+    VART_PROFILE_ZONE("MeshObject::DrawInstanceOGL");
 #ifdef VART_OGL
     bool result = true;
     list<VART::Mesh>::const_iterator iter;
@@ -717,10 +1212,19 @@ bool VART::MeshObject::DrawInstanceOGL() const {
         { // Optimized structure found - draw it!
           // Note that vertex arrays must be enabled to allow drawing of optimized meshes. See
           // VART::ViewerGlutOGL.
-            glVertexPointer(3, GL_DOUBLE, 0, &vertCoordVec[0]);
-            glNormalPointer(GL_DOUBLE, 0, &normCoordVec[0]);
+            // Deformed objects keep vertices and normals in a vertex buffer, where only
+            // changed vertices are sent again.
+            bool buffered = deformationPtr && UploadDeformation();
+            if (!buffered)
+            {
+                glVertexPointer(3, GL_DOUBLE, 0, &vertCoordVec[0]);
+                glNormalPointer(GL_DOUBLE, 0, &normCoordVec[0]);
+                FrameStats::current.vertexBytes += (vertCoordVec.size() + normCoordVec.size())
+                                                   * sizeof(double);
+            }
             if (!textCoordVec.empty())
                 glTexCoordPointer(3, GL_FLOAT, 0, &textCoordVec[0]);
+            FrameStats::current.vertexBytes += textCoordVec.size() * sizeof(float);
             if ((howToShow == LINES_AND_NORMALS) || (howToShow == POINTS_AND_NORMALS))
             { // Draw normals
                 unsigned int numVertices = vertCoordVec.size() / 3;
@@ -744,6 +1248,10 @@ bool VART::MeshObject::DrawInstanceOGL() const {
                 //}
                 result &= iter->DrawInstanceOGL();
             }
+#ifdef GL_VERSION_1_5
+            if (buffered)
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
         }
         else
         { // No optmized structure found - draw vertices from vertVec
@@ -762,6 +1270,10 @@ bool VART::MeshObject::DrawInstanceOGL() const {
                     glVertex4dv(vertVec[iter->indexVec[i]].VetXYZW());
                 }
                 glEnd();
+                ++FrameStats::current.drawCalls[iter->type];
+                FrameStats::current.indices[iter->type] += meshSize;
+                // a normal (3 doubles) and a vertex (4 doubles) per index
+                FrameStats::current.vertexBytes += meshSize * 7 * sizeof(double);
             }
         }
     }
@@ -776,6 +1288,12 @@ bool VART::MeshObject::DrawInstanceOGL() const {
 }
 
 bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject*>* resultPtr)
+{
+    return ReadFromOBJ(filename, resultPtr, true);
+}
+
+bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject*>* resultPtr,
+                                   bool loadTextures)
 // passing garbage on *resultPtr makes the method crash. Remember to clean it before calling.
 
 // Note: Blender saves obj files with multiple objects, reusing normal coordinates (and
@@ -799,7 +1317,6 @@ bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject
     //char trash;
     double x,y,z;
     map<string,VART::Material> materialMap;
-    map<string,VART::Texture> textureMap;
     // vertIndexesMap maps vi/ni/ti triplets to unique array indices
     map<VertexTriplet, unsigned int> vertIndexesMap;
     vector<float> vertCoordTempVec; // cache of previous vertices described in a file
@@ -810,6 +1327,7 @@ bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject
     unsigned int faceCounter = 0; // counts the number of faces in the file
     unsigned int objCounter = 0; // counts the number of objects in the file
     unsigned int lineNumber = 0;
+    unsigned int index = 0; // next vertex index in current object
 
     while (getline(file, line)) {
         iss.clear(); // reset error status
@@ -817,7 +1335,6 @@ bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject
         if(iss.peek() != -1) {
             iss >> lineID;
             ++lineNumber;
-            static unsigned int index = 0;
             if (lineID == "v") { // vertex
                 if (meshObjectPtr == NULL) {
                     ostringstream error;
@@ -938,21 +1455,19 @@ bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject
             iss >> name;
             // make sure the name is in lower case
             transform(name.begin(), name.end(), name.begin(), ::tolower);
-            VART::Texture texture = textureMap[name];
-            if(!texture.HasData()) //Read a texture file not read yet
-            {
-                name = VART::File::GetPathFromString(filename)+name;
-                if(! texture.LoadFromFile(name) )
-                    cerr << "Error reading usemap in '" << VART::File::GetPathFromString(filename) << filename << "', line " << lineNumber <<
-                    ": could not read texture file '" << name << "'" << endl;
-                textureMap[name] = texture;
-            }
+            // Files used many times are read once by the texture cache
+            VART::Texture texture;
+            name = VART::File::GetPathFromString(filename)+name;
+            if (!(loadTextures ? texture.LoadFromFile(name) : texture.RequestFile(name)))
+                cerr << "Error reading usemap in '" << filename << "', line " << lineNumber <<
+                ": could not read texture file '" << name << "'" << endl;
             mesh.material.SetTexture( texture );
         }
         else if (lineID == "mtllib") // material library
         {
             iss >> ws >> name;
-            ReadMaterialTable(VART::File::GetPathFromString(filename)+name, &materialMap);
+            ReadMaterialTable(VART::File::GetPathFromString(filename)+name, &materialMap,
+                              loadTextures);
         }
         else if (lineID == "maplib") //texture mapping library
         {//ignore this line, no maplib implemented yet in V-Art
@@ -978,6 +1493,7 @@ bool VART::MeshObject::ReadFromOBJ(const string& filename, list<VART::MeshObject
             meshObjectPtr = new VART::MeshObject;
             meshObjectPtr->autoDelete = true;
             meshObjectPtr->SetDescription(name);
+            meshObjectPtr->fileName = filename;
             resultPtr->push_back(meshObjectPtr);
             index = 0;
         }
@@ -1034,7 +1550,8 @@ void VART::MeshObject::NormalizeAllNormals()
     }
 }
 
-void VART::MeshObject::ReadMaterialTable(const string& filename, map<string,VART::Material>* matMapPtr)
+void VART::MeshObject::ReadMaterialTable(const string& filename, map<string,VART::Material>* matMapPtr,
+                                         bool loadTextures)
 // Reads a Wavefront material table (.mtl file)
 {
     ifstream file(filename.c_str());
@@ -1045,7 +1562,6 @@ void VART::MeshObject::ReadMaterialTable(const string& filename, map<string,VART
     string textureName;
     VART::Material material;
     VART::Texture texture;
-    std::map<std::string,VART::Texture> textureMap;
     float r,g,b;
     float value;
     unsigned int type;
@@ -1120,17 +1636,13 @@ void VART::MeshObject::ReadMaterialTable(const string& filename, map<string,VART
         else if (lineID == "map_Kd")
         {
             iss >> textureName;
-            texture = textureMap[textureName];
-            if(!texture.HasData())
+            textureName = VART::File::GetPathFromString(filename) + textureName;
+            texture = VART::Texture();
+            if (!(loadTextures ? texture.LoadFromFile(textureName) : texture.RequestFile(textureName)))
             {
-                string path = VART::File::GetPathFromString(filename);
-                if( !texture.LoadFromFile( path+textureName ) )
-                {
-                    cerr << "Error reading map_Kd in '" << filename << "', line "
-                         << lineNumber << ": could not read texture file '"
-                         << path << textureName << "'" << endl;
-                }
-                textureMap[textureName] = texture;
+                cerr << "Error reading map_Kd in '" << filename << "', line "
+                     << lineNumber << ": could not read texture file '"
+                     << textureName << "'" << endl;
             }
             material.SetTexture( texture );
         }
@@ -0,0 +1,594 @@
+/// \file particlesystem.cpp
+/// \brief Implementation file for V-ART class "ParticleSystem".
+/// \version $Revision: 1.1 $
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#ifdef VART_OGL
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#endif
+#include "vart/particlesystem.h"
+#include "vart/framestats.h"
+#include "vart/profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if !defined(VART_NO_SIMD) && defined(__AVX__)
+#define VART_PARTICLESYSTEM_AVX
+#include <immintrin.h>
+#elif !defined(VART_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define VART_PARTICLESYSTEM_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Particles per job: smaller systems are updated by the calling thread alone
+static const unsigned int MIN_PARTICLES_PER_JOB = 4096;
+
+// === Auxiliary functions ===
+
+// Returns a random number in [0, 1) for a key (splitmix64 finalizer)
+static inline double Random(unsigned long long key)
+{
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    key ^= key >> 31;
+    return (key >> 11) * (1.0 / 9007199254740992.0);
+}
+
+class VART::ParticleSystem::RangeJob : public VART::WorkQueue::Job {
+    public:
+        RangeJob(ParticleSystem* systemPtr, bool integrateParticles, unsigned int firstParticle,
+                 unsigned int endParticle, float* boundsPtr)
+            : system(*systemPtr), integrate(integrateParticles), first(firstParticle),
+              end(endParticle), bounds(boundsPtr) {}
+        virtual void Run()
+        {
+            if (integrate)
+                system.Integrate(first, end);
+            else
+                system.Prepare(first, end, bounds);
+            lock_guard<mutex> lock(system.pendingMutex);
+            if (--system.pending == 0)
+                system.finished.notify_all();
+        }
+    private:
+        ParticleSystem& system;
+        bool integrate;
+        unsigned int first;
+        unsigned int end;
+        float* bounds;
+};
+
+// === Member functions ===
+VART::ParticleSystem::ParticleSystem(unsigned int capacity)
+    : numParticles(0), capacity(capacity), emitterRadius(0), cosSpread(1), minSpeed(1),
+      maxSpeed(1), minLife(1), maxLife(1), rate(0), owed(0), numBursting(0), numBorn(0),
+      firstNew(0), elapsed(0), seed(0), drag(0), pointSize(1), perspective(false),
+      additive(false), numThreads(thread::hardware_concurrency()), pending(0)
+{
+    SetDirection(Point4D::Y(), 0);
+    fill(gravity, gravity + 3, 0.0f);
+    fill(startColor, startColor + 4, 1.0f);
+    fill(endColor, endColor + 3, 1.0f);
+    endColor[3] = 0;
+    if (numThreads == 0)
+        numThreads = 1;
+    Allocate();
+}
+
+VART::ParticleSystem::ParticleSystem(const ParticleSystem& system)
+    : pending(0)
+{
+    this->operator=(system);
+}
+
+VART::ParticleSystem& VART::ParticleSystem::operator=(const ParticleSystem& system)
+{
+    this->GraphicObj::operator=(system);
+    for (int i = 0; i < 3; ++i)
+    {
+        positionVecs[i] = system.positionVecs[i];
+        velocityVecs[i] = system.velocityVecs[i];
+    }
+    ageVec = system.ageVec;
+    lifeVec = system.lifeVec;
+    numParticles = system.numParticles;
+    capacity = system.capacity;
+    vertexVec = system.vertexVec;
+    colorVec = system.colorVec;
+    emitterPosition = system.emitterPosition;
+    emitterRadius = system.emitterRadius;
+    copy(system.axis, system.axis + 9, axis);
+    cosSpread = system.cosSpread;
+    minSpeed = system.minSpeed;
+    maxSpeed = system.maxSpeed;
+    minLife = system.minLife;
+    maxLife = system.maxLife;
+    rate = system.rate;
+    owed = system.owed;
+    numBursting = system.numBursting;
+    numBorn = system.numBorn;
+    seed = system.seed;
+    copy(system.gravity, system.gravity + 3, gravity);
+    drag = system.drag;
+    copy(system.startColor, system.startColor + 4, startColor);
+    copy(system.endColor, system.endColor + 4, endColor);
+    pointSize = system.pointSize;
+    perspective = system.perspective;
+    texture = system.texture;
+    additive = system.additive;
+    SetNumThreads(system.numThreads);
+    return *this;
+}
+
+VART::ParticleSystem::~ParticleSystem()
+{
+    workQueue.Stop();
+}
+
+VART::SceneNode* VART::ParticleSystem::Copy()
+{
+    return new ParticleSystem(*this);
+}
+
+void VART::ParticleSystem::Allocate()
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        positionVecs[i].resize(capacity);
+        velocityVecs[i].resize(capacity);
+    }
+    ageVec.resize(capacity);
+    lifeVec.resize(capacity);
+    vertexVec.resize(capacity * 3);
+    colorVec.resize(capacity * 4);
+}
+
+void VART::ParticleSystem::SetCapacity(unsigned int value)
+{
+    capacity = value;
+    numParticles = min(numParticles, capacity);
+    Allocate();
+}
+
+VART::Point4D VART::ParticleSystem::GetPosition(unsigned int index) const
+{
+    return Point4D(positionVecs[0][index], positionVecs[1][index], positionVecs[2][index]);
+}
+
+VART::Point4D VART::ParticleSystem::GetVelocity(unsigned int index) const
+{
+    return Point4D(velocityVecs[0][index], velocityVecs[1][index], velocityVecs[2][index], 0);
+}
+
+void VART::ParticleSystem::Clear()
+{
+    numParticles = 0;
+    numBursting = 0;
+    owed = 0;
+}
+
+void VART::ParticleSystem::SetEmitter(const Point4D& position, double radius)
+{
+    emitterPosition = position;
+    emitterRadius = radius;
+}
+
+void VART::ParticleSystem::SetDirection(const Point4D& direction, double spread)
+{
+    Point4D w(direction.GetX(), direction.GetY(), direction.GetZ(), 0);
+    w.Normalize();
+    // any vector not parallel to the axis gives a perpendicular one
+    Point4D helper = (fabs(w.GetX()) < 0.9) ? Point4D::X() : Point4D::Y();
+    Point4D u = helper.CrossProduct(w);
+    u.Normalize();
+    Point4D v = w.CrossProduct(u);
+    const Point4D* vectors[] = { &w, &u, &v };
+    for (int i = 0; i < 3; ++i)
+    {
+        axis[i * 3] = vectors[i]->GetX();
+        axis[i * 3 + 1] = vectors[i]->GetY();
+        axis[i * 3 + 2] = vectors[i]->GetZ();
+    }
+    cosSpread = cos(spread);
+}
+
+void VART::ParticleSystem::SetSpeed(double minSpeed, double maxSpeed)
+{
+    this->minSpeed = minSpeed;
+    this->maxSpeed = maxSpeed;
+}
+
+void VART::ParticleSystem::SetLife(double minLife, double maxLife)
+{
+    this->minLife = minLife;
+    this->maxLife = maxLife;
+}
+
+void VART::ParticleSystem::SetGravity(const Point4D& acceleration)
+{
+    gravity[0] = static_cast<float>(acceleration.GetX());
+    gravity[1] = static_cast<float>(acceleration.GetY());
+    gravity[2] = static_cast<float>(acceleration.GetZ());
+}
+
+void VART::ParticleSystem::SetColors(const Color& start, const Color& end)
+{
+    start.Get(startColor);
+    end.Get(endColor);
+}
+
+void VART::ParticleSystem::SetPointSize(float size, bool perspective)
+{
+    pointSize = size;
+    this->perspective = perspective;
+}
+
+void VART::ParticleSystem::SetNumThreads(unsigned int value)
+{
+    numThreads = (value > 0) ? value : 1;
+    workQueue.SetNumThreads(numThreads);
+}
+
+void VART::ParticleSystem::Update(double seconds)
+{
+    VART_PROFILE_ZONE("ParticleSystem::Update");
+    elapsed = static_cast<float>(seconds);
+    if (numParticles > 0)
+    {
+        RunRanges(true, numParticles);
+        Compact();
+    }
+    owed += rate * seconds;
+    unsigned int count = static_cast<unsigned int>(owed);
+    owed -= count;
+    count = min(count + numBursting, capacity - numParticles);
+    numBursting = 0;
+    firstNew = numParticles;
+    numParticles += count;
+    if (numParticles == 0)
+    {
+        bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+    RunRanges(false, numParticles);
+    numBorn += count;
+    // bounds of ranges
+    float bounds[6];
+    copy(&rangeBoundsVec[0], &rangeBoundsVec[6], bounds);
+    for (unsigned int range = 6; range < rangeBoundsVec.size(); range += 6)
+        for (int i = 0; i < 3; ++i)
+        {
+            bounds[i] = min(bounds[i], rangeBoundsVec[range + i]);
+            bounds[i + 3] = max(bounds[i + 3], rangeBoundsVec[range + i + 3]);
+        }
+    bBox.SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+}
+
+void VART::ParticleSystem::RunRanges(bool integrate, unsigned int end)
+{
+    unsigned int numJobs = max(1u, min(numThreads, end / MIN_PARTICLES_PER_JOB));
+    rangeBoundsVec.resize(numJobs * 6);
+    if (numJobs == 1)
+    {
+        if (integrate)
+            Integrate(0, end);
+        else
+            Prepare(0, end, &rangeBoundsVec[0]);
+        return;
+    }
+    pending = numJobs - 1;
+    // The calling thread takes the first range
+    for (unsigned int job = 1; job < numJobs; ++job)
+        workQueue.Add(new RangeJob(this, integrate,
+                                   static_cast<unsigned int>(
+                                       static_cast<unsigned long long>(end) * job / numJobs),
+                                   static_cast<unsigned int>(
+                                       static_cast<unsigned long long>(end) * (job + 1)
+                                       / numJobs),
+                                   &rangeBoundsVec[job * 6]));
+    if (integrate)
+        Integrate(0, end / numJobs);
+    else
+        Prepare(0, end / numJobs, &rangeBoundsVec[0]);
+    unique_lock<mutex> lock(pendingMutex);
+    while (pending > 0)
+        finished.wait(lock);
+}
+
+void VART::ParticleSystem::Integrate(unsigned int first, unsigned int end)
+{
+    float step = elapsed;
+    float damping = max(0.0f, 1 - drag * step);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float* position = &positionVecs[axis][0];
+        float* velocity = &velocityVecs[axis][0];
+        float deltaV = gravity[axis] * step;
+        unsigned int i = first;
+#if defined(VART_PARTICLESYSTEM_AVX)
+        __m256 deltaV8 = _mm256_set1_ps(deltaV);
+        __m256 damping8 = _mm256_set1_ps(damping);
+        __m256 step8 = _mm256_set1_ps(step);
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 v = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(velocity + i), deltaV8),
+                                     damping8);
+            _mm256_storeu_ps(velocity + i, v);
+            _mm256_storeu_ps(position + i,
+                             _mm256_add_ps(_mm256_loadu_ps(position + i), _mm256_mul_ps(v, step8)));
+        }
+#elif defined(VART_PARTICLESYSTEM_SSE2)
+        __m128 deltaV4 = _mm_set1_ps(deltaV);
+        __m128 damping4 = _mm_set1_ps(damping);
+        __m128 step4 = _mm_set1_ps(step);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 v = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(velocity + i), deltaV4), damping4);
+            _mm_storeu_ps(velocity + i, v);
+            _mm_storeu_ps(position + i,
+                          _mm_add_ps(_mm_loadu_ps(position + i), _mm_mul_ps(v, step4)));
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            velocity[i] = (velocity[i] + deltaV) * damping;
+            position[i] += velocity[i] * step;
+        }
+    }
+    float* age = &ageVec[0];
+    unsigned int i = first;
+#if defined(VART_PARTICLESYSTEM_AVX)
+    __m256 step8 = _mm256_set1_ps(step);
+    for (; i + 8 <= end; i += 8)
+        _mm256_storeu_ps(age + i, _mm256_add_ps(_mm256_loadu_ps(age + i), step8));
+#elif defined(VART_PARTICLESYSTEM_SSE2)
+    __m128 step4 = _mm_set1_ps(step);
+    for (; i + 4 <= end; i += 4)
+        _mm_storeu_ps(age + i, _mm_add_ps(_mm_loadu_ps(age + i), step4));
+#endif
+    for (; i < end; ++i)
+        age[i] += step;
+}
+
+void VART::ParticleSystem::Compact()
+{
+    const float* age = &ageVec[0];
+    const float* life = &lifeVec[0];
+    unsigned int i = 0;
+    while (i < numParticles)
+    {
+        // skip blocks of living particles
+#if defined(VART_PARTICLESYSTEM_AVX)
+        if ((i + 8 <= numParticles) &&
+            !_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(age + i),
+                                              _mm256_loadu_ps(life + i), _CMP_GE_OQ)))
+        {
+            i += 8;
+            continue;
+        }
+#elif defined(VART_PARTICLESYSTEM_SSE2)
+        if ((i + 4 <= numParticles) &&
+            !_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(age + i), _mm_loadu_ps(life + i))))
+        {
+            i += 4;
+            continue;
+        }
+#endif
+        if (age[i] < life[i])
+        {
+            ++i;
+            continue;
+        }
+        --numParticles;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            positionVecs[axis][i] = positionVecs[axis][numParticles];
+            velocityVecs[axis][i] = velocityVecs[axis][numParticles];
+        }
+        ageVec[i] = ageVec[numParticles];
+        lifeVec[i] = lifeVec[numParticles];
+    }
+}
+
+void VART::ParticleSystem::Prepare(unsigned int first, unsigned int end, float* bounds)
+{
+    const double TWO_PI = 6.283185307179586;
+    unsigned long long seedKey = static_cast<unsigned long long>(seed) << 40;
+    // Births: eight random numbers for each particle
+    for (unsigned int particle = max(first, firstNew); particle < end; ++particle)
+    {
+        unsigned long long key = seedKey ^ ((numBorn + particle - firstNew) * 8);
+        // a point of the emitter ball: a direction and a distance from the center
+        double z = 1 - 2 * Random(key);
+        double angle = TWO_PI * Random(key + 1);
+        double side = sqrt(max(0.0, 1 - z * z));
+        double distance = emitterRadius * cbrt(Random(key + 2));
+        double offset[3] = { side * cos(angle) * distance, side * sin(angle) * distance,
+                             z * distance };
+        // a direction in the cone, turned around its axis
+        double cosTilt = 1 - Random(key + 3) * (1 - cosSpread);
+        double sinTilt = sqrt(max(0.0, 1 - cosTilt * cosTilt));
+        double turn = TWO_PI * Random(key + 4);
+        double across[2] = { sinTilt * cos(turn), sinTilt * sin(turn) };
+        double speed = minSpeed + (maxSpeed - minSpeed) * Random(key + 5);
+        double life = minLife + (maxLife - minLife) * Random(key + 6);
+        // born at some moment of the update: it has already moved since then
+        double age = elapsed * Random(key + 7);
+        const double center[3] = { emitterPosition.GetX(), emitterPosition.GetY(),
+                                   emitterPosition.GetZ() };
+        for (int i = 0; i < 3; ++i)
+        {
+            double velocity = speed * (axis[i] * cosTilt + axis[i + 3] * across[0]
+                                       + axis[i + 6] * across[1]);
+            velocityVecs[i][particle] = static_cast<float>(velocity);
+            positionVecs[i][particle] = static_cast<float>(center[i] + offset[i]
+                                                           + velocity * age);
+        }
+        ageVec[particle] = static_cast<float>(age);
+        lifeVec[particle] = static_cast<float>(life);
+    }
+    // Vertices and colors, kept in local variables: stores of bytes could change anything
+    float low[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float high[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    float start[4];
+    float change[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        start[i] = startColor[i] * 255 + 0.5f;
+        change[i] = (endColor[i] - startColor[i]) * 255;
+    }
+    const float* x = &positionVecs[0][0];
+    const float* y = &positionVecs[1][0];
+    const float* z = &positionVecs[2][0];
+    const float* age = &ageVec[0];
+    const float* life = &lifeVec[0];
+    float* vertex = &vertexVec[0];
+    unsigned char* color = &colorVec[0];
+    unsigned int particle = first;
+#if defined(VART_PARTICLESYSTEM_AVX) || defined(VART_PARTICLESYSTEM_SSE2)
+    // Four particles at a time: coordinates and colors are transposed from arrays of
+    // particles into vertices and RGBA bytes.
+    __m128 low4[3];
+    __m128 high4[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        low4[i] = _mm_set1_ps(FLT_MAX);
+        high4[i] = _mm_set1_ps(-FLT_MAX);
+    }
+    __m128 one4 = _mm_set1_ps(1);
+    for (; particle + 4 <= end; particle += 4)
+    {
+        __m128 rows[4] = { _mm_loadu_ps(x + particle), _mm_loadu_ps(y + particle),
+                           _mm_loadu_ps(z + particle), _mm_setzero_ps() };
+        for (int i = 0; i < 3; ++i)
+        {
+            low4[i] = _mm_min_ps(low4[i], rows[i]);
+            high4[i] = _mm_max_ps(high4[i], rows[i]);
+        }
+        _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+        // the last vertex must not write past its Z: the next one may be another range's
+        float* vertexPtr = vertex + particle * 3;
+        _mm_storeu_ps(vertexPtr, rows[0]);
+        _mm_storeu_ps(vertexPtr + 3, rows[1]);
+        _mm_storeu_ps(vertexPtr + 6, rows[2]);
+        _mm_storel_pi(reinterpret_cast<__m64*>(vertexPtr + 9), rows[3]);
+        _mm_store_ss(vertexPtr + 11, _mm_movehl_ps(rows[3], rows[3]));
+        __m128 t = _mm_min_ps(_mm_div_ps(_mm_loadu_ps(age + particle),
+                                         _mm_loadu_ps(life + particle)), one4);
+        __m128 channels[4];
+        for (int i = 0; i < 4; ++i)
+            channels[i] = _mm_add_ps(_mm_set1_ps(start[i]),
+                                     _mm_mul_ps(_mm_set1_ps(change[i]), t));
+        _MM_TRANSPOSE4_PS(channels[0], channels[1], channels[2], channels[3]);
+        __m128i firstHalf = _mm_packs_epi32(_mm_cvttps_epi32(channels[0]),
+                                            _mm_cvttps_epi32(channels[1]));
+        __m128i secondHalf = _mm_packs_epi32(_mm_cvttps_epi32(channels[2]),
+                                             _mm_cvttps_epi32(channels[3]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(color + particle * 4),
+                         _mm_packus_epi16(firstHalf, secondHalf));
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        float lanes[4];
+        _mm_storeu_ps(lanes, low4[i]);
+        low[i] = *min_element(lanes, lanes + 4);
+        _mm_storeu_ps(lanes, high4[i]);
+        high[i] = *max_element(lanes, lanes + 4);
+    }
+#endif
+    for (; particle < end; ++particle)
+    {
+        float coordinates[3] = { x[particle], y[particle], z[particle] };
+        for (int i = 0; i < 3; ++i)
+        {
+            vertex[particle * 3 + i] = coordinates[i];
+            low[i] = min(low[i], coordinates[i]);
+            high[i] = max(high[i], coordinates[i]);
+        }
+        float t = min(age[particle] / life[particle], 1.0f);
+        for (int i = 0; i < 4; ++i)
+            color[particle * 4 + i] = static_cast<unsigned char>(start[i] + change[i] * t);
+    }
+    copy(low, low + 3, bounds);
+    copy(high, high + 3, bounds + 3);
+}
+
+void VART::ParticleSystem::ComputeBoundingBox()
+{
+    if (numParticles == 0)
+    {
+        bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+    float bounds[6];
+    for (int i = 0; i < 3; ++i)
+    {
+        bounds[i] = *min_element(&positionVecs[i][0], &positionVecs[i][0] + numParticles);
+        bounds[i + 3] = *max_element(&positionVecs[i][0], &positionVecs[i][0] + numParticles);
+    }
+    bBox.SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+}
+
+bool VART::ParticleSystem::DrawInstanceOGL() const
+{
+#ifdef VART_OGL
+    if (show && (numParticles > 0))
+    {
+        // Binds the texture or disables texturing, before saving state: textures keep
+        // track of whether texturing is enabled.
+        texture.DrawOGL();
+        glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_POINT_BIT
+                     | GL_TEXTURE_BIT);
+        glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+        glDisable(GL_LIGHTING);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, additive ? GL_ONE : GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+        glPointSize(pointSize);
+#ifdef GL_VERSION_1_4
+        const GLfloat perspectiveAttenuation[] = { 0, 0, 1 };
+        const GLfloat noAttenuation[] = { 1, 0, 0 };
+        if (perspective)
+            glPointParameterfv(GL_POINT_DISTANCE_ATTENUATION, perspectiveAttenuation);
+#endif
+#ifdef GL_VERSION_2_0
+        if (texture.HasData())
+        {
+            glEnable(GL_POINT_SPRITE);
+            glTexEnvi(GL_POINT_SPRITE, GL_COORD_REPLACE, GL_TRUE);
+            glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        }
+#endif
+        glDisableClientState(GL_NORMAL_ARRAY);
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(3, GL_FLOAT, 0, &vertexVec[0]);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colorVec[0]);
+        glDrawArrays(GL_POINTS, 0, numParticles);
+        ++FrameStats::current.drawCalls[Mesh::POINTS];
+        FrameStats::current.indices[Mesh::POINTS] += numParticles;
+        FrameStats::current.vertexBytes += numParticles * (3 * sizeof(float) + 4);
+#ifdef GL_VERSION_1_4
+        if (perspective)
+            glPointParameterfv(GL_POINT_DISTANCE_ATTENUATION, noAttenuation);
+#endif
+        glPopClientAttrib();
+        glPopAttrib();
+    }
+    if (bBox.visible)
+        bBox.DrawInstanceOGL();
+    if (recBBox.visible)
+        recBBox.DrawInstanceOGL();
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,727 @@
+/// \file terrain.cpp
+/// \brief Implementation file for V-ART class "Terrain".
+/// \version $Revision: 1.1 $
+
+#include "vart/terrain.h"
+#include "vart/framestats.h"
+#include "vart/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#ifdef VART_OGL
+#include <GL/gl.h>
+#endif
+
+using namespace std;
+
+// Floats per vertex: coordinates, then normal
+static const unsigned int VERTEX_SIZE = 6;
+
+class VART::Terrain::LoadJob : public VART::WorkQueue::Job {
+    public:
+        LoadJob(Terrain* terrainPtr, TileSource* sourcePtr, unsigned int x, unsigned int z,
+                unsigned int s, unsigned int g)
+            : terrain(*terrainPtr), source(sourcePtr), tileX(x), tileZ(z), size(s),
+              generation(g) {}
+        virtual void Run()
+        {
+            VART_PROFILE_ZONE("Terrain::Load");
+            terrain.Load(source, tileX, tileZ, size, generation);
+        }
+    private:
+        Terrain& terrain;
+        TileSource* source;
+        unsigned int tileX;
+        unsigned int tileZ;
+        unsigned int size;
+        unsigned int generation;
+};
+
+VART::Terrain::Terrain()
+    : numCellsX(0), numCellsZ(0), spacing(1), chunkSize(1), numTilesX(0), numTilesZ(0),
+      lodDistance(100), streamingDistance(1000), rangeMin(0), rangeMax(0),
+      tileSourcePtr(NULL), numChunksDrawn(0), generation(0)
+{
+    bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+}
+
+VART::Terrain::Terrain(unsigned int cellsX, unsigned int cellsZ, double newSpacing,
+                       unsigned int newChunkSize)
+    : numCellsX(0), numCellsZ(0), spacing(1), chunkSize(1), numTilesX(0), numTilesZ(0),
+      lodDistance(100), streamingDistance(1000), rangeMin(0), rangeMax(0),
+      tileSourcePtr(NULL), numChunksDrawn(0), generation(0)
+{
+    bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+    SetSize(cellsX, cellsZ, newSpacing, newChunkSize);
+}
+
+VART::Terrain::Terrain(const Terrain& terrain)
+    : tileSourcePtr(NULL), generation(0)
+{
+    this->operator=(terrain);
+}
+
+VART::Terrain::~Terrain()
+{
+    // Jobs refer to the terrain
+    workQueue.Stop();
+}
+
+VART::Terrain& VART::Terrain::operator=(const Terrain& terrain)
+{
+    this->GraphicObj::operator=(terrain);
+    numCellsX = terrain.numCellsX;
+    numCellsZ = terrain.numCellsZ;
+    spacing = terrain.spacing;
+    chunkSize = terrain.chunkSize;
+    numTilesX = terrain.numTilesX;
+    numTilesZ = terrain.numTilesZ;
+    tileVec.resize(terrain.tileVec.size());
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+    {
+        const Tile& source = terrain.tileVec[t];
+        Tile& tile = tileVec[t];
+        tile.heightVec = source.heightVec;
+        tile.state = (source.state == Tile::LOADING) ? Tile::UNLOADED : source.state;
+        tile.vertexVec.clear();
+        tile.minHeight = source.minHeight;
+        tile.maxHeight = source.maxHeight;
+    }
+    indexVecs = terrain.indexVecs;
+    material = terrain.material;
+    lodDistance = terrain.lodDistance;
+    streamingDistance = terrain.streamingDistance;
+    rangeMin = terrain.rangeMin;
+    rangeMax = terrain.rangeMax;
+    // Tiles requested before are of no use to this terrain
+    ++generation;
+    tileSourcePtr = NULL;
+    eye = terrain.eye;
+    numChunksDrawn = 0;
+    return *this;
+}
+
+VART::SceneNode* VART::Terrain::Copy()
+{
+    return new Terrain(*this);
+}
+
+bool VART::Terrain::SetSize(unsigned int cellsX, unsigned int cellsZ, double newSpacing,
+                            unsigned int newChunkSize)
+{
+    if ((newChunkSize == 0) || (newChunkSize > 128) || (newChunkSize & (newChunkSize - 1)))
+    {
+        cerr << "Error: Terrain::SetSize: chunk size " << newChunkSize
+             << " is not a power of two up to 128.\n";
+        return false;
+    }
+    if ((cellsX == 0) || (cellsZ == 0) || (cellsX % newChunkSize) || (cellsZ % newChunkSize))
+    {
+        cerr << "Error: Terrain::SetSize: " << cellsX << "x" << cellsZ
+             << " cells cannot be split into chunks of " << newChunkSize << ".\n";
+        return false;
+    }
+    if (newSpacing <= 0)
+    {
+        cerr << "Error: Terrain::SetSize: spacing must be positive.\n";
+        return false;
+    }
+    numCellsX = cellsX;
+    numCellsZ = cellsZ;
+    spacing = newSpacing;
+    chunkSize = newChunkSize;
+    numTilesX = cellsX / newChunkSize;
+    numTilesZ = cellsZ / newChunkSize;
+    ++generation;
+    vector<Tile>().swap(tileVec);
+    tileVec.resize(numTilesX * numTilesZ);
+    unsigned int tileSamples = (chunkSize + 1) * (chunkSize + 1);
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+    {
+        Tile& tile = tileVec[t];
+        if (tileSourcePtr)
+        {
+            tile.state = Tile::UNLOADED;
+            tile.minHeight = rangeMin;
+            tile.maxHeight = rangeMax;
+        }
+        else
+            tile.heightVec.assign(tileSamples, 0.0f);
+    }
+    MakeIndices();
+    ComputeBoundingBox();
+    return true;
+}
+
+void VART::Terrain::MakeIndices()
+{
+    indexVecs.clear();
+    for (unsigned int step = 1; step <= chunkSize; step *= 2)
+    {
+        unsigned int n = chunkSize / step + 1; // vertices along a side
+        indexVecs.push_back(vector<unsigned short>());
+        vector<unsigned short>& indexVec = indexVecs.back();
+        indexVec.reserve((n - 1) * (n - 1) * 6);
+        // Two triangles per cell, split along the diagonal from (i+1, j) to (i, j+1), both
+        // counterclockwise when seen from above
+        for (unsigned int b = 0; b + 1 < n; ++b)
+            for (unsigned int a = 0; a + 1 < n; ++a)
+            {
+                unsigned short v00 = static_cast<unsigned short>(b * n + a);
+                unsigned short v10 = v00 + 1;
+                unsigned short v01 = static_cast<unsigned short>(v00 + n);
+                unsigned short v11 = v01 + 1;
+                indexVec.push_back(v00);
+                indexVec.push_back(v01);
+                indexVec.push_back(v10);
+                indexVec.push_back(v10);
+                indexVec.push_back(v01);
+                indexVec.push_back(v11);
+            }
+    }
+}
+
+void VART::Terrain::SetHeight(unsigned int i, unsigned int j, float height)
+{
+    // Border samples are in up to four tiles; vertex data of tiles next to the sample also
+    // change, because of normals.
+    unsigned int firstX = (i > 0) ? (i - 1) / chunkSize : 0;
+    unsigned int lastX = min((i + 1) / chunkSize, numTilesX - 1);
+    unsigned int firstZ = (j > 0) ? (j - 1) / chunkSize : 0;
+    unsigned int lastZ = min((j + 1) / chunkSize, numTilesZ - 1);
+    for (unsigned int tileZ = firstZ; tileZ <= lastZ; ++tileZ)
+        for (unsigned int tileX = firstX; tileX <= lastX; ++tileX)
+        {
+            Tile& tile = tileVec[tileZ * numTilesX + tileX];
+            tile.vertexVec.clear();
+            int localI = static_cast<int>(i) - static_cast<int>(tileX * chunkSize);
+            int localJ = static_cast<int>(j) - static_cast<int>(tileZ * chunkSize);
+            if ((tile.state != Tile::LOADED) || (localI < 0) || (localJ < 0)
+                || (localI > static_cast<int>(chunkSize))
+                || (localJ > static_cast<int>(chunkSize)))
+                continue;
+            tile.heightVec[localJ * (chunkSize + 1) + localI] = height;
+            tile.minHeight = min(tile.minHeight, height);
+            tile.maxHeight = max(tile.maxHeight, height);
+        }
+}
+
+float VART::Terrain::GetHeight(unsigned int i, unsigned int j) const
+{
+    unsigned int tileX = min(i / chunkSize, numTilesX - 1);
+    unsigned int tileZ = min(j / chunkSize, numTilesZ - 1);
+    const Tile& tile = tileVec[tileZ * numTilesX + tileX];
+    if (tile.state != Tile::LOADED)
+        return 0;
+    return tile.heightVec[(j - tileZ * chunkSize) * (chunkSize + 1) + i - tileX * chunkSize];
+}
+
+double VART::Terrain::GetHeightAt(double x, double z) const
+{
+    if (tileVec.empty())
+        return 0;
+    double cellX = min(max(x / spacing, 0.0), static_cast<double>(numCellsX));
+    double cellZ = min(max(z / spacing, 0.0), static_cast<double>(numCellsZ));
+    unsigned int i = min(static_cast<unsigned int>(cellX), numCellsX - 1);
+    unsigned int j = min(static_cast<unsigned int>(cellZ), numCellsZ - 1);
+    double u = cellX - i;
+    double v = cellZ - j;
+    // Interpolate on the triangle of the cell that contains the point (see MakeIndices)
+    if (u + v <= 1)
+    {
+        double h00 = GetHeight(i, j);
+        return h00 + u * (GetHeight(i + 1, j) - h00) + v * (GetHeight(i, j + 1) - h00);
+    }
+    double h11 = GetHeight(i + 1, j + 1);
+    return h11 + (1 - u) * (GetHeight(i, j + 1) - h11) + (1 - v) * (GetHeight(i + 1, j) - h11);
+}
+
+VART::Point4D VART::Terrain::GetNormalAt(double x, double z) const
+{
+    if (tileVec.empty())
+        return Point4D::Y();
+    double cellX = min(max(x / spacing, 0.0), static_cast<double>(numCellsX));
+    double cellZ = min(max(z / spacing, 0.0), static_cast<double>(numCellsZ));
+    unsigned int i = min(static_cast<unsigned int>(cellX), numCellsX - 1);
+    unsigned int j = min(static_cast<unsigned int>(cellZ), numCellsZ - 1);
+    double u = cellX - i;
+    double v = cellZ - j;
+    // Bilinear interpolation of the normals at the corners of the cell
+    double weights[4] = { (1 - u) * (1 - v), u * (1 - v), (1 - u) * v, u * v };
+    double sum[3] = { 0, 0, 0 };
+    for (unsigned int corner = 0; corner < 4; ++corner)
+    {
+        unsigned int sampleI = i + (corner & 1);
+        unsigned int sampleJ = j + (corner >> 1);
+        unsigned int tileX = min(sampleI / chunkSize, numTilesX - 1);
+        unsigned int tileZ = min(sampleJ / chunkSize, numTilesZ - 1);
+        const Tile& tile = tileVec[tileZ * numTilesX + tileX];
+        float normal[3] = { 0, 1, 0 };
+        if (tile.state == Tile::LOADED)
+            SampleNormal(tile, tileX, tileZ, sampleI - tileX * chunkSize,
+                         sampleJ - tileZ * chunkSize, normal);
+        for (unsigned int axis = 0; axis < 3; ++axis)
+            sum[axis] += weights[corner] * normal[axis];
+    }
+    Point4D result(sum[0], sum[1], sum[2], 0);
+    result.Normalize();
+    return result;
+}
+
+bool VART::Terrain::Sample(const Tile& tile, unsigned int tileX, unsigned int tileZ,
+                           int i, int j, float* heightPtr) const
+{
+    int size = static_cast<int>(chunkSize);
+    if ((i >= 0) && (i <= size) && (j >= 0) && (j <= size))
+    {
+        if (tile.state != Tile::LOADED)
+            return false;
+        *heightPtr = tile.heightVec[j * (size + 1) + i];
+        return true;
+    }
+    // In a neighbour tile
+    int neighbourX = static_cast<int>(tileX) + ((i < 0) ? -1 : ((i > size) ? 1 : 0));
+    int neighbourZ = static_cast<int>(tileZ) + ((j < 0) ? -1 : ((j > size) ? 1 : 0));
+    if ((neighbourX < 0) || (neighbourX >= static_cast<int>(numTilesX))
+        || (neighbourZ < 0) || (neighbourZ >= static_cast<int>(numTilesZ)))
+        return false;
+    const Tile& neighbour = tileVec[neighbourZ * numTilesX + neighbourX];
+    if (neighbour.state != Tile::LOADED)
+        return false;
+    i -= (neighbourX - static_cast<int>(tileX)) * size;
+    j -= (neighbourZ - static_cast<int>(tileZ)) * size;
+    *heightPtr = neighbour.heightVec[j * (size + 1) + i];
+    return true;
+}
+
+void VART::Terrain::SampleNormal(const Tile& tile, unsigned int tileX, unsigned int tileZ,
+                                 int i, int j, float* normal) const
+{
+    // Central differences, or one sided ones at borders of the grid (or of loaded tiles)
+    float center = tile.heightVec[j * (chunkSize + 1) + i];
+    float before;
+    float after;
+    int span = 2;
+    if (!Sample(tile, tileX, tileZ, i - 1, j, &before))
+    {
+        before = center;
+        --span;
+    }
+    if (!Sample(tile, tileX, tileZ, i + 1, j, &after))
+    {
+        after = center;
+        --span;
+    }
+    float slopeX = (span > 0) ? (after - before) / static_cast<float>(span * spacing) : 0;
+    span = 2;
+    if (!Sample(tile, tileX, tileZ, i, j - 1, &before))
+    {
+        before = center;
+        --span;
+    }
+    if (!Sample(tile, tileX, tileZ, i, j + 1, &after))
+    {
+        after = center;
+        --span;
+    }
+    float slopeZ = (span > 0) ? (after - before) / static_cast<float>(span * spacing) : 0;
+    float length = sqrt(slopeX * slopeX + 1 + slopeZ * slopeZ);
+    normal[0] = -slopeX / length;
+    normal[1] = 1 / length;
+    normal[2] = -slopeZ / length;
+}
+
+double VART::Terrain::TileDistance(unsigned int tileX, unsigned int tileZ) const
+{
+    const Tile& tile = tileVec[tileZ * numTilesX + tileX];
+    double dy = max(max(tile.minHeight - eye.GetY(), eye.GetY() - tile.maxHeight), 0.0);
+    double dXZ = TileDistanceXZ(tileX, tileZ);
+    return sqrt(dXZ * dXZ + dy * dy);
+}
+
+double VART::Terrain::TileDistanceXZ(unsigned int tileX, unsigned int tileZ) const
+{
+    double extent = chunkSize * spacing;
+    double minX = tileX * extent;
+    double minZ = tileZ * extent;
+    double dx = max(max(minX - eye.GetX(), eye.GetX() - minX - extent), 0.0);
+    double dz = max(max(minZ - eye.GetZ(), eye.GetZ() - minZ - extent), 0.0);
+    return sqrt(dx * dx + dz * dz);
+}
+
+unsigned int VART::Terrain::ChunkLevel(unsigned int tileX, unsigned int tileZ) const
+{
+    double distance = TileDistance(tileX, tileZ);
+    if (distance <= lodDistance)
+        return 0;
+    unsigned int level = static_cast<unsigned int>(log2(distance / lodDistance)) + 1;
+    return min(level, static_cast<unsigned int>(indexVecs.size() - 1));
+}
+
+void VART::Terrain::MakeVertices(Tile* tilePtr, unsigned int tileX, unsigned int tileZ) const
+{
+    Tile& tile = *tilePtr;
+    int step = 1 << tile.level;
+    int size = static_cast<int>(chunkSize);
+    int n = size / step + 1;
+    tile.vertexVec.resize(n * n * VERTEX_SIZE);
+    float* vertex = &tile.vertexVec[0];
+    double originX = tileX * chunkSize * spacing;
+    double originZ = tileZ * chunkSize * spacing;
+    for (int b = 0; b < n; ++b)
+        for (int a = 0; a < n; ++a)
+        {
+            int i = a * step;
+            int j = b * step;
+            float height = tile.heightVec[j * (size + 1) + i];
+            float* normal = vertex + 3;
+            SampleNormal(tile, tileX, tileZ, i, j, normal);
+            // Border vertices next to a coarser chunk are placed on its edge, between the
+            // vertices it has there (corners are vertices at every level)
+            int edge = -1;
+            if (a == 0)
+                edge = 0;
+            else if (a == n - 1)
+                edge = 1;
+            else if (b == 0)
+                edge = 2;
+            else if (b == n - 1)
+                edge = 3;
+            if ((edge >= 0) && (tile.neighbourLevels[edge] > tile.level))
+            {
+                int coarseStep = 1 << tile.neighbourLevels[edge];
+                int along = (edge < 2) ? j : i;
+                int offset = along % coarseStep;
+                if (offset)
+                {
+                    int i0 = (edge < 2) ? i : i - offset;
+                    int j0 = (edge < 2) ? j - offset : j;
+                    int i1 = (edge < 2) ? i : i0 + coarseStep;
+                    int j1 = (edge < 2) ? j0 + coarseStep : j;
+                    float t = static_cast<float>(offset) / coarseStep;
+                    float h0 = tile.heightVec[j0 * (size + 1) + i0];
+                    float h1 = tile.heightVec[j1 * (size + 1) + i1];
+                    height = h0 + t * (h1 - h0);
+                    float n0[3];
+                    float n1[3];
+                    SampleNormal(tile, tileX, tileZ, i0, j0, n0);
+                    SampleNormal(tile, tileX, tileZ, i1, j1, n1);
+                    float length = 0;
+                    for (unsigned int axis = 0; axis < 3; ++axis)
+                    {
+                        normal[axis] = n0[axis] + t * (n1[axis] - n0[axis]);
+                        length += normal[axis] * normal[axis];
+                    }
+                    length = sqrt(length);
+                    for (unsigned int axis = 0; axis < 3; ++axis)
+                        normal[axis] /= length;
+                }
+            }
+            vertex[0] = static_cast<float>(originX + i * spacing);
+            vertex[1] = height;
+            vertex[2] = static_cast<float>(originZ + j * spacing);
+            vertex += VERTEX_SIZE;
+        }
+}
+
+void VART::Terrain::SetTileSource(TileSource* sourcePtr)
+{
+    tileSourcePtr = sourcePtr;
+    ++generation;
+    {
+        lock_guard<mutex> lock(loadedMutex);
+        loadedList.clear();
+    }
+    unsigned int tileSamples = (chunkSize + 1) * (chunkSize + 1);
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+    {
+        Tile& tile = tileVec[t];
+        vector<float>().swap(tile.vertexVec);
+        if (sourcePtr)
+        {
+            vector<float>().swap(tile.heightVec);
+            tile.state = Tile::UNLOADED;
+            tile.minHeight = rangeMin;
+            tile.maxHeight = rangeMax;
+        }
+        else
+        {
+            tile.heightVec.assign(tileSamples, 0.0f);
+            tile.state = Tile::LOADED;
+            tile.minHeight = 0;
+            tile.maxHeight = 0;
+        }
+    }
+    ComputeBoundingBox();
+}
+
+void VART::Terrain::SetHeightRange(float minHeight, float maxHeight)
+{
+    rangeMin = minHeight;
+    rangeMax = maxHeight;
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+        if (tileVec[t].state != Tile::LOADED)
+        {
+            tileVec[t].minHeight = minHeight;
+            tileVec[t].maxHeight = maxHeight;
+        }
+}
+
+void VART::Terrain::Load(TileSource* sourcePtr, unsigned int tileX, unsigned int tileZ,
+                         unsigned int size, unsigned int requestGeneration)
+{
+    list<LoadedTile> loaded(1);
+    LoadedTile& tile = loaded.front();
+    tile.tileX = tileX;
+    tile.tileZ = tileZ;
+    tile.generation = requestGeneration;
+    tile.heightVec.resize(size * size);
+    tile.failed = !sourcePtr->LoadTile(tileX, tileZ, size, &tile.heightVec[0]);
+    lock_guard<mutex> lock(loadedMutex);
+    loadedList.splice(loadedList.end(), loaded);
+}
+
+void VART::Terrain::Update()
+{
+    if (!tileSourcePtr)
+        return;
+    list<LoadedTile> loaded;
+    {
+        lock_guard<mutex> lock(loadedMutex);
+        loaded.swap(loadedList);
+    }
+    bool changed = false;
+    // Put loaded tiles in place; they change normals at borders of their neighbours
+    list<LoadedTile>::iterator iter = loaded.begin();
+    for (; iter != loaded.end(); ++iter)
+    {
+        if (iter->generation != generation)
+            continue;
+        unsigned int tileX = iter->tileX;
+        unsigned int tileZ = iter->tileZ;
+        unsigned int index = tileZ * numTilesX + tileX;
+        Tile& tile = tileVec[index];
+        if (tile.state != Tile::LOADING)
+            continue;
+        if (iter->failed)
+        {
+            cerr << "Error: Terrain::Update: could not load tile " << tileX << ", "
+                 << tileZ << ".\n";
+            tile.state = Tile::FAILED;
+            continue;
+        }
+        tile.heightVec.swap(iter->heightVec);
+        tile.state = Tile::LOADED;
+        tile.minHeight = *min_element(tile.heightVec.begin(), tile.heightVec.end());
+        tile.maxHeight = *max_element(tile.heightVec.begin(), tile.heightVec.end());
+        tile.vertexVec.clear();
+        if (tileX > 0)
+            tileVec[index - 1].vertexVec.clear();
+        if (tileX + 1 < numTilesX)
+            tileVec[index + 1].vertexVec.clear();
+        if (tileZ > 0)
+            tileVec[index - numTilesX].vertexVec.clear();
+        if (tileZ + 1 < numTilesZ)
+            tileVec[index + numTilesX].vertexVec.clear();
+        changed = true;
+    }
+    // Request near tiles, nearest first, and unload far ones
+    vector<pair<double, unsigned int> > requestVec;
+    for (unsigned int tileZ = 0; tileZ < numTilesZ; ++tileZ)
+        for (unsigned int tileX = 0; tileX < numTilesX; ++tileX)
+        {
+            unsigned int index = tileZ * numTilesX + tileX;
+            Tile& tile = tileVec[index];
+            double distance = TileDistanceXZ(tileX, tileZ);
+            if ((tile.state == Tile::UNLOADED) && (distance <= streamingDistance))
+                requestVec.push_back(make_pair(distance, index));
+            else if ((tile.state == Tile::LOADED) && (distance > 1.5 * streamingDistance))
+            {
+                vector<float>().swap(tile.heightVec);
+                vector<float>().swap(tile.vertexVec);
+                tile.state = Tile::UNLOADED;
+                tile.minHeight = rangeMin;
+                tile.maxHeight = rangeMax;
+                changed = true;
+            }
+        }
+    sort(requestVec.begin(), requestVec.end());
+    for (unsigned int r = 0; r < requestVec.size(); ++r)
+    {
+        unsigned int index = requestVec[r].second;
+        tileVec[index].state = Tile::LOADING;
+        workQueue.Add(new LoadJob(this, tileSourcePtr, index % numTilesX, index / numTilesX,
+                                  chunkSize + 1, generation));
+    }
+    if (changed)
+    {
+        ComputeBoxFromTiles();
+        ComputeRecursiveBoundingBox();
+    }
+}
+
+unsigned int VART::Terrain::GetNumLoadedTiles() const
+{
+    unsigned int result = 0;
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+        if (tileVec[t].state == Tile::LOADED)
+            ++result;
+    return result;
+}
+
+unsigned long VART::Terrain::GetMemoryBytes() const
+{
+    unsigned long result = tileVec.capacity() * sizeof(Tile);
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+        result += (tileVec[t].heightVec.capacity() + tileVec[t].vertexVec.capacity())
+                  * sizeof(float);
+    for (unsigned int level = 0; level < indexVecs.size(); ++level)
+        result += indexVecs[level].capacity() * sizeof(unsigned short);
+    return result;
+}
+
+void VART::Terrain::ComputeBoundingBox()
+{
+    if (tileVec.empty())
+    {
+        bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+    // SetHeight only widens ranges of tiles: make them exact
+    for (unsigned int t = 0; t < tileVec.size(); ++t)
+    {
+        Tile& tile = tileVec[t];
+        if (tile.state == Tile::LOADED)
+        {
+            tile.minHeight = *min_element(tile.heightVec.begin(), tile.heightVec.end());
+            tile.maxHeight = *max_element(tile.heightVec.begin(), tile.heightVec.end());
+        }
+    }
+    ComputeBoxFromTiles();
+}
+
+void VART::Terrain::ComputeBoxFromTiles()
+{
+    if (tileVec.empty())
+    {
+        bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+    float minHeight = tileVec[0].minHeight;
+    float maxHeight = tileVec[0].maxHeight;
+    for (unsigned int t = 1; t < tileVec.size(); ++t)
+    {
+        minHeight = min(minHeight, tileVec[t].minHeight);
+        maxHeight = max(maxHeight, tileVec[t].maxHeight);
+    }
+    bBox.SetBoundingBox(0, minHeight, 0, numCellsX * spacing, maxHeight, numCellsZ * spacing);
+}
+
+bool VART::Terrain::DrawInstanceOGL() const
+{
+    VART_PROFILE_ZONE("Terrain::DrawInstanceOGL");
+#ifdef VART_OGL
+    numChunksDrawn = 0;
+    if (show && !tileVec.empty())
+    {
+        Matrix4 modelView;
+        Matrix4 projection;
+        glGetDoublev(GL_MODELVIEW_MATRIX, &modelView[0]);
+        glGetDoublev(GL_PROJECTION_MATRIX, &projection[0]);
+        Matrix4 inverse;
+        if (modelView.GetInverse(&inverse))
+            eye = inverse * Point4D::ORIGIN();
+        // Planes of the view volume in the terrain's coordinates, from rows of the product
+        // of projection and modelview (left, right, bottom, top, near, far)
+        Matrix4 clip;
+        Matrix4::Multiply(projection, modelView, &clip);
+        double planes[6][4];
+        for (unsigned int axis = 0; axis < 3; ++axis)
+            for (unsigned int col = 0; col < 4; ++col)
+            {
+                planes[axis*2][col] = clip[col*4+3] + clip[col*4+axis];
+                planes[axis*2+1][col] = clip[col*4+3] - clip[col*4+axis];
+            }
+        switch (howToShow)
+        {
+            case LINES:
+            case LINES_AND_NORMALS:
+                glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+                break;
+            case POINTS:
+            case POINTS_AND_NORMALS:
+                glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+                break;
+            default:
+                glPolygonMode(GL_FRONT, GL_FILL);
+                break;
+        }
+        material.DrawOGL();
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        double extent = chunkSize * spacing;
+        for (unsigned int tileZ = 0; tileZ < numTilesZ; ++tileZ)
+            for (unsigned int tileX = 0; tileX < numTilesX; ++tileX)
+            {
+                Tile& tile = tileVec[tileZ * numTilesX + tileX];
+                bool visible = (tile.state == Tile::LOADED);
+                if (visible && tileSourcePtr)
+                    visible = (TileDistanceXZ(tileX, tileZ) <= streamingDistance);
+                // Cull if the box of the chunk is completely outside any plane
+                double center[3] = { (tileX + 0.5) * extent,
+                                     (tile.minHeight + tile.maxHeight) / 2.0,
+                                     (tileZ + 0.5) * extent };
+                double halfEdges[3] = { extent / 2, (tile.maxHeight - tile.minHeight) / 2.0,
+                                        extent / 2 };
+                for (unsigned int p = 0; visible && (p < 6); ++p)
+                {
+                    const double* plane = planes[p];
+                    double distance = plane[0] * center[0] + plane[1] * center[1]
+                                      + plane[2] * center[2] + plane[3];
+                    double reach = fabs(plane[0]) * halfEdges[0]
+                                   + fabs(plane[1]) * halfEdges[1]
+                                   + fabs(plane[2]) * halfEdges[2];
+                    visible = (distance + reach >= 0);
+                }
+                if (!visible)
+                { // keep vertex data of drawn chunks only
+                    if (!tile.vertexVec.empty())
+                        vector<float>().swap(tile.vertexVec);
+                    continue;
+                }
+                unsigned int level = ChunkLevel(tileX, tileZ);
+                unsigned int neighbourLevels[4] = {
+                    (tileX > 0) ? ChunkLevel(tileX - 1, tileZ) : level,
+                    (tileX + 1 < numTilesX) ? ChunkLevel(tileX + 1, tileZ) : level,
+                    (tileZ > 0) ? ChunkLevel(tileX, tileZ - 1) : level,
+                    (tileZ + 1 < numTilesZ) ? ChunkLevel(tileX, tileZ + 1) : level };
+                if (tile.vertexVec.empty() || (tile.level != level)
+                    || !equal(neighbourLevels, neighbourLevels + 4, tile.neighbourLevels))
+                {
+                    tile.level = level;
+                    copy(neighbourLevels, neighbourLevels + 4, tile.neighbourLevels);
+                    MakeVertices(&tile, tileX, tileZ);
+                }
+                const vector<unsigned short>& indexVec = indexVecs[level];
+                glVertexPointer(3, GL_FLOAT, VERTEX_SIZE * sizeof(float), &tile.vertexVec[0]);
+                glNormalPointer(GL_FLOAT, VERTEX_SIZE * sizeof(float), &tile.vertexVec[3]);
+                glDrawElements(GL_TRIANGLES, indexVec.size(), GL_UNSIGNED_SHORT, &indexVec[0]);
+                ++FrameStats::current.drawCalls[Mesh::TRIANGLES];
+                FrameStats::current.indices[Mesh::TRIANGLES] += indexVec.size();
+                FrameStats::current.vertexBytes += tile.vertexVec.size() * sizeof(float);
+                ++numChunksDrawn;
+            }
+    }
+    if (bBox.visible)
+        bBox.DrawInstanceOGL();
+    if (recBBox.visible)
+        recBBox.DrawInstanceOGL();
+    return true;
+#else
+    return false;
+#endif
+}
@@ -6,6 +6,7 @@
 
 #ifdef __linux__  // compiling on a Linux system?
 #include <sys/time.h>
+#include <time.h>
 #endif
 
 #ifdef WIN32
@@ -65,6 +66,20 @@ void VART::Time::Set()
 #endif
 }
 
+void VART::Time::SetMonotonic()
+{
+#ifdef __linux__
+    timespec temp;
+    clock_gettime(CLOCK_MONOTONIC, &temp);
+    seconds = static_cast<double>(temp.tv_sec) + (static_cast<double>(temp.tv_nsec)/1000000000.0);
+#endif
+
+#ifdef WIN32
+    // The performance counter is already monotonic
+    Set();
+#endif
+}
+
 const VART::Time& VART::Time::NOW()
 // static method
 {
@@ -0,0 +1,508 @@
+/// \file xmlreader.cpp
+/// \brief Implementation file for V-ART class "XmlReader".
+/// \version $Revision: 1.1 $
+
+#include "vart/xmlreader.h"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+// Initial size of the input window
+const unsigned int BUFFER_SIZE = 65536;
+
+const unsigned int VART::XmlReader::NO_NAME = 0xFFFFFFFF;
+
+static inline bool IsSpace(char c)
+{
+    return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r');
+}
+
+VART::XmlReader::XmlReader() : filePtr(NULL), position(0), end(0), endOfFile(true), line(1),
+                               pendingEnd(false), popPending(false), seenRoot(false),
+                               lastEvent(END_OF_DOCUMENT)
+{
+    hashTable.assign(64, NO_NAME);
+}
+
+VART::XmlReader::~XmlReader()
+{
+    Close();
+}
+
+unsigned int VART::XmlReader::Intern(const string& name)
+{
+    return Intern(name.data(), name.size());
+}
+
+unsigned int VART::XmlReader::Intern(const char* name, unsigned int length)
+{
+    // FNV-1a hash
+    unsigned int hash = 2166136261u;
+    for (unsigned int i = 0; i < length; ++i)
+        hash = (hash ^ static_cast<unsigned char>(name[i])) * 16777619u;
+    unsigned int mask = hashTable.size() - 1;
+    unsigned int slot = hash & mask;
+    while (hashTable[slot] != NO_NAME)
+    {
+        const string& candidate = nameVec[hashTable[slot]];
+        if ((candidate.size() == length) && (memcmp(candidate.data(), name, length) == 0))
+            return hashTable[slot];
+        slot = (slot + 1) & mask;
+    }
+    unsigned int id = nameVec.size();
+    nameVec.push_back(string(name, length));
+    hashTable[slot] = id;
+    if (nameVec.size() * 2 > hashTable.size())
+    { // Keep the table at most half full
+        vector<unsigned int> oldTable;
+        oldTable.swap(hashTable);
+        hashTable.assign(oldTable.size() * 2, NO_NAME);
+        mask = hashTable.size() - 1;
+        for (unsigned int n = 0; n < nameVec.size(); ++n)
+        {
+            hash = 2166136261u;
+            for (unsigned int i = 0; i < nameVec[n].size(); ++i)
+                hash = (hash ^ static_cast<unsigned char>(nameVec[n][i])) * 16777619u;
+            slot = hash & mask;
+            while (hashTable[slot] != NO_NAME)
+                slot = (slot + 1) & mask;
+            hashTable[slot] = n;
+        }
+    }
+    return id;
+}
+
+bool VART::XmlReader::Open(const string& fileName)
+{
+    Close();
+    filePtr = fopen(fileName.c_str(), "rb");
+    if (filePtr == NULL)
+    {
+        SetError("could not open '" + fileName + "'");
+        return false;
+    }
+    buffer.assign(BUFFER_SIZE + 1, '\0'); // plus a terminator
+    position = 0;
+    end = 0;
+    endOfFile = false;
+    line = 1;
+    elementStack.clear();
+    attributeVec.clear();
+    pendingEnd = false;
+    popPending = false;
+    seenRoot = false;
+    lastEvent = START_ELEMENT;
+    errorMessage.clear();
+    // Skip UTF-8 byte order mark
+    if (Ensure(2) && (memcmp(&buffer[0], "\xEF\xBB\xBF", 3) == 0))
+        position = 3;
+    return true;
+}
+
+void VART::XmlReader::Close()
+{
+    if (filePtr)
+    {
+        fclose(filePtr);
+        filePtr = NULL;
+    }
+    endOfFile = true;
+}
+
+bool VART::XmlReader::Refill()
+{
+    if (endOfFile)
+        return false;
+    // Move unread data to the front
+    unsigned int size = end - position;
+    if (position > 0)
+    {
+        memmove(&buffer[0], &buffer[position], size);
+        position = 0;
+        end = size;
+    }
+    // Grow if the window is full (a very long tag)
+    if (end == buffer.size() - 1)
+        buffer.resize(buffer.size() * 2 - 1);
+    size_t count = fread(&buffer[end], 1, buffer.size() - 1 - end, filePtr);
+    end += count;
+    buffer[end] = '\0';
+    if (count == 0)
+        endOfFile = true;
+    return count > 0;
+}
+
+bool VART::XmlReader::Ensure(unsigned int offset)
+// Offsets are relative to "position", which may change on refills.
+{
+    while (position + offset >= end)
+        if (!Refill())
+            return false;
+    return true;
+}
+
+bool VART::XmlReader::Find(const char* str, unsigned int* offsetPtr)
+{
+    unsigned int length = strlen(str);
+    unsigned int offset = 0;
+    for (;;)
+    {
+        const char* start = &buffer[position];
+        const char* stop = &buffer[end];
+        const char* found = search(start + offset, stop, str, str + length);
+        if (found != stop)
+        {
+            *offsetPtr = found - start;
+            return true;
+        }
+        // Search again from where a partial match may begin
+        unsigned int available = end - position;
+        offset = (available >= length) ? (available - length + 1) : 0;
+        if (!Refill())
+            return false;
+    }
+}
+
+void VART::XmlReader::Consume(unsigned int count)
+{
+    const char* start = &buffer[position];
+    line += std::count(start, start + count, '\n');
+    position += count;
+}
+
+VART::XmlReader::Event VART::XmlReader::SetError(const string& message)
+{
+    ostringstream stream;
+    stream << message;
+    if (filePtr)
+        stream << " (line " << line << ")";
+    errorMessage = stream.str();
+    lastEvent = PARSE_ERROR;
+    return PARSE_ERROR;
+}
+
+VART::XmlReader::Event VART::XmlReader::Next()
+{
+    if ((lastEvent == END_OF_DOCUMENT) || (lastEvent == PARSE_ERROR))
+        return lastEvent;
+    if (popPending)
+    {
+        elementStack.pop_back();
+        popPending = false;
+    }
+    attributeVec.clear();
+    if (pendingEnd)
+    {
+        pendingEnd = false;
+        popPending = true;
+        return (lastEvent = END_ELEMENT);
+    }
+    for (;;)
+    {
+        // Skip text
+        const char* start = &buffer[position];
+        const char* found = static_cast<const char*>(memchr(start, '<', end - position));
+        while (found == NULL)
+        {
+            Consume(end - position);
+            if (!Refill())
+            {
+                if (seenRoot && elementStack.empty())
+                {
+                    Close();
+                    return (lastEvent = END_OF_DOCUMENT);
+                }
+                return SetError("unexpected end of file");
+            }
+            start = &buffer[position];
+            found = static_cast<const char*>(memchr(start, '<', end - position));
+        }
+        Consume(found - start);
+        if (!Ensure(1))
+            return SetError("unexpected end of file");
+        char next = buffer[position + 1];
+        if (next == '/')
+            return ParseEndTag();
+        if (next == '?')
+        {
+            unsigned int offset;
+            if (!Find("?>", &offset))
+                return SetError("unterminated processing instruction");
+            Consume(offset + 2);
+        }
+        else if (next == '!')
+        {
+            unsigned int offset;
+            if (Ensure(3) && (memcmp(&buffer[position], "<!--", 4) == 0))
+            {
+                if (!Find("-->", &offset))
+                    return SetError("unterminated comment");
+                Consume(offset + 3);
+            }
+            else if (Ensure(8) && (memcmp(&buffer[position], "<![CDATA[", 9) == 0))
+            {
+                if (!Find("]]>", &offset))
+                    return SetError("unterminated CDATA section");
+                Consume(offset + 3);
+            }
+            else
+            { // Document type declaration, possibly with an internal subset
+                unsigned int depth = 0;
+                char quote = 0;
+                offset = 2;
+                for (;; ++offset)
+                {
+                    if (!Ensure(offset))
+                        return SetError("unterminated declaration");
+                    char c = buffer[position + offset];
+                    if (quote)
+                    {
+                        if (c == quote)
+                            quote = 0;
+                    }
+                    else if ((c == '"') || (c == '\''))
+                        quote = c;
+                    else if (c == '[')
+                        ++depth;
+                    else if ((c == ']') && (depth > 0))
+                        --depth;
+                    else if ((c == '>') && (depth == 0))
+                        break;
+                }
+                Consume(offset + 1);
+            }
+        }
+        else
+            return ParseStartTag();
+    }
+}
+
+VART::XmlReader::Event VART::XmlReader::ParseStartTag()
+{
+    // Find the end of the tag, skipping quoted values
+    unsigned int length = 1;
+    char quote = 0;
+    for (;; ++length)
+    {
+        if (!Ensure(length))
+            return SetError("unterminated start tag");
+        char c = buffer[position + length];
+        if (quote)
+        {
+            if (c == quote)
+                quote = 0;
+        }
+        else if ((c == '"') || (c == '\''))
+            quote = c;
+        else if (c == '>')
+            break;
+    }
+    if (seenRoot && elementStack.empty())
+        return SetError("element after end of root element");
+    // The whole tag is now in the buffer
+    char* tag = &buffer[position];
+    char* tagEnd = tag + length; // at '>'
+    char* p = tag + 1;
+    while ((p < tagEnd) && !IsSpace(*p) && (*p != '/'))
+        ++p;
+    if (p == tag + 1)
+        return SetError("missing element name");
+    unsigned int name = Intern(tag + 1, p - tag - 1);
+    bool empty = false;
+    for (;;)
+    {
+        while ((p < tagEnd) && IsSpace(*p))
+            ++p;
+        if (p == tagEnd)
+            break;
+        if (*p == '/')
+        {
+            empty = true;
+            ++p;
+            continue;
+        }
+        char* attrName = p;
+        while ((p < tagEnd) && !IsSpace(*p) && (*p != '='))
+            ++p;
+        unsigned int attrLength = p - attrName;
+        while ((p < tagEnd) && IsSpace(*p))
+            ++p;
+        if ((p == tagEnd) || (*p != '=') || (attrLength == 0))
+            return SetError("malformed attribute in element '" + nameVec[name] + "'");
+        ++p;
+        while ((p < tagEnd) && IsSpace(*p))
+            ++p;
+        if ((p == tagEnd) || ((*p != '"') && (*p != '\'')))
+            return SetError("unquoted attribute value in element '" + nameVec[name] + "'");
+        char valueQuote = *p++;
+        char* value = p;
+        while (*p != valueQuote)
+            ++p;
+        *p++ = '\0';
+        if (!DecodeValue(value))
+            return SetError("unknown reference in element '" + nameVec[name] + "'");
+        Attribute attribute;
+        attribute.name = Intern(attrName, attrLength);
+        attribute.value = value;
+        attributeVec.push_back(attribute);
+    }
+    Consume(length + 1);
+    elementStack.push_back(name);
+    seenRoot = true;
+    pendingEnd = empty;
+    return (lastEvent = START_ELEMENT);
+}
+
+VART::XmlReader::Event VART::XmlReader::ParseEndTag()
+{
+    unsigned int offset;
+    if (!Find(">", &offset))
+        return SetError("unterminated end tag");
+    const char* name = &buffer[position + 2];
+    const char* nameEnd = &buffer[position + offset];
+    while ((nameEnd > name) && IsSpace(nameEnd[-1]))
+        --nameEnd;
+    if (elementStack.empty() || (Intern(name, nameEnd - name) != elementStack.back()))
+        return SetError("unexpected end tag '" + string(name, nameEnd) + "'");
+    Consume(offset + 1);
+    popPending = true;
+    return (lastEvent = END_ELEMENT);
+}
+
+bool VART::XmlReader::DecodeValue(char* value)
+// Attribute values are normalized as required by the XML specification: references are
+// replaced and white space characters become spaces.
+{
+    char* destination = value;
+    for (const char* source = value; *source; ++source)
+    {
+        if (*source == '&')
+        {
+            const char* semicolon = strchr(source, ';');
+            if (semicolon == NULL)
+                return false;
+            string entity(source + 1, semicolon);
+            if (entity == "lt")
+                *destination++ = '<';
+            else if (entity == "gt")
+                *destination++ = '>';
+            else if (entity == "amp")
+                *destination++ = '&';
+            else if (entity == "quot")
+                *destination++ = '"';
+            else if (entity == "apos")
+                *destination++ = '\'';
+            else if ((entity.size() > 1) && (entity[0] == '#'))
+            { // Character reference, written as UTF-8
+                unsigned long code = (entity[1] == 'x') ? strtoul(entity.c_str() + 2, NULL, 16)
+                                                        : strtoul(entity.c_str() + 1, NULL, 10);
+                if (code < 0x80)
+                    *destination++ = static_cast<char>(code);
+                else if (code < 0x800)
+                {
+                    *destination++ = static_cast<char>(0xC0 | (code >> 6));
+                    *destination++ = static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000)
+                {
+                    *destination++ = static_cast<char>(0xE0 | (code >> 12));
+                    *destination++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    *destination++ = static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else
+                {
+                    *destination++ = static_cast<char>(0xF0 | (code >> 18));
+                    *destination++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    *destination++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    *destination++ = static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+            else
+                return false;
+            source = semicolon;
+        }
+        else if (IsSpace(*source))
+            *destination++ = ' ';
+        else
+            *destination++ = *source;
+    }
+    *destination = '\0';
+    return true;
+}
+
+unsigned int VART::XmlReader::GetParentName() const
+{
+    unsigned int depth = elementStack.size();
+    return (depth > 1) ? elementStack[depth - 2] : NO_NAME;
+}
+
+const VART::XmlReader::Attribute* VART::XmlReader::FindAttribute(unsigned int nameId) const
+{
+    for (unsigned int i = 0; i < attributeVec.size(); ++i)
+        if (attributeVec[i].name == nameId)
+            return &attributeVec[i];
+    return NULL;
+}
+
+bool VART::XmlReader::GetAttribute(unsigned int nameId, float* valuePtr) const
+{
+    const Attribute* attributePtr = FindAttribute(nameId);
+    if (attributePtr == NULL)
+        return false;
+    char* numberEnd;
+    float value = strtof(attributePtr->value, &numberEnd);
+    if (numberEnd == attributePtr->value)
+        return false;
+    *valuePtr = value;
+    return true;
+}
+
+bool VART::XmlReader::GetAttribute(unsigned int nameId, int* valuePtr) const
+{
+    const Attribute* attributePtr = FindAttribute(nameId);
+    if (attributePtr == NULL)
+        return false;
+    char* numberEnd;
+    long value = strtol(attributePtr->value, &numberEnd, 10);
+    if (numberEnd == attributePtr->value)
+        return false;
+    *valuePtr = static_cast<int>(value);
+    return true;
+}
+
+bool VART::XmlReader::GetAttribute(unsigned int nameId, bool* valuePtr) const
+{
+    const Attribute* attributePtr = FindAttribute(nameId);
+    if (attributePtr == NULL)
+        return false;
+    const char* value = attributePtr->value;
+    if ((strcmp(value, "true") == 0) || (strcmp(value, "1") == 0))
+    {
+        *valuePtr = true;
+        return true;
+    }
+    if ((strcmp(value, "false") == 0) || (strcmp(value, "0") == 0))
+    {
+        *valuePtr = false;
+        return true;
+    }
+    return false;
+}
+
+bool VART::XmlReader::GetAttribute(unsigned int nameId, string* valuePtr) const
+{
+    const Attribute* attributePtr = FindAttribute(nameId);
+    if (attributePtr == NULL)
+        return false;
+    *valuePtr = attributePtr->value;
+    return true;
+}
+
+bool VART::XmlReader::AttributeEquals(unsigned int nameId, const char* value) const
+{
+    const Attribute* attributePtr = FindAttribute(nameId);
+    return attributePtr && (strcmp(attributePtr->value, value) == 0);
+}
@@ -0,0 +1,179 @@
+/// \file offscreenviewer.cpp
+/// \brief Implementation file for V-ART class "OffscreenViewer".
+/// \version $Revision: 1.1 $
+
+#include "vart/contrib/offscreenviewer.h"
+#include "vart/baseaction.h"
+#include "vart/profiler.h"
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+#include <cstring>
+#include <cassert>
+
+using namespace std;
+
+VART::OffscreenViewer::OffscreenViewer(int newWidth, int newHeight) :
+    autoChangeCameraAspect(true), autoMoveActions(true), ptScene(NULL), cameraPtr(NULL),
+    idleHndPtr(NULL), drawHandlerPtr(NULL), width(newWidth), height(newHeight),
+    handlerViewer(newWidth, newHeight, false), frameCount(0), displayPtr(NULL),
+    surfacePtr(NULL), contextPtr(NULL)
+{
+    clock.SetOffline(true);
+    clock.Reset();
+    if (CreateContext())
+    {
+        glViewport(0, 0, width, height);
+        glShadeModel(GL_SMOOTH);
+        glEnable(GL_DEPTH_TEST);
+        glEnable(GL_CULL_FACE);
+        // Enable vertex arrays to allow drawing of optimized mesh objects
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_NORMAL_ARRAY);
+    }
+}
+
+VART::OffscreenViewer::~OffscreenViewer()
+{
+    if (SimulationClock::GetCurrent() == &clock)
+        SimulationClock::SetCurrent(NULL);
+    if (contextPtr)
+    {
+        eglMakeCurrent(displayPtr, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(displayPtr, contextPtr);
+    }
+    if (surfacePtr)
+        eglDestroySurface(displayPtr, surfacePtr);
+    // The display is not terminated: other viewers may be using it.
+}
+
+bool VART::OffscreenViewer::CreateContext()
+{
+    // Prefer the surfaceless platform, which needs no display server
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (extensions && strstr(extensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay)
+            displayPtr = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY,
+                                            NULL);
+    }
+    if (displayPtr == EGL_NO_DISPLAY)
+        displayPtr = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major, minor;
+    if ((displayPtr == EGL_NO_DISPLAY) || !eglInitialize(displayPtr, &major, &minor))
+    {
+        cerr << "Error: OffscreenViewer: could not initialize EGL." << endl;
+        return false;
+    }
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24, EGL_NONE };
+    EGLConfig config;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(displayPtr, configAttribs, &config, 1, &numConfigs) || (numConfigs == 0))
+    {
+        cerr << "Error: OffscreenViewer: no EGL configuration for OpenGL pbuffers." << endl;
+        return false;
+    }
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    surfacePtr = eglCreatePbufferSurface(displayPtr, config, surfaceAttribs);
+    if (surfacePtr == EGL_NO_SURFACE)
+    {
+        cerr << "Error: OffscreenViewer: could not create a " << width << "x" << height
+             << " pbuffer." << endl;
+        surfacePtr = NULL;
+        return false;
+    }
+    contextPtr = eglCreateContext(displayPtr, config, EGL_NO_CONTEXT, NULL);
+    if (contextPtr == EGL_NO_CONTEXT)
+    {
+        cerr << "Error: OffscreenViewer: could not create an OpenGL context." << endl;
+        contextPtr = NULL;
+        return false;
+    }
+    MakeCurrent();
+    return true;
+}
+
+void VART::OffscreenViewer::MakeCurrent()
+{
+    if (contextPtr)
+        eglMakeCurrent(displayPtr, surfacePtr, surfacePtr, contextPtr);
+}
+
+void VART::OffscreenViewer::SetScene(VART::Scene& scene)
+{
+    ptScene = &scene;
+    if (cameraPtr == NULL)
+        cameraPtr = scene.GetCurrentCamera();
+    if (autoChangeCameraAspect)
+        scene.SetAllCamerasAspectRatio(static_cast<float>(width)/height);
+    if (scene.GetNumLights() > 0)
+    {
+        MakeCurrent();
+        glEnable(GL_LIGHTING);
+    }
+}
+
+void VART::OffscreenViewer::SetIdleHandler(ViewerGlutOGL::IdleHandler* newIHPtr)
+{
+    idleHndPtr = newIHPtr;
+    if (newIHPtr)
+        newIHPtr->viewerPtr = &handlerViewer;
+}
+
+void VART::OffscreenViewer::SetDrawHandler(ViewerGlutOGL::DrawHandler* newDHPtr)
+{
+    drawHandlerPtr = newDHPtr;
+    if (newDHPtr)
+        newDHPtr->viewerPtr = &handlerViewer;
+}
+
+void VART::OffscreenViewer::DrawFrame()
+{
+    assert(ptScene && "OffscreenViewer tried to draw a scene pointed by NULL!");
+    MakeCurrent();
+    // An offline clock accounts for exactly one step per update
+    clock.Update();
+    while (clock.Step())
+        if (autoMoveActions)
+            BaseAction::MoveAllActive();
+    if (idleHndPtr)
+    {
+        VART_PROFILE_ZONE("IdleHandler::OnIdle");
+        idleHndPtr->OnIdle();
+    }
+    static float bgColor[4];
+    ptScene->GetBackgroundColor().GetScaled(1.0f, bgColor); // convert color components to float
+    glClearColor(bgColor[0], bgColor[1], bgColor[2], bgColor[3]);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    ptScene->DrawOGL(cameraPtr);
+    if (drawHandlerPtr)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
+        drawHandlerPtr->OnDraw();
+    }
+    ++frameCount;
+    if (Profiler::IsEnabled())
+        Profiler::EndFrame();
+}
+
+void VART::OffscreenViewer::Run(unsigned int numFrames)
+{
+    for (unsigned int i = 0; i < numFrames; ++i)
+        DrawFrame();
+    glFinish();
+}
+
+void VART::OffscreenViewer::ReadPixels(vector<unsigned char>* rgbaPtr)
+{
+    MakeCurrent();
+    rgbaPtr->resize(static_cast<size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &(*rgbaPtr)[0]);
+}
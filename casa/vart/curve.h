@@ -22,6 +22,31 @@ namespace VART {
             /// \param result [out] the point at position t.
             virtual void GetPoint(double t, Point4D* result)=0;
 
+            /// \brief Returns many points of the curve.
+            /// \param params [in] curve parameters describing the desired points.
+            /// \param count [in] number of elements in params and results.
+            /// \param results [out] the points at each parameter.
+            virtual void GetPoints(const double* params, unsigned int count, Point4D* results)
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                    GetPoint(params[i], results + i);
+            }
+
+            /// \brief Returns points of the curve at evenly spaced parameters.
+            /// \param tBegin [in] parameter of the first point.
+            /// \param tEnd [in] parameter of the last point.
+            /// \param count [in] number of points.
+            /// \param results [out] the points, from tBegin to tEnd.
+            ///
+            /// Use this method to tesselate a curve.
+            virtual void GetUniformPoints(double tBegin, double tEnd, unsigned int count,
+                                          Point4D* results)
+            {
+                double step = (count > 1) ? (tEnd - tBegin) / (count - 1) : 0.0;
+                for (unsigned int i = 0; i < count; ++i)
+                    GetPoint(tBegin + i * step, results + i);
+            }
+
             /// \brief Applies a transformation to all controlPoints
             void ApplyTransform(const Transform& t);
 
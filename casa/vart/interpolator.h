@@ -38,6 +38,23 @@ namespace VART {
             /// sophisticated interpolation (GetValue output). Each derived class implents a
             /// specific mapping.
             virtual float GetValue(float linearIndex, float initialPos, float range) const = 0;
+
+            /// \brief Evaluates goal positions for an array of linear indices
+            /// \param linearIndices [in] Numbers in range [0..1].
+            /// \param count [in] Number of elements in linearIndices and results.
+            /// \param initialPos [in] DOF's initial movement position.
+            /// \param range [in] DOF's position range on movement.
+            /// \param results [out] DOF's positions (may be the same array as linearIndices).
+            ///
+            /// Gives the same results as calling GetValue for each linear index, but
+            /// derived classes evaluate whole arrays much faster. Use it to sample a whole
+            /// track, e.g.: for baking an animation.
+            virtual void GetValues(const float* linearIndices, unsigned int count,
+                                   float initialPos, float range, float* results) const
+            {
+                for (unsigned int i = 0; i < count; ++i)
+                    results[i] = GetValue(linearIndices[i], initialPos, range);
+            }
             virtual TypeID GetID() const = 0;
     }; // end class declaration
 } // end namespace
@@ -22,6 +22,10 @@ namespace VART {
             NaturalInterpolator();
             NaturalInterpolator(float offsetLevel, float overshootLevel);
             virtual float GetValue(float linearIndex, float initialValue, float range) const;
+            /// \brief Evaluates values one at a time (SineInterpolator's version does not apply).
+            virtual void GetValues(const float* linearIndices, unsigned int count,
+                                   float initialPos, float range, float* results) const
+                { Interpolator::GetValues(linearIndices, count, initialPos, range, results); }
             void SetOffset(float value) { offset = value; }
             float GetOffset() { return offset; }
             void SetOvershoot(float value) { overshoot = value; }
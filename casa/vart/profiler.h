@@ -0,0 +1,102 @@
+/// \file profiler.h
+/// \brief Header file for V-ART class "Profiler".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_PROFILER_H
+#define VART_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/// \def VART_PROFILE_ZONE(name)
+/// \brief Times the rest of the enclosing block as a zone called "name" (a string literal).
+///
+/// Compiling with VART_NO_PROFILING removes zones altogether.
+#ifdef VART_NO_PROFILING
+#define VART_PROFILE_ZONE(name)
+#else
+#define VART_PROFILE_CONCAT2(a, b) a ## b
+#define VART_PROFILE_CONCAT(a, b) VART_PROFILE_CONCAT2(a, b)
+#define VART_PROFILE_ZONE(name) \
+    VART::Profiler::Zone VART_PROFILE_CONCAT(vartProfileZone, __LINE__)(name)
+#endif
+
+namespace VART {
+/// \class Profiler profiler.h
+/// \brief Records timed zones of code for tracing and for on-screen statistics.
+///
+/// Zones are marked with VART_PROFILE_ZONE. When the profiler is enabled (see SetEnabled),
+/// each zone records its name, start and end into a ring buffer of the running thread.
+/// Buffers belong to a single thread each and are written without locks; old events are
+/// overwritten when a buffer is full. When disabled, a zone costs a check of a flag.
+///
+/// Recorded events may be saved as a Chrome trace (see SaveChromeTrace), viewed in
+/// "chrome://tracing" or Perfetto. Viewers call EndFrame once per frame, which keeps rolling
+/// averages of the time taken by each zone per frame (see GetAverages).
+    class Profiler {
+        public:
+        // PUBLIC NESTED CLASSES
+            /// \brief Scoped zone: records its lifetime, if the profiler is enabled.
+            class Zone {
+                public:
+                    Zone(const char* zoneName)
+                        : name(IsEnabled() ? zoneName : NULL), start(name ? Now() : 0) {}
+                    ~Zone() { if (name) Record(name, start, Now()); }
+                private:
+                    const char* name;
+                    long long start;
+            };
+            /// \brief Rolling average of a zone.
+            class Average {
+                public:
+                    std::string name;
+                    /// \brief Time per frame, in milliseconds (nested zones included).
+                    double milliseconds;
+                    /// \brief Number of times the zone ran per frame.
+                    double count;
+            };
+        // PUBLIC STATIC METHODS
+            /// \brief Turns recording on or off.
+            static void SetEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+            /// \brief Checks whether recording is on.
+            static bool IsEnabled() { return enabled.load(std::memory_order_relaxed); }
+            /// \brief Sets the number of events kept per thread (default 65536).
+            ///
+            /// Takes effect for threads that have not recorded yet.
+            static void SetCapacity(unsigned int value) { capacity = value; }
+            /// \brief Names the calling thread in traces.
+            /// \param threadName [in] A string that lives as long as the thread (e.g.: a literal).
+            static void SetThreadName(const char* threadName);
+            /// \brief Returns monotonic time in nanoseconds.
+            static long long Now()
+            {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+            /// \brief Records an event. Called by zones.
+            static void Record(const char* name, long long start, long long end);
+            /// \brief Discards recorded events.
+            static void Clear();
+            /// \brief Saves recorded events in the Chrome trace event format (JSON).
+            /// \return False if the file could not be written.
+            static bool SaveChromeTrace(const std::string& fileName);
+            /// \brief Marks the end of a frame, updating rolling averages.
+            ///
+            /// Zones that ended since the previous call are accounted for this frame. The
+            /// frame itself is accounted for as a zone named "Frame".
+            static void EndFrame();
+            /// \brief Returns rolling averages of zones, by decreasing time.
+            static void GetAverages(std::vector<Average>* resultPtr);
+            /// \brief Sets how many frames rolling averages span, roughly (default 30).
+            static void SetAverageFrames(unsigned int value) { averageFrames = value; }
+        protected:
+        // PROTECTED STATIC ATTRIBUTES
+            static std::atomic<bool> enabled;
+            static unsigned int capacity;
+            static unsigned int averageFrames;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -6,7 +6,6 @@
 
 void VART::Curve::ApplyTransform(const VART::Transform& t)
 {
-    unsigned int numCtrlPoints = controlPoints.size();
-    for (unsigned int i=0; i < numCtrlPoints; ++i)
-        t.ApplyTo(&controlPoints[i]);
+    if (!controlPoints.empty())
+        t.GetMatrix().ApplyTo(&controlPoints[0], controlPoints.size());
 }
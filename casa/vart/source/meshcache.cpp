@@ -0,0 +1,167 @@
+/// \file meshcache.cpp
+/// \brief Implementation file for V-ART class "MeshCache".
+/// \version $Revision: 1.1 $
+
+#include "vart/meshcache.h"
+#include "vart/meshobject.h"
+#include "vart/profiler.h"
+#include "vart/texturecache.h"
+#include <iostream>
+#include <list>
+#include <stdexcept>
+
+using namespace std;
+
+class VART::MeshCache::ReadJob : public VART::WorkQueue::Job {
+    public:
+        ReadJob(MeshCache* cachePtr, const string& name) : cache(*cachePtr), fileName(name) {}
+        virtual void Run()
+        {
+            VART_PROFILE_ZONE("MeshCache::Read");
+            cache.Read(fileName);
+        }
+    private:
+        MeshCache& cache;
+        string fileName;
+};
+
+VART::MeshCache::Entry::~Entry()
+{
+    map<string, MeshObject*>::iterator iter = meshObjectMap.begin();
+    for (; iter != meshObjectMap.end(); ++iter)
+        delete iter->second;
+}
+
+VART::MeshCache& VART::MeshCache::Instance()
+{
+    static MeshCache cache;
+    return cache;
+}
+
+VART::MeshCache::MeshCache() : numFilesRead(0)
+{
+    // Workers request textures, so the texture cache must outlive this one (statics are
+    // destroyed in reverse order of construction).
+    TextureCache::Instance();
+}
+
+VART::MeshCache::~MeshCache()
+{
+    workQueue.Stop();
+    map<string, Entry*>::iterator iter = entryMap.begin();
+    for (; iter != entryMap.end(); ++iter)
+        delete iter->second;
+}
+
+void VART::MeshCache::Request(const string& fileName)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    Entry*& entryPtr = entryMap[fileName];
+    if (entryPtr == NULL)
+    {
+        entryPtr = new Entry;
+        workQueue.Add(new ReadJob(this, fileName));
+    }
+    ++entryPtr->refCount;
+}
+
+void VART::MeshCache::Release(const string& fileName)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    map<string, Entry*>::iterator iter = entryMap.find(fileName);
+    if ((iter == entryMap.end()) || (iter->second->refCount == 0))
+    {
+        cerr << "Error: MeshCache::Release: '" << fileName << "' has not been requested.\n";
+        return;
+    }
+    Entry* entryPtr = iter->second;
+    --entryPtr->refCount;
+    // Files still being read are removed by the worker that reads them.
+    if ((entryPtr->refCount == 0) && entryPtr->ready)
+    {
+        delete entryPtr;
+        entryMap.erase(iter);
+    }
+}
+
+bool VART::MeshCache::GetMeshObject(const string& fileName, const string& meshName,
+                                    MeshObject* resultPtr)
+{
+    unique_lock<mutex> lock(cacheMutex);
+    map<string, Entry*>::iterator iter = entryMap.find(fileName);
+    if (iter == entryMap.end())
+    {
+        cerr << "Error: MeshCache::GetMeshObject: '" << fileName << "' has not been requested.\n";
+        return false;
+    }
+    Entry* entryPtr = iter->second;
+    while (!entryPtr->ready)
+        read.wait(lock);
+    if (entryPtr->failed)
+    {
+        cerr << "Error: " << entryPtr->errorMessage << endl;
+        return false;
+    }
+    map<string, MeshObject*>::iterator meshIter = entryPtr->meshObjectMap.find(meshName);
+    if (meshIter == entryPtr->meshObjectMap.end())
+    {
+        cerr << "Error: No mesh object named " << meshName << " was found in " << fileName
+             << "!" << endl;
+        return false;
+    }
+    // Entries in use are not removed, so the lock is not needed to copy the mesh object.
+    lock.unlock();
+    resultPtr->MergeWith(*meshIter->second);
+    resultPtr->SetFileName(fileName);
+    return true;
+}
+
+bool VART::MeshCache::IsReady(const string& fileName) const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    map<string, Entry*>::const_iterator iter = entryMap.find(fileName);
+    return (iter != entryMap.end()) && iter->second->ready;
+}
+
+unsigned int VART::MeshCache::GetNumFiles() const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    return entryMap.size();
+}
+
+void VART::MeshCache::Read(const string& fileName)
+{
+    list<MeshObject*> meshObjectList;
+    string errorMessage;
+    try
+    {
+        MeshObject::ReadFromOBJ(fileName, &meshObjectList, false);
+    }
+    catch (exception& e)
+    {
+        errorMessage = e.what();
+    }
+    catch (...)
+    {
+        errorMessage = "MeshCache could not read '" + fileName + "'.";
+    }
+    lock_guard<mutex> lock(cacheMutex);
+    Entry* entryPtr = entryMap[fileName];
+    for (list<MeshObject*>::iterator iter = meshObjectList.begin();
+         iter != meshObjectList.end(); ++iter)
+    {
+        MeshObject*& meshPtr = entryPtr->meshObjectMap[(*iter)->GetDescription()];
+        delete meshPtr; // keep the last of repeated names
+        meshPtr = *iter;
+    }
+    entryPtr->failed = !errorMessage.empty();
+    entryPtr->errorMessage = errorMessage;
+    entryPtr->ready = true;
+    ++numFilesRead;
+    if (entryPtr->refCount == 0)
+    { // released while being read
+        delete entryPtr;
+        entryMap.erase(fileName);
+    }
+    read.notify_all();
+}
@@ -0,0 +1,271 @@
+/// \file profiler.cpp
+/// \brief Implementation file for V-ART class "Profiler".
+/// \version $Revision: 1.1 $
+
+#include "vart/profiler.h"
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+
+using namespace std;
+
+// INITIALIZATION OF STATIC ATTRIBUTES
+atomic<bool> VART::Profiler::enabled(false);
+unsigned int VART::Profiler::capacity = 65536;
+unsigned int VART::Profiler::averageFrames = 30;
+
+// A recorded zone
+class ProfilerEvent {
+    public:
+        const char* name;
+        long long start;
+        long long end;
+};
+
+// Ring buffer of events, written by a single thread. Events are numbered from zero; event
+// "n" is stored at n % size. The owner publishes an event by incrementing "count".
+class ProfilerBuffer {
+    public:
+        ProfilerBuffer(unsigned int size, unsigned int id)
+            : eventVec(size), count(0), cleared(0), framed(0), threadID(id) {}
+        // Copies events numbered from "first" on that are still in the buffer.
+        // Returns the number of the event after the last one copied.
+        unsigned long long Read(unsigned long long first, vector<ProfilerEvent>* resultPtr) const;
+        vector<ProfilerEvent> eventVec;
+        atomic<unsigned long long> count;
+        // Events before this one were discarded by Clear
+        atomic<unsigned long long> cleared;
+        // Events before this one were accounted for by EndFrame
+        unsigned long long framed;
+        unsigned int threadID;
+        string threadName;
+};
+
+unsigned long long ProfilerBuffer::Read(unsigned long long first,
+                                        vector<ProfilerEvent>* resultPtr) const
+{
+    const unsigned long long size = eventVec.size();
+    unsigned long long last = count.load(memory_order_acquire);
+    first = max(first, cleared.load(memory_order_relaxed));
+    if (last > size)
+        first = max(first, last - size);
+    resultPtr->clear();
+    for (unsigned long long n = first; n < last; ++n)
+        resultPtr->push_back(eventVec[n % size]);
+    // The owner may have overwritten the oldest events while they were copied
+    unsigned long long now = count.load(memory_order_acquire);
+    if (now > size + first)
+    {
+        unsigned long long overwritten = min(now - size - first, last - first);
+        resultPtr->erase(resultPtr->begin(), resultPtr->begin() + overwritten);
+    }
+    return last;
+}
+
+// Buffers of all threads that recorded. They are never deleted, since threads may still
+// record after the profiler is done with them.
+static mutex registryMutex;
+static vector<ProfilerBuffer*> bufferVec;
+static thread_local ProfilerBuffer* threadBufferPtr = NULL;
+// Name given to the calling thread before it recorded anything
+static thread_local const char* threadNamePtr = NULL;
+// Rolling averages, by name, and end of the last frame (guarded by registryMutex)
+static map<string, VART::Profiler::Average> averageMap;
+static long long lastFrameEnd = 0;
+
+static ProfilerBuffer* ThreadBuffer(unsigned int capacity)
+{
+    if (threadBufferPtr == NULL)
+    {
+        lock_guard<mutex> lock(registryMutex);
+        threadBufferPtr = new ProfilerBuffer((capacity > 0) ? capacity : 1, bufferVec.size());
+        if (threadNamePtr)
+            threadBufferPtr->threadName = threadNamePtr;
+        bufferVec.push_back(threadBufferPtr);
+    }
+    return threadBufferPtr;
+}
+
+// Appends a string as a JSON string
+static void AppendJSONString(string* textPtr, const string& value)
+{
+    textPtr->push_back('"');
+    for (string::const_iterator iter = value.begin(); iter != value.end(); ++iter)
+    {
+        if ((*iter == '"') || (*iter == '\\'))
+            textPtr->push_back('\\');
+        if (static_cast<unsigned char>(*iter) >= ' ')
+            textPtr->push_back(*iter);
+    }
+    textPtr->push_back('"');
+}
+
+void VART::Profiler::SetThreadName(const char* threadName)
+{
+    // Buffers are only created when recording
+    threadNamePtr = threadName;
+    if (threadBufferPtr)
+    {
+        lock_guard<mutex> lock(registryMutex);
+        threadBufferPtr->threadName = threadName;
+    }
+}
+
+void VART::Profiler::Record(const char* name, long long start, long long end)
+{
+    ProfilerBuffer* bufferPtr = ThreadBuffer(capacity);
+    unsigned long long n = bufferPtr->count.load(memory_order_relaxed);
+    ProfilerEvent& event = bufferPtr->eventVec[n % bufferPtr->eventVec.size()];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    bufferPtr->count.store(n + 1, memory_order_release);
+}
+
+void VART::Profiler::Clear()
+{
+    lock_guard<mutex> lock(registryMutex);
+    for (unsigned int i = 0; i < bufferVec.size(); ++i)
+    {
+        unsigned long long count = bufferVec[i]->count.load(memory_order_acquire);
+        bufferVec[i]->cleared.store(count, memory_order_relaxed);
+        bufferVec[i]->framed = count;
+    }
+    averageMap.clear();
+    lastFrameEnd = 0;
+}
+
+bool VART::Profiler::SaveChromeTrace(const string& fileName)
+{
+    lock_guard<mutex> lock(registryMutex);
+    vector<vector<ProfilerEvent> > eventsVec(bufferVec.size());
+    long long origin = 0;
+    bool hasOrigin = false;
+    for (unsigned int i = 0; i < bufferVec.size(); ++i)
+    {
+        bufferVec[i]->Read(0, &eventsVec[i]);
+        for (unsigned int e = 0; e < eventsVec[i].size(); ++e)
+            if (!hasOrigin || (eventsVec[i][e].start < origin))
+            {
+                origin = eventsVec[i][e].start;
+                hasOrigin = true;
+            }
+    }
+    string text = "{\"traceEvents\":[\n";
+    bool first = true;
+    char number[64];
+    for (unsigned int i = 0; i < bufferVec.size(); ++i)
+    {
+        if (!bufferVec[i]->threadName.empty())
+        {
+            snprintf(number, sizeof(number), "%u", bufferVec[i]->threadID);
+            text += first ? "" : ",\n";
+            text += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+            text += number;
+            text += ",\"args\":{\"name\":";
+            AppendJSONString(&text, bufferVec[i]->threadName);
+            text += "}}";
+            first = false;
+        }
+        for (unsigned int e = 0; e < eventsVec[i].size(); ++e)
+        {
+            const ProfilerEvent& event = eventsVec[i][e];
+            text += first ? "" : ",\n";
+            text += "{\"name\":";
+            AppendJSONString(&text, event.name);
+            // Times in microseconds
+            snprintf(number, sizeof(number), ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f",
+                     (event.start - origin) / 1000.0, (event.end - event.start) / 1000.0);
+            text += number;
+            snprintf(number, sizeof(number), ",\"pid\":1,\"tid\":%u}", bufferVec[i]->threadID);
+            text += number;
+            first = false;
+        }
+    }
+    text += "\n]}\n";
+    ofstream file(fileName.c_str(), ios::binary);
+    file.write(text.data(), text.size());
+    if (!file)
+    {
+        cerr << "Error: Profiler::SaveChromeTrace: could not write '" << fileName << "'." << endl;
+        return false;
+    }
+    return true;
+}
+
+void VART::Profiler::EndFrame()
+{
+    long long now = Now();
+    lock_guard<mutex> lock(registryMutex);
+    // Totals of this frame, by name (literals of the same name may have different addresses)
+    map<string, Average> frameMap;
+    vector<ProfilerEvent> eventVec;
+    for (unsigned int i = 0; i < bufferVec.size(); ++i)
+    {
+        bufferVec[i]->framed = bufferVec[i]->Read(bufferVec[i]->framed, &eventVec);
+        map<const char*, pair<long long, unsigned int> > totalMap;
+        for (unsigned int e = 0; e < eventVec.size(); ++e)
+        {
+            pair<long long, unsigned int>& total = totalMap[eventVec[e].name];
+            total.first += eventVec[e].end - eventVec[e].start;
+            ++total.second;
+        }
+        for (map<const char*, pair<long long, unsigned int> >::iterator iter = totalMap.begin();
+             iter != totalMap.end(); ++iter)
+        {
+            Average& average = frameMap[iter->first];
+            average.milliseconds += iter->second.first / 1e6;
+            average.count += iter->second.second;
+        }
+    }
+    if (lastFrameEnd != 0)
+    {
+        Average& frame = frameMap["Frame"];
+        frame.milliseconds = (now - lastFrameEnd) / 1e6;
+        frame.count = 1;
+    }
+    lastFrameEnd = now;
+    // Exponential moving averages: zones that did not run count as zero
+    const double weight = 1.0 / max(averageFrames, 1u);
+    for (map<string, Average>::iterator iter = averageMap.begin(); iter != averageMap.end();
+         ++iter)
+    {
+        iter->second.milliseconds -= iter->second.milliseconds * weight;
+        iter->second.count -= iter->second.count * weight;
+    }
+    for (map<string, Average>::iterator iter = frameMap.begin(); iter != frameMap.end(); ++iter)
+    {
+        map<string, Average>::iterator found = averageMap.find(iter->first);
+        if (found == averageMap.end())
+        {
+            // First frame of a zone: start from its value
+            Average& average = averageMap[iter->first];
+            average.name = iter->first;
+            average.milliseconds = iter->second.milliseconds;
+            average.count = iter->second.count;
+        }
+        else
+        {
+            found->second.milliseconds += iter->second.milliseconds * weight;
+            found->second.count += iter->second.count * weight;
+        }
+    }
+}
+
+static bool SlowerThan(const VART::Profiler::Average& a, const VART::Profiler::Average& b)
+{
+    return a.milliseconds > b.milliseconds;
+}
+
+void VART::Profiler::GetAverages(vector<Average>* resultPtr)
+{
+    lock_guard<mutex> lock(registryMutex);
+    resultPtr->clear();
+    for (map<string, Average>::iterator iter = averageMap.begin(); iter != averageMap.end();
+         ++iter)
+        resultPtr->push_back(iter->second);
+    sort(resultPtr->begin(), resultPtr->end(), SlowerThan);
+}
@@ -0,0 +1,541 @@
+/// \file scenesnapshot.cpp
+/// \brief Implementation file for V-ART class "SceneSnapshot".
+/// \version $Revision: 1.1 $
+
+#include "vart/scenesnapshot.h"
+#include "vart/profiler.h"
+#include "vart/scene.h"
+#include "vart/light.h"
+#include "vart/material.h"
+#include "vart/meshobject.h"
+#include "vart/lazymeshobject.h"
+#include "vart/meshcache.h"
+#include "vart/sphere.h"
+#include "vart/cylinder.h"
+#include "vart/uniaxialjoint.h"
+#include "vart/biaxialjoint.h"
+#include "vart/polyaxialjoint.h"
+#include "vart/dof.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <set>
+
+using namespace std;
+
+const unsigned char VART::SceneSnapshot::VERSION = 1;
+
+VART::SceneSnapshot::SceneSnapshot() : offset(0), failed(false)
+{
+}
+
+bool VART::SceneSnapshot::Capture(Scene& scene)
+{
+    data.clear();
+    data.push_back('V'); data.push_back('S'); data.push_back('N'); data.push_back('P');
+    data.push_back(VERSION);
+    AppendString(scene.GetDescription());
+    list<const Light*> lightList = scene.GetLights();
+    Append(lightList.size());
+    for (list<const Light*>::iterator iter = lightList.begin(); iter != lightList.end(); ++iter)
+        AppendLight(**iter);
+    list<SceneNode*> objectList = scene.GetObjects();
+    Append(objectList.size());
+    for (list<SceneNode*>::iterator iter = objectList.begin(); iter != objectList.end(); ++iter)
+        if (!AppendNode(**iter))
+            return false;
+    return true;
+}
+
+void VART::SceneSnapshot::Append(unsigned long long value)
+{
+    while (value >= 0x80)
+    {
+        data.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back(static_cast<unsigned char>(value));
+}
+
+void VART::SceneSnapshot::AppendDouble(double value)
+{
+    unsigned long long bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (unsigned int i = 0; i < 8; ++i)
+        data.push_back(static_cast<unsigned char>(bits >> (i * 8)));
+}
+
+void VART::SceneSnapshot::AppendFloat(float value)
+{
+    unsigned int bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (unsigned int i = 0; i < 4; ++i)
+        data.push_back(static_cast<unsigned char>(bits >> (i * 8)));
+}
+
+void VART::SceneSnapshot::AppendString(const string& value)
+{
+    Append(value.size());
+    data.insert(data.end(), value.begin(), value.end());
+}
+
+void VART::SceneSnapshot::AppendMaterial(const Material& material)
+{
+    const Color* colors[] = { &material.GetDiffuseColor(), &material.GetSpecularColor(),
+                              &material.GetAmbientColor(), &material.GetEmissiveColor() };
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        data.push_back(colors[i]->GetR());
+        data.push_back(colors[i]->GetG());
+        data.push_back(colors[i]->GetB());
+        data.push_back(colors[i]->GetA());
+    }
+    AppendFloat(material.GetShininess());
+}
+
+void VART::SceneSnapshot::AppendLight(const Light& light)
+{
+    AppendString(light.GetDescription());
+    AppendFloat(light.GetIntensity());
+    AppendFloat(light.GetAmbientIntensity());
+    Color color = light.GetColor();
+    data.push_back(color.GetR());
+    data.push_back(color.GetG());
+    data.push_back(color.GetB());
+    data.push_back(color.GetA());
+    data.push_back(light.IsOn() ? 1 : 0);
+    Point4D location = light.GetLocation();
+    AppendDouble(location.GetX());
+    AppendDouble(location.GetY());
+    AppendDouble(location.GetZ());
+    AppendDouble(location.GetW());
+}
+
+bool VART::SceneSnapshot::AppendNode(const SceneNode& node)
+{
+    // Derived classes are tested before their bases
+    if (const Joint* jointPtr = dynamic_cast<const Joint*>(&node))
+    {
+        if (dynamic_cast<const UniaxialJoint*>(jointPtr))
+            data.push_back(UNIAXIAL_JOINT);
+        else if (dynamic_cast<const BiaxialJoint*>(jointPtr))
+            data.push_back(BIAXIAL_JOINT);
+        else
+            data.push_back(POLYAXIAL_JOINT);
+        AppendString(node.GetDescription());
+        list<Dof*> dofList;
+        const_cast<Joint*>(jointPtr)->GetDofs(&dofList);
+        Append(dofList.size());
+        for (list<Dof*>::iterator iter = dofList.begin(); iter != dofList.end(); ++iter)
+        {
+            const Dof& dof = **iter;
+            Point4D position = dof.GetPosition();
+            Point4D axis = dof.GetAxis();
+            AppendString(dof.GetDescription());
+            AppendDouble(position.GetX());
+            AppendDouble(position.GetY());
+            AppendDouble(position.GetZ());
+            AppendDouble(axis.GetX());
+            AppendDouble(axis.GetY());
+            AppendDouble(axis.GetZ());
+            AppendFloat(dof.GetMin());
+            AppendFloat(dof.GetMax());
+            AppendFloat(dof.GetRest());
+            AppendFloat(dof.GetCurrent());
+        }
+    }
+    else if (const Transform* transPtr = dynamic_cast<const Transform*>(&node))
+    {
+        data.push_back(TRANSFORM);
+        AppendString(node.GetDescription());
+        const double* matrix = transPtr->GetData();
+        for (unsigned int i = 0; i < 16; ++i)
+            AppendDouble(matrix[i]);
+    }
+    else if (const LazyMeshObject* lazyPtr = dynamic_cast<const LazyMeshObject*>(&node))
+    {
+        data.push_back(LAZY_MESH_OBJECT);
+        AppendString(node.GetDescription());
+        AppendString(lazyPtr->GetFileName());
+        // While loaded, the bounding box is the mesh's, which is the placeholder's too.
+        const BoundingBox& box = lazyPtr->GetBoundingBox();
+        AppendDouble(box.GetSmallerX());
+        AppendDouble(box.GetSmallerY());
+        AppendDouble(box.GetSmallerZ());
+        AppendDouble(box.GetGreaterX());
+        AppendDouble(box.GetGreaterY());
+        AppendDouble(box.GetGreaterZ());
+    }
+    else if (const MeshObject* meshObjectPtr = dynamic_cast<const MeshObject*>(&node))
+    {
+        if (meshObjectPtr->GetFileName().empty())
+        {
+            cerr << "Error: SceneSnapshot: mesh object '" << node.GetDescription()
+                 << "' was not read from a file." << endl;
+            return false;
+        }
+        data.push_back(MESH_OBJECT);
+        AppendString(node.GetDescription());
+        AppendString(meshObjectPtr->GetFileName());
+    }
+    else if (const Sphere* spherePtr = dynamic_cast<const Sphere*>(&node))
+    {
+        data.push_back(SPHERE);
+        AppendString(node.GetDescription());
+        AppendFloat(const_cast<Sphere*>(spherePtr)->GetRadius());
+        AppendMaterial(spherePtr->GetMaterial());
+    }
+    else if (const Cylinder* cylinderPtr = dynamic_cast<const Cylinder*>(&node))
+    {
+        Cylinder* ptr = const_cast<Cylinder*>(cylinderPtr);
+        data.push_back(CYLINDER);
+        AppendString(node.GetDescription());
+        AppendFloat(ptr->GetHeight());
+        AppendFloat(ptr->GetTopRadius());
+        AppendFloat(ptr->GetBottomRadius());
+        AppendMaterial(cylinderPtr->GetMaterial());
+    }
+    else if (const Light* lightPtr = dynamic_cast<const Light*>(&node))
+    {
+        data.push_back(LIGHT);
+        AppendLight(*lightPtr);
+    }
+    else
+    {
+        cerr << "Error: SceneSnapshot: cannot capture scene node '" << node.GetDescription()
+             << "'." << endl;
+        return false;
+    }
+    Append(node.childList.size());
+    list<SceneNode*>::const_iterator iter = node.childList.begin();
+    for (; iter != node.childList.end(); ++iter)
+        if (!AppendNode(**iter))
+            return false;
+    return true;
+}
+
+unsigned long long VART::SceneSnapshot::Read()
+{
+    unsigned long long value = 0;
+    unsigned int shift = 0;
+    unsigned char byte;
+    do {
+        if (offset >= data.size())
+        {
+            failed = true;
+            return 0;
+        }
+        byte = data[offset++];
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && (shift < 64));
+    return value;
+}
+
+double VART::SceneSnapshot::ReadDouble()
+{
+    if (offset + 8 > data.size())
+    {
+        failed = true;
+        return 0;
+    }
+    unsigned long long bits = 0;
+    for (unsigned int i = 0; i < 8; ++i)
+        bits |= static_cast<unsigned long long>(data[offset++]) << (i * 8);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+float VART::SceneSnapshot::ReadFloat()
+{
+    if (offset + 4 > data.size())
+    {
+        failed = true;
+        return 0;
+    }
+    unsigned int bits = 0;
+    for (unsigned int i = 0; i < 4; ++i)
+        bits |= static_cast<unsigned int>(data[offset++]) << (i * 8);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void VART::SceneSnapshot::ReadString(string* resultPtr)
+{
+    unsigned long long size = Read();
+    if (size > data.size() - offset)
+    {
+        failed = true;
+        resultPtr->clear();
+        return;
+    }
+    resultPtr->assign(data.begin() + offset, data.begin() + offset + size);
+    offset += size;
+}
+
+void VART::SceneSnapshot::ReadMaterial(Material* resultPtr)
+{
+    if (offset + 16 > data.size())
+    {
+        failed = true;
+        return;
+    }
+    Color colors[4];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        colors[i].SetRGBA(data[offset], data[offset+1], data[offset+2], data[offset+3]);
+        offset += 4;
+    }
+    resultPtr->SetDiffuseColor(colors[0]);
+    resultPtr->SetSpecularColor(colors[1]);
+    resultPtr->SetAmbientColor(colors[2]);
+    resultPtr->SetEmissiveColor(colors[3]);
+    resultPtr->SetShininess(ReadFloat());
+}
+
+void VART::SceneSnapshot::ReadLight(Light* resultPtr)
+{
+    string description;
+    ReadString(&description);
+    resultPtr->SetDescription(description);
+    resultPtr->SetIntensity(ReadFloat());
+    resultPtr->SetAmbientIntensity(ReadFloat());
+    if (offset + 5 > data.size())
+    {
+        failed = true;
+        return;
+    }
+    resultPtr->SetColor(Color(data[offset], data[offset+1], data[offset+2], data[offset+3]));
+    resultPtr->Turn(data[offset+4] != 0);
+    offset += 5;
+    double coords[4];
+    for (unsigned int i = 0; i < 4; ++i)
+        coords[i] = ReadDouble();
+    resultPtr->SetLocation(Point4D(coords[0], coords[1], coords[2], coords[3]));
+}
+
+VART::SceneNode* VART::SceneSnapshot::ReadNode()
+{
+    if (offset >= data.size())
+    {
+        failed = true;
+        return NULL;
+    }
+    SceneNode* nodePtr = NULL;
+    string description;
+    unsigned char tag = data[offset++];
+    if (tag != LIGHT)
+        ReadString(&description);
+    switch (tag)
+    {
+        case UNIAXIAL_JOINT:
+        case BIAXIAL_JOINT:
+        case POLYAXIAL_JOINT:
+        {
+            Joint* jointPtr;
+            if (tag == UNIAXIAL_JOINT)
+                jointPtr = new UniaxialJoint;
+            else if (tag == BIAXIAL_JOINT)
+                jointPtr = new BiaxialJoint;
+            else
+                jointPtr = new PolyaxialJoint;
+            nodePtr = jointPtr;
+            unsigned long long numDofs = Read();
+            for (unsigned long long i = 0; (i < numDofs) && !failed; ++i)
+            {
+                Dof* dofPtr = new Dof;
+                dofPtr->autoDelete = true;
+                string dofDescription;
+                ReadString(&dofDescription);
+                double coords[6];
+                for (unsigned int j = 0; j < 6; ++j)
+                    coords[j] = ReadDouble();
+                Point4D position(coords[0], coords[1], coords[2], 1);
+                Point4D axis(coords[3], coords[4], coords[5], 0);
+                float min = ReadFloat();
+                float max = ReadFloat();
+                dofPtr->Set(axis, position, min, max);
+                dofPtr->SetDescription(dofDescription);
+                dofPtr->SetRest(ReadFloat());
+                jointPtr->AddDof(dofPtr);
+                dofPtr->SetCurrent(ReadFloat());
+            }
+            if (numDofs > 0)
+                jointPtr->MakeLim();
+            break;
+        }
+        case TRANSFORM:
+        {
+            double matrix[16];
+            for (unsigned int i = 0; i < 16; ++i)
+                matrix[i] = ReadDouble();
+            Transform* transPtr = new Transform;
+            transPtr->SetData(matrix);
+            nodePtr = transPtr;
+            break;
+        }
+        case LAZY_MESH_OBJECT:
+        {
+            string fileName;
+            ReadString(&fileName);
+            double box[6];
+            for (unsigned int i = 0; i < 6; ++i)
+                box[i] = ReadDouble();
+            nodePtr = new LazyMeshObject(fileName, description,
+                                         BoundingBox(box[0], box[1], box[2],
+                                                     box[3], box[4], box[5]));
+            break;
+        }
+        case MESH_OBJECT:
+        {
+            PendingMesh pending;
+            ReadString(&pending.fileName);
+            pending.meshObjectPtr = new MeshObject;
+            pendingMeshVec.push_back(pending);
+            nodePtr = pending.meshObjectPtr;
+            break;
+        }
+        case SPHERE:
+        {
+            Sphere* spherePtr = new Sphere;
+            spherePtr->SetRadius(ReadFloat());
+            Material material;
+            ReadMaterial(&material);
+            spherePtr->SetMaterial(material);
+            nodePtr = spherePtr;
+            break;
+        }
+        case CYLINDER:
+        {
+            Cylinder* cylinderPtr = new Cylinder;
+            cylinderPtr->SetHeight(ReadFloat());
+            cylinderPtr->SetTopRadius(ReadFloat());
+            cylinderPtr->SetBottomRadius(ReadFloat());
+            Material material;
+            ReadMaterial(&material);
+            cylinderPtr->SetMaterial(material);
+            nodePtr = cylinderPtr;
+            break;
+        }
+        case LIGHT:
+        {
+            Light* lightPtr = new Light;
+            ReadLight(lightPtr);
+            nodePtr = lightPtr;
+            break;
+        }
+        default:
+            cerr << "Error: SceneSnapshot: unknown node type " << static_cast<int>(tag)
+                 << "." << endl;
+            failed = true;
+            return NULL;
+    }
+    nodePtr->autoDelete = true;
+    if (tag != LIGHT)
+        nodePtr->SetDescription(description);
+    unsigned long long numChildren = Read();
+    for (unsigned long long i = 0; (i < numChildren) && !failed; ++i)
+    {
+        SceneNode* childPtr = ReadNode();
+        if (childPtr)
+            nodePtr->AddChild(*childPtr);
+    }
+    return nodePtr;
+}
+
+void VART::SceneSnapshot::DeleteNode(SceneNode* nodePtr)
+{
+    nodePtr->AutoDeleteChildren();
+    delete nodePtr;
+}
+
+bool VART::SceneSnapshot::Restore(Scene* scenePtr)
+{
+    VART_PROFILE_ZONE("SceneSnapshot::Restore");
+    if ((data.size() < 5) || (memcmp(&data[0], "VSNP", 4) != 0) || (data[4] != VERSION))
+    {
+        cerr << "Error: SceneSnapshot: invalid stream." << endl;
+        return false;
+    }
+    offset = 5;
+    failed = false;
+    pendingMeshVec.clear();
+    string description;
+    ReadString(&description);
+    list<Light*> lightList;
+    unsigned long long numLights = Read();
+    for (unsigned long long i = 0; (i < numLights) && !failed; ++i)
+    {
+        Light* lightPtr = new Light;
+        lightPtr->autoDelete = true;
+        ReadLight(lightPtr);
+        lightList.push_back(lightPtr);
+    }
+    list<SceneNode*> objectList;
+    unsigned long long numObjects = Read();
+    for (unsigned long long i = 0; (i < numObjects) && !failed; ++i)
+    {
+        SceneNode* nodePtr = ReadNode();
+        if (nodePtr)
+            objectList.push_back(nodePtr);
+    }
+    // Read mesh files on worker threads, then fill mesh objects, children first (so that
+    // recursive bounding boxes include them).
+    set<string> fileSet;
+    for (unsigned int i = 0; (i < pendingMeshVec.size()) && !failed; ++i)
+        if (fileSet.insert(pendingMeshVec[i].fileName).second)
+            MeshCache::Instance().Request(pendingMeshVec[i].fileName);
+    bool result = !failed;
+    for (unsigned int i = pendingMeshVec.size(); result && (i > 0); --i)
+    {
+        PendingMesh& pending = pendingMeshVec[i-1];
+        result = MeshCache::Instance().GetMeshObject(pending.fileName,
+                                                     pending.meshObjectPtr->GetDescription(),
+                                                     pending.meshObjectPtr);
+    }
+    for (set<string>::iterator iter = fileSet.begin(); iter != fileSet.end(); ++iter)
+        MeshCache::Instance().Release(*iter);
+    pendingMeshVec.clear();
+    if (!result)
+    {
+        if (failed)
+            cerr << "Error: SceneSnapshot: truncated stream." << endl;
+        for (list<Light*>::iterator iter = lightList.begin(); iter != lightList.end(); ++iter)
+            delete *iter;
+        for (list<SceneNode*>::iterator iter = objectList.begin(); iter != objectList.end();
+             ++iter)
+            DeleteNode(*iter);
+        return false;
+    }
+    scenePtr->SetDescription(description);
+    for (list<Light*>::iterator iter = lightList.begin(); iter != lightList.end(); ++iter)
+        scenePtr->AddLight(*iter);
+    for (list<SceneNode*>::iterator iter = objectList.begin(); iter != objectList.end(); ++iter)
+        scenePtr->AddObject(*iter);
+    return true;
+}
+
+bool VART::SceneSnapshot::SaveToFile(const string& fileName) const
+{
+    ofstream file(fileName.c_str(), ios::out | ios::binary);
+    if (!file)
+        return false;
+    if (!data.empty())
+        file.write(reinterpret_cast<const char*>(&data[0]), data.size());
+    return static_cast<bool>(file);
+}
+
+bool VART::SceneSnapshot::LoadFromFile(const string& fileName)
+{
+    ifstream file(fileName.c_str(), ios::in | ios::binary);
+    if (!file)
+    {
+        cerr << "Error: SceneSnapshot: could not open '" << fileName << "'." << endl;
+        return false;
+    }
+    data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    return true;
+}
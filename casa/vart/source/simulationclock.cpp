@@ -0,0 +1,65 @@
+/// \file simulationclock.cpp
+/// \brief Implementation file for V-ART class "SimulationClock".
+/// \version $Revision: 1.1 $
+
+#include "vart/simulationclock.h"
+
+//#include <iostream>
+using namespace std;
+
+// Initialization of static attributes
+VART::SimulationClock* VART::SimulationClock::currentPtr = NULL;
+
+VART::SimulationClock::SimulationClock() : step(1.0/60.0), maxFrameTime(0.25), offline(false)
+{
+    Reset();
+}
+
+VART::SimulationClock::SimulationClock(double stepSeconds) : step(stepSeconds),
+                                                            maxFrameTime(0.25), offline(false)
+{
+    Reset();
+}
+
+void VART::SimulationClock::Reset()
+{
+    accumulator = 0.0;
+    stepCount = 0;
+    simTime = Time(0.0);
+    lastRealTime.SetMonotonic();
+}
+
+unsigned int VART::SimulationClock::Update()
+{
+    if (offline)
+        accumulator += step;
+    else
+    {
+        Time currentTime;
+        currentTime.SetMonotonic();
+        double elapsed = (currentTime - lastRealTime).AsDouble();
+        if (elapsed > maxFrameTime)
+            elapsed = maxFrameTime;
+        accumulator += elapsed;
+        lastRealTime = currentTime;
+    }
+    return static_cast<unsigned int>(accumulator / step);
+}
+
+bool VART::SimulationClock::Step()
+{
+    if (accumulator < step)
+        return false;
+    accumulator -= step;
+    ++stepCount;
+    simTime = Time(stepCount * step);
+    return true;
+}
+
+// static
+VART::Time VART::SimulationClock::NOW()
+{
+    if (currentPtr)
+        return currentPtr->simTime;
+    return Time::NOW();
+}
@@ -3,7 +3,10 @@
 /// \version $Revision: 1.9 $
 
 #include "vart/xmlscene.h"
+#include "vart/profiler.h"
 #include "vart/meshobject.h"
+#include "vart/lazymeshobject.h"
+#include "vart/meshcache.h"
 #include "vart/dof.h"
 #include "vart/sphere.h"
 #include "vart/cylinder.h"
@@ -20,30 +23,32 @@ using XERCES_CPP_NAMESPACE::DOMNode;
 using XERCES_CPP_NAMESPACE::DOMNamedNodeMap;
 using namespace std;
 
-VART::XmlScene::XmlScene()
+VART::XmlScene::XmlScene() : lazyLoading(false)
 {
 }
 
 bool VART::XmlScene::LoadFromFile(const std::string& fileName)
 {
-    meshMap::iterator iterMesh;
-    meshObjMap::iterator iterMeshObj;
-
+    VART_PROFILE_ZONE("XmlScene::LoadFromFile");
     if (ParseFile(fileName))
     { //XML parser sucessfull
-        //~ istringstream stream;
-        //...load the elements of the scene,
-        bool result = LoadScene( VART::File::GetPathFromString(fileName) );
-        // Terminate Xerces
-        Terminate();
-        // ...delete unused mesh objects and clear the maps.
-        for(iterMesh = mapMesh.begin(); iterMesh != mapMesh.end(); ++iterMesh)
+        string basePath = VART::File::GetPathFromString(fileName);
+        // Start reading mesh files, then load the elements of the scene, which wait for the
+        // meshes they need.
+        if (!lazyLoading)
+            RequestMeshFiles(basePath);
+        bool result = LoadScene(basePath);
+        // Discard placeholders used to find bounding boxes
+        map<string, list<LazyMeshObject*> >::iterator mapIter = placeholderMap.begin();
+        for (; mapIter != placeholderMap.end(); ++mapIter)
         {
-            for(iterMeshObj = mapMeshObj.begin(); iterMeshObj != mapMeshObj.end(); ++iterMeshObj)
-                delete iterMeshObj->second;
-            mapMeshObj.clear();
+            list<LazyMeshObject*>::iterator iter = mapIter->second.begin();
+            for (; iter != mapIter->second.end(); ++iter)
+                delete *iter;
         }
-        mapMesh.clear();
+        placeholderMap.clear();
+        // Terminate Xerces
+        Terminate();
         return result;
     }
 
@@ -54,6 +59,23 @@ bool VART::XmlScene::LoadFromFile(const std::string& fileName)
     }
 }
 
+void VART::XmlScene::RequestMeshFiles(const std::string& basePath)
+{
+    DOMNodeList* meshList = documentPtr->getElementsByTagName(XercesString("meshobject"));
+    for (unsigned int i = 0; i < meshList->getLength(); ++i)
+    {
+        DOMNamedNodeMap* attrPt = meshList->item(i)->getAttributes();
+        DOMNode* fileNode = attrPt->getNamedItem(XercesString("filename"));
+        DOMNode* typeNode = attrPt->getNamedItem(XercesString("type"));
+        if (fileNode && typeNode && (TempCString(typeNode->getNodeValue()) == "obj"))
+        {
+            string fileName = basePath + string(TempCString(fileNode->getNodeValue()));
+            MeshCache::Instance().Request(fileName);
+            meshFileList.push_back(fileName);
+        }
+    }
+}
+
 bool VART::XmlScene::LoadScene(const std::string& basePath)
 // File contents come from xerces' structure at documentPtr. The "basePath" is used to fill in
 // relative names in the XML file.
@@ -93,68 +115,47 @@ bool VART::XmlScene::LoadScene(const std::string& basePath)
 }
 
 VART::MeshObject* VART::XmlScene::LoadMeshFromFile(string filen, string type, string meshName)
+// Files have been requested by RequestMeshFiles. Each mesh object is a copy of the one in the
+// cache, so that the same mesh object may be used many times. Lazy mesh objects are copies of
+// placeholders read from the file.
 {
-    meshMap::iterator iterMesh;
-    meshObjMap::iterator iterMeshObj;
-    list<VART::MeshObject*> meshObjectList;
-    list<VART::MeshObject*>::iterator iter;
-    VART::MeshObject* finalMesh;
-    VART::MeshObject* result = NULL;
-    finalMesh = new VART::MeshObject;
-    finalMesh->autoDelete = true;
-    iterMesh = mapMesh.find(filen);
-    int i=0;
-
-    if(iterMesh != mapMesh.end())
-    {//The file has been loaded
-        iterMeshObj = mapMeshObj.find(meshName);
-        if(iterMeshObj != mapMeshObj.end())
-        {//The mesh has been loaded
-            i++;
-            finalMesh = iterMeshObj->second;
-            mapMeshObj.erase(iterMeshObj);
-            return finalMesh;
-        }
-
-        else
-        {
-            cerr<<"Error! Mesh "<<meshName<<" not found in file "<<filen<<endl;
-            return NULL;
-        }
+    if (type != "obj")
+    {
+        //FixMe. Must load others types of file.
+        cerr << "Error: XmlScene: unsupported mesh file type '" << type << "'." << endl;
+        return NULL;
     }
-
-    else
+    if (lazyLoading)
     {
-        //The file hasn't been loaded
-        if(type == "obj")
+        map<string, list<LazyMeshObject*> >::iterator mapIter = placeholderMap.find(filen);
+        if (mapIter == placeholderMap.end())
         {
-            meshObjectList.clear();
-            VART::MeshObject::ReadFromOBJ(filen, &meshObjectList);
-            for (iter = meshObjectList.begin(); iter != meshObjectList.end(); ++iter)
-            {
-                if ((*iter)->GetDescription() == meshName)
-                {
-                    result=*iter;
-                }
-                else
-                {
-                    finalMesh = *iter;
-                    mapMeshObj[finalMesh->GetDescription()] = finalMesh;
-                }
-            }
-            mapMesh[filen] = mapMeshObj;
-            if (result == NULL)
-                cerr << "Error: No mesh object named " << meshName << " was found!" << endl;
-            //result->bBoxShow = true;
-            return result;
+            mapIter = placeholderMap.insert(make_pair(filen, list<LazyMeshObject*>())).first;
+            LazyMeshObject::ReadFromOBJ(filen, &mapIter->second);
         }
-        else
+        list<LazyMeshObject*>::iterator iter = mapIter->second.begin();
+        for (; iter != mapIter->second.end(); ++iter)
         {
-            //FixMe. Must load others types of file.
+            if ((*iter)->GetDescription() == meshName)
+            {
+                MeshObject* lazyPtr = static_cast<MeshObject*>((*iter)->Copy());
+                lazyPtr->autoDelete = true;
+                return lazyPtr;
+            }
         }
-    //result->bBoxShow = true;
-    return result;
+        cerr << "Error: XmlScene: mesh object '" << meshName << "' not found in '" << filen
+             << "'." << endl;
+        return NULL;
+    }
+    VART::MeshObject* result = new VART::MeshObject;
+    result->autoDelete = true;
+    result->SetDescription(meshName);
+    if (!MeshCache::Instance().GetMeshObject(filen, meshName, result))
+    {
+        delete result;
+        return NULL;
     }
+    return result;
 }
 
 VART::SceneNode* VART::XmlScene::LoadSceneNode(DOMNode* sceneList, const std::string& basePath)
@@ -886,4 +887,7 @@ void VART::XmlScene::loadDofs(DOMNode* node, list<VART::Dof*>* dofs)
 
 VART::XmlScene::~XmlScene()
 {
+    list<string>::iterator iter = meshFileList.begin();
+    for (; iter != meshFileList.end(); ++iter)
+        MeshCache::Instance().Release(*iter);
 }
@@ -0,0 +1,492 @@
+/// \file xmlstreamscene.cpp
+/// \brief Implementation file for V-ART class "XmlStreamScene".
+/// \version $Revision: 1.1 $
+
+#include "vart/xmlstreamscene.h"
+#include "vart/profiler.h"
+#include "vart/meshobject.h"
+#include "vart/lazymeshobject.h"
+#include "vart/meshcache.h"
+#include "vart/dof.h"
+#include "vart/sphere.h"
+#include "vart/cylinder.h"
+#include "vart/light.h"
+#include "vart/biaxialjoint.h"
+#include "vart/polyaxialjoint.h"
+#include "vart/uniaxialjoint.h"
+#include "vart/file.h"
+#include <map>
+
+using namespace std;
+
+// Element and attribute names, in the order of XmlStreamScene::Name
+static const char* NAMES[] = {
+    "scene", "camera", "node", "sphere", "cylinder", "meshobject", "directionallight",
+    "spotlight", "pointlight", "transform", "joint", "bezier", "radius", "height",
+    "material", "intensity", "ambientIntensity", "color", "enabled", "position",
+    "matrix", "translation", "scale", "rotation", "dof", "axis", "range",
+    "description", "value", "r", "g", "b", "red", "green", "blue", "alpha", "x", "y", "z",
+    "filename", "type", "radians", "min", "max", "rest",
+    "m00", "m01", "m02", "m03", "m10", "m11", "m12", "m13",
+    "m20", "m21", "m22", "m23", "m30", "m31", "m32", "m33", NULL };
+
+VART::XmlStreamScene::XmlStreamScene() : dofPtr(NULL), lazyLoading(false)
+{
+}
+
+bool VART::XmlStreamScene::LoadFromFile(const string& fileName)
+{
+    VART_PROFILE_ZONE("XmlStreamScene::LoadFromFile");
+    XmlReader reader;
+    for (unsigned int i = 0; NAMES[i]; ++i)
+        reader.Intern(NAMES[i]);
+    if (!reader.Open(fileName))
+    {
+        cerr << "Error: XmlStreamScene: " << reader.GetErrorMessage() << endl;
+        return false;
+    }
+    basePath = File::GetPathFromString(fileName);
+    nodeStack.clear();
+    dofPtr = NULL;
+    bool result = true;
+    XmlReader::Event event = reader.Next();
+    while (result && (event != XmlReader::END_OF_DOCUMENT))
+    {
+        if (event == XmlReader::PARSE_ERROR)
+        {
+            cerr << "Error: XmlStreamScene: " << fileName << ": " << reader.GetErrorMessage()
+                 << endl;
+            result = false;
+        }
+        else
+        {
+            if (event == XmlReader::START_ELEMENT)
+                result = StartElement(reader);
+            else
+                result = EndElement(reader);
+            event = reader.Next();
+        }
+    }
+    // Fill mesh objects, children first (so that recursive bounding boxes include them).
+    for (unsigned int i = pendingMeshVec.size(); result && (i > 0); --i)
+    {
+        PendingMesh& pending = pendingMeshVec[i-1];
+        MeshObject* meshObjectPtr = pending.meshObjectPtr;
+        result = MeshCache::Instance().GetMeshObject(pending.fileName,
+                                                     meshObjectPtr->GetDescription(),
+                                                     meshObjectPtr);
+    }
+    pendingMeshVec.clear();
+    if (result)
+        result = BoundLazyMeshes();
+    lazyMeshVec.clear();
+    return result;
+}
+
+bool VART::XmlStreamScene::BoundLazyMeshes()
+{
+    // Placeholders found in each file, read only if some bounds are missing
+    map<string, list<LazyMeshObject*> > placeholderMap;
+    bool result = true;
+    for (unsigned int i = lazyMeshVec.size(); result && (i > 0); --i)
+    {
+        LazyMesh& lazy = lazyMeshVec[i-1];
+        LazyMeshObject* meshObjectPtr = lazy.meshObjectPtr;
+        if (lazy.hasMin && lazy.hasMax)
+        {
+            BoundingBox box(lazy.min[0], lazy.min[1], lazy.min[2],
+                            lazy.max[0], lazy.max[1], lazy.max[2]);
+            meshObjectPtr->SetPlaceholderBox(box);
+            continue;
+        }
+        map<string, list<LazyMeshObject*> >::iterator mapIter =
+            placeholderMap.find(meshObjectPtr->GetFileName());
+        if (mapIter == placeholderMap.end())
+        {
+            mapIter = placeholderMap.insert(make_pair(meshObjectPtr->GetFileName(),
+                                                      list<LazyMeshObject*>())).first;
+            LazyMeshObject::ReadFromOBJ(mapIter->first, &mapIter->second);
+        }
+        list<LazyMeshObject*>::iterator iter = mapIter->second.begin();
+        while ((iter != mapIter->second.end())
+               && ((*iter)->GetDescription() != meshObjectPtr->GetDescription()))
+            ++iter;
+        if (iter == mapIter->second.end())
+        {
+            cerr << "Error: XmlStreamScene: mesh object '" << meshObjectPtr->GetDescription()
+                 << "' not found in '" << meshObjectPtr->GetFileName() << "'." << endl;
+            result = false;
+        }
+        else
+            meshObjectPtr->SetPlaceholderBox((*iter)->GetBoundingBox());
+    }
+    map<string, list<LazyMeshObject*> >::iterator mapIter = placeholderMap.begin();
+    for (; mapIter != placeholderMap.end(); ++mapIter)
+    {
+        list<LazyMeshObject*>::iterator iter = mapIter->second.begin();
+        for (; iter != mapIter->second.end(); ++iter)
+            delete *iter;
+    }
+    return result;
+}
+
+bool VART::XmlStreamScene::StartElement(XmlReader& reader)
+{
+    unsigned int name = reader.GetName();
+    if (name == NODE)
+    {
+        if (!nodeStack.empty() && (nodeStack.back().nodePtr == NULL))
+        {
+            cerr << "Error: XmlStreamScene: node without content (line " << reader.GetLine()
+                 << ")." << endl;
+            return false;
+        }
+        nodeStack.push_back(NodeFrame());
+        return true;
+    }
+    if (nodeStack.empty()) // cameras and elements outside nodes are ignored
+        return true;
+    NodeFrame& frame = nodeStack.back();
+    if (reader.GetParentName() == NODE)
+    { // The first child element defines the scene node, others must be nodes
+        if (frame.content != XmlReader::NO_NAME)
+        {
+            cerr << "Error: XmlStreamScene: unexpected '" << reader.GetNameString(name)
+                 << "' element (line " << reader.GetLine() << ")." << endl;
+            return false;
+        }
+        frame.content = name;
+        frame.nodePtr = CreateContent(reader);
+        return frame.nodePtr != NULL;
+    }
+    ReadProperty(reader);
+    return true;
+}
+
+bool VART::XmlStreamScene::EndElement(XmlReader& reader)
+{
+    unsigned int name = reader.GetName();
+    if ((name == DOF) && dofPtr)
+    {
+        dofPtr->Set(dofAxis, dofPosition, dofMin, dofMax);
+        dofPtr->SetDescription(dofDescription);
+        dofPtr->SetRest(dofRest);
+        static_cast<Joint*>(nodeStack.back().nodePtr)->AddDof(dofPtr);
+        dofPtr = NULL;
+    }
+    else if (name == NODE)
+    {
+        SceneNode* nodePtr = nodeStack.back().nodePtr;
+        nodeStack.pop_back();
+        if (nodePtr == NULL)
+        {
+            cerr << "Error: XmlStreamScene: empty node (line " << reader.GetLine() << ")."
+                 << endl;
+            return false;
+        }
+        if (!nodeStack.empty())
+            nodeStack.back().nodePtr->AddChild(*nodePtr);
+        else
+        {
+            Light* lightPtr = dynamic_cast<Light*>(nodePtr);
+            if (lightPtr)
+                AddLight(lightPtr);
+            else
+                AddObject(nodePtr);
+        }
+    }
+    return true;
+}
+
+VART::SceneNode* VART::XmlStreamScene::CreateContent(XmlReader& reader)
+{
+    string description;
+    reader.GetAttribute(DESCRIPTION, &description);
+    switch (reader.GetName())
+    {
+        case SPHERE:
+        {
+            Sphere* spherePtr = new Sphere;
+            spherePtr->autoDelete = true;
+            spherePtr->SetDescription(description);
+            return spherePtr;
+        }
+        case CYLINDER:
+        {
+            Cylinder* cylinderPtr = new Cylinder;
+            cylinderPtr->autoDelete = true;
+            cylinderPtr->SetDescription(description);
+            return cylinderPtr;
+        }
+        case MESHOBJECT:
+        {
+            string fileName;
+            string type;
+            reader.GetAttribute(FILENAME, &fileName);
+            reader.GetAttribute(TYPE, &type);
+            if (type != "obj")
+            {
+                cerr << "Error: XmlStreamScene: unsupported mesh file type '" << type << "'."
+                     << endl;
+                return NULL;
+            }
+            if (lazyLoading)
+            {
+                LazyMeshObject* lazyPtr = new LazyMeshObject(basePath + fileName, description,
+                                                             BoundingBox());
+                lazyPtr->autoDelete = true;
+                lazyMeshVec.push_back(LazyMesh(lazyPtr));
+                return lazyPtr;
+            }
+            PendingMesh pending;
+            pending.fileName = basePath + fileName;
+            MeshCache::Instance().Request(pending.fileName);
+            meshFileList.push_back(pending.fileName);
+            pending.meshObjectPtr = new MeshObject;
+            pending.meshObjectPtr->autoDelete = true;
+            pending.meshObjectPtr->SetDescription(description);
+            pendingMeshVec.push_back(pending);
+            return pending.meshObjectPtr;
+        }
+        case DIRECTIONALLIGHT:
+        case SPOTLIGHT:
+        case POINTLIGHT:
+        {
+            Light* lightPtr = new Light;
+            lightPtr->autoDelete = true;
+            lightPtr->SetDescription(description);
+            return lightPtr;
+        }
+        case TRANSFORM:
+        {
+            Transform* transPtr = new Transform;
+            transPtr->autoDelete = true;
+            transPtr->MakeIdentity();
+            transPtr->SetDescription(description);
+            return transPtr;
+        }
+        case JOINT:
+        {
+            Joint* jointPtr;
+            if (reader.AttributeEquals(TYPE, "biaxial"))
+                jointPtr = new BiaxialJoint;
+            else if (reader.AttributeEquals(TYPE, "polyaxial"))
+                jointPtr = new PolyaxialJoint;
+            else if (reader.AttributeEquals(TYPE, "uniaxial"))
+                jointPtr = new UniaxialJoint;
+            else
+            {
+                cerr << "Error: XmlStreamScene: unknown joint type (line " << reader.GetLine()
+                     << ")." << endl;
+                return NULL;
+            }
+            jointPtr->autoDelete = true;
+            jointPtr->SetDescription(description);
+            // Start DOF properties from scratch
+            dofAxis = Point4D();
+            dofPosition = Point4D();
+            dofMin = dofMax = dofRest = 0;
+            return jointPtr;
+        }
+        default:
+            cerr << "Error: XmlStreamScene: unsupported element '"
+                 << reader.GetNameString(reader.GetName()) << "' (line " << reader.GetLine()
+                 << ")." << endl;
+            return NULL;
+    }
+}
+
+void VART::XmlStreamScene::ReadProperty(XmlReader& reader)
+// Attributes missing from the file leave the corresponding values at zero.
+{
+    const NodeFrame& frame = nodeStack.back();
+    unsigned int name = reader.GetName();
+    unsigned int parent = reader.GetParentName();
+    float x = 0, y = 0, z = 0;
+    int r = 0, g = 0, b = 0, a = 0;
+
+    // DOFs (inside joints) and their properties
+    if (frame.content == JOINT)
+    {
+        if ((name == DOF) && (parent == JOINT))
+        {
+            dofPtr = new Dof;
+            dofPtr->autoDelete = true;
+            dofDescription.clear();
+            reader.GetAttribute(DESCRIPTION, &dofDescription);
+        }
+        else if (dofPtr && (parent == DOF))
+        {
+            if (name == POSITION)
+            {
+                reader.GetAttribute(X, &x);
+                reader.GetAttribute(Y, &y);
+                reader.GetAttribute(Z, &z);
+                dofPosition.SetXYZW(x, y, z, 1);
+            }
+            else if (name == AXIS)
+            {
+                reader.GetAttribute(X, &x);
+                reader.GetAttribute(Y, &y);
+                reader.GetAttribute(Z, &z);
+                dofAxis.SetXYZW(x, y, z, 0);
+                dofAxis.Normalize();
+            }
+            else if (name == RANGE)
+            {
+                reader.GetAttribute(MIN, &dofMin);
+                reader.GetAttribute(MAX, &dofMax);
+                reader.GetAttribute(REST, &dofRest);
+            }
+        }
+        return;
+    }
+    // Everything else is a direct child of the content element
+    if (parent != frame.content)
+        return;
+    switch (frame.content)
+    {
+        case SPHERE:
+        case CYLINDER:
+            if ((name == RADIUS) && reader.GetAttribute(VALUE, &x))
+            {
+                if (frame.content == SPHERE)
+                    static_cast<Sphere*>(frame.nodePtr)->SetRadius(x);
+                else
+                    static_cast<Cylinder*>(frame.nodePtr)->SetRadius(x);
+            }
+            else if ((name == HEIGHT) && (frame.content == CYLINDER)
+                     && reader.GetAttribute(VALUE, &x))
+                static_cast<Cylinder*>(frame.nodePtr)->SetHeight(x);
+            else if (name == MATERIAL)
+            {
+                reader.GetAttribute(R, &r);
+                reader.GetAttribute(G, &g);
+                reader.GetAttribute(B, &b);
+                Material material(Color(static_cast<unsigned char>(r),
+                                        static_cast<unsigned char>(g),
+                                        static_cast<unsigned char>(b)));
+                if (frame.content == SPHERE)
+                    static_cast<Sphere*>(frame.nodePtr)->SetMaterial(material);
+                else
+                    static_cast<Cylinder*>(frame.nodePtr)->SetMaterial(material);
+            }
+            break;
+        case DIRECTIONALLIGHT:
+        case SPOTLIGHT:
+        case POINTLIGHT:
+        {
+            Light* lightPtr = static_cast<Light*>(frame.nodePtr);
+            if ((name == INTENSITY) && reader.GetAttribute(VALUE, &x))
+                lightPtr->SetIntensity(x);
+            else if ((name == AMBIENTINTENSITY) && reader.GetAttribute(VALUE, &x))
+                lightPtr->SetAmbientIntensity(x);
+            else if (name == COLOR)
+            {
+                reader.GetAttribute(RED, &r);
+                reader.GetAttribute(GREEN, &g);
+                reader.GetAttribute(BLUE, &b);
+                if (frame.content == DIRECTIONALLIGHT)
+                {
+                    reader.GetAttribute(ALPHA, &a);
+                    lightPtr->SetColor(Color(r, g, b, a));
+                }
+                else
+                    lightPtr->SetColor(Color(r, g, b));
+            }
+            else if (name == ENABLED)
+            {
+                if (reader.AttributeEquals(VALUE, "false"))
+                    lightPtr->Turn(false);
+                else
+                {
+                    if (!reader.AttributeEquals(VALUE, "true"))
+                    {
+                        string value;
+                        reader.GetAttribute(VALUE, &value);
+                        cerr << "XmlStreamScene::LoadFromFile: Error at '"
+                             << reader.GetNameString(frame.content) << "' attribute: "
+                             << "unknown value for 'enabled': '" << value
+                             << "'. Assuming 'true'.\n";
+                    }
+                    lightPtr->Turn(true);
+                }
+            }
+            else if (name == POSITION)
+            {
+                reader.GetAttribute(X, &x);
+                reader.GetAttribute(Y, &y);
+                reader.GetAttribute(Z, &z);
+                lightPtr->SetLocation(Point4D(x, y, z, 1.0));
+            }
+            break;
+        }
+        case TRANSFORM:
+        {
+            Transform* transPtr = static_cast<Transform*>(frame.nodePtr);
+            if (name == MATRIX)
+            {
+                double data[16];
+                for (unsigned int i = 0; i < 16; ++i)
+                {
+                    x = 0;
+                    reader.GetAttribute(M00 + i, &x);
+                    data[i] = x;
+                }
+                transPtr->SetData(data);
+            }
+            else if (name == TRANSLATION)
+            {
+                reader.GetAttribute(X, &x);
+                reader.GetAttribute(Y, &y);
+                reader.GetAttribute(Z, &z);
+                transPtr->MakeTranslation(Point4D(x, y, z, 0));
+            }
+            else if (name == SCALE)
+            {
+                reader.GetAttribute(X, &x);
+                reader.GetAttribute(Y, &y);
+                reader.GetAttribute(Z, &z);
+                transPtr->MakeScale(x, y, z);
+            }
+            else if (name == ROTATION)
+            {
+                reader.GetAttribute(RADIANS, &x);
+                if (reader.AttributeEquals(AXIS, "x"))
+                    transPtr->MakeXRotation(x);
+                else if (reader.AttributeEquals(AXIS, "y"))
+                    transPtr->MakeYRotation(x);
+                else if (reader.AttributeEquals(AXIS, "z"))
+                    transPtr->MakeZRotation(x);
+            }
+            break;
+        }
+        case MESHOBJECT:
+            // Mesh objects ignore their materials (as in XmlScene). Lazy ones may have bounds.
+            if (lazyLoading && ((name == MIN) || (name == MAX)))
+            {
+                LazyMesh& lazy = lazyMeshVec.back();
+                double* coordPtr = (name == MIN) ? lazy.min : lazy.max;
+                reader.GetAttribute(X, &x);
+                reader.GetAttribute(Y, &y);
+                reader.GetAttribute(Z, &z);
+                coordPtr[0] = x;
+                coordPtr[1] = y;
+                coordPtr[2] = z;
+                if (name == MIN)
+                    lazy.hasMin = true;
+                else
+                    lazy.hasMax = true;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+VART::XmlStreamScene::~XmlStreamScene()
+{
+    list<string>::iterator iter = meshFileList.begin();
+    for (; iter != meshFileList.end(); ++iter)
+        MeshCache::Instance().Release(*iter);
+}
@@ -6,6 +6,7 @@
 #define VART_TRANSFORM_H
 
 #include "vart/point4d.h"
+#include "vart/matrix4.h"
 #include "vart/scenenode.h"
 #include <iostream>
 #include <iomanip>
@@ -21,6 +22,9 @@ namespace VART {
 /// values are at the rightmost column.
 /// In a scene graph, the innermost transformation (the one close to the graphic object, farther
 /// away from root) is the one applied first.
+///
+/// The matrix itself is a Matrix4, which should be preferred for temporary results, since
+/// a Transform is a scene node.
     class Transform : public SceneNode {
         /// 'ostream' class extension to output a transformation on the console.
         friend std::ostream& operator<<(std::ostream& output, const Transform& t);
@@ -108,7 +112,13 @@ namespace VART {
             ///
             /// Use this method to get an OpenGl like transformation matrix, compatible
             /// with methods such as "glLoadMatrixd" and "glMultMatrixd".
-            const double* GetData() const { return matrix; }
+            const double* GetData() const { return matrix.GetData(); }
+
+            /// \brief Returns the transformation matrix.
+            const Matrix4& GetMatrix() const { return matrix; }
+
+            /// \brief Sets the transformation matrix.
+            void SetMatrix(const Matrix4& m) { matrix = m; }
 
             /// \brief Returns the X vector of the transform.
             ///
@@ -168,10 +178,7 @@ namespace VART {
 
         protected:
         // PROTECTED ATTRIBUTES
-            double matrix[16];
-        private:
-        // PRIVATE METHODS
-            bool Zero(const double& n) { return (fabs(n) < 0.0000001); }
+            Matrix4 matrix;
     }; // end class declaration
 } // end namespace
 #endif
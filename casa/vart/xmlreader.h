@@ -0,0 +1,182 @@
+/// \file xmlreader.h
+/// \brief Header file for V-ART class "XmlReader".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_XMLREADER_H
+#define VART_XMLREADER_H
+
+#include <string>
+#include <vector>
+#include <cstdio>
+
+namespace VART {
+/// \class XmlReader xmlreader.h
+/// \brief Streaming (pull) parser for XML files.
+///
+/// An XML reader walks a file one element at a time, keeping only a small window of the file
+/// in memory, so that memory use does not grow with file size. It is meant for loaders that
+/// build objects as elements are read (see XmlStreamScene and XmlStreamJointAction), as an
+/// alternative to XmlBase, which keeps a whole DOM tree.
+///
+/// Element and attribute names are interned: each distinct name gets a small integer
+/// identifier, so that loaders compare integers instead of strings. Names interned before
+/// reading get consecutive identifiers, starting at zero, which may be used as enumeration
+/// values. Attribute values are read directly from the input buffer.
+///
+/// Text, comments, processing instructions and the document type declaration are skipped.
+/// The reader checks that elements are properly nested, but does not validate documents.
+/// \code
+/// XmlReader reader;
+/// unsigned int radius = reader.Intern("radius");
+/// reader.Open("scene.xml");
+/// while (reader.Next() == XmlReader::START_ELEMENT)
+///     if (reader.GetName() == radius)
+///         reader.GetAttribute(reader.Intern("value"), &value);
+/// \endcode
+    class XmlReader {
+        public:
+        // PUBLIC TYPES
+            enum Event { START_ELEMENT, END_ELEMENT, END_OF_DOCUMENT, PARSE_ERROR };
+        // PUBLIC STATIC ATTRIBUTES
+            /// \brief Name identifier that matches no name.
+            static const unsigned int NO_NAME;
+        // PUBLIC METHODS
+            /// \brief Creates a reader with no open file.
+            XmlReader();
+            ~XmlReader();
+
+            /// \brief Returns the identifier of a name, creating it if needed.
+            unsigned int Intern(const std::string& name);
+
+            /// \brief Returns a name, given its identifier.
+            const std::string& GetNameString(unsigned int id) const { return nameVec[id]; }
+
+            /// \brief Opens a file for reading.
+            /// \return False if the file could not be opened.
+            bool Open(const std::string& fileName);
+
+            /// \brief Closes current file (if any).
+            void Close();
+
+            /// \brief Reads up to the next element boundary.
+            ///
+            /// Empty elements (such as \<radius value="1"/\>) generate both a START_ELEMENT
+            /// and an END_ELEMENT event. After END_OF_DOCUMENT or PARSE_ERROR, the reader keeps
+            /// returning the same event.
+            Event Next();
+
+            /// \brief Returns the name identifier of the current element.
+            unsigned int GetName() const { return elementStack.empty() ? NO_NAME : elementStack.back(); }
+
+            /// \brief Returns the name identifier of the parent of the current element.
+            unsigned int GetParentName() const;
+
+            /// \brief Returns the number of open elements (the root element has depth one).
+            ///
+            /// At an END_ELEMENT event, the element that has just ended is still counted.
+            unsigned int GetDepth() const { return elementStack.size(); }
+
+            /// \brief Checks whether the current element has an attribute.
+            ///
+            /// Attributes are available only at START_ELEMENT events.
+            bool HasAttribute(unsigned int nameId) const { return FindAttribute(nameId) != NULL; }
+
+            /// \brief Reads an attribute of the current element.
+            /// \return False if there is no such attribute or its value is not a number.
+            bool GetAttribute(unsigned int nameId, float* valuePtr) const;
+
+            /// \brief Reads an attribute of the current element.
+            /// \return False if there is no such attribute or its value is not a number.
+            bool GetAttribute(unsigned int nameId, int* valuePtr) const;
+
+            /// \brief Reads an attribute of the current element.
+            ///
+            /// Accepts "true", "1", "false" and "0", as XmlBase does.
+            /// \return False if there is no such attribute or its value is invalid.
+            bool GetAttribute(unsigned int nameId, bool* valuePtr) const;
+
+            /// \brief Reads an attribute of the current element.
+            /// \return False if there is no such attribute.
+            bool GetAttribute(unsigned int nameId, std::string* valuePtr) const;
+
+            /// \brief Checks whether an attribute of the current element has given value.
+            bool AttributeEquals(unsigned int nameId, const char* value) const;
+
+            /// \brief Returns a description of the last error.
+            const std::string& GetErrorMessage() const { return errorMessage; }
+
+            /// \brief Returns the current line number (counting from one).
+            unsigned long GetLine() const { return line; }
+
+            /// \brief Returns the size of the input buffer, in bytes.
+            ///
+            /// The buffer grows only when a single tag does not fit in it.
+            unsigned int GetBufferSize() const { return buffer.size(); }
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief An attribute of the current element.
+            class Attribute
+            {
+                public:
+                    unsigned int name;
+                    /// Null terminated value, inside the buffer.
+                    const char* value;
+            };
+        // PROTECTED METHODS
+            /// \brief Moves unread data to the start of the buffer and reads more.
+            /// \return False if nothing could be read.
+            bool Refill();
+
+            /// \brief Makes sure that the byte at given offset from current position is in the
+            /// buffer, reading more as needed.
+            bool Ensure(unsigned int offset);
+
+            /// \brief Finds a string from current position, reading more as needed.
+            /// \param offsetPtr [out] Position of the string, relative to current position.
+            /// \return False if not found.
+            bool Find(const char* str, unsigned int* offsetPtr);
+
+            /// \brief Returns the identifier of a name inside the buffer.
+            unsigned int Intern(const char* name, unsigned int length);
+
+            /// \brief Advances current position, counting line breaks.
+            void Consume(unsigned int count);
+
+            /// \brief Parses a start tag at current position.
+            Event ParseStartTag();
+
+            /// \brief Parses an end tag at current position.
+            Event ParseEndTag();
+
+            /// \brief Replaces entity and character references in a value, in place.
+            /// \return False on unknown references.
+            bool DecodeValue(char* value);
+
+            Event SetError(const std::string& message);
+            const Attribute* FindAttribute(unsigned int nameId) const;
+        // PROTECTED ATTRIBUTES
+            /// \brief Interned names.
+            std::vector<std::string> nameVec;
+            /// \brief Open addressing hash table of name identifiers (NO_NAME marks free slots).
+            std::vector<unsigned int> hashTable;
+            FILE* filePtr;
+            /// \brief Input window. Data is in range [position:end).
+            std::vector<char> buffer;
+            unsigned int position;
+            unsigned int end;
+            bool endOfFile;
+            unsigned long line;
+            /// \brief Names of open elements.
+            std::vector<unsigned int> elementStack;
+            std::vector<Attribute> attributeVec;
+            /// \brief Whether the current element was empty (END_ELEMENT pending).
+            bool pendingEnd;
+            /// \brief Whether the last event was END_ELEMENT (element must be popped).
+            bool popPending;
+            bool seenRoot;
+            Event lastEvent;
+            std::string errorMessage;
+    }; // end class declaration
+} // end namespace
+
+#endif
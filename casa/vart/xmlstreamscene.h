@@ -0,0 +1,126 @@
+/// \file xmlstreamscene.h
+/// \brief Header file for V-ART class "XmlStreamScene".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_XMLSTREAMSCENE_H
+#define VART_XMLSTREAMSCENE_H
+
+#include "vart/scene.h"
+#include "vart/point4d.h"
+#include "vart/xmlreader.h"
+#include <string>
+#include <vector>
+#include <list>
+
+namespace VART {
+    class MeshObject;
+    class LazyMeshObject;
+    class Dof;
+/// \class XmlStreamScene xmlstreamscene.h
+/// \brief Streaming loader for xml files that describe a Scene.
+///
+/// Reads the same files as XmlScene and builds the same scene graph, but uses an XmlReader
+/// instead of a DOM tree: scene nodes are created while the file is read and no copy of the
+/// document is kept in memory. Memory use while loading is therefore about the size of the
+/// resulting scene, no matter how large the file is. Unlike XmlScene, it does not need
+/// Xerces and does not validate files against the DTD.
+///
+/// Mesh files are requested from the MeshCache as soon as they are found, so that they are
+/// read by worker threads while the rest of the file is parsed. Mesh objects get their
+/// geometry at the end of LoadFromFile.
+///
+/// With lazy loading, mesh objects are LazyMeshObjects instead, and their files are read only
+/// when they come into view. Their bounding boxes come from optional "min" and "max" elements
+/// inside "meshobject" elements (with x, y and z attributes) or, if missing, from a quick scan
+/// of their files.
+    class XmlStreamScene : public Scene {
+        public:
+        // PUBLIC METHODS
+            XmlStreamScene();
+            ~XmlStreamScene();
+
+            /// \brief Loads the scene from a file.
+            /// \return False on errors, which are reported to cerr.
+            bool LoadFromFile(const std::string& fileName);
+
+            /// \brief Sets whether mesh objects are loaded lazily (default: false).
+            void SetLazyLoading(bool value) { lazyLoading = value; }
+        protected:
+        // PROTECTED TYPES
+            /// \brief Element and attribute names, interned in this order.
+            enum Name { SCENE, CAMERA, NODE, SPHERE, CYLINDER, MESHOBJECT, DIRECTIONALLIGHT,
+                        SPOTLIGHT, POINTLIGHT, TRANSFORM, JOINT, BEZIER, RADIUS, HEIGHT,
+                        MATERIAL, INTENSITY, AMBIENTINTENSITY, COLOR, ENABLED, POSITION,
+                        MATRIX, TRANSLATION, SCALE, ROTATION, DOF, AXIS, RANGE,
+                        // attributes
+                        DESCRIPTION, VALUE, R, G, B, RED, GREEN, BLUE, ALPHA, X, Y, Z,
+                        FILENAME, TYPE, RADIANS, MIN, MAX, REST, M00 };
+            /// \brief A node element being read.
+            class NodeFrame
+            {
+                public:
+                    NodeFrame() : nodePtr(NULL), content(XmlReader::NO_NAME) {}
+                    /// Scene node built from the content element (first child element).
+                    SceneNode* nodePtr;
+                    /// Name of the content element.
+                    unsigned int content;
+            };
+            /// \brief A mesh object created before its file has been read.
+            class PendingMesh
+            {
+                public:
+                    MeshObject* meshObjectPtr;
+                    std::string fileName;
+            };
+            /// \brief A lazy mesh object and the bounds read for it.
+            class LazyMesh
+            {
+                public:
+                    LazyMesh(LazyMeshObject* ptr) : meshObjectPtr(ptr), hasMin(false),
+                                                   hasMax(false) {}
+                    LazyMeshObject* meshObjectPtr;
+                    bool hasMin;
+                    bool hasMax;
+                    double min[3];
+                    double max[3];
+            };
+        // PROTECTED METHODS
+            /// \brief Sets bounding boxes of lazy mesh objects.
+            /// \return False if a mesh object was not found in its file.
+            bool BoundLazyMeshes();
+            /// \brief Handles the start of an element.
+            /// \return False on errors.
+            bool StartElement(XmlReader& reader);
+            /// \brief Handles the end of an element.
+            /// \return False on errors.
+            bool EndElement(XmlReader& reader);
+            /// \brief Creates the scene node for the content element of a node.
+            SceneNode* CreateContent(XmlReader& reader);
+            /// \brief Reads a property element of the current content element.
+            void ReadProperty(XmlReader& reader);
+        // PROTECTED ATTRIBUTES
+            /// \brief Path of the scene file, used to complete relative file names.
+            std::string basePath;
+            /// \brief Open node elements.
+            std::vector<NodeFrame> nodeStack;
+            /// \brief DOF being read (inside a joint).
+            Dof* dofPtr;
+            // DOF properties. As in XmlScene, these are kept from one DOF to the next
+            // inside a joint.
+            Point4D dofAxis;
+            Point4D dofPosition;
+            float dofMin;
+            float dofMax;
+            float dofRest;
+            std::string dofDescription;
+            /// \brief Mesh objects to be filled from the MeshCache once the file has been read.
+            std::vector<PendingMesh> pendingMeshVec;
+            /// \brief Mesh files requested from the MeshCache, released by the destructor.
+            std::list<std::string> meshFileList;
+            bool lazyLoading;
+            /// \brief Lazy mesh objects created by the current LoadFromFile.
+            std::vector<LazyMesh> lazyMeshVec;
+    }; // end class declaration
+} // end namespace
+
+#endif
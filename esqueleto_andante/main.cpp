@@ -11,6 +11,7 @@
 #include <vart/transform.h>
 #include <vart/arrow.h>
 #include <vart/material.h>
+#include <vart/simulationclock.h>
 
 #include <iostream>
 #include <cmath>
@@ -18,6 +19,11 @@
 using namespace std;
 using namespace VART;
 
+// velocidade angular do esqueleto ao virar (radianos por segundo)
+#define ANGULAR_SPEED (3 * M_PI)
+// velocidade de translacao do esqueleto (unidades por segundo)
+#define SPEED 120
+
 // auxiliares para o controle do teclado
 const unsigned int MAX_KEYS = 10; // quantidade maxima de teclas que podem ser usadas
 enum Key { UP, DOWN, RIGHT, LEFT }; // teclas uteis
@@ -79,30 +85,31 @@ class MyIHClass : public VART::ViewerGlutOGL::IdleHandler {
 
         virtual ~MyIHClass() {}
         virtual void OnIdle()  {
-            if(keyPressed[LEFT]) {
-                // se a seta para a esquerda foi pressionada, aumenta o angulo e rotaciona
-                angleYRotation += M_PI/20;
-                rotation->MakeRotation(Point4D::Y(), angleYRotation);
-            }
-            if(keyPressed[RIGHT]) {
-                // se a seta para a esquerda foi pressionada, diminui o angulo e rotaciona
-                angleYRotation -= M_PI/20;
-                rotation->MakeRotation(Point4D::Y(), angleYRotation);
-            }
-            if(keyPressed[UP]) {
-                // se a seta para cima foi aoertada, utiliza o angulo da rotacao para calcular
-                // as novas coordenadas de x e z e faz a translacao
-                xTranslation += sin(angleYRotation) * speed;
-                zTranslation += cos(angleYRotation) * speed;
-                movimentTranslation->MakeTranslation(xTranslation, yTranslation, zTranslation);
-            }
-            if(keyPressed[DOWN]) {
-                // se a seta para cima foi aoertada, utiliza o angulo da rotacao para calcular
-                // as novas coordenadas de x e z e faz a translacao
-                xTranslation += -sin(angleYRotation) * speed;
-                zTranslation += -cos(angleYRotation) * speed;
-                movimentTranslation->MakeTranslation(xTranslation, yTranslation, zTranslation);
+            // o esqueleto vira e anda a cada passo de simulacao, de modo que as velocidades
+            // nao dependem da taxa de quadros
+            clock.Update();
+            while (clock.Step()) {
+                double dt = clock.GetStep();
+                if(keyPressed[LEFT])
+                    // se a seta para a esquerda foi pressionada, aumenta o angulo
+                    angleYRotation += ANGULAR_SPEED * dt;
+                if(keyPressed[RIGHT])
+                    // se a seta para a direita foi pressionada, diminui o angulo
+                    angleYRotation -= ANGULAR_SPEED * dt;
+                if(keyPressed[UP]) {
+                    // se a seta para cima foi apertada, utiliza o angulo da rotacao para
+                    // calcular as novas coordenadas de x e z
+                    xTranslation += sin(angleYRotation) * SPEED * dt;
+                    zTranslation += cos(angleYRotation) * SPEED * dt;
+                }
+                if(keyPressed[DOWN]) {
+                    // se a seta para baixo foi apertada, anda no sentido contrario
+                    xTranslation += -sin(angleYRotation) * SPEED * dt;
+                    zTranslation += -cos(angleYRotation) * SPEED * dt;
+                }
             }
+            rotation->MakeRotation(Point4D::Y(), angleYRotation);
+            movimentTranslation->MakeTranslation(xTranslation, yTranslation, zTranslation);
             // altera as coordenadas da camera para que ela se mantenha proxima do esqueleto
             xCamera = sin(angleYRotation) * distCamera + xTranslation;
             zCamera = cos(angleYRotation) * distCamera + zTranslation;
@@ -120,8 +127,6 @@ class MyIHClass : public VART::ViewerGlutOGL::IdleHandler {
         double zTranslation = 0;
         // angulo de rotacao do esqueleto
         double angleYRotation = 0;
-        // velocidade de translacao do esqueleto
-        double speed = 2;
 
         // posicoes da camera
         double xCamera = 0;
@@ -129,6 +134,8 @@ class MyIHClass : public VART::ViewerGlutOGL::IdleHandler {
         double zCamera = 0;
         // distancia da camera em relacao ao esqueleto
         double distCamera = -50;
+        // relogio de passo fixo
+        SimulationClock clock;
 };
 
 
@@ -0,0 +1,493 @@
+/// \file crowd.cpp
+/// \brief Implementation file for V-ART class "Crowd" (contrib).
+/// \version $Revision: 1.1 $
+
+#include "vart/contrib/crowd.h"
+#include "vart/framestats.h"
+#include "vart/joint.h"
+#include "vart/meshobject.h"
+#include "vart/jointaction.h"
+#include "vart/simulationclock.h"
+#include "vart/collector.h"
+#include "vart/workqueue.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cassert>
+#include <cmath>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#ifdef VART_OGL
+#include <GL/gl.h>
+#endif
+
+using namespace std;
+
+// Instances are not worth a thread of their own below this amount
+const unsigned int MIN_INSTANCES_PER_THREAD = 2048;
+
+const unsigned int VART::Crowd::LIVE_CLIP = 0xFFFFFFFF;
+
+// Workers for large crowds, shared by all crowds. Never deleted, so that crowds may be
+// updated during static destruction.
+static VART::WorkQueue* updateQueuePtr = NULL;
+static mutex updateQueueMutex;
+
+// Ranges of an update still running
+class PendingRanges {
+    public:
+        PendingRanges(unsigned int count) : pending(count) {}
+        // Marks a range as done
+        void Done();
+        // Waits until all ranges are done
+        void Wait();
+    private:
+        unsigned int pending;
+        mutex doneMutex;
+        condition_variable done;
+};
+
+void PendingRanges::Done()
+{
+    lock_guard<mutex> lock(doneMutex);
+    if (--pending == 0)
+        done.notify_all();
+}
+
+void PendingRanges::Wait()
+{
+    unique_lock<mutex> lock(doneMutex);
+    while (pending > 0)
+        done.wait(lock);
+}
+
+class VART::Crowd::RangeJob : public VART::WorkQueue::Job {
+    public:
+        RangeJob(Crowd* crowdPtr, PendingRanges* rangesPtr, unsigned int firstInstance,
+                 unsigned int endInstance, float elapsed)
+            : crowd(*crowdPtr), ranges(*rangesPtr), first(firstInstance), end(endInstance),
+              seconds(elapsed) {}
+        virtual void Run()
+        {
+            crowd.UpdateRange(first, end, seconds);
+            ranges.Done();
+        }
+    private:
+        Crowd& crowd;
+        PendingRanges& ranges;
+        unsigned int first;
+        unsigned int end;
+        float seconds;
+};
+
+// static
+unsigned int VART::Crowd::InstanceSize()
+{
+    // root matrix, phase, speed, clip, pose key and sorted index
+    return 16 * sizeof(float) + 2 * sizeof(float) + 3 * sizeof(unsigned int);
+}
+
+VART::Crowd::Crowd() : modelPtr(NULL), numKeys(1), numThreads(0)
+{
+    keyStartVec.assign(2, 0);
+}
+
+VART::Crowd::Crowd(const Crowd& crowd)
+{
+    this->Crowd::operator=(crowd);
+}
+
+VART::Crowd::~Crowd()
+{
+}
+
+VART::Crowd& VART::Crowd::operator=(const Crowd& crowd)
+{
+    this->GraphicObj::operator=(crowd);
+    modelPtr = crowd.modelPtr;
+    jointVec = crowd.jointVec;
+    clipList = crowd.clipList;
+    numKeys = crowd.numKeys;
+    numThreads = crowd.numThreads;
+    rootVec = crowd.rootVec;
+    phaseVec = crowd.phaseVec;
+    speedVec = crowd.speedVec;
+    clipVec = crowd.clipVec;
+    poseKeyVec = crowd.poseKeyVec;
+    sortedVec = crowd.sortedVec;
+    keyStartVec = crowd.keyStartVec;
+    return *this;
+}
+
+VART::SceneNode* VART::Crowd::Copy()
+{
+    return new Crowd(*this);
+}
+
+void VART::Crowd::SetModel(SceneNode* newModelPtr)
+{
+    modelPtr = newModelPtr;
+    clipList.clear();
+    numKeys = 1;
+    jointVec.clear();
+    if (modelPtr)
+    {
+        Collector<Joint> collector;
+        modelPtr->TraverseDepthFirst(&collector);
+        Collector<Joint>::iterator iter = collector.begin();
+        for (; iter != collector.end(); ++iter)
+            jointVec.push_back(const_cast<Joint*>(*iter));
+    }
+    // Instances that used baked clips fall back to the live pose
+    for (unsigned int i = 0; i < clipVec.size(); ++i)
+        clipVec[i] = LIVE_CLIP;
+    Update(0);
+}
+
+unsigned int VART::Crowd::BakeAction(JointAction* actionPtr, unsigned int numSamples)
+{
+    assert(modelPtr != NULL);
+    assert(numSamples > 0);
+    Clip clip;
+    unsigned int numJoints = jointVec.size();
+    clip.duration = actionPtr->GetDuration() / actionPtr->GetSpeed();
+    clip.numSamples = numSamples;
+    clip.firstKey = numKeys;
+    clip.matrices.resize(numSamples * numJoints * 16);
+
+    // Run the action alone under a private offline clock, so that neither scheduled events
+    // nor other active actions see the private time
+    SimulationClock* previousClockPtr = SimulationClock::GetCurrent();
+    SimulationClock clock(clip.duration / numSamples);
+    clock.SetOffline(true);
+    SimulationClock::SetCurrent(&clock);
+    bool wasCyclic = actionPtr->IsCyclic();
+    actionPtr->SetCyclic(true);
+    actionPtr->Deactivate();
+    actionPtr->Activate();
+    // First cycle brings the model from its current pose into the cycle...
+    for (unsigned int i = 0; i < numSamples; ++i)
+    {
+        clock.Update();
+        clock.Step();
+        actionPtr->MoveAlone();
+    }
+    // ... second cycle is stored.
+    double* destination = &clip.matrices[0];
+    for (unsigned int i = 0; i < numSamples; ++i)
+    {
+        clock.Update();
+        clock.Step();
+        actionPtr->MoveAlone();
+        for (unsigned int j = 0; j < numJoints; ++j)
+        {
+            const double* source = jointVec[j]->GetData();
+            for (unsigned int k = 0; k < 16; ++k)
+                *destination++ = source[k];
+        }
+    }
+    actionPtr->Deactivate();
+    actionPtr->SetCyclic(wasCyclic);
+    SimulationClock::SetCurrent(previousClockPtr);
+
+    clipList.push_back(clip);
+    numKeys += numSamples;
+    Update(0);
+    return clipList.size() - 1;
+}
+
+unsigned int VART::Crowd::AddInstance(const Transform& root, unsigned int clip,
+                                      float phase, float speed)
+{
+    assert((clip == LIVE_CLIP) || (clip < clipList.size()));
+    const double* data = root.GetData();
+    for (unsigned int i = 0; i < 16; ++i)
+        rootVec.push_back(static_cast<float>(data[i]));
+    phaseVec.push_back(phase);
+    speedVec.push_back(speed);
+    clipVec.push_back(clip);
+    poseKeyVec.push_back(0);
+    return phaseVec.size() - 1;
+}
+
+void VART::Crowd::ClearInstances()
+{
+    rootVec.clear();
+    phaseVec.clear();
+    speedVec.clear();
+    clipVec.clear();
+    poseKeyVec.clear();
+    sortedVec.clear();
+    SortByPose();
+}
+
+void VART::Crowd::SetRootTransform(unsigned int instance, const Transform& root)
+{
+    const double* data = root.GetData();
+    float* destination = &rootVec[instance * 16];
+    for (unsigned int i = 0; i < 16; ++i)
+        destination[i] = static_cast<float>(data[i]);
+}
+
+void VART::Crowd::GetRootTransform(unsigned int instance, Transform* resultPtr) const
+{
+    double data[16];
+    const float* source = &rootVec[instance * 16];
+    for (unsigned int i = 0; i < 16; ++i)
+        data[i] = source[i];
+    resultPtr->SetData(data);
+}
+
+void VART::Crowd::SetClip(unsigned int instance, unsigned int clip, float phase)
+{
+    assert((clip == LIVE_CLIP) || (clip < clipList.size()));
+    clipVec[instance] = clip;
+    phaseVec[instance] = phase;
+}
+
+void VART::Crowd::UpdateRange(unsigned int begin, unsigned int end, float seconds)
+{
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        unsigned int clip = clipVec[i];
+        if (clip == LIVE_CLIP)
+        {
+            poseKeyVec[i] = 0;
+            continue;
+        }
+        const Clip& clipRef = clipList[clip];
+        float phase = phaseVec[i] + (seconds * speedVec[i]) / clipRef.duration;
+        phase -= floor(phase); // keep it in [0:1)
+        phaseVec[i] = phase;
+        unsigned int sample = static_cast<unsigned int>(phase * clipRef.numSamples);
+        if (sample >= clipRef.numSamples) // phase may round up to 1
+            sample = 0;
+        poseKeyVec[i] = clipRef.firstKey + sample;
+    }
+}
+
+void VART::Crowd::Update(float seconds)
+{
+    unsigned int numInstances = phaseVec.size();
+    unsigned int threadCount = numThreads;
+    if (threadCount == 0)
+        threadCount = thread::hardware_concurrency();
+    if (threadCount * MIN_INSTANCES_PER_THREAD > numInstances)
+        threadCount = numInstances / MIN_INSTANCES_PER_THREAD;
+    if (threadCount < 2)
+        UpdateRange(0, numInstances, seconds);
+    else
+    {
+        {
+            lock_guard<mutex> lock(updateQueueMutex);
+            if (updateQueuePtr == NULL)
+                updateQueuePtr = new WorkQueue;
+        }
+        PendingRanges ranges(threadCount - 1);
+        unsigned int chunk = numInstances / threadCount;
+        for (unsigned int t = 0; t < threadCount - 1; ++t)
+            updateQueuePtr->Add(new RangeJob(this, &ranges, t * chunk, (t+1) * chunk, seconds));
+        // the calling thread takes the last chunk
+        UpdateRange((threadCount - 1) * chunk, numInstances, seconds);
+        ranges.Wait();
+    }
+    SortByPose();
+}
+
+void VART::Crowd::SortByPose()
+{
+    unsigned int numInstances = poseKeyVec.size();
+    keyStartVec.assign(numKeys + 1, 0);
+    for (unsigned int i = 0; i < numInstances; ++i)
+        ++keyStartVec[poseKeyVec[i] + 1];
+    for (unsigned int k = 1; k <= numKeys; ++k)
+        keyStartVec[k] += keyStartVec[k-1];
+    // Use the end of each bucket as insertion point, then fix bucket starts
+    sortedVec.resize(numInstances);
+    for (unsigned int i = 0; i < numInstances; ++i)
+        sortedVec[keyStartVec[poseKeyVec[i]]++] = i;
+    for (unsigned int k = numKeys; k > 0; --k)
+        keyStartVec[k] = keyStartVec[k-1];
+    keyStartVec[0] = 0;
+}
+
+void VART::Crowd::ApplyPose(const double* matrices) const
+{
+    for (unsigned int j = 0; j < jointVec.size(); ++j)
+        jointVec[j]->SetData(const_cast<double*>(matrices + j * 16));
+}
+
+void VART::Crowd::ComputeBoundingBox()
+{
+    BoundingBox modelBox;
+    GraphicObj* objPtr = dynamic_cast<GraphicObj*>(modelPtr);
+    Transform* transPtr = dynamic_cast<Transform*>(modelPtr);
+    if (objPtr)
+    {
+        objPtr->ComputeRecursiveBoundingBox();
+        modelBox = objPtr->GetRecursiveBoundingBox();
+    }
+    else if (!(transPtr && transPtr->RecursiveBoundingBox(&modelBox)))
+        return;
+    double corners[8][3];
+    for (unsigned int c = 0; c < 8; ++c)
+    {
+        corners[c][0] = (c & 1) ? modelBox.GetGreaterX() : modelBox.GetSmallerX();
+        corners[c][1] = (c & 2) ? modelBox.GetGreaterY() : modelBox.GetSmallerY();
+        corners[c][2] = (c & 4) ? modelBox.GetGreaterZ() : modelBox.GetSmallerZ();
+    }
+    for (unsigned int i = 0; i < phaseVec.size(); ++i)
+    {
+        const float* m = &rootVec[i * 16];
+        for (unsigned int c = 0; c < 8; ++c)
+        {
+            const double* p = corners[c];
+            double x = m[0]*p[0] + m[4]*p[1] + m[8]*p[2] + m[12];
+            double y = m[1]*p[0] + m[5]*p[1] + m[9]*p[2] + m[13];
+            double z = m[2]*p[0] + m[6]*p[1] + m[10]*p[2] + m[14];
+            if ((i == 0) && (c == 0))
+                bBox.SetBoundingBox(x, y, z, x, y, z);
+            else
+                bBox.ConditionalUpdate(x, y, z);
+        }
+    }
+    bBox.ProcessCenter();
+}
+
+void VART::Crowd::CollectParts(const SceneNode* nodePtr, const Matrix4& matrix) const
+{
+    const Transform* transPtr = dynamic_cast<const Transform*>(nodePtr);
+    const MeshObject* meshObjPtr = dynamic_cast<const MeshObject*>(nodePtr);
+    const SceneNode* drawnPtr = NULL; // Node drawn instance by instance, with its subtree
+    Matrix4 childMatrix = matrix;
+    if (transPtr)
+        Matrix4::Multiply(matrix, Matrix4(transPtr->GetData()), &childMatrix);
+    else if (meshObjPtr && meshObjPtr->IsOptimized())
+    {
+        if (const_cast<MeshObject*>(meshObjPtr)->IsVisible())
+        {
+            partVec.push_back(Part());
+            partVec.back().meshObjPtr = meshObjPtr;
+            partVec.back().nodePtr = NULL;
+            partVec.back().matrix = matrix;
+        }
+    }
+    else
+        drawnPtr = nodePtr;
+    if (drawnPtr)
+    {
+        partVec.push_back(Part());
+        partVec.back().meshObjPtr = NULL;
+        partVec.back().nodePtr = drawnPtr;
+        partVec.back().matrix = matrix;
+        return;
+    }
+    list<SceneNode*>::const_iterator iter = nodePtr->childList.begin();
+    for (; iter != nodePtr->childList.end(); ++iter)
+        CollectParts(*iter, childMatrix);
+}
+
+bool VART::Crowd::DrawPose(unsigned int begin, unsigned int end) const
+{
+#ifdef VART_OGL
+    bool result = true;
+    Matrix4 identity;
+    identity.MakeIdentity();
+    partVec.clear();
+    CollectParts(modelPtr, identity);
+    unsigned int group = 0;
+    for (unsigned int p = 0; p < partVec.size(); ++p)
+    {
+        const Part& part = partVec[p];
+        if (part.meshObjPtr)
+        {
+            // One instance per instance of the crowd, placed by its root matrix
+            if (group == groupVec.size())
+                groupVec.push_back(InstanceGroup());
+            InstanceGroup& groupRef = groupVec[group++];
+            groupRef.SetMeshObject(*part.meshObjPtr);
+            groupRef.ClearInstances();
+            Matrix4 root;
+            Matrix4 placement;
+            for (unsigned int s = begin; s < end; ++s)
+            {
+                const float* source = &rootVec[sortedVec[s] * 16];
+                for (unsigned int k = 0; k < 16; ++k)
+                    root[k] = source[k];
+                Matrix4::Multiply(root, part.matrix, &placement);
+                groupRef.AddInstance(placement);
+            }
+            result &= groupRef.DrawOGL();
+        }
+        else
+        {
+            for (unsigned int s = begin; s < end; ++s)
+            {
+                ++FrameStats::current.transformsPushed;
+                glPushMatrix();
+                glMultMatrixf(&rootVec[sortedVec[s] * 16]);
+                glMultMatrixd(part.matrix.GetData());
+                result &= part.nodePtr->DrawOGL();
+                glPopMatrix();
+            }
+        }
+    }
+    return result;
+#else
+    return false;
+#endif
+}
+
+// virtual
+bool VART::Crowd::DrawInstanceOGL() const
+{
+#ifdef VART_OGL
+    bool result = true;
+
+    if (show && modelPtr)
+    {
+        unsigned int numJoints = jointVec.size();
+        // Baked poses overwrite the model's joints. Save the live pose so that it survives.
+        vector<double> livePose(numJoints * 16);
+        for (unsigned int j = 0; j < numJoints; ++j)
+        {
+            const double* source = jointVec[j]->GetData();
+            for (unsigned int k = 0; k < 16; ++k)
+                livePose[j*16 + k] = source[k];
+        }
+        // Key zero holds live instances, which are drawn first. Keys of clip c-1 come
+        // before the first key of clip c.
+        unsigned int key = 0;
+        for (unsigned int c = 0; c <= clipList.size(); ++c)
+        {
+            unsigned int lastKey = (c < clipList.size()) ? clipList[c].firstKey : numKeys;
+            for (; key < lastKey; ++key)
+            {
+                unsigned int begin = keyStartVec[key];
+                unsigned int end = keyStartVec[key+1];
+                if (begin == end)
+                    continue;
+                if (key > 0)
+                {
+                    const Clip& clip = clipList[c-1];
+                    ApplyPose(&clip.matrices[(key - clip.firstKey) * numJoints * 16]);
+                }
+                // Draw every instance that shares this pose
+                result &= DrawPose(begin, end);
+            }
+        }
+        if (numJoints > 0)
+            ApplyPose(&livePose[0]);
+    }
+    if (bBox.visible)
+        bBox.DrawInstanceOGL();
+    if (recBBox.visible)
+        recBBox.DrawInstanceOGL();
+    return result;
+#else
+    return false;
+#endif
+}
@@ -7,9 +7,12 @@
 
 #include "vart/scene.h"
 #include "vart/contrib/mousecontrol.h"
+#include "vart/contrib/framepacer.h"
+#include "vart/simulationclock.h"
 #include <list>
 
 namespace VART {
+    class OffscreenViewer;
     const int KEY_F1 = GLUT_KEY_F1 + 255;
     const int KEY_F2 = GLUT_KEY_F2 + 255;
     const int KEY_F3 = GLUT_KEY_F3 + 255;
@@ -38,7 +41,11 @@ namespace VART {
 /// A ViewerGlutOGL is a window which can display a V-ART scene (VART::Scene) using GLUT
 /// and OpenGL. The window also has basic behavior such as mouse navigation and
 /// keyboard response. At most 6 instances of this class can be created.
+///
+/// An OffscreenViewer owns a ViewerGlutOGL with no window, which stands in for it as the
+/// viewer of its handlers: window methods do nothing on it (e.g.: PostRedisplay).
     class ViewerGlutOGL {
+        friend class OffscreenViewer;
         public:
         // PUBLIC NESTED CLASSES
             // These classes are nested because other types of viewers may have different
@@ -81,6 +88,7 @@ namespace VART {
             class IdleHandler
             {
                 friend class ViewerGlutOGL;
+                friend class OffscreenViewer;
                 public:
                     virtual ~IdleHandler() {};
                     /// Called when the application is idle.
@@ -98,6 +106,7 @@ namespace VART {
             class DrawHandler
             {
                 friend class ViewerGlutOGL;
+                friend class OffscreenViewer;
                 public:
                     virtual ~DrawHandler() {};
                     /// \brief Called when the window is redrawn.
@@ -196,6 +205,22 @@ namespace VART {
             /// Tells the scene to use next camera in its list.
             void UseNextCamera() { ptScene->UseNextCamera(); }
 
+            /// \brief Sets the target frame rate of the viewer.
+            ///
+            /// A paced viewer draws at most at this rate: redraws are posted when frames
+            /// are due and the main loop sleeps in between, instead of spinning. Zero (the
+            /// default) means not paced: redraws are posted at every Idle call.
+            void SetFrameRate(double framesPerSecond) { pacer.SetFrameRate(framesPerSecond); }
+
+            /// \brief Returns frame pacing statistics (frame times, jitter and CPU usage).
+            ///
+            /// Statistics are kept since the frame rate was set, or since
+            /// ResetPacingStats.
+            void GetPacingStats(FramePacer::Stats* resultPtr) const { pacer.GetStats(resultPtr); }
+
+            /// \brief Restarts frame pacing statistics.
+            void ResetPacingStats() { pacer.Reset(); }
+
         // PUBLIC STATIC METHODS
 
             /// \brief Enters main rendering loop.
@@ -213,6 +238,19 @@ namespace VART {
             /// \brief Marks all viewers for redisplay.
             static void RedisplayAll();
 
+            /// \brief Sets the rate of simulation updates.
+            ///
+            /// With an update rate, simulation is decoupled from rendering: Idle (thus idle
+            /// handlers) is called once per fixed step of a simulation clock, which is made
+            /// current so that actions take time from it (see SimulationClock). Zero (the
+            /// default) means Idle is called once per main loop iteration. If all viewers are
+            /// paced (see SetFrameRate) or there is an update rate, the main loop sleeps
+            /// while there is nothing due.
+            static void SetUpdateRate(double updatesPerSecond);
+
+            /// \brief Returns the clock that drives updates, if there is an update rate.
+            static SimulationClock& GetUpdateClock() { return updateClock; }
+
         // PUBLIC ATTRIBUTES
             /// Sets whether the aspect ratio of the viewer window should be passed
             /// along to its cameras.
@@ -224,6 +262,14 @@ namespace VART {
             /// continuously redraw the scene.
             bool redrawOnIdle;
 
+            /// \brief Sets whether redraws on idle happen only when the scene changed.
+            ///
+            /// When set, frames requested by redrawOnIdle are skipped unless a transform, a
+            /// joint, a camera or a light changed (see Scene::ComputeStateHash). Changes to
+            /// meshes or materials are not noticed: call PostRedisplay after them. This is
+            /// set to "false" by default.
+            bool redrawOnChange;
+
             /// How much to walk at each step (mouse movement).
             float walkStep;
 
@@ -234,9 +280,23 @@ namespace VART {
             /// This is set to "true" by default.
             bool autoRespondKeys;
 
+            /// \brief Sets whether profiling statistics are drawn over the scene.
+            ///
+            /// Average times per frame of profiled zones (see Profiler) are listed at the top
+            /// left corner of the window. Key 'p' toggles this and profiling together, if
+            /// built-in keyboard responses are enabled. This is set to "false" by default.
+            bool showProfiler;
+
         protected:
             /// \brief Sets clear color and clears OpenGL buffers.
             void ClearOGLBuffers();
+            /// \brief Draws profiling statistics (if enabled), swaps buffers and ends a
+            /// profiled frame.
+            void FinishFrame();
+            /// \brief Draws profiling statistics over the scene.
+            void DrawProfilerHUD();
+            /// \brief Checks whether a frame should be drawn, consuming redraw requests.
+            bool NeedsRedraw();
 
         private:
         // PRIVATE STATIC METHODS (GLUT CALLBACKS)
@@ -301,7 +361,13 @@ namespace VART {
         // PRIVATE STATIC ATRIBUTES
             static int glutIDVec[6]; // GLUT window IDs
             static ViewerGlutOGL* instancePtrVec[6]; // pointers to class instances
+            static double updateRate; // simulation updates per second (zero if not set)
+            static SimulationClock updateClock;
         // PRIVATE METHODS
+            /// \brief Creates a viewer with no window (see OffscreenViewer).
+            ViewerGlutOGL(int newWidth, int newHeight, bool createWindow);
+            /// \brief Checks whether the viewer has a window (stand-ins have none).
+            bool HasWindow() const { return glutID != 0; }
             void RegisterCallbacks();
             void CommonConstructor();
             void HandleKey(unsigned char key);
@@ -315,6 +381,9 @@ namespace VART {
             int height; // window height in pixels
             int width;  // window width in pixels
             Camera* cameraPtr;
+            FramePacer pacer;
+            bool redrawPending; // a redraw was requested by navigation
+            unsigned long long lastStateHash; // scene state when last checked
     }; // end class declaration
 } // end namespace
 
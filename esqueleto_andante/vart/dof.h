@@ -16,6 +16,7 @@
 namespace VART {
     class Modifier;
     class Joint;
+    class XmlWriter;
 /// \class Dof dof.h
 /// \brief Degree Of Freedom - basic component of a Joint.
 ///
@@ -91,6 +92,13 @@ namespace VART {
             /// \brief Gets DOF's current position.
             float GetCurrent() const;
 
+            /// \brief Sets DOF's current position, leaving the owner joint as it is.
+            ///
+            /// Unlike MoveTo, ignores range limits and priorities. Meant for restoring
+            /// recorded poses (see PosePlayer): call Joint::MakeLim after setting all DOFs
+            /// of a joint, so that its transform is computed once.
+            void SetCurrent(float pos);
+
             /// \brief Changes DOF
             ///
             /// Changes how much the DOF is "bent"
@@ -124,9 +132,12 @@ namespace VART {
             /// \param ptrTrans [in,out] where to apply internal transform.
             void ApplyTransformTo(Transform* ptrTrans) const;
 
-            /// \brief Outputs XML representation of the scene.
+            /// \brief Outputs XML representation of the DOF.
             void XmlPrintOn(std::ostream& os, unsigned int indent) const;
 
+            /// \brief Appends XML representation of the DOF to a writer.
+            void XmlWrite(XmlWriter* writerPtr, unsigned int indent) const;
+
             /// \brief Reconfigure DOF to match a target direction.
             ///
             /// Given a state (some direction representing current DOF configuration), puts
@@ -173,6 +184,7 @@ namespace VART {
             float currentPosition; //A real number from 0 to 1
             float restPosition;           //Another real number from 0 to 1
             Joint* ownerJoint;            //Reference to the joint where this dof is set up
+            std::list<Dof*>::iterator instanceListPos; // Position in instanceList
         // PRIVATE STATIC ATTRIBUTES
             // List of all instances of the class
             static std::list<Dof*> instanceList;
@@ -0,0 +1,77 @@
+/// \file framestats.h
+/// \brief Header file for V-ART class "FrameStats".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_FRAMESTATS_H
+#define VART_FRAMESTATS_H
+
+#include "vart/mesh.h"
+#include <iostream>
+
+namespace VART {
+/// \class FrameStats framestats.h
+/// \brief Counts of the work done to update and draw a frame.
+///
+/// While rendering and updating, the core increments the counters of FrameStats::current.
+/// At the end of Scene::DrawOGL, the counts are moved to the scene (see
+/// Scene::GetFrameStats), so that a frame accounts for everything done since the
+/// previous frame ended (e.g.: dofs moved by actions) up to drawing.
+///
+/// Counting is done by the drawing thread, with no synchronization; applications that
+/// move dofs from other threads get approximate dof counts. With several viewers, each
+/// scene gets the counts since any scene was last drawn.
+///
+/// Frame statistics may be written as CSV, one row per frame (see WriteCSVHeader and
+/// WriteCSV), to keep track of performance regressions.
+    class FrameStats {
+        public:
+        // PUBLIC CONSTANTS
+            /// Number of mesh types (see Mesh::MeshType).
+            static const unsigned int NUM_MESH_TYPES = Mesh::POLYGON + 1;
+        // PUBLIC METHODS
+            /// Creates zeroed counts.
+            FrameStats() { Clear(); }
+            /// Sets all counts to zero.
+            void Clear();
+            /// Returns the number of draw calls of meshes, of any type.
+            unsigned long GetDrawCalls() const;
+            /// Returns the number of vertex indices sent by meshes, of any type.
+            unsigned long GetIndices() const;
+            /// Returns the number of triangles drawn by meshes (quads and polygons count as
+            /// the triangles that would make them).
+            unsigned long GetTriangles() const;
+            /// \brief Writes column names of WriteCSV, ending the line.
+            static void WriteCSVHeader(std::ostream& os);
+            /// \brief Writes counts as comma separated values, ending the line.
+            /// \param frame [in] Frame number, written as the first column.
+            void WriteCSV(std::ostream& os, unsigned long frame) const;
+        // PUBLIC ATTRIBUTES
+            /// Scene nodes whose DrawOGL was called.
+            unsigned long nodesVisited;
+            /// Visible graphic objects drawn.
+            unsigned long objectsDrawn;
+            /// Draw calls of meshes (glDrawElements, or glBegin/glEnd for meshes without
+            /// vertex arrays), by mesh type.
+            unsigned long drawCalls[NUM_MESH_TYPES];
+            /// Vertex indices sent by draw calls, by mesh type.
+            unsigned long indices[NUM_MESH_TYPES];
+            /// Materials set.
+            unsigned long materialBinds;
+            /// Textures bound.
+            unsigned long textureBinds;
+            /// Lights set.
+            unsigned long lightsSet;
+            /// Matrices pushed by transforms and joints.
+            unsigned long transformsPushed;
+            /// Calls to Dof::MoveTo.
+            unsigned long dofsMoved;
+            /// Bytes of vertex data (coordinates, normals and texture coordinates) given to
+            /// OpenGL.
+            unsigned long vertexBytes;
+        // PUBLIC STATIC ATTRIBUTES
+            /// Counts of the frame in progress.
+            static FrameStats current;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -75,6 +75,11 @@ namespace VART {
             /// that are selected by the mouse (see Scene::Pick).
             virtual void DrawForPicking() const;
 
+            /// \brief Recursive drawing using OpenGL commands
+            ///
+            /// Visible objects are counted as drawn (see FrameStats).
+            virtual bool DrawOGL() const;
+
         // PUBLIC ATTRIBUTES
             /// \brief Defines how to show the object
             ShowType howToShow;
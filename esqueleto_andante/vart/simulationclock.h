@@ -0,0 +1,132 @@
+/// \file simulationclock.h
+/// \brief Header file for V-ART class "SimulationClock".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_SIMULATIONCLOCK_H
+#define VART_SIMULATIONCLOCK_H
+
+#include "vart/time.h"
+
+namespace VART {
+/// \class SimulationClock simulationclock.h
+/// \brief Fixed time step clock for animation and simulation.
+///
+/// A simulation clock decouples the advance of simulated time from the rendering rate.
+/// Real elapsed time (read from a monotonic source) is accumulated at each Update() and
+/// consumed in fixed steps by Step(), so that animation speed no longer depends on how
+/// fast frames are drawn. A typical idle handler looks like:
+/// \code
+/// clock.Update();
+/// while (clock.Step())
+///     BaseAction::MoveAllActive();
+/// float alpha = clock.GetAlpha(); // blend previous and current states for rendering
+/// \endcode
+/// When made current (see SetCurrent), actions read time from the clock instead of the
+/// wall clock. In offline mode, every Update() accounts for exactly one step, regardless
+/// of real elapsed time: simulations run as fast as possible and produce the same results
+/// on every run.
+    class SimulationClock {
+        public:
+        // PUBLIC STATIC METHODS
+            /// \brief Sets the clock from which actions take time.
+            ///
+            /// Pass NULL to make actions go back to reading the wall clock.
+            static void SetCurrent(SimulationClock* clockPtr) { currentPtr = clockPtr; }
+
+            /// \brief Returns the current clock (may be NULL).
+            static SimulationClock* GetCurrent() { return currentPtr; }
+
+            /// \brief Returns current time.
+            ///
+            /// Returns the simulation time of the current clock or, if no clock is current,
+            /// elapsed time since "the epoch" (see Time::NOW).
+            static Time NOW();
+        // PUBLIC METHODS
+            /// \brief Creates a real time clock with steps of 1/60 seconds.
+            SimulationClock();
+
+            /// \brief Creates a real time clock with steps of given size (in seconds).
+            SimulationClock(double stepSeconds);
+
+            /// \brief Sets the size (in seconds) of each simulation step.
+            void SetStep(double seconds) { step = seconds; }
+
+            /// \brief Returns the size (in seconds) of each simulation step.
+            double GetStep() const { return step; }
+
+            /// \brief Sets whether the clock ignores real time.
+            ///
+            /// An offline clock accounts for exactly one step at each Update(). Use it for
+            /// batch rendering and for reproducible simulations.
+            void SetOffline(bool value) { offline = value; }
+
+            /// \brief Checks whether the clock ignores real time.
+            bool IsOffline() const { return offline; }
+
+            /// \brief Sets maximum amount of real time accounted for in a single Update().
+            ///
+            /// Prevents a long pause (e.g.: a breakpoint or a slow frame) from generating a
+            /// burst of simulation steps. Default value is 0.25 seconds.
+            void SetMaxFrameTime(double seconds) { maxFrameTime = seconds; }
+
+            /// \brief Restarts the clock.
+            ///
+            /// Sets simulation time to zero, discards accumulated time and restarts
+            /// measurement of real time.
+            void Reset();
+
+            /// \brief Accounts for elapsed real time.
+            /// \return The number of steps ready to be consumed by Step().
+            ///
+            /// Call once per frame, before consuming steps.
+            unsigned int Update();
+
+            /// \brief Advances simulation time by one step, if there is time to consume.
+            /// \return False if less than one step is accumulated (simulation time is
+            /// unchanged in that case).
+            bool Step();
+
+            /// \brief Returns current simulation time.
+            const Time& GetTime() const { return simTime; }
+
+            /// \brief Returns the number of steps taken since last Reset().
+            unsigned long GetStepCount() const { return stepCount; }
+
+            /// \brief Returns the interpolation factor for rendering.
+            ///
+            /// The interpolation factor (alpha) is the fraction of a step accumulated, but
+            /// not yet consumed. It is a number in [0:1) which may be used to blend the two
+            /// most recent simulation states when rendering.
+            float GetAlpha() const { return static_cast<float>(accumulator / step); }
+        protected:
+        // PROTECTED STATIC ATTRIBUTES
+            /// \brief Clock from which actions take time.
+            static SimulationClock* currentPtr;
+        // PROTECTED ATTRIBUTES
+            /// \brief Size of a simulation step (in seconds).
+            double step;
+
+            /// \brief Real time accumulated, but not yet consumed (in seconds).
+            double accumulator;
+
+            /// \brief Maximum real time accounted for in one Update() (in seconds).
+            double maxFrameTime;
+
+            /// \brief Number of steps taken since last Reset().
+            unsigned long stepCount;
+
+            /// \brief Whether the clock ignores real time.
+            bool offline;
+
+            /// \brief Monotonic time of last Update().
+            Time lastRealTime;
+
+            /// \brief Current simulation time.
+            ///
+            /// Always computed as stepCount * step so that no error is accumulated.
+            Time simTime;
+        private:
+    }; // end class declaration
+} // end namespace
+
+#endif
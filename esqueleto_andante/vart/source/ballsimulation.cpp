@@ -0,0 +1,780 @@
+/// \file ballsimulation.cpp
+/// \brief Implementation file for V-ART class "BallSimulation".
+/// \version $Revision: 1.1 $
+
+#include "vart/ballsimulation.h"
+#include "vart/meshobject.h"
+#include "vart/terrain.h"
+#include "vart/transform.h"
+#include "vart/instancegroup.h"
+#include "vart/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if !defined(VART_NO_SIMD) && defined(__AVX__)
+#define VART_BALLSIMULATION_AVX
+#include <immintrin.h>
+#elif !defined(VART_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define VART_BALLSIMULATION_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// Balls per job: smaller simulations are run by the calling thread alone
+static const unsigned int MIN_BALLS_PER_JOB = 1024;
+
+// === Auxiliary functions ===
+static inline double Dot(const double* a, const double* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static inline void Cross(const double* a, const double* b, double* result)
+{
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+// Finds the point of triangle abc closest to p (see Ericson, "Real-Time Collision
+// Detection", section 5.1.5)
+static void ClosestPointOnTriangle(const double* p, const double* a, const double* b,
+                                   const double* c, double* result)
+{
+    double ab[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+    double ac[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+    double ap[3] = { p[0] - a[0], p[1] - a[1], p[2] - a[2] };
+    double d1 = Dot(ab, ap);
+    double d2 = Dot(ac, ap);
+    if ((d1 <= 0) && (d2 <= 0))
+    { // vertex a
+        copy(a, a + 3, result);
+        return;
+    }
+    double bp[3] = { p[0] - b[0], p[1] - b[1], p[2] - b[2] };
+    double d3 = Dot(ab, bp);
+    double d4 = Dot(ac, bp);
+    if ((d3 >= 0) && (d4 <= d3))
+    { // vertex b
+        copy(b, b + 3, result);
+        return;
+    }
+    double vc = d1 * d4 - d3 * d2;
+    if ((vc <= 0) && (d1 >= 0) && (d3 <= 0))
+    { // edge ab
+        double v = d1 / (d1 - d3);
+        for (int i = 0; i < 3; ++i)
+            result[i] = a[i] + v * ab[i];
+        return;
+    }
+    double cp[3] = { p[0] - c[0], p[1] - c[1], p[2] - c[2] };
+    double d5 = Dot(ab, cp);
+    double d6 = Dot(ac, cp);
+    if ((d6 >= 0) && (d5 <= d6))
+    { // vertex c
+        copy(c, c + 3, result);
+        return;
+    }
+    double vb = d5 * d2 - d1 * d6;
+    if ((vb <= 0) && (d2 >= 0) && (d6 <= 0))
+    { // edge ac
+        double w = d2 / (d2 - d6);
+        for (int i = 0; i < 3; ++i)
+            result[i] = a[i] + w * ac[i];
+        return;
+    }
+    double va = d3 * d6 - d5 * d4;
+    if ((va <= 0) && ((d4 - d3) >= 0) && ((d5 - d6) >= 0))
+    { // edge bc
+        double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        for (int i = 0; i < 3; ++i)
+            result[i] = b[i] + w * (c[i] - b[i]);
+        return;
+    }
+    // inside the face
+    double denom = 1 / (va + vb + vc);
+    double v = vb * denom;
+    double w = vc * denom;
+    for (int i = 0; i < 3; ++i)
+        result[i] = a[i] + ab[i] * v + ac[i] * w;
+}
+
+// Returns the smallest power of two that is not smaller than value
+static unsigned int PowerOfTwo(unsigned int value)
+{
+    unsigned int result = 1;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+class VART::BallSimulation::RangeJob : public VART::WorkQueue::Job {
+    public:
+        RangeJob(BallSimulation* simulationPtr, bool integrateBalls, unsigned int firstBall,
+                 unsigned int endBall)
+            : simulation(*simulationPtr), integrate(integrateBalls), first(firstBall),
+              end(endBall) {}
+        virtual void Run()
+        {
+            if (integrate)
+                simulation.Integrate(first, end);
+            else
+                simulation.Solve(first, end);
+            lock_guard<mutex> lock(simulation.pendingMutex);
+            if (--simulation.pending == 0)
+                simulation.finished.notify_all();
+        }
+    private:
+        BallSimulation& simulation;
+        bool integrate;
+        unsigned int first;
+        unsigned int end;
+};
+
+// === Member functions ===
+VART::BallSimulation::BallSimulation()
+    : maxRadius(0), cellSize(1), bucketMask(0), triangleCellSize(1), triangleMask(0),
+      trianglesChanged(false), terrain(NULL), hasBounds(false), step(1.0 / 60),
+      restitution(0.5), friction(0.3), iterations(4),
+      numThreads(thread::hardware_concurrency()), pending(0)
+{
+    gravity[0] = 0;
+    gravity[1] = -9.8;
+    gravity[2] = 0;
+    if (numThreads == 0)
+        numThreads = 1;
+}
+
+VART::BallSimulation::~BallSimulation()
+{
+    workQueue.Stop();
+}
+
+unsigned int VART::BallSimulation::AddBall(const Point4D& position, double radius,
+                                           const Point4D& velocity)
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        positionVecs[i].push_back(position.VetXYZW()[i]);
+        velocityVecs[i].push_back(velocity.VetXYZW()[i]);
+        spinVecs[i].push_back(0);
+    }
+    orientationVecs[0].push_back(1);
+    for (int i = 1; i < 4; ++i)
+        orientationVecs[i].push_back(0);
+    radiusVec.push_back(radius);
+    massVec.push_back(radius * radius * radius);
+    if (radius > maxRadius)
+    {
+        maxRadius = radius;
+        // triangle cells must be at least as large as balls
+        if (2 * maxRadius > triangleCellSize)
+            trianglesChanged = true;
+    }
+    return static_cast<unsigned int>(radiusVec.size() - 1);
+}
+
+void VART::BallSimulation::ClearBalls()
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        positionVecs[i].clear();
+        velocityVecs[i].clear();
+        spinVecs[i].clear();
+    }
+    for (int i = 0; i < 4; ++i)
+        orientationVecs[i].clear();
+    radiusVec.clear();
+    massVec.clear();
+    maxRadius = 0;
+}
+
+VART::Point4D VART::BallSimulation::GetPosition(unsigned int index) const
+{
+    return Point4D(positionVecs[0][index], positionVecs[1][index], positionVecs[2][index]);
+}
+
+void VART::BallSimulation::SetPosition(unsigned int index, const Point4D& position)
+{
+    for (int i = 0; i < 3; ++i)
+        positionVecs[i][index] = position.VetXYZW()[i];
+}
+
+VART::Point4D VART::BallSimulation::GetVelocity(unsigned int index) const
+{
+    return Point4D(velocityVecs[0][index], velocityVecs[1][index], velocityVecs[2][index], 0);
+}
+
+void VART::BallSimulation::SetVelocity(unsigned int index, const Point4D& velocity)
+{
+    for (int i = 0; i < 3; ++i)
+        velocityVecs[i][index] = velocity.VetXYZW()[i];
+}
+
+void VART::BallSimulation::GetMatrix(unsigned int index, Matrix4* resultPtr) const
+{
+    double w = orientationVecs[0][index];
+    double x = orientationVecs[1][index];
+    double y = orientationVecs[2][index];
+    double z = orientationVecs[3][index];
+    double r = radiusVec[index];
+    Matrix4& m = *resultPtr;
+    // rotation of a unit quaternion, column by column, scaled by the radius
+    m[0] = r * (1 - 2 * (y * y + z * z));
+    m[1] = r * 2 * (x * y + w * z);
+    m[2] = r * 2 * (x * z - w * y);
+    m[3] = 0;
+    m[4] = r * 2 * (x * y - w * z);
+    m[5] = r * (1 - 2 * (x * x + z * z));
+    m[6] = r * 2 * (y * z + w * x);
+    m[7] = 0;
+    m[8] = r * 2 * (x * z + w * y);
+    m[9] = r * 2 * (y * z - w * x);
+    m[10] = r * (1 - 2 * (x * x + y * y));
+    m[11] = 0;
+    m[12] = positionVecs[0][index];
+    m[13] = positionVecs[1][index];
+    m[14] = positionVecs[2][index];
+    m[15] = 1;
+}
+
+void VART::BallSimulation::AddMesh(const MeshObject& meshObj)
+{
+    Matrix4 identity;
+    identity.MakeIdentity();
+    AddMesh(meshObj, identity);
+}
+
+void VART::BallSimulation::AddMesh(const MeshObject& meshObj, const Matrix4& matrix)
+{
+    // Vertices of optimized or unoptimized objects, placed in the simulation
+    vector<double> coordVec;
+    if (meshObj.vertCoordVec.empty())
+    {
+        coordVec.reserve(meshObj.vertVec.size() * 3);
+        for (unsigned int i = 0; i < meshObj.vertVec.size(); ++i)
+        {
+            coordVec.push_back(meshObj.vertVec[i].GetX());
+            coordVec.push_back(meshObj.vertVec[i].GetY());
+            coordVec.push_back(meshObj.vertVec[i].GetZ());
+        }
+    }
+    else
+        coordVec = meshObj.vertCoordVec;
+    if (coordVec.empty())
+        return;
+    matrix.TransformPoints(&coordVec[0], &coordVec[0], coordVec.size() / 3, NULL);
+
+    list<Mesh>::const_iterator iter = meshObj.meshList.begin();
+    for (; iter != meshObj.meshList.end(); ++iter)
+    {
+        const vector<unsigned int>& indexVec = iter->indexVec;
+        unsigned int size = indexVec.size();
+        unsigned int i;
+        switch (iter->type)
+        {
+            case Mesh::TRIANGLES:
+                for (i = 0; i + 2 < size; i += 3)
+                    AddTriangle(&coordVec[indexVec[i] * 3], &coordVec[indexVec[i+1] * 3],
+                                &coordVec[indexVec[i+2] * 3]);
+                break;
+            case Mesh::TRIANGLE_STRIP:
+            case Mesh::QUAD_STRIP:
+                for (i = 0; i + 2 < size; ++i)
+                    AddTriangle(&coordVec[indexVec[i] * 3], &coordVec[indexVec[i+1] * 3],
+                                &coordVec[indexVec[i+2] * 3]);
+                break;
+            case Mesh::QUADS:
+                for (i = 0; i + 3 < size; i += 4)
+                {
+                    AddTriangle(&coordVec[indexVec[i] * 3], &coordVec[indexVec[i+1] * 3],
+                                &coordVec[indexVec[i+2] * 3]);
+                    AddTriangle(&coordVec[indexVec[i] * 3], &coordVec[indexVec[i+2] * 3],
+                                &coordVec[indexVec[i+3] * 3]);
+                }
+                break;
+            case Mesh::TRIANGLE_FAN:
+            case Mesh::POLYGON:
+                for (i = 1; i + 1 < size; ++i)
+                    AddTriangle(&coordVec[indexVec[0] * 3], &coordVec[indexVec[i] * 3],
+                                &coordVec[indexVec[i+1] * 3]);
+                break;
+            default: // points and lines
+                break;
+        }
+    }
+}
+
+void VART::BallSimulation::AddTriangle(const double* v1, const double* v2, const double* v3)
+{
+    triangleVec.insert(triangleVec.end(), v1, v1 + 3);
+    triangleVec.insert(triangleVec.end(), v2, v2 + 3);
+    triangleVec.insert(triangleVec.end(), v3, v3 + 3);
+    trianglesChanged = true;
+}
+
+void VART::BallSimulation::ClearMeshes()
+{
+    triangleVec.clear();
+    trianglesChanged = true;
+}
+
+void VART::BallSimulation::SetBounds(const BoundingBox& box)
+{
+    bounds = box;
+    hasBounds = true;
+}
+
+void VART::BallSimulation::SetGravity(const Point4D& acceleration)
+{
+    gravity[0] = acceleration.GetX();
+    gravity[1] = acceleration.GetY();
+    gravity[2] = acceleration.GetZ();
+}
+
+void VART::BallSimulation::SetNumThreads(unsigned int value)
+{
+    numThreads = (value > 0) ? value : 1;
+    workQueue.SetNumThreads(numThreads);
+}
+
+unsigned int VART::BallSimulation::Bucket(int x, int y, int z, unsigned int mask)
+{
+    return ((static_cast<unsigned int>(x) * 73856093u) ^
+            (static_cast<unsigned int>(y) * 19349663u) ^
+            (static_cast<unsigned int>(z) * 83492791u)) & mask;
+}
+
+void VART::BallSimulation::Step()
+{
+    VART_PROFILE_ZONE("BallSimulation::Step");
+    if (radiusVec.empty())
+        return;
+    if (trianglesChanged)
+        BuildTriangleGrid();
+    RunRanges(true);
+    BuildBallGrid();
+    unsigned int numBalls = radiusVec.size();
+    for (int i = 0; i < 3; ++i)
+    {
+        newPositionVecs[i].resize(numBalls);
+        newVelocityVecs[i].resize(numBalls);
+    }
+    // Each pass starts from the results of the previous one, with the same grid: balls
+    // move little during a step.
+    for (unsigned int pass = 0; pass < iterations; ++pass)
+    {
+        RunRanges(false);
+        for (int i = 0; i < 3; ++i)
+        {
+            positionVecs[i].swap(newPositionVecs[i]);
+            velocityVecs[i].swap(newVelocityVecs[i]);
+        }
+    }
+}
+
+void VART::BallSimulation::RunRanges(bool integrate)
+{
+    unsigned int numBalls = radiusVec.size();
+    unsigned int numJobs = min(numThreads, numBalls / MIN_BALLS_PER_JOB);
+    if (numJobs <= 1)
+    {
+        if (integrate)
+            Integrate(0, numBalls);
+        else
+            Solve(0, numBalls);
+        return;
+    }
+    pending = numJobs - 1;
+    // The calling thread takes the first range
+    for (unsigned int job = 1; job < numJobs; ++job)
+        workQueue.Add(new RangeJob(this, integrate,
+                                   static_cast<unsigned int>(
+                                       static_cast<unsigned long long>(numBalls) * job / numJobs),
+                                   static_cast<unsigned int>(
+                                       static_cast<unsigned long long>(numBalls) * (job + 1)
+                                       / numJobs)));
+    unsigned int end = numBalls / numJobs;
+    if (integrate)
+        Integrate(0, end);
+    else
+        Solve(0, end);
+    unique_lock<mutex> lock(pendingMutex);
+    while (pending > 0)
+        finished.wait(lock);
+}
+
+void VART::BallSimulation::Integrate(unsigned int first, unsigned int end)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        double* position = &positionVecs[axis][0];
+        double* velocity = &velocityVecs[axis][0];
+        double deltaV = gravity[axis] * step;
+        unsigned int i = first;
+#if defined(VART_BALLSIMULATION_AVX)
+        __m256d deltaV4 = _mm256_set1_pd(deltaV);
+        __m256d step4 = _mm256_set1_pd(step);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m256d v = _mm256_add_pd(_mm256_loadu_pd(velocity + i), deltaV4);
+            _mm256_storeu_pd(velocity + i, v);
+            _mm256_storeu_pd(position + i,
+                             _mm256_add_pd(_mm256_loadu_pd(position + i), _mm256_mul_pd(v, step4)));
+        }
+#elif defined(VART_BALLSIMULATION_SSE2)
+        __m128d deltaV2 = _mm_set1_pd(deltaV);
+        __m128d step2 = _mm_set1_pd(step);
+        for (; i + 2 <= end; i += 2)
+        {
+            __m128d v = _mm_add_pd(_mm_loadu_pd(velocity + i), deltaV2);
+            _mm_storeu_pd(velocity + i, v);
+            _mm_storeu_pd(position + i,
+                          _mm_add_pd(_mm_loadu_pd(position + i), _mm_mul_pd(v, step2)));
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            velocity[i] += deltaV;
+            position[i] += velocity[i] * step;
+        }
+    }
+    // Turn orientations by spins: q += (step / 2) * (0, spin) * q
+    double h = step / 2;
+    for (unsigned int ball = first; ball < end; ++ball)
+    {
+        double spin[3] = { spinVecs[0][ball], spinVecs[1][ball], spinVecs[2][ball] };
+        double* q[4] = { &orientationVecs[0][ball], &orientationVecs[1][ball],
+                         &orientationVecs[2][ball], &orientationVecs[3][ball] };
+        double w = *q[0] - h * (spin[0] * *q[1] + spin[1] * *q[2] + spin[2] * *q[3]);
+        double x = *q[1] + h * (spin[0] * *q[0] + spin[1] * *q[3] - spin[2] * *q[2]);
+        double y = *q[2] + h * (spin[1] * *q[0] + spin[2] * *q[1] - spin[0] * *q[3]);
+        double z = *q[3] + h * (spin[2] * *q[0] + spin[0] * *q[2] - spin[1] * *q[1]);
+        double length = sqrt(w * w + x * x + y * y + z * z);
+        *q[0] = w / length;
+        *q[1] = x / length;
+        *q[2] = y / length;
+        *q[3] = z / length;
+    }
+}
+
+void VART::BallSimulation::BuildBallGrid()
+{
+    unsigned int numBalls = radiusVec.size();
+    unsigned int numBuckets = PowerOfTwo(2 * numBalls);
+    cellSize = 2 * maxRadius;
+    bucketMask = numBuckets - 1;
+    vector<unsigned int> bucketVec(numBalls);
+    bucketStartVec.assign(numBuckets + 1, 0);
+    for (int i = 0; i < 3; ++i)
+        cellVecs[i].resize(numBalls);
+    for (unsigned int ball = 0; ball < numBalls; ++ball)
+    {
+        for (int i = 0; i < 3; ++i)
+            cellVecs[i][ball] = static_cast<int>(floor(positionVecs[i][ball] / cellSize));
+        bucketVec[ball] = Bucket(cellVecs[0][ball], cellVecs[1][ball], cellVecs[2][ball],
+                                 bucketMask);
+        ++bucketStartVec[bucketVec[ball] + 1];
+    }
+    for (unsigned int bucket = 0; bucket < numBuckets; ++bucket)
+        bucketStartVec[bucket + 1] += bucketStartVec[bucket];
+    sortedVec.resize(numBalls);
+    vector<unsigned int> nextVec(bucketStartVec.begin(), bucketStartVec.end() - 1);
+    for (unsigned int ball = 0; ball < numBalls; ++ball)
+        sortedVec[nextVec[bucketVec[ball]]++] = ball;
+}
+
+void VART::BallSimulation::BuildTriangleGrid()
+{
+    unsigned int numTriangles = triangleVec.size() / 9;
+    trianglesChanged = false;
+    triangleIndexVec.clear();
+    triangleStartVec.assign(2, 0);
+    triangleMask = 0;
+    if (numTriangles == 0)
+        return;
+    // Cells as large as an average triangle, but not smaller than balls
+    double sizeSum = 0;
+    for (unsigned int t = 0; t < numTriangles; ++t)
+    {
+        const double* v = &triangleVec[t * 9];
+        for (int i = 0; i < 3; ++i)
+            sizeSum += max(max(v[i], v[i+3]), v[i+6]) - min(min(v[i], v[i+3]), v[i+6]);
+    }
+    triangleCellSize = max(sizeSum / (3 * numTriangles), 2 * maxRadius);
+    if (triangleCellSize <= 0)
+        triangleCellSize = 1;
+
+    // Each triangle goes to every cell its box touches: find the cells, then sort them
+    vector<unsigned int> cellTriangleVec;
+    vector<int> cellVec;
+    for (unsigned int t = 0; t < numTriangles; ++t)
+    {
+        const double* v = &triangleVec[t * 9];
+        int low[3];
+        int high[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            low[i] = static_cast<int>(floor(min(min(v[i], v[i+3]), v[i+6]) / triangleCellSize));
+            high[i] = static_cast<int>(floor(max(max(v[i], v[i+3]), v[i+6]) / triangleCellSize));
+        }
+        for (int x = low[0]; x <= high[0]; ++x)
+            for (int y = low[1]; y <= high[1]; ++y)
+                for (int z = low[2]; z <= high[2]; ++z)
+                {
+                    cellTriangleVec.push_back(t);
+                    cellVec.push_back(x);
+                    cellVec.push_back(y);
+                    cellVec.push_back(z);
+                }
+    }
+    unsigned int numEntries = cellTriangleVec.size();
+    unsigned int numBuckets = PowerOfTwo(numEntries);
+    triangleMask = numBuckets - 1;
+    vector<unsigned int> bucketVec(numEntries);
+    triangleStartVec.assign(numBuckets + 1, 0);
+    for (unsigned int entry = 0; entry < numEntries; ++entry)
+    {
+        bucketVec[entry] = Bucket(cellVec[entry * 3], cellVec[entry * 3 + 1],
+                                  cellVec[entry * 3 + 2], triangleMask);
+        ++triangleStartVec[bucketVec[entry] + 1];
+    }
+    for (unsigned int bucket = 0; bucket < numBuckets; ++bucket)
+        triangleStartVec[bucket + 1] += triangleStartVec[bucket];
+    triangleIndexVec.resize(numEntries);
+    vector<unsigned int> nextVec(triangleStartVec.begin(), triangleStartVec.end() - 1);
+    for (unsigned int entry = 0; entry < numEntries; ++entry)
+        triangleIndexVec[nextVec[bucketVec[entry]]++] = cellTriangleVec[entry];
+}
+
+void VART::BallSimulation::Solve(unsigned int first, unsigned int end)
+{
+    for (unsigned int ball = first; ball < end; ++ball)
+    {
+        double radius = radiusVec[ball];
+        double mass = massVec[ball];
+        double position[3];
+        double velocity[3];
+        double spin[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            position[i] = positionVecs[i][ball];
+            velocity[i] = velocityVecs[i][ball];
+            spin[i] = spinVecs[i][ball];
+        }
+
+        // Other balls, in the 27 cells around: each ball takes its share (by mass) of the
+        // separation and of the impulse, computed from the previous pass.
+        double correction[3] = { 0, 0, 0 };
+        double deltaV[3] = { 0, 0, 0 };
+        int cell[3] = { cellVecs[0][ball], cellVecs[1][ball], cellVecs[2][ball] };
+        for (int x = cell[0] - 1; x <= cell[0] + 1; ++x)
+            for (int y = cell[1] - 1; y <= cell[1] + 1; ++y)
+                for (int z = cell[2] - 1; z <= cell[2] + 1; ++z)
+                {
+                    unsigned int bucket = Bucket(x, y, z, bucketMask);
+                    for (unsigned int k = bucketStartVec[bucket]; k < bucketStartVec[bucket + 1];
+                         ++k)
+                    {
+                        unsigned int other = sortedVec[k];
+                        // buckets are shared by several cells
+                        if ((other == ball) || (cellVecs[0][other] != x) ||
+                            (cellVecs[1][other] != y) || (cellVecs[2][other] != z))
+                            continue;
+                        double normal[3] = { position[0] - positionVecs[0][other],
+                                             position[1] - positionVecs[1][other],
+                                             position[2] - positionVecs[2][other] };
+                        double distance2 = Dot(normal, normal);
+                        double reach = radius + radiusVec[other];
+                        if ((distance2 >= reach * reach) || (distance2 == 0))
+                            continue;
+                        double distance = sqrt(distance2);
+                        for (int i = 0; i < 3; ++i)
+                            normal[i] /= distance;
+                        double share = massVec[other] / (mass + massVec[other]);
+                        double approach = 0; // relative speed along the normal
+                        for (int i = 0; i < 3; ++i)
+                        {
+                            correction[i] += normal[i] * (reach - distance) * share;
+                            approach += (velocity[i] - velocityVecs[i][other]) * normal[i];
+                        }
+                        if (approach < 0)
+                            for (int i = 0; i < 3; ++i)
+                                deltaV[i] -= normal[i] * (1 + restitution) * approach * share;
+                    }
+                }
+        for (int i = 0; i < 3; ++i)
+        {
+            position[i] += correction[i];
+            velocity[i] += deltaV[i];
+        }
+
+        // Obstacles, one contact after the other
+        if (hasBounds)
+        {
+            const double low[3] = { bounds.GetSmallerX(), bounds.GetSmallerY(),
+                                    bounds.GetSmallerZ() };
+            const double high[3] = { bounds.GetGreaterX(), bounds.GetGreaterY(),
+                                     bounds.GetGreaterZ() };
+            for (int i = 0; i < 3; ++i)
+            {
+                double normal[3] = { 0, 0, 0 };
+                if (position[i] - radius < low[i])
+                {
+                    normal[i] = 1;
+                    Collide(normal, low[i] - (position[i] - radius), radius, position, velocity,
+                            spin);
+                }
+                else if (position[i] + radius > high[i])
+                {
+                    normal[i] = -1;
+                    Collide(normal, position[i] + radius - high[i], radius, position, velocity,
+                            spin);
+                }
+            }
+        }
+        if (terrain)
+        {
+            double height = terrain->GetHeightAt(position[0], position[2]);
+            if (position[1] - height < 2 * radius)
+            {
+                Point4D normalPoint = terrain->GetNormalAt(position[0], position[2]);
+                double normal[3] = { normalPoint.GetX(), normalPoint.GetY(), normalPoint.GetZ() };
+                // distance to the plane that touches the surface under the center
+                double distance = (position[1] - height) * normal[1];
+                if (distance < radius)
+                    Collide(normal, radius - distance, radius, position, velocity, spin);
+            }
+        }
+        if (!triangleIndexVec.empty())
+        {
+            int low[3];
+            int high[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                low[i] = static_cast<int>(floor((position[i] - radius) / triangleCellSize));
+                high[i] = static_cast<int>(floor((position[i] + radius) / triangleCellSize));
+            }
+            for (int x = low[0]; x <= high[0]; ++x)
+                for (int y = low[1]; y <= high[1]; ++y)
+                    for (int z = low[2]; z <= high[2]; ++z)
+                    {
+                        unsigned int bucket = Bucket(x, y, z, triangleMask);
+                        for (unsigned int k = triangleStartVec[bucket];
+                             k < triangleStartVec[bucket + 1]; ++k)
+                        {
+                            // A triangle found twice is harmless: the ball was already
+                            // pushed out of it.
+                            const double* v = &triangleVec[triangleIndexVec[k] * 9];
+                            double closest[3];
+                            ClosestPointOnTriangle(position, v, v + 3, v + 6, closest);
+                            double normal[3] = { position[0] - closest[0],
+                                                 position[1] - closest[1],
+                                                 position[2] - closest[2] };
+                            double distance2 = Dot(normal, normal);
+                            if (distance2 >= radius * radius)
+                                continue;
+                            double distance = sqrt(distance2);
+                            if (distance > 0)
+                            {
+                                for (int i = 0; i < 3; ++i)
+                                    normal[i] /= distance;
+                            }
+                            else
+                            { // center on the triangle: push along its normal
+                                double edge1[3] = { v[3] - v[0], v[4] - v[1], v[5] - v[2] };
+                                double edge2[3] = { v[6] - v[0], v[7] - v[1], v[8] - v[2] };
+                                Cross(edge1, edge2, normal);
+                                double length = sqrt(Dot(normal, normal));
+                                if (length == 0)
+                                    continue;
+                                for (int i = 0; i < 3; ++i)
+                                    normal[i] /= length;
+                            }
+                            Collide(normal, radius - distance, radius, position, velocity,
+                                    spin);
+                        }
+                    }
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            newPositionVecs[i][ball] = position[i];
+            newVelocityVecs[i][ball] = velocity[i];
+            spinVecs[i][ball] = spin[i];
+        }
+    }
+}
+
+void VART::BallSimulation::Collide(const double* normal, double depth, double radius,
+                                   double* position, double* velocity, double* spin) const
+{
+    for (int i = 0; i < 3; ++i)
+        position[i] += normal[i] * depth;
+    double approach = Dot(velocity, normal);
+    if (approach >= 0)
+        return; // already leaving
+    // Slow contacts (e.g.: resting under gravity) do not bounce, or balls would never rest
+    double gravitySpeed = sqrt(Dot(gravity, gravity)) * step;
+    double bounce = (-approach > 2 * gravitySpeed) ? restitution : 0;
+    double normalImpulse = -(1 + bounce) * approach; // per unit of mass
+    for (int i = 0; i < 3; ++i)
+        velocity[i] += normal[i] * normalImpulse;
+
+    // Friction opposes slip at the contact point (velocity + spin x (-normal * radius)).
+    // Stopping it takes 2/7 of it as change of velocity, for a solid ball.
+    double arm[3] = { -normal[0] * radius, -normal[1] * radius, -normal[2] * radius };
+    double slip[3];
+    Cross(spin, arm, slip);
+    for (int i = 0; i < 3; ++i)
+        slip[i] += velocity[i];
+    double slipNormal = Dot(slip, normal);
+    for (int i = 0; i < 3; ++i)
+        slip[i] -= normal[i] * slipNormal;
+    double slipSpeed = sqrt(Dot(slip, slip));
+    if (slipSpeed == 0)
+        return;
+    double impulse = min(2.0 / 7 * slipSpeed, friction * normalImpulse);
+    double frictionV[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        frictionV[i] = -slip[i] / slipSpeed * impulse;
+        velocity[i] += frictionV[i];
+    }
+    // Change of spin: (arm x impulse) / inertia, inertia being 2/5 of mass times radius^2
+    double torque[3];
+    Cross(arm, frictionV, torque);
+    for (int i = 0; i < 3; ++i)
+        spin[i] += torque[i] * 5 / (2 * radius * radius);
+}
+
+void VART::BallSimulation::WriteTransforms(const vector<Transform*>& transformPtrVec) const
+{
+    unsigned int count = min(static_cast<unsigned int>(transformPtrVec.size()), GetNumBalls());
+    Matrix4 matrix;
+    for (unsigned int ball = 0; ball < count; ++ball)
+    {
+        if (transformPtrVec[ball])
+        {
+            GetMatrix(ball, &matrix);
+            transformPtrVec[ball]->SetMatrix(matrix);
+        }
+    }
+}
+
+void VART::BallSimulation::WriteInstances(InstanceGroup* groupPtr) const
+{
+    unsigned int numBalls = GetNumBalls();
+    Matrix4 matrix;
+    for (unsigned int ball = 0; ball < numBalls; ++ball)
+    {
+        GetMatrix(ball, &matrix);
+        if (ball < groupPtr->GetNumInstances())
+            groupPtr->SetMatrix(ball, matrix);
+        else
+            groupPtr->AddInstance(matrix);
+    }
+    groupPtr->ComputeBoundingBox();
+}
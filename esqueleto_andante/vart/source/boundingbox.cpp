@@ -68,17 +68,19 @@ void VART::BoundingBox::ProcessCenter() {
 }
 
 void VART::BoundingBox::ApplyTransform(const VART::Transform& trans) {
-    VART::BoundingBox box = *this;
-
-    VART::Point4D ptoBBox = trans * VART::Point4D(box.GetSmallerX(),box.GetSmallerY(),box.GetSmallerZ());
-    this->SetBoundingBox(ptoBBox.GetX(),ptoBBox.GetY(),ptoBBox.GetZ(),ptoBBox.GetX(),ptoBBox.GetY(),ptoBBox.GetZ());
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetSmallerX(), box.GetSmallerY(), box.GetGreaterZ()));
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetSmallerX(), box.GetGreaterY(), box.GetGreaterZ()));
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetSmallerX(), box.GetGreaterY(), box.GetSmallerZ()));
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetSmallerY(), box.GetSmallerZ()));
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetSmallerY(), box.GetGreaterZ()));
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetGreaterY(), box.GetGreaterZ()));
-    this->ConditionalUpdate(trans * VART::Point4D(box.GetGreaterX(), box.GetGreaterY(), box.GetSmallerZ()));
+    // Transform the 8 corners at once, then take their extremes
+    double corners[24];
+    for (int i = 0; i < 8; ++i) {
+        corners[i*3]   = (i & 1) ? greaterX : smallerX;
+        corners[i*3+1] = (i & 2) ? greaterY : smallerY;
+        corners[i*3+2] = (i & 4) ? greaterZ : smallerZ;
+    }
+    trans.GetMatrix().TransformPoints(corners, corners, 8);
+    smallerX = greaterX = corners[0];
+    smallerY = greaterY = corners[1];
+    smallerZ = greaterZ = corners[2];
+    for (int i = 3; i < 24; i += 3)
+        ConditionalUpdate(corners[i], corners[i+1], corners[i+2]);
     ProcessCenter();
 }
 
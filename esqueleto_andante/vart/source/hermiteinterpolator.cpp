@@ -8,6 +8,7 @@
 using namespace std;
 
 VART::HermiteInterpolator::HermiteInterpolator(float finalTime, float finalPosition)
+    : coefficientsValid(false)
 {
     positionVec.reserve(3);
     timeVec.reserve(3);
@@ -21,34 +22,35 @@ VART::HermiteInterpolator::HermiteInterpolator(float finalTime, float finalPosit
 float VART::HermiteInterpolator::GetValue(float linearIndex) const
 // virtual method
 {
-    // find next position
-    int size = timeVec.size();
-    int next = 1;
-    bool notFinished = true;
-    while ((next < size) && notFinished)
+    if (!coefficientsValid)
+        ComputeCoefficients();
+    // find segment: the one that ends at the first control time not before linearIndex
+    int lastSegment = timeVec.size() - 2;
+    int segment = 0;
+    while ((segment < lastSegment) && (timeVec[segment+1] < linearIndex))
+        ++segment;
+    return EvaluateSegment(segment, linearIndex);
+}
+
+void VART::HermiteInterpolator::GetValues(const float* linearIndices, unsigned int count,
+                                          float initialPos, float range, float* results) const
+// virtual method
+{
+    if (!coefficientsValid)
+        ComputeCoefficients();
+    // Linear indices usually come in increasing order, so the search for each segment
+    // starts at the previous one.
+    int lastSegment = timeVec.size() - 2;
+    int segment = 0;
+    for (unsigned int i = 0; i < count; ++i)
     {
-        if (timeVec[next] >= linearIndex)
-            notFinished = false;
-        else
-            ++next;
+        float linearIndex = linearIndices[i];
+        if (timeVec[segment] >= linearIndex)
+            segment = 0;
+        while ((segment < lastSegment) && (timeVec[segment+1] < linearIndex))
+            ++segment;
+        results[i] = EvaluateSegment(segment, linearIndex);
     }
-
-    // find previous position
-    int previous = next - 1;
-
-    const float tension = 0.25;
-    float prevPos = positionVec[previous];
-    float nextPos = positionVec[next];
-    float befPrevPos = positionVec[WarpIndex(previous - 1)];
-    float aftNextPos = positionVec[WarpIndex(next + 1)];
-    // find previous tangent
-    float prevTg = tension * (nextPos - befPrevPos);
-    // find next tangent
-    float nextTg = tension * (prevPos - aftNextPos);
-    // find linear index relative to control times
-    float t = (linearIndex - timeVec[previous]) / (timeVec[next] - timeVec[previous]);
-    // interpolate
-    return Interpolate(prevPos, prevTg, nextPos, nextTg, t);
 }
 
 void VART::HermiteInterpolator::AddControlPosition(float pos, float time)
@@ -60,6 +62,7 @@ void VART::HermiteInterpolator::AddControlPosition(float pos, float time)
     // add given values
     positionVec[lastIndex] = pos;
     timeVec[lastIndex] = time;
+    coefficientsValid = false;
 }
 
 float VART::HermiteInterpolator::Interpolate(float p1, float tg1, float p2, float tg2, float t)
@@ -71,10 +74,42 @@ float VART::HermiteInterpolator::Interpolate(float p1, float tg1, float p2, floa
          + ((3 * t2) - (2 * t3)) * p2
          + (t3 - (2 * t2) + t) * tg1
          + (t3 - t2) * tg2;
-    cout << p1 << " " << tg1 << " " << p2 << " " << tg2 << " " << t << " => " << result << "\n";
     return result;
 }
 
+void VART::HermiteInterpolator::ComputeCoefficients() const
+// protected
+{
+    const float tension = 0.25;
+    int numSegments = timeVec.size() - 1;
+    coefficientVec.resize(numSegments * 6);
+    for (int previous = 0; previous < numSegments; ++previous)
+    {
+        int next = previous + 1;
+        float prevPos = positionVec[previous];
+        float nextPos = positionVec[next];
+        float prevTg = tension * (nextPos - positionVec[WarpIndex(previous - 1)]);
+        float nextTg = tension * (prevPos - positionVec[WarpIndex(next + 1)]);
+        float* coef = &coefficientVec[previous * 6];
+        coef[0] = timeVec[previous];
+        coef[1] = 1.0f / (timeVec[next] - timeVec[previous]);
+        // Interpolate() in power basis
+        coef[2] = prevPos;
+        coef[3] = prevTg;
+        coef[4] = 3 * (nextPos - prevPos) - 2 * prevTg - nextTg;
+        coef[5] = 2 * (prevPos - nextPos) + prevTg + nextTg;
+    }
+    coefficientsValid = true;
+}
+
+float VART::HermiteInterpolator::EvaluateSegment(int segment, float linearIndex) const
+// protected
+{
+    const float* coef = &coefficientVec[segment * 6];
+    float t = (linearIndex - coef[0]) * coef[1];
+    return coef[2] + t * (coef[3] + t * (coef[4] + t * coef[5]));
+}
+
 int VART::HermiteInterpolator::WarpIndex(int i) const
 // protected
 {
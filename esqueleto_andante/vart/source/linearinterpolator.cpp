@@ -23,3 +23,11 @@ float VART::LinearInterpolator::GetValue(float linearIndex, float initialPos, fl
 {
     return linearIndex * range + initialPos;
 }
+
+void VART::LinearInterpolator::GetValues(const float* linearIndices, unsigned int count,
+                                         float initialPos, float range, float* results) const
+// virtual method
+{
+    for (unsigned int i = 0; i < count; ++i)
+        results[i] = linearIndices[i] * range + initialPos;
+}
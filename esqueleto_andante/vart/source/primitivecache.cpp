@@ -0,0 +1,320 @@
+/// \file primitivecache.cpp
+/// \brief Implementation file for V-ART class "PrimitiveCache".
+/// \version $Revision: 1.1 $
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#ifdef VART_OGL
+#include <GL/gl.h>
+#endif
+#include "vart/primitivecache.h"
+#include "vart/framestats.h"
+#include <cmath>
+
+using namespace std;
+
+// Sizes on screen (in pixels, the diameter of the object) from which each level but the
+// first is used
+static const double LEVEL_SIZES[VART::PrimitiveCache::NUM_LEVELS - 1] = { 16, 64, 256 };
+
+// Slices of each level (stacks of spheres are 3/4 of that)
+static const unsigned int LEVEL_SLICES[VART::PrimitiveCache::NUM_LEVELS] = { 8, 16, 32, 64 };
+// Frustum radii are rounded to multiples of 1/RADIUS_STEPS, so that animated radii share a
+// bounded number of tessellations
+static const float RADIUS_STEPS = 256;
+
+static float RoundRadius(float radius)
+{
+    if (radius < 0)
+        radius = 0;
+    else if (radius > 1)
+        radius = 1;
+    return floor(radius * RADIUS_STEPS + 0.5f) / RADIUS_STEPS;
+}
+
+bool VART::PrimitiveCache::Tessellation::DrawOGL(bool textured) const
+{
+#ifdef VART_OGL
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, 0, &coordVec[0]);
+    glNormalPointer(GL_FLOAT, 0, &normVec[0]);
+    unsigned long bytes = (coordVec.size() + normVec.size()) * sizeof(float);
+    if (textured)
+    {
+        glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        glTexCoordPointer(2, GL_FLOAT, 0, &texCoordVec[0]);
+        bytes += texCoordVec.size() * sizeof(float);
+    }
+    else
+        glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDrawElements(GL_TRIANGLES, indexVec.size(), GL_UNSIGNED_INT, &indexVec[0]);
+    ++FrameStats::current.drawCalls[Mesh::TRIANGLES];
+    FrameStats::current.indices[Mesh::TRIANGLES] += indexVec.size();
+    FrameStats::current.vertexBytes += bytes;
+    return true;
+#else
+    return false;
+#endif
+}
+
+VART::PrimitiveCache& VART::PrimitiveCache::Instance()
+{
+    static PrimitiveCache cache;
+    return cache;
+}
+
+unsigned int VART::PrimitiveCache::GetSlices(unsigned int level)
+{
+    return LEVEL_SLICES[(level < NUM_LEVELS) ? level : NUM_LEVELS - 1];
+}
+
+VART::PrimitiveCache::PrimitiveCache() : detail(1)
+{
+    for (unsigned int level = 0; level < NUM_LEVELS; ++level)
+    {
+        spheres[level] = NULL;
+        disks[level][0] = NULL;
+        disks[level][1] = NULL;
+    }
+}
+
+VART::PrimitiveCache::~PrimitiveCache()
+{
+    Clear();
+}
+
+const VART::PrimitiveCache::Tessellation& VART::PrimitiveCache::GetSphere(unsigned int level)
+{
+    if (level >= NUM_LEVELS)
+        level = NUM_LEVELS - 1;
+    if (!spheres[level])
+    {
+        spheres[level] = new Tessellation;
+        TessellateSphere(LEVEL_SLICES[level], LEVEL_SLICES[level] * 3 / 4, spheres[level]);
+    }
+    return *spheres[level];
+}
+
+const VART::PrimitiveCache::Tessellation& VART::PrimitiveCache::GetFrustum(
+    unsigned int level, float bottomRadius, float topRadius)
+{
+    if (level >= NUM_LEVELS)
+        level = NUM_LEVELS - 1;
+    bottomRadius = RoundRadius(bottomRadius);
+    topRadius = RoundRadius(topRadius);
+    Tessellation*& tessPtr = frustums[level][make_pair(bottomRadius, topRadius)];
+    if (!tessPtr)
+    {
+        tessPtr = new Tessellation;
+        TessellateFrustum(LEVEL_SLICES[level], bottomRadius, topRadius, tessPtr);
+    }
+    return *tessPtr;
+}
+
+const VART::PrimitiveCache::Tessellation& VART::PrimitiveCache::GetDisk(unsigned int level,
+                                                                        bool facingUp)
+{
+    if (level >= NUM_LEVELS)
+        level = NUM_LEVELS - 1;
+    Tessellation*& tessPtr = disks[level][facingUp ? 1 : 0];
+    if (!tessPtr)
+    {
+        tessPtr = new Tessellation;
+        TessellateDisk(LEVEL_SLICES[level], facingUp, tessPtr);
+    }
+    return *tessPtr;
+}
+
+unsigned int VART::PrimitiveCache::SelectLevel(double radius) const
+{
+#ifdef VART_OGL
+    GLdouble modelview[16];
+    GLdouble projection[16];
+    GLint viewport[4];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelview);
+    glGetDoublev(GL_PROJECTION_MATRIX, projection);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    // Radius in eye coordinates, scaled by the longest axis of the modelview matrix
+    double scale2 = 0;
+    for (unsigned int col = 0; col < 12; col += 4)
+    {
+        double axis2 = modelview[col] * modelview[col] + modelview[col+1] * modelview[col+1]
+                       + modelview[col+2] * modelview[col+2];
+        if (axis2 > scale2)
+            scale2 = axis2;
+    }
+    double eyeRadius = radius * sqrt(scale2);
+    // The origin in eye coordinates is the translation of the modelview matrix
+    double x = modelview[12];
+    double y = modelview[13];
+    double z = modelview[14];
+    if (x*x + y*y + z*z <= eyeRadius * eyeRadius)
+        return NUM_LEVELS - 1;
+    // Clip W of the origin (its depth, for perspective projections; 1 for orthographic)
+    double w = projection[3] * x + projection[7] * y + projection[11] * z + projection[15];
+    double wSpread = eyeRadius * sqrt(projection[3] * projection[3]
+                                      + projection[7] * projection[7]
+                                      + projection[11] * projection[11]);
+    if (w + wSpread <= 0) // behind the camera
+        return 0;
+    if (w - wSpread <= 0) // crossing the plane of the camera
+        return NUM_LEVELS - 1;
+    // Diameter in pixels, along the greater of the viewport dimensions
+    double sizeX = fabs(projection[0]) * viewport[2];
+    double sizeY = fabs(projection[5]) * viewport[3];
+    double size = detail * eyeRadius * ((sizeX > sizeY) ? sizeX : sizeY) / w;
+    unsigned int level = 0;
+    while ((level < NUM_LEVELS - 1) && (size >= LEVEL_SIZES[level]))
+        ++level;
+    return level;
+#else
+    return NUM_LEVELS - 1;
+#endif
+}
+
+unsigned int VART::PrimitiveCache::GetNumTessellations() const
+{
+    unsigned int result = 0;
+    for (unsigned int level = 0; level < NUM_LEVELS; ++level)
+    {
+        result += (spheres[level] ? 1 : 0) + (disks[level][0] ? 1 : 0)
+                  + (disks[level][1] ? 1 : 0) + frustums[level].size();
+    }
+    return result;
+}
+
+void VART::PrimitiveCache::Clear()
+{
+    for (unsigned int level = 0; level < NUM_LEVELS; ++level)
+    {
+        delete spheres[level];
+        delete disks[level][0];
+        delete disks[level][1];
+        spheres[level] = NULL;
+        disks[level][0] = NULL;
+        disks[level][1] = NULL;
+        map<pair<float,float>, Tessellation*>::iterator iter = frustums[level].begin();
+        for (; iter != frustums[level].end(); ++iter)
+            delete iter->second;
+        frustums[level].clear();
+    }
+}
+
+// Like gluSphere: "slices" meridians from +Y towards -X, "stacks" parallels from +Z down.
+// The first and last meridians are the same, with different texture coordinates.
+void VART::PrimitiveCache::TessellateSphere(unsigned int slices, unsigned int stacks,
+                                            Tessellation* resultPtr)
+{
+    const double dRho = M_PI / stacks;
+    const double dTheta = 2 * M_PI / slices;
+    unsigned int rowSize = slices + 1;
+    resultPtr->coordVec.reserve((stacks + 1) * rowSize * 3);
+    resultPtr->texCoordVec.reserve((stacks + 1) * rowSize * 2);
+    for (unsigned int i = 0; i <= stacks; ++i)
+    {
+        double rho = i * dRho;
+        for (unsigned int j = 0; j <= slices; ++j)
+        {
+            double theta = (j == slices) ? 0 : j * dTheta;
+            resultPtr->coordVec.push_back(-sin(theta) * sin(rho));
+            resultPtr->coordVec.push_back(cos(theta) * sin(rho));
+            resultPtr->coordVec.push_back(cos(rho));
+            resultPtr->texCoordVec.push_back(static_cast<float>(j) / slices);
+            resultPtr->texCoordVec.push_back(1 - static_cast<float>(i) / stacks);
+        }
+    }
+    // Unit sphere: normals are the coordinates
+    resultPtr->normVec = resultPtr->coordVec;
+    for (unsigned int i = 0; i < stacks; ++i)
+        for (unsigned int j = 0; j < slices; ++j)
+        {
+            unsigned int upperLeft = i * rowSize + j;
+            unsigned int lowerLeft = upperLeft + rowSize;
+            if (i > 0) // at the top, upper vertices are the same
+            {
+                resultPtr->indexVec.push_back(upperLeft);
+                resultPtr->indexVec.push_back(lowerLeft);
+                resultPtr->indexVec.push_back(upperLeft + 1);
+            }
+            if (i < stacks - 1) // at the bottom, lower vertices are the same
+            {
+                resultPtr->indexVec.push_back(upperLeft + 1);
+                resultPtr->indexVec.push_back(lowerLeft);
+                resultPtr->indexVec.push_back(lowerLeft + 1);
+            }
+        }
+}
+
+// Like gluCylinder with a single stack: bottom ring first, then top ring.
+void VART::PrimitiveCache::TessellateFrustum(unsigned int slices, float bottomRadius,
+                                             float topRadius, Tessellation* resultPtr)
+{
+    const double dTheta = 2 * M_PI / slices;
+    const double radii[2] = { bottomRadius, topRadius };
+    unsigned int rowSize = slices + 1;
+    // Normals lean by the difference of radii (height is 1)
+    double normalZ = bottomRadius - topRadius;
+    double normalScale = 1 / sqrt(1 + normalZ * normalZ);
+    for (unsigned int ring = 0; ring < 2; ++ring)
+        for (unsigned int j = 0; j <= slices; ++j)
+        {
+            double theta = (j == slices) ? 0 : j * dTheta;
+            double x = sin(theta);
+            double y = cos(theta);
+            resultPtr->coordVec.push_back(x * radii[ring]);
+            resultPtr->coordVec.push_back(y * radii[ring]);
+            resultPtr->coordVec.push_back(ring);
+            resultPtr->normVec.push_back(x * normalScale);
+            resultPtr->normVec.push_back(y * normalScale);
+            resultPtr->normVec.push_back(normalZ * normalScale);
+            resultPtr->texCoordVec.push_back(static_cast<float>(j) / slices);
+            resultPtr->texCoordVec.push_back(ring);
+        }
+    for (unsigned int j = 0; j < slices; ++j)
+    {
+        if (bottomRadius > 0)
+        {
+            resultPtr->indexVec.push_back(j);
+            resultPtr->indexVec.push_back(rowSize + j);
+            resultPtr->indexVec.push_back(j + 1);
+        }
+        if (topRadius > 0)
+        {
+            resultPtr->indexVec.push_back(j + 1);
+            resultPtr->indexVec.push_back(rowSize + j);
+            resultPtr->indexVec.push_back(rowSize + j + 1);
+        }
+    }
+}
+
+// Like gluDisk with no inner radius and a single loop: the center, then the rim.
+void VART::PrimitiveCache::TessellateDisk(unsigned int slices, bool facingUp,
+                                          Tessellation* resultPtr)
+{
+    const double dTheta = 2 * M_PI / slices;
+    float normalZ = facingUp ? 1 : -1;
+    for (unsigned int j = 0; j <= slices; ++j)
+    {
+        // vertex 0 is the center
+        double x = (j == 0) ? 0 : sin((j - 1) * dTheta);
+        double y = (j == 0) ? 0 : cos((j - 1) * dTheta);
+        resultPtr->coordVec.push_back(x);
+        resultPtr->coordVec.push_back(y);
+        resultPtr->coordVec.push_back(0);
+        resultPtr->normVec.push_back(0);
+        resultPtr->normVec.push_back(0);
+        resultPtr->normVec.push_back(normalZ);
+        resultPtr->texCoordVec.push_back(0.5 + x / 2);
+        resultPtr->texCoordVec.push_back(0.5 + y / 2);
+    }
+    // The rim goes clockwise, seen from above
+    for (unsigned int j = 1; j <= slices; ++j)
+    {
+        unsigned int next = (j == slices) ? 1 : j + 1;
+        resultPtr->indexVec.push_back(0);
+        resultPtr->indexVec.push_back(facingUp ? next : j);
+        resultPtr->indexVec.push_back(facingUp ? j : next);
+    }
+}
@@ -3,11 +3,16 @@
 /// \version $Revision: 1.12 $
 
 #include "vart/scene.h"
+#include "vart/framestats.h"
+#include "vart/profiler.h"
 #include "vart/graphicobj.h"
 #include "vart/transform.h"
+#include "vart/snoperator.h"
 #include "vart/picknamelocator.h"
+#include "vart/xmlwriter.h"
 
 #include <cassert>
+#include <cstring>
 #ifdef VART_OGL
 #include <GL/gl.h>
 #endif
@@ -174,6 +179,7 @@ void VART::Scene::SetBackgroundColor(VART::Color color) {
 
 // cameraPtr defauts to NULL
 bool VART::Scene::DrawOGL(Camera* cameraPtr) const {
+    VART_PROFILE_ZONE("Scene::DrawOGL");
 #ifdef VART_OGL
     // LookAT
     if (cameraPtr)
@@ -196,6 +202,9 @@ bool VART::Scene::DrawOGL(Camera* cameraPtr) const {
     }
     if (bBox.visible)
         bBox.DrawInstanceOGL();
+    // The frame ends: hand its counts over to the scene
+    frameStats = FrameStats::current;
+    FrameStats::current.Clear();
     return true;
 #else
     return false;
@@ -211,6 +220,7 @@ bool VART::Scene::DrawLightsOGL() const {
     {
         (*iter)->DrawOGL(lightID);
         ++lightID;
+        ++FrameStats::current.lightsSet;
     }
     return true;
 #else
@@ -218,6 +228,73 @@ bool VART::Scene::DrawLightsOGL() const {
 #endif
 }
 
+// Hashes scene state that affects drawing (see Scene::ComputeStateHash), mixing 64 bit
+// words in the manner of FNV-1a
+class StateHasher : public VART::SNOperator {
+    public:
+        StateHasher() : hash(14695981039346656037ULL) {}
+        void Add(unsigned long long word) { hash = (hash ^ word) * 1099511628211ULL; }
+        void Add(const double* valuePtr, unsigned int count)
+        {
+            unsigned long long word;
+            for (unsigned int i = 0; i < count; ++i)
+            {
+                memcpy(&word, valuePtr + i, sizeof(word));
+                Add(word);
+            }
+        }
+        void Add(double value) { Add(&value, 1); }
+        void Add(const VART::Point4D& point) { Add(point.VetXYZW(), 4); }
+        virtual void OperateOn(const VART::SceneNode* nodePtr)
+        {
+            // Node addresses account for changes of structure
+            Add(reinterpret_cast<unsigned long long>(nodePtr));
+            const VART::Transform* transPtr = dynamic_cast<const VART::Transform*>(nodePtr);
+            if (transPtr)
+                Add(transPtr->GetData(), 16);
+        }
+        unsigned long long hash;
+};
+
+unsigned long long VART::Scene::ComputeStateHash() const {
+    StateHasher hasher;
+    list<VART::SceneNode*>::const_iterator iter;
+    for (iter = objects.begin(); iter != objects.end(); ++iter)
+        (*iter)->TraverseDepthFirst(&hasher);
+    list<VART::Camera*>::const_iterator camIter;
+    for (camIter = cameras.begin(); camIter != cameras.end(); ++camIter)
+    {
+        hasher.Add(static_cast<unsigned long long>(camIter == currentCamera));
+        hasher.Add((*camIter)->GetLocation());
+        hasher.Add((*camIter)->GetTarget());
+        hasher.Add((*camIter)->GetUp());
+        hasher.Add((*camIter)->GetFovY());
+        hasher.Add((*camIter)->GetAspectRatio());
+        hasher.Add((*camIter)->GetNearPlaneDistance());
+        hasher.Add((*camIter)->GetFarPlaneDistance());
+    }
+    list<const VART::Light*>::const_iterator lightIter;
+    for (lightIter = lights.begin(); lightIter != lights.end(); ++lightIter)
+    {
+        const VART::Light* lightPtr = *lightIter;
+        hasher.Add(static_cast<unsigned long long>(lightPtr->IsOn()));
+        hasher.Add(lightPtr->GetIntensity());
+        hasher.Add(lightPtr->GetAmbientIntensity());
+        VART::Color color = lightPtr->GetColor();
+        // Channels are widened before shifting: a red of 128 or more would reach the sign
+        // bit of an int
+        unsigned long long rgba = static_cast<unsigned long long>(color.GetR()) << 24;
+        rgba |= static_cast<unsigned long long>(color.GetG()) << 16;
+        rgba |= static_cast<unsigned long long>(color.GetB()) << 8;
+        rgba |= color.GetA();
+        hasher.Add(rgba);
+        hasher.Add(lightPtr->GetLocation());
+        if (lightPtr->GetTransform())
+            hasher.Add(lightPtr->GetTransform()->GetData(), 16);
+    }
+    return hasher.hash;
+}
+
 VART::Camera* VART::Scene::GetCurrentCamera() const {
     if (currentCamera == cameras.end())
         return NULL;
@@ -266,6 +343,7 @@ void VART::Scene::ChangeAllCamerasViewVolume(float horScale, float verScale) {
 }
 
 bool VART::Scene::ComputeBoundingBox() {
+    VART_PROFILE_ZONE("Scene::ComputeBoundingBox");
     VART::BoundingBox box;
     bool initBBox = false;
     list<VART::SceneNode*>::const_iterator iter;
@@ -381,6 +459,7 @@ std::list<VART::SceneNode*> VART::Scene::GetAllSceneTypeObject( VART::SceneNode:
 
 void VART::Scene::Pick(int x, int y, list<GraphicObj*>* resultListPtr)
 {
+    VART_PROFILE_ZONE("Scene::Pick");
 #ifdef VART_OGL
     const static int SELECTION_BUFFER_SIZE = 512; // FixMe: find a better place to put this!
 
@@ -452,17 +531,26 @@ void VART::Scene::Pick(int x, int y, list<GraphicObj*>* resultListPtr)
 }
 
 void VART::Scene::XmlPrintOn(ostream& os) const
+{
+    XmlWriter writer;
+    XmlWrite(&writer);
+    writer.WriteTo(os);
+}
+
+void VART::Scene::XmlWrite(XmlWriter* writerPtr) const
 {
     list<VART::SceneNode*>::const_iterator iter;
 
-    os << "<?xml version=\"1.0\"?>\n"
-       << "<!DOCTYPE scene SYSTEM \"vartScene.dtd\">\n"
-       << "<scene description=\"" << description << "\">\n";
+    writerPtr->Append("<?xml version=\"1.0\"?>\n"
+                      "<!DOCTYPE scene SYSTEM \"vartScene.dtd\">\n"
+                      "<scene description=\"");
+    writerPtr->Append(description);
+    writerPtr->Append("\">\n");
     for (iter = objects.begin(); iter != objects.end(); ++iter)
     {
-        os << "  <node>\n";
-        (*iter)->XmlPrintOn(os, 4);
-        os << "  </node>\n";
+        writerPtr->Append("  <node>\n");
+        (*iter)->XmlWrite(writerPtr, 4);
+        writerPtr->Append("  </node>\n");
     }
-    os << "</scene>\n";
+    writerPtr->Append("</scene>\n");
 }
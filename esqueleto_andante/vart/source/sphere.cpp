@@ -9,6 +9,7 @@
 #include <GL/glu.h>
 #endif
 #include "vart/sphere.h"
+#include "vart/primitivecache.h"
 #include <iostream>
 
 using namespace std;
@@ -62,20 +63,21 @@ void VART::Sphere::ComputeBoundingBox() {
 
 bool VART::Sphere::DrawInstanceOGL() const {
 #ifdef VART_OGL
-    GLUquadricObj* qObj = gluNewQuadric();
     bool result = true;
 
     if (show)
     {
-        if( material.GetTexture().HasData() )
-        {
-            gluQuadricTexture(qObj,GL_TRUE);
-        }
+        PrimitiveCache& cache = PrimitiveCache::Instance();
+        unsigned int level = cache.SelectLevel(radius);
         result = material.DrawOGL();
-        gluQuadricDrawStyle(qObj, GLU_FILL);
-        gluQuadricNormals(qObj, GLU_SMOOTH);
-        gluSphere(qObj, radius, 15, 15);
-        gluDeleteQuadric(qObj);
+        GLboolean normalize = glIsEnabled(GL_NORMALIZE);
+        glEnable(GL_NORMALIZE);
+        glPushMatrix();
+        glScalef(radius, radius, radius);
+        result &= cache.GetSphere(level).DrawOGL(material.GetTexture().HasData());
+        glPopMatrix();
+        if (!normalize)
+            glDisable(GL_NORMALIZE);
     }
     if (bBox.visible)
         bBox.DrawInstanceOGL();
@@ -0,0 +1,118 @@
+/// \file xmlwriter.cpp
+/// \brief Implementation file for V-ART class "XmlWriter".
+/// \version $Revision: 1.1 $
+
+#include "vart/xmlwriter.h"
+
+#include <fstream>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+using namespace std;
+
+// Powers of ten, exact in double precision
+static const double POWERS_OF_TEN[] = { 1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+VART::XmlWriter::XmlWriter()
+{
+    buffer.reserve(4096);
+}
+
+void VART::XmlWriter::Append(const char* text)
+{
+    buffer.insert(buffer.end(), text, text + strlen(text));
+}
+
+void VART::XmlWriter::Append(const string& text)
+{
+    buffer.insert(buffer.end(), text.begin(), text.end());
+}
+
+void VART::XmlWriter::Append(double value)
+{
+    char text[32];
+    buffer.insert(buffer.end(), text, text + FormatNumber(value, text));
+}
+
+void VART::XmlWriter::Append(const char* before, double value, const char* after)
+{
+    Append(before);
+    Append(value);
+    Append(after);
+}
+
+void VART::XmlWriter::WriteTo(ostream& os) const
+{
+    if (!buffer.empty())
+        os.write(&buffer[0], buffer.size());
+}
+
+bool VART::XmlWriter::SaveToFile(const string& fileName) const
+{
+    ofstream file(fileName.c_str(), ios::binary);
+    WriteTo(file);
+    return static_cast<bool>(file);
+}
+
+unsigned int VART::XmlWriter::FormatNumber(double value, char* text)
+// Numbers in [1e-4, 1e6) are printed by "%g" in fixed notation, with 6 significant digits
+// and no trailing zeros. These are rounded here, unless too close to a tie for the rounding
+// to be sure. Others go through snprintf.
+{
+    char* ptr = text;
+    double magnitude = fabs(value);
+    if (magnitude == 0)
+    {
+        if (signbit(value))
+            *ptr++ = '-';
+        *ptr++ = '0';
+        return ptr - text;
+    }
+    if ((magnitude >= 1e-4) && (magnitude < 1e6))
+    {
+        int exponent = static_cast<int>(floor(log10(magnitude)));
+        if ((exponent >= -4) && (exponent <= 5))
+        {
+            double scaled = magnitude * POWERS_OF_TEN[5 - exponent];
+            double rounded = floor(scaled + 0.5);
+            if ((fabs(scaled - floor(scaled) - 0.5) > 1e-6)
+                && (rounded >= 100000) && (rounded < 1000000))
+            {
+                char digits[6];
+                unsigned int number = static_cast<unsigned int>(rounded);
+                for (int i = 5; i >= 0; --i)
+                {
+                    digits[i] = static_cast<char>('0' + number % 10);
+                    number /= 10;
+                }
+                unsigned int integerDigits = (exponent >= 0) ? exponent + 1 : 0;
+                unsigned int numDigits = 6;
+                while ((numDigits > integerDigits) && (digits[numDigits-1] == '0'))
+                    --numDigits;
+                if (value < 0)
+                    *ptr++ = '-';
+                if (integerDigits > 0)
+                {
+                    memcpy(ptr, digits, integerDigits);
+                    ptr += integerDigits;
+                }
+                else
+                    *ptr++ = '0';
+                if (numDigits > integerDigits)
+                {
+                    *ptr++ = '.';
+                    for (int i = exponent + 1; i < 0; ++i)
+                        *ptr++ = '0';
+                    memcpy(ptr, digits + integerDigits, numDigits - integerDigits);
+                    ptr += numDigits - integerDigits;
+                }
+                return ptr - text;
+            }
+        }
+    }
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), "%g", value);
+    memcpy(text, buffer, length);
+    return length;
+}
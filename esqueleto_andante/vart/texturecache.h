@@ -0,0 +1,158 @@
+/// \file texturecache.h
+/// \brief Header file for V-ART class "TextureCache".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_TEXTURECACHE_H
+#define VART_TEXTURECACHE_H
+
+#include "vart/workqueue.h"
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+
+namespace VART {
+/// \class TextureCache texturecache.h
+/// \brief Shared cache of texture images.
+///
+/// Every texture read from a file is an image in the texture cache. Files are known by their
+/// canonical path and images by their contents, so that an image is decoded and uploaded
+/// once, no matter how many materials use it, under how many names.
+///
+/// Images are decoded by worker threads into a chain of mipmaps (built on the CPU, with a
+/// box filter). The thread with an OpenGL context uploads them when they are first needed
+/// (see Texture::DrawOGL and Texture::LoadFromFile) and the decoded data is then freed.
+///
+/// Binary PNM images (.ppm and .pgm) are decoded by V-ART itself; other formats require the
+/// Developer Image Library (see Texture) and are decoded one at a time.
+///
+/// A budget may limit the texture memory used. Uploading an image that does not fit evicts
+/// the least recently drawn images, which are decoded again when next needed.
+    class TextureCache {
+        public:
+        // PUBLIC NESTED CLASSES
+            /// \brief An image in the cache.
+            ///
+            /// Textures refer to images. Images stay in the cache until it is cleared.
+            class Image {
+                friend class TextureCache;
+                public:
+                    /// \brief Returns the canonical path of the first file with the image.
+                    const std::string& GetFileName() const { return fileName; }
+                    /// \brief Indicates whether the image could not be decoded.
+                    bool HasFailed() const { return failed; }
+                protected:
+                    Image(const std::string& name);
+                    std::string fileName;
+                    /// Size of the largest mipmap level.
+                    unsigned int width;
+                    unsigned int height;
+                    /// RGBA mipmap levels, largest first, while decoded and not uploaded.
+                    std::vector<unsigned char> pixelVec;
+                    /// Whether a decoding job has been queued and has not finished.
+                    bool decoding;
+                    bool decoded;
+                    bool failed;
+                    // The following are used only by the thread with the OpenGL context.
+                    bool resident;
+                    unsigned int textureId;
+                    unsigned long textureBytes;
+                    std::list<Image*>::iterator residentPos;
+            };
+        // PUBLIC STATIC METHODS
+            /// \brief Returns the cache shared by all textures.
+            static TextureCache& Instance();
+        // PUBLIC METHODS
+            /// \brief Requests an image file, starting to decode it if not in the cache.
+            /// \return The image, or NULL if the file could not be read. Errors are reported
+            /// to cerr.
+            ///
+            /// Reads the file (to identify its contents) but does not decode it, so it may be
+            /// called by any thread.
+            Image* Request(const std::string& fileName);
+
+            /// \brief Returns the OpenGL texture of an image, uploading it if decoded.
+            /// \return Zero if the image has not been decoded yet, or could not be.
+            ///
+            /// Must be called with a current OpenGL context. Marks the image as the most
+            /// recently used. If the image has been evicted, decoding starts again.
+            unsigned int GetTextureId(Image* imagePtr);
+
+            /// \brief Returns the OpenGL texture of an image, waiting for it to be decoded.
+            /// \return Zero if the image could not be decoded.
+            ///
+            /// Must be called with a current OpenGL context.
+            unsigned int WaitTextureId(Image* imagePtr);
+
+            /// \brief Sets the texture memory budget in bytes (zero, the default, means no
+            /// limit).
+            void SetBudget(unsigned long value) { budget = value; }
+
+            /// \brief Returns the texture memory budget in bytes.
+            unsigned long GetBudget() const { return budget; }
+
+            /// \brief Returns the texture memory in use, in bytes.
+            unsigned long GetTextureBytes() const { return textureBytes; }
+
+            /// \brief Sets the number of worker threads (default: number of processors).
+            ///
+            /// Takes effect before the first request.
+            void SetNumThreads(unsigned int value) { workQueue.SetNumThreads(value); }
+
+            /// \brief Returns the number of images in the cache.
+            unsigned int GetNumImages() const;
+
+            /// \brief Returns the number of images decoded so far.
+            unsigned long GetNumDecoded() const { return numDecoded; }
+
+            /// \brief Returns the number of images uploaded so far.
+            unsigned long GetNumUploaded() const { return numUploaded; }
+
+            /// \brief Removes every image from the cache.
+            ///
+            /// Must be called with a current OpenGL context, when no texture refers to cached
+            /// images.
+            void Clear();
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief Job that decodes an image.
+            class DecodeJob;
+        // PROTECTED METHODS
+            TextureCache();
+            ~TextureCache();
+            /// \brief Queues an image for decoding. Requires the lock.
+            void QueueDecoding(Image* imagePtr, std::vector<unsigned char>* dataPtr);
+            /// \brief Decodes an image. Called by worker threads.
+            void Decode(Image* imagePtr, std::vector<unsigned char>* dataPtr);
+            /// \brief Uploads a decoded image, evicting others to fit the budget.
+            unsigned int Upload(Image* imagePtr);
+            /// \brief Evicts an image from texture memory.
+            void Evict(Image* imagePtr);
+        // PROTECTED STATIC METHODS
+            /// \brief Decodes a binary PNM image into RGBA, bottom row first.
+            static bool DecodePNM(const std::vector<unsigned char>& data, unsigned int* widthPtr,
+                                  unsigned int* heightPtr, std::vector<unsigned char>* resultPtr);
+            /// \brief Appends mipmap levels to an RGBA image.
+            static void BuildMipmaps(unsigned int width, unsigned int height,
+                                     std::vector<unsigned char>* pixelVecPtr);
+        // PROTECTED ATTRIBUTES
+            /// \brief Images by canonical file path.
+            std::map<std::string, Image*> fileMap;
+            /// \brief Images by contents (hash and size of their files).
+            std::map<std::pair<unsigned long long, size_t>, Image*> contentMap;
+            /// \brief Images in texture memory, most recently used first.
+            std::list<Image*> residentList;
+            WorkQueue workQueue;
+            unsigned long budget;
+            unsigned long textureBytes;
+            unsigned long numDecoded;
+            unsigned long numUploaded;
+            mutable std::mutex cacheMutex;
+            /// \brief Signals that images were decoded.
+            std::condition_variable decoded;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -0,0 +1,88 @@
+/// \file framepacer.h
+/// \brief Header file for V-ART class "FramePacer".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_FRAMEPACER_H
+#define VART_FRAMEPACER_H
+
+#include <ctime>
+
+namespace VART {
+/// \class FramePacer framepacer.h
+/// \brief Schedules frames at a target rate and measures how well the rate is kept.
+///
+/// A paced main loop asks whether a frame is due (FrameDue) and, when it is not, sleeps
+/// until it is (TimeToNextFrame, Sleep), instead of spinning. Frames that fall behind
+/// are dropped rather than drawn in a burst.
+///
+/// Statistics are kept since the last Reset: intervals between frames drawn (mean and
+/// standard deviation), jitter (how late due frames were noticed, mostly sleep
+/// overshoot) and CPU usage of the process (CPU time over real time, which may exceed 1
+/// with several threads).
+    class FramePacer {
+        public:
+        // PUBLIC NESTED CLASSES
+            /// \brief Pacing statistics (times in seconds).
+            class Stats {
+                public:
+                    /// Frames drawn.
+                    unsigned long frames;
+                    /// Frames due that were not drawn (e.g.: nothing changed).
+                    unsigned long skippedFrames;
+                    double meanFrameTime;
+                    double frameTimeStdDev;
+                    double meanJitter;
+                    double maxJitter;
+                    double cpuUsage;
+            };
+        // PUBLIC STATIC METHODS
+            /// \brief Suspends the calling thread for given time (in seconds).
+            static void Sleep(double seconds);
+        // PUBLIC METHODS
+            /// \brief Creates an unpaced pacer.
+            FramePacer();
+            /// \brief Sets the target frame rate.
+            ///
+            /// Zero (the default) means not paced: every frame is due.
+            void SetFrameRate(double framesPerSecond);
+            /// \brief Returns the target frame rate (zero if not paced).
+            double GetFrameRate() const { return (period > 0) ? 1 / period : 0; }
+            /// \brief Checks whether there is a target frame rate.
+            bool IsPaced() const { return period > 0; }
+            /// \brief Restarts the schedule (next frame due now) and statistics.
+            void Reset();
+            /// \brief Checks whether a frame is due; if so, schedules the next one.
+            bool FrameDue();
+            /// \brief Returns the time (in seconds) until the next frame is due.
+            double TimeToNextFrame() const;
+            /// \brief Accounts for a frame drawn.
+            void FrameDrawn();
+            /// \brief Accounts for a frame due that was not drawn.
+            void FrameSkipped() { ++skippedFrames; }
+            /// \brief Returns statistics since the last Reset.
+            void GetStats(Stats* resultPtr) const;
+        protected:
+        // PROTECTED METHODS
+            /// \brief Returns monotonic time in seconds.
+            static double Now();
+        // PROTECTED ATTRIBUTES
+            /// Target interval between frames (zero if not paced).
+            double period;
+            /// Monotonic time at which the next frame is due.
+            double nextFrameTime;
+            double startTime;
+            std::clock_t startCPUTime;
+            /// Monotonic time of the last frame drawn (negative if none).
+            double lastFrameTime;
+            unsigned long frames;
+            unsigned long skippedFrames;
+            unsigned long dueFrames;
+            /// Running mean and sum of squared deviations of frame times (Welford's method).
+            double frameTimeMean;
+            double frameTimeM2;
+            double jitterSum;
+            double maxJitter;
+    }; // end class declaration
+} // end namespace
+
+#endif
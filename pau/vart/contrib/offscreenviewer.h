@@ -0,0 +1,103 @@
+/// \file offscreenviewer.h
+/// \brief Header file for V-ART class "OffscreenViewer".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_OFFSCREENVIEWER_H
+#define VART_OFFSCREENVIEWER_H
+
+#include "vart/contrib/viewerglutogl.h"
+#include "vart/simulationclock.h"
+#include <vector>
+
+namespace VART {
+/// \class OffscreenViewer offscreenviewer.h
+/// \brief V-ART Viewer that renders to an image, with no window or display.
+///
+/// An OffscreenViewer renders a scene into a pbuffer of an EGL context (on Mesa, the
+/// "surfaceless" platform is used, so no display server is needed; llvmpipe renders in
+/// software if there is no GPU). Applications using it must link with EGL and GLUT.
+///
+/// Frames are drawn on demand (see DrawFrame and Run) as fast as possible, not in a main
+/// loop. Each frame advances a simulation clock by one fixed step (1/60 seconds by
+/// default), moves active actions, calls the idle handler, draws the scene and calls the
+/// draw handler (e.g.: a FrameCapture). Call MakeClockCurrent so that actions take time
+/// from the clock instead of the system time.
+///
+/// Handlers are the ones used by ViewerGlutOGL. Their viewerPtr points to a ViewerGlutOGL
+/// with no window, owned by the offscreen viewer, on which window methods do nothing (e.g.:
+/// PostRedisplay, since every frame is drawn anyway).
+    class OffscreenViewer {
+        public:
+        // PUBLIC METHODS
+            /// \brief Creates a viewer of given size, with its own OpenGL context.
+            ///
+            /// Errors are reported to cerr; use IsValid to check for them.
+            OffscreenViewer(int newWidth, int newHeight);
+            ~OffscreenViewer();
+            /// \brief Checks whether the OpenGL context was created.
+            bool IsValid() const { return contextPtr != NULL; }
+            /// \brief Makes the viewer's context current in the calling thread.
+            void MakeCurrent();
+            /// \brief Attaches a scene to the viewer.
+            ///
+            /// Lighting is enabled if there are lights attached to the scene.
+            void SetScene(Scene& scene);
+            /// \brief Sets the camera used to view the scene.
+            void SetCamera(Camera* camPtr) { cameraPtr = camPtr; }
+            /// \brief Sets the idle time handler, called once per frame.
+            void SetIdleHandler(ViewerGlutOGL::IdleHandler* newIHPtr);
+            /// \brief Sets the drawing handler, called after the scene is drawn.
+            void SetDrawHandler(ViewerGlutOGL::DrawHandler* newDHPtr);
+            /// \brief Sets the number of frames per simulated second (default 60).
+            void SetFrameRate(double framesPerSecond) { clock.SetStep(1 / framesPerSecond); }
+            /// \brief Returns the clock that drives actions.
+            SimulationClock& GetClock() { return clock; }
+            /// \brief Makes the viewer's clock current (see SimulationClock::SetCurrent).
+            ///
+            /// It stops being current when the viewer is destroyed.
+            void MakeClockCurrent() { SimulationClock::SetCurrent(&clock); }
+            /// \brief Advances the clock by one step and draws a frame.
+            void DrawFrame();
+            /// \brief Draws a number of frames, then waits for rendering to finish.
+            void Run(unsigned int numFrames);
+            /// \brief Reads the image of the last frame drawn.
+            /// \param rgbaPtr [out] RGBA pixels, bottom row first (as read by glReadPixels).
+            void ReadPixels(std::vector<unsigned char>* rgbaPtr);
+            /// \brief Returns the number of frames drawn.
+            unsigned long GetFrameCount() const { return frameCount; }
+            /// Returns image width.
+            int GetWidth() const { return width; }
+            /// Returns image height.
+            int GetHeight() const { return height; }
+        // PUBLIC ATTRIBUTES
+            /// Sets whether the aspect ratio of the image should be passed along to the
+            /// cameras of the scene. This is set to "true" by default.
+            bool autoChangeCameraAspect;
+            /// Sets whether active actions are moved at every step of the clock (see
+            /// BaseAction::MoveAllActive). This is set to "true" by default; turn it off if
+            /// the idle handler moves actions.
+            bool autoMoveActions;
+        protected:
+        // PROTECTED METHODS
+            /// \brief Creates the EGL context and its pbuffer.
+            bool CreateContext();
+        // PROTECTED ATTRIBUTES
+            Scene* ptScene;
+            Camera* cameraPtr;
+            ViewerGlutOGL::IdleHandler* idleHndPtr;
+            ViewerGlutOGL::DrawHandler* drawHandlerPtr;
+            SimulationClock clock;
+            int width;
+            int height;
+            /// Viewer of handlers (with no window).
+            ViewerGlutOGL handlerViewer;
+            unsigned long frameCount;
+            /// EGL display, surface and context (kept untyped so that EGL headers are only
+            /// needed by the implementation).
+            void* displayPtr;
+            void* surfacePtr;
+            void* contextPtr;
+    }; // end class declaration
+} // end namespace
+
+#endif
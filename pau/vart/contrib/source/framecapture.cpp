@@ -0,0 +1,350 @@
+/// \file framecapture.cpp
+/// \brief Implementation file for V-ART class "FrameCapture".
+/// \version $Revision: 1.1 $
+
+// Pixel buffer objects are OpenGL 2.1 functions
+#define GL_GLEXT_PROTOTYPES
+#include "vart/contrib/framecapture.h"
+#include "vart/profiler.h"
+#include "vart/time.h"
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <cstring>
+#include <cassert>
+#ifdef ZLIB_LIB
+#include <zlib.h>
+#endif
+
+using namespace std;
+
+class VART::FrameCapture::EncodeJob : public VART::WorkQueue::Job {
+    public:
+        EncodeJob(FrameCapture* capturePtr, Frame* newFramePtr)
+            : ownerPtr(capturePtr), framePtr(newFramePtr) {}
+        virtual void Run()
+        {
+            VART_PROFILE_ZONE("FrameCapture::Encode");
+            ownerPtr->Encode(framePtr);
+            ownerPtr->Write(framePtr);
+        }
+    private:
+        FrameCapture* ownerPtr;
+        Frame* framePtr;
+};
+
+#ifdef ZLIB_LIB
+// Appends a big endian 32 bit number
+static void AppendUInt(vector<unsigned char>* dataPtr, unsigned long value)
+{
+    dataPtr->push_back(static_cast<unsigned char>(value >> 24));
+    dataPtr->push_back(static_cast<unsigned char>(value >> 16));
+    dataPtr->push_back(static_cast<unsigned char>(value >> 8));
+    dataPtr->push_back(static_cast<unsigned char>(value));
+}
+
+// Appends the CRC of a PNG chunk that starts at "start" (with its length)
+static void AppendCRC(vector<unsigned char>* dataPtr, size_t start)
+{
+    unsigned long crc = crc32(0, &(*dataPtr)[start + 4], dataPtr->size() - start - 4);
+    AppendUInt(dataPtr, crc);
+}
+#endif
+
+VART::FrameCapture::FrameCapture() :
+    format(PNM_SEQUENCE), fileName("frame"), compressionLevel(1), numColumns(0), numLines(0),
+    currentBuffer(0), bufferPending(false), frameCounter(0), maxPendingFrames(4),
+    numPending(0), numFrames(0), nextRawFrame(0), numCaptured(0), numStalls(0),
+    totalOverhead(0), maxOverhead(0)
+{
+    pixelBuffers[0] = pixelBuffers[1] = 0;
+}
+
+VART::FrameCapture::~FrameCapture()
+{
+    // A frame still in a pixel buffer would be lost (PNMExporter users never call Finish)
+    if (bufferPending)
+        Finish();
+    unique_lock<mutex> lock(frameMutex);
+    while (numPending > 0)
+        frameWritten.wait(lock);
+    for (unsigned int i = 0; i < freeFrameVec.size(); ++i)
+        delete freeFrameVec[i];
+}
+
+void VART::FrameCapture::SetBufferSize(int columns, int lines)
+{
+    numColumns = columns;
+    numLines = lines;
+}
+
+bool VART::FrameCapture::SetFormat(Format newFormat)
+{
+#ifndef ZLIB_LIB
+    if (newFormat == PNG_SEQUENCE)
+    {
+        cerr << "Error: FrameCapture::SetFormat: PNG output requires zlib (ZLIB_LIB)." << endl;
+        return false;
+    }
+#endif
+    format = newFormat;
+    return true;
+}
+
+void VART::FrameCapture::OnDraw()
+// virtual method
+{
+    assert((numColumns > 0) && "No buffer size set for FrameCapture!");
+    Time start;
+    start.SetMonotonic();
+#ifdef GL_PIXEL_PACK_BUFFER
+    unsigned int size = numColumns * numLines * 4;
+    if (pixelBuffers[0] == 0)
+    {
+        glGenBuffers(2, pixelBuffers);
+        for (unsigned int i = 0; i < 2; ++i)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+        }
+    }
+    // Start reading this frame, then copy out the previous one, which is likely done by now
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[currentBuffer]);
+    glReadPixels(0, 0, numColumns, numLines, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    currentBuffer = 1 - currentBuffer;
+    if (bufferPending)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[currentBuffer]);
+        const void* dataPtr = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (dataPtr)
+        {
+            QueueFrame(dataPtr);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        else
+            cerr << "Error: FrameCapture::OnDraw: could not map pixel buffer." << endl;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    bufferPending = true;
+#else
+    // No pixel buffers: read synchronously into a free frame
+    vector<unsigned char> pixels(numColumns * numLines * 4);
+    glReadPixels(0, 0, numColumns, numLines, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    QueueFrame(&pixels[0]);
+#endif
+    Time end;
+    end.SetMonotonic();
+    AddOverhead((end - start).AsDouble());
+}
+
+void VART::FrameCapture::AddFrame(const void* rgbaPtr)
+{
+    Time start;
+    start.SetMonotonic();
+    QueueFrame(rgbaPtr);
+    Time end;
+    end.SetMonotonic();
+    AddOverhead((end - start).AsDouble());
+}
+
+void VART::FrameCapture::Finish()
+{
+#ifdef GL_PIXEL_PACK_BUFFER
+    if (bufferPending)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[1 - currentBuffer]);
+        const void* dataPtr = glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (dataPtr)
+        {
+            QueueFrame(dataPtr);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        bufferPending = false;
+    }
+    if (pixelBuffers[0])
+        DeletePixelBuffers();
+#endif
+    unique_lock<mutex> lock(frameMutex);
+    while (numPending > 0)
+        frameWritten.wait(lock);
+    if (rawFile.is_open())
+        rawFile.close();
+    frameCounter = 0;
+    nextRawFrame = 0;
+}
+
+double VART::FrameCapture::GetOverhead() const
+{
+    return (numCaptured > 0) ? totalOverhead / numCaptured : 0;
+}
+
+void VART::FrameCapture::QueueFrame(const void* rgbaPtr)
+{
+    if ((format == RAW_VIDEO) && (frameCounter == 0))
+    {
+        rawFile.open(fileName.c_str(), ios::binary | ios::trunc);
+        if (!rawFile)
+            cerr << "Error: FrameCapture: could not create '" << fileName << "'." << endl;
+    }
+    Frame* framePtr;
+    {
+        unique_lock<mutex> lock(frameMutex);
+        if (freeFrameVec.empty() && (numFrames >= maxPendingFrames))
+        {
+            ++numStalls;
+            while (freeFrameVec.empty())
+                frameWritten.wait(lock);
+        }
+        if (freeFrameVec.empty())
+        {
+            framePtr = new Frame;
+            ++numFrames;
+        }
+        else
+        {
+            framePtr = freeFrameVec.back();
+            freeFrameVec.pop_back();
+        }
+        ++numPending;
+    }
+    size_t size = static_cast<size_t>(numColumns) * numLines * 4;
+    framePtr->pixels.resize(size);
+    memcpy(&framePtr->pixels[0], rgbaPtr, size);
+    framePtr->number = frameCounter++;
+    workQueue.Add(new EncodeJob(this, framePtr));
+}
+
+void VART::FrameCapture::Encode(Frame* framePtr)
+{
+    const unsigned int rowSize = numColumns * 3;
+    vector<unsigned char>& output = framePtr->output;
+    output.clear();
+    size_t start = 0;
+    if (format == PNM_SEQUENCE)
+    {
+        ostringstream header;
+        header << "P6\n#Creator: V-ART framework FrameCapture class\n"
+               << numColumns << " " << numLines << "\n255\n";
+        string text = header.str();
+        output.assign(text.begin(), text.end());
+        start = output.size();
+    }
+    // PNG rows start with a filter type byte
+    unsigned int rowStride = (format == PNG_SEQUENCE) ? rowSize + 1 : rowSize;
+    output.resize(start + static_cast<size_t>(rowStride) * numLines);
+    // Flip rows and drop alpha
+    for (int lin = 0; lin < numLines; ++lin)
+    {
+        const unsigned char* srcPtr = &framePtr->pixels[(numLines - 1 - lin) * numColumns * 4];
+        unsigned char* dstPtr = &output[start + lin * rowStride];
+        if (format == PNG_SEQUENCE)
+            *dstPtr++ = 0;
+        for (int col = 0; col < numColumns; ++col)
+        {
+            dstPtr[0] = srcPtr[0];
+            dstPtr[1] = srcPtr[1];
+            dstPtr[2] = srcPtr[2];
+            dstPtr += 3;
+            srcPtr += 4;
+        }
+    }
+#ifdef ZLIB_LIB
+    if (format == PNG_SEQUENCE)
+    {
+        // Compress filtered rows (kept in "pixels", no longer needed) into IDAT
+        framePtr->pixels.swap(output);
+        uLong rawSize = framePtr->pixels.size();
+        uLongf compressedSize = compressBound(rawSize);
+        static const unsigned char signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+        output.assign(signature, signature + 8);
+        // IHDR: size, 8 bits per sample, RGB, no interlacing
+        size_t chunk = output.size();
+        AppendUInt(&output, 13);
+        output.insert(output.end(), "IHDR", "IHDR" + 4);
+        AppendUInt(&output, numColumns);
+        AppendUInt(&output, numLines);
+        static const unsigned char ihdr[] = { 8, 2, 0, 0, 0 };
+        output.insert(output.end(), ihdr, ihdr + 5);
+        AppendCRC(&output, chunk);
+        chunk = output.size();
+        AppendUInt(&output, 0);
+        output.insert(output.end(), "IDAT", "IDAT" + 4);
+        output.resize(chunk + 8 + compressedSize);
+        if (compress2(&output[chunk + 8], &compressedSize, &framePtr->pixels[0], rawSize,
+                      compressionLevel) != Z_OK)
+            cerr << "Error: FrameCapture: could not compress frame " << framePtr->number
+                 << "." << endl;
+        output.resize(chunk + 8 + compressedSize);
+        output[chunk] = static_cast<unsigned char>(compressedSize >> 24);
+        output[chunk + 1] = static_cast<unsigned char>(compressedSize >> 16);
+        output[chunk + 2] = static_cast<unsigned char>(compressedSize >> 8);
+        output[chunk + 3] = static_cast<unsigned char>(compressedSize);
+        AppendCRC(&output, chunk);
+        chunk = output.size();
+        AppendUInt(&output, 0);
+        output.insert(output.end(), "IEND", "IEND" + 4);
+        AppendCRC(&output, chunk);
+    }
+#endif
+}
+
+void VART::FrameCapture::Write(Frame* framePtr)
+{
+    vector<Frame*> writtenVec;
+    if (format == RAW_VIDEO)
+    {
+        // Frames are written in order, by the thread that encodes the next one expected
+        lock_guard<mutex> lock(rawMutex);
+        encodedMap[framePtr->number] = framePtr;
+        map<unsigned int, Frame*>::iterator iter = encodedMap.begin();
+        while ((iter != encodedMap.end()) && (iter->first == nextRawFrame))
+        {
+            vector<unsigned char>& output = iter->second->output;
+            rawFile.write(reinterpret_cast<const char*>(&output[0]), output.size());
+            writtenVec.push_back(iter->second);
+            encodedMap.erase(iter++);
+            ++nextRawFrame;
+        }
+    }
+    else
+    {
+        string name = SequenceFileName(framePtr->number);
+        ofstream file(name.c_str(), ios::binary);
+        file.write(reinterpret_cast<const char*>(&framePtr->output[0]), framePtr->output.size());
+        if (!file)
+            cerr << "Error: FrameCapture: could not write '" << name << "'." << endl;
+        writtenVec.push_back(framePtr);
+    }
+    if (!writtenVec.empty())
+    {
+        lock_guard<mutex> lock(frameMutex);
+        freeFrameVec.insert(freeFrameVec.end(), writtenVec.begin(), writtenVec.end());
+        numPending -= writtenVec.size();
+        frameWritten.notify_all();
+    }
+}
+
+string VART::FrameCapture::SequenceFileName(unsigned int number) const
+{
+    ostringstream oss;
+    oss << fileName << setfill('0') << setw(5) << number
+        << ((format == PNG_SEQUENCE) ? ".png" : ".pnm");
+    return oss.str();
+}
+
+void VART::FrameCapture::AddOverhead(double seconds)
+{
+    ++numCaptured;
+    totalOverhead += seconds;
+    if (seconds > maxOverhead)
+        maxOverhead = seconds;
+}
+
+void VART::FrameCapture::DeletePixelBuffers()
+{
+#ifdef GL_PIXEL_PACK_BUFFER
+    glDeleteBuffers(2, pixelBuffers);
+#endif
+    pixelBuffers[0] = pixelBuffers[1] = 0;
+}
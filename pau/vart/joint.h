@@ -101,8 +101,9 @@ namespace VART {
             /// Returns type identification of the node.
             virtual TypeID GetID() { return JOINT; }
 
-            /// \brief Outputs XML representation of the scene.
-            virtual void XmlPrintOn(std::ostream& os, unsigned int indent) const;
+            /// \brief Appends XML representation of the joint, its DOFs and (if
+            /// recursivePrinting) its children to a writer.
+            virtual void XmlWrite(XmlWriter* writerPtr, unsigned int indent) const;
 
     #ifdef VISUAL_JOINTS
             virtual bool DrawOGL() const;
@@ -0,0 +1,183 @@
+/// \file particlesystem.h
+/// \brief Header file for V-ART class "ParticleSystem".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_PARTICLESYSTEM_H
+#define VART_PARTICLESYSTEM_H
+
+#include "vart/graphicobj.h"
+#include "vart/point4d.h"
+#include "vart/color.h"
+#include "vart/texture.h"
+#include "vart/workqueue.h"
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace VART {
+/// \class ParticleSystem particlesystem.h
+/// \brief Many small short-lived points (dust, sparks, fireworks...) drawn at once.
+///
+/// Particles are born at an emitter (a ball of given radius), with velocities inside a
+/// cone, and die when their lifetimes are over. While alive, they fall by gravity, are
+/// slowed down by drag and fade from a start color to an end color. Particles are not
+/// scene nodes: they are kept as arrays of coordinates (one array per coordinate), which
+/// Update moves with SIMD instructions (see Matrix4 for the instruction sets used), split
+/// among threads for large systems. Arrays are allocated for the capacity of the system,
+/// so that particles that die are replaced by the last ones, without allocation, and
+/// particles are not kept in the order they were born.
+///
+/// The whole system is drawn as a single array of points, unlit, blended with what is
+/// behind and not hiding what is drawn after. With a texture, points are drawn as point
+/// sprites: squares facing the camera, with the texture modulated by particle colors (a
+/// round texture makes round particles).
+/// Coordinates are those of the node: put the system under a transform to move it.
+///
+/// Update does not depend on the number of threads: random numbers of each particle come
+/// from its number (counted since the system was created) and the seed.
+    class ParticleSystem : public GraphicObj {
+        public:
+        // PUBLIC METHODS
+            /// \brief Creates a system for a number of particles, emitting none.
+            ParticleSystem(unsigned int capacity = 10000);
+            ParticleSystem(const ParticleSystem& system);
+            ParticleSystem& operator=(const ParticleSystem& system);
+            /// \brief Waits for worker threads.
+            virtual ~ParticleSystem();
+            /// \brief Returns a copy of the system (with the same particles).
+            virtual SceneNode* Copy();
+
+            /// \brief Sets the largest number of particles alive at once. Living particles
+            /// beyond it are discarded.
+            void SetCapacity(unsigned int value);
+            unsigned int GetCapacity() const { return capacity; }
+            /// \brief Returns the number of living particles.
+            unsigned int GetNumParticles() const { return numParticles; }
+            /// \brief Returns the position of a living particle.
+            Point4D GetPosition(unsigned int index) const;
+            /// \brief Returns the velocity of a living particle.
+            Point4D GetVelocity(unsigned int index) const;
+            /// \brief Kills all particles.
+            void Clear();
+
+            /// \brief Sets the center and radius of the ball where particles are born.
+            void SetEmitter(const Point4D& position, double radius);
+            /// \brief Sets the cone of directions of new particles.
+            /// \param direction [in] Axis of the cone (need not be normalized).
+            /// \param spread [in] Angle (in radians) between the axis and the side of the
+            /// cone: 0 emits along the axis, pi emits in all directions.
+            void SetDirection(const Point4D& direction, double spread);
+            /// \brief Sets the range of speeds of new particles.
+            void SetSpeed(double minSpeed, double maxSpeed);
+            /// \brief Sets the range of lifetimes (in seconds) of new particles.
+            void SetLife(double minLife, double maxLife);
+            /// \brief Sets the number of particles born per second (default 0).
+            void SetRate(double particlesPerSecond) { rate = particlesPerSecond; }
+            /// \brief Makes particles be born at the next update, besides those of the rate
+            /// (e.g.: for an explosion).
+            void Emit(unsigned int count) { numBursting += count; }
+            /// \brief Sets the seed of random numbers.
+            void SetSeed(unsigned int value) { seed = value; }
+
+            /// \brief Sets the acceleration of gravity (default none).
+            void SetGravity(const Point4D& acceleration);
+            /// \brief Sets the fraction of speed lost per second (default 0).
+            void SetDrag(double value) { drag = static_cast<float>(value); }
+            /// \brief Sets colors of particles when born and when dying (default: opaque
+            /// white fading to transparent white).
+            void SetColors(const Color& start, const Color& end);
+            /// \brief Sets the size of points.
+            /// \param size [in] Size in pixels or, if perspective, in pixels at a unit of
+            /// distance from the camera (so that farther points look smaller).
+            /// \param perspective [in] Whether size depends on the distance.
+            void SetPointSize(float size, bool perspective = false);
+            /// \brief Sets the texture of point sprites (a texture with no data draws square
+            /// points, the default).
+            void SetTexture(const Texture& value) { texture = value; }
+            /// \brief Sets whether colors are added to what is behind (as light is), instead
+            /// of blended by their alpha (the default).
+            void SetAdditive(bool value) { additive = value; }
+            /// \brief Sets the number of threads that update particles (default: number of
+            /// processors). Takes effect before the first update.
+            void SetNumThreads(unsigned int value);
+
+            /// \brief Moves, ages and kills particles, then makes new ones be born.
+            /// \param seconds [in] Time elapsed since the last update.
+            ///
+            /// Also computes the bounding box.
+            void Update(double seconds);
+            /// \brief Computes the bounding box of living particles.
+            virtual void ComputeBoundingBox();
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief Job that runs a phase of Update over a range of particles.
+            class RangeJob;
+        // PROTECTED METHODS
+            /// \brief Moves and ages particles in [first, end).
+            void Integrate(unsigned int first, unsigned int end);
+            /// \brief Makes particles in [first, end) be born, where past firstNew, and
+            /// writes vertices and colors of all of them, computing their bounds.
+            /// \param bounds [out] Smaller X, Y, Z, then greater X, Y, Z.
+            void Prepare(unsigned int first, unsigned int end, float* bounds);
+            /// \brief Runs Integrate or Prepare over particles in [0, end), split among
+            /// threads.
+            void RunRanges(bool integrate, unsigned int end);
+            /// \brief Replaces dead particles by the last living ones.
+            void Compact();
+            /// \brief Allocates arrays for the capacity.
+            void Allocate();
+            virtual bool DrawInstanceOGL() const;
+        // PROTECTED ATTRIBUTES
+            /// Coordinates of positions and velocities, for the capacity.
+            std::vector<float> positionVecs[3];
+            std::vector<float> velocityVecs[3];
+            /// Ages and lifetimes, in seconds.
+            std::vector<float> ageVec;
+            std::vector<float> lifeVec;
+            unsigned int numParticles;
+            unsigned int capacity;
+            /// Vertices (X, Y and Z of each particle) and colors (RGBA) of living
+            /// particles, as drawn (computed by Update).
+            std::vector<float> vertexVec;
+            std::vector<unsigned char> colorVec;
+            /// Bounds of each range of particles, computed by Prepare.
+            std::vector<float> rangeBoundsVec;
+            Point4D emitterPosition;
+            double emitterRadius;
+            /// Axis of the cone of directions, then two unit vectors perpendicular to it.
+            double axis[9];
+            double cosSpread;
+            double minSpeed;
+            double maxSpeed;
+            double minLife;
+            double maxLife;
+            double rate;
+            /// Particles owed by the rate in past updates (less than one).
+            double owed;
+            /// Particles to be born at the next update by Emit.
+            unsigned int numBursting;
+            /// Particles born since the system was created.
+            unsigned long long numBorn;
+            /// Particles from which those born by Prepare are numbered, and duration of
+            /// the update, for Prepare.
+            unsigned int firstNew;
+            float elapsed;
+            unsigned int seed;
+            float gravity[3];
+            float drag;
+            float startColor[4];
+            float endColor[4];
+            float pointSize;
+            bool perspective;
+            Texture texture;
+            bool additive;
+            unsigned int numThreads;
+            WorkQueue workQueue;
+            /// Jobs of the current update still running.
+            unsigned int pending;
+            std::mutex pendingMutex;
+            std::condition_variable finished;
+    }; // end class declaration
+} // end namespace
+
+#endif
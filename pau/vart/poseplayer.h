@@ -0,0 +1,90 @@
+/// \file poseplayer.h
+/// \brief Header file for V-ART class "PosePlayer".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_POSEPLAYER_H
+#define VART_POSEPLAYER_H
+
+#include <vector>
+#include <string>
+
+namespace VART {
+    class SceneNode;
+    class Joint;
+    class Dof;
+    class Transform;
+/// \class PosePlayer poseplayer.h
+/// \brief Replays poses recorded by a PoseRecorder.
+///
+/// A pose player restores recorded DOF positions and transform matrices directly, without
+/// running actions. Each joint computes its transform once per frame, no matter how many
+/// DOFs it has. Targets must be added in the same order used when recording; the number
+/// of DOFs and transforms is checked against the stream header.
+    class PosePlayer {
+        public:
+        // PUBLIC METHODS
+            /// \brief Creates a player with nothing to play.
+            PosePlayer();
+
+            /// \brief Adds the joints of a scene graph, in depth first order.
+            void AddNode(SceneNode* nodePtr);
+
+            /// \brief Adds a transform.
+            void AddTransform(Transform* transPtr);
+
+            /// \brief Sets the stream to play.
+            /// \return False if the stream is invalid or does not match the targets.
+            ///
+            /// An incomplete last frame (e.g.: of a truncated file) is dropped.
+            bool SetData(const std::vector<unsigned char>& newData);
+
+            /// \brief Reads the stream to play from a file.
+            /// \return False if the file could not be read or does not match the targets.
+            bool LoadFromFile(const std::string& fileName);
+
+            /// \brief Returns the number of frames in the stream.
+            unsigned int GetNumFrames() const { return frameOffsetVec.size(); }
+
+            /// \brief Returns the index of the next frame to be played.
+            unsigned int GetNextFrame() const { return nextFrame; }
+
+            /// \brief Selects the next frame to be played.
+            ///
+            /// Decodes from the nearest key frame, but does not change any pose.
+            /// \return False if there is no such frame.
+            bool Seek(unsigned int frame);
+
+            /// \brief Applies the next frame to the targets.
+            /// \return False if there are no more frames or the frame is corrupt.
+            bool PlayFrame();
+        protected:
+        // PROTECTED METHODS
+            /// \brief Decodes the next frame into currentDofVec and currentTransformVec.
+            /// \return False if the frame goes past the end of the stream.
+            bool DecodeFrame();
+            /// \brief Reads an unsigned integer, 7 bits per byte.
+            ///
+            /// Sets "failed" if reading goes past the end of the stream.
+            unsigned long long Read();
+        // PROTECTED ATTRIBUTES
+            /// \brief Joints that have DOFs in dofVec.
+            std::vector<Joint*> jointVec;
+            std::vector<Dof*> dofVec;
+            std::vector<Transform*> transformVec;
+            /// \brief Bit patterns of DOF positions of the last decoded frame.
+            std::vector<unsigned int> currentDofVec;
+            /// \brief Bit patterns of transform elements of the last decoded frame.
+            std::vector<unsigned long long> currentTransformVec;
+            /// \brief The stream.
+            std::vector<unsigned char> data;
+            /// \brief Position of each frame in the stream.
+            std::vector<unsigned int> frameOffsetVec;
+            /// \brief Reading position.
+            unsigned int offset;
+            unsigned int nextFrame;
+            /// \brief Whether a read went past the end of the stream.
+            bool failed;
+    }; // end class declaration
+} // end namespace
+
+#endif
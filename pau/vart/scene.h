@@ -17,12 +17,14 @@
 #include "vart/camera.h"
 #include "vart/color.h" // for background color
 #include "vart/boundingbox.h"
+#include "vart/framestats.h"
 #include <string> //STL include
 #include <list>   //STL include
 #include <iostream> // for XmlPrintOn
 
 namespace VART {
     class GraphicObj;
+    class XmlWriter;
 /// \class Scene scene.h
 /// \brief A set of objects, lights and cameras.
 ///
@@ -132,6 +134,19 @@ namespace VART {
             /// \return false if V-ART was not compiled with OpenGL support.
             bool DrawLightsOGL() const;
 
+            /// \brief Returns counts of the work done for the last frame.
+            ///
+            /// Counts are taken at the end of DrawOGL and cover everything done since the
+            /// previous frame (see FrameStats).
+            const FrameStats& GetFrameStats() const { return frameStats; }
+
+            /// \brief Computes a hash of the scene state that affects drawing.
+            ///
+            /// Covers the scene graph structure, matrices of transforms and joints (thus
+            /// dof movements), cameras and lights. Changes to meshes or materials are not
+            /// covered. Viewers use it to skip drawing of frames that would not change.
+            unsigned long long ComputeStateHash() const;
+
             /// Returns the current camera in the scene or NULL if no camera exists.
             Camera* GetCurrentCamera() const;
 
@@ -200,6 +215,9 @@ namespace VART {
             /// \brief Outputs XML representation of the scene.
             void XmlPrintOn(std::ostream& os) const;
 
+            /// \brief Appends XML representation of the scene to a writer.
+            void XmlWrite(XmlWriter* writerPtr) const;
+
         protected:
             // PROTECTED METHODS
             // PROTECTED ATTRIBUTES
@@ -223,6 +241,8 @@ namespace VART {
             std::list<Camera*>::const_iterator currentCamera;
             BoundingBox bBox;
             std::string description;
+            // Counts of the last frame, taken by DrawOGL
+            mutable FrameStats frameStats;
     }; // end class declaration
 } // end namespace
 #endif  // VART_SCENE_H
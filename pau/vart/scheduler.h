@@ -0,0 +1,130 @@
+/// \file scheduler.h
+/// \brief Header file for V-ART class "Scheduler".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_SCHEDULER_H
+#define VART_SCHEDULER_H
+
+#include <vector>
+
+namespace VART {
+    class BaseAction;
+    class CallBack;
+/// \class Scheduler scheduler.h
+/// \brief Activates actions, deactivates actions and runs callbacks at given simulation times.
+///
+/// Events are kept in a hierarchical timer wheel, with ticks of fixed length: scheduling,
+/// canceling and firing an event take constant time, no matter how many events are
+/// pending. Event times are given in seconds of simulation time (see SimulationClock::NOW)
+/// and events never fire before their time, but may fire up to one tick later.
+///
+/// When a scheduler is current (see SetCurrent), BaseAction::MoveAllActive updates it before
+/// moving actions and BaseAction::Deactivate(float) schedules a deactivation event instead of
+/// counting time to live at every move. Create (or Reset) the scheduler after making a
+/// simulation clock current, so that both agree on what time it is.
+    class Scheduler {
+        public:
+        // PUBLIC TYPES
+            /// \brief A pending event.
+            ///
+            /// Pointers to events are handles, valid until the event fires or is canceled.
+            class Event
+            {
+                friend class Scheduler;
+                public:
+                    /// \brief Removes the event from its scheduler.
+                    void Cancel();
+                private:
+                    enum TypeID { ACTIVATION, DEACTIVATION, CALLBACK };
+                    Event* previousPtr;
+                    Event* nextPtr;
+                    Event** slotPtr; // list that holds the event
+                    Scheduler* ownerPtr;
+                    unsigned long long tick;
+                    TypeID type;
+                    BaseAction* actionPtr;
+                    CallBack* callbackPtr;
+            }; // Scheduler::Event
+        // PUBLIC STATIC METHODS
+            /// \brief Sets the scheduler used by actions (may be NULL).
+            static void SetCurrent(Scheduler* schedulerPtr) { currentPtr = schedulerPtr; }
+
+            /// \brief Returns the scheduler used by actions (may be NULL).
+            static Scheduler* GetCurrent() { return currentPtr; }
+        // PUBLIC METHODS
+            /// \brief Creates a scheduler with ticks of 1/60 seconds.
+            Scheduler();
+
+            /// \brief Creates a scheduler with ticks of given length (in seconds).
+            Scheduler(double tickSeconds);
+
+            ~Scheduler();
+
+            /// \brief Schedules the activation of an action.
+            /// \param actionPtr [in] Action to activate. Must exist until the event fires.
+            /// \param time [in] Simulation time (in seconds).
+            Event* Activate(BaseAction* actionPtr, double time);
+
+            /// \brief Schedules the deactivation of an action.
+            /// \param actionPtr [in] Action to deactivate. Must exist until the event fires.
+            /// \param time [in] Simulation time (in seconds).
+            Event* Deactivate(BaseAction* actionPtr, double time);
+
+            /// \brief Schedules the activation of a callback.
+            /// \param callbackPtr [in] Callback to activate. Must exist until the event fires.
+            /// \param time [in] Simulation time (in seconds).
+            Event* Call(CallBack* callbackPtr, double time);
+
+            /// \brief Removes a pending event.
+            void Cancel(Event* eventPtr);
+
+            /// \brief Removes all pending events and restarts at current simulation time.
+            void Reset();
+
+            /// \brief Returns the number of pending events.
+            unsigned int GetNumEvents() const { return numEvents; }
+
+            /// \brief Fires all events up to current simulation time.
+            /// \return The number of events fired.
+            unsigned int Update();
+
+            /// \brief Fires all events up to given simulation time.
+            /// \return The number of events fired.
+            unsigned int Update(double time);
+        protected:
+        // PROTECTED METHODS
+            /// \brief Gets an event from the pool and schedules it.
+            Event* NewEvent(Event::TypeID type, double time);
+            /// \brief Puts an event in the wheel slot matching its tick.
+            void Insert(Event* eventPtr);
+            /// \brief Puts an event in a list.
+            void Link(Event* eventPtr, Event** listPtr);
+            /// \brief Takes an event out of its wheel slot.
+            void Unlink(Event* eventPtr);
+            /// \brief Reinserts all events of a slot of some level (they move to lower levels).
+            /// \return Index of the slot.
+            unsigned int Cascade(unsigned int level);
+        // PROTECTED STATIC ATTRIBUTES
+            /// \brief Scheduler used by actions.
+            static Scheduler* currentPtr;
+        // PROTECTED ATTRIBUTES
+            /// \brief Length of a tick in seconds.
+            double tickSeconds;
+            /// \brief Next tick to be processed.
+            unsigned long long currentTick;
+            /// \brief Number of pending events.
+            unsigned int numEvents;
+            /// \brief Timer wheel: 4 levels of 256 slots, each slot holds a list of events.
+            ///
+            /// Level n holds events that are due in less than 256^(n+1) ticks.
+            Event* wheel[4][256];
+            /// \brief Events due at current tick.
+            Event* dueListPtr;
+            /// \brief Events not in use.
+            Event* freeListPtr;
+            /// \brief Memory for events (allocated in blocks).
+            std::vector<Event*> blockVec;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -0,0 +1,78 @@
+/// \file framestats.cpp
+/// \brief Implementation file for V-ART class "FrameStats".
+/// \version $Revision: 1.1 $
+
+#include "vart/framestats.h"
+
+using namespace std;
+
+// INITIALIZATION OF STATIC ATTRIBUTES
+VART::FrameStats VART::FrameStats::current;
+
+// Column names of mesh types, in the order of Mesh::MeshType
+static const char* meshTypeNames[VART::FrameStats::NUM_MESH_TYPES] = {
+    "none", "points", "lines", "line_strip", "line_loop", "triangles", "triangle_strip",
+    "triangle_fan", "quads", "quad_strip", "polygon" };
+
+void VART::FrameStats::Clear()
+{
+    nodesVisited = 0;
+    objectsDrawn = 0;
+    for (unsigned int i = 0; i < NUM_MESH_TYPES; ++i)
+    {
+        drawCalls[i] = 0;
+        indices[i] = 0;
+    }
+    materialBinds = 0;
+    textureBinds = 0;
+    lightsSet = 0;
+    transformsPushed = 0;
+    dofsMoved = 0;
+    vertexBytes = 0;
+}
+
+unsigned long VART::FrameStats::GetDrawCalls() const
+{
+    unsigned long result = 0;
+    for (unsigned int i = 0; i < NUM_MESH_TYPES; ++i)
+        result += drawCalls[i];
+    return result;
+}
+
+unsigned long VART::FrameStats::GetIndices() const
+{
+    unsigned long result = 0;
+    for (unsigned int i = 0; i < NUM_MESH_TYPES; ++i)
+        result += indices[i];
+    return result;
+}
+
+unsigned long VART::FrameStats::GetTriangles() const
+{
+    // Strips, fans and polygons make n-2 triangles out of n indices, per draw call
+    unsigned long result = indices[Mesh::TRIANGLES] / 3 + indices[Mesh::QUADS] / 2;
+    const Mesh::MeshType stripTypes[] = { Mesh::TRIANGLE_STRIP, Mesh::TRIANGLE_FAN,
+                                          Mesh::QUAD_STRIP, Mesh::POLYGON };
+    for (unsigned int i = 0; i < 4; ++i)
+        if (indices[stripTypes[i]] > 2 * drawCalls[stripTypes[i]])
+            result += indices[stripTypes[i]] - 2 * drawCalls[stripTypes[i]];
+    return result;
+}
+
+void VART::FrameStats::WriteCSVHeader(ostream& os)
+{
+    os << "frame,nodes_visited,objects_drawn,draw_calls,indices,triangles";
+    for (unsigned int i = 1; i < NUM_MESH_TYPES; ++i)
+        os << ",draw_calls_" << meshTypeNames[i] << ",indices_" << meshTypeNames[i];
+    os << ",material_binds,texture_binds,lights_set,transforms_pushed,dofs_moved,vertex_bytes\n";
+}
+
+void VART::FrameStats::WriteCSV(ostream& os, unsigned long frame) const
+{
+    os << frame << ',' << nodesVisited << ',' << objectsDrawn << ',' << GetDrawCalls() << ','
+       << GetIndices() << ',' << GetTriangles();
+    for (unsigned int i = 1; i < NUM_MESH_TYPES; ++i)
+        os << ',' << drawCalls[i] << ',' << indices[i];
+    os << ',' << materialBinds << ',' << textureBinds << ',' << lightsSet << ','
+       << transformsPushed << ',' << dofsMoved << ',' << vertexBytes << '\n';
+}
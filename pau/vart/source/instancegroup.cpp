@@ -0,0 +1,520 @@
+/// \file instancegroup.cpp
+/// \brief Implementation file for V-ART class "InstanceGroup".
+/// \version $Revision: 1.1 $
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+#ifdef VART_OGL
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#endif
+#include "vart/instancegroup.h"
+#include "vart/meshobject.h"
+#include "vart/framestats.h"
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// INITIALIZATION OF STATIC ATTRIBUTES
+bool VART::InstanceGroup::instancing = true;
+
+#if defined(VART_OGL) && defined(GL_VERSION_3_3)
+// Attribute locations of the instancing program: four columns of the modelview matrix,
+// then the color. They are chosen not to alias conventional attributes used by meshes
+// (vertices, normals, colors and the first texture coordinates).
+static const GLuint MATRIX_LOCATION = 10;
+static const GLuint COLOR_LOCATION = 14;
+
+// Vertex shader of the instancing program. It does what the fixed function pipeline
+// does for meshes, but with the modelview matrix of the instance. Normals are
+// transformed by the cofactors of the modelview matrix (its inverse transpose, up to a
+// scale) and normalized.
+static const char* INSTANCING_SHADER =
+    "#version 120\n"
+    "attribute vec4 instanceColumn0;\n"
+    "attribute vec4 instanceColumn1;\n"
+    "attribute vec4 instanceColumn2;\n"
+    "attribute vec4 instanceColumn3;\n"
+    "attribute vec4 instanceColor;\n"
+    "uniform bool lighting;\n"
+    "uniform bool useColor;\n"
+    "uniform bool lightEnabled[8];\n"
+    "uniform int numLights;\n"
+    "void main()\n"
+    "{\n"
+    "    mat4 modelView = mat4(instanceColumn0, instanceColumn1, instanceColumn2,\n"
+    "                          instanceColumn3);\n"
+    "    vec4 eyePosition = modelView * gl_Vertex;\n"
+    "    gl_Position = gl_ProjectionMatrix * eyePosition;\n"
+    "    gl_ClipVertex = eyePosition;\n"
+    "    gl_FogFragCoord = abs(eyePosition.z);\n"
+    "    gl_TexCoord[0] = gl_TextureMatrix[0] * gl_MultiTexCoord0;\n"
+    "    if (!lighting)\n"
+    "    {\n"
+    "        gl_FrontColor = useColor ? instanceColor : gl_Color;\n"
+    "        gl_BackColor = gl_FrontColor;\n"
+    "        return;\n"
+    "    }\n"
+    "    vec4 ambient = useColor ? instanceColor : gl_FrontMaterial.ambient;\n"
+    "    vec4 diffuse = useColor ? instanceColor : gl_FrontMaterial.diffuse;\n"
+    "    vec3 a = modelView[0].xyz;\n"
+    "    vec3 b = modelView[1].xyz;\n"
+    "    vec3 c = modelView[2].xyz;\n"
+    "    vec3 normal = normalize(mat3(cross(b, c), cross(c, a), cross(a, b)) * gl_Normal);\n"
+    "    if (dot(a, cross(b, c)) < 0.0)\n"
+    "        normal = -normal;\n"
+    "    vec3 position = eyePosition.xyz / eyePosition.w;\n"
+    "    vec4 color = gl_FrontMaterial.emission + ambient * gl_LightModel.ambient;\n"
+    "    for (int i = 0; i < numLights; ++i)\n"
+    "    {\n"
+    "        if (!lightEnabled[i])\n"
+    "            continue;\n"
+    "        vec3 toLight;\n"
+    "        float attenuation = 1.0;\n"
+    "        if (gl_LightSource[i].position.w == 0.0)\n"
+    "            toLight = normalize(gl_LightSource[i].position.xyz);\n"
+    "        else\n"
+    "        {\n"
+    "            toLight = gl_LightSource[i].position.xyz / gl_LightSource[i].position.w\n"
+    "                      - position;\n"
+    "            float distance = length(toLight);\n"
+    "            toLight /= distance;\n"
+    "            attenuation = 1.0 / (gl_LightSource[i].constantAttenuation\n"
+    "                                 + gl_LightSource[i].linearAttenuation * distance\n"
+    "                                 + gl_LightSource[i].quadraticAttenuation\n"
+    "                                   * distance * distance);\n"
+    "            if (gl_LightSource[i].spotCutoff != 180.0)\n"
+    "            {\n"
+    "                float spot = dot(-toLight, normalize(gl_LightSource[i].spotDirection));\n"
+    "                if (spot < gl_LightSource[i].spotCosCutoff)\n"
+    "                    attenuation = 0.0;\n"
+    "                else\n"
+    "                    attenuation *= pow(spot, gl_LightSource[i].spotExponent);\n"
+    "            }\n"
+    "        }\n"
+    "        float nDotL = max(dot(normal, toLight), 0.0);\n"
+    "        vec4 term = ambient * gl_LightSource[i].ambient\n"
+    "                    + nDotL * diffuse * gl_LightSource[i].diffuse;\n"
+    "        if (nDotL > 0.0)\n"
+    "        {\n"
+    "            float nDotH = max(dot(normal, normalize(toLight + vec3(0.0, 0.0, 1.0))), 0.0);\n"
+    "            float shine = (gl_FrontMaterial.shininess > 0.0)\n"
+    "                          ? pow(nDotH, gl_FrontMaterial.shininess) : 1.0;\n"
+    "            term += shine * gl_FrontMaterial.specular * gl_LightSource[i].specular;\n"
+    "        }\n"
+    "        color += attenuation * term;\n"
+    "    }\n"
+    "    color.a = diffuse.a;\n"
+    "    gl_FrontColor = clamp(color, 0.0, 1.0);\n"
+    "    gl_BackColor = gl_FrontColor;\n"
+    "}\n";
+
+// Uniform locations of the instancing program
+static GLint lightingLocation;
+static GLint useColorLocation;
+static GLint lightEnabledLocation;
+static GLint numLightsLocation;
+
+// Returns the instancing program, creating it at the first call (zero if it could not be
+// created). Assumes a single OpenGL context.
+static GLuint InstancingProgram()
+{
+    static GLuint program = 0;
+    static bool failed = false;
+    if (program || failed)
+        return program;
+    GLuint shader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(shader, 1, &INSTANCING_SHADER, NULL);
+    glCompileShader(shader);
+    GLint status;
+    char log[1024];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status)
+    {
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        cerr << "Error: InstanceGroup: could not compile vertex shader:\n" << log << endl;
+        glDeleteShader(shader);
+        failed = true;
+        return 0;
+    }
+    program = glCreateProgram();
+    glAttachShader(program, shader);
+    const char* names[] = { "instanceColumn0", "instanceColumn1", "instanceColumn2",
+                            "instanceColumn3" };
+    for (GLuint column = 0; column < 4; ++column)
+        glBindAttribLocation(program, MATRIX_LOCATION + column, names[column]);
+    glBindAttribLocation(program, COLOR_LOCATION, "instanceColor");
+    glLinkProgram(program);
+    glDeleteShader(shader); // flagged for deletion with the program
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (!status)
+    {
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        cerr << "Error: InstanceGroup: could not link instancing program:\n" << log << endl;
+        glDeleteProgram(program);
+        program = 0;
+        failed = true;
+        return 0;
+    }
+    lightingLocation = glGetUniformLocation(program, "lighting");
+    useColorLocation = glGetUniformLocation(program, "useColor");
+    lightEnabledLocation = glGetUniformLocation(program, "lightEnabled");
+    numLightsLocation = glGetUniformLocation(program, "numLights");
+    return program;
+}
+#endif
+
+bool VART::InstanceGroup::IsInstancingAvailable()
+{
+#if defined(VART_OGL) && defined(GL_VERSION_3_3)
+    static int available = -1; // unknown
+    if (available < 0)
+    {
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        if (!version)
+            return false; // no context yet: ask again later
+        int major = 0;
+        int minor = 0;
+        sscanf(version, "%d.%d", &major, &minor);
+        available = (major > 3) || ((major == 3) && (minor >= 3));
+    }
+    return available == 1;
+#else
+    return false;
+#endif
+}
+
+VART::InstanceGroup::InstanceGroup()
+    : meshObjPtr(NULL), numDrawn(0)
+{
+}
+
+VART::InstanceGroup::InstanceGroup(const MeshObject& meshObj)
+    : meshObjPtr(&meshObj), numDrawn(0)
+{
+}
+
+VART::InstanceGroup::InstanceGroup(const InstanceGroup& group)
+{
+    this->operator=(group);
+}
+
+VART::InstanceGroup& VART::InstanceGroup::operator=(const InstanceGroup& group)
+{
+    this->GraphicObj::operator=(group);
+    meshObjPtr = group.meshObjPtr;
+    matrixVec = group.matrixVec;
+    colorVec = group.colorVec;
+    numDrawn = 0;
+    return *this;
+}
+
+VART::SceneNode* VART::InstanceGroup::Copy()
+{
+    return new InstanceGroup(*this);
+}
+
+void VART::InstanceGroup::SetMeshObject(const MeshObject& meshObj)
+{
+    meshObjPtr = &meshObj;
+}
+
+unsigned int VART::InstanceGroup::AddInstance(const Matrix4& matrix)
+{
+    matrixVec.push_back(matrix);
+    if (!colorVec.empty())
+        colorVec.push_back(Color::WHITE());
+    return matrixVec.size() - 1;
+}
+
+unsigned int VART::InstanceGroup::AddInstance(const Matrix4& matrix, const Color& color)
+{
+    matrixVec.push_back(matrix);
+    SetColor(matrixVec.size() - 1, color);
+    return matrixVec.size() - 1;
+}
+
+void VART::InstanceGroup::SetColor(unsigned int index, const Color& color)
+{
+    colorVec.resize(matrixVec.size(), Color::WHITE());
+    colorVec[index] = color;
+}
+
+void VART::InstanceGroup::ClearInstances()
+{
+    matrixVec.clear();
+    colorVec.clear();
+}
+
+void VART::InstanceGroup::ComputeBoundingBox()
+{
+    if (!meshObjPtr || matrixVec.empty())
+    {
+        bBox.SetBoundingBox(0, 0, 0, 0, 0, 0);
+        return;
+    }
+    const BoundingBox& box = meshObjPtr->GetBoundingBox();
+    double center[3] = { (box.GetSmallerX() + box.GetGreaterX()) / 2,
+                         (box.GetSmallerY() + box.GetGreaterY()) / 2,
+                         (box.GetSmallerZ() + box.GetGreaterZ()) / 2 };
+    double extent[3] = { box.GetEdgeX() / 2, box.GetEdgeY() / 2, box.GetEdgeZ() / 2 };
+    double bounds[6];
+    for (unsigned int i = 0; i < matrixVec.size(); ++i)
+    {
+        const Matrix4& m = matrixVec[i];
+        for (unsigned int row = 0; row < 3; ++row)
+        {
+            double placedCenter = m[row] * center[0] + m[row+4] * center[1]
+                                  + m[row+8] * center[2] + m[row+12];
+            double placedExtent = fabs(m[row]) * extent[0] + fabs(m[row+4]) * extent[1]
+                                  + fabs(m[row+8]) * extent[2];
+            if ((i == 0) || (placedCenter - placedExtent < bounds[row]))
+                bounds[row] = placedCenter - placedExtent;
+            if ((i == 0) || (placedCenter + placedExtent > bounds[row+3]))
+                bounds[row+3] = placedCenter + placedExtent;
+        }
+    }
+    bBox.SetBoundingBox(bounds[0], bounds[1], bounds[2], bounds[3], bounds[4], bounds[5]);
+}
+
+void VART::InstanceGroup::CullInstances(const Matrix4& modelView,
+                                        const Matrix4& projection) const
+{
+    // Planes of the view volume in the group's coordinates, from rows of the product of
+    // projection and modelview (left, right, bottom, top, near, far)
+    Matrix4 clip;
+    Matrix4::Multiply(projection, modelView, &clip);
+    double planes[6][4];
+    for (unsigned int axis = 0; axis < 3; ++axis)
+        for (unsigned int col = 0; col < 4; ++col)
+        {
+            planes[axis*2][col] = clip[col*4+3] + clip[col*4+axis];
+            planes[axis*2+1][col] = clip[col*4+3] - clip[col*4+axis];
+        }
+    // The mesh object's box, as a center and half edges
+    const BoundingBox& box = meshObjPtr->GetBoundingBox();
+    double center[3] = { (box.GetSmallerX() + box.GetGreaterX()) / 2,
+                         (box.GetSmallerY() + box.GetGreaterY()) / 2,
+                         (box.GetSmallerZ() + box.GetGreaterZ()) / 2 };
+    double extent[3] = { box.GetEdgeX() / 2, box.GetEdgeY() / 2, box.GetEdgeZ() / 2 };
+    bool colored = !colorVec.empty();
+    visibleMatrixVec.resize(matrixVec.size() * 16);
+    if (colored)
+        visibleColorVec.resize(matrixVec.size() * 4);
+    numDrawn = 0;
+    Matrix4 product;
+    for (unsigned int i = 0; i < matrixVec.size(); ++i)
+    {
+        // Place the box with the instance's matrix (the result encloses the placed box)
+        const Matrix4& m = matrixVec[i];
+        double placedCenter[3];
+        double placedExtent[3];
+        for (unsigned int row = 0; row < 3; ++row)
+        {
+            placedCenter[row] = m[row] * center[0] + m[row+4] * center[1]
+                                + m[row+8] * center[2] + m[row+12];
+            placedExtent[row] = fabs(m[row]) * extent[0] + fabs(m[row+4]) * extent[1]
+                                + fabs(m[row+8]) * extent[2];
+        }
+        // Cull if completely outside any plane
+        bool visible = true;
+        for (unsigned int p = 0; visible && (p < 6); ++p)
+        {
+            const double* plane = planes[p];
+            double distance = plane[0] * placedCenter[0] + plane[1] * placedCenter[1]
+                              + plane[2] * placedCenter[2] + plane[3];
+            double reach = fabs(plane[0]) * placedExtent[0] + fabs(plane[1]) * placedExtent[1]
+                           + fabs(plane[2]) * placedExtent[2];
+            visible = (distance + reach >= 0);
+        }
+        if (!visible)
+            continue;
+        Matrix4::Multiply(modelView, m, &product);
+        float* matrixPtr = &visibleMatrixVec[numDrawn * 16];
+        for (unsigned int e = 0; e < 16; ++e)
+            matrixPtr[e] = static_cast<float>(product[e]);
+        if (colored)
+        {
+            unsigned char* colorPtr = &visibleColorVec[numDrawn * 4];
+            colorVec[i].GetRGBA(colorPtr, colorPtr + 1, colorPtr + 2, colorPtr + 3);
+        }
+        ++numDrawn;
+    }
+}
+
+bool VART::InstanceGroup::DrawInstanced(bool texCoords) const
+{
+#if defined(VART_OGL) && defined(GL_VERSION_3_3)
+    GLuint program = InstancingProgram();
+    if (!program)
+        return false;
+    glUseProgram(program);
+    // Lights are usually enabled in sequence: the shader skips those after the last one
+    GLint lightEnabled[8];
+    GLint numLights = 0;
+    for (GLint i = 0; i < 8; ++i)
+    {
+        lightEnabled[i] = glIsEnabled(GL_LIGHT0 + i);
+        if (lightEnabled[i])
+            numLights = i + 1;
+    }
+    glUniform1iv(lightEnabledLocation, 8, lightEnabled);
+    glUniform1i(numLightsLocation, numLights);
+    glUniform1i(lightingLocation, glIsEnabled(GL_LIGHTING));
+    glUniform1i(useColorLocation, !colorVec.empty());
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        glEnableVertexAttribArray(MATRIX_LOCATION + column);
+        glVertexAttribPointer(MATRIX_LOCATION + column, 4, GL_FLOAT, GL_FALSE,
+                              16 * sizeof(float), &visibleMatrixVec[column * 4]);
+        glVertexAttribDivisor(MATRIX_LOCATION + column, 1);
+    }
+    if (!colorVec.empty())
+    {
+        glEnableVertexAttribArray(COLOR_LOCATION);
+        glVertexAttribPointer(COLOR_LOCATION, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0,
+                              &visibleColorVec[0]);
+        glVertexAttribDivisor(COLOR_LOCATION, 1);
+    }
+    list<Mesh>::const_iterator iter = meshObjPtr->meshList.begin();
+    for (; iter != meshObjPtr->meshList.end(); ++iter)
+    {
+        iter->material.DrawOGL();
+        if (texCoords && iter->material.HasTexture())
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        else
+            glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDrawElementsInstanced(iter->GetOglType(), iter->indexVec.size(), GL_UNSIGNED_INT,
+                                &iter->indexVec[0], numDrawn);
+        ++FrameStats::current.drawCalls[iter->type];
+        FrameStats::current.indices[iter->type] += iter->indexVec.size() * numDrawn;
+    }
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        glVertexAttribDivisor(MATRIX_LOCATION + column, 0);
+        glDisableVertexAttribArray(MATRIX_LOCATION + column);
+    }
+    if (!colorVec.empty())
+    {
+        glVertexAttribDivisor(COLOR_LOCATION, 0);
+        glDisableVertexAttribArray(COLOR_LOCATION);
+    }
+    glUseProgram(0);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool VART::InstanceGroup::DrawOneByOne(bool texCoords) const
+{
+#ifdef VART_OGL
+    bool colored = !colorVec.empty();
+    // Instances may be scaled
+    GLboolean normalize = glIsEnabled(GL_NORMALIZE);
+    glEnable(GL_NORMALIZE);
+    if (colored)
+    { // instance colors replace material colors
+        glColorMaterial(GL_FRONT, GL_AMBIENT_AND_DIFFUSE);
+        glEnable(GL_COLOR_MATERIAL);
+    }
+    // Matrices of instances already include the modelview matrix: keep it to restore
+    glPushMatrix();
+    list<Mesh>::const_iterator iter = meshObjPtr->meshList.begin();
+    for (; iter != meshObjPtr->meshList.end(); ++iter)
+    {
+        iter->material.DrawOGL();
+        if (texCoords && iter->material.HasTexture())
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+        else
+            glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        GLenum type = iter->GetOglType();
+        unsigned int size = iter->indexVec.size();
+        const unsigned int* indices = &iter->indexVec[0];
+        for (unsigned int i = 0; i < numDrawn; ++i)
+        {
+            glLoadMatrixf(&visibleMatrixVec[i * 16]);
+            if (colored)
+                glColor4ubv(&visibleColorVec[i * 4]);
+            glDrawElements(type, size, GL_UNSIGNED_INT, indices);
+        }
+        FrameStats::current.drawCalls[iter->type] += numDrawn;
+        FrameStats::current.indices[iter->type] += size * numDrawn;
+    }
+    glPopMatrix();
+    if (colored)
+        glDisable(GL_COLOR_MATERIAL);
+    if (!normalize)
+        glDisable(GL_NORMALIZE);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool VART::InstanceGroup::DrawInstanceOGL() const
+{
+#ifdef VART_OGL
+    bool result = true;
+    numDrawn = 0;
+    if (show && meshObjPtr && !matrixVec.empty() && !meshObjPtr->vertCoordVec.empty())
+    {
+        Matrix4 modelView;
+        Matrix4 projection;
+        glGetDoublev(GL_MODELVIEW_MATRIX, &modelView[0]);
+        glGetDoublev(GL_PROJECTION_MATRIX, &projection[0]);
+        CullInstances(modelView, projection);
+        if (numDrawn > 0)
+        {
+            switch (howToShow)
+            {
+                case LINES:
+                case LINES_AND_NORMALS:
+                    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+                    break;
+                case POINTS:
+                case POINTS_AND_NORMALS:
+                    glPolygonMode(GL_FRONT_AND_BACK, GL_POINT);
+                    break;
+                default:
+                    glPolygonMode(GL_FRONT, GL_FILL);
+                    break;
+            }
+            // Arrays of the mesh object are shared by all instances
+            const MeshObject& meshObj = *meshObjPtr;
+            // Normals and texture coordinates are optional: arrays that do not match the
+            // vertices are left off
+            unsigned int numCoords = meshObj.vertCoordVec.size();
+            bool normals = (meshObj.normCoordVec.size() == numCoords);
+            bool texCoords = (meshObj.textCoordVec.size() == numCoords);
+            glVertexPointer(3, GL_DOUBLE, 0, &meshObj.vertCoordVec[0]);
+            if (normals)
+                glNormalPointer(GL_DOUBLE, 0, &meshObj.normCoordVec[0]);
+            else
+                glDisableClientState(GL_NORMAL_ARRAY);
+            if (texCoords)
+                glTexCoordPointer(3, GL_FLOAT, 0, &meshObj.textCoordVec[0]);
+            FrameStats::current.vertexBytes += numCoords * sizeof(double);
+            if (normals)
+                FrameStats::current.vertexBytes += numCoords * sizeof(double);
+            if (texCoords)
+                FrameStats::current.vertexBytes += numCoords * sizeof(float);
+            if (!(instancing && IsInstancingAvailable() && DrawInstanced(texCoords)))
+                result = DrawOneByOne(texCoords);
+            // Viewers keep normal arrays enabled
+            if (!normals)
+                glEnableClientState(GL_NORMAL_ARRAY);
+        }
+    }
+    if (bBox.visible)
+        bBox.DrawInstanceOGL();
+    if (recBBox.visible)
+        recBBox.DrawInstanceOGL();
+    return result;
+#else
+    return false;
+#endif
+}
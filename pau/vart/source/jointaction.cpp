@@ -3,10 +3,12 @@
 /// \version $Revision: 1.1 $
 
 #include "vart/dofmover.h"
+#include "vart/profiler.h"
 #include "vart/jointaction.h"
 #include "vart/jointmover.h"
 #include "vart/dof.h"
 #include "vart/dmmodifier.h"
+#include "vart/simulationclock.h"
 
 #include <iostream>
 using namespace std;
@@ -50,7 +52,7 @@ void VART::JointAction::Activate()
         active = true;
         lastPositionIndex = 0;
         // Store current time so that we had data do compute on next Move()
-        lastUpdateTime.Set();
+        lastUpdateTime = SimulationClock::NOW();
 
         // Add action to list of active instances
         AddToActiveInstancesList();
@@ -59,32 +61,8 @@ void VART::JointAction::Activate()
 
 void VART::JointAction::AddToActiveInstancesList()
 {
-    list<BaseAction*>::iterator iter = activeInstances.begin();
-    bool positionNotFound = true;
-    while (positionNotFound && (iter != activeInstances.end()))
-    {
-        JointAction* jaPtr = dynamic_cast<JointAction*>(*iter);
-        // if action is of type JointAction
-        if (jaPtr)
-        {
-            if (jaPtr->priority > priority)
-                ++iter;
-            else
-                positionNotFound = false;
-        }
-        else
-            positionNotFound = false;
-    }
-    if (positionNotFound)
-        // end of list reached
-        activeInstances.push_back(this);
-    else
-        activeInstances.insert(iter, this);
-    //~ iter = activeInstances.begin();
-    //~ cout << "activeInstances: ";
-    //~ for (; iter != activeInstances.end(); ++iter)
-        //~ cout << (*iter)->description << " ";
-    //~ cout << "\n";
+    // Joint actions come before other actions (key -1), higher priorities first
+    AddToActiveList(priority, true);
 }
 
 void VART::JointAction::DeactivateDofMovers()
@@ -124,6 +102,7 @@ VART::JointMover* VART::JointAction::AddJointMover(Joint* jointPtr,
 // virtual
 void VART::JointAction::Move()
 {
+    VART_PROFILE_ZONE("JointAction::Move");
     bool cycled;
     ComputePositionIndex(&cycled);
     if (cycled)
@@ -0,0 +1,186 @@
+/// \file poseplayer.cpp
+/// \brief Implementation file for V-ART class "PosePlayer".
+/// \version $Revision: 1.1 $
+
+#include "vart/poseplayer.h"
+#include "vart/poserecorder.h"
+#include "vart/joint.h"
+#include "vart/dof.h"
+#include "vart/collector.h"
+
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+VART::PosePlayer::PosePlayer() : offset(0), nextFrame(0), failed(false)
+{
+}
+
+void VART::PosePlayer::AddNode(SceneNode* nodePtr)
+{
+    Collector<Joint> collector;
+    nodePtr->TraverseDepthFirst(&collector);
+    for (Collector<Joint>::iterator iter = collector.begin(); iter != collector.end(); ++iter)
+    {
+        Joint* jointPtr = const_cast<Joint*>(*iter);
+        list<Dof*> dofList;
+        jointPtr->GetDofs(&dofList);
+        if (dofList.empty())
+            continue;
+        jointVec.push_back(jointPtr);
+        dofVec.insert(dofVec.end(), dofList.begin(), dofList.end());
+    }
+}
+
+void VART::PosePlayer::AddTransform(Transform* transPtr)
+{
+    transformVec.push_back(transPtr);
+}
+
+unsigned long long VART::PosePlayer::Read()
+{
+    unsigned long long value = 0;
+    unsigned int shift = 0;
+    unsigned char byte;
+    do {
+        if (offset >= data.size())
+        {
+            failed = true;
+            return 0;
+        }
+        byte = data[offset++];
+        value |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+        shift += 7;
+    } while ((byte & 0x80) && (shift < 64));
+    return value;
+}
+
+bool VART::PosePlayer::SetData(const vector<unsigned char>& newData)
+{
+    data = newData;
+    frameOffsetVec.clear();
+    nextFrame = 0;
+    if ((data.size() < 7) || (memcmp(&data[0], "VPOS", 4) != 0)
+        || (data[4] != PoseRecorder::VERSION))
+    {
+        cerr << "Error: PosePlayer: invalid stream." << endl;
+        return false;
+    }
+    offset = 5;
+    failed = false;
+    unsigned int numDofs = Read();
+    unsigned int numTransforms = Read();
+    if (failed)
+    {
+        cerr << "Error: PosePlayer: invalid stream." << endl;
+        return false;
+    }
+    if ((numDofs != dofVec.size()) || (numTransforms != transformVec.size()))
+    {
+        cerr << "Error: PosePlayer: stream has " << numDofs << " DOFs and " << numTransforms
+             << " transforms, but player has " << dofVec.size() << " and "
+             << transformVec.size() << "." << endl;
+        return false;
+    }
+    // Index frames. The last byte of a variable length integer is the only one below 0x80.
+    unsigned int numValues = numDofs + numTransforms * 16;
+    unsigned int size = data.size();
+    while (offset < size)
+    {
+        frameOffsetVec.push_back(offset);
+        ++offset; // key frame flag
+        unsigned int i = 0;
+        for (; (i < numValues) && (offset < size); ++offset)
+            if (data[offset] < 0x80)
+                ++i;
+        if (i < numValues)
+        { // truncated recording: drop the incomplete frame
+            cerr << "Warning: PosePlayer: last frame is incomplete and was dropped." << endl;
+            frameOffsetVec.pop_back();
+        }
+    }
+    currentDofVec.assign(numDofs, 0);
+    currentTransformVec.assign(numTransforms * 16, 0);
+    offset = frameOffsetVec.empty() ? size : frameOffsetVec[0];
+    return true;
+}
+
+bool VART::PosePlayer::LoadFromFile(const string& fileName)
+{
+    ifstream file(fileName.c_str(), ios::in | ios::binary);
+    if (!file)
+    {
+        cerr << "Error: PosePlayer: could not read '" << fileName << "'." << endl;
+        return false;
+    }
+    vector<unsigned char> fileData((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    return SetData(fileData);
+}
+
+bool VART::PosePlayer::DecodeFrame()
+{
+    if (offset >= data.size())
+        return false;
+    if (data[offset++])
+    { // key frame
+        currentDofVec.assign(currentDofVec.size(), 0);
+        currentTransformVec.assign(currentTransformVec.size(), 0);
+    }
+    unsigned int numDofs = currentDofVec.size();
+    for (unsigned int i = 0; i < numDofs; ++i)
+    {
+        unsigned int zigzag = static_cast<unsigned int>(Read());
+        currentDofVec[i] += (zigzag >> 1) ^ (0u - (zigzag & 1));
+    }
+    unsigned int numElements = currentTransformVec.size();
+    for (unsigned int i = 0; i < numElements; ++i)
+    {
+        unsigned long long zigzag = Read();
+        currentTransformVec[i] += (zigzag >> 1) ^ (0ull - (zigzag & 1));
+    }
+    ++nextFrame;
+    return !failed;
+}
+
+bool VART::PosePlayer::Seek(unsigned int frame)
+{
+    if (frame >= frameOffsetVec.size())
+        return false;
+    unsigned int key = frame;
+    while ((key > 0) && (data[frameOffsetVec[key]] == 0))
+        --key;
+    offset = frameOffsetVec[key];
+    nextFrame = key;
+    while (nextFrame < frame)
+        if (!DecodeFrame())
+            return false;
+    return true;
+}
+
+bool VART::PosePlayer::PlayFrame()
+{
+    if (nextFrame >= frameOffsetVec.size())
+        return false;
+    if (!DecodeFrame())
+    {
+        cerr << "Error: PosePlayer: frame " << nextFrame << " is corrupt." << endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < dofVec.size(); ++i)
+    {
+        float position;
+        memcpy(&position, &currentDofVec[i], sizeof(position));
+        dofVec[i]->SetCurrent(position);
+    }
+    for (unsigned int i = 0; i < jointVec.size(); ++i)
+        jointVec[i]->MakeLim();
+    for (unsigned int i = 0; i < transformVec.size(); ++i)
+    {
+        double matrix[16];
+        memcpy(matrix, &currentTransformVec[i * 16], sizeof(matrix));
+        transformVec[i]->SetData(matrix);
+    }
+    return true;
+}
@@ -0,0 +1,243 @@
+/// \file scheduler.cpp
+/// \brief Implementation file for V-ART class "Scheduler".
+/// \version $Revision: 1.1 $
+
+#include "vart/scheduler.h"
+#include "vart/baseaction.h"
+#include "vart/simulationclock.h"
+#include "vart/callback.h"
+#include <cmath>
+#include <cstring>
+
+//#include <iostream>
+using namespace std;
+
+// Number of events allocated at once
+const unsigned int EVENT_BLOCK_SIZE = 256;
+// Tolerance (in ticks) for rounding event and current times
+const double TICK_TOLERANCE = 1e-6;
+
+// Initialization of static attributes
+VART::Scheduler* VART::Scheduler::currentPtr = NULL;
+
+void VART::Scheduler::Event::Cancel()
+{
+    ownerPtr->Cancel(this);
+}
+
+VART::Scheduler::Scheduler() : tickSeconds(1.0/60.0), numEvents(0), dueListPtr(NULL),
+                               freeListPtr(NULL)
+{
+    memset(wheel, 0, sizeof(wheel));
+    Reset();
+}
+
+VART::Scheduler::Scheduler(double seconds) : tickSeconds(seconds), numEvents(0),
+                                             dueListPtr(NULL), freeListPtr(NULL)
+{
+    memset(wheel, 0, sizeof(wheel));
+    Reset();
+}
+
+VART::Scheduler::~Scheduler()
+{
+    if (currentPtr == this)
+        currentPtr = NULL;
+    Reset(); // detaches actions from their deactivation events
+    for (unsigned int i = 0; i < blockVec.size(); ++i)
+        delete[] blockVec[i];
+}
+
+void VART::Scheduler::Reset()
+{
+    for (unsigned int level = 0; level < 4; ++level)
+    {
+        for (unsigned int slot = 0; slot < 256; ++slot)
+        {
+            while (wheel[level][slot])
+                Cancel(wheel[level][slot]);
+        }
+    }
+    while (dueListPtr)
+        Cancel(dueListPtr);
+    double now = SimulationClock::NOW().AsDouble() / tickSeconds;
+    currentTick = (now > 0) ? static_cast<unsigned long long>(now + TICK_TOLERANCE) : 0;
+    numEvents = 0;
+}
+
+VART::Scheduler::Event* VART::Scheduler::Activate(BaseAction* actionPtr, double time)
+{
+    Event* eventPtr = NewEvent(Event::ACTIVATION, time);
+    eventPtr->actionPtr = actionPtr;
+    return eventPtr;
+}
+
+VART::Scheduler::Event* VART::Scheduler::Deactivate(BaseAction* actionPtr, double time)
+{
+    Event* eventPtr = NewEvent(Event::DEACTIVATION, time);
+    eventPtr->actionPtr = actionPtr;
+    return eventPtr;
+}
+
+VART::Scheduler::Event* VART::Scheduler::Call(CallBack* callbackPtr, double time)
+{
+    Event* eventPtr = NewEvent(Event::CALLBACK, time);
+    eventPtr->callbackPtr = callbackPtr;
+    return eventPtr;
+}
+
+void VART::Scheduler::Cancel(Event* eventPtr)
+{
+    Unlink(eventPtr);
+    if ((eventPtr->type == Event::DEACTIVATION) &&
+        (eventPtr->actionPtr->stopEventPtr == eventPtr))
+        eventPtr->actionPtr->stopEventPtr = NULL;
+    eventPtr->nextPtr = freeListPtr;
+    freeListPtr = eventPtr;
+    --numEvents;
+}
+
+unsigned int VART::Scheduler::Update()
+{
+    return Update(SimulationClock::NOW().AsDouble());
+}
+
+unsigned int VART::Scheduler::Update(double time)
+{
+    double timeInTicks = time / tickSeconds + TICK_TOLERANCE;
+    if (timeInTicks < currentTick)
+        return 0;
+    unsigned long long lastTick = static_cast<unsigned long long>(timeInTicks);
+    unsigned int numFired = 0;
+    while (currentTick <= lastTick)
+    {
+        if (numEvents == 0)
+        { // nothing to do, jump to the end
+            currentTick = lastTick + 1;
+            break;
+        }
+        unsigned int index = currentTick & 255;
+        // Entering a new round of level 0, bring events from upper levels
+        if ((index == 0) && (Cascade(1) == 0) && (Cascade(2) == 0))
+            Cascade(3);
+        // The slot may also hold events of the next round, leave them there
+        Event* eventPtr = wheel[0][index];
+        while (eventPtr)
+        {
+            Event* nextPtr = eventPtr->nextPtr;
+            if (eventPtr->tick == currentTick)
+            {
+                Unlink(eventPtr);
+                Link(eventPtr, &dueListPtr);
+            }
+            eventPtr = nextPtr;
+        }
+        // Fire. Events scheduled for current tick while firing go to the due list as well.
+        while (dueListPtr)
+        {
+            eventPtr = dueListPtr;
+            Event::TypeID type = eventPtr->type;
+            BaseAction* actionPtr = eventPtr->actionPtr;
+            CallBack* callbackPtr = eventPtr->callbackPtr;
+            Cancel(eventPtr); // back to the pool before firing
+            ++numFired;
+            switch (type)
+            {
+                case Event::ACTIVATION:
+                    actionPtr->Activate();
+                    break;
+                case Event::DEACTIVATION:
+                    actionPtr->Deactivate();
+                    break;
+                case Event::CALLBACK:
+                    callbackPtr->Activate();
+                    break;
+            }
+        }
+        ++currentTick;
+    }
+    return numFired;
+}
+
+VART::Scheduler::Event* VART::Scheduler::NewEvent(Event::TypeID type, double time)
+{
+    if (freeListPtr == NULL)
+    {
+        Event* blockPtr = new Event[EVENT_BLOCK_SIZE];
+        blockVec.push_back(blockPtr);
+        for (unsigned int i = 0; i < EVENT_BLOCK_SIZE; ++i)
+        {
+            blockPtr[i].nextPtr = freeListPtr;
+            freeListPtr = blockPtr + i;
+        }
+    }
+    Event* eventPtr = freeListPtr;
+    freeListPtr = eventPtr->nextPtr;
+    eventPtr->ownerPtr = this;
+    eventPtr->type = type;
+    eventPtr->actionPtr = NULL;
+    eventPtr->callbackPtr = NULL;
+    // Round up: events never fire early
+    double timeInTicks = ceil(time / tickSeconds - TICK_TOLERANCE);
+    if (timeInTicks < currentTick)
+        eventPtr->tick = currentTick;
+    else
+        eventPtr->tick = static_cast<unsigned long long>(timeInTicks);
+    Insert(eventPtr);
+    ++numEvents;
+    return eventPtr;
+}
+
+void VART::Scheduler::Insert(Event* eventPtr)
+// protected
+{
+    unsigned long long tick = eventPtr->tick;
+    unsigned long long delta = tick - currentTick;
+    if (delta == 0)
+        Link(eventPtr, &dueListPtr);
+    else if (delta < 0x100ULL)
+        Link(eventPtr, &wheel[0][tick & 255]);
+    else if (delta < 0x10000ULL)
+        Link(eventPtr, &wheel[1][(tick >> 8) & 255]);
+    else if (delta < 0x1000000ULL)
+        Link(eventPtr, &wheel[2][(tick >> 16) & 255]);
+    else // events beyond the last level come back here at every cascade
+        Link(eventPtr, &wheel[3][(tick >> 24) & 255]);
+}
+
+void VART::Scheduler::Link(Event* eventPtr, Event** listPtr)
+// protected
+{
+    eventPtr->slotPtr = listPtr;
+    eventPtr->previousPtr = NULL;
+    eventPtr->nextPtr = *listPtr;
+    if (*listPtr)
+        (*listPtr)->previousPtr = eventPtr;
+    *listPtr = eventPtr;
+}
+
+void VART::Scheduler::Unlink(Event* eventPtr)
+// protected
+{
+    if (eventPtr->previousPtr)
+        eventPtr->previousPtr->nextPtr = eventPtr->nextPtr;
+    else
+        *(eventPtr->slotPtr) = eventPtr->nextPtr;
+    if (eventPtr->nextPtr)
+        eventPtr->nextPtr->previousPtr = eventPtr->previousPtr;
+}
+
+unsigned int VART::Scheduler::Cascade(unsigned int level)
+// protected
+{
+    unsigned int index = (currentTick >> (8 * level)) & 255;
+    Event* eventPtr = wheel[level][index];
+    wheel[level][index] = NULL;
+    while (eventPtr)
+    {
+        Event* nextPtr = eventPtr->nextPtr;
+        Insert(eventPtr);
+        eventPtr = nextPtr;
+    }
+    return index;
+}
@@ -0,0 +1,411 @@
+/// \file texturecache.cpp
+/// \brief Implementation file for V-ART class "TextureCache".
+/// \version $Revision: 1.1 $
+
+#include "vart/texturecache.h"
+#include "vart/profiler.h"
+#include <fstream>
+#include <iostream>
+#include <cctype>
+#include <cstdlib>
+#include <climits>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#ifdef VART_OGL
+#include <GL/gl.h>
+#endif
+
+#ifdef IL_LIB
+#include <IL/il.h>
+#endif
+
+using namespace std;
+
+#ifdef IL_LIB
+// DevIL keeps global state, so images are decoded by one thread at a time
+static mutex ilMutex;
+#endif
+
+// Returns the absolute path of a file without links, "." or "..", or an empty string if the
+// file does not exist.
+static string CanonicalPath(const string& fileName)
+{
+#ifdef WIN32
+    char buffer[_MAX_PATH];
+    if (_fullpath(buffer, fileName.c_str(), _MAX_PATH) == NULL)
+        return string();
+#else
+    char buffer[PATH_MAX];
+    if (realpath(fileName.c_str(), buffer) == NULL)
+        return string();
+#endif
+    return buffer;
+}
+
+static bool ReadFile(const string& fileName, vector<unsigned char>* resultPtr)
+{
+    ifstream file(fileName.c_str(), ios::in | ios::binary);
+    if (!file)
+        return false;
+    file.seekg(0, ios::end);
+    streamoff size = file.tellg();
+    file.seekg(0, ios::beg);
+    resultPtr->resize(static_cast<size_t>(size));
+    if (size > 0)
+        file.read(reinterpret_cast<char*>(&(*resultPtr)[0]), size);
+    return !file.fail();
+}
+
+// 64-bit FNV-1a hash
+static unsigned long long Hash(const vector<unsigned char>& data)
+{
+    unsigned long long result = 14695981039346656037ULL;
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        result ^= data[i];
+        result *= 1099511628211ULL;
+    }
+    return result;
+}
+
+class VART::TextureCache::DecodeJob : public VART::WorkQueue::Job {
+    public:
+        DecodeJob(TextureCache* cachePtr, Image* imgPtr, vector<unsigned char>* dataPtr)
+            : cache(*cachePtr), imagePtr(imgPtr)
+        {
+            data.swap(*dataPtr);
+        }
+        virtual void Run()
+        {
+            VART_PROFILE_ZONE("TextureCache::Decode");
+            cache.Decode(imagePtr, &data);
+        }
+    private:
+        TextureCache& cache;
+        Image* imagePtr;
+        vector<unsigned char> data;
+};
+
+VART::TextureCache::Image::Image(const string& name)
+    : fileName(name), width(0), height(0), decoding(false), decoded(false), failed(false),
+      resident(false), textureId(0), textureBytes(0)
+{
+}
+
+VART::TextureCache& VART::TextureCache::Instance()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+VART::TextureCache::TextureCache()
+    : budget(0), textureBytes(0), numDecoded(0), numUploaded(0)
+{
+#ifdef IL_LIB
+    ilInit();
+#endif
+}
+
+VART::TextureCache::~TextureCache()
+{
+    // Texture memory is not freed: the OpenGL context may be gone by now.
+    workQueue.Stop();
+    // Files with the same contents share images, so images are deleted by contents.
+    map<pair<unsigned long long, size_t>, Image*>::iterator iter = contentMap.begin();
+    for (; iter != contentMap.end(); ++iter)
+        delete iter->second;
+}
+
+VART::TextureCache::Image* VART::TextureCache::Request(const string& fileName)
+{
+    string path = CanonicalPath(fileName);
+    unique_lock<mutex> lock(cacheMutex);
+    map<string, Image*>::iterator iter = fileMap.find(path);
+    if (iter != fileMap.end())
+        return iter->second;
+    // Read without holding the lock
+    lock.unlock();
+    vector<unsigned char> data;
+    if (path.empty() || !ReadFile(path, &data))
+    {
+        cerr << "Error: TextureCache::Request: could not read '" << fileName << "'.\n";
+        return NULL;
+    }
+    pair<unsigned long long, size_t> content(Hash(data), data.size());
+    lock.lock();
+    Image*& imagePtr = fileMap[path];
+    if (imagePtr == NULL)
+    { // not requested by another thread meanwhile
+        Image*& contentImagePtr = contentMap[content];
+        if (contentImagePtr == NULL)
+        {
+            contentImagePtr = new Image(path);
+            QueueDecoding(contentImagePtr, &data);
+        }
+        imagePtr = contentImagePtr;
+    }
+    return imagePtr;
+}
+
+unsigned int VART::TextureCache::GetTextureId(Image* imagePtr)
+{
+    if (imagePtr->resident)
+    {
+        residentList.splice(residentList.begin(), residentList, imagePtr->residentPos);
+        return imagePtr->textureId;
+    }
+    {
+        lock_guard<mutex> lock(cacheMutex);
+        if (imagePtr->failed)
+            return 0;
+        if (!imagePtr->decoded)
+        {
+            if (!imagePtr->decoding)
+            {
+                vector<unsigned char> data;
+                QueueDecoding(imagePtr, &data);
+            }
+            return 0;
+        }
+    }
+    return Upload(imagePtr);
+}
+
+unsigned int VART::TextureCache::WaitTextureId(Image* imagePtr)
+{
+    if (imagePtr->resident)
+        return GetTextureId(imagePtr);
+    {
+        unique_lock<mutex> lock(cacheMutex);
+        if (!imagePtr->decoded && !imagePtr->decoding && !imagePtr->failed)
+        {
+            vector<unsigned char> data;
+            QueueDecoding(imagePtr, &data);
+        }
+        while (imagePtr->decoding)
+            decoded.wait(lock);
+        if (imagePtr->failed)
+            return 0;
+    }
+    return Upload(imagePtr);
+}
+
+unsigned int VART::TextureCache::GetNumImages() const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    return contentMap.size();
+}
+
+void VART::TextureCache::Clear()
+{
+    // Finish pending work first: jobs refer to images.
+    unique_lock<mutex> lock(cacheMutex);
+    map<pair<unsigned long long, size_t>, Image*>::iterator iter = contentMap.begin();
+    for (; iter != contentMap.end(); ++iter)
+        while (iter->second->decoding)
+            decoded.wait(lock);
+    for (iter = contentMap.begin(); iter != contentMap.end(); ++iter)
+    {
+        if (iter->second->resident)
+            Evict(iter->second);
+        delete iter->second;
+    }
+    contentMap.clear();
+    fileMap.clear();
+}
+
+void VART::TextureCache::QueueDecoding(Image* imagePtr, vector<unsigned char>* dataPtr)
+{
+    imagePtr->decoding = true;
+    workQueue.Add(new DecodeJob(this, imagePtr, dataPtr));
+}
+
+void VART::TextureCache::Decode(Image* imagePtr, vector<unsigned char>* dataPtr)
+{
+    // The file is read again if its data has been freed (after eviction).
+    bool success = !dataPtr->empty() || ReadFile(imagePtr->fileName, dataPtr);
+    unsigned int width = 0;
+    unsigned int height = 0;
+    vector<unsigned char> pixelVec;
+    if (success)
+    {
+        if ((dataPtr->size() > 2) && ((*dataPtr)[0] == 'P') &&
+            (((*dataPtr)[1] == '5') || ((*dataPtr)[1] == '6')))
+            success = DecodePNM(*dataPtr, &width, &height, &pixelVec);
+        else
+        {
+#ifdef IL_LIB
+            lock_guard<mutex> lock(ilMutex);
+            ILuint ilImageName;
+            ilGenImages(1, &ilImageName);
+            ilBindImage(ilImageName);
+            ilEnable(IL_ORIGIN_SET);
+            ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
+            ilLoadL(IL_TYPE_UNKNOWN, &(*dataPtr)[0], dataPtr->size());
+            ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+            ILubyte* imageData = ilGetData();
+            success = (ilGetError() == IL_NO_ERROR) && (imageData != NULL);
+            if (success)
+            {
+                width = ilGetInteger(IL_IMAGE_WIDTH);
+                height = ilGetInteger(IL_IMAGE_HEIGHT);
+                pixelVec.assign(imageData, imageData + width * height * 4);
+            }
+            ilDeleteImages(1, &ilImageName);
+#else
+            success = false;
+#endif
+        }
+    }
+    if (success)
+        BuildMipmaps(width, height, &pixelVec);
+    else
+        cerr << "Error: TextureCache could not decode '" << imagePtr->fileName << "'.\n";
+    lock_guard<mutex> lock(cacheMutex);
+    imagePtr->width = width;
+    imagePtr->height = height;
+    imagePtr->pixelVec.swap(pixelVec);
+    imagePtr->decoded = success;
+    imagePtr->failed = !success;
+    imagePtr->decoding = false;
+    ++numDecoded;
+    decoded.notify_all();
+}
+
+unsigned int VART::TextureCache::Upload(Image* imagePtr)
+{
+    // Decoded data is only changed by this thread from now on, so no lock is needed.
+    unsigned long bytes = imagePtr->pixelVec.size();
+    while ((budget > 0) && (textureBytes + bytes > budget) && !residentList.empty())
+        Evict(residentList.back());
+    imagePtr->textureId = 0;
+#ifdef VART_OGL
+    glGenTextures(1, &imagePtr->textureId);
+    glBindTexture(GL_TEXTURE_2D, imagePtr->textureId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    unsigned int width = imagePtr->width;
+    unsigned int height = imagePtr->height;
+    size_t offset = 0;
+    for (int level = 0; offset < bytes; ++level)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, width, height, 0, GL_RGBA,
+                     GL_UNSIGNED_BYTE, &imagePtr->pixelVec[offset]);
+        offset += width * height * 4;
+        width = (width > 1) ? width / 2 : 1;
+        height = (height > 1) ? height / 2 : 1;
+    }
+#endif
+    imagePtr->resident = true;
+    imagePtr->textureBytes = bytes;
+    imagePtr->residentPos = residentList.insert(residentList.begin(), imagePtr);
+    textureBytes += bytes;
+    ++numUploaded;
+    lock_guard<mutex> lock(cacheMutex);
+    vector<unsigned char>().swap(imagePtr->pixelVec);
+    imagePtr->decoded = false;
+    return imagePtr->textureId;
+}
+
+void VART::TextureCache::Evict(Image* imagePtr)
+{
+#ifdef VART_OGL
+    glDeleteTextures(1, &imagePtr->textureId);
+#endif
+    residentList.erase(imagePtr->residentPos);
+    textureBytes -= imagePtr->textureBytes;
+    imagePtr->textureBytes = 0;
+    imagePtr->textureId = 0;
+    imagePtr->resident = false;
+}
+
+bool VART::TextureCache::DecodePNM(const vector<unsigned char>& data, unsigned int* widthPtr,
+                                   unsigned int* heightPtr, vector<unsigned char>* resultPtr)
+{
+    // Header: magic number, width, height and maximum value, separated by white space and
+    // comments, then a single white space character.
+    unsigned int header[3];
+    size_t pos = 2;
+    for (int i = 0; i < 3; ++i)
+    {
+        while ((pos < data.size()) && (isspace(data[pos]) || (data[pos] == '#')))
+        {
+            if (data[pos] == '#')
+                while ((pos < data.size()) && (data[pos] != '\n'))
+                    ++pos;
+            else
+                ++pos;
+        }
+        if ((pos == data.size()) || !isdigit(data[pos]))
+            return false;
+        header[i] = 0;
+        while ((pos < data.size()) && isdigit(data[pos]))
+            header[i] = header[i] * 10 + (data[pos++] - '0');
+    }
+    ++pos;
+    unsigned int width = header[0];
+    unsigned int height = header[1];
+    unsigned int maxValue = header[2];
+    unsigned int channels = (data[1] == '6') ? 3 : 1;
+    if ((width == 0) || (height == 0) || (maxValue == 0) || (maxValue > 255) ||
+        (data.size() < pos + static_cast<size_t>(width) * height * channels))
+        return false;
+    resultPtr->resize(static_cast<size_t>(width) * height * 4);
+    unsigned char* outPtr = &(*resultPtr)[0];
+    for (unsigned int y = height; y > 0; --y)
+    {
+        const unsigned char* inPtr = &data[pos + static_cast<size_t>(y - 1) * width * channels];
+        for (unsigned int x = 0; x < width; ++x)
+        {
+            for (unsigned int c = 0; c < 3; ++c)
+                outPtr[c] = inPtr[(channels == 3) ? c : 0] * 255 / maxValue;
+            outPtr[3] = 255;
+            outPtr += 4;
+            inPtr += channels;
+        }
+    }
+    *widthPtr = width;
+    *heightPtr = height;
+    return true;
+}
+
+void VART::TextureCache::BuildMipmaps(unsigned int width, unsigned int height,
+                                      vector<unsigned char>* pixelVecPtr)
+{
+    size_t size = 0;
+    for (unsigned int w = width, h = height; ; w = (w > 1) ? w / 2 : 1, h = (h > 1) ? h / 2 : 1)
+    {
+        size += static_cast<size_t>(w) * h * 4;
+        if ((w == 1) && (h == 1))
+            break;
+    }
+    pixelVecPtr->resize(size);
+    size_t source = 0;
+    while ((width > 1) || (height > 1))
+    {
+        unsigned int newWidth = (width > 1) ? width / 2 : 1;
+        unsigned int newHeight = (height > 1) ? height / 2 : 1;
+        size_t target = source + static_cast<size_t>(width) * height * 4;
+        const unsigned char* srcPtr = &(*pixelVecPtr)[source];
+        unsigned char* dstPtr = &(*pixelVecPtr)[target];
+        // Each pixel is the average of a 2x2 block (or 2x1, for images one pixel wide or tall)
+        unsigned int dx = (width > 1) ? 4 : 0;
+        size_t dy = (height > 1) ? static_cast<size_t>(width) * 4 : 0;
+        for (unsigned int y = 0; y < newHeight; ++y)
+        {
+            const unsigned char* rowPtr = srcPtr + static_cast<size_t>(y) * 2 * width * 4;
+            for (unsigned int x = 0; x < newWidth; ++x)
+            {
+                const unsigned char* p = rowPtr + x * 8;
+                for (unsigned int c = 0; c < 4; ++c)
+                    *dstPtr++ = (p[c] + p[c + dx] + p[c + dy] + p[c + dx + dy] + 2) / 4;
+            }
+        }
+        source = target;
+        width = newWidth;
+        height = newHeight;
+    }
+}
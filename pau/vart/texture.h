@@ -5,6 +5,7 @@
 #ifndef VART_TEXTURE_H
 #define VART_TEXTURE_H
 
+#include "vart/texturecache.h"
 #include <string>
 
 #ifdef WIN32
@@ -45,6 +46,10 @@ namespace VART {
 /// .pbm, .pcd, .pcx, .pgm, .pic, .png, .ppm, .psd, .psp, .raw, .sgi, .tga, 
 /// .tif and .hdr files. Note that to use the Developer Image Library support,
 /// you must compile V-Art with IL_LIB symbol.
+/// <br>
+/// <br>
+/// Images are kept in the TextureCache, so that textures read from the same file (or from
+/// files with the same contents) share their data. Copies of a texture also share data.
     class Texture {
         public:
 
@@ -65,7 +70,8 @@ namespace VART {
 
             /// \brief Loads a texture from a file.
             ///
-            /// Reads a image file and convert it to a graphic texture.
+            /// Reads a image file and convert it to a graphic texture. Requires a current
+            /// OpenGL context.
 
             /// \return True if fileName could be read. False if the file could not
             /// be read, or if V-Art was not compiled with OpenGL or an image reader 
@@ -89,7 +95,18 @@ namespace VART {
             /// A texture contains data if it has been loaded from an image file using
             /// 'VART::Texture::LoadFromFile()' or if the data has been procedurally
             /// generated. There are no methods to generate procedural textures yet.
-            bool HasData() const { return hasTexture; };
+            bool HasData() const { return imagePtr != NULL; };
+
+            /// \brief Starts loading a texture from a file, without waiting for it.
+            /// \return False if the file could not be read.
+            ///
+            /// Needs no OpenGL context, so it may be called by any thread. The image is
+            /// decoded in the background and uploaded when the texture is first drawn. Until
+            /// then, the texture draws as if it held no data.
+            bool RequestFile(const std::string& fileName);
+
+            /// \brief Returns the name of the image file (empty if unknown).
+            const std::string& GetFileName() const { return fileName; }
 
             /// \brief Destructor class.
             ///
@@ -113,11 +130,11 @@ namespace VART {
             /// Indicates if a white texture has been created.
             static bool hasWhiteTexture;
 
-            /// Indicates if a texture image is loaded in current Texture instance object.
-            bool hasTexture;
+            /// The cached image of the texture (NULL if none).
+            TextureCache::Image* imagePtr;
 
-            /// The openGl texture identifier.
-            unsigned int textureId;
+            /// Name of the image file.
+            std::string fileName;
 
 //            /// \brief Reference count to a texture
 //            unsigned int refCount;
@@ -30,6 +30,13 @@ namespace VART {
             /// is some fixed point in time determined by the operating system (usually
             /// 0h of Jan 1, 1970).
             void Set();
+            /// \brief Set to current monotonic time.
+            ///
+            /// Makes the active object hold the elapsed time since some unspecified starting
+            /// point (usually system boot). Unlike Set(), the value is never affected by
+            /// changes in the system clock, therefore it is the right choice for measuring
+            /// time intervals.
+            void SetMonotonic();
             /// \brief Returns the number of whole microseconds in elapsed time.
             unsigned int WholeMicroseconds() const;
             /// \brief Returns the number of whole miliseconds in elapsed time.
@@ -38,6 +45,8 @@ namespace VART {
             unsigned int WholeSeconds() const;
             /// \brief Returns elapsed time (number of seconds) as float.
             float AsFloat() const { return static_cast<float>(seconds); }
+            /// \brief Returns elapsed time (number of seconds) as double.
+            double AsDouble() const { return seconds; }
         // PUBLIC OPERATORS
             Time operator-(const Time& initialTime) const;
             bool operator>=(const Time& t) const { return seconds >= t.seconds; }
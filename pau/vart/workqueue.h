@@ -0,0 +1,67 @@
+/// \file workqueue.h
+/// \brief Header file for V-ART class "WorkQueue".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_WORKQUEUE_H
+#define VART_WORKQUEUE_H
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace VART {
+/// \class WorkQueue workqueue.h
+/// \brief Jobs run by a pool of worker threads.
+///
+/// Jobs are run in the order they were added, by as many threads as set with SetNumThreads.
+/// Threads are started when the first job is added, so that unused queues cost nothing.
+/// Jobs report their results by themselves; the queue only runs and deletes them.
+    class WorkQueue {
+        public:
+        // PUBLIC NESTED CLASSES
+            /// \brief A task to run on a worker thread.
+            class Job {
+                public:
+                    virtual ~Job() {}
+                    /// \brief Does the work. Called once, by a worker thread.
+                    virtual void Run() = 0;
+            };
+        // PUBLIC METHODS
+            /// \brief Creates a queue with one thread per processor.
+            WorkQueue();
+
+            /// \brief Stops the queue (see Stop).
+            ~WorkQueue();
+
+            /// \brief Adds a job to the queue.
+            ///
+            /// The queue takes ownership of the job, deleting it after it has run.
+            void Add(Job* jobPtr);
+
+            /// \brief Discards queued jobs and waits for running ones.
+            ///
+            /// Owners of a queue should stop it before destroying anything jobs may use.
+            void Stop();
+
+            /// \brief Sets the number of worker threads (default: number of processors).
+            ///
+            /// Takes effect before the first job is added.
+            void SetNumThreads(unsigned int value) { numThreads = value; }
+        protected:
+        // PROTECTED METHODS
+            /// \brief Runs queued jobs until the queue is stopped.
+            void Work();
+        // PROTECTED ATTRIBUTES
+            std::deque<Job*> jobQueue;
+            std::vector<std::thread> workerVec;
+            unsigned int numThreads;
+            bool stopping;
+            std::mutex queueMutex;
+            /// \brief Signals that jobs were added (or that workers must stop).
+            std::condition_variable added;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -9,9 +9,11 @@
 #include "vart/xmlbase.h"
 #include <string>
 #include <map>
+#include <list>
 
 namespace VART {
     class MeshObject;
+    class LazyMeshObject;
     class Dof;
     typedef std::map<std::string, MeshObject*> meshObjMap;
     typedef std::map<std::string, meshObjMap> meshMap;
@@ -26,14 +28,27 @@ namespace VART {
             bool LoadScene(const std::string& basePath);
             /// Load the nodes (transformations, geometry, etc.) of the scene.
             SceneNode* LoadSceneNode(XERCES_CPP_NAMESPACE::DOMNode* sceneList, const std::string& basePath);
+            /// \brief Requests every mesh file the document refers to (see MeshCache).
+            ///
+            /// Files are read on worker threads while the scene graph is built.
+            void RequestMeshFiles(const std::string& basePath);
             /// Load MeshObjects from file.
             MeshObject* LoadMeshFromFile(std::string filen, std::string type, std::string meshName);
             /// Load the dofs of the joint.
             void loadDofs( XERCES_CPP_NAMESPACE::DOMNode* node, std::list<Dof*>* dofs);
+            /// \brief Sets whether mesh objects are loaded lazily (default: false).
+            ///
+            /// Lazy mesh objects are LazyMeshObjects, whose files are read when they come into
+            /// view. Their bounding boxes come from a quick scan of the files.
+            void SetLazyLoading(bool value) { lazyLoading = value; }
 
         private:
-            meshObjMap mapMeshObj;
-            meshMap mapMesh;
+            /// Mesh files requested from the MeshCache, released by the destructor.
+            std::list<std::string> meshFileList;
+            bool lazyLoading;
+            /// Placeholders for every mesh object in the files scanned by the current
+            /// LoadFromFile (lazy loading only).
+            std::map<std::string, std::list<LazyMeshObject*> > placeholderMap;
     }; // end class declaration
 } // end namespace
 
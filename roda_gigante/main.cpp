@@ -2,12 +2,16 @@
 #include <vart/light.h>
 #include <vart/arrow.h>
 #include <vart/meshobject.h>
+#include <vart/instancegroup.h>
 #include <vart/sphere.h>
+#include <vart/particlesystem.h>
+#include <vart/simulationclock.h>
 #include <vart/contrib/viewerglutogl.h>
 #include <vart/contrib/mousecontrol.h>
 
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
 
 using namespace std;
 using namespace VART;
@@ -15,38 +19,69 @@ using namespace VART;
 #define NUMBER_OF_CHAIRS 10
 #define ANGLE_BETWEEN_CHAIRS ((2.0 * M_PI) / NUMBER_OF_CHAIRS)
 #define RADIUS_OF_WHEEL 70
+// velocidade angular da roda (radianos por segundo)
+#define WHEEL_ANGULAR_SPEED 1.8
+// intervalo entre fogos de artificio (segundos)
+#define SECONDS_BETWEEN_FIREWORKS 1.5
 
 class MyIHClass : public ViewerGlutOGL::IdleHandler {
     public:
         // transformacoes que ocorrerao durante a execucao do programa
-        vector<Transform*> translationChair;
+        InstanceGroup* chairs;
         Transform* rotationWheel;
+        ParticleSystem* fireworks;
 
         virtual ~MyIHClass() {}
         virtual void OnIdle() {
+            // a roda gira e as faiscas andam a cada passo de simulacao
+            clock.Update();
+            while (clock.Step()) {
+                rotationWheelAngle += WHEEL_ANGULAR_SPEED * clock.GetStep();
+                // de tempos em tempos, explode um fogo de artificio acima da roda
+                timeToFireworks -= clock.GetStep();
+                if(timeToFireworks <= 0) {
+                    fireworks->SetEmitter(Point4D(rand() % 81 - 40,
+                                                  RADIUS_OF_WHEEL + 20 + rand() % 30,
+                                                  rand() % 121 - 60), 1);
+                    fireworks->SetColors(Color(155 + rand() % 101, 100 + rand() % 156,
+                                               rand() % 256),
+                                         Color(255, 80, 0, 0));
+                    fireworks->Emit(3000);
+                    timeToFireworks += SECONDS_BETWEEN_FIREWORKS;
+                }
+                // as faiscas andam, caem e apagam
+                fireworks->Update(clock.GetStep());
+            }
+            // interpola a fracao de passo ainda nao consumida
+            double angle = rotationWheelAngle
+                         + clock.GetAlpha() * WHEEL_ANGULAR_SPEED * clock.GetStep();
+
             // rotacao da roda no eixo X
-            rotationWheel->MakeRotation(Point4D::X(), rotationWheelAngle);
+            rotationWheel->MakeRotation(Point4D::X(), angle);
             
             // translada as cadeiras para sua posicao especifica
             double angleTranslationChair = 0;
-            // para cada uma das transformacoes de cada cadeira
+            Matrix4 translation;
+            // para cada uma das instancias de cadeira
             for(unsigned int i = 0; i < NUMBER_OF_CHAIRS; i++) {
                 // calculo das novas coordenadas
-                double y = RADIUS_OF_WHEEL * sin(angleTranslationChair + rotationWheelAngle);
-                double z = RADIUS_OF_WHEEL * -cos(angleTranslationChair + rotationWheelAngle);
+                double y = RADIUS_OF_WHEEL * sin(angleTranslationChair + angle);
+                double z = RADIUS_OF_WHEEL * -cos(angleTranslationChair + angle);
                 // translacao para as novas coordenadas
-                translationChair[i]->MakeTranslation(0, y, z);
+                translation.MakeTranslation(Point4D(0, y, z));
+                chairs->SetMatrix(i, translation);
                 // varia o angulo para calcular a translacao da proxima cadeira
                 angleTranslationChair += ANGLE_BETWEEN_CHAIRS;
             }
-
-            // varia o angulo de rotacao da roda
-            rotationWheelAngle += 0.03;
             viewerPtr->PostRedisplay();
         }
     private:
         // angulo de rotacao da roda gigente
         double rotationWheelAngle = 0;
+        // tempo ate o proximo fogo de artificio (o primeiro explode logo)
+        double timeToFireworks = 0;
+        // relogio de passo fixo: a velocidade da animacao nao depende da taxa de quadros
+        SimulationClock clock;
 };
 
 // The application itself:
@@ -82,18 +117,15 @@ int main(int argc, char* argv[]) {
     }
 
 
-    // criacao das transformacoes da cadeira
-    vector<Transform*> tChairs;
+    // as cadeiras sao instancias de uma mesma malha, desenhadas de uma vez
+    InstanceGroup* chairs = new InstanceGroup(*chair);
+    Matrix4 identity;
+    identity.MakeIdentity();
     // para cada cadeira
-    for(int i = 0; i < NUMBER_OF_CHAIRS; i++) {
-        Transform* tChair = new Transform();
-        tChair->MakeIdentity();
-        // adiciona a cadeira como filha da transformacao
-        tChair->AddChild(*chair);
-        tChairs.push_back(tChair);
-        // adiciona a transformacao na cena
-        scene.AddObject(tChairs[i]);
-    }
+    for(int i = 0; i < NUMBER_OF_CHAIRS; i++)
+        chairs->AddInstance(identity);
+    // adiciona o grupo de cadeiras na cena
+    scene.AddObject(chairs);
 
     // criacao da transformacao da roda
     Transform* tWheel = new Transform();
@@ -106,13 +138,26 @@ int main(int argc, char* argv[]) {
     // adiciona o suporte na cena
     scene.AddObject(support);
 
+    // faiscas dos fogos de artificio, em todas as direcoes
+    ParticleSystem* fireworks = new ParticleSystem(20000);
+    fireworks->SetDirection(Point4D::Y(), M_PI);
+    fireworks->SetSpeed(10, 25);
+    fireworks->SetLife(1, 2);
+    fireworks->SetGravity(Point4D(0, -9.8, 0, 0));
+    fireworks->SetDrag(0.8);
+    fireworks->SetPointSize(3);
+    fireworks->SetAdditive(true);
+    // desenhadas por ultimo, para nao esconder o que esta atras
+    scene.AddObject(fireworks);
+
     scene.AddLight(Light::BRIGHT_AMBIENT());
     scene.AddCamera(&camera);
 
     // criacao e atribuicao dos valores do idle
     MyIHClass idle;
     idle.rotationWheel = tWheel;
-    idle.translationChair = tChairs;
+    idle.chairs = chairs;
+    idle.fireworks = fireworks;
 
     viewer.SetTitle("V-ART arrow example");
     viewer.SetScene(scene); // attach the scene
@@ -8,6 +8,7 @@
 #include "vart/time.h"
 #include "vart/scenenode.h"
 #include <list>
+#include <map>
 #include <string>
 
 namespace VART {
@@ -104,7 +105,8 @@ namespace VART {
             ///
             /// If greater then zero, the action does not measure real elapsed time from
             /// previous update. Instead it uses this value as elapsed time. Use it for
-            /// creation of offline animations.
+            /// creation of offline animations. Real elapsed time is taken from the current
+            /// SimulationClock if there is one (see SimulationClock::SetCurrent).
             static float frameFrequency;
         // PUBLIC ATTRIBUTES
             /// \brief Textual description
@@ -131,8 +133,16 @@ namespace VART {
             unsigned int priority;
             std::list<JointMover*> jointMoverList;
             Time initialTime;
+            /// \brief Position in the list of active instances (valid while active).
+            std::list<Action*>::iterator activeIter;
+            /// \brief Priority at activation time.
+            unsigned int activePriority;
         // STATIC PROTECTED ATTRIBUTES
             static std::list<Action*> activeInstances;
+            /// \brief First active instance of each priority.
+            ///
+            /// Allows insertion in priority order without searching the list.
+            static std::map<unsigned int, std::list<Action*>::iterator> activeGroups;
         private:
             // keep programmers from creating copies of actions
             Action(const Action& action) {}
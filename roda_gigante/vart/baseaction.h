@@ -6,7 +6,9 @@
 #define VART_BASEACTION_H
 
 #include "vart/time.h"
+#include "vart/scheduler.h"
 #include <list>
+#include <map>
 #include <string>
 
 namespace VART {
@@ -17,8 +19,11 @@ namespace VART {
 /// Actions can be seen as animations. BaseAction is an abstract class providing the interface
 /// for all kinds of actions. In order to use actions, the programmer creates action objects
 /// from derived classes such as TranslationAction; activates them and finally calls
-/// BaseAction::MoveAllActive() before each rendering iteration.
+/// BaseAction::MoveAllActive() before each rendering iteration. Actions take time from the
+/// current SimulationClock, if there is one, or from the wall clock otherwise.
+/// Activation and deactivation may be scheduled ahead of time with a Scheduler.
     class BaseAction {
+        friend class Scheduler;
         public:
         // PUBLIC STATIC METHODS
             /// \brief Moves all active actions.
@@ -31,15 +36,21 @@ namespace VART {
             /// huge.
             BaseAction();
 
-            virtual ~BaseAction() { }
+            /// \brief Leaves the list of active actions (without deactivation callback).
+            virtual ~BaseAction();
 
             void SetSpeed(float newSpeed) { speedModifier = newSpeed; }
+            float GetSpeed() const { return speedModifier; }
             void SetDuration(float seconds) { duration = seconds; }
+            float GetDuration() const { return duration; }
             void SetCyclic(bool value) { cyclic = value; }
             bool IsCyclic() { return cyclic; }
             bool IsActive() const { return active; }
 
             /// \brief Mark for auto deactivation in given time.
+            ///
+            /// If there is a current Scheduler, a deactivation event is scheduled. Otherwise
+            /// time to live is counted down at every move, while the action is active.
             void Deactivate(float seconds);
 
             /// \brief Deactivate now.
@@ -50,6 +61,13 @@ namespace VART {
             /// Once an action becomes active, calls to MoveAllActive() will make it update
             /// its target.
             virtual void Activate();
+
+            /// \brief Moves this action only, if active.
+            ///
+            /// Runs action initializers and moves the action as MoveAllActive() would, but
+            /// neither fires scheduled events nor moves other actions. Meant for driving a
+            /// single action under a private clock (e.g.: to sample it).
+            void MoveAlone();
         // PUBLIC ATTRIBUTES
             std::string description;
 
@@ -73,6 +91,17 @@ namespace VART {
             }; // BaseAction::Initializer
         // PROTECTED STATIC METHODS
         // PROTECTED METHODS
+            /// \brief Inserts the action in the list of active actions.
+            /// \param key [in] Move order. Actions with greater keys are moved first.
+            /// \param newestFirst [in] Whether the action is moved before (true) or after
+            /// (false) other actions with the same key.
+            ///
+            /// Takes constant time for a given number of distinct keys.
+            void AddToActiveList(long key, bool newestFirst);
+
+            /// \brief Removes the action from the list of active actions (constant time).
+            void RemoveFromActiveList();
+
             /// \brief Make the action update its targets.
             ///
             /// Move is to be called from MoveAllActive.
@@ -86,8 +115,25 @@ namespace VART {
             /// it is finished.
             virtual void ComputePositionIndex(bool* cycled);
         // PROTECTED STATIC ATTRIBUTES
-            /// \brief List of active actions.
-            static std::list<BaseAction*> activeInstances;
+            /// \brief First action of the list of active actions.
+            ///
+            /// Active actions are linked by their previousActivePtr and nextActivePtr
+            /// attributes, in move order.
+            static BaseAction* firstActivePtr;
+
+            /// \brief Last action of the list of active actions.
+            static BaseAction* lastActivePtr;
+
+            /// \brief Number of active actions.
+            static unsigned int numActive;
+
+            /// \brief First action of each move order key in the list of active actions.
+            static std::map<long, BaseAction*> activeGroups;
+
+            /// \brief Next action to move during MoveAllActive.
+            ///
+            /// Kept valid when moving an action deactivates others (e.g.: by callbacks).
+            static BaseAction* nextToMovePtr;
 
             /// \brief List of action initializers.
             static std::list<Initializer*> initializers;
@@ -128,6 +174,18 @@ namespace VART {
 
             /// \brief Time of last update.
             Time lastUpdateTime;
+
+            /// \brief Previous action in the list of active actions.
+            BaseAction* previousActivePtr;
+
+            /// \brief Next action in the list of active actions.
+            BaseAction* nextActivePtr;
+
+            /// \brief Move order key given when the action was activated.
+            long activeKey;
+
+            /// \brief Pending deactivation event (see Deactivate(float)).
+            Scheduler::Event* stopEventPtr;
         private:
     }; // end class declaration
 } // end namespace
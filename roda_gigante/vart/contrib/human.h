@@ -47,7 +47,7 @@ namespace VART {
 
             virtual SceneNode* Copy();
             virtual void ComputeBoundingBox();
-            virtual void TraverseDepthFirst(SNOperator* operatorPtr);
+            virtual void TraverseDepthFirst(SNOperator* operatorPtr) const;
             virtual void LocateDepthFirst(SNLocator* locatorPtr) const;
             virtual void DrawForPicking() const;
             /// \brief Loads from a XML file
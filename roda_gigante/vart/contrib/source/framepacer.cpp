@@ -0,0 +1,106 @@
+/// \file framepacer.cpp
+/// \brief Implementation file for V-ART class "FramePacer".
+/// \version $Revision: 1.1 $
+
+#include "vart/contrib/framepacer.h"
+#include "vart/time.h"
+#include <thread>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+
+void VART::FramePacer::Sleep(double seconds)
+{
+    if (seconds > 0)
+        this_thread::sleep_for(chrono::duration<double>(seconds));
+}
+
+VART::FramePacer::FramePacer() : period(0)
+{
+    Reset();
+}
+
+double VART::FramePacer::Now()
+{
+    Time now;
+    now.SetMonotonic();
+    return now.AsDouble();
+}
+
+void VART::FramePacer::SetFrameRate(double framesPerSecond)
+{
+    period = (framesPerSecond > 0) ? 1 / framesPerSecond : 0;
+    Reset();
+}
+
+void VART::FramePacer::Reset()
+{
+    startTime = Now();
+    startCPUTime = clock();
+    nextFrameTime = startTime;
+    lastFrameTime = -1;
+    frames = 0;
+    skippedFrames = 0;
+    dueFrames = 0;
+    frameTimeMean = 0;
+    frameTimeM2 = 0;
+    jitterSum = 0;
+    maxJitter = 0;
+}
+
+bool VART::FramePacer::FrameDue()
+{
+    if (period <= 0)
+        return true;
+    double now = Now();
+    if (now < nextFrameTime)
+        return false;
+    double jitter = now - nextFrameTime;
+    ++dueFrames;
+    jitterSum += jitter;
+    if (jitter > maxJitter)
+        maxJitter = jitter;
+    nextFrameTime += period;
+    // Frames that fell behind are dropped, not drawn in a burst
+    if (nextFrameTime <= now)
+        nextFrameTime = now + period;
+    return true;
+}
+
+double VART::FramePacer::TimeToNextFrame() const
+{
+    if (period <= 0)
+        return 0;
+    double result = nextFrameTime - Now();
+    return (result > 0) ? result : 0;
+}
+
+void VART::FramePacer::FrameDrawn()
+{
+    double now = Now();
+    if (lastFrameTime >= 0)
+    {
+        double frameTime = now - lastFrameTime;
+        // frames counts frame times plus one
+        double delta = frameTime - frameTimeMean;
+        frameTimeMean += delta / frames;
+        frameTimeM2 += delta * (frameTime - frameTimeMean);
+    }
+    lastFrameTime = now;
+    ++frames;
+}
+
+void VART::FramePacer::GetStats(Stats* resultPtr) const
+{
+    resultPtr->frames = frames;
+    resultPtr->skippedFrames = skippedFrames;
+    resultPtr->meanFrameTime = frameTimeMean;
+    resultPtr->frameTimeStdDev = (frames > 2) ? sqrt(frameTimeM2 / (frames - 2)) : 0;
+    resultPtr->meanJitter = (dueFrames > 0) ? jitterSum / dueFrames : 0;
+    resultPtr->maxJitter = maxJitter;
+    double elapsed = Now() - startTime;
+    resultPtr->cpuUsage = (elapsed > 0)
+                          ? (static_cast<double>(clock() - startCPUTime) / CLOCKS_PER_SEC) / elapsed
+                          : 0;
+}
@@ -3,19 +3,25 @@
 /// \version $Revision: 1.3 $
 
 #include "vart/contrib/viewerglutogl.h"
+#include "vart/profiler.h"
 #include <cassert>
 #include <GL/glut.h>
 
 #include <iostream> // FixMe: Remove me if possible.
 #include <cstdlib>
+#include <cstdio>
 
 using namespace std;
 
 const unsigned int MAX_VIEWERS = 6;
+// Longest sleep of the main loop, so that window events are still handled
+const double MAX_SLEEP_TIME = 0.05;
 
 // INITIALIZATION OF STATIC ATRIBUTES
 int VART::ViewerGlutOGL::glutIDVec[6] = { 0, 0, 0, 0, 0, 0 };
 VART::ViewerGlutOGL* VART::ViewerGlutOGL::instancePtrVec[6] = { NULL, NULL, NULL, NULL, NULL, NULL };
+double VART::ViewerGlutOGL::updateRate = 0;
+VART::SimulationClock VART::ViewerGlutOGL::updateClock;
 
 // Keyboard handler methods:
 // virtual, deprecated
@@ -44,6 +50,35 @@ VART::ViewerGlutOGL::ViewerGlutOGL(int newWidth, int newHeight)
     CommonConstructor();
 }
 
+VART::ViewerGlutOGL::ViewerGlutOGL(int newWidth, int newHeight, bool createWindow)
+// private method
+{
+    width = newWidth;
+    height = newHeight;
+    if (createWindow)
+        CommonConstructor();
+    else
+    {
+        // No window, no GLUT calls: only handler bookkeeping is used
+        glutID = 0;
+        ptScene = NULL;
+        idleHndPtr = NULL;
+        kbHandlerPtr = NULL;
+        drawHandlerPtr = NULL;
+        mouseController.SetOwner(this);
+        walkStep = 0.0001;
+        redrawOnIdle = false;
+        redrawOnChange = false;
+        redrawPending = false;
+        lastStateHash = 0;
+        autoChangeCameraAspect = true;
+        autoNavigationEnabled = true;
+        autoRespondKeys = true;
+        showProfiler = false;
+        cameraPtr = NULL;
+    }
+}
+
 void VART::ViewerGlutOGL::CommonConstructor()
 {
     glutInitWindowPosition(0,0);
@@ -55,9 +90,13 @@ void VART::ViewerGlutOGL::CommonConstructor()
     mouseController.SetOwner(this);
     walkStep = 0.0001;
     redrawOnIdle = false;
+    redrawOnChange = false;
+    redrawPending = false;
+    lastStateHash = 0;
     autoChangeCameraAspect = true;
     autoNavigationEnabled = true;
     autoRespondKeys = true;
+    showProfiler = false;
     glShadeModel(GL_SMOOTH);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
@@ -70,6 +109,8 @@ void VART::ViewerGlutOGL::CommonConstructor()
 
 VART::ViewerGlutOGL::~ViewerGlutOGL()
 {
+    if (!HasWindow())
+        return;
     int i = 0;
     while (glutIDVec[i] != glutID)
         ++i;
@@ -86,6 +127,8 @@ void VART::ViewerGlutOGL::SetIdleHandler(IdleHandler* newIHPtr)
 
 void VART::ViewerGlutOGL::SetPosition(int x, int y)
 {
+    if (!HasWindow())
+        return;
     int currentWindow = glutGetWindow();
     glutSetWindow(glutID);
     glutPositionWindow(x,y);
@@ -94,7 +137,6 @@ void VART::ViewerGlutOGL::SetPosition(int x, int y)
 
 void VART::ViewerGlutOGL::SetSize(int newWidth, int newHeight)
 {
-    int currentWindow = glutGetWindow(); // save current window
     if (autoChangeCameraAspect && ptScene)
     {
         ptScene->SetAllCamerasAspectRatio(static_cast<float>(newWidth)/newHeight);
@@ -104,6 +146,9 @@ void VART::ViewerGlutOGL::SetSize(int newWidth, int newHeight)
     }
     width = newWidth;
     height = newHeight;
+    if (!HasWindow())
+        return;
+    int currentWindow = glutGetWindow(); // save current window
     glutSetWindow(glutID);
     glutReshapeWindow(newWidth, newHeight);
     glutSetWindow(currentWindow); // restore current window
@@ -112,6 +157,8 @@ void VART::ViewerGlutOGL::SetSize(int newWidth, int newHeight)
 
 void VART::ViewerGlutOGL::TurnIntoCurrentWindow()
 {
+    if (!HasWindow())
+        return;
     glutSetWindow(glutID);
 }
 
@@ -127,7 +174,7 @@ void VART::ViewerGlutOGL::SetScene(VART::Scene& scene)
     ptScene = &scene;
     if (cameraPtr == NULL)
         cameraPtr = scene.GetCurrentCamera();
-    if (scene.GetNumLights() > 0)
+    if (HasWindow() && (scene.GetNumLights() > 0))
     {
         int currentWindow = glutGetWindow();
         glutSetWindow(glutID);
@@ -195,8 +242,11 @@ void VART::ViewerGlutOGL::DrawCB0()
     }
 #endif
     if (viewerPtr->drawHandlerPtr) // if (drawHandlerPtr != NULL)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
         viewerPtr->drawHandlerPtr->OnDraw();
-    glutSwapBuffers();
+    }
+    viewerPtr->FinishFrame();
 }
 
 void VART::ViewerGlutOGL::DrawCB1()
@@ -205,8 +255,11 @@ void VART::ViewerGlutOGL::DrawCB1()
     viewerPtr->ClearOGLBuffers();
     viewerPtr->ptScene->DrawOGL(viewerPtr->cameraPtr);
     if (viewerPtr->drawHandlerPtr) // if (drawHandlerPtr != NULL)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
         viewerPtr->drawHandlerPtr->OnDraw();
-    glutSwapBuffers();
+    }
+    viewerPtr->FinishFrame();
 }
 
 void VART::ViewerGlutOGL::DrawCB2()
@@ -215,8 +268,11 @@ void VART::ViewerGlutOGL::DrawCB2()
     viewerPtr->ClearOGLBuffers();
     viewerPtr->ptScene->DrawOGL(viewerPtr->cameraPtr);
     if (viewerPtr->drawHandlerPtr) // if (drawHandlerPtr != NULL)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
         viewerPtr->drawHandlerPtr->OnDraw();
-    glutSwapBuffers();
+    }
+    viewerPtr->FinishFrame();
 }
 
 void VART::ViewerGlutOGL::DrawCB3()
@@ -225,8 +281,11 @@ void VART::ViewerGlutOGL::DrawCB3()
     viewerPtr->ClearOGLBuffers();
     viewerPtr->ptScene->DrawOGL(viewerPtr->cameraPtr);
     if (viewerPtr->drawHandlerPtr) // if (drawHandlerPtr != NULL)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
         viewerPtr->drawHandlerPtr->OnDraw();
-    glutSwapBuffers();
+    }
+    viewerPtr->FinishFrame();
 }
 
 void VART::ViewerGlutOGL::DrawCB4()
@@ -235,8 +294,11 @@ void VART::ViewerGlutOGL::DrawCB4()
     viewerPtr->ClearOGLBuffers();
     viewerPtr->ptScene->DrawOGL(viewerPtr->cameraPtr);
     if (viewerPtr->drawHandlerPtr) // if (drawHandlerPtr != NULL)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
         viewerPtr->drawHandlerPtr->OnDraw();
-    glutSwapBuffers();
+    }
+    viewerPtr->FinishFrame();
 }
 
 void VART::ViewerGlutOGL::DrawCB5()
@@ -245,8 +307,59 @@ void VART::ViewerGlutOGL::DrawCB5()
     viewerPtr->ClearOGLBuffers();
     viewerPtr->ptScene->DrawOGL(viewerPtr->cameraPtr);
     if (viewerPtr->drawHandlerPtr) // if (drawHandlerPtr != NULL)
+    {
+        VART_PROFILE_ZONE("DrawHandler::OnDraw");
         viewerPtr->drawHandlerPtr->OnDraw();
-    glutSwapBuffers();
+    }
+    viewerPtr->FinishFrame();
+}
+
+void VART::ViewerGlutOGL::FinishFrame()
+{
+    if (showProfiler)
+        DrawProfilerHUD();
+    {
+        VART_PROFILE_ZONE("ViewerGlutOGL::SwapBuffers");
+        glutSwapBuffers();
+    }
+    if (Profiler::IsEnabled())
+        Profiler::EndFrame();
+    pacer.FrameDrawn();
+}
+
+void VART::ViewerGlutOGL::DrawProfilerHUD()
+{
+    vector<Profiler::Average> averageVec;
+    Profiler::GetAverages(&averageVec);
+    // Draw text in window coordinates, over everything else
+    glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glDisable(GL_DEPTH_TEST);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    gluOrtho2D(0, width, 0, height);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+    glColor3f(1.0f, 1.0f, 0.0f);
+    const int lineHeight = 15;
+    char line[128];
+    int y = height - lineHeight;
+    for (unsigned int i = 0; (i < averageVec.size()) && (y > 0); ++i, y -= lineHeight)
+    {
+        snprintf(line, sizeof(line), "%8.3f ms %6.1fx %s", averageVec[i].milliseconds,
+                 averageVec[i].count, averageVec[i].name.c_str());
+        glRasterPos2i(5, y);
+        for (const char* charPtr = line; *charPtr; ++charPtr)
+            glutBitmapCharacter(GLUT_BITMAP_9_BY_15, *charPtr);
+    }
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
 }
 
 void VART::ViewerGlutOGL::MouseCB0(int button, int state, int x, int y)
@@ -602,6 +715,10 @@ void VART::ViewerGlutOGL::HandleKey(unsigned char key)
         case 's':
             cameraPtr->PitchAroundTarget(-0.01);
             break;
+        case 'p':
+            showProfiler = !showProfiler;
+            Profiler::SetEnabled(showProfiler);
+            break;
         case 'q':
             exit(0);
             break;
@@ -965,22 +1082,92 @@ void VART::ViewerGlutOGL::Idle()
                 ptCam->Yaw(yawAngle);
             }
         }
-        glutPostRedisplay();
+        redrawPending = true;
     }
     if (idleHndPtr) { // if (idleHndPtr != NULL)
+        VART_PROFILE_ZONE("IdleHandler::OnIdle");
         idleHndPtr->OnIdle();
     }
-    if (redrawOnIdle) {
+    // Paced viewers post redraws when frames are due (see IdleMngr)
+    if (!pacer.IsPaced() && NeedsRedraw())
         glutPostRedisplay();
-    }
     glutSetWindow(currentWindow);
 }
 
+bool VART::ViewerGlutOGL::NeedsRedraw()
+{
+    bool changed = true;
+    if (redrawOnChange && ptScene && (redrawPending || redrawOnIdle))
+    {
+        unsigned long long stateHash = ptScene->ComputeStateHash();
+        changed = (stateHash != lastStateHash);
+        lastStateHash = stateHash;
+    }
+    bool result = redrawPending || (redrawOnIdle && changed);
+    redrawPending = false;
+    return result;
+}
+
 void VART::ViewerGlutOGL::IdleMngr()
 {
+    // Simulation: once per call or, with an update rate, once per step of the clock
+    if (updateRate > 0)
+    {
+        updateClock.Update();
+        while (updateClock.Step())
+            for (int i = 0; i < 6; ++i)
+                if (instancePtrVec[i]) // if instancePtrVec[i] != NULL ...
+                    instancePtrVec[i]->Idle();
+    }
+    else
+    {
+        for (int i = 0; i < 6; ++i)
+            if (instancePtrVec[i]) // if instancePtrVec[i] != NULL ...
+                instancePtrVec[i]->Idle();
+    }
+    // Frames of paced viewers. Sleeps until a frame or an update is due, unless an
+    // unpaced viewer is driven by the loop itself.
+    bool canSleep = true;
+    double sleepTime = (updateRate > 0) ? (1 - updateClock.GetAlpha()) * updateClock.GetStep()
+                                        : MAX_SLEEP_TIME;
     for (int i = 0; i < 6; ++i)
-        if (instancePtrVec[i]) // if instancePtrVec[i] != NULL ...
-            instancePtrVec[i]->Idle();
+    {
+        ViewerGlutOGL* viewerPtr = instancePtrVec[i];
+        if (viewerPtr == NULL)
+            continue;
+        if (!viewerPtr->pacer.IsPaced())
+        {
+            if (updateRate <= 0)
+                canSleep = false;
+            continue;
+        }
+        if (viewerPtr->pacer.FrameDue())
+        {
+            if (viewerPtr->NeedsRedraw())
+                viewerPtr->PostRedisplay();
+            else
+                viewerPtr->pacer.FrameSkipped();
+        }
+        double timeToFrame = viewerPtr->pacer.TimeToNextFrame();
+        if (timeToFrame < sleepTime)
+            sleepTime = timeToFrame;
+    }
+    if (canSleep)
+        FramePacer::Sleep(sleepTime);
+}
+
+void VART::ViewerGlutOGL::SetUpdateRate(double updatesPerSecond)
+// static method
+{
+    updateRate = updatesPerSecond;
+    if (updatesPerSecond > 0)
+    {
+        updateClock.SetStep(1 / updatesPerSecond);
+        updateClock.Reset();
+        SimulationClock::SetCurrent(&updateClock);
+    }
+    else if (SimulationClock::GetCurrent() == &updateClock)
+        SimulationClock::SetCurrent(NULL);
 }
 
 void VART::ViewerGlutOGL::RegisterCallbacks()
@@ -1060,6 +1247,8 @@ void VART::ViewerGlutOGL::RegisterCallbacks()
 
 void VART::ViewerGlutOGL::Hide()
 {
+    if (!HasWindow())
+        return;
     int currentWindow = glutGetWindow();
     glutSetWindow(glutID);
     glutHideWindow();
@@ -1068,6 +1257,8 @@ void VART::ViewerGlutOGL::Hide()
 
 void VART::ViewerGlutOGL::Show()
 {
+    if (!HasWindow())
+        return;
     int currentWindow = glutGetWindow();
     glutSetWindow(glutID);
     glutShowWindow();
@@ -1076,6 +1267,8 @@ void VART::ViewerGlutOGL::Show()
 
 void VART::ViewerGlutOGL::SetTitle(const std::string& newTitle)
 {
+    if (!HasWindow())
+        return;
     int currentWindow = glutGetWindow();
     glutSetWindow(glutID);
     glutSetWindowTitle(newTitle.c_str());
@@ -1085,6 +1278,8 @@ void VART::ViewerGlutOGL::SetTitle(const std::string& newTitle)
 
 void VART::ViewerGlutOGL::Iconify()
 {
+    if (!HasWindow())
+        return;
     int currentWindow = glutGetWindow();
     glutSetWindow(glutID);
     glutIconifyWindow();
@@ -1093,6 +1288,8 @@ void VART::ViewerGlutOGL::Iconify()
 
 void VART::ViewerGlutOGL::PostRedisplay()
 {
+    if (!HasWindow())
+        return;
     int currentWindow = glutGetWindow();
     glutSetWindow(glutID);
     glutPostRedisplay();
@@ -0,0 +1,94 @@
+/// \file poserecorder.h
+/// \brief Header file for V-ART class "PoseRecorder".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_POSERECORDER_H
+#define VART_POSERECORDER_H
+
+#include <vector>
+#include <string>
+
+namespace VART {
+    class SceneNode;
+    class Dof;
+    class Transform;
+/// \class PoseRecorder poserecorder.h
+/// \brief Records poses of articulated models, frame by frame, into a binary stream.
+///
+/// A pose recorder captures exactly what the animation system produced: the position of
+/// every DOF below the recorded nodes and, optionally, the matrices of some transforms
+/// (usually the roots of the models). Recordings are replayed by PosePlayer, which does
+/// not need any action, interpolator or DOF mover.
+///
+/// Each frame is stored as a delta from the previous frame: for each DOF position (float)
+/// and transform element (double), the difference between the current and previous bit
+/// patterns is written as a zigzag variable length integer. Still DOFs take one byte per
+/// frame and slow moving ones take two or three. Every n-th frame (see SetKeyFrameInterval)
+/// is a key frame, stored as a delta from zero, so that players can seek. The stream
+/// starts with a header (the "VPOS" signature, a version number, the number of DOFs and the
+/// number of transforms); each frame starts with a byte that tells whether it is a key
+/// frame. Recording is lossless.
+    class PoseRecorder {
+        public:
+        // PUBLIC STATIC ATTRIBUTES
+            /// \brief Stream format version.
+            static const unsigned char VERSION;
+        // PUBLIC METHODS
+            /// \brief Creates a recorder with nothing to record.
+            PoseRecorder();
+
+            /// \brief Records the DOFs of every joint in a scene graph.
+            ///
+            /// Joints are visited in depth first order. Targets must be added before the first
+            /// frame is recorded and, when replaying, must be added to the player in the same
+            /// order.
+            void AddNode(const SceneNode& node);
+
+            /// \brief Records the matrix of a transform.
+            void AddTransform(const Transform& trans);
+
+            /// \brief Sets how often a key frame is recorded (default is 60).
+            void SetKeyFrameInterval(unsigned int frames) { keyFrameInterval = frames; }
+
+            /// \brief Returns the number of DOFs recorded at each frame.
+            unsigned int GetNumDofs() const { return dofVec.size(); }
+
+            /// \brief Returns the number of transforms recorded at each frame.
+            unsigned int GetNumTransforms() const { return transformVec.size(); }
+
+            /// \brief Records current pose as a new frame.
+            void Record();
+
+            /// \brief Returns the number of recorded frames.
+            unsigned int GetNumFrames() const { return numFrames; }
+
+            /// \brief Discards recorded frames (targets are kept).
+            void Clear();
+
+            /// \brief Returns the recorded stream (header and frames).
+            const std::vector<unsigned char>& GetData() const { return data; }
+
+            /// \brief Writes the recorded stream to a file.
+            /// \return False if the file could not be written.
+            bool SaveToFile(const std::string& fileName) const;
+        protected:
+        // PROTECTED METHODS
+            /// \brief Appends an unsigned integer, 7 bits per byte.
+            void Append(unsigned long long value);
+        // PROTECTED ATTRIBUTES
+            /// \brief Recorded DOFs.
+            std::vector<const Dof*> dofVec;
+            /// \brief Recorded transforms.
+            std::vector<const Transform*> transformVec;
+            /// \brief Bit patterns of DOF positions at the previous frame.
+            std::vector<unsigned int> previousDofVec;
+            /// \brief Bit patterns of transform elements at the previous frame.
+            std::vector<unsigned long long> previousTransformVec;
+            /// \brief The stream.
+            std::vector<unsigned char> data;
+            unsigned int numFrames;
+            unsigned int keyFrameInterval;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -0,0 +1,104 @@
+/// \file primitivecache.h
+/// \brief Header file for V-ART class "PrimitiveCache".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_PRIMITIVECACHE_H
+#define VART_PRIMITIVECACHE_H
+
+#include <vector>
+#include <map>
+
+namespace VART {
+/// \class PrimitiveCache primitivecache.h
+/// \brief Shared cache of tessellated primitives (spheres, cylinders and cones).
+///
+/// Primitives are tessellated once, with unit size, at a few levels of detail and kept
+/// as indexed vertex arrays. Sphere, Cylinder and Cone draw them with a scale, instead
+/// of tessellating with GLU at every frame. Level of detail is picked from the size of
+/// the primitive on screen, computed from the current OpenGL matrices and viewport (that
+/// is, under the camera drawing the frame), so that far objects use few triangles and
+/// near ones are smooth.
+///
+/// Tessellations follow GLU's (gluSphere, gluCylinder and gluDisk), including texture
+/// coordinates. The side of a cylinder or cone is a frustum of height 1, whose greatest
+/// radius is 1; frustums are cached for each ratio of radii, rounded to 1/256 so that
+/// animated radii do not fill the cache. Normals of scaled
+/// primitives are renormalized by OpenGL (GL_NORMALIZE is enabled while drawing).
+///
+/// The cache is used by the drawing thread only, with no synchronization.
+    class PrimitiveCache {
+        public:
+        // PUBLIC CONSTANTS
+            /// Number of levels of detail. Level 0 has fewest triangles.
+            static const unsigned int NUM_LEVELS = 4;
+        // PUBLIC NESTED CLASSES
+            /// \brief A tessellated primitive: indexed triangles.
+            class Tessellation {
+                public:
+                    /// \brief Draws triangles, with texture coordinates if asked to.
+                    /// \return False if there is no OpenGL support.
+                    bool DrawOGL(bool textured) const;
+                    /// Vertex coordinates (x, y, z for each vertex).
+                    std::vector<float> coordVec;
+                    /// Vertex normals (x, y, z for each vertex).
+                    std::vector<float> normVec;
+                    /// Texture coordinates (s, t for each vertex).
+                    std::vector<float> texCoordVec;
+                    /// Three indices per triangle, counterclockwise when seen from outside.
+                    std::vector<unsigned int> indexVec;
+            };
+        // PUBLIC STATIC METHODS
+            /// \brief Returns the cache shared by all primitives.
+            static PrimitiveCache& Instance();
+            /// \brief Returns the number of slices (around the Z axis) of a level of detail.
+            static unsigned int GetSlices(unsigned int level);
+        // PUBLIC METHODS
+            PrimitiveCache();
+            ~PrimitiveCache();
+            /// \brief Returns a sphere of radius 1, centered at the origin.
+            const Tessellation& GetSphere(unsigned int level);
+            /// \brief Returns the side of a frustum along the Z axis, from z=0 to z=1.
+            /// \param bottomRadius [in] Radius at z=0, between 0 and 1.
+            /// \param topRadius [in] Radius at z=1, between 0 and 1.
+            ///
+            /// Radii are rounded to multiples of 1/256.
+            const Tessellation& GetFrustum(unsigned int level, float bottomRadius,
+                                           float topRadius);
+            /// \brief Returns a disk of radius 1 at z=0, facing up (+Z) or down (-Z).
+            const Tessellation& GetDisk(unsigned int level, bool facingUp);
+            /// \brief Picks a level of detail for an object of given radius, drawn under the
+            /// current OpenGL matrices and viewport.
+            ///
+            /// Returns the finest level if the camera is within the radius.
+            unsigned int SelectLevel(double radius) const;
+            /// \brief Sets a factor to the size on screen from which levels are picked
+            /// (default 1). Greater factors use finer levels.
+            void SetDetail(double factor) { detail = factor; }
+            /// \brief Returns the factor set by SetDetail.
+            double GetDetail() const { return detail; }
+            /// \brief Returns the number of tessellations in the cache.
+            unsigned int GetNumTessellations() const;
+            /// \brief Removes all tessellations.
+            void Clear();
+        protected:
+        // PROTECTED METHODS
+            static void TessellateSphere(unsigned int slices, unsigned int stacks,
+                                         Tessellation* resultPtr);
+            static void TessellateFrustum(unsigned int slices, float bottomRadius,
+                                          float topRadius, Tessellation* resultPtr);
+            static void TessellateDisk(unsigned int slices, bool facingUp,
+                                       Tessellation* resultPtr);
+        // PROTECTED ATTRIBUTES
+            Tessellation* spheres[NUM_LEVELS];
+            Tessellation* disks[NUM_LEVELS][2];
+            /// Frustums by level, then bottom and top radii.
+            std::map<std::pair<float,float>, Tessellation*> frustums[NUM_LEVELS];
+            double detail;
+        private:
+            // Copying is not allowed
+            PrimitiveCache(const PrimitiveCache&);
+            PrimitiveCache& operator=(const PrimitiveCache&);
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -0,0 +1,118 @@
+/// \file scenesnapshot.h
+/// \brief Header file for V-ART class "SceneSnapshot".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_SCENESNAPSHOT_H
+#define VART_SCENESNAPSHOT_H
+
+#include <vector>
+#include <string>
+
+namespace VART {
+    class Scene;
+    class SceneNode;
+    class Light;
+    class Material;
+    class MeshObject;
+/// \class SceneSnapshot scenesnapshot.h
+/// \brief Binary snapshot of a scene graph.
+///
+/// A snapshot stores the objects and lights of a scene in a compact binary stream that can be
+/// restored without an XML parser. It is meant for saving and reloading large scenes quickly;
+/// XML files (see Scene::XmlPrintOn, XmlStreamScene) remain the interchange format.
+///
+/// Snapshots hold transforms (their matrices), joints and their DOFs (including current
+/// positions), spheres, cylinders, lights and mesh objects. Mesh objects are stored as
+/// references: the name of the file they were read from and their name in the file (see
+/// MeshObject::GetFileName), so files are read again (through the MeshCache) when the
+/// snapshot is restored. Lazy mesh objects are stored with their placeholder boxes and are
+/// restored unloaded. Other scene nodes, and mesh objects not read from files, cannot be
+/// captured. Nodes with many parents are stored once for each parent.
+///
+/// The stream starts with the "VSNP" signature and a version number. Counts and lengths are
+/// variable length integers (7 bits per byte); numbers are stored as their bit patterns, least
+/// significant byte first, so snapshots are portable and lossless.
+    class SceneSnapshot {
+        public:
+        // PUBLIC STATIC ATTRIBUTES
+            /// \brief Stream format version.
+            static const unsigned char VERSION;
+        // PUBLIC METHODS
+            SceneSnapshot();
+
+            /// \brief Captures the objects and lights of a scene.
+            /// \return False if the scene has nodes that cannot be captured. Errors are
+            /// reported to cerr.
+            bool Capture(Scene& scene);
+
+            /// \brief Adds the captured objects and lights to a scene.
+            /// \return False if the stream is invalid or mesh files could not be read (errors
+            /// are reported to cerr), in which case nothing is added.
+            ///
+            /// Created nodes are marked as auto-delete.
+            bool Restore(Scene* scenePtr);
+
+            /// \brief Returns the stream.
+            const std::vector<unsigned char>& GetData() const { return data; }
+
+            /// \brief Sets the stream to restore.
+            void SetData(const std::vector<unsigned char>& newData) { data = newData; }
+
+            /// \brief Writes the stream to a file.
+            /// \return False if the file could not be written.
+            bool SaveToFile(const std::string& fileName) const;
+
+            /// \brief Reads the stream from a file.
+            /// \return False if the file could not be read.
+            bool LoadFromFile(const std::string& fileName);
+        protected:
+        // PROTECTED TYPES
+            /// \brief Kinds of scene nodes in the stream.
+            enum Tag { TRANSFORM = 1, UNIAXIAL_JOINT, BIAXIAL_JOINT, POLYAXIAL_JOINT,
+                       MESH_OBJECT, LAZY_MESH_OBJECT, SPHERE, CYLINDER, LIGHT };
+            /// \brief A mesh object to be filled from the MeshCache at the end of Restore.
+            class PendingMesh
+            {
+                public:
+                    MeshObject* meshObjectPtr;
+                    std::string fileName;
+            };
+        // PROTECTED METHODS
+            /// \brief Appends an unsigned integer, 7 bits per byte.
+            void Append(unsigned long long value);
+            void AppendDouble(double value);
+            void AppendFloat(float value);
+            void AppendString(const std::string& value);
+            void AppendMaterial(const Material& material);
+            void AppendLight(const Light& light);
+            /// \brief Appends a scene node and its children.
+            /// \return False if some node cannot be captured.
+            bool AppendNode(const SceneNode& node);
+
+            /// \brief Reads an unsigned integer, 7 bits per byte.
+            ///
+            /// Reading past the end of the stream returns zeros and sets "failed".
+            unsigned long long Read();
+            double ReadDouble();
+            float ReadFloat();
+            void ReadString(std::string* resultPtr);
+            void ReadMaterial(Material* resultPtr);
+            void ReadLight(Light* resultPtr);
+            /// \brief Reads a scene node and its children.
+            /// \return The node, or NULL if the stream is invalid.
+            SceneNode* ReadNode();
+            /// \brief Deletes a node created by ReadNode, and its children.
+            static void DeleteNode(SceneNode* nodePtr);
+        // PROTECTED ATTRIBUTES
+            /// \brief The stream.
+            std::vector<unsigned char> data;
+            /// \brief Reading position.
+            size_t offset;
+            /// \brief Whether reading went past the end of the stream.
+            bool failed;
+            /// \brief Mesh objects created by Restore.
+            std::vector<PendingMesh> pendingMeshVec;
+    }; // end class declaration
+} // end namespace
+
+#endif
@@ -3,22 +3,38 @@
 /// \version $Revision: 1.1 $
 
 #include "vart/baseaction.h"
-#include "vart/time.h"
+#include "vart/profiler.h"
+#include "vart/simulationclock.h"
 #include "vart/callback.h"
 
 //#include <iostream>
 using namespace std;
 
 // Initialization of static attributes
-list<VART::BaseAction*> VART::BaseAction::activeInstances;
+VART::BaseAction* VART::BaseAction::firstActivePtr = NULL;
+VART::BaseAction* VART::BaseAction::lastActivePtr = NULL;
+unsigned int VART::BaseAction::numActive = 0;
+map<long, VART::BaseAction*> VART::BaseAction::activeGroups;
+VART::BaseAction* VART::BaseAction::nextToMovePtr = NULL;
 list<VART::BaseAction::Initializer*> VART::BaseAction::initializers;
 
 
 VART::BaseAction::BaseAction() : callbackPtr(NULL), cyclic(false), active(false),
-                                 speedModifier(1.0), timeToLive(604800.0f)
+                                 speedModifier(1.0), timeToLive(604800.0f),
+                                 previousActivePtr(NULL), nextActivePtr(NULL),
+                                 stopEventPtr(NULL)
 {
 }
 
+// virtual
+VART::BaseAction::~BaseAction()
+{
+    if (active)
+        RemoveFromActiveList();
+    if (stopEventPtr)
+        stopEventPtr->Cancel();
+}
+
 // virtual
 void VART::BaseAction::Deactivate()
 {
@@ -28,17 +44,11 @@ void VART::BaseAction::Deactivate()
         active = false;
 
         // Remove this instance from list of active actions.
-        list<VART::BaseAction*>::iterator iter = activeInstances.begin();
-        while (iter != activeInstances.end())
-        {
-            if ((*iter) == this)
-            {
-                activeInstances.erase(iter);
-                iter = activeInstances.end(); // force the way out of the while loop
-            }
-            else
-                ++iter;
-        }
+        RemoveFromActiveList();
+
+        // Forget pending deactivation
+        if (stopEventPtr)
+            stopEventPtr->Cancel();
 
         // Call its callback
         if (callbackPtr)
@@ -52,7 +62,15 @@ void VART::BaseAction::Deactivate()
 
 void VART::BaseAction::Deactivate(float seconds)
 {
-    timeToLive = seconds;
+    Scheduler* schedulerPtr = Scheduler::GetCurrent();
+    if (schedulerPtr)
+    {
+        if (stopEventPtr)
+            stopEventPtr->Cancel();
+        stopEventPtr = schedulerPtr->Deactivate(this, SimulationClock::NOW().AsDouble() + seconds);
+    }
+    else
+        timeToLive = seconds;
 }
 
 // virtual
@@ -63,16 +81,22 @@ void VART::BaseAction::Activate()
         active = true;
         lastPositionIndex = 0;
         // Store current time so that we had data do compute on next Move()
-        lastUpdateTime.Set();
+        lastUpdateTime = SimulationClock::NOW();
 
-        // Add action to list of active instances
-        activeInstances.push_back(this);
+        // Add action to the end of the list of active instances, after joint actions (see
+        // JointAction), so that actions move in activation order
+        AddToActiveList(-1, false);
     }
 }
 
 // static
 unsigned int VART::BaseAction::MoveAllActive()
 {
+    VART_PROFILE_ZONE("BaseAction::MoveAllActive");
+    // Fire scheduled events
+    if (Scheduler::GetCurrent())
+        Scheduler::GetCurrent()->Update();
+
     // Run all initializers
     list<VART::BaseAction::Initializer*>::iterator i = initializers.begin();
     while (i != initializers.end())
@@ -82,25 +106,91 @@ unsigned int VART::BaseAction::MoveAllActive()
     }
 
     // Move all actions
-    list<VART::BaseAction*>::iterator iter = activeInstances.begin();
-    list<VART::BaseAction*>::iterator tempIter;
+    BaseAction* actionPtr = firstActivePtr;
+    while (actionPtr)
+    {
+        // the action could remove itself (or others) from the list, see RemoveFromActiveList
+        nextToMovePtr = actionPtr->nextActivePtr;
+        actionPtr->Move();
+        actionPtr = nextToMovePtr;
+    }
+    return numActive;
+}
 
-    while (iter != activeInstances.end())
+void VART::BaseAction::MoveAlone()
+{
+    if (!active)
+        return;
+    list<VART::BaseAction::Initializer*>::iterator i = initializers.begin();
+    for (; i != initializers.end(); ++i)
+        (*i)->Initialize();
+    Move();
+}
+
+void VART::BaseAction::AddToActiveList(long key, bool newestFirst)
+// protected
+{
+    // Insert before the first action of the same key (newest first) or else before the first
+    // action of the greatest key that is smaller than the given one.
+    BaseAction* nextPtr = NULL;
+    map<long, BaseAction*>::iterator iter = activeGroups.lower_bound(key);
+    bool groupExists = (iter != activeGroups.end()) && (iter->first == key);
+    if (groupExists && newestFirst)
+        nextPtr = iter->second;
+    else if (iter != activeGroups.begin())
+        nextPtr = (--iter)->second;
+    if (newestFirst || !groupExists)
+        activeGroups[key] = this;
+    activeKey = key;
+    if (nextPtr)
     {
-        tempIter = iter;
-        ++iter;
-        // the action could remove itself from the list, so use a private iterator copy
-        (*tempIter)->Move();
+        previousActivePtr = nextPtr->previousActivePtr;
+        nextPtr->previousActivePtr = this;
     }
+    else
+    { // end of list
+        previousActivePtr = lastActivePtr;
+        lastActivePtr = this;
+    }
+    nextActivePtr = nextPtr;
+    if (previousActivePtr)
+        previousActivePtr->nextActivePtr = this;
+    else
+        firstActivePtr = this;
+    ++numActive;
+}
 
-    return activeInstances.size();
+void VART::BaseAction::RemoveFromActiveList()
+// protected
+{
+    if (nextToMovePtr == this)
+        nextToMovePtr = nextActivePtr;
+    map<long, BaseAction*>::iterator iter = activeGroups.find(activeKey);
+    if (iter->second == this)
+    {
+        if (nextActivePtr && (nextActivePtr->activeKey == activeKey))
+            iter->second = nextActivePtr;
+        else
+            activeGroups.erase(iter);
+    }
+    if (previousActivePtr)
+        previousActivePtr->nextActivePtr = nextActivePtr;
+    else
+        firstActivePtr = nextActivePtr;
+    if (nextActivePtr)
+        nextActivePtr->previousActivePtr = previousActivePtr;
+    else
+        lastActivePtr = previousActivePtr;
+    previousActivePtr = NULL;
+    nextActivePtr = NULL;
+    --numActive;
 }
 
 // virtual
 void VART::BaseAction::ComputePositionIndex(bool* cycled)
 {
     *cycled = false; // default value
-    Time currentTime = Time::NOW();
+    Time currentTime = SimulationClock::NOW();
     // Compute how much time has passed since last update
     float diffTime = (currentTime - lastUpdateTime).AsFloat();
     // Compute current position index
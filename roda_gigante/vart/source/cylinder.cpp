@@ -3,6 +3,7 @@
 /// \version $Revision: 1.4 $
 
 #include "vart/cylinder.h"
+#include "vart/primitivecache.h"
 #ifdef WIN32
 #include <windows.h>
 #endif
@@ -12,6 +13,7 @@
 
 //?
 #include <iostream>
+#include <cmath>
 using namespace std;
 
 
@@ -161,7 +163,6 @@ bool VART::Cylinder::ShowBottom(void)
 bool VART::Cylinder::DrawInstanceOGL() const
 {
 #ifdef VART_OGL
-    GLUquadricObj* qObj = gluNewQuadric();
     bool result = true;
 
     if (show)
@@ -178,30 +179,40 @@ bool VART::Cylinder::DrawInstanceOGL() const
                 glPolygonMode(GL_FRONT, GL_FILL);
                 break;
         }
-        if ( material.GetTexture().HasData() ) {
-            gluQuadricTexture(qObj,GL_TRUE);
-        }
+        PrimitiveCache& cache = PrimitiveCache::Instance();
+        float maxRadius = (btRadius > topRadius) ? btRadius : topRadius;
+        // The primitive reaches up to "height" from its origin
+        unsigned int level = cache.SelectLevel(sqrt(maxRadius * maxRadius + height * height));
+        bool textured = material.GetTexture().HasData();
         result = material.DrawOGL();
+        // Parts are unit primitives, scaled: normals must be renormalized
+        GLboolean normalize = glIsEnabled(GL_NORMALIZE);
+        glEnable(GL_NORMALIZE);
         // Render sides
-        if (sidesVisible) {
-            gluQuadricDrawStyle(qObj, GLU_FILL);
-            gluQuadricNormals(qObj, GLU_SMOOTH);
-            gluCylinder(qObj, btRadius, topRadius, height, 15, 1);
+        if (sidesVisible && (maxRadius > 0)) {
+            glPushMatrix();
+            glScalef(maxRadius, maxRadius, height);
+            result &= cache.GetFrustum(level, btRadius / maxRadius,
+                                       topRadius / maxRadius).DrawOGL(textured);
+            glPopMatrix();
         }
         // Render bottom
-        if (bottomVisible) {
-            gluQuadricOrientation(qObj,GLU_INSIDE);
-            gluDisk(qObj, 0.0, btRadius, 15, 1);
+        if (bottomVisible && (btRadius > 0)) {
+            glPushMatrix();
+            glScalef(btRadius, btRadius, 1);
+            result &= cache.GetDisk(level, false).DrawOGL(textured);
+            glPopMatrix();
         }
         // Render top
-        if (topVisible) {
+        if (topVisible && (topRadius > 0)) {
             glPushMatrix();
-            gluQuadricOrientation(qObj,GLU_OUTSIDE);
             glTranslatef(0.0f, 0.0f, height);
-            gluDisk(qObj, 0.0, topRadius, 15, 1);
+            glScalef(topRadius, topRadius, 1);
+            result &= cache.GetDisk(level, true).DrawOGL(textured);
             glPopMatrix();
         }
-        gluDeleteQuadric(qObj);
+        if (!normalize)
+            glDisable(GL_NORMALIZE);
     }
     if (bBox.visible) // Is the bounding box visible?
         bBox.DrawInstanceOGL();
@@ -0,0 +1,761 @@
+/// \file matrix4.cpp
+/// \brief Implementation file for V-ART class "Matrix4".
+/// \version $Revision: 1.1 $
+
+// Internal matrix element organization reference
+//           [ data[0] data[4] data[8]  data[12] ]
+// Matrix4 = [ data[1] data[5] data[9]  data[13] ]
+//           [ data[2] data[6] data[10] data[14] ]
+//           [ data[3] data[7] data[11] data[15] ]
+//
+// Kernels keep whole columns in registers: a column takes one AVX register, or two SSE2
+// registers (rows 0-1 and rows 2-3). Operands are read before results are written, so
+// that results may overwrite operands. Loads and stores are unaligned, since transforms
+// are allocated with plain new.
+
+#include "vart/matrix4.h"
+#include "vart/workqueue.h"
+#include <cmath>
+#include <algorithm>
+
+#if !defined(VART_NO_SIMD) && defined(__AVX__)
+#define VART_MATRIX4_AVX
+#include <immintrin.h>
+#elif !defined(VART_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#define VART_MATRIX4_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+// INITIALIZATION OF STATIC ATTRIBUTES
+unsigned int VART::Matrix4::parallelThreshold = 65536;
+unsigned int VART::Matrix4::numThreads = 0;
+
+VART::Matrix4::Matrix4(const double* values)
+{
+    SetData(values);
+}
+
+void VART::Matrix4::SetData(const double* values)
+{
+    for (int i = 0; i < 16; ++i)
+        data[i] = values[i];
+}
+
+void VART::Matrix4::MakeIdentity()
+{
+    for (int i = 0; i < 16; ++i)
+        data[i] = 0.0;
+    data[0] = data[5] = data[10] = data[15] = 1.0;
+}
+
+void VART::Matrix4::MakeTranslation(const Point4D& translationVector)
+{
+    MakeIdentity();
+    data[12] = translationVector.GetX();
+    data[13] = translationVector.GetY();
+    data[14] = translationVector.GetZ();
+}
+
+void VART::Matrix4::MakeXRotation(double radians)
+{
+    MakeIdentity();
+    data[5] =   cos(radians);
+    data[9] =  -sin(radians);
+    data[6] =   sin(radians);
+    data[10] =  cos(radians);
+}
+
+void VART::Matrix4::MakeYRotation(double radians)
+{
+    MakeIdentity();
+    data[0] =   cos(radians);
+    data[8] =   sin(radians);
+    data[2] =  -sin(radians);
+    data[10] =  cos(radians);
+}
+
+void VART::Matrix4::MakeZRotation(double radians)
+{
+    MakeIdentity();
+    data[0] =  cos(radians);
+    data[4] = -sin(radians);
+    data[1] =  sin(radians);
+    data[5] =  cos(radians);
+}
+
+void VART::Matrix4::MakeRotation(const Point4D& refVec, double radians)
+{
+    // Bring refVec to the X axis (rotations around Y, then Z), rotate around X, then bring
+    // the X axis back to refVec.
+    Point4D projEmY;
+    Point4D vetTemp;
+    Matrix4 tTemp;
+    double anguloY;
+    double anguloZ;
+
+    if (fabs(refVec.GetZ()) < 0.0000001)
+    {
+        anguloY = 0.0;
+        MakeIdentity();
+        vetTemp = refVec;
+    }
+    else
+    {
+        // refVec is not on the XY plane
+        projEmY.SetXYZW(refVec.GetX(), 0, refVec.GetZ(), 0);
+        projEmY.Normalize();
+        if (refVec.GetZ() < 0)
+            anguloY = -(projEmY.AngleTo(Point4D(1,0,0,0)));
+        else
+            anguloY = projEmY.AngleTo(Point4D(1,0,0,0));
+        MakeYRotation(anguloY);
+        vetTemp = (*this) * refVec; // refVec on the XY plane
+    }
+    if (vetTemp.GetY() < 0)
+        anguloZ = vetTemp.AngleTo(Point4D(1,0,0,0));
+    else
+        anguloZ = -(vetTemp.AngleTo(Point4D(1,0,0,0)));
+    tTemp.MakeZRotation(anguloZ);
+    MultiplyAffine(tTemp, *this, this);
+    tTemp.MakeXRotation(radians);
+    MultiplyAffine(tTemp, *this, this);
+    tTemp.MakeZRotation(-anguloZ);
+    MultiplyAffine(tTemp, *this, this);
+    tTemp.MakeYRotation(-anguloY);
+    MultiplyAffine(tTemp, *this, this);
+}
+
+void VART::Matrix4::MakeRotation(const Point4D& refPoint, const Point4D& refVec,
+                                 double radians)
+{
+    Matrix4 tTemp;
+
+    MakeTranslation(-refPoint);
+    tTemp.MakeRotation(refVec, radians);
+    MultiplyAffine(tTemp, *this, this);
+    tTemp.MakeTranslation(refPoint);
+    MultiplyAffine(tTemp, *this, this);
+}
+
+void VART::Matrix4::MakeScale(double sX, double sY, double sZ)
+{
+    MakeIdentity();
+    data[0] =  sX;
+    data[5] =  sY;
+    data[10] = sZ;
+}
+
+void VART::Matrix4::MakeShear(double shX, double shY)
+{
+    MakeIdentity();
+    data[8] = shX;
+    data[9] = shY;
+}
+
+VART::Matrix4 VART::Matrix4::operator*(const Matrix4& m) const
+{
+    Matrix4 result;
+    Multiply(*this, m, &result);
+    return result;
+}
+
+void VART::Matrix4::Multiply(const Matrix4& a, const Matrix4& b, Matrix4* resultPtr)
+{
+    const double* pa = a.data;
+    const double* pb = b.data;
+    double* pr = resultPtr->data;
+#if defined(VART_MATRIX4_AVX)
+    __m256d c0 = _mm256_loadu_pd(pa);
+    __m256d c1 = _mm256_loadu_pd(pa + 4);
+    __m256d c2 = _mm256_loadu_pd(pa + 8);
+    __m256d c3 = _mm256_loadu_pd(pa + 12);
+    for (int j = 0; j < 16; j += 4)
+    {
+        __m256d acc = _mm256_mul_pd(c0, _mm256_broadcast_sd(pb + j));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c1, _mm256_broadcast_sd(pb + j + 1)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c2, _mm256_broadcast_sd(pb + j + 2)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c3, _mm256_broadcast_sd(pb + j + 3)));
+        _mm256_storeu_pd(pr + j, acc);
+    }
+#elif defined(VART_MATRIX4_SSE2)
+    __m128d c0l = _mm_loadu_pd(pa);      __m128d c0h = _mm_loadu_pd(pa + 2);
+    __m128d c1l = _mm_loadu_pd(pa + 4);  __m128d c1h = _mm_loadu_pd(pa + 6);
+    __m128d c2l = _mm_loadu_pd(pa + 8);  __m128d c2h = _mm_loadu_pd(pa + 10);
+    __m128d c3l = _mm_loadu_pd(pa + 12); __m128d c3h = _mm_loadu_pd(pa + 14);
+    for (int j = 0; j < 16; j += 4)
+    {
+        __m128d b0 = _mm_set1_pd(pb[j]);
+        __m128d b1 = _mm_set1_pd(pb[j + 1]);
+        __m128d b2 = _mm_set1_pd(pb[j + 2]);
+        __m128d b3 = _mm_set1_pd(pb[j + 3]);
+        __m128d lo = _mm_mul_pd(c0l, b0);
+        __m128d hi = _mm_mul_pd(c0h, b0);
+        lo = _mm_add_pd(lo, _mm_mul_pd(c1l, b1));
+        hi = _mm_add_pd(hi, _mm_mul_pd(c1h, b1));
+        lo = _mm_add_pd(lo, _mm_mul_pd(c2l, b2));
+        hi = _mm_add_pd(hi, _mm_mul_pd(c2h, b2));
+        lo = _mm_add_pd(lo, _mm_mul_pd(c3l, b3));
+        hi = _mm_add_pd(hi, _mm_mul_pd(c3h, b3));
+        _mm_storeu_pd(pr + j, lo);
+        _mm_storeu_pd(pr + j + 2, hi);
+    }
+#else
+    double result[16];
+    for (int j = 0; j < 16; j += 4)
+        for (int i = 0; i < 4; ++i)
+            result[j + i] = pa[i] * pb[j] + pa[i + 4] * pb[j + 1]
+                          + pa[i + 8] * pb[j + 2] + pa[i + 12] * pb[j + 3];
+    for (int i = 0; i < 16; ++i)
+        pr[i] = result[i];
+#endif
+}
+
+void VART::Matrix4::MultiplyAffine(const Matrix4& a, const Matrix4& b, Matrix4* resultPtr)
+{
+    // Row 3 of b is 0, 0, 0, 1: column 3 of a only adds to the translation column.
+    const double* pa = a.data;
+    const double* pb = b.data;
+    double* pr = resultPtr->data;
+#if defined(VART_MATRIX4_AVX)
+    __m256d c0 = _mm256_loadu_pd(pa);
+    __m256d c1 = _mm256_loadu_pd(pa + 4);
+    __m256d c2 = _mm256_loadu_pd(pa + 8);
+    __m256d c3 = _mm256_loadu_pd(pa + 12);
+    for (int j = 0; j < 16; j += 4)
+    {
+        __m256d acc = _mm256_mul_pd(c0, _mm256_broadcast_sd(pb + j));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c1, _mm256_broadcast_sd(pb + j + 1)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c2, _mm256_broadcast_sd(pb + j + 2)));
+        if (j == 12)
+            acc = _mm256_add_pd(acc, c3);
+        _mm256_storeu_pd(pr + j, acc);
+    }
+#elif defined(VART_MATRIX4_SSE2)
+    __m128d c0l = _mm_loadu_pd(pa);      __m128d c0h = _mm_loadu_pd(pa + 2);
+    __m128d c1l = _mm_loadu_pd(pa + 4);  __m128d c1h = _mm_loadu_pd(pa + 6);
+    __m128d c2l = _mm_loadu_pd(pa + 8);  __m128d c2h = _mm_loadu_pd(pa + 10);
+    __m128d c3l = _mm_loadu_pd(pa + 12); __m128d c3h = _mm_loadu_pd(pa + 14);
+    for (int j = 0; j < 16; j += 4)
+    {
+        __m128d b0 = _mm_set1_pd(pb[j]);
+        __m128d b1 = _mm_set1_pd(pb[j + 1]);
+        __m128d b2 = _mm_set1_pd(pb[j + 2]);
+        __m128d lo = _mm_mul_pd(c0l, b0);
+        __m128d hi = _mm_mul_pd(c0h, b0);
+        lo = _mm_add_pd(lo, _mm_mul_pd(c1l, b1));
+        hi = _mm_add_pd(hi, _mm_mul_pd(c1h, b1));
+        lo = _mm_add_pd(lo, _mm_mul_pd(c2l, b2));
+        hi = _mm_add_pd(hi, _mm_mul_pd(c2h, b2));
+        if (j == 12)
+        {
+            lo = _mm_add_pd(lo, c3l);
+            hi = _mm_add_pd(hi, c3h);
+        }
+        _mm_storeu_pd(pr + j, lo);
+        _mm_storeu_pd(pr + j + 2, hi);
+    }
+#else
+    double result[16];
+    for (int j = 0; j < 12; j += 4)
+    {
+        for (int i = 0; i < 3; ++i)
+            result[j + i] = pa[i] * pb[j] + pa[i + 4] * pb[j + 1] + pa[i + 8] * pb[j + 2];
+        result[j + 3] = 0.0;
+    }
+    for (int i = 0; i < 3; ++i)
+        result[12 + i] = pa[i] * pb[12] + pa[i + 4] * pb[13] + pa[i + 8] * pb[14] + pa[i + 12];
+    result[15] = 1.0;
+    for (int i = 0; i < 16; ++i)
+        pr[i] = result[i];
+#endif
+}
+
+VART::Point4D VART::Matrix4::operator*(const Point4D& point) const
+{
+    Point4D result(point);
+    ApplyTo(&result);
+    return result;
+}
+
+void VART::Matrix4::ApplyTo(Point4D* ptPoint) const
+{
+    const double x = ptPoint->GetX();
+    const double y = ptPoint->GetY();
+    const double z = ptPoint->GetZ();
+    const double w = ptPoint->GetW();
+#if defined(VART_MATRIX4_AVX)
+    __m256d acc = _mm256_mul_pd(_mm256_loadu_pd(data), _mm256_set1_pd(x));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(data + 4), _mm256_set1_pd(y)));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(data + 8), _mm256_set1_pd(z)));
+    acc = _mm256_add_pd(acc, _mm256_mul_pd(_mm256_loadu_pd(data + 12), _mm256_set1_pd(w)));
+    double result[4];
+    _mm256_storeu_pd(result, acc);
+    ptPoint->SetXYZW(result[0], result[1], result[2], result[3]);
+#else
+    ptPoint->SetXYZW(data[0] * x + data[4] * y + data[8] * z + data[12] * w,
+                     data[1] * x + data[5] * y + data[9] * z + data[13] * w,
+                     data[2] * x + data[6] * y + data[10] * z + data[14] * w,
+                     data[3] * x + data[7] * y + data[11] * z + data[15] * w);
+#endif
+}
+
+void VART::Matrix4::GetTranspose(Matrix4* resultPtr) const
+{
+#if defined(VART_MATRIX4_AVX) || defined(VART_MATRIX4_SSE2)
+    // Swap 2x2 blocks across the diagonal, transposing each
+    __m128d c0l = _mm_loadu_pd(data);      __m128d c0h = _mm_loadu_pd(data + 2);
+    __m128d c1l = _mm_loadu_pd(data + 4);  __m128d c1h = _mm_loadu_pd(data + 6);
+    __m128d c2l = _mm_loadu_pd(data + 8);  __m128d c2h = _mm_loadu_pd(data + 10);
+    __m128d c3l = _mm_loadu_pd(data + 12); __m128d c3h = _mm_loadu_pd(data + 14);
+    double* pr = resultPtr->data;
+    _mm_storeu_pd(pr,      _mm_unpacklo_pd(c0l, c1l));
+    _mm_storeu_pd(pr + 2,  _mm_unpacklo_pd(c2l, c3l));
+    _mm_storeu_pd(pr + 4,  _mm_unpackhi_pd(c0l, c1l));
+    _mm_storeu_pd(pr + 6,  _mm_unpackhi_pd(c2l, c3l));
+    _mm_storeu_pd(pr + 8,  _mm_unpacklo_pd(c0h, c1h));
+    _mm_storeu_pd(pr + 10, _mm_unpacklo_pd(c2h, c3h));
+    _mm_storeu_pd(pr + 12, _mm_unpackhi_pd(c0h, c1h));
+    _mm_storeu_pd(pr + 14, _mm_unpackhi_pd(c2h, c3h));
+#else
+    double result[16];
+    for (int j = 0; j < 4; ++j)
+        for (int i = 0; i < 4; ++i)
+            result[j * 4 + i] = data[i * 4 + j];
+    resultPtr->SetData(result);
+#endif
+}
+
+bool VART::Matrix4::GetInverse(Matrix4* resultPtr) const
+{
+    const double* m = data;
+    double inv[16];
+    if (IsAffine())
+    {
+        // Inverse of the 3x3 part by cofactors, then the translation is -inverse*t
+        inv[0] = m[5] * m[10] - m[9] * m[6];
+        inv[1] = m[9] * m[2] - m[1] * m[10];
+        inv[2] = m[1] * m[6] - m[5] * m[2];
+        double det = m[0] * inv[0] + m[4] * inv[1] + m[8] * inv[2];
+        if (det == 0)
+            return false;
+        double invDet = 1.0 / det;
+        inv[0] *= invDet;
+        inv[1] *= invDet;
+        inv[2] *= invDet;
+        inv[4] = (m[8] * m[6] - m[4] * m[10]) * invDet;
+        inv[5] = (m[0] * m[10] - m[8] * m[2]) * invDet;
+        inv[6] = (m[4] * m[2] - m[0] * m[6]) * invDet;
+        inv[8] = (m[4] * m[9] - m[8] * m[5]) * invDet;
+        inv[9] = (m[8] * m[1] - m[0] * m[9]) * invDet;
+        inv[10] = (m[0] * m[5] - m[4] * m[1]) * invDet;
+        for (int i = 0; i < 3; ++i)
+            inv[12 + i] = -(inv[i] * m[12] + inv[4 + i] * m[13] + inv[8 + i] * m[14]);
+        inv[3] = inv[7] = inv[11] = 0.0;
+        inv[15] = 1.0;
+    }
+    else
+    {
+        // Adjugate (transposed cofactors) over the determinant
+        inv[0] = m[5]*m[10]*m[15] - m[5]*m[11]*m[14] - m[9]*m[6]*m[15]
+               + m[9]*m[7]*m[14] + m[13]*m[6]*m[11] - m[13]*m[7]*m[10];
+        inv[4] = -m[4]*m[10]*m[15] + m[4]*m[11]*m[14] + m[8]*m[6]*m[15]
+               - m[8]*m[7]*m[14] - m[12]*m[6]*m[11] + m[12]*m[7]*m[10];
+        inv[8] = m[4]*m[9]*m[15] - m[4]*m[11]*m[13] - m[8]*m[5]*m[15]
+               + m[8]*m[7]*m[13] + m[12]*m[5]*m[11] - m[12]*m[7]*m[9];
+        inv[12] = -m[4]*m[9]*m[14] + m[4]*m[10]*m[13] + m[8]*m[5]*m[14]
+                - m[8]*m[6]*m[13] - m[12]*m[5]*m[10] + m[12]*m[6]*m[9];
+        inv[1] = -m[1]*m[10]*m[15] + m[1]*m[11]*m[14] + m[9]*m[2]*m[15]
+               - m[9]*m[3]*m[14] - m[13]*m[2]*m[11] + m[13]*m[3]*m[10];
+        inv[5] = m[0]*m[10]*m[15] - m[0]*m[11]*m[14] - m[8]*m[2]*m[15]
+               + m[8]*m[3]*m[14] + m[12]*m[2]*m[11] - m[12]*m[3]*m[10];
+        inv[9] = -m[0]*m[9]*m[15] + m[0]*m[11]*m[13] + m[8]*m[1]*m[15]
+               - m[8]*m[3]*m[13] - m[12]*m[1]*m[11] + m[12]*m[3]*m[9];
+        inv[13] = m[0]*m[9]*m[14] - m[0]*m[10]*m[13] - m[8]*m[1]*m[14]
+                + m[8]*m[2]*m[13] + m[12]*m[1]*m[10] - m[12]*m[2]*m[9];
+        inv[2] = m[1]*m[6]*m[15] - m[1]*m[7]*m[14] - m[5]*m[2]*m[15]
+               + m[5]*m[3]*m[14] + m[13]*m[2]*m[7] - m[13]*m[3]*m[6];
+        inv[6] = -m[0]*m[6]*m[15] + m[0]*m[7]*m[14] + m[4]*m[2]*m[15]
+               - m[4]*m[3]*m[14] - m[12]*m[2]*m[7] + m[12]*m[3]*m[6];
+        inv[10] = m[0]*m[5]*m[15] - m[0]*m[7]*m[13] - m[4]*m[1]*m[15]
+                + m[4]*m[3]*m[13] + m[12]*m[1]*m[7] - m[12]*m[3]*m[5];
+        inv[14] = -m[0]*m[5]*m[14] + m[0]*m[6]*m[13] + m[4]*m[1]*m[14]
+                - m[4]*m[2]*m[13] - m[12]*m[1]*m[6] + m[12]*m[2]*m[5];
+        inv[3] = -m[1]*m[6]*m[11] + m[1]*m[7]*m[10] + m[5]*m[2]*m[11]
+               - m[5]*m[3]*m[10] - m[9]*m[2]*m[7] + m[9]*m[3]*m[6];
+        inv[7] = m[0]*m[6]*m[11] - m[0]*m[7]*m[10] - m[4]*m[2]*m[11]
+               + m[4]*m[3]*m[10] + m[8]*m[2]*m[7] - m[8]*m[3]*m[6];
+        inv[11] = -m[0]*m[5]*m[11] + m[0]*m[7]*m[9] + m[4]*m[1]*m[11]
+                - m[4]*m[3]*m[9] - m[8]*m[1]*m[7] + m[8]*m[3]*m[5];
+        inv[15] = m[0]*m[5]*m[10] - m[0]*m[6]*m[9] - m[4]*m[1]*m[10]
+                + m[4]*m[2]*m[9] + m[8]*m[1]*m[6] - m[8]*m[2]*m[5];
+        double det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+        if (det == 0)
+            return false;
+        double invDet = 1.0 / det;
+        for (int i = 0; i < 16; ++i)
+            inv[i] *= invDet;
+    }
+    resultPtr->SetData(inv);
+    return true;
+}
+
+// Batch kernels, on matrix elements "m". Bounds are computed even if not wanted, since
+// that costs little next to loads and stores.
+
+// Transforms points, storing them if dst is not NULL
+static void PointsKernel(const double* m, const double* src, double* dst, unsigned int count,
+                         double* bounds)
+{
+    const double* end = src + 3 * count;
+#if defined(VART_MATRIX4_AVX)
+    __m256d c0 = _mm256_loadu_pd(m);
+    __m256d c1 = _mm256_loadu_pd(m + 4);
+    __m256d c2 = _mm256_loadu_pd(m + 8);
+    __m256d c3 = _mm256_loadu_pd(m + 12);
+    __m256d smaller = _mm256_set1_pd(HUGE_VAL);
+    __m256d greater = _mm256_set1_pd(-HUGE_VAL);
+    for (; src != end; src += 3)
+    {
+        __m256d acc = _mm256_add_pd(c3, _mm256_mul_pd(c0, _mm256_broadcast_sd(src)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c1, _mm256_broadcast_sd(src + 1)));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c2, _mm256_broadcast_sd(src + 2)));
+        smaller = _mm256_min_pd(smaller, acc);
+        greater = _mm256_max_pd(greater, acc);
+        if (dst)
+        {
+            _mm_storeu_pd(dst, _mm256_castpd256_pd128(acc));
+            _mm_store_sd(dst + 2, _mm256_extractf128_pd(acc, 1));
+            dst += 3;
+        }
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, smaller);
+    bounds[0] = lanes[0]; bounds[1] = lanes[1]; bounds[2] = lanes[2];
+    _mm256_storeu_pd(lanes, greater);
+    bounds[3] = lanes[0]; bounds[4] = lanes[1]; bounds[5] = lanes[2];
+#elif defined(VART_MATRIX4_SSE2)
+    __m128d c0l = _mm_loadu_pd(m);      __m128d c0h = _mm_load_sd(m + 2);
+    __m128d c1l = _mm_loadu_pd(m + 4);  __m128d c1h = _mm_load_sd(m + 6);
+    __m128d c2l = _mm_loadu_pd(m + 8);  __m128d c2h = _mm_load_sd(m + 10);
+    __m128d c3l = _mm_loadu_pd(m + 12); __m128d c3h = _mm_load_sd(m + 14);
+    __m128d smallerl = _mm_set1_pd(HUGE_VAL);
+    __m128d smallerh = smallerl;
+    __m128d greaterl = _mm_set1_pd(-HUGE_VAL);
+    __m128d greaterh = greaterl;
+    for (; src != end; src += 3)
+    {
+        __m128d x = _mm_set1_pd(src[0]);
+        __m128d y = _mm_set1_pd(src[1]);
+        __m128d z = _mm_set1_pd(src[2]);
+        __m128d lo = _mm_add_pd(c3l, _mm_mul_pd(c0l, x));
+        __m128d hi = _mm_add_sd(c3h, _mm_mul_sd(c0h, x));
+        lo = _mm_add_pd(lo, _mm_mul_pd(c1l, y));
+        hi = _mm_add_sd(hi, _mm_mul_sd(c1h, y));
+        lo = _mm_add_pd(lo, _mm_mul_pd(c2l, z));
+        hi = _mm_add_sd(hi, _mm_mul_sd(c2h, z));
+        smallerl = _mm_min_pd(smallerl, lo);
+        smallerh = _mm_min_sd(smallerh, hi);
+        greaterl = _mm_max_pd(greaterl, lo);
+        greaterh = _mm_max_sd(greaterh, hi);
+        if (dst)
+        {
+            _mm_storeu_pd(dst, lo);
+            _mm_store_sd(dst + 2, hi);
+            dst += 3;
+        }
+    }
+    _mm_storeu_pd(bounds, smallerl);
+    _mm_store_sd(bounds + 2, smallerh);
+    _mm_storeu_pd(bounds + 3, greaterl);
+    _mm_store_sd(bounds + 5, greaterh);
+#else
+    for (int i = 0; i < 3; ++i)
+    {
+        bounds[i] = HUGE_VAL;
+        bounds[i + 3] = -HUGE_VAL;
+    }
+    for (; src != end; src += 3)
+    {
+        const double x = src[0];
+        const double y = src[1];
+        const double z = src[2];
+        double point[3];
+        point[0] = m[12] + m[0] * x + m[4] * y + m[8] * z;
+        point[1] = m[13] + m[1] * x + m[5] * y + m[9] * z;
+        point[2] = m[14] + m[2] * x + m[6] * y + m[10] * z;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (point[i] < bounds[i])
+                bounds[i] = point[i];
+            if (point[i] > bounds[i + 3])
+                bounds[i + 3] = point[i];
+        }
+        if (dst)
+        {
+            dst[0] = point[0];
+            dst[1] = point[1];
+            dst[2] = point[2];
+            dst += 3;
+        }
+    }
+#endif
+}
+
+// Transforms vectors, normalizing them if "normalize" is true
+static void VectorsKernel(const double* m, const double* src, double* dst, unsigned int count,
+                          bool normalize)
+{
+    const double* end = src + 3 * count;
+#if defined(VART_MATRIX4_AVX) || defined(VART_MATRIX4_SSE2)
+    // AVX gains nothing here: normalization needs the three coordinates together
+    __m128d c0l = _mm_loadu_pd(m);      __m128d c0h = _mm_load_sd(m + 2);
+    __m128d c1l = _mm_loadu_pd(m + 4);  __m128d c1h = _mm_load_sd(m + 6);
+    __m128d c2l = _mm_loadu_pd(m + 8);  __m128d c2h = _mm_load_sd(m + 10);
+    for (; src != end; src += 3, dst += 3)
+    {
+        __m128d x = _mm_set1_pd(src[0]);
+        __m128d y = _mm_set1_pd(src[1]);
+        __m128d z = _mm_set1_pd(src[2]);
+        __m128d lo = _mm_mul_pd(c0l, x);
+        __m128d hi = _mm_mul_sd(c0h, x);
+        lo = _mm_add_pd(lo, _mm_mul_pd(c1l, y));
+        hi = _mm_add_sd(hi, _mm_mul_sd(c1h, y));
+        lo = _mm_add_pd(lo, _mm_mul_pd(c2l, z));
+        hi = _mm_add_sd(hi, _mm_mul_sd(c2h, z));
+        if (normalize)
+        {
+            __m128d squares = _mm_mul_pd(lo, lo);
+            __m128d length = _mm_add_sd(_mm_add_sd(squares, _mm_unpackhi_pd(squares, squares)),
+                                        _mm_mul_sd(hi, hi));
+            length = _mm_sqrt_sd(length, length);
+            if (_mm_cvtsd_f64(length) > 0)
+            {
+                length = _mm_unpacklo_pd(length, length);
+                lo = _mm_div_pd(lo, length);
+                hi = _mm_div_sd(hi, length);
+            }
+        }
+        _mm_storeu_pd(dst, lo);
+        _mm_store_sd(dst + 2, hi);
+    }
+#else
+    for (; src != end; src += 3, dst += 3)
+    {
+        const double x = src[0];
+        const double y = src[1];
+        const double z = src[2];
+        double vector[3];
+        vector[0] = m[0] * x + m[4] * y + m[8] * z;
+        vector[1] = m[1] * x + m[5] * y + m[9] * z;
+        vector[2] = m[2] * x + m[6] * y + m[10] * z;
+        if (normalize)
+        {
+            double length = sqrt(vector[0] * vector[0] + vector[1] * vector[1]
+                                 + vector[2] * vector[2]);
+            if (length > 0)
+                for (int i = 0; i < 3; ++i)
+                    vector[i] /= length;
+        }
+        dst[0] = vector[0];
+        dst[1] = vector[1];
+        dst[2] = vector[2];
+    }
+#endif
+}
+
+// Shared state of a batch split among threads
+class MatrixBatch {
+    public:
+        enum Kind { POINTS, VECTORS, NORMALS };
+        // Runs the kernel on a chunk
+        void Run(unsigned int chunk);
+        // Marks a chunk as done
+        void Done();
+        // Waits until all chunks are done
+        void Wait();
+        Kind kind;
+        const double* matrix;
+        const double* src;
+        double* dst;
+        unsigned int count;
+        unsigned int numChunks;
+        // Bounds of each chunk
+        vector<double> boundsVec;
+        unsigned int pending;
+        mutex doneMutex;
+        condition_variable done;
+};
+
+void MatrixBatch::Run(unsigned int chunk)
+{
+    unsigned int first = static_cast<unsigned int>(
+        static_cast<unsigned long long>(count) * chunk / numChunks);
+    unsigned int last = static_cast<unsigned int>(
+        static_cast<unsigned long long>(count) * (chunk + 1) / numChunks);
+    if (kind == POINTS)
+        PointsKernel(matrix, src + 3 * first, dst ? (dst + 3 * first) : NULL, last - first,
+                     &boundsVec[6 * chunk]);
+    else
+        VectorsKernel(matrix, src + 3 * first, dst + 3 * first, last - first, kind == NORMALS);
+}
+
+void MatrixBatch::Done()
+{
+    lock_guard<mutex> lock(doneMutex);
+    if (--pending == 0)
+        done.notify_all();
+}
+
+void MatrixBatch::Wait()
+{
+    unique_lock<mutex> lock(doneMutex);
+    while (pending > 0)
+        done.wait(lock);
+}
+
+// A chunk of a batch, for a worker thread
+class MatrixBatchJob : public VART::WorkQueue::Job {
+    public:
+        MatrixBatchJob(MatrixBatch* batchPtr, unsigned int chunkIndex)
+            : batch(batchPtr), chunk(chunkIndex) {}
+        virtual void Run() { batch->Run(chunk); batch->Done(); }
+    private:
+        MatrixBatch* batch;
+        unsigned int chunk;
+};
+
+// Workers for large batches. Never deleted, so that batches may run during static
+// destruction.
+static VART::WorkQueue* batchQueuePtr = NULL;
+static mutex batchQueueMutex;
+
+// Runs a batch, splitting it among threads (zero: as many as processors) if it is large
+static void RunBatch(MatrixBatch::Kind kind, const double* m, const double* src, double* dst,
+                     unsigned int count, double* bounds, unsigned int threshold,
+                     unsigned int threads)
+{
+    unsigned int numChunks = 1;
+    if ((threshold > 0) && (count >= threshold))
+    {
+        if (threads == 0)
+            threads = thread::hardware_concurrency();
+        numChunks = min(threads, count / (threshold / 2 + 1));
+        if (numChunks == 0)
+            numChunks = 1;
+    }
+    if (numChunks == 1)
+    {
+        double chunkBounds[6];
+        if (kind == MatrixBatch::POINTS)
+            PointsKernel(m, src, dst, count, bounds ? bounds : chunkBounds);
+        else
+            VectorsKernel(m, src, dst, count, kind == MatrixBatch::NORMALS);
+        return;
+    }
+    {
+        lock_guard<mutex> lock(batchQueueMutex);
+        if (batchQueuePtr == NULL)
+            batchQueuePtr = new VART::WorkQueue;
+    }
+    MatrixBatch batch;
+    batch.kind = kind;
+    batch.matrix = m;
+    batch.src = src;
+    batch.dst = dst;
+    batch.count = count;
+    batch.numChunks = numChunks;
+    batch.boundsVec.resize(6 * numChunks);
+    batch.pending = numChunks - 1;
+    // The calling thread takes the first chunk
+    for (unsigned int chunk = 1; chunk < numChunks; ++chunk)
+        batchQueuePtr->Add(new MatrixBatchJob(&batch, chunk));
+    batch.Run(0);
+    batch.Wait();
+    if (bounds)
+    {
+        for (int i = 0; i < 6; ++i)
+            bounds[i] = batch.boundsVec[i];
+        for (unsigned int chunk = 1; chunk < numChunks; ++chunk)
+            for (int i = 0; i < 3; ++i)
+            {
+                bounds[i] = min(bounds[i], batch.boundsVec[6 * chunk + i]);
+                bounds[i + 3] = max(bounds[i + 3], batch.boundsVec[6 * chunk + i + 3]);
+            }
+    }
+}
+
+void VART::Matrix4::TransformPoints(const double* src, double* dst, unsigned int count,
+                                    double* bounds) const
+{
+    RunBatch(MatrixBatch::POINTS, data, src, dst, count, bounds, parallelThreshold, numThreads);
+}
+
+void VART::Matrix4::TransformVectors(const double* src, double* dst, unsigned int count) const
+{
+    RunBatch(MatrixBatch::VECTORS, data, src, dst, count, NULL, parallelThreshold,
+             numThreads);
+}
+
+bool VART::Matrix4::TransformNormals(const double* src, double* dst, unsigned int count) const
+{
+    Matrix4 normalMatrix;
+    if (!GetNormalMatrix(&normalMatrix))
+        return false;
+    RunBatch(MatrixBatch::NORMALS, normalMatrix.data, src, dst, count, NULL, parallelThreshold,
+             numThreads);
+    return true;
+}
+
+bool VART::Matrix4::GetNormalMatrix(Matrix4* resultPtr) const
+{
+    // The inverse of the 3x3 part is its adjugate over the determinant; the transpose of
+    // the adjugate is the matrix of cofactors.
+    const double* m = data;
+    double cof[16];
+    cof[0] = m[5] * m[10] - m[9] * m[6];
+    cof[1] = m[6] * m[8] - m[4] * m[10];
+    cof[2] = m[4] * m[9] - m[8] * m[5];
+    double det = m[0] * cof[0] + m[1] * cof[1] + m[2] * cof[2];
+    if (det == 0)
+        return false;
+    double invDet = 1.0 / det;
+    cof[0] *= invDet;
+    cof[1] *= invDet;
+    cof[2] *= invDet;
+    cof[4] = (m[9] * m[2] - m[1] * m[10]) * invDet;
+    cof[5] = (m[0] * m[10] - m[8] * m[2]) * invDet;
+    cof[6] = (m[8] * m[1] - m[0] * m[9]) * invDet;
+    cof[8] = (m[1] * m[6] - m[5] * m[2]) * invDet;
+    cof[9] = (m[4] * m[2] - m[0] * m[6]) * invDet;
+    cof[10] = (m[0] * m[5] - m[4] * m[1]) * invDet;
+    cof[3] = cof[7] = cof[11] = cof[12] = cof[13] = cof[14] = 0.0;
+    cof[15] = 1.0;
+    resultPtr->SetData(cof);
+    return true;
+}
+
+void VART::Matrix4::ApplyTo(Point4D* points, unsigned int count) const
+{
+    Point4D* end = points + count;
+#if defined(VART_MATRIX4_AVX)
+    __m256d c0 = _mm256_loadu_pd(data);
+    __m256d c1 = _mm256_loadu_pd(data + 4);
+    __m256d c2 = _mm256_loadu_pd(data + 8);
+    __m256d c3 = _mm256_loadu_pd(data + 12);
+    for (; points != end; ++points)
+    {
+        __m256d acc = _mm256_mul_pd(c0, _mm256_set1_pd(points->GetX()));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c1, _mm256_set1_pd(points->GetY())));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c2, _mm256_set1_pd(points->GetZ())));
+        acc = _mm256_add_pd(acc, _mm256_mul_pd(c3, _mm256_set1_pd(points->GetW())));
+        double result[4];
+        _mm256_storeu_pd(result, acc);
+        points->SetXYZW(result[0], result[1], result[2], result[3]);
+    }
+#else
+    for (; points != end; ++points)
+        ApplyTo(points);
+#endif
+}
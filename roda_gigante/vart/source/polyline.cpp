@@ -3,6 +3,7 @@
 /// \version $Revision: 1.2 $
 
 #include "vart/polyline.h"
+#include "vart/framestats.h"
 
 using namespace std;
 //using namespace VART;
@@ -40,6 +41,15 @@ void VART::PolyLine::Clear()
     vertexVec.clear();
 }
 
+void VART::PolyLine::AddCurve(VART::Curve& curve, unsigned int numVertices)
+{
+    if (numVertices == 0)
+        return;
+    unsigned int first = vertexVec.size();
+    vertexVec.resize(first + numVertices);
+    curve.GetUniformPoints(0.0, 1.0, numVertices, &vertexVec[first]);
+}
+
 void VART::PolyLine::ComputeBoundingBox() 
 {
     if (vertexVec.size() > 1)
@@ -56,8 +66,10 @@ bool VART::PolyLine::DrawOGL() const
 {
 #ifdef VART_OGL
     bool result = true;
+    ++FrameStats::current.nodesVisited;
     if (show)
     {
+        ++FrameStats::current.objectsDrawn;
         glPushAttrib( GL_LINE_BIT );
         glLineWidth( width );
         result = material.DrawOGL();
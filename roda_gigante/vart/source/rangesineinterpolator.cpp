@@ -39,3 +39,11 @@ float VART::RangeSineInterpolator::GetValue(float linearIndex, float initialPos,
 {
     return ((((sinf((linearIndex+1.5)*M_PI)+1)/2.0f)*(maxLimit-minLimit))+minLimit)*range+initialPos;
 }
+
+void VART::RangeSineInterpolator::GetValues(const float* linearIndices, unsigned int count,
+                                            float initialPos, float range, float* results) const
+// virtual method
+{
+    EaseInEaseOut(linearIndices, count, (maxLimit - minLimit) * range,
+                  minLimit * range + initialPos, results);
+}
@@ -3,7 +3,8 @@
 /// \version $Revision: 1.4 $
 
 #include "vart/texture.h"
-#include <cassert>
+#include "vart/framestats.h"
+#include "vart/profiler.h"
 #include <iostream>
 
 using std::cerr;
@@ -15,7 +16,7 @@ bool VART::Texture::hasWhiteTexture = false;
 unsigned int VART::Texture::whiteTextureId = 0;
 
 VART::Texture::Texture()
-    : hasTexture(false), textureId(0)
+    : imagePtr(NULL)
 // Creates a texture with no data that does not affect the redering of a material.
 {
     if (notInitalized)
@@ -24,6 +25,7 @@ VART::Texture::Texture()
 }
 
 VART::Texture::Texture(const string& fileName)
+    : imagePtr(NULL)
 {
     if (notInitalized)
         Initialize();
@@ -37,86 +39,41 @@ VART::Texture::Texture(const VART::Texture& texture)
 
 bool VART::Texture::HasTextureLoad() const {
     cerr << "\aWarning: Texture::HasTextureLoad() is deprecated.\n";
-    return hasTexture;
+    return HasData();
 }
 
 VART::Texture& VART::Texture::operator=(const VART::Texture& texture)
 {
-    textureId = texture.textureId;
-    hasTexture = texture.hasTexture;
+    imagePtr = texture.imagePtr;
+    fileName = texture.fileName;
     return *this;
 }
 
 bool VART::Texture::LoadFromFile(const std::string& fileName)
 {
-    // The following symbols of devIL match OpenGL's:
-    // IL_COLOUR_INDEX, IL_COLOR_INDEX, IL_ALPHA, IL_RGB, IL_RGBA, IL_BGR,
-    // IL_BGRA, IL_LUMINANCE, IL_LUMINANCE_ALPHA
-
-    // Reads the image data, and assign it to width, height and imageData variables.
-    // This is dependent of the image reader library.
-#ifdef IL_LIB
-    ILuint ilTextName;
-
-    ilGenImages(1, &ilTextName);
-    ilBindImage(ilTextName);
-    ilEnable(IL_ORIGIN_SET);
-    ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
-    ilLoadImage( fileName.c_str() );
-    ILenum error = ilGetError();
-    if (error != IL_NO_ERROR)
+    VART_PROFILE_ZONE("Texture::LoadFromFile");
+    if (!RequestFile(fileName))
+        return false;
+    TextureCache& cache = TextureCache::Instance();
+    cache.WaitTextureId(imagePtr);
+    if (imagePtr->HasFailed())
     {
         cerr << "Error while loading image file in Texture::LoadFromFile.\n"
-             << "ilLoadImage returned " << error << "\n";
-        throw 1;
-    }
-    unsigned int width = ilGetInteger(IL_IMAGE_WIDTH);
-    unsigned int height = ilGetInteger(IL_IMAGE_HEIGHT);
-    ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
-    ILubyte* imageData = ilGetData();
-    error = ilGetError();
-    if (error == IL_NO_ERROR)
-    {
-        clog << "Image data from " << fileName << " loaded successfully.\n";
-    }
-    else
-    {
-        cerr << "Error while getting image data in Texture::LoadFromFile.\n"
-             << "Caught error: " << error << "\n";
-        throw 2;
+             << "Texture file: '" << fileName << "'\n";
+        imagePtr = NULL;
+        return false;
     }
-#else
-#error No image handling library defined. Try compiling with -DIL_LIB.
-#endif //IL_LIB
-
-#ifdef VART_OGL
-    //If we have the image data, generate a OpenGL texture.
-    if(imageData != NULL)
-    {
-        hasTexture = true;
-        glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, imageData);
-        assert(glGetError()==GL_NO_ERROR);
-    }
-    else
-    {
-        cerr << "Error binding texture in Texture::LoadFromFile.\n"
-             << "Texture file: '" << fileName << "'\n"
-             << "imageData: " << imageData << "\n";
-        throw 3;
-    }
-#else
-#error No rendering library defined. Try compiling with -DVART_OGL.
-#endif //VART_OGL
-
-#ifdef IL_LIB
-    //Free the image data.
-    ilDeleteImages(1, &ilTextName);
-#endif //IL_LIB
+    clog << "Image data from " << fileName << " loaded successfully.\n";
+    return true;
+}
 
+bool VART::Texture::RequestFile(const std::string& fileName)
+{
+    TextureCache::Image* newImagePtr = TextureCache::Instance().Request(fileName);
+    if (newImagePtr == NULL)
+        return false;
+    imagePtr = newImagePtr;
+    this->fileName = fileName;
     return true;
 }
 
@@ -135,11 +92,15 @@ bool VART::Texture::DrawOGL() const
 {
 #ifdef VART_OGL
     static bool textureIsEnabled = false;
+    unsigned int textureId = 0;
+    if (imagePtr)
+        textureId = TextureCache::Instance().GetTextureId(imagePtr);
     if (textureIsEnabled)
     {
-        if (hasTexture)
+        if (textureId)
         {
             glBindTexture(GL_TEXTURE_2D, textureId);
+            ++FrameStats::current.textureBinds;
             //std::cout << "DrawOGL textureId: " << textureId << ".\n";
         }
         else
@@ -151,11 +112,12 @@ bool VART::Texture::DrawOGL() const
     }
     else
     { // texture is not enabled
-        if (hasTexture)
+        if (textureId)
         {
                 glEnable(GL_TEXTURE_2D);
                 textureIsEnabled = true;
                 glBindTexture(GL_TEXTURE_2D, textureId);
+                ++FrameStats::current.textureBinds;
         }
     }
 #endif //VART_OGL
@@ -0,0 +1,69 @@
+/// \file workqueue.cpp
+/// \brief Implementation file for V-ART class "WorkQueue".
+/// \version $Revision: 1.1 $
+
+#include "vart/workqueue.h"
+#include "vart/profiler.h"
+
+using namespace std;
+
+VART::WorkQueue::WorkQueue() : numThreads(thread::hardware_concurrency()), stopping(false)
+{
+}
+
+VART::WorkQueue::~WorkQueue()
+{
+    Stop();
+}
+
+void VART::WorkQueue::Add(Job* jobPtr)
+{
+    lock_guard<mutex> lock(queueMutex);
+    if (stopping)
+    {
+        delete jobPtr;
+        return;
+    }
+    jobQueue.push_back(jobPtr);
+    if (workerVec.empty())
+    {
+        unsigned int count = (numThreads > 0) ? numThreads : 1;
+        for (unsigned int i = 0; i < count; ++i)
+            workerVec.push_back(thread(&WorkQueue::Work, this));
+    }
+    added.notify_one();
+}
+
+void VART::WorkQueue::Stop()
+{
+    {
+        lock_guard<mutex> lock(queueMutex);
+        stopping = true;
+        for (unsigned int i = 0; i < jobQueue.size(); ++i)
+            delete jobQueue[i];
+        jobQueue.clear();
+    }
+    added.notify_all();
+    for (unsigned int i = 0; i < workerVec.size(); ++i)
+        workerVec[i].join();
+    workerVec.clear();
+}
+
+void VART::WorkQueue::Work()
+{
+    Profiler::SetThreadName("WorkQueue");
+    unique_lock<mutex> lock(queueMutex);
+    while (true)
+    {
+        while (jobQueue.empty() && !stopping)
+            added.wait(lock);
+        if (stopping)
+            return;
+        Job* jobPtr = jobQueue.front();
+        jobQueue.pop_front();
+        lock.unlock();
+        jobPtr->Run();
+        delete jobPtr;
+        lock.lock();
+    }
+}
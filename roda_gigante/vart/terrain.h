@@ -0,0 +1,228 @@
+/// \file terrain.h
+/// \brief Header file for V-ART class "Terrain".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_TERRAIN_H
+#define VART_TERRAIN_H
+
+#include "vart/graphicobj.h"
+#include "vart/material.h"
+#include "vart/matrix4.h"
+#include "vart/point4d.h"
+#include "vart/workqueue.h"
+#include <vector>
+#include <list>
+#include <mutex>
+
+namespace VART {
+/// \class Terrain terrain.h
+/// \brief A heightfield: a regular grid of heights over the XZ plane.
+///
+/// A terrain keeps only one height (a float) per grid sample, so that large grids (e.g.:
+/// 4096x4096 cells) fit in memory, which would not be the case for a MeshObject. The grid
+/// starts at the origin and extends along positive X and Z, with samples "spacing" units
+/// apart. Normals are computed from neighbouring heights (central differences).
+///
+/// The grid is split into square chunks of cells. Each chunk is drawn at a level of detail
+/// picked from its distance to the camera (geomipmapping): level 0 uses every sample,
+/// each following level every other sample of the previous one. Where a chunk meets a
+/// coarser neighbour, its border vertices are placed on the neighbour's edges, so there
+/// are no cracks between levels. Chunks outside the view volume are not drawn, and
+/// vertex data is only kept for chunks drawn in the last frame.
+///
+/// Heights may also be streamed: with a TileSource, each chunk's heights (a tile) are
+/// loaded in the background when the chunk comes within the streaming distance of the
+/// camera, and discarded when it goes well beyond it. Loaded tiles are put in place by
+/// Update, which the application must call once per frame, from the thread that draws.
+///
+/// GetHeightAt and GetNormalAt give the surface at any point, in constant time, for
+/// objects that move on the terrain.
+    class Terrain : public GraphicObj {
+        public:
+        // PUBLIC NESTED CLASSES
+            /// \brief Provider of heights for streamed terrains.
+            class TileSource {
+                public:
+                    virtual ~TileSource() {}
+                    /// \brief Gives the heights of a tile (the samples of a chunk).
+                    /// \param tileX [in] Column of the tile (along X).
+                    /// \param tileZ [in] Row of the tile (along Z).
+                    /// \param size [in] Number of samples along each side of the tile
+                    /// (chunk size plus one: tiles share border samples).
+                    /// \param heights [out] size*size heights, row by row (X varies
+                    /// fastest).
+                    /// \return False if the tile could not be loaded.
+                    ///
+                    /// Border samples must match those of neighbour tiles. Called by
+                    /// worker threads, possibly several at a time.
+                    virtual bool LoadTile(unsigned int tileX, unsigned int tileZ,
+                                          unsigned int size, float* heights) = 0;
+            };
+        // PUBLIC METHODS
+            /// \brief Creates an empty terrain.
+            Terrain();
+            /// \brief Creates a flat terrain (see SetSize).
+            Terrain(unsigned int numCellsX, unsigned int numCellsZ, double spacing,
+                    unsigned int chunkSize = 64);
+            Terrain(const Terrain& terrain);
+            virtual ~Terrain();
+            Terrain& operator=(const Terrain& terrain);
+            /// \brief Returns a copy of the terrain (without streaming).
+            virtual SceneNode* Copy();
+
+            /// \brief Resizes the grid, making it flat (or unloaded, if streamed).
+            /// \param numCellsX [in] Number of cells along X.
+            /// \param numCellsZ [in] Number of cells along Z.
+            /// \param spacing [in] Distance between samples.
+            /// \param chunkSize [in] Cells along each side of a chunk: a power of two, up to
+            /// 128, that divides both numbers of cells.
+            /// \return False (leaving the terrain untouched) if sizes are not valid.
+            bool SetSize(unsigned int numCellsX, unsigned int numCellsZ, double spacing,
+                         unsigned int chunkSize = 64);
+            unsigned int GetNumCellsX() const { return numCellsX; }
+            unsigned int GetNumCellsZ() const { return numCellsZ; }
+            double GetSpacing() const { return spacing; }
+            unsigned int GetChunkSize() const { return chunkSize; }
+
+            /// \brief Sets the height of a sample. Its tile must be loaded.
+            ///
+            /// Call ComputeBoundingBox after changing heights, if the bounding box is needed.
+            void SetHeight(unsigned int i, unsigned int j, float height);
+            /// \brief Returns the height of a sample (zero if its tile is not loaded).
+            float GetHeight(unsigned int i, unsigned int j) const;
+            /// \brief Returns the height of the surface at a point of the XZ plane.
+            ///
+            /// The result is on the triangles drawn at the finest level. Points outside
+            /// the grid get the height of the nearest border. Points on unloaded tiles get
+            /// zero.
+            double GetHeightAt(double x, double z) const;
+            /// \brief Returns the normal of the surface at a point of the XZ plane.
+            ///
+            /// Normals of the samples around the point are interpolated, as when drawing.
+            Point4D GetNormalAt(double x, double z) const;
+
+            /// \brief Sets the material used to draw the terrain.
+            void SetMaterial(const Material& mat) { material = mat; }
+            /// \brief Returns the material used to draw the terrain.
+            const Material& GetMaterial() const { return material; }
+
+            /// \brief Sets the distance (in object coordinates) up to which chunks are drawn
+            /// at the finest level (default 100). Each time the distance doubles, chunks are
+            /// drawn at the next level.
+            void SetLODDistance(double value) { lodDistance = value; }
+            double GetLODDistance() const { return lodDistance; }
+
+            /// \brief Streams heights from a source (NULL to stop streaming).
+            ///
+            /// Every tile is unloaded (or made flat, if streaming stops). The source must
+            /// outlive the terrain: it may still be loading tiles.
+            void SetTileSource(TileSource* sourcePtr);
+            /// \brief Sets the distance (in object coordinates) from the camera within
+            /// which tiles are loaded and drawn (default 1000). Tiles beyond one and a
+            /// half times this distance are unloaded by Update.
+            void SetStreamingDistance(double value) { streamingDistance = value; }
+            /// \brief Sets the range of heights assumed for unloaded tiles, to decide
+            /// whether they are in view (default: 0 to 0).
+            void SetHeightRange(float minHeight, float maxHeight);
+            /// \brief Puts loaded tiles in place and unloads far ones.
+            ///
+            /// Distances are measured from the camera of the last frame. Does nothing if
+            /// heights are not streamed.
+            void Update();
+            /// \brief Returns the number of tiles whose heights are in memory.
+            unsigned int GetNumLoadedTiles() const;
+
+            /// \brief Returns the number of chunks drawn in the last frame.
+            unsigned int GetNumChunksDrawn() const { return numChunksDrawn; }
+            /// \brief Returns the memory used by heights, vertex data and indices, in bytes.
+            unsigned long GetMemoryBytes() const;
+
+            /// \brief Computes the bounding box (using the height range for unloaded tiles).
+            virtual void ComputeBoundingBox();
+        protected:
+        // PROTECTED NESTED CLASSES
+            /// \brief Heights of a chunk and its vertex data, as last drawn.
+            class Tile {
+                public:
+                    Tile() : state(LOADED), level(0), minHeight(0), maxHeight(0) {}
+                    enum State { UNLOADED, LOADING, LOADED, FAILED };
+                    /// (chunkSize + 1)^2 heights, row by row (X varies fastest).
+                    std::vector<float> heightVec;
+                    State state;
+                    /// Level of detail of vertexVec.
+                    unsigned int level;
+                    /// Levels of neighbours (X-, X+, Z-, Z+) vertexVec was made for.
+                    unsigned int neighbourLevels[4];
+                    /// Vertex coordinates and normals, interleaved (empty if the chunk
+                    /// was not drawn in the last frame).
+                    std::vector<float> vertexVec;
+                    float minHeight;
+                    float maxHeight;
+            };
+            /// \brief Heights of a tile loaded by a worker thread, waiting for Update.
+            class LoadedTile {
+                public:
+                    unsigned int tileX;
+                    unsigned int tileZ;
+                    /// Value of "generation" when the tile was requested.
+                    unsigned int generation;
+                    bool failed;
+                    std::vector<float> heightVec;
+            };
+            /// \brief Job that loads a tile from the tile source.
+            class LoadJob;
+        // PROTECTED METHODS
+            /// \brief Gets the height of a sample, given by its position in a tile, even if
+            /// just outside it (in a neighbour tile).
+            /// \return False if the sample is outside the grid or in an unloaded tile.
+            bool Sample(const Tile& tile, unsigned int tileX, unsigned int tileZ,
+                        int i, int j, float* heightPtr) const;
+            /// \brief Computes the (unit) normal at a sample of a tile.
+            void SampleNormal(const Tile& tile, unsigned int tileX, unsigned int tileZ,
+                              int i, int j, float* normal) const;
+            /// \brief Returns the level of detail of a chunk, seen from the eye position.
+            unsigned int ChunkLevel(unsigned int tileX, unsigned int tileZ) const;
+            /// \brief Makes vertex data of a chunk for its level and its neighbours'.
+            void MakeVertices(Tile* tilePtr, unsigned int tileX, unsigned int tileZ) const;
+            /// \brief Computes the bounding box from height ranges of tiles.
+            void ComputeBoxFromTiles();
+            /// \brief Makes triangle indices of every level.
+            void MakeIndices();
+            /// \brief Returns the distance from the eye position to the box of a tile.
+            double TileDistance(unsigned int tileX, unsigned int tileZ) const;
+            /// \brief Returns the distance from the eye position to a tile, in the XZ plane.
+            double TileDistanceXZ(unsigned int tileX, unsigned int tileZ) const;
+            /// \brief Loads a tile from a tile source. Called by worker threads.
+            void Load(TileSource* sourcePtr, unsigned int tileX, unsigned int tileZ,
+                      unsigned int size, unsigned int requestGeneration);
+            virtual bool DrawInstanceOGL() const;
+        // PROTECTED ATTRIBUTES
+            unsigned int numCellsX;
+            unsigned int numCellsZ;
+            double spacing;
+            unsigned int chunkSize;
+            unsigned int numTilesX;
+            unsigned int numTilesZ;
+            /// Tiles row by row (X varies fastest).
+            mutable std::vector<Tile> tileVec;
+            /// Triangle indices of each level, shared by all chunks.
+            std::vector<std::vector<unsigned short> > indexVecs;
+            Material material;
+            double lodDistance;
+            double streamingDistance;
+            float rangeMin;
+            float rangeMax;
+            TileSource* tileSourcePtr;
+            /// Eye position in object coordinates, in the last frame.
+            mutable Point4D eye;
+            mutable unsigned int numChunksDrawn;
+            /// Incremented whenever tiles requested before become useless (the grid or the
+            /// tile source changed).
+            unsigned int generation;
+            std::list<LoadedTile> loadedList;
+            std::mutex loadedMutex;
+            WorkQueue workQueue;
+    }; // end class declaration
+} // end namespace
+
+#endif
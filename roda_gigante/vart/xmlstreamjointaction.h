@@ -0,0 +1,66 @@
+/// \file xmlstreamjointaction.h
+/// \brief Header file for V-ART class "XmlStreamJointAction".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_XMLSTREAMJOINTACTION_H
+#define VART_XMLSTREAMJOINTACTION_H
+
+#include "vart/jointaction.h"
+#include <vector>
+#include <map>
+#include <string>
+
+namespace VART {
+    class SceneNode;
+    class XmlReader;
+/// \class XmlStreamJointAction xmlstreamjointaction.h
+/// \brief Streaming loader for xml files that describe a JointAction.
+///
+/// Reads the same files as XmlJointAction (and the deprecated XmlAction) and builds the same
+/// joint movers, but uses an XmlReader instead of a DOM tree, so it does not need Xerces and
+/// does not validate files against the DTD. Range sine interpolators are owned by the action.
+    class XmlStreamJointAction : public JointAction {
+        public:
+        // PUBLIC METHODS
+            XmlStreamJointAction();
+            virtual ~XmlStreamJointAction();
+
+            /// \brief Loads JointAction from a XML file.
+            ///
+            /// Only descendents of given scene node are searched for joints.
+            /// \return False on errors, which are reported to cerr.
+            bool LoadFromFile(const std::string& fileName, const SceneNode& sNode);
+        protected:
+        // PROTECTED TYPES
+            /// \brief Element and attribute names, interned in this order.
+            enum Name { ACTION, JOINT_MOVEMENT, INTERPOLATION, DOF_MOVEMENT, NOISE, POSITIONAL_ERROR,
+                        // attributes
+                        ACTION_NAME, SPEED, CYCLE, DURATION, JOINT_NAME, TYPE, INITIAL_TIME,
+                        FINAL_TIME, FINAL_POSITION, DOF_ID, AMPLITUDE, LENGTH, OVERSHOOT,
+                        OFFSET, PEAK_TIME };
+        // PROTECTED METHODS
+            /// \brief Handles the start of an element.
+            /// \return False on errors.
+            bool StartElement(const XmlReader& reader);
+            /// \brief Creates the dof mover that has just been read.
+            void CreateDofMover();
+        // PROTECTED ATTRIBUTES
+            /// \brief Nodes that may be moved, by description (filled while loading).
+            std::map<std::string, const SceneNode*> nodeMap;
+            /// \brief Joint mover being read (NULL if its joint was not found).
+            JointMover* jointMoverPtr;
+            // Dof mover being read
+            Joint::DofID dofID;
+            float initialTime;
+            float finalTime;
+            float finalPosition;
+            float noiseAmplitude;
+            float noiseWaveLength;
+            bool foundNoise;
+            bool foundPositionalError;
+            /// \brief Interpolators allocated by the action.
+            std::vector<Interpolator*> interpolatorVec;
+    }; // end class declaration
+} // end namespace
+
+#endif
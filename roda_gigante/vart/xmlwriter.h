@@ -0,0 +1,59 @@
+/// \file xmlwriter.h
+/// \brief Header file for V-ART class "XmlWriter".
+/// \version $Revision: 1.1 $
+
+#ifndef VART_XMLWRITER_H
+#define VART_XMLWRITER_H
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace VART {
+/// \class XmlWriter xmlwriter.h
+/// \brief Buffer for writing xml files.
+///
+/// Text is appended to a single growing buffer, which is written at once when done. Numbers
+/// are formatted as by an ostream with default settings (6 significant digits, "%g" style),
+/// without going through locales or stream state, so XmlWrite methods (see SceneNode::XmlWrite)
+/// produce exactly what XmlPrintOn used to, much faster.
+    class XmlWriter {
+        public:
+        // PUBLIC METHODS
+            XmlWriter();
+
+            /// \brief Appends a string.
+            void Append(const char* text);
+            void Append(const std::string& text);
+            /// \brief Appends a number, as an ostream would.
+            void Append(double value);
+            /// \brief Appends a number of spaces.
+            void Indent(unsigned int indent) { buffer.insert(buffer.end(), indent, ' '); }
+
+            /// \brief Appends a string, then a number, then another string.
+            void Append(const char* before, double value, const char* after);
+
+            /// \brief Returns the buffer size.
+            size_t GetSize() const { return buffer.size(); }
+            /// \brief Returns the text written so far.
+            std::string GetText() const { return std::string(buffer.begin(), buffer.end()); }
+            /// \brief Empties the buffer, keeping its memory.
+            void Clear() { buffer.clear(); }
+            /// \brief Writes the text to a stream.
+            void WriteTo(std::ostream& os) const;
+            /// \brief Writes the text to a file.
+            /// \return False if the file could not be written.
+            bool SaveToFile(const std::string& fileName) const;
+        // PUBLIC STATIC METHODS
+            /// \brief Formats a number as "%g" would.
+            /// \param value [in] The number.
+            /// \param text [out] At least 16 characters, not null terminated.
+            /// \return The number of characters.
+            static unsigned int FormatNumber(double value, char* text);
+        protected:
+        // PROTECTED ATTRIBUTES
+            std::vector<char> buffer;
+    }; // end class declaration
+} // end namespace
+
+#endif